@@ -163,6 +163,7 @@ macro(libgav1_set_build_definitions)
   # Source file names ending in these suffixes will have the appropriate
   # compiler flags added to their compile commands to enable intrinsics.
   set(libgav1_avx2_source_file_suffix "avx2(_test)?.cc")
+  set(libgav1_avx512_source_file_suffix "avx512(_test)?.cc")
   set(libgav1_neon_source_file_suffix "neon(_test)?.cc")
   set(libgav1_sse4_source_file_suffix "sse4(_test)?.cc")
 endmacro()
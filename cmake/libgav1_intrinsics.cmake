@@ -38,6 +38,13 @@ macro(libgav1_get_intrinsics_flag_for_suffix)
     if(NOT MSVC)
       set(${intrinsics_VARIABLE} "${LIBGAV1_NEON_INTRINSICS_FLAG}")
     endif()
+  elseif(intrinsics_SUFFIX MATCHES "avx512")
+    if(MSVC)
+      set(${intrinsics_VARIABLE} "/arch:AVX512")
+    else()
+      set(${intrinsics_VARIABLE}
+          "-mavx512f -mavx512bw -mavx512dq -mavx512vl")
+    endif()
   elseif(intrinsics_SUFFIX MATCHES "avx2")
     if(MSVC)
       set(${intrinsics_VARIABLE} "/arch:AVX2")
@@ -63,7 +70,7 @@ endmacro()
 # necessary: libgav1_process_intrinsics_sources(SOURCES <sources>)
 #
 # Detects requirement for intrinsics flags using source file name suffix.
-# Currently supports AVX2 and SSE4.1.
+# Currently supports AVX-512, AVX2 and SSE4.1.
 macro(libgav1_process_intrinsics_sources)
   unset(arg_TARGET)
   unset(arg_SOURCES)
@@ -77,6 +84,24 @@ macro(libgav1_process_intrinsics_sources)
                         "SOURCES required.")
   endif()
 
+  if(LIBGAV1_ENABLE_AVX512 AND libgav1_have_avx512)
+    unset(avx512_sources)
+    list(APPEND avx512_sources ${arg_SOURCES})
+
+    list(FILTER avx512_sources INCLUDE REGEX
+         "${libgav1_avx512_source_file_suffix}$")
+
+    if(avx512_sources)
+      unset(avx512_flags)
+      libgav1_get_intrinsics_flag_for_suffix(
+        SUFFIX ${libgav1_avx512_source_file_suffix} VARIABLE avx512_flags)
+      if(avx512_flags)
+        libgav1_set_compiler_flags_for_sources(SOURCES ${avx512_sources} FLAGS
+                                               ${avx512_flags})
+      endif()
+    endif()
+  endif()
+
   if(LIBGAV1_ENABLE_AVX2 AND libgav1_have_avx2)
     unset(avx2_sources)
     list(APPEND avx2_sources ${arg_SOURCES})
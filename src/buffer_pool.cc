@@ -17,6 +17,7 @@
 #include <cassert>
 #include <cstring>
 
+#include "src/memory_tracker.h"
 #include "src/utils/common.h"
 #include "src/utils/constants.h"
 #include "src/utils/logging.h"
@@ -155,6 +156,17 @@ bool BufferPool::OnFrameBufferSizeChanged(int bitdepth,
                                        /*stride_alignment=*/16) == kStatusOk;
 }
 
+void BufferPool::SetMemoryNodes(uint64_t node_mask) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  internal_frame_buffers_.set_memory_nodes(node_mask);
+}
+
+void BufferPool::SetMemoryTracker(MemoryTracker* const memory_tracker) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  memory_tracker_ = memory_tracker;
+  internal_frame_buffers_.set_memory_tracker(memory_tracker);
+}
+
 RefCountedBufferPtr BufferPool::GetFreeBuffer() {
   std::unique_lock<std::mutex> lock(mutex_);
   for (auto buffer : buffers_) {
@@ -189,6 +201,10 @@ RefCountedBufferPtr BufferPool::GetFreeBuffer() {
     delete buffer;
     return RefCountedBufferPtr();
   }
+  if (memory_tracker_ != nullptr) {
+    memory_tracker_->Add(kMemoryCategorySymbolContexts,
+                         sizeof(SymbolDecoderContext));
+  }
   return RefCountedBufferPtr(buffer, RefCountedBuffer::ReturnToBufferPool);
 }
 
@@ -201,6 +217,25 @@ void BufferPool::Abort() {
   }
 }
 
+void BufferPool::Trim() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t num_buffers = 0;
+  for (auto* const buffer : buffers_) {
+    if (buffer->in_use_) {
+      buffers_[num_buffers++] = buffer;
+      continue;
+    }
+    assert(!buffer->buffer_private_data_valid_);
+    delete buffer;
+    if (memory_tracker_ != nullptr) {
+      memory_tracker_->Subtract(kMemoryCategorySymbolContexts,
+                                sizeof(SymbolDecoderContext));
+    }
+  }
+  buffers_.erase(buffers_.begin() + num_buffers, buffers_.end());
+  internal_frame_buffers_.Trim();
+}
+
 void BufferPool::ReturnUnusedBuffer(RefCountedBuffer* buffer) {
   std::lock_guard<std::mutex> lock(mutex_);
   assert(buffer->in_use_);
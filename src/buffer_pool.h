@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <condition_variable>  // NOLINT (unapproved c++11 header)
@@ -44,6 +45,7 @@
 namespace libgav1 {
 
 class BufferPool;
+class MemoryTracker;
 
 enum FrameState : uint8_t {
   kFrameStateUnknown,
@@ -219,43 +221,29 @@ class RefCountedBuffer : public MaxAlignedAllocable {
 
   // This will wake up the WaitUntil*() functions and make them return false.
   void Abort() {
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      abort_ = true;
-    }
-    parsed_condvar_.notify_all();
-    decoded_condvar_.notify_all();
-    progress_row_condvar_.notify_all();
+    abort_ = true;
+    NotifyWaiters();
   }
 
   void SetFrameState(FrameState frame_state) {
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      frame_state_ = frame_state;
-    }
-    if (frame_state == kFrameStateParsed) {
-      parsed_condvar_.notify_all();
-    } else if (frame_state == kFrameStateDecoded) {
-      decoded_condvar_.notify_all();
-      progress_row_condvar_.notify_all();
-    }
+    frame_state_ = frame_state;
+    NotifyWaiters();
   }
 
   // Sets the progress of this frame to |progress_row| and notifies any threads
   // that may be waiting on rows <= |progress_row|.
   void SetProgress(int progress_row) {
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      if (progress_row_ >= progress_row) return;
-      progress_row_ = progress_row;
-    }
-    progress_row_condvar_.notify_all();
+    int current_progress_row = progress_row_.load(std::memory_order_relaxed);
+    do {
+      if (current_progress_row >= progress_row) return;
+    } while (!progress_row_.compare_exchange_weak(current_progress_row,
+                                                  progress_row));
+    NotifyWaiters();
   }
 
   void MarkFrameAsStarted() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (frame_state_ != kFrameStateUnknown) return;
-    frame_state_ = kFrameStateStarted;
+    FrameState expected = kFrameStateUnknown;
+    frame_state_.compare_exchange_strong(expected, kFrameStateStarted);
   }
 
   // All the WaitUntil* functions will return true if the desired wait state was
@@ -265,10 +253,7 @@ class RefCountedBuffer : public MaxAlignedAllocable {
 
   // Waits until the frame has been parsed.
   bool WaitUntilParsed() {
-    std::unique_lock<std::mutex> lock(mutex_);
-    while (frame_state_ < kFrameStateParsed && !abort_) {
-      parsed_condvar_.wait(lock);
-    }
+    Wait([this]() { return frame_state_ >= kFrameStateParsed || abort_; });
     return !abort_;
   }
 
@@ -285,25 +270,21 @@ class RefCountedBuffer : public MaxAlignedAllocable {
     // border to be available. The top border will be available when row 0 has
     // been decoded. So we can simply wait on row 0 instead.
     progress_row = std::max(progress_row, 0);
-    std::unique_lock<std::mutex> lock(mutex_);
-    while (progress_row_ < progress_row && frame_state_ != kFrameStateDecoded &&
-           !abort_) {
-      progress_row_condvar_.wait(lock);
-    }
+    Wait([this, progress_row]() {
+      return progress_row_ >= progress_row ||
+             frame_state_ == kFrameStateDecoded || abort_;
+    });
     // Once |frame_state_| reaches kFrameStateDecoded, |progress_row_| may no
     // longer be updated. So we set |*progress_row_cache| to INT_MAX in that
     // case.
     *progress_row_cache =
-        (frame_state_ != kFrameStateDecoded) ? progress_row_ : INT_MAX;
+        (frame_state_ != kFrameStateDecoded) ? progress_row_.load() : INT_MAX;
     return !abort_;
   }
 
   // Waits until the entire frame has been decoded.
   bool WaitUntilDecoded() {
-    std::unique_lock<std::mutex> lock(mutex_);
-    while (frame_state_ != kFrameStateDecoded && !abort_) {
-      decoded_condvar_.wait(lock);
-    }
+    Wait([this]() { return frame_state_ == kFrameStateDecoded || abort_; });
     return !abort_;
   }
 
@@ -316,23 +297,54 @@ class RefCountedBuffer : public MaxAlignedAllocable {
   void SetBufferPool(BufferPool* pool);
   static void ReturnToBufferPool(RefCountedBuffer* ptr);
 
+  // Number of times the wait condition is checked before a WaitUntil*()
+  // function blocks. The frame progress is usually close to the row that is
+  // waited on, so this avoids putting the thread to sleep for short waits.
+  static constexpr int kSpinsBeforeBlocking = 1024;
+
+  // Waits until |ready| returns true. Spins for a while and then blocks on
+  // |condvar_|.
+  template <typename Predicate>
+  void Wait(Predicate ready) {
+    for (int i = 0; i < kSpinsBeforeBlocking; ++i) {
+      if (ready()) return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++num_waiters_;
+    while (!ready()) {
+      condvar_.wait(lock);
+    }
+    --num_waiters_;
+  }
+
+  // Wakes up the threads that are blocked in Wait(). The state changes are made
+  // to the atomics before calling this function. The sequentially consistent
+  // ordering of those changes and of |num_waiters_| guarantees that either a
+  // waiter sees the change before blocking or it is counted here. Taking
+  // |mutex_| makes sure that a counted waiter is blocked on |condvar_| before
+  // it is notified.
+  void NotifyWaiters() {
+    if (num_waiters_ == 0) return;
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    condvar_.notify_all();
+  }
+
   BufferPool* pool_ = nullptr;
   bool buffer_private_data_valid_ = false;
   void* buffer_private_data_ = nullptr;
   YuvBuffer yuv_buffer_;
   bool in_use_ = false;  // Only used by BufferPool.
 
+  // The frame progress is read without locks. The release and acquire
+  // semantics of the atomics make the decoded pixels visible to the threads
+  // that wait on them. |mutex_| and |condvar_| are only used by threads that
+  // block in Wait().
+  std::atomic<FrameState> frame_state_{kFrameStateUnknown};
+  std::atomic<int> progress_row_{-1};
+  std::atomic<bool> abort_{false};
+  std::atomic<int> num_waiters_{0};
   std::mutex mutex_;
-  FrameState frame_state_ = kFrameStateUnknown LIBGAV1_GUARDED_BY(mutex_);
-  int progress_row_ = -1 LIBGAV1_GUARDED_BY(mutex_);
-  // Signaled when progress_row_ is updated or when frame_state_ is set to
-  // kFrameStateDecoded.
-  std::condition_variable progress_row_condvar_;
-  // Signaled when the frame state is set to kFrameStateParsed.
-  std::condition_variable parsed_condvar_;
-  // Signaled when the frame state is set to kFrameStateDecoded.
-  std::condition_variable decoded_condvar_;
-  bool abort_ = false LIBGAV1_GUARDED_BY(mutex_);
+  std::condition_variable condvar_;
 
   FrameType frame_type_ = kFrameKey;
   ChromaSamplePosition chroma_sample_position_ = kChromaSamplePositionUnknown;
@@ -411,6 +423,22 @@ class BufferPool {
   // Aborts all the buffers that are in use.
   void Abort();
 
+  // Frees the buffers that are not in use, as well as the internal frame
+  // buffers that are not in use. The buffers in use, e.g. the reference
+  // frames, are not affected. This function is thread safe.
+  void Trim();
+
+  // Sets the NUMA nodes (bit i is node i) that the frame buffers allocated by
+  // the library from now on are placed on. 0 means no preference. This has no
+  // effect when the application provides the frame buffers. This function is
+  // thread safe.
+  void SetMemoryNodes(uint64_t node_mask);
+
+  // Counts the memory allocated by the pool from now on in |memory_tracker|,
+  // which must outlive the pool. Must be called before the pool is used by
+  // more than one thread.
+  void SetMemoryTracker(MemoryTracker* memory_tracker);
+
  private:
   friend class RefCountedBuffer;
 
@@ -419,7 +447,7 @@ class BufferPool {
   void ReturnUnusedBuffer(RefCountedBuffer* buffer);
 
   // Used to make the following functions thread safe: GetFreeBuffer(),
-  // ReturnUnusedBuffer(), RefCountedBuffer::Realloc().
+  // Trim(), ReturnUnusedBuffer(), RefCountedBuffer::Realloc().
   std::mutex mutex_;
 
   // Storing a RefCountedBuffer object in a Vector is complicated because of the
@@ -427,6 +455,7 @@ class BufferPool {
   // pointers in the vector.
   Vector<RefCountedBuffer*> buffers_ LIBGAV1_GUARDED_BY(mutex_);
   InternalFrameBufferList internal_frame_buffers_;
+  MemoryTracker* memory_tracker_ = nullptr;
 
   // Frame buffer callbacks.
   FrameBufferSizeChangedCallback on_frame_buffer_size_changed_;
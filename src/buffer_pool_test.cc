@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <memory>
 #include <ostream>
+#include <thread>  // NOLINT (unapproved c++11 header)
 #include <tuple>
 #include <utility>
 
@@ -26,6 +27,7 @@
 #include "src/gav1/decoder_buffer.h"
 #include "src/gav1/frame_buffer.h"
 #include "src/internal_frame_buffer_list.h"
+#include "src/memory_tracker.h"
 #include "src/utils/constants.h"
 #include "src/utils/types.h"
 #include "src/yuv_buffer.h"
@@ -60,6 +62,53 @@ TEST(BufferPoolTest, RefCountedBufferPtr) {
   EXPECT_EQ(buffer_ptr4.use_count(), 2);
 }
 
+TEST(BufferPoolTest, Trim) {
+  // Use the internal frame buffers of the pool.
+  BufferPool buffer_pool(nullptr, nullptr, nullptr, nullptr);
+  MemoryTracker memory_tracker;
+  buffer_pool.SetMemoryTracker(&memory_tracker);
+  RefCountedBufferPtr buffers[3];
+  for (auto& buffer : buffers) {
+    buffer = buffer_pool.GetFreeBuffer();
+    ASSERT_NE(buffer, nullptr);
+    ASSERT_TRUE(buffer->Realloc(/*bitdepth=*/8, /*is_monochrome=*/false,
+                                /*width=*/64, /*height=*/32,
+                                /*subsampling_x=*/1, /*subsampling_y=*/1,
+                                kBorderPixels, kBorderPixels, kBorderPixels,
+                                kBorderPixels));
+  }
+  MemoryUsage usage;
+  memory_tracker.Get(&usage);
+  const size_t frame_buffer_size =
+      usage.current_bytes[kMemoryCategoryFrameBuffers] / 3;
+  EXPECT_GT(frame_buffer_size, size_t{0});
+  EXPECT_EQ(usage.current_bytes[kMemoryCategorySymbolContexts],
+            3 * sizeof(SymbolDecoderContext));
+
+  RefCountedBuffer* const kept_buffer = buffers[1].get();
+  buffers[0] = nullptr;
+  buffers[2] = nullptr;
+  buffer_pool.Trim();
+  memory_tracker.Get(&usage);
+  EXPECT_EQ(usage.current_bytes[kMemoryCategoryFrameBuffers],
+            frame_buffer_size);
+  EXPECT_EQ(usage.current_bytes[kMemoryCategorySymbolContexts],
+            sizeof(SymbolDecoderContext));
+  // The buffer in use keeps its frame buffer.
+  EXPECT_NE(buffers[1]->buffer()->data(kPlaneY), nullptr);
+  buffers[1]->buffer()->data(kPlaneY)[0] = 1;
+
+  // The pool still hands out the buffer in use once it is released.
+  buffers[1] = nullptr;
+  buffers[0] = buffer_pool.GetFreeBuffer();
+  EXPECT_EQ(buffers[0].get(), kept_buffer);
+  buffers[0] = nullptr;
+  buffer_pool.Trim();
+  memory_tracker.Get(&usage);
+  EXPECT_EQ(usage.current_bytes[kMemoryCategoryFrameBuffers], size_t{0});
+  EXPECT_EQ(usage.current_bytes[kMemoryCategorySymbolContexts], size_t{0});
+}
+
 TEST(RefCountedBufferTest, SetFrameDimensions) {
   InternalFrameBufferList buffer_list;
   BufferPool buffer_pool(OnInternalFrameBufferSizeChanged,
@@ -103,6 +152,38 @@ TEST(RefCountedBuffertTest, WaitUntil) {
   EXPECT_FALSE(buffer_ptr->WaitUntil(50, &progress_row_cache));
 }
 
+TEST(RefCountedBuffertTest, WaitUntilAcrossThreads) {
+  InternalFrameBufferList buffer_list;
+  BufferPool buffer_pool(OnInternalFrameBufferSizeChanged,
+                         GetInternalFrameBuffer, ReleaseInternalFrameBuffer,
+                         &buffer_list);
+  RefCountedBufferPtr buffer_ptr = buffer_pool.GetFreeBuffer();
+  ASSERT_NE(buffer_ptr, nullptr);
+
+  // The waiting thread blocks until the rows are reported one at a time.
+  int progress_row_cache = INT_MIN;
+  bool waited = false;
+  std::thread waiter([&]() {
+    waited = buffer_ptr->WaitUntilParsed() &&
+             buffer_ptr->WaitUntil(100, &progress_row_cache);
+  });
+  buffer_ptr->SetFrameState(kFrameStateParsed);
+  for (int row = 0; row <= 100; ++row) {
+    buffer_ptr->SetProgress(row);
+  }
+  waiter.join();
+  EXPECT_TRUE(waited);
+  EXPECT_GE(progress_row_cache, 100);
+
+  // Abort() wakes up a blocked thread and makes the wait fail.
+  waited = true;
+  std::thread decoded_waiter(
+      [&]() { waited = buffer_ptr->WaitUntilDecoded(); });
+  buffer_ptr->Abort();
+  decoded_waiter.join();
+  EXPECT_FALSE(waited);
+}
+
 constexpr struct Params {
   int width;
   int height;
@@ -42,6 +42,14 @@ Libgav1StatusCode Libgav1DecoderCreate(const Libgav1DecoderSettings* settings,
   cxx_settings.operating_point = settings->operating_point;
   cxx_settings.post_filter_mask = settings->post_filter_mask;
   cxx_settings.parse_only = settings->parse_only != 0;
+  cxx_settings.executor_schedule = settings->executor_schedule;
+  cxx_settings.executor_private_data = settings->executor_private_data;
+  cxx_settings.adaptive_threading = settings->adaptive_threading != 0;
+  cxx_settings.thread_affinity = settings->thread_affinity;
+  cxx_settings.affinity_cpus = settings->affinity_cpus;
+  cxx_settings.num_affinity_cpus = settings->num_affinity_cpus;
+  cxx_settings.max_memory_bytes = settings->max_memory_bytes;
+  cxx_settings.on_frame_ready = settings->on_frame_ready;
 
   const Libgav1StatusCode status = cxx_decoder->Init(&cxx_settings);
   if (status == kLibgav1StatusOk) {
@@ -75,6 +83,31 @@ Libgav1StatusCode Libgav1DecoderSignalEOS(Libgav1Decoder* decoder) {
   return cxx_decoder->SignalEOS();
 }
 
+Libgav1StatusCode Libgav1DecoderReset(Libgav1Decoder* decoder) {
+  auto* cxx_decoder = reinterpret_cast<libgav1::Decoder*>(decoder);
+  return cxx_decoder->Reset();
+}
+
+Libgav1StatusCode Libgav1DecoderPrewarm(Libgav1Decoder* decoder, int max_width,
+                                        int max_height, int bitdepth,
+                                        Libgav1ImageFormat image_format,
+                                        int frame_parallel_depth) {
+  auto* cxx_decoder = reinterpret_cast<libgav1::Decoder*>(decoder);
+  return cxx_decoder->Prewarm(max_width, max_height, bitdepth, image_format,
+                              frame_parallel_depth);
+}
+
+Libgav1StatusCode Libgav1DecoderGetMemoryUsage(const Libgav1Decoder* decoder,
+                                               Libgav1MemoryUsage* usage) {
+  const auto* cxx_decoder = reinterpret_cast<const libgav1::Decoder*>(decoder);
+  return cxx_decoder->GetMemoryUsage(usage);
+}
+
+Libgav1StatusCode Libgav1DecoderTrimMemory(Libgav1Decoder* decoder) {
+  auto* cxx_decoder = reinterpret_cast<libgav1::Decoder*>(decoder);
+  return cxx_decoder->TrimMemory();
+}
+
 int Libgav1DecoderGetMaxBitdepth() {
   return libgav1::Decoder::GetMaxBitdepth();
 }
@@ -90,6 +123,17 @@ Decoder::~Decoder() = default;
 StatusCode Decoder::Init(const DecoderSettings* const settings) {
   if (impl_ != nullptr) return kStatusAlready;
   if (settings != nullptr) settings_ = *settings;
+  // The application may free |settings->affinity_cpus| after this call, but
+  // the decoder is created again by SignalEOS(). Keep a copy of the CPUs.
+  affinity_cpus_.clear();
+  if (settings_.affinity_cpus != nullptr && settings_.num_affinity_cpus > 0) {
+    affinity_cpus_.assign(
+        settings_.affinity_cpus,
+        settings_.affinity_cpus + settings_.num_affinity_cpus);
+    settings_.affinity_cpus = affinity_cpus_.data();
+  } else {
+    settings_.affinity_cpus = nullptr;
+  }
   return DecoderImpl::Create(&settings_, &impl_);
 }
 
@@ -97,12 +141,18 @@ StatusCode Decoder::EnqueueFrame(const uint8_t* data, const size_t size,
                                  int64_t user_private_data,
                                  void* buffer_private_data) {
   if (impl_ == nullptr) return kStatusNotInitialized;
-  return impl_->EnqueueFrame(data, size, user_private_data,
-                             buffer_private_data);
+  const StatusCode status = impl_->EnqueueFrame(data, size, user_private_data,
+                                                buffer_private_data);
+  // The frames have been decoded by the EnqueueFrame() call.
+  if (settings_.on_frame_ready != nullptr && settings_.parse_only) {
+    frame_mean_qps_ = impl_->GetFrameQps();
+  }
+  return status;
 }
 
 StatusCode Decoder::DequeueFrame(const DecoderBuffer** out_ptr) {
   if (impl_ == nullptr) return kStatusNotInitialized;
+  if (settings_.on_frame_ready != nullptr) return kStatusInvalidArgument;
   StatusCode status = impl_->DequeueFrame(out_ptr);
   if (settings_.parse_only) {
     frame_mean_qps_ = impl_->GetFrameQps();
@@ -112,16 +162,56 @@ StatusCode Decoder::DequeueFrame(const DecoderBuffer** out_ptr) {
 
 StatusCode Decoder::SignalEOS() {
   if (impl_ == nullptr) return kStatusNotInitialized;
+  if (settings_.on_frame_ready != nullptr) impl_->WaitForPendingFrames();
   // In non-frame-parallel mode, we have to release all the references. This
   // simply means replacing the |impl_| with a new instance so that all the
   // existing references are released and the state is cleared.
+  return RecreateImpl();
+}
+
+StatusCode Decoder::Reset() {
+  if (impl_ == nullptr) return kStatusNotInitialized;
+  frame_mean_qps_.clear();
+  if (impl_->Reset() == kStatusOk) return kStatusOk;
+  // |impl_| cannot be used after a decoding error. Start over with a new
+  // instance.
+  return RecreateImpl();
+}
+
+StatusCode Decoder::Prewarm(int max_width, int max_height, int bitdepth,
+                            ImageFormat image_format,
+                            int frame_parallel_depth) {
+  if (impl_ == nullptr) return kStatusNotInitialized;
+  return impl_->Prewarm(max_width, max_height, bitdepth, image_format,
+                        frame_parallel_depth);
+}
+
+StatusCode Decoder::RecreateImpl() {
+  // The peaks are kept across the coded video sequences.
+  MemoryUsage usage;
+  impl_->GetMemoryUsage(&usage);
   impl_ = nullptr;
-  return DecoderImpl::Create(&settings_, &impl_);
+  const StatusCode status = DecoderImpl::Create(&settings_, &impl_);
+  if (status == kStatusOk) impl_->RecordPeakMemoryUsage(usage);
+  return status;
 }
 
 // static.
 int Decoder::GetMaxBitdepth() { return DecoderImpl::GetMaxBitdepth(); }
 
+StatusCode Decoder::GetMemoryUsage(MemoryUsage* const usage) const {
+  if (impl_ == nullptr) return kStatusNotInitialized;
+  if (usage == nullptr) return kStatusInvalidArgument;
+  impl_->GetMemoryUsage(usage);
+  return kStatusOk;
+}
+
+StatusCode Decoder::TrimMemory() {
+  if (impl_ == nullptr) return kStatusNotInitialized;
+  impl_->TrimMemory();
+  return kStatusOk;
+}
+
 std::vector<int> Decoder::GetFramesMeanQpInTemporalUnit() {
   return frame_mean_qps_;
 }
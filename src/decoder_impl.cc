@@ -18,7 +18,9 @@
 #include <atomic>
 #include <cassert>
 #include <cmath>
+#include <functional>
 #include <iterator>
+#include <memory>
 #include <new>
 #include <utility>
 #include <vector>
@@ -37,6 +39,7 @@
 #include "src/utils/blocking_counter.h"
 #include "src/utils/common.h"
 #include "src/utils/constants.h"
+#include "src/utils/cpu_affinity.h"
 #include "src/utils/logging.h"
 #include "src/utils/raw_bit_reader.h"
 #include "src/utils/segmentation.h"
@@ -49,6 +52,36 @@ namespace {
 constexpr int kMaxBlockWidth4x4 = 32;
 constexpr int kMaxBlockHeight4x4 = 32;
 
+// An Executor that hands the scheduled callbacks to the application through
+// the executor_schedule setting.
+class CallbackExecutor : public Executor, public Allocable {
+ public:
+  CallbackExecutor(ExecutorScheduleCallback schedule, void* private_data)
+      : schedule_(schedule), private_data_(private_data) {}
+
+  void Schedule(std::function<void()> callback) override {
+    std::unique_ptr<std::function<void()>> task(new (std::nothrow)
+                                                    std::function<void()>());
+    if (task == nullptr) {
+      // Out of memory. Run |callback| directly.
+      callback();
+      return;
+    }
+    *task = std::move(callback);
+    schedule_(private_data_, RunTask, task.release());
+  }
+
+ private:
+  static void RunTask(void* task_data) {
+    std::unique_ptr<std::function<void()>> task(
+        static_cast<std::function<void()>*>(task_data));
+    (*task)();
+  }
+
+  const ExecutorScheduleCallback schedule_;
+  void* const private_data_;
+};
+
 // Computes the bottom border size in pixels. If CDEF, loop restoration or
 // SuperRes is enabled, adds extra border pixels to facilitate those steps to
 // happen nearly in-place (a few extra rows instead of an entire frame buffer).
@@ -128,7 +161,7 @@ void SetSegmentationMap(const ObuFrameHeader& frame_header,
 StatusCode DecodeTilesNonFrameParallel(
     const ObuSequenceHeader& sequence_header,
     const ObuFrameHeader& frame_header,
-    const Vector<std::unique_ptr<Tile>>& tiles,
+    const Vector<ArenaUniquePtr<Tile>>& tiles,
     FrameScratchBuffer* const frame_scratch_buffer,
     PostFilter* const post_filter) {
   // Decode in superblock row order.
@@ -154,7 +187,7 @@ StatusCode DecodeTilesNonFrameParallel(
 }
 
 StatusCode DecodeTilesThreadedNonFrameParallel(
-    const Vector<std::unique_ptr<Tile>>& tiles,
+    const Vector<ArenaUniquePtr<Tile>>& tiles,
     FrameScratchBuffer* const frame_scratch_buffer,
     PostFilter* const post_filter,
     BlockingCounterWithStatus* const pending_tiles) {
@@ -165,6 +198,8 @@ StatusCode DecodeTilesThreadedNonFrameParallel(
   std::atomic<int> tile_counter(0);
   const int tile_count = static_cast<int>(tiles.size());
   bool tile_decoding_failed = false;
+  // Filter the superblock rows as soon as they are decoded if possible.
+  const bool filter_with_decoding = post_filter->StartFilteringWithDecoding();
   // Submit tile decoding jobs to the thread pool.
   for (int i = 0; i < num_workers; ++i) {
     threading_strategy.tile_thread_pool()->Schedule([&tiles, tile_count,
@@ -209,11 +244,17 @@ StatusCode DecodeTilesThreadedNonFrameParallel(
   tile_decoding_failed |= !pending_tiles->Wait();
   if (tile_decoding_failed) return kStatusUnknownError;
   assert(threading_strategy.post_filter_thread_pool() != nullptr);
-  post_filter->ApplyFilteringThreaded();
+  const ScopedStageTimer stage_timer(&threading_strategy,
+                                     ThreadingStrategy::kStagePostFilter);
+  if (filter_with_decoding) {
+    post_filter->FinishFilteringWithDecoding();
+  } else {
+    post_filter->ApplyFilteringThreaded();
+  }
   return kStatusOk;
 }
 
-StatusCode ParseTiles(const Vector<std::unique_ptr<Tile>>& tiles) {
+StatusCode ParseTiles(const Vector<ArenaUniquePtr<Tile>>& tiles) {
   for (const auto& tile : tiles) {
     if (!tile->Parse()) {
       LIBGAV1_DLOG(ERROR, "Failed to parse tile number: %d\n", tile->number());
@@ -226,7 +267,7 @@ StatusCode ParseTiles(const Vector<std::unique_ptr<Tile>>& tiles) {
 StatusCode DecodeTilesFrameParallel(
     const ObuSequenceHeader& sequence_header,
     const ObuFrameHeader& frame_header,
-    const Vector<std::unique_ptr<Tile>>& tiles,
+    const Vector<ArenaUniquePtr<Tile>>& tiles,
     const SymbolDecoderContext& saved_symbol_decoder_context,
     const SegmentationMap* const prev_segment_ids,
     FrameScratchBuffer* const frame_scratch_buffer,
@@ -277,29 +318,37 @@ StatusCode DecodeTilesFrameParallel(
 // Helper function used by DecodeTilesThreadedFrameParallel. Applies the
 // deblocking filter for tile boundaries for the superblock row at |row4x4|.
 void ApplyDeblockingFilterForTileBoundaries(
-    PostFilter* const post_filter, const std::unique_ptr<Tile>* tile_row_base,
+    PostFilter* const post_filter, const ArenaUniquePtr<Tile>* tile_row_base,
     const ObuFrameHeader& frame_header, int row4x4, int block_width4x4,
     int tile_columns, bool decode_entire_tiles_in_worker_threads) {
+  // The column ranges to be filtered are collected so that PostFilter can
+  // filter them concurrently.
+  int column4x4_start[kMaxTileColumns + 1];
+  int column4x4_end[kMaxTileColumns + 1];
   // Apply vertical deblock filtering for the first 64 columns of each tile.
   for (int tile_column = 0; tile_column < tile_columns; ++tile_column) {
     const Tile& tile = *tile_row_base[tile_column];
-    post_filter->ApplyDeblockFilter(
-        kLoopFilterTypeVertical, row4x4, tile.column4x4_start(),
-        tile.column4x4_start() + kNum4x4InLoopFilterUnit, block_width4x4);
-  }
+    column4x4_start[tile_column] = tile.column4x4_start();
+    column4x4_end[tile_column] =
+        tile.column4x4_start() + kNum4x4InLoopFilterUnit;
+  }
+  post_filter->ApplyDeblockFilter(kLoopFilterTypeVertical, row4x4,
+                                  column4x4_start, column4x4_end, tile_columns,
+                                  block_width4x4);
+  int num_ranges = 0;
   if (decode_entire_tiles_in_worker_threads &&
       row4x4 == tile_row_base[0]->row4x4_start()) {
     // This is the first superblock row of a tile row. In this case, apply
     // horizontal deblock filtering for the entire superblock row.
-    post_filter->ApplyDeblockFilter(kLoopFilterTypeHorizontal, row4x4, 0,
-                                    frame_header.columns4x4, block_width4x4);
+    column4x4_start[num_ranges] = 0;
+    column4x4_end[num_ranges++] = frame_header.columns4x4;
   } else {
     // Apply horizontal deblock filtering for the first 64 columns of the
     // first tile.
     const Tile& first_tile = *tile_row_base[0];
-    post_filter->ApplyDeblockFilter(
-        kLoopFilterTypeHorizontal, row4x4, first_tile.column4x4_start(),
-        first_tile.column4x4_start() + kNum4x4InLoopFilterUnit, block_width4x4);
+    column4x4_start[num_ranges] = first_tile.column4x4_start();
+    column4x4_end[num_ranges++] =
+        first_tile.column4x4_start() + kNum4x4InLoopFilterUnit;
     // Apply horizontal deblock filtering for the last 64 columns of the
     // previous tile and the first 64 columns of the current tile.
     for (int tile_column = 1; tile_column < tile_columns; ++tile_column) {
@@ -307,15 +356,14 @@ void ApplyDeblockingFilterForTileBoundaries(
       // If the previous tile has more than 64 columns, then include those
       // for the horizontal deblock.
       const Tile& previous_tile = *tile_row_base[tile_column - 1];
-      const int column4x4_start =
+      column4x4_start[num_ranges] =
           tile.column4x4_start() -
           ((tile.column4x4_start() - kNum4x4InLoopFilterUnit !=
             previous_tile.column4x4_start())
                ? kNum4x4InLoopFilterUnit
                : 0);
-      post_filter->ApplyDeblockFilter(
-          kLoopFilterTypeHorizontal, row4x4, column4x4_start,
-          tile.column4x4_start() + kNum4x4InLoopFilterUnit, block_width4x4);
+      column4x4_end[num_ranges++] =
+          tile.column4x4_start() + kNum4x4InLoopFilterUnit;
     }
     // Apply horizontal deblock filtering for the last 64 columns of the
     // last tile.
@@ -323,16 +371,18 @@ void ApplyDeblockingFilterForTileBoundaries(
     // Identify the last column4x4 value and do horizontal filtering for
     // that column4x4. The value of last column4x4 is the nearest multiple
     // of 16 that is before tile.column4x4_end().
-    const int column4x4_start = (last_tile.column4x4_end() - 1) & ~15;
-    // If column4x4_start is the same as tile.column4x4_start() then it
+    const int last_column4x4_start = (last_tile.column4x4_end() - 1) & ~15;
+    // If last_column4x4_start is the same as tile.column4x4_start() then it
     // means that the last tile has <= 64 columns. So there is nothing left
     // to deblock (since it was already deblocked in the loop above).
-    if (column4x4_start != last_tile.column4x4_start()) {
-      post_filter->ApplyDeblockFilter(
-          kLoopFilterTypeHorizontal, row4x4, column4x4_start,
-          last_tile.column4x4_end(), block_width4x4);
+    if (last_column4x4_start != last_tile.column4x4_start()) {
+      column4x4_start[num_ranges] = last_column4x4_start;
+      column4x4_end[num_ranges++] = last_tile.column4x4_end();
     }
   }
+  post_filter->ApplyDeblockFilter(kLoopFilterTypeHorizontal, row4x4,
+                                  column4x4_start, column4x4_end, num_ranges,
+                                  block_width4x4);
 }
 
 // Helper function used by DecodeTilesThreadedFrameParallel. Decodes the
@@ -345,7 +395,7 @@ void ApplyDeblockingFilterForTileBoundaries(
 //   * If an entire superblock row of the frame has been decoded, it notifies
 //     the waiters (if there are any).
 void DecodeSuperBlockRowInTile(
-    const Vector<std::unique_ptr<Tile>>& tiles, size_t tile_index, int row4x4,
+    const Vector<ArenaUniquePtr<Tile>>& tiles, size_t tile_index, int row4x4,
     const int superblock_size4x4, const int tile_columns,
     const int superblock_rows, FrameScratchBuffer* const frame_scratch_buffer,
     PostFilter* const post_filter, BlockingCounter* const pending_jobs) {
@@ -421,7 +471,7 @@ void DecodeSuperBlockRowInTile(
 StatusCode DecodeTilesThreadedFrameParallel(
     const ObuSequenceHeader& sequence_header,
     const ObuFrameHeader& frame_header,
-    const Vector<std::unique_ptr<Tile>>& tiles,
+    const Vector<ArenaUniquePtr<Tile>>& tiles,
     const SymbolDecoderContext& saved_symbol_decoder_context,
     const SegmentationMap* const prev_segment_ids,
     FrameScratchBuffer* const frame_scratch_buffer,
@@ -541,7 +591,7 @@ StatusCode DecodeTilesThreadedFrameParallel(
   // Current thread will do the post filters.
   std::condition_variable* const superblock_row_progress_condvar =
       frame_scratch_buffer->superblock_row_progress_condvar.get();
-  const std::unique_ptr<Tile>* tile_row_base = &tiles[0];
+  const ArenaUniquePtr<Tile>* tile_row_base = &tiles[0];
   for (int row4x4 = 0, index = 0; row4x4 < frame_header.rows4x4;
        row4x4 += block_width4x4, ++index) {
     if (!tile_row_base[0]->IsRow4x4Inside(row4x4)) {
@@ -588,7 +638,7 @@ StatusCode DecodeTilesThreadedFrameParallel(
   return kStatusOk;
 }
 
-int CalcFrameMeanQp(const Vector<std::unique_ptr<Tile>>& tiles) {
+int CalcFrameMeanQp(const Vector<ArenaUniquePtr<Tile>>& tiles) {
   int cumulative_frame_qp = 0;
   for (const auto& tile : tiles) {
     cumulative_frame_qp += tile->GetTileMeanQP();
@@ -629,11 +679,45 @@ StatusCode DecoderImpl::Create(const DecoderSettings* settings,
         "the frame_parallel option cannot be used in the parse_only mode.");
     return kStatusInvalidArgument;
   }
+  if (settings->thread_affinity != kThreadAffinityNone &&
+      settings->thread_affinity != kThreadAffinityCpuSet &&
+      settings->thread_affinity != kThreadAffinityCompactPerNode) {
+    LIBGAV1_DLOG(ERROR, "Invalid settings->thread_affinity: %d.",
+                 settings->thread_affinity);
+    return kStatusInvalidArgument;
+  }
+  if (settings->thread_affinity == kThreadAffinityCpuSet &&
+      (settings->affinity_cpus == nullptr ||
+       settings->num_affinity_cpus <= 0)) {
+    LIBGAV1_DLOG(ERROR,
+                 "affinity_cpus must not be empty when thread_affinity is "
+                 "kThreadAffinityCpuSet.");
+    return kStatusInvalidArgument;
+  }
   std::unique_ptr<DecoderImpl> impl(new (std::nothrow) DecoderImpl(settings));
   if (impl == nullptr) {
     LIBGAV1_DLOG(ERROR, "Failed to allocate DecoderImpl.");
     return kStatusOutOfMemory;
   }
+  if (settings->thread_affinity != kThreadAffinityNone &&
+      settings->executor_schedule == nullptr) {
+    CpuSet cpus;
+    for (int i = 0; i < settings->num_affinity_cpus; ++i) {
+      cpus.Add(settings->affinity_cpus[i]);
+    }
+    // Without a topology, the threads are simply not restricted.
+    NumaTopology topology;
+    GetNumaTopology(&topology);
+    impl->thread_placement_.Init(settings->thread_affinity, cpus, topology);
+  }
+  if (settings->executor_schedule != nullptr) {
+    impl->executor_.reset(new (std::nothrow) CallbackExecutor(
+        settings->executor_schedule, settings->executor_private_data));
+    if (impl->executor_ == nullptr) {
+      LIBGAV1_DLOG(ERROR, "Failed to allocate CallbackExecutor.");
+      return kStatusOutOfMemory;
+    }
+  }
   const StatusCode status = impl->Init();
   if (status != kStatusOk) return status;
   *output = std::move(impl);
@@ -644,8 +728,11 @@ DecoderImpl::DecoderImpl(const DecoderSettings* settings)
     : buffer_pool_(settings->on_frame_buffer_size_changed,
                    settings->get_frame_buffer, settings->release_frame_buffer,
                    settings->callback_private_data),
-      settings_(*settings) {
+      settings_(*settings),
+      threads_(settings->threads) {
   dsp::DspInit();
+  buffer_pool_.SetMemoryTracker(&memory_tracker_);
+  frame_scratch_buffer_pool_.set_memory_tracker(&memory_tracker_);
 }
 
 DecoderImpl::~DecoderImpl() {
@@ -672,7 +759,10 @@ StatusCode DecoderImpl::Init() {
 StatusCode DecoderImpl::InitializeFrameThreadPoolAndTemporalUnitQueue(
     const uint8_t* data, size_t size) {
   is_frame_parallel_ = false;
-  if (settings_.frame_parallel) {
+  // Frame threads wait on each other, which is not safe on an executor that
+  // may be shared with other decoders.
+  const bool frame_parallel = settings_.frame_parallel && executor_ == nullptr;
+  if (frame_parallel || settings_.max_memory_bytes != 0) {
     DecoderState state;
     std::unique_ptr<ObuParser> obu(new (std::nothrow) ObuParser(
         data, size, settings_.operating_point, &buffer_pool_, &state));
@@ -690,14 +780,39 @@ StatusCode DecoderImpl::InitializeFrameThreadPoolAndTemporalUnitQueue(
     // We assume that the first frame that was parsed will contain the frame
     // header. This assumption is usually true in practice. So we will simply
     // not use frame parallel mode if this is not the case.
-    if (settings_.threads > 1 &&
+    const StatusCode thread_pool_status = InitializeFrameThreadPool(
+        obu->sequence_header(), obu->frame_header(), frame_parallel,
+        kMaxThreads);
+    if (thread_pool_status != kStatusOk) return thread_pool_status;
+  }
+  return InitializeTemporalUnitQueue();
+}
+
+StatusCode DecoderImpl::InitializeFrameThreadPool(
+    const ObuSequenceHeader& sequence_header,
+    const ObuFrameHeader& frame_header, bool frame_parallel,
+    int max_frame_threads) {
+  if (settings_.max_memory_bytes != 0) {
+    max_frame_threads =
+        std::min(max_frame_threads,
+                 ApplyMemoryBudget(sequence_header, frame_header,
+                                   frame_parallel));
+  }
+  if (frame_parallel) {
+    if (threads_ > 1 &&
         !InitializeThreadPoolsForFrameParallel(
-            settings_.threads, obu->frame_header().tile_info.tile_count,
-            obu->frame_header().tile_info.tile_columns, &frame_thread_pool_,
-            &frame_scratch_buffer_pool_)) {
+            threads_, frame_header.tile_info.tile_count,
+            frame_header.tile_info.tile_columns, max_frame_threads,
+            &frame_thread_pool_, &frame_scratch_buffer_pool_,
+            &thread_placement_)) {
       return kStatusOutOfMemory;
     }
+    buffer_pool_.SetMemoryNodes(thread_placement_.memory_nodes());
   }
+  return kStatusOk;
+}
+
+StatusCode DecoderImpl::InitializeTemporalUnitQueue() {
   const int max_allowed_frames =
       (frame_thread_pool_ != nullptr) ? frame_thread_pool_->num_threads() : 1;
   assert(max_allowed_frames > 0);
@@ -709,6 +824,67 @@ StatusCode DecoderImpl::InitializeFrameThreadPoolAndTemporalUnitQueue(
   return kStatusOk;
 }
 
+int DecoderImpl::ApplyMemoryBudget(const ObuSequenceHeader& sequence_header,
+                                   const ObuFrameHeader& frame_header,
+                                   bool frame_parallel) {
+  const ColorConfig& color_config = sequence_header.color_config;
+  // A frame buffer, with the borders that the decoder usually asks for, and
+  // the symbol decoder context saved with it.
+  size_t frame_bytes = sizeof(SymbolDecoderContext);
+  FrameBufferInfo info;
+  if (ComputeFrameBufferInfo(
+          color_config.bitdepth,
+          ComposeImageFormat(color_config.is_monochrome,
+                             color_config.subsampling_x,
+                             color_config.subsampling_y),
+          frame_header.upscaled_width, frame_header.height, kBorderPixels,
+          kBorderPixels, kBorderPixels, kBorderPixels, /*stride_alignment=*/16,
+          &info) == kStatusOk) {
+    frame_bytes += info.y_buffer_size + 2 * info.uv_buffer_size;
+  }
+  // The state of a frame being decoded. Per 4x4 block, there are two
+  // BlockParameters pointers in BlockParametersHolder and, assuming that the
+  // blocks are 16x16 on average, a sixteenth of a BlockParameters object.
+  const size_t frame_state_bytes =
+      sizeof(FrameScratchBuffer) +
+      static_cast<size_t>(frame_header.rows4x4) * frame_header.columns4x4 *
+          (2 * sizeof(BlockParameters*) + sizeof(BlockParameters) / 16) +
+      frame_header.tile_info.tile_count *
+          Tile::ArenaSize(sequence_header, frame_header);
+  // The buffers of a tile thread: a TileScratchBuffer and the residuals of one
+  // superblock.
+  const int superblock_size = sequence_header.use_128x128_superblock ? 128 : 64;
+  const size_t thread_bytes =
+      TileScratchBuffer::AllocatedSize(color_config.bitdepth) +
+      superblock_size * superblock_size * kMaxPlanes *
+          ((color_config.bitdepth == 8) ? sizeof(int16_t) : sizeof(int32_t));
+  // The reference frames and one frame being decoded are always needed.
+  const size_t base_bytes =
+      (kNumReferenceFrameTypes + 1) * frame_bytes + frame_state_bytes;
+  if (base_bytes >= settings_.max_memory_bytes) {
+    LIBGAV1_DLOG(INFO,
+                 "The memory budget is too small, using a single thread.");
+    threads_ = 1;
+    return 1;
+  }
+  size_t available_bytes = settings_.max_memory_bytes - base_bytes;
+  int frame_threads = 1;
+  if (frame_parallel) {
+    // Each additional frame in flight needs its own frame buffer and state.
+    const size_t max_frames =
+        1 + available_bytes / (frame_bytes + frame_state_bytes);
+    frame_threads = static_cast<int>(
+        std::min(max_frames, static_cast<size_t>(std::max(threads_, 1))));
+    available_bytes -= (frame_threads - 1) * (frame_bytes + frame_state_bytes);
+  }
+  const size_t max_threads = std::max(
+      static_cast<size_t>(frame_threads), available_bytes / thread_bytes);
+  if (max_threads < static_cast<size_t>(threads_)) {
+    threads_ = static_cast<int>(max_threads);
+  }
+  return frame_threads;
+}
+
 StatusCode DecoderImpl::EnqueueFrame(const uint8_t* data, size_t size,
                                      int64_t user_private_data,
                                      void* buffer_private_data) {
@@ -722,8 +898,12 @@ StatusCode DecoderImpl::EnqueueFrame(const uint8_t* data, size_t size,
       return SignalFailure(status);
     }
   }
-  if (temporal_units_.Full()) {
-    return kStatusTryAgain;
+  {
+    // The frame threads may be removing elements from |temporal_units_|.
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (temporal_units_.Full()) {
+      return kStatusTryAgain;
+    }
   }
   if (is_frame_parallel_) {
     return ParseAndSchedule(data, size, user_private_data, buffer_private_data);
@@ -731,6 +911,7 @@ StatusCode DecoderImpl::EnqueueFrame(const uint8_t* data, size_t size,
   TemporalUnit temporal_unit(data, size, user_private_data,
                              buffer_private_data);
   temporal_units_.Push(std::move(temporal_unit));
+  if (settings_.on_frame_ready != nullptr) return DecodeAndOutputFrames();
   return kStatusOk;
 }
 
@@ -799,6 +980,7 @@ StatusCode DecoderImpl::DequeueFrame(const DecoderBuffer** out_ptr) {
       output_frame_queue_.Clear();
     }
     if (settings_.release_input_buffer != nullptr) {
+      temporal_unit.released_input_buffer = true;
       settings_.release_input_buffer(settings_.callback_private_data,
                                      temporal_unit.buffer_private_data);
     }
@@ -856,6 +1038,207 @@ StatusCode DecoderImpl::DequeueFrame(const DecoderBuffer** out_ptr) {
   return kStatusOk;
 }
 
+void DecoderImpl::WaitForPendingFrames() {
+  // In non frame parallel mode, the frames are output by EnqueueFrame().
+  if (!is_frame_parallel_) return;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!temporal_units_.Empty() && failure_status_ == kStatusOk) {
+    decoded_condvar_.wait(lock);
+  }
+}
+
+StatusCode DecoderImpl::Reset() {
+  if (HasFailure()) return kStatusUnknownError;
+  if (settings_.on_frame_ready != nullptr) {
+    WaitForPendingFrames();
+    if (HasFailure()) return kStatusUnknownError;
+  }
+  while (!temporal_units_.Empty()) {
+    TemporalUnit& temporal_unit = temporal_units_.Front();
+    if (is_frame_parallel_) {
+      // The frame threads may still be decoding |temporal_unit| and they may
+      // refer to the reference frames in |state_|.
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (!temporal_unit.decoded && failure_status_ == kStatusOk) {
+        decoded_condvar_.wait(lock);
+      }
+      if (failure_status_ != kStatusOk) {
+        const StatusCode failure_status = failure_status_;
+        lock.unlock();
+        return SignalFailure(failure_status);
+      }
+    }
+    if (settings_.release_input_buffer != nullptr &&
+        !temporal_unit.released_input_buffer) {
+      temporal_unit.released_input_buffer = true;
+      settings_.release_input_buffer(settings_.callback_private_data,
+                                     temporal_unit.buffer_private_data);
+    }
+    temporal_units_.Pop();
+  }
+  ReleaseOutputFrame();
+  output_frame_queue_.Clear();
+  state_ = DecoderState();
+  sequence_header_ = {};
+  has_sequence_header_ = false;
+  frame_mean_qps_.clear();
+  frame_mean_qp_ = 0;
+  return kStatusOk;
+}
+
+StatusCode DecoderImpl::Prewarm(int max_width, int max_height, int bitdepth,
+                                ImageFormat image_format,
+                                int frame_parallel_depth) {
+  // The frame dimensions are coded with at most 16 bits.
+  if (max_width <= 0 || max_width > 65536 || max_height <= 0 ||
+      max_height > 65536 ||
+      (bitdepth != 8 && bitdepth != 10 && bitdepth != 12) ||
+      bitdepth > GetMaxBitdepth() || image_format < kImageFormatYuv420 ||
+      image_format > kImageFormatMonochrome400 || frame_parallel_depth < 0) {
+    return kStatusInvalidArgument;
+  }
+  if (HasFailure()) return kStatusUnknownError;
+  {
+    // The frames that are being decoded may be using the buffers.
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!temporal_units_.Empty()) return kStatusTryAgain;
+  }
+
+  ObuSequenceHeader sequence_header = {};
+  sequence_header.max_frame_width = max_width;
+  sequence_header.max_frame_height = max_height;
+  ColorConfig& color_config = sequence_header.color_config;
+  color_config.bitdepth = bitdepth;
+  DecomposeImageFormat(image_format, &color_config.is_monochrome,
+                       &color_config.subsampling_x,
+                       &color_config.subsampling_y);
+  // A key frame of the maximum size that uses all the tools whose buffers
+  // depend on the frame size, except for superres. The smallest loop
+  // restoration units are used.
+  ObuFrameHeader frame_header = {};
+  frame_header.frame_type = kFrameKey;
+  frame_header.width = max_width;
+  frame_header.upscaled_width = max_width;
+  frame_header.height = max_height;
+  frame_header.columns4x4 = ((max_width + 7) >> 3) << 1;
+  frame_header.rows4x4 = ((max_height + 7) >> 3) << 1;
+  frame_header.tile_info.tile_count = 1;
+  frame_header.tile_info.tile_rows = 1;
+  frame_header.tile_info.tile_columns = 1;
+  frame_header.cdef.bits = 3;
+  frame_header.use_ref_frame_mvs = true;
+  for (int plane = kPlaneY; plane < kMaxPlanes; ++plane) {
+    frame_header.loop_restoration.type[plane] = kLoopRestorationTypeSwitchable;
+    frame_header.loop_restoration.unit_size_log2[plane] =
+        (plane != kPlaneY && color_config.subsampling_x != 0 &&
+         color_config.subsampling_y != 0)
+            ? 5
+            : 6;
+  }
+
+  if (!seen_first_frame_) {
+    seen_first_frame_ = true;
+    is_frame_parallel_ = false;
+    const bool frame_parallel =
+        settings_.frame_parallel && executor_ == nullptr;
+    StatusCode status = InitializeFrameThreadPool(
+        sequence_header, frame_header, frame_parallel,
+        (frame_parallel_depth == 0) ? static_cast<int>(kMaxThreads)
+                                    : frame_parallel_depth);
+    if (status == kStatusOk) status = InitializeTemporalUnitQueue();
+    if (status != kStatusOk) return SignalFailure(status);
+  }
+
+  // Get all the frame scratch buffers that may be in use at once, so that the
+  // pool does not hand out the same one twice.
+  const int max_frames_in_flight =
+      is_frame_parallel_ ? frame_thread_pool_->num_threads() : 1;
+  Vector<std::unique_ptr<FrameScratchBuffer>> frame_scratch_buffers;
+  if (!frame_scratch_buffers.reserve(max_frames_in_flight)) {
+    return kStatusOutOfMemory;
+  }
+  StatusCode status = kStatusOk;
+  for (int i = 0; i < max_frames_in_flight && status == kStatusOk; ++i) {
+    std::unique_ptr<FrameScratchBuffer> frame_scratch_buffer =
+        frame_scratch_buffer_pool_.Get();
+    if (frame_scratch_buffer == nullptr) {
+      status = kStatusOutOfMemory;
+      break;
+    }
+    status = AllocateFrameScratchBuffer(sequence_header, frame_header,
+                                        frame_scratch_buffer.get());
+    if (status == kStatusOk) {
+      // One tile scratch buffer for each thread that decodes this frame.
+      const ThreadPool* const thread_pool =
+          frame_scratch_buffer->threading_strategy.thread_pool();
+      const int num_tile_scratch_buffers =
+          1 + ((thread_pool != nullptr) ? thread_pool->num_threads() : 0);
+      TileScratchBufferPool& tile_scratch_buffer_pool =
+          frame_scratch_buffer->tile_scratch_buffer_pool;
+      Vector<std::unique_ptr<TileScratchBuffer>> tile_scratch_buffers;
+      if (!tile_scratch_buffers.reserve(num_tile_scratch_buffers)) {
+        status = kStatusOutOfMemory;
+      }
+      for (int j = 0; j < num_tile_scratch_buffers && status == kStatusOk;
+           ++j) {
+        std::unique_ptr<TileScratchBuffer> tile_scratch_buffer =
+            tile_scratch_buffer_pool.Get();
+        if (tile_scratch_buffer == nullptr) {
+          status = kStatusOutOfMemory;
+          break;
+        }
+        tile_scratch_buffers.push_back_unchecked(
+            std::move(tile_scratch_buffer));
+      }
+      for (auto& tile_scratch_buffer : tile_scratch_buffers) {
+        tile_scratch_buffer_pool.Release(std::move(tile_scratch_buffer));
+      }
+    }
+    frame_scratch_buffers.push_back_unchecked(std::move(frame_scratch_buffer));
+  }
+  // Release the frame scratch buffers in reverse order so that they keep their
+  // order in the pool.
+  for (int i = static_cast<int>(frame_scratch_buffers.size()) - 1; i >= 0;
+       --i) {
+    frame_scratch_buffer_pool_.Release(std::move(frame_scratch_buffers[i]));
+  }
+  if (status != kStatusOk) return status;
+
+  const int max_bottom_border = GetBottomBorderPixels(
+      /*do_cdef=*/true, /*do_restoration=*/true,
+      /*do_superres=*/true, color_config.subsampling_y);
+  if (!buffer_pool_.OnFrameBufferSizeChanged(
+          bitdepth, image_format, max_width, max_height, kBorderPixels,
+          kBorderPixels, kBorderPixels, max_bottom_border)) {
+    LIBGAV1_DLOG(ERROR, "buffer_pool_.OnFrameBufferSizeChanged failed.");
+    return kStatusUnknownError;
+  }
+  // The reference frames and the frames that are being decoded. The buffers
+  // go back to the pool when |frame_buffers| is destroyed.
+  const int num_frame_buffers = kNumReferenceFrameTypes + max_frames_in_flight;
+  Vector<RefCountedBufferPtr> frame_buffers;
+  if (!frame_buffers.reserve(num_frame_buffers)) return kStatusOutOfMemory;
+  for (int i = 0; i < num_frame_buffers; ++i) {
+    RefCountedBufferPtr frame_buffer = buffer_pool_.GetFreeBuffer();
+    if (frame_buffer == nullptr) {
+      LIBGAV1_DLOG(ERROR, "Could not get a frame buffer from the buffer pool.");
+      return kStatusResourceExhausted;
+    }
+    if (!frame_buffer->Realloc(bitdepth, color_config.is_monochrome, max_width,
+                               max_height, color_config.subsampling_x,
+                               color_config.subsampling_y,
+                               /*left_border=*/kBorderPixels,
+                               /*right_border=*/kBorderPixels,
+                               /*top_border=*/kBorderPixels,
+                               max_bottom_border)) {
+      LIBGAV1_DLOG(ERROR, "Failed to allocate memory for a frame buffer.");
+      return kStatusOutOfMemory;
+    }
+    frame_buffers.push_back_unchecked(std::move(frame_buffer));
+  }
+  return kStatusOk;
+}
+
 std::vector<int> DecoderImpl::GetFrameQps() { return frame_mean_qps_; }
 
 StatusCode DecoderImpl::ParseAndSchedule(const uint8_t* data, size_t size,
@@ -925,53 +1308,124 @@ StatusCode DecoderImpl::ParseAndSchedule(const uint8_t* data, size_t size,
     state_.UpdateReferenceFrames(current_frame,
                                  obu->frame_header().refresh_frame_flags);
   }
+  temporal_unit.color_config = sequence_header_.color_config;
   // This function cannot fail after this point. So it is okay to move the
   // |temporal_unit| into |temporal_units_| queue.
-  temporal_units_.Push(std::move(temporal_unit));
-  if (temporal_units_.Back().frames.empty()) {
+  TemporalUnit* queued_temporal_unit;
+  {
     std::lock_guard<std::mutex> lock(mutex_);
-    temporal_units_.Back().has_displayable_frame = false;
-    temporal_units_.Back().decoded = true;
+    temporal_units_.Push(std::move(temporal_unit));
+    queued_temporal_unit = &temporal_units_.Back();
+  }
+  // Once its last frame is scheduled, |queued_temporal_unit| may be output and
+  // removed from the queue by a frame thread at any time.
+  const size_t num_frames = queued_temporal_unit->frames.size();
+  if (num_frames == 0) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queued_temporal_unit->has_displayable_frame = false;
+      queued_temporal_unit->decoded = true;
+    }
+    if (settings_.on_frame_ready != nullptr) OutputDecodedFrames();
     return kStatusOk;
   }
-  for (auto& frame : temporal_units_.Back().frames) {
-    EncodedFrame* const encoded_frame = &frame;
-    encoded_frame->temporal_unit = &temporal_units_.Back();
+  for (size_t i = 0; i < num_frames; ++i) {
+    EncodedFrame* const encoded_frame = &queued_temporal_unit->frames[i];
+    encoded_frame->temporal_unit = queued_temporal_unit;
+    // The frame threads are shared by all the frames in flight. The other
+    // frames wait on the progress of the reference frames, so these are
+    // decoded first. A reference frame never waits on a frame that does not
+    // refresh a reference slot, so this cannot cause a deadlock.
+    const ThreadPool::Priority priority =
+        (encoded_frame->frame_header.refresh_frame_flags != 0)
+            ? ThreadPool::Priority::kHigh
+            : ThreadPool::Priority::kNormal;
     frame_thread_pool_->Schedule([this, encoded_frame]() {
       if (HasFailure()) return;
       const StatusCode status = DecodeFrame(encoded_frame);
       encoded_frame->state = {};
       encoded_frame->frame = nullptr;
       TemporalUnit& temporal_unit = *encoded_frame->temporal_unit;
-      std::lock_guard<std::mutex> lock(mutex_);
-      if (failure_status_ != kStatusOk) return;
-      // temporal_unit's status defaults to kStatusOk. So we need to set it only
-      // on error. If |failure_status_| is not kStatusOk at this point, it means
-      // that there has already been a failure. So we don't care about this
-      // subsequent failure.  We will simply return the error code of the first
-      // failure.
-      if (status != kStatusOk) {
-        temporal_unit.status = status;
-        if (failure_status_ == kStatusOk) {
-          failure_status_ = status;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (failure_status_ != kStatusOk) return;
+        // temporal_unit's status defaults to kStatusOk. So we need to set it
+        // only on error. If |failure_status_| is not kStatusOk at this point,
+        // it means that there has already been a failure. So we don't care
+        // about this subsequent failure.  We will simply return the error code
+        // of the first failure.
+        if (status != kStatusOk) {
+          temporal_unit.status = status;
+          if (failure_status_ == kStatusOk) {
+            failure_status_ = status;
+          }
+        }
+        temporal_unit.decoded =
+            ++temporal_unit.decoded_count == temporal_unit.frames.size();
+        if (temporal_unit.decoded && settings_.output_all_layers &&
+            temporal_unit.output_layer_count > 1) {
+          std::sort(
+              temporal_unit.output_layers,
+              temporal_unit.output_layers + temporal_unit.output_layer_count);
+        }
+        if (temporal_unit.decoded || failure_status_ != kStatusOk) {
+          decoded_condvar_.notify_one();
         }
       }
-      temporal_unit.decoded =
-          ++temporal_unit.decoded_count == temporal_unit.frames.size();
-      if (temporal_unit.decoded && settings_.output_all_layers &&
-          temporal_unit.output_layer_count > 1) {
-        std::sort(
-            temporal_unit.output_layers,
-            temporal_unit.output_layers + temporal_unit.output_layer_count);
-      }
-      if (temporal_unit.decoded || failure_status_ != kStatusOk) {
-        decoded_condvar_.notify_one();
-      }
-    });
+      if (settings_.on_frame_ready != nullptr) OutputDecodedFrames();
+    }, priority);
   }
   return kStatusOk;
 }
 
+StatusCode DecoderImpl::DecodeAndOutputFrames() {
+  while (!temporal_units_.Empty()) {
+    const DecoderBuffer* buffer;
+    const StatusCode status = DequeueFrame(&buffer);
+    if (status != kStatusOk) return status;
+    if (buffer != nullptr) {
+      settings_.on_frame_ready(settings_.callback_private_data, buffer);
+    }
+  }
+  ReleaseOutputFrame();
+  return kStatusOk;
+}
+
+void DecoderImpl::OutputDecodedFrames() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (outputting_frames_) return;
+  outputting_frames_ = true;
+  while (failure_status_ == kStatusOk && !temporal_units_.Empty() &&
+         temporal_units_.Front().decoded) {
+    TemporalUnit& temporal_unit = temporal_units_.Front();
+    lock.unlock();
+    // A failed temporal unit also sets |failure_status_|.
+    assert(temporal_unit.status == kStatusOk);
+    if (settings_.release_input_buffer != nullptr) {
+      settings_.release_input_buffer(settings_.callback_private_data,
+                                     temporal_unit.buffer_private_data);
+    }
+    // |output_layers| is sorted in reverse order, see DequeueFrame().
+    StatusCode status = kStatusOk;
+    for (int i = temporal_unit.output_layer_count - 1; i >= 0; --i) {
+      const RefCountedBufferPtr frame =
+          std::move(temporal_unit.output_layers[i].frame);
+      DecoderBuffer buffer = {};
+      status = FillDecoderBuffer(frame, temporal_unit.color_config, &buffer);
+      if (status != kStatusOk) break;
+      buffer.user_private_data = temporal_unit.user_private_data;
+      settings_.on_frame_ready(settings_.callback_private_data, &buffer);
+    }
+    lock.lock();
+    temporal_units_.Pop();
+    if (status != kStatusOk && failure_status_ == kStatusOk) {
+      failure_status_ = status;
+    }
+    decoded_condvar_.notify_all();
+  }
+  outputting_frames_ = false;
+}
+
 StatusCode DecoderImpl::DecodeFrame(EncodedFrame* const encoded_frame) {
   const ObuSequenceHeader& sequence_header = encoded_frame->sequence_header;
   const ObuFrameHeader& frame_header = encoded_frame->frame_header;
@@ -987,6 +1441,17 @@ StatusCode DecoderImpl::DecodeFrame(EncodedFrame* const encoded_frame) {
   // of scope (i.e.) on any return path in this function.
   FrameScratchBufferReleaser frame_scratch_buffer_releaser(
       &frame_scratch_buffer_pool_, &frame_scratch_buffer);
+  // Move to the CPUs of the threads that help with this frame, if they are
+  // restricted, so that the memory this thread touches is on their node.
+  // Changing the affinity is a system call, so each frame thread only does it
+  // for the first frame it decodes.
+  thread_local bool affinity_set = false;
+  if (!affinity_set) {
+    affinity_set = true;
+    const CpuSet& affinity =
+        frame_scratch_buffer->threading_strategy.affinity();
+    if (!affinity.Empty()) SetCurrentThreadAffinity(affinity);
+  }
 
   StatusCode status;
   if (!frame_header.show_existing_frame) {
@@ -1137,10 +1602,15 @@ StatusCode DecoderImpl::DecodeTemporalUnit(const TemporalUnit& temporal_unit,
       }
       if (!settings_.parse_only) {
         RefCountedBufferPtr film_grain_frame;
-        status = ApplyFilmGrain(
-            obu->sequence_header(), obu->frame_header(), current_frame,
-            &film_grain_frame,
-            frame_scratch_buffer->threading_strategy.film_grain_thread_pool());
+        {
+          ThreadingStrategy& threading_strategy =
+              frame_scratch_buffer->threading_strategy;
+          const ScopedStageTimer stage_timer(
+              &threading_strategy, ThreadingStrategy::kStageFilmGrain);
+          status = ApplyFilmGrain(obu->sequence_header(), obu->frame_header(),
+                                  current_frame, &film_grain_frame,
+                                  threading_strategy.film_grain_thread_pool());
+        }
         if (status != kStatusOk) return status;
         output_frame_queue_.Push(std::move(film_grain_frame));
       }
@@ -1163,21 +1633,32 @@ StatusCode DecoderImpl::DecodeTemporalUnit(const TemporalUnit& temporal_unit,
 
 StatusCode DecoderImpl::CopyFrameToOutputBuffer(
     const RefCountedBufferPtr& frame) {
+  const StatusCode status =
+      FillDecoderBuffer(frame, sequence_header_.color_config, &buffer_);
+  if (status != kStatusOk) return status;
+  output_frame_ = frame;
+  return kStatusOk;
+}
+
+// static
+StatusCode DecoderImpl::FillDecoderBuffer(const RefCountedBufferPtr& frame,
+                                          const ColorConfig& color_config,
+                                          DecoderBuffer* const buffer) {
   YuvBuffer* yuv_buffer = frame->buffer();
 
-  buffer_.chroma_sample_position = frame->chroma_sample_position();
+  buffer->chroma_sample_position = frame->chroma_sample_position();
 
   if (yuv_buffer->is_monochrome()) {
-    buffer_.image_format = kImageFormatMonochrome400;
+    buffer->image_format = kImageFormatMonochrome400;
   } else {
     if (yuv_buffer->subsampling_x() == 0 && yuv_buffer->subsampling_y() == 0) {
-      buffer_.image_format = kImageFormatYuv444;
+      buffer->image_format = kImageFormatYuv444;
     } else if (yuv_buffer->subsampling_x() == 1 &&
                yuv_buffer->subsampling_y() == 0) {
-      buffer_.image_format = kImageFormatYuv422;
+      buffer->image_format = kImageFormatYuv422;
     } else if (yuv_buffer->subsampling_x() == 1 &&
                yuv_buffer->subsampling_y() == 1) {
-      buffer_.image_format = kImageFormatYuv420;
+      buffer->image_format = kImageFormatYuv420;
     } else {
       LIBGAV1_DLOG(ERROR,
                    "Invalid chroma subsampling values: cannot determine buffer "
@@ -1185,51 +1666,48 @@ StatusCode DecoderImpl::CopyFrameToOutputBuffer(
       return kStatusInvalidArgument;
     }
   }
-  buffer_.color_range = sequence_header_.color_config.color_range;
-  buffer_.color_primary = sequence_header_.color_config.color_primary;
-  buffer_.transfer_characteristics =
-      sequence_header_.color_config.transfer_characteristics;
-  buffer_.matrix_coefficients =
-      sequence_header_.color_config.matrix_coefficients;
+  buffer->color_range = color_config.color_range;
+  buffer->color_primary = color_config.color_primary;
+  buffer->transfer_characteristics = color_config.transfer_characteristics;
+  buffer->matrix_coefficients = color_config.matrix_coefficients;
 
-  buffer_.bitdepth = yuv_buffer->bitdepth();
+  buffer->bitdepth = yuv_buffer->bitdepth();
   const int num_planes =
       yuv_buffer->is_monochrome() ? kMaxPlanesMonochrome : kMaxPlanes;
   int plane = kPlaneY;
   for (; plane < num_planes; ++plane) {
-    buffer_.stride[plane] = yuv_buffer->stride(plane);
-    buffer_.plane[plane] = yuv_buffer->data(plane);
-    buffer_.displayed_width[plane] = yuv_buffer->width(plane);
-    buffer_.displayed_height[plane] = yuv_buffer->height(plane);
+    buffer->stride[plane] = yuv_buffer->stride(plane);
+    buffer->plane[plane] = yuv_buffer->data(plane);
+    buffer->displayed_width[plane] = yuv_buffer->width(plane);
+    buffer->displayed_height[plane] = yuv_buffer->height(plane);
   }
   for (; plane < kMaxPlanes; ++plane) {
-    buffer_.stride[plane] = 0;
-    buffer_.plane[plane] = nullptr;
-    buffer_.displayed_width[plane] = 0;
-    buffer_.displayed_height[plane] = 0;
-  }
-  buffer_.spatial_id = frame->spatial_id();
-  buffer_.temporal_id = frame->temporal_id();
-  buffer_.buffer_private_data = frame->buffer_private_data();
+    buffer->stride[plane] = 0;
+    buffer->plane[plane] = nullptr;
+    buffer->displayed_width[plane] = 0;
+    buffer->displayed_height[plane] = 0;
+  }
+  buffer->spatial_id = frame->spatial_id();
+  buffer->temporal_id = frame->temporal_id();
+  buffer->buffer_private_data = frame->buffer_private_data();
   if (frame->hdr_cll_set()) {
-    buffer_.has_hdr_cll = 1;
-    buffer_.hdr_cll = frame->hdr_cll();
+    buffer->has_hdr_cll = 1;
+    buffer->hdr_cll = frame->hdr_cll();
   } else {
-    buffer_.has_hdr_cll = 0;
+    buffer->has_hdr_cll = 0;
   }
   if (frame->hdr_mdcv_set()) {
-    buffer_.has_hdr_mdcv = 1;
-    buffer_.hdr_mdcv = frame->hdr_mdcv();
+    buffer->has_hdr_mdcv = 1;
+    buffer->hdr_mdcv = frame->hdr_mdcv();
   } else {
-    buffer_.has_hdr_mdcv = 0;
+    buffer->has_hdr_mdcv = 0;
   }
   if (frame->itut_t35_set()) {
-    buffer_.has_itut_t35 = 1;
-    buffer_.itut_t35 = frame->itut_t35();
+    buffer->has_itut_t35 = 1;
+    buffer->itut_t35 = frame->itut_t35();
   } else {
-    buffer_.has_itut_t35 = 0;
+    buffer->has_itut_t35 = 0;
   }
-  output_frame_ = frame;
   return kStatusOk;
 }
 
@@ -1240,11 +1718,10 @@ void DecoderImpl::ReleaseOutputFrame() {
   output_frame_ = nullptr;
 }
 
-StatusCode DecoderImpl::DecodeTiles(
+StatusCode DecoderImpl::AllocateFrameScratchBuffer(
     const ObuSequenceHeader& sequence_header,
-    const ObuFrameHeader& frame_header, const Vector<TileBuffer>& tile_buffers,
-    const DecoderState& state, FrameScratchBuffer* const frame_scratch_buffer,
-    RefCountedBuffer* const current_frame) {
+    const ObuFrameHeader& frame_header,
+    FrameScratchBuffer* const frame_scratch_buffer) {
   frame_scratch_buffer->tile_scratch_buffer_pool.Reset(
       sequence_header.color_config.bitdepth);
   if (!frame_scratch_buffer->loop_restoration_info.Reset(
@@ -1258,9 +1735,13 @@ StatusCode DecoderImpl::DecodeTiles(
   }
   ThreadingStrategy& threading_strategy =
       frame_scratch_buffer->threading_strategy;
-  if (!is_frame_parallel_ &&
-      !threading_strategy.Reset(frame_header, settings_.threads)) {
-    return kStatusOutOfMemory;
+  if (!is_frame_parallel_) {
+    threading_strategy.set_adaptive(settings_.adaptive_threading);
+    threading_strategy.set_placement(&thread_placement_);
+    if (!threading_strategy.Reset(frame_header, threads_, executor_.get())) {
+      return kStatusOutOfMemory;
+    }
+    buffer_pool_.SetMemoryNodes(thread_placement_.memory_nodes());
   }
   const bool do_cdef =
       PostFilter::DoCdef(frame_header, settings_.post_filter_mask);
@@ -1271,25 +1752,6 @@ StatusCode DecoderImpl::DecodeTiles(
       frame_header.loop_restoration, settings_.post_filter_mask, num_planes);
   const bool do_superres =
       PostFilter::DoSuperRes(frame_header, settings_.post_filter_mask);
-  // Use kBorderPixels for the left, right, and top borders. Only the bottom
-  // border may need to be bigger. Cdef border is needed only if we apply Cdef
-  // without multithreading.
-  const int bottom_border = GetBottomBorderPixels(
-      do_cdef && threading_strategy.post_filter_thread_pool() == nullptr,
-      do_restoration, do_superres, sequence_header.color_config.subsampling_y);
-  current_frame->set_chroma_sample_position(
-      sequence_header.color_config.chroma_sample_position);
-  if (!current_frame->Realloc(sequence_header.color_config.bitdepth,
-                              sequence_header.color_config.is_monochrome,
-                              frame_header.upscaled_width, frame_header.height,
-                              sequence_header.color_config.subsampling_x,
-                              sequence_header.color_config.subsampling_y,
-                              /*left_border=*/kBorderPixels,
-                              /*right_border=*/kBorderPixels,
-                              /*top_border=*/kBorderPixels, bottom_border)) {
-    LIBGAV1_DLOG(ERROR, "Failed to allocate memory for the decoder buffer.");
-    return kStatusOutOfMemory;
-  }
   if (frame_header.cdef.bits > 0) {
     if (!frame_scratch_buffer->cdef_index.Reset(
             DivideBy16(frame_header.rows4x4 + kMaxBlockHeight4x4),
@@ -1326,21 +1788,6 @@ StatusCode DecoderImpl::DecodeTiles(
                    "Failed to allocate memory for temporal motion vectors.");
       return kStatusOutOfMemory;
     }
-
-    // For each motion vector, only mv[0] needs to be initialized to
-    // kInvalidMvValue, mv[1] is not necessary to be initialized and can be
-    // set to an arbitrary value. For simplicity, mv[1] is set to 0.
-    // The following memory initialization of contiguous memory is very fast. It
-    // is not recommended to make the initialization multi-threaded, unless the
-    // memory which needs to be initialized in each thread is still contiguous.
-    MotionVector invalid_mv;
-    invalid_mv.mv[0] = kInvalidMvValue;
-    invalid_mv.mv[1] = 0;
-    MotionVector* const motion_field_mv =
-        &frame_scratch_buffer->motion_field.mv[0][0];
-    std::fill(motion_field_mv,
-              motion_field_mv + frame_scratch_buffer->motion_field.mv.size(),
-              invalid_mv);
   }
 
   // The addition of kMaxBlockHeight4x4 and kMaxBlockWidth4x4 is necessary so
@@ -1351,19 +1798,18 @@ StatusCode DecoderImpl::DecodeTiles(
           frame_header.columns4x4 + kMaxBlockWidth4x4)) {
     return kStatusOutOfMemory;
   }
-  const dsp::Dsp* const dsp =
-      dsp::GetDspTable(sequence_header.color_config.bitdepth);
-  if (dsp == nullptr) {
-    LIBGAV1_DLOG(ERROR, "Failed to get the dsp table for bitdepth %d.",
-                 sequence_header.color_config.bitdepth);
-    return kStatusInternalError;
-  }
-
   const int tile_count = frame_header.tile_info.tile_count;
   assert(tile_count >= 1);
-  Vector<std::unique_ptr<Tile>> tiles;
-  if (!tiles.reserve(tile_count)) {
-    LIBGAV1_DLOG(ERROR, "tiles.reserve(%d) failed.\n", tile_count);
+  // The tiles of the previous frame decoded with |frame_scratch_buffer| have
+  // been destroyed, so their memory can be reused.
+  Arena& tile_arena = frame_scratch_buffer->tile_arena;
+  const size_t tile_arena_capacity = tile_arena.capacity();
+  const bool tile_arena_allocated = tile_arena.Reset(
+      tile_count * Tile::ArenaSize(sequence_header, frame_header));
+  memory_tracker_.Update(kMemoryCategoryScratch, tile_arena_capacity,
+                         tile_arena.capacity());
+  if (!tile_arena_allocated) {
+    LIBGAV1_DLOG(ERROR, "Failed to allocate the tile arena.\n");
     return kStatusOutOfMemory;
   }
 
@@ -1381,6 +1827,8 @@ StatusCode DecoderImpl::DecodeTiles(
         LIBGAV1_DLOG(ERROR, "Failed to allocate residual buffer.\n");
         return kStatusOutOfMemory;
       }
+      frame_scratch_buffer->residual_buffer_pool->set_memory_tracker(
+          &memory_tracker_);
     } else {
       frame_scratch_buffer->residual_buffer_pool->Reset(
           sequence_header.use_128x128_superblock,
@@ -1489,6 +1937,109 @@ StatusCode DecoderImpl::DecodeTiles(
     }
   }
 
+  if (UseIntraPredictionBuffer()) {
+    if (!frame_scratch_buffer->intra_prediction_buffers.Resize(
+            frame_header.tile_info.tile_rows)) {
+      LIBGAV1_DLOG(ERROR, "Failed to Resize intra_prediction_buffers.");
+      return kStatusOutOfMemory;
+    }
+    IntraPredictionBuffer* const intra_prediction_buffers =
+        frame_scratch_buffer->intra_prediction_buffers.get();
+    for (int plane = kPlaneY; plane < num_planes; ++plane) {
+      const int subsampling =
+          (plane == kPlaneY) ? 0 : sequence_header.color_config.subsampling_x;
+      const size_t intra_prediction_buffer_size =
+          ((MultiplyBy4(frame_header.columns4x4) >> subsampling) *
+           (sequence_header.color_config.bitdepth == 8 ? sizeof(uint8_t)
+                                                       : sizeof(uint16_t)));
+      for (int tile_row = 0; tile_row < frame_header.tile_info.tile_rows;
+           ++tile_row) {
+        if (!intra_prediction_buffers[tile_row][plane].Resize(
+                intra_prediction_buffer_size)) {
+          LIBGAV1_DLOG(ERROR,
+                       "Failed to allocate intra prediction buffer for tile "
+                       "row %d plane %d.\n",
+                       tile_row, plane);
+          return kStatusOutOfMemory;
+        }
+      }
+    }
+  }
+
+  return kStatusOk;
+}
+
+StatusCode DecoderImpl::DecodeTiles(
+    const ObuSequenceHeader& sequence_header,
+    const ObuFrameHeader& frame_header, const Vector<TileBuffer>& tile_buffers,
+    const DecoderState& state, FrameScratchBuffer* const frame_scratch_buffer,
+    RefCountedBuffer* const current_frame) {
+  const StatusCode allocation_status = AllocateFrameScratchBuffer(
+      sequence_header, frame_header, frame_scratch_buffer);
+  if (allocation_status != kStatusOk) return allocation_status;
+  ThreadingStrategy& threading_strategy =
+      frame_scratch_buffer->threading_strategy;
+  const bool do_cdef =
+      PostFilter::DoCdef(frame_header, settings_.post_filter_mask);
+  const int num_planes = sequence_header.color_config.is_monochrome
+                             ? kMaxPlanesMonochrome
+                             : kMaxPlanes;
+  const bool do_restoration = PostFilter::DoRestoration(
+      frame_header.loop_restoration, settings_.post_filter_mask, num_planes);
+  const bool do_superres =
+      PostFilter::DoSuperRes(frame_header, settings_.post_filter_mask);
+  // Use kBorderPixels for the left, right, and top borders. Only the bottom
+  // border may need to be bigger. Cdef border is needed only if we apply Cdef
+  // without multithreading.
+  const int bottom_border = GetBottomBorderPixels(
+      do_cdef && threading_strategy.post_filter_thread_pool() == nullptr,
+      do_restoration, do_superres, sequence_header.color_config.subsampling_y);
+  current_frame->set_chroma_sample_position(
+      sequence_header.color_config.chroma_sample_position);
+  if (!current_frame->Realloc(sequence_header.color_config.bitdepth,
+                              sequence_header.color_config.is_monochrome,
+                              frame_header.upscaled_width, frame_header.height,
+                              sequence_header.color_config.subsampling_x,
+                              sequence_header.color_config.subsampling_y,
+                              /*left_border=*/kBorderPixels,
+                              /*right_border=*/kBorderPixels,
+                              /*top_border=*/kBorderPixels, bottom_border)) {
+    LIBGAV1_DLOG(ERROR, "Failed to allocate memory for the decoder buffer.");
+    return kStatusOutOfMemory;
+  }
+  if (frame_header.use_ref_frame_mvs) {
+    // For each motion vector, only mv[0] needs to be initialized to
+    // kInvalidMvValue, mv[1] is not necessary to be initialized and can be
+    // set to an arbitrary value. For simplicity, mv[1] is set to 0.
+    // The following memory initialization of contiguous memory is very fast. It
+    // is not recommended to make the initialization multi-threaded, unless the
+    // memory which needs to be initialized in each thread is still contiguous.
+    MotionVector invalid_mv;
+    invalid_mv.mv[0] = kInvalidMvValue;
+    invalid_mv.mv[1] = 0;
+    MotionVector* const motion_field_mv =
+        &frame_scratch_buffer->motion_field.mv[0][0];
+    std::fill(motion_field_mv,
+              motion_field_mv + frame_scratch_buffer->motion_field.mv.size(),
+              invalid_mv);
+  }
+
+  const dsp::Dsp* const dsp =
+      dsp::GetDspTable(sequence_header.color_config.bitdepth);
+  if (dsp == nullptr) {
+    LIBGAV1_DLOG(ERROR, "Failed to get the dsp table for bitdepth %d.",
+                 sequence_header.color_config.bitdepth);
+    return kStatusInternalError;
+  }
+
+  const int tile_count = frame_header.tile_info.tile_count;
+  assert(tile_count >= 1);
+  Vector<ArenaUniquePtr<Tile>> tiles;
+  if (!tiles.reserve(tile_count)) {
+    LIBGAV1_DLOG(ERROR, "tiles.reserve(%d) failed.\n", tile_count);
+    return kStatusOutOfMemory;
+  }
+
   if (is_frame_parallel_ && !IsIntraFrame(frame_header.frame_type)) {
     // We can parse the current frame if all the reference frames have been
     // parsed.
@@ -1519,51 +2070,14 @@ StatusCode DecoderImpl::DecodeTiles(
     }
   }
 
-  // The Tile class must make use of a separate buffer to store the unfiltered
-  // pixels for the intra prediction of the next superblock row. This is done
-  // only when one of the following conditions are true:
-  //   * is_frame_parallel_ is true.
-  //   * settings_.threads == 1.
-  // In the non-frame-parallel multi-threaded case, we do not run the post
-  // filters in the decode loop. So this buffer need not be used.
-  const bool use_intra_prediction_buffer =
-      is_frame_parallel_ || settings_.threads == 1;
-  if (use_intra_prediction_buffer) {
-    if (!frame_scratch_buffer->intra_prediction_buffers.Resize(
-            frame_header.tile_info.tile_rows)) {
-      LIBGAV1_DLOG(ERROR, "Failed to Resize intra_prediction_buffers.");
-      return kStatusOutOfMemory;
-    }
-    IntraPredictionBuffer* const intra_prediction_buffers =
-        frame_scratch_buffer->intra_prediction_buffers.get();
-    for (int plane = kPlaneY; plane < num_planes; ++plane) {
-      const int subsampling =
-          (plane == kPlaneY) ? 0 : sequence_header.color_config.subsampling_x;
-      const size_t intra_prediction_buffer_size =
-          ((MultiplyBy4(frame_header.columns4x4) >> subsampling) *
-           (sequence_header.color_config.bitdepth == 8 ? sizeof(uint8_t)
-                                                       : sizeof(uint16_t)));
-      for (int tile_row = 0; tile_row < frame_header.tile_info.tile_rows;
-           ++tile_row) {
-        if (!intra_prediction_buffers[tile_row][plane].Resize(
-                intra_prediction_buffer_size)) {
-          LIBGAV1_DLOG(ERROR,
-                       "Failed to allocate intra prediction buffer for tile "
-                       "row %d plane %d.\n",
-                       tile_row, plane);
-          return kStatusOutOfMemory;
-        }
-      }
-    }
-  }
-
+  const bool use_intra_prediction_buffer = UseIntraPredictionBuffer();
   PostFilter post_filter(frame_header, sequence_header, frame_scratch_buffer,
                          current_frame->buffer(), dsp,
                          settings_.post_filter_mask);
   SymbolDecoderContext saved_symbol_decoder_context;
   BlockingCounterWithStatus pending_tiles(tile_count);
   for (int tile_number = 0; tile_number < tile_count; ++tile_number) {
-    std::unique_ptr<Tile> tile = Tile::Create(
+    ArenaUniquePtr<Tile> tile = Tile::Create(
         tile_number, tile_buffers[tile_number].data,
         tile_buffers[tile_number].size, sequence_header, frame_header,
         current_frame, state, frame_scratch_buffer, wedge_masks_,
@@ -1596,7 +2110,7 @@ StatusCode DecoderImpl::DecodeTiles(
           prev_segment_ids, frame_scratch_buffer, &post_filter, current_frame);
     }
     StatusCode status;
-    if (settings_.threads == 1) {
+    if (threads_ == 1) {
       status = DecodeTilesNonFrameParallel(sequence_header, frame_header, tiles,
                                            frame_scratch_buffer, &post_filter);
     } else {
@@ -1679,6 +2193,7 @@ StatusCode DecoderImpl::ApplyFilmGrain(
                              displayable_frame->buffer()->subsampling_y(),
                              displayable_frame->upscaled_width(),
                              displayable_frame->frame_height(), thread_pool);
+    film_grain.set_memory_tracker(&memory_tracker_);
     if (!film_grain.AddNoise(
             displayable_frame->buffer()->data(kPlaneY),
             displayable_frame->buffer()->stride(kPlaneY),
@@ -1703,6 +2218,7 @@ StatusCode DecoderImpl::ApplyFilmGrain(
                              displayable_frame->buffer()->subsampling_y(),
                              displayable_frame->upscaled_width(),
                              displayable_frame->frame_height(), thread_pool);
+    film_grain.set_memory_tracker(&memory_tracker_);
     if (!film_grain.AddNoise(
             displayable_frame->buffer()->data(kPlaneY),
             displayable_frame->buffer()->stride(kPlaneY),
@@ -1725,6 +2241,7 @@ StatusCode DecoderImpl::ApplyFilmGrain(
                           displayable_frame->buffer()->subsampling_y(),
                           displayable_frame->upscaled_width(),
                           displayable_frame->frame_height(), thread_pool);
+  film_grain.set_memory_tracker(&memory_tracker_);
   if (!film_grain.AddNoise(
           displayable_frame->buffer()->data(kPlaneY),
           displayable_frame->buffer()->stride(kPlaneY),
@@ -32,15 +32,18 @@
 #include "src/gav1/decoder_buffer.h"
 #include "src/gav1/decoder_settings.h"
 #include "src/gav1/status_code.h"
+#include "src/memory_tracker.h"
 #include "src/obu_parser.h"
 #include "src/quantizer.h"
 #include "src/residual_buffer_pool.h"
 #include "src/symbol_decoder_context.h"
+#include "src/threading_strategy.h"
 #include "src/tile.h"
 #include "src/utils/array_2d.h"
 #include "src/utils/block_parameters_holder.h"
 #include "src/utils/compiler_attributes.h"
 #include "src/utils/constants.h"
+#include "src/utils/executor.h"
 #include "src/utils/memory.h"
 #include "src/utils/queue.h"
 #include "src/utils/segmentation_map.h"
@@ -127,6 +130,10 @@ struct TemporalUnit : public Allocable {
   // Flag to ensure that we release the input buffer only once if there are
   // multiple output layers.
   bool released_input_buffer;
+  // The color config of the sequence the temporal unit belongs to. Used only
+  // in frame parallel mode when the frames are output through
+  // |settings_.on_frame_ready|.
+  ColorConfig color_config;
 };
 
 class DecoderImpl : public Allocable {
@@ -141,6 +148,15 @@ class DecoderImpl : public Allocable {
   StatusCode EnqueueFrame(const uint8_t* data, size_t size,
                           int64_t user_private_data, void* buffer_private_data);
   StatusCode DequeueFrame(const DecoderBuffer** out_ptr);
+  // Used only if |settings_.on_frame_ready| is not nullptr. Waits until all the
+  // enqueued frames have been passed to the callback or decoding has failed.
+  void WaitForPendingFrames();
+  // Discards the enqueued frames, the reference frames and the sequence header
+  // so that a new stream can be decoded. The thread pools, the pooled buffers
+  // and the lookup tables are kept. In frame parallel mode, waits for the
+  // frames that are being decoded first. Returns an error if decoding has
+  // failed, in which case the object cannot be used any more.
+  StatusCode Reset();
   static constexpr int GetMaxBitdepth() {
     static_assert(LIBGAV1_MAX_BITDEPTH == 8 || LIBGAV1_MAX_BITDEPTH == 10 ||
                       LIBGAV1_MAX_BITDEPTH == 12,
@@ -148,6 +164,25 @@ class DecoderImpl : public Allocable {
     return LIBGAV1_MAX_BITDEPTH;
   }
   std::vector<int> GetFrameQps();
+  void GetMemoryUsage(MemoryUsage* usage) const { memory_tracker_.Get(usage); }
+  // Raises the peaks reported by GetMemoryUsage() to at least the ones in
+  // |usage|.
+  void RecordPeakMemoryUsage(const MemoryUsage& usage) {
+    memory_tracker_.RecordPeaks(usage);
+  }
+  // Allocates the frame buffers, the scratch buffers and the threads needed to
+  // decode frames of up to |max_width|x|max_height| pixels. If called before
+  // the first frame is enqueued, also sets up the frame threading, as for a
+  // stream with a single tile and with at most |frame_parallel_depth| frames
+  // decoded in parallel (no limit if it is 0).
+  StatusCode Prewarm(int max_width, int max_height, int bitdepth,
+                     ImageFormat image_format, int frame_parallel_depth);
+  // Frees the unused buffers of |buffer_pool_| and trims the pooled scratch
+  // buffers. The frames in use and the thread pools are kept.
+  void TrimMemory() {
+    buffer_pool_.Trim();
+    frame_scratch_buffer_pool_.Trim();
+  }
 
  private:
   explicit DecoderImpl(const DecoderSettings* settings);
@@ -165,6 +200,24 @@ class DecoderImpl : public Allocable {
   //    sequence (i.e.) a new sequence header.
   StatusCode InitializeFrameThreadPoolAndTemporalUnitQueue(const uint8_t* data,
                                                            size_t size);
+  // Sets up the frame threading for a stream with |sequence_header| and
+  // |frame_header|, decoding at most |max_frame_threads| frames in parallel.
+  // |frame_parallel| is true if frame parallel mode is allowed.
+  StatusCode InitializeFrameThreadPool(const ObuSequenceHeader& sequence_header,
+                                       const ObuFrameHeader& frame_header,
+                                       bool frame_parallel,
+                                       int max_frame_threads);
+  // Initializes the |temporal_units_| queue based on the number of frame
+  // threads.
+  StatusCode InitializeTemporalUnitQueue();
+  // Used only if |settings_.max_memory_bytes| is not 0. Estimates the memory
+  // needed to decode the stream of |sequence_header| and |frame_header| and
+  // returns the number of frames that may be decoded in parallel within the
+  // budget (1 if |frame_parallel| is false). Then lowers |threads_| until the
+  // estimate for the threads fits in what is left of the budget.
+  int ApplyMemoryBudget(const ObuSequenceHeader& sequence_header,
+                        const ObuFrameHeader& frame_header,
+                        bool frame_parallel);
   // Used only in frame parallel mode. Signals failure and waits until the
   // worker threads are aborted if |status| is a failure status. If |status| is
   // equal to kStatusOk or kStatusTryAgain, this function does not do anything.
@@ -189,16 +242,51 @@ class DecoderImpl : public Allocable {
   // |encoded_frame->temporal_unit|'s parameters if the decoded frame is a
   // displayable frame. Used only in frame parallel mode.
   StatusCode DecodeFrame(EncodedFrame* encoded_frame);
-
+  // Used only if |settings_.on_frame_ready| is not nullptr. Decodes the
+  // enqueued temporal units and passes their frames to the callback. Used only
+  // in non frame parallel mode.
+  StatusCode DecodeAndOutputFrames();
+  // Used only if |settings_.on_frame_ready| is not nullptr. Passes the frames
+  // of the decoded temporal units at the front of |temporal_units_| to the
+  // callback and removes these temporal units from the queue. Does nothing if
+  // another thread is already doing so, since that thread also takes care of
+  // the temporal units decoded in the meantime. Used only in frame parallel
+  // mode.
+  void OutputDecodedFrames();
+
+  // Populates |buffer| with values from |frame|, using |color_config| for the
+  // color description.
+  static StatusCode FillDecoderBuffer(const RefCountedBufferPtr& frame,
+                                      const ColorConfig& color_config,
+                                      DecoderBuffer* buffer);
   // Populates |buffer_| with values from |frame|. Adds a reference to |frame|
   // in |output_frame_|.
   StatusCode CopyFrameToOutputBuffer(const RefCountedBufferPtr& frame);
+  // Allocates the buffers in |frame_scratch_buffer| that are needed to decode
+  // a frame with |sequence_header| and |frame_header|, and sets up the thread
+  // pools in non frame parallel mode. The buffers are only grown, so this is
+  // cheap after the first frame.
+  StatusCode AllocateFrameScratchBuffer(
+      const ObuSequenceHeader& sequence_header,
+      const ObuFrameHeader& frame_header,
+      FrameScratchBuffer* frame_scratch_buffer);
   StatusCode DecodeTiles(const ObuSequenceHeader& sequence_header,
                          const ObuFrameHeader& frame_header,
                          const Vector<TileBuffer>& tile_buffers,
                          const DecoderState& state,
                          FrameScratchBuffer* frame_scratch_buffer,
                          RefCountedBuffer* current_frame);
+  // The Tile class must make use of a separate buffer to store the unfiltered
+  // pixels for the intra prediction of the next superblock row. This is done
+  // only when one of the following conditions are true:
+  //   * is_frame_parallel_ is true.
+  //   * threads_ == 1.
+  // In the non-frame-parallel multi-threaded case, the post filters modify a
+  // superblock row only after the superblock row below it has been decoded (see
+  // PostFilter::StartFilteringWithDecoding()). So this buffer need not be used.
+  bool UseIntraPredictionBuffer() const {
+    return is_frame_parallel_ || threads_ == 1;
+  }
   // Applies film grain synthesis to the |displayable_frame| and stores the film
   // grain applied frame into |film_grain_frame|. Returns kStatusOk on success.
   StatusCode ApplyFilmGrain(const ObuSequenceHeader& sequence_header,
@@ -224,6 +312,9 @@ class DecoderImpl : public Allocable {
 
   // Elements in this queue cannot be moved with std::move since the
   // |EncodedFrame.temporal_unit| stores a pointer to elements in this queue.
+  // In frame parallel mode, when |settings_.on_frame_ready| is not nullptr, the
+  // frame threads remove the elements from this queue. The queue itself is
+  // then guarded by |mutex_|.
   Queue<TemporalUnit> temporal_units_;
   DecoderState state_;
 
@@ -238,17 +329,28 @@ class DecoderImpl : public Allocable {
   // false.
   Queue<RefCountedBufferPtr> output_frame_queue_;
 
+  // Declared before the pools that record their allocations in it.
+  MemoryTracker memory_tracker_;
   BufferPool buffer_pool_;
   WedgeMaskArray wedge_masks_;
   bool wedge_masks_initialized_ = false;
   QuantizerMatrix quantizer_matrix_;
   bool quantizer_matrix_initialized_ = false;
+  // Wraps |settings_.executor_schedule|. nullptr if the application did not
+  // provide an executor. Declared before |frame_scratch_buffer_pool_| since
+  // the thread pools in there may use it until they are destroyed.
+  std::unique_ptr<Executor> executor_;
+  // Decides which CPUs the worker threads run on according to
+  // |settings_.thread_affinity|.
+  ThreadPlacement thread_placement_;
   FrameScratchBufferPool frame_scratch_buffer_pool_;
 
   // Used to synchronize the accesses into |temporal_units_| in order to update
   // the "decoded" state of a temporal unit.
   std::mutex mutex_;
   std::condition_variable decoded_condvar_;
+  // True while a thread is in OutputDecodedFrames(). Guarded by |mutex_|.
+  bool outputting_frames_ = false;
   bool is_frame_parallel_;
   std::unique_ptr<ThreadPool> frame_thread_pool_;
 
@@ -266,6 +368,9 @@ class DecoderImpl : public Allocable {
   bool has_sequence_header_ = false;
 
   const DecoderSettings& settings_;
+  // The number of threads to use. Initialized to |settings_.threads| and
+  // lowered if needed to stay within |settings_.max_memory_bytes|.
+  int threads_;
   bool seen_first_frame_ = false;
 
   std::vector<int> frame_mean_qps_;
@@ -29,6 +29,14 @@ void Libgav1DecoderSettingsInitDefault(Libgav1DecoderSettings* settings) {
   settings->operating_point = 0;
   settings->post_filter_mask = 0x1f;
   settings->parse_only = 0;  // false
+  settings->executor_schedule = nullptr;
+  settings->executor_private_data = nullptr;
+  settings->adaptive_threading = 0;  // false
+  settings->thread_affinity = kLibgav1ThreadAffinityNone;
+  settings->affinity_cpus = nullptr;
+  settings->num_affinity_cpus = 0;
+  settings->max_memory_bytes = 0;
+  settings->on_frame_ready = nullptr;
 }
 
 }  // extern "C"
@@ -14,6 +14,7 @@
 
 #include "src/gav1/decoder.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -22,6 +23,7 @@
 
 #include "gtest/gtest.h"
 #include "src/decoder_test_data.h"
+#include "src/utils/threadpool.h"
 
 namespace libgav1 {
 namespace {
@@ -381,6 +383,321 @@ TEST_F(DecoderTest, MetadataObu) {
   EXPECT_EQ(frames_in_use_, 0);
 }
 
+// An executor that runs the decoder's tasks on a ThreadPool and counts them.
+struct CountingExecutor {
+  std::unique_ptr<ThreadPool> thread_pool;
+  std::atomic<int> scheduled{0};
+  std::atomic<int> completed{0};
+};
+
+extern "C" void ScheduleOnThreadPool(void* executor_private_data,
+                                     ExecutorTask task, void* task_data) {
+  auto* const executor = static_cast<CountingExecutor*>(executor_private_data);
+  ++executor->scheduled;
+  executor->thread_pool->Schedule([executor, task, task_data]() {
+    task(task_data);
+    ++executor->completed;
+  });
+}
+
+// Two decoders sharing one application-owned executor.
+TEST(DecoderExecutorTest, SharedExecutor) {
+  CountingExecutor executor;
+  executor.thread_pool = ThreadPool::Create(2);
+  ASSERT_NE(executor.thread_pool, nullptr);
+  {
+    DecoderSettings settings = {};
+    settings.threads = 4;
+    // Frame parallel decoding is not used with an executor.
+    settings.frame_parallel = true;
+    settings.release_input_buffer = [](void*, void*) {};
+    settings.executor_schedule = ScheduleOnThreadPool;
+    settings.executor_private_data = &executor;
+    Decoder decoders[2];
+    for (auto& decoder : decoders) {
+      ASSERT_EQ(decoder.Init(&settings), kStatusOk);
+    }
+    for (auto& decoder : decoders) {
+      ASSERT_EQ(decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0, nullptr),
+                kStatusOk);
+    }
+    for (auto& decoder : decoders) {
+      const DecoderBuffer* buffer;
+      ASSERT_EQ(decoder.DequeueFrame(&buffer), kStatusOk);
+      EXPECT_NE(buffer, nullptr);
+    }
+  }
+  // Wait for the last |completed| updates.
+  executor.thread_pool = nullptr;
+  EXPECT_GT(executor.scheduled.load(), 0);
+  EXPECT_EQ(executor.scheduled.load(), executor.completed.load());
+}
+
+// Records the frames passed to the on_frame_ready callback.
+struct OutputFrames {
+  std::vector<int64_t> user_private_data;
+  int invalid_buffers = 0;
+};
+
+extern "C" void OnFrameReady(void* callback_private_data,
+                             const Libgav1DecoderBuffer* buffer) {
+  auto* const output_frames = static_cast<OutputFrames*>(callback_private_data);
+  if (buffer == nullptr || buffer->plane[0] == nullptr) {
+    ++output_frames->invalid_buffers;
+    return;
+  }
+  output_frames->user_private_data.push_back(buffer->user_private_data);
+}
+
+class FrameReadyCallbackTest : public testing::TestWithParam<bool> {};
+
+TEST_P(FrameReadyCallbackTest, OutputsFramesInOrder) {
+  OutputFrames output_frames;
+  DecoderSettings settings = {};
+  settings.threads = 4;
+  settings.frame_parallel = GetParam();
+  settings.release_input_buffer = [](void*, void*) {};
+  settings.on_frame_ready = OnFrameReady;
+  settings.callback_private_data = &output_frames;
+  Decoder decoder;
+  ASSERT_EQ(decoder.Init(&settings), kStatusOk);
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 1, nullptr),
+            kStatusOk);
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame2, sizeof(kFrame2), 2, nullptr),
+            kStatusOk);
+  // The frames are only output through the callback.
+  const DecoderBuffer* buffer;
+  EXPECT_EQ(decoder.DequeueFrame(&buffer), kStatusInvalidArgument);
+  ASSERT_EQ(decoder.SignalEOS(), kStatusOk);
+  EXPECT_EQ(output_frames.invalid_buffers, 0);
+  EXPECT_EQ(output_frames.user_private_data, (std::vector<int64_t>{1, 2}));
+}
+
+INSTANTIATE_TEST_SUITE_P(FrameParallel, FrameReadyCallbackTest,
+                         testing::Bool());
+
+TEST(DecoderMemoryUsageTest, ReportsUsage) {
+  Decoder decoder;
+  MemoryUsage usage;
+  EXPECT_EQ(decoder.GetMemoryUsage(&usage), kStatusNotInitialized);
+  DecoderSettings settings = {};
+  ASSERT_EQ(decoder.Init(&settings), kStatusOk);
+  EXPECT_EQ(decoder.GetMemoryUsage(nullptr), kStatusInvalidArgument);
+  ASSERT_EQ(decoder.GetMemoryUsage(&usage), kStatusOk);
+  for (int i = 0; i < kNumMemoryCategories; ++i) {
+    EXPECT_EQ(usage.current_bytes[i], size_t{0}) << "i = " << i;
+    EXPECT_EQ(usage.peak_bytes[i], size_t{0}) << "i = " << i;
+  }
+
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0, nullptr),
+            kStatusOk);
+  const DecoderBuffer* buffer;
+  ASSERT_EQ(decoder.DequeueFrame(&buffer), kStatusOk);
+  ASSERT_NE(buffer, nullptr);
+  ASSERT_EQ(decoder.GetMemoryUsage(&usage), kStatusOk);
+  for (const MemoryCategory category :
+       {kMemoryCategoryFrameBuffers, kMemoryCategoryScratch,
+        kMemoryCategorySymbolContexts}) {
+    EXPECT_GT(usage.current_bytes[category], size_t{0})
+        << "category = " << category;
+    EXPECT_GE(usage.peak_bytes[category], usage.current_bytes[category])
+        << "category = " << category;
+  }
+  const size_t frame_buffers_peak =
+      usage.peak_bytes[kMemoryCategoryFrameBuffers];
+
+  // The peaks are kept across SignalEOS().
+  ASSERT_EQ(decoder.SignalEOS(), kStatusOk);
+  ASSERT_EQ(decoder.GetMemoryUsage(&usage), kStatusOk);
+  EXPECT_EQ(usage.current_bytes[kMemoryCategoryFrameBuffers], size_t{0});
+  EXPECT_EQ(usage.peak_bytes[kMemoryCategoryFrameBuffers], frame_buffers_peak);
+}
+
+TEST(DecoderAffinityTest, CpusAreOnlyReadByInit) {
+  Decoder decoder;
+  {
+    std::vector<int> cpus = {0};
+    DecoderSettings settings = {};
+    settings.threads = 2;
+    settings.thread_affinity = kThreadAffinityCpuSet;
+    settings.affinity_cpus = cpus.data();
+    settings.num_affinity_cpus = static_cast<int>(cpus.size());
+    ASSERT_EQ(decoder.Init(&settings), kStatusOk);
+  }
+  // SignalEOS() creates the decoder again without the freed array.
+  ASSERT_EQ(decoder.SignalEOS(), kStatusOk);
+  const DecoderBuffer* buffer;
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0, nullptr),
+            kStatusOk);
+  ASSERT_EQ(decoder.DequeueFrame(&buffer), kStatusOk);
+  EXPECT_NE(buffer, nullptr);
+}
+
+class TrimMemoryTest : public testing::TestWithParam<bool> {};
+
+TEST_P(TrimMemoryTest, KeepsReferenceFrames) {
+  Decoder decoder;
+  EXPECT_EQ(decoder.TrimMemory(), kStatusNotInitialized);
+  DecoderSettings settings = {};
+  settings.threads = 4;
+  settings.frame_parallel = GetParam();
+  settings.blocking_dequeue = true;
+  settings.release_input_buffer = [](void*, void*) {};
+  ASSERT_EQ(decoder.Init(&settings), kStatusOk);
+  EXPECT_EQ(decoder.TrimMemory(), kStatusOk);
+
+  const DecoderBuffer* buffer;
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0, nullptr),
+            kStatusOk);
+  ASSERT_EQ(decoder.DequeueFrame(&buffer), kStatusOk);
+  ASSERT_NE(buffer, nullptr);
+  const uint8_t first_pixel = buffer->plane[0][0];
+  MemoryUsage usage;
+  ASSERT_EQ(decoder.GetMemoryUsage(&usage), kStatusOk);
+  const size_t frame_buffers_bytes =
+      usage.current_bytes[kMemoryCategoryFrameBuffers];
+
+  ASSERT_EQ(decoder.TrimMemory(), kStatusOk);
+  ASSERT_EQ(decoder.GetMemoryUsage(&usage), kStatusOk);
+  // The output frame, which is also a reference frame, is kept.
+  EXPECT_GT(usage.current_bytes[kMemoryCategoryFrameBuffers], size_t{0});
+  EXPECT_LE(usage.current_bytes[kMemoryCategoryFrameBuffers],
+            frame_buffers_bytes);
+  EXPECT_EQ(buffer->plane[0][0], first_pixel);
+
+  // Decoding continues with the reference frames that were kept.
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame2, sizeof(kFrame2), 0, nullptr),
+            kStatusOk);
+  ASSERT_EQ(decoder.DequeueFrame(&buffer), kStatusOk);
+  ASSERT_NE(buffer, nullptr);
+  ASSERT_EQ(decoder.SignalEOS(), kStatusOk);
+}
+
+INSTANTIATE_TEST_SUITE_P(FrameParallel, TrimMemoryTest, testing::Bool());
+
+class ResetTest : public testing::TestWithParam<bool> {};
+
+TEST_P(ResetTest, DiscardsStreamState) {
+  Decoder decoder;
+  EXPECT_EQ(decoder.Reset(), kStatusNotInitialized);
+  int released_input_buffers = 0;
+  DecoderSettings settings = {};
+  settings.threads = 4;
+  settings.frame_parallel = GetParam();
+  settings.blocking_dequeue = true;
+  settings.callback_private_data = &released_input_buffers;
+  settings.release_input_buffer = [](void* callback_private_data, void*) {
+    ++*static_cast<int*>(callback_private_data);
+  };
+  ASSERT_EQ(decoder.Init(&settings), kStatusOk);
+  EXPECT_EQ(decoder.Reset(), kStatusOk);
+
+  const DecoderBuffer* buffer;
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0, nullptr),
+            kStatusOk);
+  ASSERT_EQ(decoder.DequeueFrame(&buffer), kStatusOk);
+  ASSERT_NE(buffer, nullptr);
+  const uint8_t first_pixel = buffer->plane[0][0];
+  EXPECT_EQ(released_input_buffers, 1);
+
+  // The frame that was enqueued but not dequeued is discarded.
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame2, sizeof(kFrame2), 0, nullptr),
+            kStatusOk);
+  ASSERT_EQ(decoder.Reset(), kStatusOk);
+  EXPECT_EQ(released_input_buffers, 2);
+  EXPECT_EQ(decoder.DequeueFrame(&buffer), kStatusNothingToDequeue);
+  EXPECT_EQ(buffer, nullptr);
+
+  // The stream can be decoded again from the start.
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0, nullptr),
+            kStatusOk);
+  ASSERT_EQ(decoder.DequeueFrame(&buffer), kStatusOk);
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_EQ(buffer->plane[0][0], first_pixel);
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame2, sizeof(kFrame2), 0, nullptr),
+            kStatusOk);
+  ASSERT_EQ(decoder.DequeueFrame(&buffer), kStatusOk);
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_EQ(released_input_buffers, 4);
+  ASSERT_EQ(decoder.SignalEOS(), kStatusOk);
+}
+
+INSTANTIATE_TEST_SUITE_P(FrameParallel, ResetTest, testing::Bool());
+
+class PrewarmTest : public testing::TestWithParam<bool> {};
+
+TEST_P(PrewarmTest, AllocatesFrameBuffers) {
+  Decoder decoder;
+  EXPECT_EQ(decoder.Prewarm(32, 32, 8, kImageFormatYuv420, 2),
+            kStatusNotInitialized);
+  DecoderSettings settings = {};
+  settings.threads = 8;
+  settings.frame_parallel = GetParam();
+  settings.blocking_dequeue = true;
+  settings.release_input_buffer = [](void*, void*) {};
+  ASSERT_EQ(decoder.Init(&settings), kStatusOk);
+  EXPECT_EQ(decoder.Prewarm(0, 32, 8, kImageFormatYuv420, 2),
+            kStatusInvalidArgument);
+  EXPECT_EQ(decoder.Prewarm(32, 32, 9, kImageFormatYuv420, 2),
+            kStatusInvalidArgument);
+  EXPECT_EQ(decoder.Prewarm(32, 32, 8, kImageFormatYuv420, -1),
+            kStatusInvalidArgument);
+  // The test stream is 32x32 with 8-bit 4:2:0 frames.
+  ASSERT_EQ(decoder.Prewarm(32, 32, 8, kImageFormatYuv420, 2), kStatusOk);
+  MemoryUsage usage;
+  ASSERT_EQ(decoder.GetMemoryUsage(&usage), kStatusOk);
+  const size_t frame_buffers_bytes =
+      usage.current_bytes[kMemoryCategoryFrameBuffers];
+  EXPECT_GT(frame_buffers_bytes, size_t{0});
+  EXPECT_GT(usage.current_bytes[kMemoryCategoryScratch], size_t{0});
+
+  const DecoderBuffer* buffer;
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0, nullptr),
+            kStatusOk);
+  // The buffers may be in use by the enqueued frame.
+  EXPECT_EQ(decoder.Prewarm(32, 32, 8, kImageFormatYuv420, 2),
+            kStatusTryAgain);
+  ASSERT_EQ(decoder.DequeueFrame(&buffer), kStatusOk);
+  ASSERT_NE(buffer, nullptr);
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame2, sizeof(kFrame2), 0, nullptr),
+            kStatusOk);
+  ASSERT_EQ(decoder.DequeueFrame(&buffer), kStatusOk);
+  ASSERT_NE(buffer, nullptr);
+  // The frames were decoded into the buffers allocated by Prewarm().
+  ASSERT_EQ(decoder.GetMemoryUsage(&usage), kStatusOk);
+  EXPECT_EQ(usage.current_bytes[kMemoryCategoryFrameBuffers],
+            frame_buffers_bytes);
+  ASSERT_EQ(decoder.SignalEOS(), kStatusOk);
+}
+
+INSTANTIATE_TEST_SUITE_P(FrameParallel, PrewarmTest, testing::Bool());
+
+class MemoryBudgetTest : public testing::TestWithParam<bool> {};
+
+TEST_P(MemoryBudgetTest, DecodesWithTooSmallBudget) {
+  DecoderSettings settings = {};
+  settings.threads = 8;
+  settings.frame_parallel = GetParam();
+  settings.blocking_dequeue = true;
+  settings.release_input_buffer = [](void*, void*) {};
+  // Even the reference frames do not fit, so the stream is decoded with a
+  // single thread.
+  settings.max_memory_bytes = 1;
+  Decoder decoder;
+  ASSERT_EQ(decoder.Init(&settings), kStatusOk);
+  const DecoderBuffer* buffer;
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0, nullptr),
+            kStatusOk);
+  ASSERT_EQ(decoder.DequeueFrame(&buffer), kStatusOk);
+  ASSERT_NE(buffer, nullptr);
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame2, sizeof(kFrame2), 0, nullptr),
+            kStatusOk);
+  ASSERT_EQ(decoder.DequeueFrame(&buffer), kStatusOk);
+  ASSERT_NE(buffer, nullptr);
+}
+
+INSTANTIATE_TEST_SUITE_P(FrameParallel, MemoryBudgetTest, testing::Bool());
+
 class ParseOnlyTest : public testing::Test {
  public:
   void SetUp() override;
@@ -24,6 +24,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <type_traits>
 
 #include "src/dsp/arm/common_neon.h"
 #include "src/dsp/constants.h"
@@ -561,7 +562,7 @@ void StorePixels(void* dest, ptrdiff_t dst_stride, int16x8_t result) {
   }
 }
 
-template <int width, typename Pixel, bool enable_primary = true,
+template <int width, int bitdepth, bool enable_primary = true,
           bool enable_secondary = true>
 void CdefFilter_NEON(const uint16_t* LIBGAV1_RESTRICT src,
                      const ptrdiff_t src_stride, const int height,
@@ -570,6 +571,8 @@ void CdefFilter_NEON(const uint16_t* LIBGAV1_RESTRICT src,
                      void* LIBGAV1_RESTRICT dest, const ptrdiff_t dst_stride) {
   static_assert(width == 8 || width == 4, "");
   static_assert(enable_primary || enable_secondary, "");
+  using Pixel =
+      typename std::conditional<bitdepth == 8, uint8_t, uint16_t>::type;
   constexpr bool clipping_required = enable_primary && enable_secondary;
   auto* dst = static_cast<uint8_t*>(dest);
   const uint16x8_t cdef_large_value_mask =
@@ -582,10 +585,12 @@ void CdefFilter_NEON(const uint16_t* LIBGAV1_RESTRICT src,
   // FloorLog2() requires input to be > 0.
   // 8-bit damping range: Y: [3, 6], UV: [2, 5].
   // 10-bit damping range: Y: [3, 6 + 2], UV: [2, 5 + 2].
+  // 12-bit damping range: Y: [3, 6 + 4], UV: [2, 5 + 4].
   if (enable_primary) {
     // 8-bit primary_strength: [0, 15] -> FloorLog2: [0, 3] so a clamp is
     // necessary for UV filtering.
     // 10-bit primary_strength: [0, 15 << 2].
+    // 12-bit primary_strength: [0, 15 << 4].
     primary_damping_shift =
         vdupq_n_s16(-std::max(0, damping - FloorLog2(primary_strength)));
   }
@@ -598,13 +603,14 @@ void CdefFilter_NEON(const uint16_t* LIBGAV1_RESTRICT src,
       secondary_damping_shift =
           vdupq_n_s16(-(damping - FloorLog2(secondary_strength)));
     } else {
-      // secondary_strength: [0, 4 << 2]
+      // 10-bit secondary_strength: [0, 4 << 2].
+      // 12-bit secondary_strength: [0, 4 << 4].
       secondary_damping_shift =
           vdupq_n_s16(-std::max(0, damping - FloorLog2(secondary_strength)));
     }
   }
 
-  constexpr int coeff_shift = (sizeof(Pixel) == 1) ? 0 : kBitdepth10 - 8;
+  constexpr int coeff_shift = bitdepth - 8;
   const int primary_tap_0 =
       kCdefPrimaryTaps[(primary_strength >> coeff_shift) & 1][0];
   const int primary_tap_1 =
@@ -743,16 +749,18 @@ void Init8bpp() {
   Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
   assert(dsp != nullptr);
   dsp->cdef_direction = CdefDirection_NEON<kBitdepth8>;
-  dsp->cdef_filters[0][0] = CdefFilter_NEON<4, uint8_t>;
-  dsp->cdef_filters[0][1] = CdefFilter_NEON<4, uint8_t, /*enable_primary=*/true,
-                                            /*enable_secondary=*/false>;
+  dsp->cdef_filters[0][0] = CdefFilter_NEON<4, kBitdepth8>;
+  dsp->cdef_filters[0][1] =
+      CdefFilter_NEON<4, kBitdepth8, /*enable_primary=*/true,
+                      /*enable_secondary=*/false>;
   dsp->cdef_filters[0][2] =
-      CdefFilter_NEON<4, uint8_t, /*enable_primary=*/false>;
-  dsp->cdef_filters[1][0] = CdefFilter_NEON<8, uint8_t>;
-  dsp->cdef_filters[1][1] = CdefFilter_NEON<8, uint8_t, /*enable_primary=*/true,
-                                            /*enable_secondary=*/false>;
+      CdefFilter_NEON<4, kBitdepth8, /*enable_primary=*/false>;
+  dsp->cdef_filters[1][0] = CdefFilter_NEON<8, kBitdepth8>;
+  dsp->cdef_filters[1][1] =
+      CdefFilter_NEON<8, kBitdepth8, /*enable_primary=*/true,
+                      /*enable_secondary=*/false>;
   dsp->cdef_filters[1][2] =
-      CdefFilter_NEON<8, uint8_t, /*enable_primary=*/false>;
+      CdefFilter_NEON<8, kBitdepth8, /*enable_primary=*/false>;
 }
 
 }  // namespace
@@ -766,19 +774,39 @@ void Init10bpp() {
   Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
   assert(dsp != nullptr);
   dsp->cdef_direction = CdefDirection_NEON<kBitdepth10>;
-  dsp->cdef_filters[0][0] = CdefFilter_NEON<4, uint16_t>;
+  dsp->cdef_filters[0][0] = CdefFilter_NEON<4, kBitdepth10>;
+  dsp->cdef_filters[0][1] =
+      CdefFilter_NEON<4, kBitdepth10, /*enable_primary=*/true,
+                      /*enable_secondary=*/false>;
+  dsp->cdef_filters[0][2] =
+      CdefFilter_NEON<4, kBitdepth10, /*enable_primary=*/false>;
+  dsp->cdef_filters[1][0] = CdefFilter_NEON<8, kBitdepth10>;
+  dsp->cdef_filters[1][1] =
+      CdefFilter_NEON<8, kBitdepth10, /*enable_primary=*/true,
+                      /*enable_secondary=*/false>;
+  dsp->cdef_filters[1][2] =
+      CdefFilter_NEON<8, kBitdepth10, /*enable_primary=*/false>;
+}
+
+#if LIBGAV1_MAX_BITDEPTH == 12
+void Init12bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth12);
+  assert(dsp != nullptr);
+  dsp->cdef_direction = CdefDirection_NEON<kBitdepth12>;
+  dsp->cdef_filters[0][0] = CdefFilter_NEON<4, kBitdepth12>;
   dsp->cdef_filters[0][1] =
-      CdefFilter_NEON<4, uint16_t, /*enable_primary=*/true,
+      CdefFilter_NEON<4, kBitdepth12, /*enable_primary=*/true,
                       /*enable_secondary=*/false>;
   dsp->cdef_filters[0][2] =
-      CdefFilter_NEON<4, uint16_t, /*enable_primary=*/false>;
-  dsp->cdef_filters[1][0] = CdefFilter_NEON<8, uint16_t>;
+      CdefFilter_NEON<4, kBitdepth12, /*enable_primary=*/false>;
+  dsp->cdef_filters[1][0] = CdefFilter_NEON<8, kBitdepth12>;
   dsp->cdef_filters[1][1] =
-      CdefFilter_NEON<8, uint16_t, /*enable_primary=*/true,
+      CdefFilter_NEON<8, kBitdepth12, /*enable_primary=*/true,
                       /*enable_secondary=*/false>;
   dsp->cdef_filters[1][2] =
-      CdefFilter_NEON<8, uint16_t, /*enable_primary=*/false>;
+      CdefFilter_NEON<8, kBitdepth12, /*enable_primary=*/false>;
 }
+#endif  // LIBGAV1_MAX_BITDEPTH == 12
 
 }  // namespace
 }  // namespace high_bitdepth
@@ -789,6 +817,9 @@ void CdefInit_NEON() {
 #if LIBGAV1_MAX_BITDEPTH >= 10
   high_bitdepth::Init10bpp();
 #endif
+#if LIBGAV1_MAX_BITDEPTH == 12
+  high_bitdepth::Init12bpp();
+#endif
 }
 
 }  // namespace dsp
@@ -36,6 +36,9 @@ void CdefInit_NEON();
 
 #define LIBGAV1_Dsp10bpp_CdefDirection LIBGAV1_CPU_NEON
 #define LIBGAV1_Dsp10bpp_CdefFilters LIBGAV1_CPU_NEON
+
+#define LIBGAV1_Dsp12bpp_CdefDirection LIBGAV1_CPU_NEON
+#define LIBGAV1_Dsp12bpp_CdefFilters LIBGAV1_CPU_NEON
 #endif  // LIBGAV1_ENABLE_NEON
 
 #endif  // LIBGAV1_SRC_DSP_ARM_CDEF_NEON_H_
@@ -44,6 +44,24 @@ namespace {
 //   Vertical upscaled range:           [-1317624,  2365176]
 //   Pixel output range:                [       0,     1023]
 //   Compound output range:             [    3988,    61532]
+// Bitdepth: 12 Input range:            [       0,     4095]
+//   Horizontal upscaled range:         [ -114660,   376740]
+//   Horizontal downscaled range:       [   -7166,    23546]
+//   Vertical upscaled range:           [-1318560,  2366880]
+//   Pixel output range:                [       0,     4095]
+//   Compound output range:             [    3974,    61559]
+
+template <int bitdepth>
+constexpr int HorizontalRoundBits() {
+  return (bitdepth == 12) ? kInterRoundBitsHorizontal12bpp
+                          : kInterRoundBitsHorizontal;
+}
+
+template <int bitdepth>
+constexpr int VerticalRoundBits() {
+  return (bitdepth == 12) ? kInterRoundBitsVertical12bpp
+                          : kInterRoundBitsVertical;
+}
 
 template <int num_taps>
 int32x4x2_t SumOnePassTaps(const uint16x8_t* const src,
@@ -143,15 +161,16 @@ int32x4_t SumOnePassTaps(const uint16x4_t* const src,
   return sum;
 }
 
-template <int num_taps, bool is_compound, bool is_2d>
+template <int bitdepth, int num_taps, bool is_compound, bool is_2d>
 void FilterHorizontalWidth8AndUp(const uint16_t* LIBGAV1_RESTRICT src,
                                  const ptrdiff_t src_stride,
                                  void* LIBGAV1_RESTRICT const dest,
                                  const ptrdiff_t pred_stride, const int width,
                                  const int height,
                                  const int16x4_t* const v_tap) {
+  constexpr int kRoundBitsHorizontal = HorizontalRoundBits<bitdepth>();
   auto* dest16 = static_cast<uint16_t*>(dest);
-  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << kBitdepth10) - 1);
+  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << bitdepth) - 1);
   if (is_2d) {
     int x = 0;
     do {
@@ -193,9 +212,9 @@ void FilterHorizontalWidth8AndUp(const uint16_t* LIBGAV1_RESTRICT src,
         }
 
         const int16x4_t d0 =
-            vqrshrn_n_s32(v_sum.val[0], kInterRoundBitsHorizontal - 1);
+            vqrshrn_n_s32(v_sum.val[0], kRoundBitsHorizontal - 1);
         const int16x4_t d1 =
-            vqrshrn_n_s32(v_sum.val[1], kInterRoundBitsHorizontal - 1);
+            vqrshrn_n_s32(v_sum.val[1], kRoundBitsHorizontal - 1);
         vst1_u16(&dest16[0], vreinterpret_u16_s16(d0));
         vst1_u16(&dest16[4], vreinterpret_u16_s16(d1));
         s += src_stride;
@@ -245,9 +264,9 @@ void FilterHorizontalWidth8AndUp(const uint16_t* LIBGAV1_RESTRICT src,
       if (is_compound) {
         const int16x4_t v_compound_offset = vdup_n_s16(kCompoundOffset);
         const int16x4_t d0 =
-            vqrshrn_n_s32(v_sum.val[0], kInterRoundBitsHorizontal - 1);
+            vqrshrn_n_s32(v_sum.val[0], kRoundBitsHorizontal - 1);
         const int16x4_t d1 =
-            vqrshrn_n_s32(v_sum.val[1], kInterRoundBitsHorizontal - 1);
+            vqrshrn_n_s32(v_sum.val[1], kRoundBitsHorizontal - 1);
         vst1_u16(&dest16[x],
                  vreinterpret_u16_s16(vadd_s16(d0, v_compound_offset)));
         vst1_u16(&dest16[x + 4],
@@ -259,7 +278,7 @@ void FilterHorizontalWidth8AndUp(const uint16_t* LIBGAV1_RESTRICT src,
         // Combining them requires adding the rounding offset from the skipped
         // shift.
         const int32x4_t v_first_shift_rounding_bit =
-            vdupq_n_s32(1 << (kInterRoundBitsHorizontal - 2));
+            vdupq_n_s32(1 << (kRoundBitsHorizontal - 2));
         v_sum.val[0] = vaddq_s32(v_sum.val[0], v_first_shift_rounding_bit);
         v_sum.val[1] = vaddq_s32(v_sum.val[1], v_first_shift_rounding_bit);
         const uint16x4_t d0 = vmin_u16(
@@ -276,14 +295,15 @@ void FilterHorizontalWidth8AndUp(const uint16_t* LIBGAV1_RESTRICT src,
   } while (--y != 0);
 }
 
-template <int num_taps, bool is_compound, bool is_2d>
+template <int bitdepth, int num_taps, bool is_compound, bool is_2d>
 void FilterHorizontalWidth4(const uint16_t* LIBGAV1_RESTRICT src,
                             const ptrdiff_t src_stride,
                             void* LIBGAV1_RESTRICT const dest,
                             const ptrdiff_t pred_stride, const int height,
                             const int16x4_t* const v_tap) {
+  constexpr int kRoundBitsHorizontal = HorizontalRoundBits<bitdepth>();
   auto* dest16 = static_cast<uint16_t*>(dest);
-  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << kBitdepth10) - 1);
+  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << bitdepth) - 1);
   int y = height;
   do {
     const uint16x8_t v_zero = vdupq_n_u16(0);
@@ -301,7 +321,7 @@ void FilterHorizontalWidth4(const uint16_t* LIBGAV1_RESTRICT src,
       v_sum = SumOnePassTaps<num_taps>(v_src, v_tap + 2);
     }
     if (is_compound || is_2d) {
-      const int16x4_t d0 = vqrshrn_n_s32(v_sum, kInterRoundBitsHorizontal - 1);
+      const int16x4_t d0 = vqrshrn_n_s32(v_sum, kRoundBitsHorizontal - 1);
       if (is_compound && !is_2d) {
         vst1_u16(&dest16[0], vreinterpret_u16_s16(
                                  vadd_s16(d0, vdup_n_s16(kCompoundOffset))));
@@ -310,7 +330,7 @@ void FilterHorizontalWidth4(const uint16_t* LIBGAV1_RESTRICT src,
       }
     } else {
       const int32x4_t v_first_shift_rounding_bit =
-          vdupq_n_s32(1 << (kInterRoundBitsHorizontal - 2));
+          vdupq_n_s32(1 << (kRoundBitsHorizontal - 2));
       v_sum = vaddq_s32(v_sum, v_first_shift_rounding_bit);
       const uint16x4_t d0 =
           vmin_u16(vqrshrun_n_s32(v_sum, kFilterBits - 1), v_max_bitdepth);
@@ -321,14 +341,15 @@ void FilterHorizontalWidth4(const uint16_t* LIBGAV1_RESTRICT src,
   } while (--y != 0);
 }
 
-template <int num_taps, bool is_2d>
+template <int bitdepth, int num_taps, bool is_2d>
 void FilterHorizontalWidth2(const uint16_t* LIBGAV1_RESTRICT src,
                             const ptrdiff_t src_stride,
                             void* LIBGAV1_RESTRICT const dest,
                             const ptrdiff_t pred_stride, const int height,
                             const int16x4_t* const v_tap) {
+  constexpr int kRoundBitsHorizontal = HorizontalRoundBits<bitdepth>();
   auto* dest16 = static_cast<uint16_t*>(dest);
-  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << kBitdepth10) - 1);
+  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << bitdepth) - 1);
   int y = height >> 1;
   do {
     const int16x8_t v_zero = vdupq_n_s16(0);
@@ -353,7 +374,7 @@ void FilterHorizontalWidth2(const uint16_t* LIBGAV1_RESTRICT src,
     }
     if (is_2d) {
       const uint16x4_t d0 = vreinterpret_u16_s16(
-          vqrshrn_n_s32(v_sum, kInterRoundBitsHorizontal - 1));
+          vqrshrn_n_s32(v_sum, kRoundBitsHorizontal - 1));
       dest16[0] = vget_lane_u16(d0, 0);
       dest16[1] = vget_lane_u16(d0, 2);
       dest16 += pred_stride;
@@ -367,7 +388,7 @@ void FilterHorizontalWidth2(const uint16_t* LIBGAV1_RESTRICT src,
       // Combining them requires adding the rounding offset from the skipped
       // shift.
       const int32x4_t v_first_shift_rounding_bit =
-          vdupq_n_s32(1 << (kInterRoundBitsHorizontal - 2));
+          vdupq_n_s32(1 << (kRoundBitsHorizontal - 2));
       v_sum = vaddq_s32(v_sum, v_first_shift_rounding_bit);
       const uint16x4_t d0 =
           vmin_u16(vqrshrun_n_s32(v_sum, kFilterBits - 1), v_max_bitdepth);
@@ -401,12 +422,12 @@ void FilterHorizontalWidth2(const uint16_t* LIBGAV1_RESTRICT src,
           vmlal_s16(v_sum, vget_low_s16(vextq_s16(input, input, 3)), v_tap[5]);
     }
     const uint16x4_t d0 = vreinterpret_u16_s16(
-        vqrshrn_n_s32(v_sum, kInterRoundBitsHorizontal - 1));
+        vqrshrn_n_s32(v_sum, kRoundBitsHorizontal - 1));
     Store2<0>(dest16, d0);
   }
 }
 
-template <int num_taps, bool is_compound, bool is_2d>
+template <int bitdepth, int num_taps, bool is_compound, bool is_2d>
 void FilterHorizontal(const uint16_t* LIBGAV1_RESTRICT const src,
                       const ptrdiff_t src_stride,
                       void* LIBGAV1_RESTRICT const dest,
@@ -418,19 +439,19 @@ void FilterHorizontal(const uint16_t* LIBGAV1_RESTRICT const src,
   assert(num_taps == 2 || num_taps == 4);
   if (num_taps == 2 || num_taps == 4) {
     if (width == 2 && !is_compound) {
-      FilterHorizontalWidth2<num_taps, is_2d>(src, src_stride, dest,
-                                              pred_stride, height, v_tap);
+      FilterHorizontalWidth2<bitdepth, num_taps, is_2d>(
+          src, src_stride, dest, pred_stride, height, v_tap);
       return;
     }
     assert(width == 4);
-    FilterHorizontalWidth4<num_taps, is_compound, is_2d>(
+    FilterHorizontalWidth4<bitdepth, num_taps, is_compound, is_2d>(
         src, src_stride, dest, pred_stride, height, v_tap);
   } else {
     assert(false);
   }
 }
 
-template <bool is_compound = false, bool is_2d = false>
+template <int bitdepth, bool is_compound = false, bool is_2d = false>
 LIBGAV1_ALWAYS_INLINE void DoHorizontalPass(
     const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
     void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
@@ -451,29 +472,30 @@ LIBGAV1_ALWAYS_INLINE void DoHorizontalPass(
   // When width <= 4, the valid filter index range is always [4, 5].
   if (width >= 8) {
     if (filter_index == 2) {  // 8 tap.
-      FilterHorizontalWidth8AndUp<8, is_compound, is_2d>(
+      FilterHorizontalWidth8AndUp<bitdepth, 8, is_compound, is_2d>(
           src, src_stride, dst, dst_stride, width, height, v_tap);
     } else if (filter_index < 2) {  // 6 tap.
-      FilterHorizontalWidth8AndUp<6, is_compound, is_2d>(
+      FilterHorizontalWidth8AndUp<bitdepth, 6, is_compound, is_2d>(
           src + 1, src_stride, dst, dst_stride, width, height, v_tap);
     } else {  // 2 tap.
       assert(filter_index == 3);
-      FilterHorizontalWidth8AndUp<2, is_compound, is_2d>(
+      FilterHorizontalWidth8AndUp<bitdepth, 2, is_compound, is_2d>(
           src + 3, src_stride, dst, dst_stride, width, height, v_tap);
     }
   } else {
     if ((filter_index & 0x4) != 0) {  // 4 tap.
       // ((filter_index == 4) | (filter_index == 5))
-      FilterHorizontal<4, is_compound, is_2d>(src + 2, src_stride, dst,
-                                              dst_stride, width, height, v_tap);
+      FilterHorizontal<bitdepth, 4, is_compound, is_2d>(
+          src + 2, src_stride, dst, dst_stride, width, height, v_tap);
     } else {  // 2 tap.
       assert(filter_index == 3);
-      FilterHorizontal<2, is_compound, is_2d>(src + 3, src_stride, dst,
-                                              dst_stride, width, height, v_tap);
+      FilterHorizontal<bitdepth, 2, is_compound, is_2d>(
+          src + 3, src_stride, dst, dst_stride, width, height, v_tap);
     }
   }
 }
 
+template <int bitdepth>
 void ConvolveHorizontal_NEON(
     const void* LIBGAV1_RESTRICT const reference,
     const ptrdiff_t reference_stride, const int horizontal_filter_index,
@@ -488,10 +510,11 @@ void ConvolveHorizontal_NEON(
   const ptrdiff_t src_stride = reference_stride >> 1;
   const ptrdiff_t dst_stride = pred_stride >> 1;
 
-  DoHorizontalPass(src, src_stride, dest, dst_stride, width, height,
-                   horizontal_filter_id, filter_index);
+  DoHorizontalPass<bitdepth>(src, src_stride, dest, dst_stride, width, height,
+                             horizontal_filter_id, filter_index);
 }
 
+template <int bitdepth>
 void ConvolveCompoundHorizontal_NEON(
     const void* LIBGAV1_RESTRICT const reference,
     const ptrdiff_t reference_stride, const int horizontal_filter_index,
@@ -504,19 +527,20 @@ void ConvolveCompoundHorizontal_NEON(
   auto* const dest = static_cast<uint16_t*>(prediction);
   const ptrdiff_t src_stride = reference_stride >> 1;
 
-  DoHorizontalPass</*is_compound=*/true>(src, src_stride, dest, width, width,
-                                         height, horizontal_filter_id,
-                                         filter_index);
+  DoHorizontalPass<bitdepth, /*is_compound=*/true>(
+      src, src_stride, dest, width, width, height, horizontal_filter_id,
+      filter_index);
 }
 
-template <int num_taps, bool is_compound = false>
+template <int bitdepth, int num_taps, bool is_compound = false>
 void FilterVertical(const uint16_t* LIBGAV1_RESTRICT const src,
                     const ptrdiff_t src_stride,
                     void* LIBGAV1_RESTRICT const dst,
                     const ptrdiff_t dst_stride, const int width,
                     const int height, const int16x4_t* const taps) {
+  constexpr int kRoundBitsHorizontal = HorizontalRoundBits<bitdepth>();
   const int next_row = num_taps - 1;
-  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << kBitdepth10) - 1);
+  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << bitdepth) - 1);
   auto* const dst16 = static_cast<uint16_t*>(dst);
   assert(width >= 8);
 
@@ -557,9 +581,9 @@ void FilterVertical(const uint16_t* LIBGAV1_RESTRICT const src,
       if (is_compound) {
         const int16x4_t v_compound_offset = vdup_n_s16(kCompoundOffset);
         const int16x4_t d0 =
-            vqrshrn_n_s32(v_sum.val[0], kInterRoundBitsHorizontal - 1);
+            vqrshrn_n_s32(v_sum.val[0], kRoundBitsHorizontal - 1);
         const int16x4_t d1 =
-            vqrshrn_n_s32(v_sum.val[1], kInterRoundBitsHorizontal - 1);
+            vqrshrn_n_s32(v_sum.val[1], kRoundBitsHorizontal - 1);
         vst1_u16(dst16 + x + y * dst_stride,
                  vreinterpret_u16_s16(vadd_s16(d0, v_compound_offset)));
         vst1_u16(dst16 + x + 4 + y * dst_stride,
@@ -591,14 +615,15 @@ void FilterVertical(const uint16_t* LIBGAV1_RESTRICT const src,
   } while (x < width);
 }
 
-template <int num_taps, bool is_compound = false>
+template <int bitdepth, int num_taps, bool is_compound = false>
 void FilterVertical4xH(const uint16_t* LIBGAV1_RESTRICT src,
                        const ptrdiff_t src_stride,
                        void* LIBGAV1_RESTRICT const dst,
                        const ptrdiff_t dst_stride, const int height,
                        const int16x4_t* const taps) {
+  constexpr int kRoundBitsHorizontal = HorizontalRoundBits<bitdepth>();
   const int next_row = num_taps - 1;
-  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << kBitdepth10) - 1);
+  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << bitdepth) - 1);
   auto* dst16 = static_cast<uint16_t*>(dst);
 
   uint16x4_t srcs[9];
@@ -633,9 +658,9 @@ void FilterVertical4xH(const uint16_t* LIBGAV1_RESTRICT src,
     const int32x4_t v_sum = SumOnePassTaps<num_taps>(srcs, taps);
     const int32x4_t v_sum_1 = SumOnePassTaps<num_taps>(srcs + 1, taps);
     if (is_compound) {
-      const int16x4_t d0 = vqrshrn_n_s32(v_sum, kInterRoundBitsHorizontal - 1);
+      const int16x4_t d0 = vqrshrn_n_s32(v_sum, kRoundBitsHorizontal - 1);
       const int16x4_t d1 =
-          vqrshrn_n_s32(v_sum_1, kInterRoundBitsHorizontal - 1);
+          vqrshrn_n_s32(v_sum_1, kRoundBitsHorizontal - 1);
       vst1_u16(dst16,
                vreinterpret_u16_s16(vadd_s16(d0, vdup_n_s16(kCompoundOffset))));
       dst16 += dst_stride;
@@ -670,14 +695,14 @@ void FilterVertical4xH(const uint16_t* LIBGAV1_RESTRICT src,
   } while (y != 0);
 }
 
-template <int num_taps>
+template <int bitdepth, int num_taps>
 void FilterVertical2xH(const uint16_t* LIBGAV1_RESTRICT src,
                        const ptrdiff_t src_stride,
                        void* LIBGAV1_RESTRICT const dst,
                        const ptrdiff_t dst_stride, const int height,
                        const int16x4_t* const taps) {
   const int next_row = num_taps - 1;
-  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << kBitdepth10) - 1);
+  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << bitdepth) - 1);
   auto* dst16 = static_cast<uint16_t*>(dst);
   const uint16x4_t v_zero = vdup_n_u16(0);
 
@@ -739,9 +764,10 @@ void FilterVertical2xH(const uint16_t* LIBGAV1_RESTRICT src,
   } while (y != 0);
 }
 
-template <int num_taps, bool is_compound>
+template <int bitdepth, int num_taps, bool is_compound>
 int16x8_t SimpleSum2DVerticalTaps(const int16x8_t* const src,
                                   const int16x8_t taps) {
+  constexpr int kRoundBitsVertical = VerticalRoundBits<bitdepth>();
   const int16x4_t taps_lo = vget_low_s16(taps);
   const int16x4_t taps_hi = vget_high_s16(taps);
   int32x4_t sum_lo, sum_hi;
@@ -805,18 +831,18 @@ int16x8_t SimpleSum2DVerticalTaps(const int16x8_t* const src,
 
   // Output is pixel, so saturate to clip at 0.
   return vreinterpretq_s16_u16(
-      vcombine_u16(vqrshrun_n_s32(sum_lo, kInterRoundBitsVertical - 1),
-                   vqrshrun_n_s32(sum_hi, kInterRoundBitsVertical - 1)));
+      vcombine_u16(vqrshrun_n_s32(sum_lo, kRoundBitsVertical - 1),
+                   vqrshrun_n_s32(sum_hi, kRoundBitsVertical - 1)));
 }
 
-template <int num_taps, bool is_compound = false>
+template <int bitdepth, int num_taps, bool is_compound = false>
 void Filter2DVerticalWidth8AndUp(const int16_t* LIBGAV1_RESTRICT src,
                                  void* LIBGAV1_RESTRICT const dst,
                                  const ptrdiff_t dst_stride, const int width,
                                  const int height, const int16x8_t taps) {
   assert(width >= 8);
   constexpr int next_row = num_taps - 1;
-  const uint16x8_t v_max_bitdepth = vdupq_n_u16((1 << kBitdepth10) - 1);
+  const uint16x8_t v_max_bitdepth = vdupq_n_u16((1 << bitdepth) - 1);
   auto* const dst16 = static_cast<uint16_t*>(dst);
 
   int x = 0;
@@ -851,9 +877,11 @@ void Filter2DVerticalWidth8AndUp(const int16_t* LIBGAV1_RESTRICT src,
       srcs[next_row + 1] = vld1q_s16(src);
       src += 8;
       const int16x8_t sum0 =
-          SimpleSum2DVerticalTaps<num_taps, is_compound>(srcs + 0, taps);
+          SimpleSum2DVerticalTaps<bitdepth, num_taps, is_compound>(srcs + 0,
+                                                                   taps);
       const int16x8_t sum1 =
-          SimpleSum2DVerticalTaps<num_taps, is_compound>(srcs + 1, taps);
+          SimpleSum2DVerticalTaps<bitdepth, num_taps, is_compound>(srcs + 1,
+                                                                   taps);
       if (is_compound) {
         const int16x8_t v_compound_offset = vdupq_n_s16(kCompoundOffset);
         vst1q_u16(d16,
@@ -888,12 +916,12 @@ void Filter2DVerticalWidth8AndUp(const int16_t* LIBGAV1_RESTRICT src,
 }
 
 // Take advantage of |src_stride| == |width| to process two rows at a time.
-template <int num_taps, bool is_compound = false>
+template <int bitdepth, int num_taps, bool is_compound = false>
 void Filter2DVerticalWidth4(const int16_t* LIBGAV1_RESTRICT src,
                             void* LIBGAV1_RESTRICT const dst,
                             const ptrdiff_t dst_stride, const int height,
                             const int16x8_t taps) {
-  const uint16x8_t v_max_bitdepth = vdupq_n_u16((1 << kBitdepth10) - 1);
+  const uint16x8_t v_max_bitdepth = vdupq_n_u16((1 << bitdepth) - 1);
   auto* dst16 = static_cast<uint16_t*>(dst);
 
   int16x8_t srcs[9];
@@ -923,7 +951,7 @@ void Filter2DVerticalWidth4(const int16_t* LIBGAV1_RESTRICT src,
                                       vget_low_s16(srcs[num_taps]));
 
     const int16x8_t sum =
-        SimpleSum2DVerticalTaps<num_taps, is_compound>(srcs, taps);
+        SimpleSum2DVerticalTaps<bitdepth, num_taps, is_compound>(srcs, taps);
     if (is_compound) {
       const int16x8_t v_compound_offset = vdupq_n_s16(kCompoundOffset);
       vst1q_u16(dst16,
@@ -956,13 +984,13 @@ void Filter2DVerticalWidth4(const int16_t* LIBGAV1_RESTRICT src,
 }
 
 // Take advantage of |src_stride| == |width| to process four rows at a time.
-template <int num_taps>
+template <int bitdepth, int num_taps>
 void Filter2DVerticalWidth2(const int16_t* LIBGAV1_RESTRICT src,
                             void* LIBGAV1_RESTRICT const dst,
                             const ptrdiff_t dst_stride, const int height,
                             const int16x8_t taps) {
   constexpr int next_row = (num_taps < 6) ? 4 : 8;
-  const uint16x8_t v_max_bitdepth = vdupq_n_u16((1 << kBitdepth10) - 1);
+  const uint16x8_t v_max_bitdepth = vdupq_n_u16((1 << bitdepth) - 1);
   auto* dst16 = static_cast<uint16_t*>(dst);
 
   int16x8_t srcs[9];
@@ -998,7 +1026,8 @@ void Filter2DVerticalWidth2(const int16_t* LIBGAV1_RESTRICT src,
       srcs[7] = vextq_s16(srcs[4], srcs[8], 6);
     }
     const int16x8_t sum =
-        SimpleSum2DVerticalTaps<num_taps, /*is_compound=*/false>(srcs, taps);
+        SimpleSum2DVerticalTaps<bitdepth, num_taps, /*is_compound=*/false>(
+            srcs, taps);
     const uint16x8_t d0 = vminq_u16(vreinterpretq_u16_s16(sum), v_max_bitdepth);
     Store2<0>(dst16, d0);
     dst16 += dst_stride;
@@ -1027,25 +1056,26 @@ void Filter2DVerticalWidth2(const int16_t* LIBGAV1_RESTRICT src,
   } while (y != 0);
 }
 
-template <int vertical_taps>
+template <int bitdepth, int vertical_taps>
 void Filter2DVertical(const int16_t* LIBGAV1_RESTRICT const intermediate_result,
                       const int width, const int height, const int16x8_t taps,
                       void* LIBGAV1_RESTRICT const prediction,
                       const ptrdiff_t pred_stride) {
   auto* const dest = static_cast<uint16_t*>(prediction);
   if (width >= 8) {
-    Filter2DVerticalWidth8AndUp<vertical_taps>(
+    Filter2DVerticalWidth8AndUp<bitdepth, vertical_taps>(
         intermediate_result, dest, pred_stride, width, height, taps);
   } else if (width == 4) {
-    Filter2DVerticalWidth4<vertical_taps>(intermediate_result, dest,
-                                          pred_stride, height, taps);
+    Filter2DVerticalWidth4<bitdepth, vertical_taps>(intermediate_result, dest,
+                                                    pred_stride, height, taps);
   } else {
     assert(width == 2);
-    Filter2DVerticalWidth2<vertical_taps>(intermediate_result, dest,
-                                          pred_stride, height, taps);
+    Filter2DVerticalWidth2<bitdepth, vertical_taps>(intermediate_result, dest,
+                                                    pred_stride, height, taps);
   }
 }
 
+template <int bitdepth>
 void Convolve2D_NEON(const void* LIBGAV1_RESTRICT const reference,
                      const ptrdiff_t reference_stride,
                      const int horizontal_filter_index,
@@ -1071,7 +1101,7 @@ void Convolve2D_NEON(const void* LIBGAV1_RESTRICT const reference,
                           kHorizontalOffset;
   const ptrdiff_t dest_stride = pred_stride >> 1;
 
-  DoHorizontalPass</*is_compound=*/false, /*is_2d=*/true>(
+  DoHorizontalPass<bitdepth, /*is_compound=*/false, /*is_2d=*/true>(
       src, src_stride, intermediate_result, width, width, intermediate_height,
       horizontal_filter_id, horiz_filter_index);
 
@@ -1079,35 +1109,36 @@ void Convolve2D_NEON(const void* LIBGAV1_RESTRICT const reference,
   const int16x8_t taps = vmovl_s8(
       vld1_s8(kHalfSubPixelFilters[vert_filter_index][vertical_filter_id]));
   if (vertical_taps == 8) {
-    Filter2DVertical<8>(intermediate_result, width, height, taps, prediction,
-                        dest_stride);
+    Filter2DVertical<bitdepth, 8>(intermediate_result, width, height, taps,
+                                  prediction, dest_stride);
   } else if (vertical_taps == 6) {
-    Filter2DVertical<6>(intermediate_result, width, height, taps, prediction,
-                        dest_stride);
+    Filter2DVertical<bitdepth, 6>(intermediate_result, width, height, taps,
+                                  prediction, dest_stride);
   } else if (vertical_taps == 4) {
-    Filter2DVertical<4>(intermediate_result, width, height, taps, prediction,
-                        dest_stride);
+    Filter2DVertical<bitdepth, 4>(intermediate_result, width, height, taps,
+                                  prediction, dest_stride);
   } else {  // |vertical_taps| == 2
-    Filter2DVertical<2>(intermediate_result, width, height, taps, prediction,
-                        dest_stride);
+    Filter2DVertical<bitdepth, 2>(intermediate_result, width, height, taps,
+                                  prediction, dest_stride);
   }
 }
 
-template <int vertical_taps>
+template <int bitdepth, int vertical_taps>
 void Compound2DVertical(
     const int16_t* LIBGAV1_RESTRICT const intermediate_result, const int width,
     const int height, const int16x8_t taps,
     void* LIBGAV1_RESTRICT const prediction) {
   auto* const dest = static_cast<uint16_t*>(prediction);
   if (width == 4) {
-    Filter2DVerticalWidth4<vertical_taps, /*is_compound=*/true>(
+    Filter2DVerticalWidth4<bitdepth, vertical_taps, /*is_compound=*/true>(
         intermediate_result, dest, width, height, taps);
   } else {
-    Filter2DVerticalWidth8AndUp<vertical_taps, /*is_compound=*/true>(
+    Filter2DVerticalWidth8AndUp<bitdepth, vertical_taps, /*is_compound=*/true>(
         intermediate_result, dest, width, width, height, taps);
   }
 }
 
+template <int bitdepth>
 void ConvolveCompound2D_NEON(
     const void* LIBGAV1_RESTRICT const reference,
     const ptrdiff_t reference_stride, const int horizontal_filter_index,
@@ -1134,7 +1165,7 @@ void ConvolveCompound2D_NEON(
                           (vertical_taps / 2 - 1) * src_stride -
                           kHorizontalOffset;
 
-  DoHorizontalPass</*is_2d=*/true, /*is_compound=*/true>(
+  DoHorizontalPass<bitdepth, /*is_2d=*/true, /*is_compound=*/true>(
       src, src_stride, intermediate_result, width, width, intermediate_height,
       horizontal_filter_id, horiz_filter_index);
 
@@ -1143,16 +1174,21 @@ void ConvolveCompound2D_NEON(
   const int16x8_t taps = vmovl_s8(
       vld1_s8(kHalfSubPixelFilters[vert_filter_index][vertical_filter_id]));
   if (vertical_taps == 8) {
-    Compound2DVertical<8>(intermediate_result, width, height, taps, prediction);
+    Compound2DVertical<bitdepth, 8>(intermediate_result, width, height, taps,
+                                    prediction);
   } else if (vertical_taps == 6) {
-    Compound2DVertical<6>(intermediate_result, width, height, taps, prediction);
+    Compound2DVertical<bitdepth, 6>(intermediate_result, width, height, taps,
+                                    prediction);
   } else if (vertical_taps == 4) {
-    Compound2DVertical<4>(intermediate_result, width, height, taps, prediction);
+    Compound2DVertical<bitdepth, 4>(intermediate_result, width, height, taps,
+                                    prediction);
   } else {  // |vertical_taps| == 2
-    Compound2DVertical<2>(intermediate_result, width, height, taps, prediction);
+    Compound2DVertical<bitdepth, 2>(intermediate_result, width, height, taps,
+                                    prediction);
   }
 }
 
+template <int bitdepth>
 void ConvolveVertical_NEON(
     const void* LIBGAV1_RESTRICT const reference,
     const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
@@ -1176,14 +1212,14 @@ void ConvolveVertical_NEON(
 
   if (filter_index == 0) {  // 6 tap.
     if (width == 2) {
-      FilterVertical2xH<6>(src, src_stride, dest, dest_stride, height,
-                           taps + 1);
+      FilterVertical2xH<bitdepth, 6>(src, src_stride, dest, dest_stride, height,
+                                     taps + 1);
     } else if (width == 4) {
-      FilterVertical4xH<6>(src, src_stride, dest, dest_stride, height,
-                           taps + 1);
+      FilterVertical4xH<bitdepth, 6>(src, src_stride, dest, dest_stride, height,
+                                     taps + 1);
     } else {
-      FilterVertical<6>(src, src_stride, dest, dest_stride, width, height,
-                        taps + 1);
+      FilterVertical<bitdepth, 6>(src, src_stride, dest, dest_stride, width,
+                                  height, taps + 1);
     }
   } else if ((static_cast<int>(filter_index == 1) &
               (static_cast<int>(vertical_filter_id == 1) |
@@ -1192,34 +1228,36 @@ void ConvolveVertical_NEON(
                static_cast<int>(vertical_filter_id == 9) |
                static_cast<int>(vertical_filter_id == 15))) != 0) {  // 6 tap.
     if (width == 2) {
-      FilterVertical2xH<6>(src, src_stride, dest, dest_stride, height,
-                           taps + 1);
+      FilterVertical2xH<bitdepth, 6>(src, src_stride, dest, dest_stride, height,
+                                     taps + 1);
     } else if (width == 4) {
-      FilterVertical4xH<6>(src, src_stride, dest, dest_stride, height,
-                           taps + 1);
+      FilterVertical4xH<bitdepth, 6>(src, src_stride, dest, dest_stride, height,
+                                     taps + 1);
     } else {
-      FilterVertical<6>(src, src_stride, dest, dest_stride, width, height,
-                        taps + 1);
+      FilterVertical<bitdepth, 6>(src, src_stride, dest, dest_stride, width,
+                                  height, taps + 1);
     }
   } else if (filter_index == 2) {  // 8 tap.
     if (width == 2) {
-      FilterVertical2xH<8>(src, src_stride, dest, dest_stride, height, taps);
+      FilterVertical2xH<bitdepth, 8>(src, src_stride, dest, dest_stride, height,
+                                     taps);
     } else if (width == 4) {
-      FilterVertical4xH<8>(src, src_stride, dest, dest_stride, height, taps);
+      FilterVertical4xH<bitdepth, 8>(src, src_stride, dest, dest_stride, height,
+                                     taps);
     } else {
-      FilterVertical<8>(src, src_stride, dest, dest_stride, width, height,
-                        taps);
+      FilterVertical<bitdepth, 8>(src, src_stride, dest, dest_stride, width,
+                                  height, taps);
     }
   } else if (filter_index == 3) {  // 2 tap.
     if (width == 2) {
-      FilterVertical2xH<2>(src, src_stride, dest, dest_stride, height,
-                           taps + 3);
+      FilterVertical2xH<bitdepth, 2>(src, src_stride, dest, dest_stride, height,
+                                     taps + 3);
     } else if (width == 4) {
-      FilterVertical4xH<2>(src, src_stride, dest, dest_stride, height,
-                           taps + 3);
+      FilterVertical4xH<bitdepth, 2>(src, src_stride, dest, dest_stride, height,
+                                     taps + 3);
     } else {
-      FilterVertical<2>(src, src_stride, dest, dest_stride, width, height,
-                        taps + 3);
+      FilterVertical<bitdepth, 2>(src, src_stride, dest, dest_stride, width,
+                                  height, taps + 3);
     }
   } else {
     // 4 tap. When |filter_index| == 1 the |vertical_filter_id| values listed
@@ -1236,18 +1274,19 @@ void ConvolveVertical_NEON(
     // treating it as though it has 4.
     if (filter_index == 1) src += src_stride;
     if (width == 2) {
-      FilterVertical2xH<4>(src, src_stride, dest, dest_stride, height,
-                           taps + 2);
+      FilterVertical2xH<bitdepth, 4>(src, src_stride, dest, dest_stride, height,
+                                     taps + 2);
     } else if (width == 4) {
-      FilterVertical4xH<4>(src, src_stride, dest, dest_stride, height,
-                           taps + 2);
+      FilterVertical4xH<bitdepth, 4>(src, src_stride, dest, dest_stride, height,
+                                     taps + 2);
     } else {
-      FilterVertical<4>(src, src_stride, dest, dest_stride, width, height,
-                        taps + 2);
+      FilterVertical<bitdepth, 4>(src, src_stride, dest, dest_stride, width,
+                                  height, taps + 2);
     }
   }
 }
 
+template <int bitdepth>
 void ConvolveCompoundVertical_NEON(
     const void* LIBGAV1_RESTRICT const reference,
     const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
@@ -1270,11 +1309,11 @@ void ConvolveCompoundVertical_NEON(
 
   if (filter_index == 0) {  // 6 tap.
     if (width == 4) {
-      FilterVertical4xH<6, /*is_compound=*/true>(src, src_stride, dest, 4,
-                                                 height, taps + 1);
+      FilterVertical4xH<bitdepth, 6, /*is_compound=*/true>(
+          src, src_stride, dest, 4, height, taps + 1);
     } else {
-      FilterVertical<6, /*is_compound=*/true>(src, src_stride, dest, width,
-                                              width, height, taps + 1);
+      FilterVertical<bitdepth, 6, /*is_compound=*/true>(
+          src, src_stride, dest, width, width, height, taps + 1);
     }
   } else if ((static_cast<int>(filter_index == 1) &
               (static_cast<int>(vertical_filter_id == 1) |
@@ -1283,27 +1322,27 @@ void ConvolveCompoundVertical_NEON(
                static_cast<int>(vertical_filter_id == 9) |
                static_cast<int>(vertical_filter_id == 15))) != 0) {  // 6 tap.
     if (width == 4) {
-      FilterVertical4xH<6, /*is_compound=*/true>(src, src_stride, dest, 4,
-                                                 height, taps + 1);
+      FilterVertical4xH<bitdepth, 6, /*is_compound=*/true>(
+          src, src_stride, dest, 4, height, taps + 1);
     } else {
-      FilterVertical<6, /*is_compound=*/true>(src, src_stride, dest, width,
-                                              width, height, taps + 1);
+      FilterVertical<bitdepth, 6, /*is_compound=*/true>(
+          src, src_stride, dest, width, width, height, taps + 1);
     }
   } else if (filter_index == 2) {  // 8 tap.
     if (width == 4) {
-      FilterVertical4xH<8, /*is_compound=*/true>(src, src_stride, dest, 4,
-                                                 height, taps);
+      FilterVertical4xH<bitdepth, 8, /*is_compound=*/true>(
+          src, src_stride, dest, 4, height, taps);
     } else {
-      FilterVertical<8, /*is_compound=*/true>(src, src_stride, dest, width,
-                                              width, height, taps);
+      FilterVertical<bitdepth, 8, /*is_compound=*/true>(
+          src, src_stride, dest, width, width, height, taps);
     }
   } else if (filter_index == 3) {  // 2 tap.
     if (width == 4) {
-      FilterVertical4xH<2, /*is_compound=*/true>(src, src_stride, dest, 4,
-                                                 height, taps + 3);
+      FilterVertical4xH<bitdepth, 2, /*is_compound=*/true>(
+          src, src_stride, dest, 4, height, taps + 3);
     } else {
-      FilterVertical<2, /*is_compound=*/true>(src, src_stride, dest, width,
-                                              width, height, taps + 3);
+      FilterVertical<bitdepth, 2, /*is_compound=*/true>(
+          src, src_stride, dest, width, width, height, taps + 3);
     }
   } else {
     // 4 tap. When |filter_index| == 1 the |filter_id| values listed below map
@@ -1319,15 +1358,16 @@ void ConvolveCompoundVertical_NEON(
     // treating it as though it has 4.
     if (filter_index == 1) src += src_stride;
     if (width == 4) {
-      FilterVertical4xH<4, /*is_compound=*/true>(src, src_stride, dest, 4,
-                                                 height, taps + 2);
+      FilterVertical4xH<bitdepth, 4, /*is_compound=*/true>(
+          src, src_stride, dest, 4, height, taps + 2);
     } else {
-      FilterVertical<4, /*is_compound=*/true>(src, src_stride, dest, width,
-                                              width, height, taps + 2);
+      FilterVertical<bitdepth, 4, /*is_compound=*/true>(
+          src, src_stride, dest, width, width, height, taps + 2);
     }
   }
 }
 
+template <int bitdepth>
 void ConvolveCompoundCopy_NEON(
     const void* const reference, const ptrdiff_t reference_stride,
     const int /*horizontal_filter_index*/, const int /*vertical_filter_index*/,
@@ -1338,9 +1378,9 @@ void ConvolveCompoundCopy_NEON(
   const ptrdiff_t src_stride = reference_stride >> 1;
   auto* dest = static_cast<uint16_t*>(prediction);
   constexpr int final_shift =
-      kInterRoundBitsVertical - kInterRoundBitsCompoundVertical;
+      VerticalRoundBits<bitdepth>() - kInterRoundBitsCompoundVertical;
   const uint16x8_t offset =
-      vdupq_n_u16((1 << kBitdepth10) + (1 << (kBitdepth10 - 1)));
+      vdupq_n_u16((1 << bitdepth) + (1 << (bitdepth - 1)));
 
   if (width >= 16) {
     int y = height;
@@ -1924,11 +1964,12 @@ inline int8x16_t GetPositive2TapFilter(const int tap_index) {
   return vld1q_s8(kAbsHalfSubPixel2TapFilterColumns[tap_index]);
 }
 
-template <int grade_x>
+template <int bitdepth, int grade_x>
 inline void ConvolveKernelHorizontal2Tap(
     const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
     const int width, const int subpixel_x, const int step_x,
     const int intermediate_height, int16_t* LIBGAV1_RESTRICT intermediate) {
+  constexpr int kRoundBitsHorizontal = HorizontalRoundBits<bitdepth>();
   // Account for the 0-taps that precede the 2 nonzero taps in the spec.
   const int kernel_offset = 3;
   const int ref_x = subpixel_x >> kScaleSubPixelBits;
@@ -1977,7 +2018,7 @@ inline void ConvolveKernelHorizontal2Tap(
 
       vst1_s16(intermediate,
                vrshrn_n_s32(SumOnePassTaps</*num_taps=*/2>(src, taps),
-                            kInterRoundBitsHorizontal - 1));
+                            kRoundBitsHorizontal - 1));
       src_y = AddByteStride(src_y, src_stride);
       intermediate += kIntermediateStride;
     } while (--y != 0);
@@ -2032,10 +2073,10 @@ inline void ConvolveKernelHorizontal2Tap(
 
       vst1_s16(intermediate_x,
                vrshrn_n_s32(SumOnePassTaps</*num_taps=*/2>(src_low, taps_low),
-                            kInterRoundBitsHorizontal - 1));
+                            kRoundBitsHorizontal - 1));
       vst1_s16(intermediate_x + 4,
                vrshrn_n_s32(SumOnePassTaps</*num_taps=*/2>(src_high, taps_high),
-                            kInterRoundBitsHorizontal - 1));
+                            kRoundBitsHorizontal - 1));
       // Avoid right shifting the stride.
       src_x = AddByteStride(src_x, src_stride);
       intermediate_x += kIntermediateStride;
@@ -2059,10 +2100,12 @@ inline int8x16_t GetPositive4TapFilter(const int tap_index) {
 }
 
 // This filter is only possible when width <= 4.
+template <int bitdepth>
 inline void ConvolveKernelHorizontalPositive4Tap(
     const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
     const int subpixel_x, const int step_x, const int intermediate_height,
     int16_t* LIBGAV1_RESTRICT intermediate) {
+  constexpr int kRoundBitsHorizontal = HorizontalRoundBits<bitdepth>();
   // Account for the 0-taps that precede the 2 nonzero taps in the spec.
   const int kernel_offset = 2;
   const int ref_x = subpixel_x >> kScaleSubPixelBits;
@@ -2119,7 +2162,7 @@ inline void ConvolveKernelHorizontalPositive4Tap(
 
     vst1_s16(intermediate,
              vrshrn_n_s32(SumOnePassTaps</*num_taps=*/4>(src, taps),
-                          kInterRoundBitsHorizontal - 1));
+                          kRoundBitsHorizontal - 1));
     src_y = AddByteStride(src_y, src_stride);
     intermediate += kIntermediateStride;
   } while (--y != 0);
@@ -2139,10 +2182,12 @@ inline int8x16_t GetSigned4TapFilter(const int tap_index) {
 }
 
 // This filter is only possible when width <= 4.
+template <int bitdepth>
 inline void ConvolveKernelHorizontalSigned4Tap(
     const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
     const int subpixel_x, const int step_x, const int intermediate_height,
     int16_t* LIBGAV1_RESTRICT intermediate) {
+  constexpr int kRoundBitsHorizontal = HorizontalRoundBits<bitdepth>();
   const int kernel_offset = 2;
   const int ref_x = subpixel_x >> kScaleSubPixelBits;
   const uint8x8_t filter_index_mask = vdup_n_u8(kSubPixelMask);
@@ -2198,7 +2243,7 @@ inline void ConvolveKernelHorizontalSigned4Tap(
 
     vst1_s16(intermediate,
              vrshrn_n_s32(SumOnePassTaps</*num_taps=*/4>(src, taps),
-                          kInterRoundBitsHorizontal - 1));
+                          kRoundBitsHorizontal - 1));
     src_y = AddByteStride(src_y, src_stride);
     intermediate += kIntermediateStride;
   } while (--y != 0);
@@ -2220,12 +2265,13 @@ inline int8x16_t GetSigned6TapFilter(const int tap_index) {
 }
 
 // This filter is only possible when width >= 8.
-template <int grade_x>
+template <int bitdepth, int grade_x>
 inline void ConvolveKernelHorizontalSigned6Tap(
     const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
     const int width, const int subpixel_x, const int step_x,
     const int intermediate_height,
     int16_t* LIBGAV1_RESTRICT const intermediate) {
+  constexpr int kRoundBitsHorizontal = HorizontalRoundBits<bitdepth>();
   const int kernel_offset = 1;
   const uint8x8_t filter_index_mask = vdup_n_u8(kSubPixelMask);
   const int ref_x = subpixel_x >> kScaleSubPixelBits;
@@ -2294,10 +2340,10 @@ inline void ConvolveKernelHorizontalSigned6Tap(
 
       vst1_s16(intermediate_x,
                vrshrn_n_s32(SumOnePassTaps</*num_taps=*/6>(src_low, taps_low),
-                            kInterRoundBitsHorizontal - 1));
+                            kRoundBitsHorizontal - 1));
       vst1_s16(intermediate_x + 4,
                vrshrn_n_s32(SumOnePassTaps</*num_taps=*/6>(src_high, taps_high),
-                            kInterRoundBitsHorizontal - 1));
+                            kRoundBitsHorizontal - 1));
       // Avoid right shifting the stride.
       src_x = AddByteStride(src_x, src_stride);
       intermediate_x += kIntermediateStride;
@@ -2324,12 +2370,13 @@ inline int8x16_t GetMixed6TapFilter(const int tap_index) {
 }
 
 // This filter is only possible when width >= 8.
-template <int grade_x>
+template <int bitdepth, int grade_x>
 inline void ConvolveKernelHorizontalMixed6Tap(
     const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
     const int width, const int subpixel_x, const int step_x,
     const int intermediate_height,
     int16_t* LIBGAV1_RESTRICT const intermediate) {
+  constexpr int kRoundBitsHorizontal = HorizontalRoundBits<bitdepth>();
   const int kernel_offset = 1;
   const uint8x8_t filter_index_mask = vdup_n_u8(kSubPixelMask);
   const int ref_x = subpixel_x >> kScaleSubPixelBits;
@@ -2397,10 +2444,10 @@ inline void ConvolveKernelHorizontalMixed6Tap(
 
       vst1_s16(intermediate_x,
                vrshrn_n_s32(SumOnePassTaps</*num_taps=*/6>(src_low, taps_low),
-                            kInterRoundBitsHorizontal - 1));
+                            kRoundBitsHorizontal - 1));
       vst1_s16(intermediate_x + 4,
                vrshrn_n_s32(SumOnePassTaps</*num_taps=*/6>(src_high, taps_high),
-                            kInterRoundBitsHorizontal - 1));
+                            kRoundBitsHorizontal - 1));
       // Avoid right shifting the stride.
       src_x = AddByteStride(src_x, src_stride);
       intermediate_x += kIntermediateStride;
@@ -2430,12 +2477,13 @@ inline int8x16_t GetSigned8TapFilter(const int tap_index) {
 }
 
 // This filter is only possible when width >= 8.
-template <int grade_x>
+template <int bitdepth, int grade_x>
 inline void ConvolveKernelHorizontalSigned8Tap(
     const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
     const int width, const int subpixel_x, const int step_x,
     const int intermediate_height,
     int16_t* LIBGAV1_RESTRICT const intermediate) {
+  constexpr int kRoundBitsHorizontal = HorizontalRoundBits<bitdepth>();
   const uint8x8_t filter_index_mask = vdup_n_u8(kSubPixelMask);
   const int ref_x = subpixel_x >> kScaleSubPixelBits;
   const int step_x8 = step_x << 3;
@@ -2500,10 +2548,10 @@ inline void ConvolveKernelHorizontalSigned8Tap(
 
       vst1_s16(intermediate_x,
                vrshrn_n_s32(SumOnePassTaps</*num_taps=*/8>(src_low, taps_low),
-                            kInterRoundBitsHorizontal - 1));
+                            kRoundBitsHorizontal - 1));
       vst1_s16(intermediate_x + 4,
                vrshrn_n_s32(SumOnePassTaps</*num_taps=*/8>(src_high, taps_high),
-                            kInterRoundBitsHorizontal - 1));
+                            kRoundBitsHorizontal - 1));
       // Avoid right shifting the stride.
       src_x = AddByteStride(src_x, src_stride);
       intermediate_x += kIntermediateStride;
@@ -2514,9 +2562,10 @@ inline void ConvolveKernelHorizontalSigned8Tap(
 }
 
 // Process 16 bit inputs and output 32 bits.
-template <int num_taps, bool is_compound>
+template <int bitdepth, int num_taps, bool is_compound>
 inline int16x4_t Sum2DVerticalTaps4(const int16x4_t* const src,
                                     const int16x8_t taps) {
+  constexpr int kRoundBitsVertical = VerticalRoundBits<bitdepth>();
   const int16x4_t taps_lo = vget_low_s16(taps);
   const int16x4_t taps_hi = vget_high_s16(taps);
   int32x4_t sum;
@@ -2550,10 +2599,10 @@ inline int16x4_t Sum2DVerticalTaps4(const int16x4_t* const src,
     return vrshrn_n_s32(sum, kInterRoundBitsCompoundVertical - 1);
   }
 
-  return vreinterpret_s16_u16(vqrshrun_n_s32(sum, kInterRoundBitsVertical - 1));
+  return vreinterpret_s16_u16(vqrshrun_n_s32(sum, kRoundBitsVertical - 1));
 }
 
-template <int num_taps, int grade_y, int width, bool is_compound>
+template <int bitdepth, int num_taps, int grade_y, int width, bool is_compound>
 void ConvolveVerticalScale2Or4xH(const int16_t* LIBGAV1_RESTRICT const src,
                                  const int subpixel_y, const int filter_index,
                                  const int step_y, const int height,
@@ -2581,7 +2630,8 @@ void ConvolveVerticalScale2Or4xH(const int16_t* LIBGAV1_RESTRICT const src,
     int filter_id = (p >> 6) & kSubPixelMask;
     int16x8_t filter =
         vmovl_s8(vld1_s8(kHalfSubPixelFilters[filter_index][filter_id]));
-    int16x4_t sums = Sum2DVerticalTaps4<num_taps, is_compound>(s, filter);
+    int16x4_t sums = Sum2DVerticalTaps4<bitdepth, num_taps, is_compound>(
+        s, filter);
     if (is_compound) {
       assert(width != 2);
       // This offset potentially overflows into the sign bit, but should yield
@@ -2592,7 +2642,7 @@ void ConvolveVerticalScale2Or4xH(const int16_t* LIBGAV1_RESTRICT const src,
       compound_dest_y += dest_stride;
     } else {
       const uint16x4_t result = vmin_u16(vreinterpret_u16_s16(sums),
-                                         vdup_n_u16((1 << kBitdepth10) - 1));
+                                         vdup_n_u16((1 << bitdepth) - 1));
       if (width == 2) {
         Store2<0>(dest_y, result);
       } else {
@@ -2613,7 +2663,8 @@ void ConvolveVerticalScale2Or4xH(const int16_t* LIBGAV1_RESTRICT const src,
 
     filter_id = (p >> 6) & kSubPixelMask;
     filter = vmovl_s8(vld1_s8(kHalfSubPixelFilters[filter_index][filter_id]));
-    sums = Sum2DVerticalTaps4<num_taps, is_compound>(&s[p_diff], filter);
+    sums = Sum2DVerticalTaps4<bitdepth, num_taps, is_compound>(&s[p_diff],
+                                                               filter);
     if (is_compound) {
       assert(width != 2);
       const uint16x4_t result =
@@ -2622,7 +2673,7 @@ void ConvolveVerticalScale2Or4xH(const int16_t* LIBGAV1_RESTRICT const src,
       compound_dest_y += dest_stride;
     } else {
       const uint16x4_t result = vmin_u16(vreinterpret_u16_s16(sums),
-                                         vdup_n_u16((1 << kBitdepth10) - 1));
+                                         vdup_n_u16((1 << bitdepth) - 1));
       if (width == 2) {
         Store2<0>(dest_y, result);
       } else {
@@ -2637,7 +2688,7 @@ void ConvolveVerticalScale2Or4xH(const int16_t* LIBGAV1_RESTRICT const src,
   } while (y != 0);
 }
 
-template <int num_taps, int grade_y, bool is_compound>
+template <int bitdepth, int num_taps, int grade_y, bool is_compound>
 void ConvolveVerticalScale(const int16_t* LIBGAV1_RESTRICT const source,
                            const int intermediate_height, const int width,
                            const int subpixel_y, const int filter_index,
@@ -2670,7 +2721,7 @@ void ConvolveVerticalScale(const int16_t* LIBGAV1_RESTRICT const source,
       int16x8_t filter =
           vmovl_s8(vld1_s8(kHalfSubPixelFilters[filter_index][filter_id]));
       int16x8_t sums =
-          SimpleSum2DVerticalTaps<num_taps, is_compound>(s, filter);
+          SimpleSum2DVerticalTaps<bitdepth, num_taps, is_compound>(s, filter);
       if (is_compound) {
         // This offset potentially overflows int16_t, but should yield the
         // correct unsigned value.
@@ -2680,7 +2731,7 @@ void ConvolveVerticalScale(const int16_t* LIBGAV1_RESTRICT const source,
         compound_dest_y += dest_stride;
       } else {
         const uint16x8_t result = vminq_u16(
-            vreinterpretq_u16_s16(sums), vdupq_n_u16((1 << kBitdepth10) - 1));
+            vreinterpretq_u16_s16(sums), vdupq_n_u16((1 << bitdepth) - 1));
         vst1q_u16(dest_y, result);
         dest_y = AddByteStride(dest_y, dest_stride);
       }
@@ -2697,7 +2748,8 @@ void ConvolveVerticalScale(const int16_t* LIBGAV1_RESTRICT const source,
 
       filter_id = (p >> 6) & kSubPixelMask;
       filter = vmovl_s8(vld1_s8(kHalfSubPixelFilters[filter_index][filter_id]));
-      sums = SimpleSum2DVerticalTaps<num_taps, is_compound>(&s[p_diff], filter);
+      sums = SimpleSum2DVerticalTaps<bitdepth, num_taps, is_compound>(
+          &s[p_diff], filter);
       if (is_compound) {
         assert(width != 2);
         const uint16x8_t result = vreinterpretq_u16_s16(
@@ -2706,7 +2758,7 @@ void ConvolveVerticalScale(const int16_t* LIBGAV1_RESTRICT const source,
         compound_dest_y += dest_stride;
       } else {
         const uint16x8_t result = vminq_u16(
-            vreinterpretq_u16_s16(sums), vdupq_n_u16((1 << kBitdepth10) - 1));
+            vreinterpretq_u16_s16(sums), vdupq_n_u16((1 << bitdepth) - 1));
         vst1q_u16(dest_y, result);
         dest_y = AddByteStride(dest_y, dest_stride);
       }
@@ -2721,7 +2773,7 @@ void ConvolveVerticalScale(const int16_t* LIBGAV1_RESTRICT const source,
   } while (x < width);
 }
 
-template <bool is_compound>
+template <int bitdepth, bool is_compound>
 void ConvolveScale2D_NEON(const void* LIBGAV1_RESTRICT const reference,
                           const ptrdiff_t reference_stride,
                           const int horizontal_filter_index,
@@ -2774,58 +2826,60 @@ void ConvolveScale2D_NEON(const void* LIBGAV1_RESTRICT const reference,
   switch (filter_index) {
     case 0:
       if (step_x > grade_x_threshold) {
-        ConvolveKernelHorizontalSigned6Tap<2>(
+        ConvolveKernelHorizontalSigned6Tap<bitdepth, 2>(
             src, src_stride, width, subpixel_x, step_x, intermediate_height,
             intermediate);
       } else {
-        ConvolveKernelHorizontalSigned6Tap<1>(
+        ConvolveKernelHorizontalSigned6Tap<bitdepth, 1>(
             src, src_stride, width, subpixel_x, step_x, intermediate_height,
             intermediate);
       }
       break;
     case 1:
       if (step_x > grade_x_threshold) {
-        ConvolveKernelHorizontalMixed6Tap<2>(src, src_stride, width, subpixel_x,
-                                             step_x, intermediate_height,
-                                             intermediate);
+        ConvolveKernelHorizontalMixed6Tap<bitdepth, 2>(
+            src, src_stride, width, subpixel_x, step_x, intermediate_height,
+            intermediate);
 
       } else {
-        ConvolveKernelHorizontalMixed6Tap<1>(src, src_stride, width, subpixel_x,
-                                             step_x, intermediate_height,
-                                             intermediate);
+        ConvolveKernelHorizontalMixed6Tap<bitdepth, 1>(
+            src, src_stride, width, subpixel_x, step_x, intermediate_height,
+            intermediate);
       }
       break;
     case 2:
       if (step_x > grade_x_threshold) {
-        ConvolveKernelHorizontalSigned8Tap<2>(
+        ConvolveKernelHorizontalSigned8Tap<bitdepth, 2>(
             src, src_stride, width, subpixel_x, step_x, intermediate_height,
             intermediate);
       } else {
-        ConvolveKernelHorizontalSigned8Tap<1>(
+        ConvolveKernelHorizontalSigned8Tap<bitdepth, 1>(
             src, src_stride, width, subpixel_x, step_x, intermediate_height,
             intermediate);
       }
       break;
     case 3:
       if (step_x > grade_x_threshold) {
-        ConvolveKernelHorizontal2Tap<2>(src, src_stride, width, subpixel_x,
-                                        step_x, intermediate_height,
-                                        intermediate);
+        ConvolveKernelHorizontal2Tap<bitdepth, 2>(
+            src, src_stride, width, subpixel_x, step_x, intermediate_height,
+            intermediate);
       } else {
-        ConvolveKernelHorizontal2Tap<1>(src, src_stride, width, subpixel_x,
-                                        step_x, intermediate_height,
-                                        intermediate);
+        ConvolveKernelHorizontal2Tap<bitdepth, 1>(
+            src, src_stride, width, subpixel_x, step_x, intermediate_height,
+            intermediate);
       }
       break;
     case 4:
       assert(width <= 4);
-      ConvolveKernelHorizontalSigned4Tap(src, src_stride, subpixel_x, step_x,
-                                         intermediate_height, intermediate);
+      ConvolveKernelHorizontalSigned4Tap<bitdepth>(src, src_stride, subpixel_x,
+                                                   step_x, intermediate_height,
+                                                   intermediate);
       break;
     default:
       assert(filter_index == 5);
-      ConvolveKernelHorizontalPositive4Tap(src, src_stride, subpixel_x, step_x,
-                                           intermediate_height, intermediate);
+      ConvolveKernelHorizontalPositive4Tap<bitdepth>(
+          src, src_stride, subpixel_x, step_x, intermediate_height,
+          intermediate);
   }
 
   // Vertical filter.
@@ -2836,29 +2890,29 @@ void ConvolveScale2D_NEON(const void* LIBGAV1_RESTRICT const reference,
     case 1:
       if (step_y <= 1024) {
         if (!is_compound && width == 2) {
-          ConvolveVerticalScale2Or4xH<6, 1, 2, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 6, 1, 2, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else if (width == 4) {
-          ConvolveVerticalScale2Or4xH<6, 1, 4, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 6, 1, 4, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else {
-          ConvolveVerticalScale<6, 1, is_compound>(
+          ConvolveVerticalScale<bitdepth, 6, 1, is_compound>(
               intermediate, intermediate_height, width, subpixel_y,
               filter_index, step_y, height, prediction, pred_stride);
         }
       } else {
         if (!is_compound && width == 2) {
-          ConvolveVerticalScale2Or4xH<6, 2, 2, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 6, 2, 2, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else if (width == 4) {
-          ConvolveVerticalScale2Or4xH<6, 2, 4, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 6, 2, 4, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else {
-          ConvolveVerticalScale<6, 2, is_compound>(
+          ConvolveVerticalScale<bitdepth, 6, 2, is_compound>(
               intermediate, intermediate_height, width, subpixel_y,
               filter_index, step_y, height, prediction, pred_stride);
         }
@@ -2867,29 +2921,29 @@ void ConvolveScale2D_NEON(const void* LIBGAV1_RESTRICT const reference,
     case 2:
       if (step_y <= 1024) {
         if (!is_compound && width == 2) {
-          ConvolveVerticalScale2Or4xH<8, 1, 2, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 8, 1, 2, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else if (width == 4) {
-          ConvolveVerticalScale2Or4xH<8, 1, 4, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 8, 1, 4, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else {
-          ConvolveVerticalScale<8, 1, is_compound>(
+          ConvolveVerticalScale<bitdepth, 8, 1, is_compound>(
               intermediate, intermediate_height, width, subpixel_y,
               filter_index, step_y, height, prediction, pred_stride);
         }
       } else {
         if (!is_compound && width == 2) {
-          ConvolveVerticalScale2Or4xH<8, 2, 2, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 8, 2, 2, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else if (width == 4) {
-          ConvolveVerticalScale2Or4xH<8, 2, 4, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 8, 2, 4, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else {
-          ConvolveVerticalScale<8, 2, is_compound>(
+          ConvolveVerticalScale<bitdepth, 8, 2, is_compound>(
               intermediate, intermediate_height, width, subpixel_y,
               filter_index, step_y, height, prediction, pred_stride);
         }
@@ -2898,29 +2952,29 @@ void ConvolveScale2D_NEON(const void* LIBGAV1_RESTRICT const reference,
     case 3:
       if (step_y <= 1024) {
         if (!is_compound && width == 2) {
-          ConvolveVerticalScale2Or4xH<2, 1, 2, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 2, 1, 2, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else if (width == 4) {
-          ConvolveVerticalScale2Or4xH<2, 1, 4, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 2, 1, 4, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else {
-          ConvolveVerticalScale<2, 1, is_compound>(
+          ConvolveVerticalScale<bitdepth, 2, 1, is_compound>(
               intermediate, intermediate_height, width, subpixel_y,
               filter_index, step_y, height, prediction, pred_stride);
         }
       } else {
         if (!is_compound && width == 2) {
-          ConvolveVerticalScale2Or4xH<2, 2, 2, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 2, 2, 2, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else if (width == 4) {
-          ConvolveVerticalScale2Or4xH<2, 2, 4, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 2, 2, 4, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else {
-          ConvolveVerticalScale<2, 2, is_compound>(
+          ConvolveVerticalScale<bitdepth, 2, 2, is_compound>(
               intermediate, intermediate_height, width, subpixel_y,
               filter_index, step_y, height, prediction, pred_stride);
         }
@@ -2931,29 +2985,29 @@ void ConvolveScale2D_NEON(const void* LIBGAV1_RESTRICT const reference,
       assert(height <= 4);
       if (step_y <= 1024) {
         if (!is_compound && width == 2) {
-          ConvolveVerticalScale2Or4xH<4, 1, 2, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 4, 1, 2, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else if (width == 4) {
-          ConvolveVerticalScale2Or4xH<4, 1, 4, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 4, 1, 4, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else {
-          ConvolveVerticalScale<4, 1, is_compound>(
+          ConvolveVerticalScale<bitdepth, 4, 1, is_compound>(
               intermediate, intermediate_height, width, subpixel_y,
               filter_index, step_y, height, prediction, pred_stride);
         }
       } else {
         if (!is_compound && width == 2) {
-          ConvolveVerticalScale2Or4xH<4, 2, 2, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 4, 2, 2, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else if (width == 4) {
-          ConvolveVerticalScale2Or4xH<4, 2, 4, is_compound>(
+          ConvolveVerticalScale2Or4xH<bitdepth, 4, 2, 4, is_compound>(
               intermediate, subpixel_y, filter_index, step_y, height,
               prediction, pred_stride);
         } else {
-          ConvolveVerticalScale<4, 2, is_compound>(
+          ConvolveVerticalScale<bitdepth, 4, 2, is_compound>(
               intermediate, intermediate_height, width, subpixel_y,
               filter_index, step_y, height, prediction, pred_stride);
         }
@@ -2964,26 +3018,53 @@ void ConvolveScale2D_NEON(const void* LIBGAV1_RESTRICT const reference,
 void Init10bpp() {
   Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
   assert(dsp != nullptr);
-  dsp->convolve[0][0][0][1] = ConvolveHorizontal_NEON;
-  dsp->convolve[0][0][1][0] = ConvolveVertical_NEON;
-  dsp->convolve[0][0][1][1] = Convolve2D_NEON;
+  dsp->convolve[0][0][0][1] = ConvolveHorizontal_NEON<kBitdepth10>;
+  dsp->convolve[0][0][1][0] = ConvolveVertical_NEON<kBitdepth10>;
+  dsp->convolve[0][0][1][1] = Convolve2D_NEON<kBitdepth10>;
+
+  dsp->convolve[0][1][0][0] = ConvolveCompoundCopy_NEON<kBitdepth10>;
+  dsp->convolve[0][1][0][1] = ConvolveCompoundHorizontal_NEON<kBitdepth10>;
+  dsp->convolve[0][1][1][0] = ConvolveCompoundVertical_NEON<kBitdepth10>;
+  dsp->convolve[0][1][1][1] = ConvolveCompound2D_NEON<kBitdepth10>;
+
+  dsp->convolve[1][0][0][1] = ConvolveIntraBlockCopyHorizontal_NEON;
+  dsp->convolve[1][0][1][0] = ConvolveIntraBlockCopyVertical_NEON;
+  dsp->convolve[1][0][1][1] = ConvolveIntraBlockCopy2D_NEON;
+
+  dsp->convolve_scale[0] = ConvolveScale2D_NEON<kBitdepth10, false>;
+  dsp->convolve_scale[1] = ConvolveScale2D_NEON<kBitdepth10, true>;
+}
+
+#if LIBGAV1_MAX_BITDEPTH == 12
+void Init12bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth12);
+  assert(dsp != nullptr);
+  dsp->convolve[0][0][0][1] = ConvolveHorizontal_NEON<kBitdepth12>;
+  dsp->convolve[0][0][1][0] = ConvolveVertical_NEON<kBitdepth12>;
+  dsp->convolve[0][0][1][1] = Convolve2D_NEON<kBitdepth12>;
 
-  dsp->convolve[0][1][0][0] = ConvolveCompoundCopy_NEON;
-  dsp->convolve[0][1][0][1] = ConvolveCompoundHorizontal_NEON;
-  dsp->convolve[0][1][1][0] = ConvolveCompoundVertical_NEON;
-  dsp->convolve[0][1][1][1] = ConvolveCompound2D_NEON;
+  dsp->convolve[0][1][0][0] = ConvolveCompoundCopy_NEON<kBitdepth12>;
+  dsp->convolve[0][1][0][1] = ConvolveCompoundHorizontal_NEON<kBitdepth12>;
+  dsp->convolve[0][1][1][0] = ConvolveCompoundVertical_NEON<kBitdepth12>;
+  dsp->convolve[0][1][1][1] = ConvolveCompound2D_NEON<kBitdepth12>;
 
   dsp->convolve[1][0][0][1] = ConvolveIntraBlockCopyHorizontal_NEON;
   dsp->convolve[1][0][1][0] = ConvolveIntraBlockCopyVertical_NEON;
   dsp->convolve[1][0][1][1] = ConvolveIntraBlockCopy2D_NEON;
 
-  dsp->convolve_scale[0] = ConvolveScale2D_NEON<false>;
-  dsp->convolve_scale[1] = ConvolveScale2D_NEON<true>;
+  dsp->convolve_scale[0] = ConvolveScale2D_NEON<kBitdepth12, false>;
+  dsp->convolve_scale[1] = ConvolveScale2D_NEON<kBitdepth12, true>;
 }
+#endif  // LIBGAV1_MAX_BITDEPTH == 12
 
 }  // namespace
 
-void ConvolveInit10bpp_NEON() { Init10bpp(); }
+void ConvolveInit10bpp_NEON() {
+  Init10bpp();
+#if LIBGAV1_MAX_BITDEPTH == 12
+  Init12bpp();
+#endif
+}
 
 }  // namespace dsp
 }  // namespace libgav1
@@ -91,6 +91,38 @@ LIBGAV1_ALWAYS_INLINE void LoadSrc(const int32_t* LIBGAV1_RESTRICT src,
   }
 }
 
+// Computes (a * multiplier + rounding) >> (12 + shift) in each lane for the
+// identity row transforms. The 12bpp row inputs have 20 bits, so their
+// products with the 13 and 14 bit identity multipliers may not fit in 32 bits.
+// For 12bpp the integral part of multiplier / 4096 is applied after the shift
+// by 12, which leaves the result unchanged.
+template <int bitdepth, int32_t multiplier>
+LIBGAV1_ALWAYS_INLINE int32x4_t IdentityRowMultiply(const int32x4_t a,
+                                                    const int shift) {
+  const int32x4_t v_dual_round = vdupq_n_s32((1 + (shift << 1)) << 11);
+  if (bitdepth == kBitdepth10) {
+    const int32x4_t b = vmlaq_n_s32(v_dual_round, a, multiplier);
+    return vqshlq_s32(b, vdupq_n_s32(-(12 + shift)));
+  }
+  static_assert(multiplier >> 12 == 1 || multiplier >> 12 == 2, "");
+  const int32x4_t b = vmlaq_n_s32(v_dual_round, a, multiplier & 4095);
+  const int32x4_t a_integral = (multiplier >> 12 == 1) ? a : vaddq_s32(a, a);
+  const int32x4_t c = vaddq_s32(vshrq_n_s32(b, 12), a_integral);
+  return vshlq_s32(c, vdupq_n_s32(-shift));
+}
+
+// Saturates each 32 bit lane to the Max(bitdepth + 6, 16) bit range of the
+// row transform outputs.
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE int32x4_t ClampIntermediate(const int32x4_t a) {
+  if (bitdepth == kBitdepth10) {
+    return vmovl_s16(vqmovn_s32(a));
+  }
+  const int32x4_t max = vdupq_n_s32((1 << (bitdepth + 5)) - 1);
+  const int32x4_t min = vdupq_n_s32(-(1 << (bitdepth + 5)));
+  return vmaxq_s32(vminq_s32(a, max), min);
+}
+
 // Butterfly rotate 4 values.
 LIBGAV1_ALWAYS_INLINE void ButterflyRotation_4(int32x4_t* a, int32x4_t* b,
                                                const int angle,
@@ -101,7 +133,9 @@ LIBGAV1_ALWAYS_INLINE void ButterflyRotation_4(int32x4_t* a, int32x4_t* b,
   const int32x4_t acc_y = vmulq_n_s32(*a, sin128);
   // The max range for the input is 18 bits. The cos128/sin128 is 13 bits,
   // which leaves 1 bit for the add/subtract. For 10bpp, x/y will fit in a 32
-  // bit lane.
+  // bit lane. For 12bpp the input has 20 bits and the products may wrap, but
+  // x/y are representable in 32 bits for conformant streams, so the wrapped
+  // sums are exact.
   const int32x4_t x0 = vmlsq_n_s32(acc_x, *b, sin128);
   const int32x4_t y0 = vmlaq_n_s32(acc_y, *b, cos128);
   const int32x4_t x = vrshrq_n_s32(x0, 12);
@@ -189,7 +223,7 @@ using ButterflyRotationFunc = void (*)(int32x4_t* a, int32x4_t* b, int angle,
 //------------------------------------------------------------------------------
 // Discrete Cosine Transforms (DCT).
 
-template <int width>
+template <int bitdepth, int width>
 LIBGAV1_ALWAYS_INLINE bool DctDcOnly(void* dest, int adjusted_tx_height,
                                      bool should_round, int row_shift) {
   if (adjusted_tx_height > 1) return false;
@@ -204,8 +238,8 @@ LIBGAV1_ALWAYS_INLINE bool DctDcOnly(void* dest, int adjusted_tx_height,
   const int32x4_t xy = vqrdmulhq_n_s32(s0, cos128 << (31 - 12));
   // vqrshlq_s32 will shift right if shift value is negative.
   const int32x4_t xy_shifted = vqrshlq_s32(xy, vdupq_n_s32(-row_shift));
-  // Clamp result to signed 16 bits.
-  const int32x4_t result = vmovl_s16(vqmovn_s32(xy_shifted));
+  // Clamp result to the intermediate range.
+  const int32x4_t result = ClampIntermediate<bitdepth>(xy_shifted);
   if (width == 4) {
     vst1q_s32(dst, result);
   } else {
@@ -271,13 +305,13 @@ LIBGAV1_ALWAYS_INLINE void Dct4Stages(int32x4_t* s, const int32x4_t min,
   }
 }
 
-template <ButterflyRotationFunc butterfly_rotation>
+template <int bitdepth, ButterflyRotationFunc butterfly_rotation>
 LIBGAV1_ALWAYS_INLINE void Dct4_NEON(void* dest, int32_t step, bool is_row,
                                      int row_shift) {
   auto* const dst = static_cast<int32_t*>(dest);
   // When |is_row| is true, set range to the row range, otherwise, set to the
   // column range.
-  const int32_t range = is_row ? kBitdepth10 + 7 : 15;
+  const int32_t range = is_row ? bitdepth + 7 : bitdepth + 5;
   const int32x4_t min = vdupq_n_s32(-(1 << range));
   const int32x4_t max = vdupq_n_s32((1 << range) - 1);
   int32x4_t s[4], x[4];
@@ -302,7 +336,7 @@ LIBGAV1_ALWAYS_INLINE void Dct4_NEON(void* dest, int32_t step, bool is_row,
   if (is_row) {
     const int32x4_t v_row_shift = vdupq_n_s32(-row_shift);
     for (auto& i : s) {
-      i = vmovl_s16(vqmovn_s32(vqrshlq_s32(i, v_row_shift)));
+      i = ClampIntermediate<bitdepth>(vqrshlq_s32(i, v_row_shift));
     }
     int32x4x4_t y;
     for (int i = 0; i < 4; ++i) y.val[i] = s[i];
@@ -348,11 +382,11 @@ LIBGAV1_ALWAYS_INLINE void Dct8Stages(int32x4_t* s, const int32x4_t min,
 }
 
 // Process dct8 rows or columns, depending on the |is_row| flag.
-template <ButterflyRotationFunc butterfly_rotation>
+template <int bitdepth, ButterflyRotationFunc butterfly_rotation>
 LIBGAV1_ALWAYS_INLINE void Dct8_NEON(void* dest, int32_t step, bool is_row,
                                      int row_shift) {
   auto* const dst = static_cast<int32_t*>(dest);
-  const int32_t range = is_row ? kBitdepth10 + 7 : 15;
+  const int32_t range = is_row ? bitdepth + 7 : bitdepth + 5;
   const int32x4_t min = vdupq_n_s32(-(1 << range));
   const int32x4_t max = vdupq_n_s32((1 << range) - 1);
   int32x4_t s[8], x[8];
@@ -383,7 +417,7 @@ LIBGAV1_ALWAYS_INLINE void Dct8_NEON(void* dest, int32_t step, bool is_row,
   if (is_row) {
     const int32x4_t v_row_shift = vdupq_n_s32(-row_shift);
     for (auto& i : s) {
-      i = vmovl_s16(vqmovn_s32(vqrshlq_s32(i, v_row_shift)));
+      i = ClampIntermediate<bitdepth>(vqrshlq_s32(i, v_row_shift));
     }
     Transpose4x4(&s[0], &s[0]);
     Transpose4x4(&s[4], &s[4]);
@@ -455,11 +489,11 @@ LIBGAV1_ALWAYS_INLINE void Dct16Stages(int32x4_t* s, const int32x4_t min,
 }
 
 // Process dct16 rows or columns, depending on the |is_row| flag.
-template <ButterflyRotationFunc butterfly_rotation>
+template <int bitdepth, ButterflyRotationFunc butterfly_rotation>
 LIBGAV1_ALWAYS_INLINE void Dct16_NEON(void* dest, int32_t step, bool is_row,
                                       int row_shift) {
   auto* const dst = static_cast<int32_t*>(dest);
-  const int32_t range = is_row ? kBitdepth10 + 7 : 15;
+  const int32_t range = is_row ? bitdepth + 7 : bitdepth + 5;
   const int32x4_t min = vdupq_n_s32(-(1 << range));
   const int32x4_t max = vdupq_n_s32((1 << range) - 1);
   int32x4_t s[16], x[16];
@@ -501,7 +535,7 @@ LIBGAV1_ALWAYS_INLINE void Dct16_NEON(void* dest, int32_t step, bool is_row,
   if (is_row) {
     const int32x4_t v_row_shift = vdupq_n_s32(-row_shift);
     for (auto& i : s) {
-      i = vmovl_s16(vqmovn_s32(vqrshlq_s32(i, v_row_shift)));
+      i = ClampIntermediate<bitdepth>(vqrshlq_s32(i, v_row_shift));
     }
     for (int idx = 0; idx < 16; idx += 8) {
       Transpose4x4(&s[idx], &s[idx]);
@@ -627,10 +661,11 @@ LIBGAV1_ALWAYS_INLINE void Dct32Stages(int32x4_t* s, const int32x4_t min,
 }
 
 // Process dct32 rows or columns, depending on the |is_row| flag.
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void Dct32_NEON(void* dest, const int32_t step,
                                       const bool is_row, int row_shift) {
   auto* const dst = static_cast<int32_t*>(dest);
-  const int32_t range = is_row ? kBitdepth10 + 7 : 15;
+  const int32_t range = is_row ? bitdepth + 7 : bitdepth + 5;
   const int32x4_t min = vdupq_n_s32(-(1 << range));
   const int32x4_t max = vdupq_n_s32((1 << range) - 1);
   int32x4_t s[32], x[32];
@@ -696,7 +731,7 @@ LIBGAV1_ALWAYS_INLINE void Dct32_NEON(void* dest, const int32_t step,
       Transpose4x4(&s[idx], &output[0]);
       Transpose4x4(&s[idx + 4], &output[4]);
       for (auto& o : output) {
-        o = vmovl_s16(vqmovn_s32(vqrshlq_s32(o, v_row_shift)));
+        o = ClampIntermediate<bitdepth>(vqrshlq_s32(o, v_row_shift));
       }
       StoreDst<4>(dst, step, idx, &output[0]);
       StoreDst<4>(dst, step, idx + 4, &output[4]);
@@ -706,9 +741,10 @@ LIBGAV1_ALWAYS_INLINE void Dct32_NEON(void* dest, const int32_t step,
   }
 }
 
+template <int bitdepth>
 void Dct64_NEON(void* dest, int32_t step, bool is_row, int row_shift) {
   auto* const dst = static_cast<int32_t*>(dest);
-  const int32_t range = is_row ? kBitdepth10 + 7 : 15;
+  const int32_t range = is_row ? bitdepth + 7 : bitdepth + 5;
   const int32x4_t min = vdupq_n_s32(-(1 << range));
   const int32x4_t max = vdupq_n_s32((1 << range) - 1);
   int32x4_t s[64], x[32];
@@ -925,7 +961,7 @@ void Dct64_NEON(void* dest, int32_t step, bool is_row, int row_shift) {
       Transpose4x4(&s[idx], &output[0]);
       Transpose4x4(&s[idx + 4], &output[4]);
       for (auto& o : output) {
-        o = vmovl_s16(vqmovn_s32(vqrshlq_s32(o, v_row_shift)));
+        o = ClampIntermediate<bitdepth>(vqrshlq_s32(o, v_row_shift));
       }
       StoreDst<4>(dst, step, idx, &output[0]);
       StoreDst<4>(dst, step, idx + 4, &output[4]);
@@ -937,6 +973,7 @@ void Dct64_NEON(void* dest, int32_t step, bool is_row, int row_shift) {
 
 //------------------------------------------------------------------------------
 // Asymmetric Discrete Sine Transforms (ADST).
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void Adst4_NEON(void* dest, int32_t step, bool is_row,
                                       int row_shift) {
   auto* const dst = static_cast<int32_t*>(dest);
@@ -986,10 +1023,10 @@ LIBGAV1_ALWAYS_INLINE void Adst4_NEON(void* dest, int32_t step, bool is_row,
 
   if (is_row) {
     const int32x4_t v_row_shift = vdupq_n_s32(-row_shift);
-    x[0] = vmovl_s16(vqmovn_s32(vqrshlq_s32(x[0], v_row_shift)));
-    x[1] = vmovl_s16(vqmovn_s32(vqrshlq_s32(x[1], v_row_shift)));
-    x[2] = vmovl_s16(vqmovn_s32(vqrshlq_s32(x[2], v_row_shift)));
-    x[3] = vmovl_s16(vqmovn_s32(vqrshlq_s32(x[3], v_row_shift)));
+    x[0] = ClampIntermediate<bitdepth>(vqrshlq_s32(x[0], v_row_shift));
+    x[1] = ClampIntermediate<bitdepth>(vqrshlq_s32(x[1], v_row_shift));
+    x[2] = ClampIntermediate<bitdepth>(vqrshlq_s32(x[2], v_row_shift));
+    x[3] = ClampIntermediate<bitdepth>(vqrshlq_s32(x[3], v_row_shift));
     int32x4x4_t y;
     for (int i = 0; i < 4; ++i) y.val[i] = x[i];
     vst4q_s32(dst, y);
@@ -1001,6 +1038,7 @@ LIBGAV1_ALWAYS_INLINE void Adst4_NEON(void* dest, int32_t step, bool is_row,
 alignas(16) constexpr int32_t kAdst4DcOnlyMultiplier[4] = {1321, 2482, 3344,
                                                            2482};
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE bool Adst4DcOnly(void* dest, int adjusted_tx_height,
                                        bool should_round, int row_shift) {
   if (adjusted_tx_height > 1) return false;
@@ -1027,7 +1065,8 @@ LIBGAV1_ALWAYS_INLINE bool Adst4DcOnly(void* dest, int adjusted_tx_height,
 
   // vqrshlq_s32 will shift right if shift value is negative.
   vst1q_s32(dst,
-            vmovl_s16(vqmovn_s32(vqrshlq_s32(dst_0, vdupq_n_s32(-row_shift)))));
+            ClampIntermediate<bitdepth>(
+                vqrshlq_s32(dst_0, vdupq_n_s32(-row_shift))));
 
   return true;
 }
@@ -1067,11 +1106,11 @@ LIBGAV1_ALWAYS_INLINE bool Adst4DcOnlyColumn(void* dest, int adjusted_tx_height,
   return true;
 }
 
-template <ButterflyRotationFunc butterfly_rotation>
+template <int bitdepth, ButterflyRotationFunc butterfly_rotation>
 LIBGAV1_ALWAYS_INLINE void Adst8_NEON(void* dest, int32_t step, bool is_row,
                                       int row_shift) {
   auto* const dst = static_cast<int32_t*>(dest);
-  const int32_t range = is_row ? kBitdepth10 + 7 : 15;
+  const int32_t range = is_row ? bitdepth + 7 : bitdepth + 5;
   const int32x4_t min = vdupq_n_s32(-(1 << range));
   const int32x4_t max = vdupq_n_s32((1 << range) - 1);
   int32x4_t s[8], x[8];
@@ -1134,7 +1173,7 @@ LIBGAV1_ALWAYS_INLINE void Adst8_NEON(void* dest, int32_t step, bool is_row,
   if (is_row) {
     const int32x4_t v_row_shift = vdupq_n_s32(-row_shift);
     for (auto& i : x) {
-      i = vmovl_s16(vqmovn_s32(vqrshlq_s32(i, v_row_shift)));
+      i = ClampIntermediate<bitdepth>(vqrshlq_s32(i, v_row_shift));
     }
     Transpose4x4(&x[0], &x[0]);
     Transpose4x4(&x[4], &x[4]);
@@ -1145,6 +1184,7 @@ LIBGAV1_ALWAYS_INLINE void Adst8_NEON(void* dest, int32_t step, bool is_row,
   }
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE bool Adst8DcOnly(void* dest, int adjusted_tx_height,
                                        bool should_round, int row_shift) {
   if (adjusted_tx_height > 1) return false;
@@ -1192,7 +1232,8 @@ LIBGAV1_ALWAYS_INLINE bool Adst8DcOnly(void* dest, int adjusted_tx_height,
 
   for (int i = 0; i < 8; ++i) {
     // vqrshlq_s32 will shift right if shift value is negative.
-    x[i] = vmovl_s16(vqmovn_s32(vqrshlq_s32(x[i], vdupq_n_s32(-row_shift))));
+    x[i] = ClampIntermediate<bitdepth>(
+        vqrshlq_s32(x[i], vdupq_n_s32(-row_shift)));
     vst1q_lane_s32(&dst[i], x[i], 0);
   }
 
@@ -1253,11 +1294,11 @@ LIBGAV1_ALWAYS_INLINE bool Adst8DcOnlyColumn(void* dest, int adjusted_tx_height,
   return true;
 }
 
-template <ButterflyRotationFunc butterfly_rotation>
+template <int bitdepth, ButterflyRotationFunc butterfly_rotation>
 LIBGAV1_ALWAYS_INLINE void Adst16_NEON(void* dest, int32_t step, bool is_row,
                                        int row_shift) {
   auto* const dst = static_cast<int32_t*>(dest);
-  const int32_t range = is_row ? kBitdepth10 + 7 : 15;
+  const int32_t range = is_row ? bitdepth + 7 : bitdepth + 5;
   const int32x4_t min = vdupq_n_s32(-(1 << range));
   const int32x4_t max = vdupq_n_s32((1 << range) - 1);
   int32x4_t s[16], x[16];
@@ -1370,7 +1411,7 @@ LIBGAV1_ALWAYS_INLINE void Adst16_NEON(void* dest, int32_t step, bool is_row,
   if (is_row) {
     const int32x4_t v_row_shift = vdupq_n_s32(-row_shift);
     for (auto& i : x) {
-      i = vmovl_s16(vqmovn_s32(vqrshlq_s32(i, v_row_shift)));
+      i = ClampIntermediate<bitdepth>(vqrshlq_s32(i, v_row_shift));
     }
     for (int idx = 0; idx < 16; idx += 8) {
       Transpose4x4(&x[idx], &x[idx]);
@@ -1439,6 +1480,7 @@ LIBGAV1_ALWAYS_INLINE void Adst16DcOnlyInternal(int32x4_t* s, int32x4_t* x) {
   x[15] = vqnegq_s32(s[1]);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE bool Adst16DcOnly(void* dest, int adjusted_tx_height,
                                         bool should_round, int row_shift) {
   if (adjusted_tx_height > 1) return false;
@@ -1457,7 +1499,8 @@ LIBGAV1_ALWAYS_INLINE bool Adst16DcOnly(void* dest, int adjusted_tx_height,
 
   for (int i = 0; i < 16; ++i) {
     // vqrshlq_s32 will shift right if shift value is negative.
-    x[i] = vmovl_s16(vqmovn_s32(vqrshlq_s32(x[i], vdupq_n_s32(-row_shift))));
+    x[i] = ClampIntermediate<bitdepth>(
+        vqrshlq_s32(x[i], vdupq_n_s32(-row_shift)));
     vst1q_lane_s32(&dst[i], x[i], 0);
   }
 
@@ -1493,20 +1536,18 @@ LIBGAV1_ALWAYS_INLINE bool Adst16DcOnlyColumn(void* dest,
 //------------------------------------------------------------------------------
 // Identity Transforms.
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void Identity4_NEON(void* dest, int32_t step, int shift) {
   auto* const dst = static_cast<int32_t*>(dest);
-  const int32x4_t v_dual_round = vdupq_n_s32((1 + (shift << 1)) << 11);
-  const int32x4_t v_multiplier = vdupq_n_s32(kIdentity4Multiplier);
-  const int32x4_t v_shift = vdupq_n_s32(-(12 + shift));
   for (int i = 0; i < 4; ++i) {
     const int32x4_t v_src = vld1q_s32(&dst[i * step]);
-    const int32x4_t v_src_mult_lo =
-        vmlaq_s32(v_dual_round, v_src, v_multiplier);
-    const int32x4_t shift_lo = vqshlq_s32(v_src_mult_lo, v_shift);
-    vst1q_s32(&dst[i * step], vmovl_s16(vqmovn_s32(shift_lo)));
+    const int32x4_t shift_lo =
+        IdentityRowMultiply<bitdepth, kIdentity4Multiplier>(v_src, shift);
+    vst1q_s32(&dst[i * step], ClampIntermediate<bitdepth>(shift_lo));
   }
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE bool Identity4DcOnly(void* dest, int adjusted_tx_height,
                                            bool should_round, int tx_height) {
   if (adjusted_tx_height > 1) return false;
@@ -1518,16 +1559,13 @@ LIBGAV1_ALWAYS_INLINE bool Identity4DcOnly(void* dest, int adjusted_tx_height,
       vqrdmulhq_n_s32(v_src0, kTransformRowMultiplier << (31 - 12));
   const int32x4_t v_src = vbslq_s32(v_mask, v_src_round, v_src0);
   const int shift = tx_height < 16 ? 0 : 1;
-  const int32x4_t v_dual_round = vdupq_n_s32((1 + (shift << 1)) << 11);
-  const int32x4_t v_multiplier = vdupq_n_s32(kIdentity4Multiplier);
-  const int32x4_t v_shift = vdupq_n_s32(-(12 + shift));
-  const int32x4_t v_src_mult_lo = vmlaq_s32(v_dual_round, v_src, v_multiplier);
-  const int32x4_t dst_0 = vqshlq_s32(v_src_mult_lo, v_shift);
-  vst1q_lane_s32(dst, vmovl_s16(vqmovn_s32(dst_0)), 0);
+  const int32x4_t dst_0 =
+      IdentityRowMultiply<bitdepth, kIdentity4Multiplier>(v_src, shift);
+  vst1q_lane_s32(dst, ClampIntermediate<bitdepth>(dst_0), 0);
   return true;
 }
 
-template <int identity_size>
+template <int bitdepth, int identity_size>
 LIBGAV1_ALWAYS_INLINE void IdentityColumnStoreToFrame(
     Array2DView<uint16_t> frame, const int start_x, const int start_y,
     const int tx_width, const int tx_height,
@@ -1538,7 +1576,7 @@ LIBGAV1_ALWAYS_INLINE void IdentityColumnStoreToFrame(
   const int stride = frame.columns();
   uint16_t* LIBGAV1_RESTRICT dst = frame[start_y] + start_x;
   const int32x4_t v_dual_round = vdupq_n_s32((1 + (1 << 4)) << 11);
-  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << kBitdepth10) - 1);
+  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << bitdepth) - 1);
 
   if (identity_size < 32) {
     if (tx_width == 4) {
@@ -1640,6 +1678,7 @@ LIBGAV1_ALWAYS_INLINE void IdentityColumnStoreToFrame(
   }
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void Identity4RowColumnStoreToFrame(
     Array2DView<uint16_t> frame, const int start_x, const int start_y,
     const int tx_width, const int tx_height,
@@ -1647,14 +1686,14 @@ LIBGAV1_ALWAYS_INLINE void Identity4RowColumnStoreToFrame(
   const int stride = frame.columns();
   uint16_t* LIBGAV1_RESTRICT dst = frame[start_y] + start_x;
   const int32x4_t v_round = vdupq_n_s32((1 + (0)) << 11);
-  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << kBitdepth10) - 1);
+  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << bitdepth) - 1);
 
   if (tx_width == 4) {
     int i = 0;
     do {
       const int32x4_t v_src = vld1q_s32(&source[i * 4]);
-      const int32x4_t v_dst_row =
-          vshrq_n_s32(vmlaq_n_s32(v_round, v_src, kIdentity4Multiplier), 12);
+      const int32x4_t v_dst_row = ClampIntermediate<bitdepth>(
+          IdentityRowMultiply<bitdepth, kIdentity4Multiplier>(v_src, 0));
       const int32x4_t v_dst_col =
           vmlaq_n_s32(v_round, v_dst_row, kIdentity4Multiplier);
       const uint16x4_t frame_data = vld1_u16(dst);
@@ -1676,8 +1715,10 @@ LIBGAV1_ALWAYS_INLINE void Identity4RowColumnStoreToFrame(
             vmlaq_n_s32(v_round, v_src.val[0], kTransformRowMultiplier), 12);
         v_src_round.val[1] = vshrq_n_s32(
             vmlaq_n_s32(v_round, v_src.val[1], kTransformRowMultiplier), 12);
-        v_dst_row.val[0] = vqaddq_s32(v_src_round.val[0], v_src_round.val[0]);
-        v_dst_row.val[1] = vqaddq_s32(v_src_round.val[1], v_src_round.val[1]);
+        v_dst_row.val[0] = ClampIntermediate<bitdepth>(
+            vqaddq_s32(v_src_round.val[0], v_src_round.val[0]));
+        v_dst_row.val[1] = ClampIntermediate<bitdepth>(
+            vqaddq_s32(v_src_round.val[1], v_src_round.val[1]));
         v_dst_col.val[0] =
             vmlaq_n_s32(v_round, v_dst_row.val[0], kIdentity4Multiplier);
         v_dst_col.val[1] =
@@ -1698,6 +1739,7 @@ LIBGAV1_ALWAYS_INLINE void Identity4RowColumnStoreToFrame(
   }
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void Identity8Row32_NEON(void* dest, int32_t step) {
   auto* const dst = static_cast<int32_t*>(dest);
 
@@ -1709,11 +1751,12 @@ LIBGAV1_ALWAYS_INLINE void Identity8Row32_NEON(void* dest, int32_t step) {
     const int32x4_t v_src_hi = vld1q_s32(&dst[(i * step) + 4]);
     const int32x4_t a_lo = vrshrq_n_s32(v_src_lo, 1);
     const int32x4_t a_hi = vrshrq_n_s32(v_src_hi, 1);
-    vst1q_s32(&dst[i * step], vmovl_s16(vqmovn_s32(a_lo)));
-    vst1q_s32(&dst[(i * step) + 4], vmovl_s16(vqmovn_s32(a_hi)));
+    vst1q_s32(&dst[i * step], ClampIntermediate<bitdepth>(a_lo));
+    vst1q_s32(&dst[(i * step) + 4], ClampIntermediate<bitdepth>(a_hi));
   }
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void Identity8Row4_NEON(void* dest, int32_t step) {
   auto* const dst = static_cast<int32_t*>(dest);
 
@@ -1722,11 +1765,12 @@ LIBGAV1_ALWAYS_INLINE void Identity8Row4_NEON(void* dest, int32_t step) {
     const int32x4_t v_src_hi = vld1q_s32(&dst[(i * step) + 4]);
     const int32x4_t v_srcx2_lo = vqaddq_s32(v_src_lo, v_src_lo);
     const int32x4_t v_srcx2_hi = vqaddq_s32(v_src_hi, v_src_hi);
-    vst1q_s32(&dst[i * step], vmovl_s16(vqmovn_s32(v_srcx2_lo)));
-    vst1q_s32(&dst[(i * step) + 4], vmovl_s16(vqmovn_s32(v_srcx2_hi)));
+    vst1q_s32(&dst[i * step], ClampIntermediate<bitdepth>(v_srcx2_lo));
+    vst1q_s32(&dst[(i * step) + 4], ClampIntermediate<bitdepth>(v_srcx2_hi));
   }
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE bool Identity8DcOnly(void* dest, int adjusted_tx_height,
                                            bool should_round, int row_shift) {
   if (adjusted_tx_height > 1) return false;
@@ -1739,33 +1783,34 @@ LIBGAV1_ALWAYS_INLINE bool Identity8DcOnly(void* dest, int adjusted_tx_height,
   const int32x4_t v_src = vbslq_s32(v_mask, v_src_round, v_src0);
   const int32x4_t v_srcx2 = vaddq_s32(v_src, v_src);
   const int32x4_t dst_0 = vqrshlq_s32(v_srcx2, vdupq_n_s32(-row_shift));
-  vst1q_lane_s32(dst, vmovl_s16(vqmovn_s32(dst_0)), 0);
+  vst1q_lane_s32(dst, ClampIntermediate<bitdepth>(dst_0), 0);
   return true;
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void Identity16Row_NEON(void* dest, int32_t step,
                                               int shift) {
   auto* const dst = static_cast<int32_t*>(dest);
-  const int32x4_t v_dual_round = vdupq_n_s32((1 + (shift << 1)) << 11);
-  const int32x4_t v_shift = vdupq_n_s32(-(12 + shift));
 
   for (int i = 0; i < 4; ++i) {
     for (int j = 0; j < 2; ++j) {
       int32x4x2_t v_src;
       v_src.val[0] = vld1q_s32(&dst[i * step + j * 8]);
       v_src.val[1] = vld1q_s32(&dst[i * step + j * 8 + 4]);
-      const int32x4_t v_src_mult_lo =
-          vmlaq_n_s32(v_dual_round, v_src.val[0], kIdentity16Multiplier);
-      const int32x4_t v_src_mult_hi =
-          vmlaq_n_s32(v_dual_round, v_src.val[1], kIdentity16Multiplier);
-      const int32x4_t shift_lo = vqshlq_s32(v_src_mult_lo, v_shift);
-      const int32x4_t shift_hi = vqshlq_s32(v_src_mult_hi, v_shift);
-      vst1q_s32(&dst[i * step + j * 8], vmovl_s16(vqmovn_s32(shift_lo)));
-      vst1q_s32(&dst[i * step + j * 8 + 4], vmovl_s16(vqmovn_s32(shift_hi)));
+      const int32x4_t shift_lo =
+          IdentityRowMultiply<bitdepth, kIdentity16Multiplier>(v_src.val[0],
+                                                               shift);
+      const int32x4_t shift_hi =
+          IdentityRowMultiply<bitdepth, kIdentity16Multiplier>(v_src.val[1],
+                                                               shift);
+      vst1q_s32(&dst[i * step + j * 8], ClampIntermediate<bitdepth>(shift_lo));
+      vst1q_s32(&dst[i * step + j * 8 + 4],
+                ClampIntermediate<bitdepth>(shift_hi));
     }
   }
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE bool Identity16DcOnly(void* dest, int adjusted_tx_height,
                                             bool should_round, int shift) {
   if (adjusted_tx_height > 1) return false;
@@ -1776,11 +1821,9 @@ LIBGAV1_ALWAYS_INLINE bool Identity16DcOnly(void* dest, int adjusted_tx_height,
   const int32x4_t v_src_round =
       vqrdmulhq_n_s32(v_src0, kTransformRowMultiplier << (31 - 12));
   const int32x4_t v_src = vbslq_s32(v_mask, v_src_round, v_src0);
-  const int32x4_t v_dual_round = vdupq_n_s32((1 + (shift << 1)) << 11);
-  const int32x4_t v_src_mult_lo =
-      vmlaq_n_s32(v_dual_round, v_src, kIdentity16Multiplier);
-  const int32x4_t dst_0 = vqshlq_s32(v_src_mult_lo, vdupq_n_s32(-(12 + shift)));
-  vst1q_lane_s32(dst, vmovl_s16(vqmovn_s32(dst_0)), 0);
+  const int32x4_t dst_0 =
+      IdentityRowMultiply<bitdepth, kIdentity16Multiplier>(v_src, shift);
+  vst1q_lane_s32(dst, ClampIntermediate<bitdepth>(dst_0), 0);
   return true;
 }
 
@@ -1820,6 +1863,7 @@ LIBGAV1_ALWAYS_INLINE bool Identity32DcOnly(void* dest,
 // Walsh Hadamard Transform.
 
 // Process 4 wht4 rows and columns.
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void Wht4_NEON(uint16_t* LIBGAV1_RESTRICT dst,
                                      const int dst_stride,
                                      const void* LIBGAV1_RESTRICT source,
@@ -1888,7 +1932,7 @@ LIBGAV1_ALWAYS_INLINE void Wht4_NEON(uint16_t* LIBGAV1_RESTRICT dst,
   }
 
   // Store to frame.
-  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << kBitdepth10) - 1);
+  const uint16x4_t v_max_bitdepth = vdup_n_u16((1 << bitdepth) - 1);
   for (int row = 0; row < 4; row += 1) {
     const uint16x4_t frame_data = vld1_u16(dst);
     const int32x4_t b = vaddw_s16(s[row], vreinterpret_s16_u16(frame_data));
@@ -1984,7 +2028,7 @@ LIBGAV1_ALWAYS_INLINE void RowShift(int32_t* source, int num_rows,
   } while (i < tx_width * num_rows);
 }
 
-template <int tx_height, bool enable_flip_rows = false>
+template <int bitdepth, int tx_height, bool enable_flip_rows = false>
 LIBGAV1_ALWAYS_INLINE void StoreToFrameWithRound(
     Array2DView<uint16_t> frame, const int start_x, const int start_y,
     const int tx_width, const int32_t* LIBGAV1_RESTRICT source,
@@ -2002,7 +2046,7 @@ LIBGAV1_ALWAYS_INLINE void StoreToFrameWithRound(
       const int32x4_t a = vrshrq_n_s32(residual, 4);
       const uint32x4_t b = vaddw_u16(vreinterpretq_u32_s32(a), frame_data);
       const uint16x4_t d = vqmovun_s32(vreinterpretq_s32_u32(b));
-      vst1_u16(dst, vmin_u16(d, vdup_n_u16((1 << kBitdepth10) - 1)));
+      vst1_u16(dst, vmin_u16(d, vdup_n_u16((1 << bitdepth) - 1)));
       dst += stride;
     }
   } else {
@@ -2024,13 +2068,14 @@ LIBGAV1_ALWAYS_INLINE void StoreToFrameWithRound(
         const uint16x4_t d = vqmovun_s32(vreinterpretq_s32_u32(b));
         const uint16x4_t d_hi = vqmovun_s32(vreinterpretq_s32_u32(b_hi));
         vst1q_u16(frame[y] + x, vminq_u16(vcombine_u16(d, d_hi),
-                                          vdupq_n_u16((1 << kBitdepth10) - 1)));
+                                          vdupq_n_u16((1 << bitdepth) - 1)));
         j += 8;
       } while (j < tx_width);
     }
   }
 }
 
+template <int bitdepth>
 void Dct4TransformLoopRow_NEON(TransformType /*tx_type*/, TransformSize tx_size,
                                int adjusted_tx_height, void* src_buffer,
                                int /*start_x*/, int /*start_y*/,
@@ -2040,7 +2085,8 @@ void Dct4TransformLoopRow_NEON(TransformType /*tx_type*/, TransformSize tx_size,
   const bool should_round = (tx_height == 8);
   const int row_shift = static_cast<int>(tx_height == 16);
 
-  if (DctDcOnly<4>(src, adjusted_tx_height, should_round, row_shift)) {
+  if (DctDcOnly<bitdepth, 4>(src, adjusted_tx_height, should_round,
+                             row_shift)) {
     return;
   }
 
@@ -2052,13 +2098,14 @@ void Dct4TransformLoopRow_NEON(TransformType /*tx_type*/, TransformSize tx_size,
   int i = adjusted_tx_height;
   auto* data = src;
   do {
-    Dct4_NEON<ButterflyRotation_4>(data, /*step=*/4, /*is_row=*/true,
-                                   row_shift);
+    Dct4_NEON<bitdepth, ButterflyRotation_4>(data, /*step=*/4, /*is_row=*/true,
+                                             row_shift);
     data += 16;
     i -= 4;
   } while (i != 0);
 }
 
+template <int bitdepth>
 void Dct4TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
                                   int adjusted_tx_height,
                                   void* LIBGAV1_RESTRICT src_buffer,
@@ -2076,17 +2123,19 @@ void Dct4TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
     int i = tx_width;
     auto* data = src;
     do {
-      Dct4_NEON<ButterflyRotation_4>(data, tx_width, /*transpose=*/false,
-                                     /*row_shift=*/0);
+      Dct4_NEON<bitdepth, ButterflyRotation_4>(
+          data, tx_width, /*transpose=*/false, /*row_shift=*/0);
       data += 4;
       i -= 4;
     } while (i != 0);
   }
 
   auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
-  StoreToFrameWithRound<4>(frame, start_x, start_y, tx_width, src, tx_type);
+  StoreToFrameWithRound<bitdepth, 4>(frame, start_x, start_y, tx_width, src,
+                                     tx_type);
 }
 
+template <int bitdepth>
 void Dct8TransformLoopRow_NEON(TransformType /*tx_type*/, TransformSize tx_size,
                                int adjusted_tx_height, void* src_buffer,
                                int /*start_x*/, int /*start_y*/,
@@ -2095,7 +2144,8 @@ void Dct8TransformLoopRow_NEON(TransformType /*tx_type*/, TransformSize tx_size,
   const bool should_round = kShouldRound[tx_size];
   const uint8_t row_shift = kTransformRowShift[tx_size];
 
-  if (DctDcOnly<8>(src, adjusted_tx_height, should_round, row_shift)) {
+  if (DctDcOnly<bitdepth, 8>(src, adjusted_tx_height, should_round,
+                             row_shift)) {
     return;
   }
 
@@ -2107,13 +2157,14 @@ void Dct8TransformLoopRow_NEON(TransformType /*tx_type*/, TransformSize tx_size,
   int i = adjusted_tx_height;
   auto* data = src;
   do {
-    Dct8_NEON<ButterflyRotation_4>(data, /*step=*/8, /*is_row=*/true,
-                                   row_shift);
+    Dct8_NEON<bitdepth, ButterflyRotation_4>(data, /*step=*/8, /*is_row=*/true,
+                                             row_shift);
     data += 32;
     i -= 4;
   } while (i != 0);
 }
 
+template <int bitdepth>
 void Dct8TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
                                   int adjusted_tx_height,
                                   void* LIBGAV1_RESTRICT src_buffer,
@@ -2131,16 +2182,18 @@ void Dct8TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
     int i = tx_width;
     auto* data = src;
     do {
-      Dct8_NEON<ButterflyRotation_4>(data, tx_width, /*is_row=*/false,
-                                     /*row_shift=*/0);
+      Dct8_NEON<bitdepth, ButterflyRotation_4>(data, tx_width, /*is_row=*/false,
+                                               /*row_shift=*/0);
       data += 4;
       i -= 4;
     } while (i != 0);
   }
   auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
-  StoreToFrameWithRound<8>(frame, start_x, start_y, tx_width, src, tx_type);
+  StoreToFrameWithRound<bitdepth, 8>(frame, start_x, start_y, tx_width, src,
+                                     tx_type);
 }
 
+template <int bitdepth>
 void Dct16TransformLoopRow_NEON(TransformType /*tx_type*/,
                                 TransformSize tx_size, int adjusted_tx_height,
                                 void* src_buffer, int /*start_x*/,
@@ -2149,7 +2202,8 @@ void Dct16TransformLoopRow_NEON(TransformType /*tx_type*/,
   const bool should_round = kShouldRound[tx_size];
   const uint8_t row_shift = kTransformRowShift[tx_size];
 
-  if (DctDcOnly<16>(src, adjusted_tx_height, should_round, row_shift)) {
+  if (DctDcOnly<bitdepth, 16>(src, adjusted_tx_height, should_round,
+                              row_shift)) {
     return;
   }
 
@@ -2162,12 +2216,14 @@ void Dct16TransformLoopRow_NEON(TransformType /*tx_type*/,
   auto* data = src;
   do {
     // Process 4 1d dct16 rows in parallel per iteration.
-    Dct16_NEON<ButterflyRotation_4>(data, 16, /*is_row=*/true, row_shift);
+    Dct16_NEON<bitdepth, ButterflyRotation_4>(data, 16, /*is_row=*/true,
+                                              row_shift);
     data += 64;
     i -= 4;
   } while (i != 0);
 }
 
+template <int bitdepth>
 void Dct16TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
                                    int adjusted_tx_height,
                                    void* LIBGAV1_RESTRICT src_buffer,
@@ -2185,16 +2241,18 @@ void Dct16TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
     int i = tx_width;
     auto* data = src;
     do {
-      Dct16_NEON<ButterflyRotation_4>(data, tx_width, /*is_row=*/false,
-                                      /*row_shift=*/0);
+      Dct16_NEON<bitdepth, ButterflyRotation_4>(
+          data, tx_width, /*is_row=*/false, /*row_shift=*/0);
       data += 4;
       i -= 4;
     } while (i != 0);
   }
   auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
-  StoreToFrameWithRound<16>(frame, start_x, start_y, tx_width, src, tx_type);
+  StoreToFrameWithRound<bitdepth, 16>(frame, start_x, start_y, tx_width, src,
+                                      tx_type);
 }
 
+template <int bitdepth>
 void Dct32TransformLoopRow_NEON(TransformType /*tx_type*/,
                                 TransformSize tx_size, int adjusted_tx_height,
                                 void* src_buffer, int /*start_x*/,
@@ -2203,7 +2261,8 @@ void Dct32TransformLoopRow_NEON(TransformType /*tx_type*/,
   const bool should_round = kShouldRound[tx_size];
   const uint8_t row_shift = kTransformRowShift[tx_size];
 
-  if (DctDcOnly<32>(src, adjusted_tx_height, should_round, row_shift)) {
+  if (DctDcOnly<bitdepth, 32>(src, adjusted_tx_height, should_round,
+                              row_shift)) {
     return;
   }
 
@@ -2216,12 +2275,13 @@ void Dct32TransformLoopRow_NEON(TransformType /*tx_type*/,
   auto* data = src;
   do {
     // Process 4 1d dct32 rows in parallel per iteration.
-    Dct32_NEON(data, 32, /*is_row=*/true, row_shift);
+    Dct32_NEON<bitdepth>(data, 32, /*is_row=*/true, row_shift);
     data += 128;
     i -= 4;
   } while (i != 0);
 }
 
+template <int bitdepth>
 void Dct32TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
                                    int adjusted_tx_height,
                                    void* LIBGAV1_RESTRICT src_buffer,
@@ -2239,15 +2299,17 @@ void Dct32TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
     int i = tx_width;
     auto* data = src;
     do {
-      Dct32_NEON(data, tx_width, /*is_row=*/false, /*row_shift=*/0);
+      Dct32_NEON<bitdepth>(data, tx_width, /*is_row=*/false, /*row_shift=*/0);
       data += 4;
       i -= 4;
     } while (i != 0);
   }
   auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
-  StoreToFrameWithRound<32>(frame, start_x, start_y, tx_width, src, tx_type);
+  StoreToFrameWithRound<bitdepth, 32>(frame, start_x, start_y, tx_width, src,
+                                      tx_type);
 }
 
+template <int bitdepth>
 void Dct64TransformLoopRow_NEON(TransformType /*tx_type*/,
                                 TransformSize tx_size, int adjusted_tx_height,
                                 void* src_buffer, int /*start_x*/,
@@ -2256,7 +2318,8 @@ void Dct64TransformLoopRow_NEON(TransformType /*tx_type*/,
   const bool should_round = kShouldRound[tx_size];
   const uint8_t row_shift = kTransformRowShift[tx_size];
 
-  if (DctDcOnly<64>(src, adjusted_tx_height, should_round, row_shift)) {
+  if (DctDcOnly<bitdepth, 64>(src, adjusted_tx_height, should_round,
+                              row_shift)) {
     return;
   }
 
@@ -2269,12 +2332,13 @@ void Dct64TransformLoopRow_NEON(TransformType /*tx_type*/,
   auto* data = src;
   do {
     // Process 4 1d dct64 rows in parallel per iteration.
-    Dct64_NEON(data, 64, /*is_row=*/true, row_shift);
+    Dct64_NEON<bitdepth>(data, 64, /*is_row=*/true, row_shift);
     data += 128 * 2;
     i -= 4;
   } while (i != 0);
 }
 
+template <int bitdepth>
 void Dct64TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
                                    int adjusted_tx_height,
                                    void* LIBGAV1_RESTRICT src_buffer,
@@ -2292,15 +2356,17 @@ void Dct64TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
     int i = tx_width;
     auto* data = src;
     do {
-      Dct64_NEON(data, tx_width, /*is_row=*/false, /*row_shift=*/0);
+      Dct64_NEON<bitdepth>(data, tx_width, /*is_row=*/false, /*row_shift=*/0);
       data += 4;
       i -= 4;
     } while (i != 0);
   }
   auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
-  StoreToFrameWithRound<64>(frame, start_x, start_y, tx_width, src, tx_type);
+  StoreToFrameWithRound<bitdepth, 64>(frame, start_x, start_y, tx_width, src,
+                                      tx_type);
 }
 
+template <int bitdepth>
 void Adst4TransformLoopRow_NEON(TransformType /*tx_type*/,
                                 TransformSize tx_size, int adjusted_tx_height,
                                 void* src_buffer, int /*start_x*/,
@@ -2310,7 +2376,7 @@ void Adst4TransformLoopRow_NEON(TransformType /*tx_type*/,
   const int row_shift = static_cast<int>(tx_height == 16);
   const bool should_round = (tx_height == 8);
 
-  if (Adst4DcOnly(src, adjusted_tx_height, should_round, row_shift)) {
+  if (Adst4DcOnly<bitdepth>(src, adjusted_tx_height, should_round, row_shift)) {
     return;
   }
 
@@ -2322,12 +2388,13 @@ void Adst4TransformLoopRow_NEON(TransformType /*tx_type*/,
   int i = adjusted_tx_height;
   auto* data = src;
   do {
-    Adst4_NEON(data, /*step=*/4, /*is_row=*/true, row_shift);
+    Adst4_NEON<bitdepth>(data, /*step=*/4, /*is_row=*/true, row_shift);
     data += 16;
     i -= 4;
   } while (i != 0);
 }
 
+template <int bitdepth>
 void Adst4TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
                                    int adjusted_tx_height,
                                    void* LIBGAV1_RESTRICT src_buffer,
@@ -2345,17 +2412,18 @@ void Adst4TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
     int i = tx_width;
     auto* data = src;
     do {
-      Adst4_NEON(data, tx_width, /*is_row=*/false, /*row_shift=*/0);
+      Adst4_NEON<bitdepth>(data, tx_width, /*is_row=*/false, /*row_shift=*/0);
       data += 4;
       i -= 4;
     } while (i != 0);
   }
 
   auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
-  StoreToFrameWithRound<4, /*enable_flip_rows=*/true>(frame, start_x, start_y,
-                                                      tx_width, src, tx_type);
+  StoreToFrameWithRound<bitdepth, 4, /*enable_flip_rows=*/true>(
+      frame, start_x, start_y, tx_width, src, tx_type);
 }
 
+template <int bitdepth>
 void Adst8TransformLoopRow_NEON(TransformType /*tx_type*/,
                                 TransformSize tx_size, int adjusted_tx_height,
                                 void* src_buffer, int /*start_x*/,
@@ -2364,7 +2432,7 @@ void Adst8TransformLoopRow_NEON(TransformType /*tx_type*/,
   const bool should_round = kShouldRound[tx_size];
   const uint8_t row_shift = kTransformRowShift[tx_size];
 
-  if (Adst8DcOnly(src, adjusted_tx_height, should_round, row_shift)) {
+  if (Adst8DcOnly<bitdepth>(src, adjusted_tx_height, should_round, row_shift)) {
     return;
   }
 
@@ -2377,13 +2445,14 @@ void Adst8TransformLoopRow_NEON(TransformType /*tx_type*/,
   int i = adjusted_tx_height;
   auto* data = src;
   do {
-    Adst8_NEON<ButterflyRotation_4>(data, /*step=*/8,
-                                    /*transpose=*/true, row_shift);
+    Adst8_NEON<bitdepth, ButterflyRotation_4>(data, /*step=*/8,
+                                              /*transpose=*/true, row_shift);
     data += 32;
     i -= 4;
   } while (i != 0);
 }
 
+template <int bitdepth>
 void Adst8TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
                                    int adjusted_tx_height,
                                    void* LIBGAV1_RESTRICT src_buffer,
@@ -2401,17 +2470,18 @@ void Adst8TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
     int i = tx_width;
     auto* data = src;
     do {
-      Adst8_NEON<ButterflyRotation_4>(data, tx_width, /*transpose=*/false,
-                                      /*row_shift=*/0);
+      Adst8_NEON<bitdepth, ButterflyRotation_4>(
+          data, tx_width, /*transpose=*/false, /*row_shift=*/0);
       data += 4;
       i -= 4;
     } while (i != 0);
   }
   auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
-  StoreToFrameWithRound<8, /*enable_flip_rows=*/true>(frame, start_x, start_y,
-                                                      tx_width, src, tx_type);
+  StoreToFrameWithRound<bitdepth, 8, /*enable_flip_rows=*/true>(
+      frame, start_x, start_y, tx_width, src, tx_type);
 }
 
+template <int bitdepth>
 void Adst16TransformLoopRow_NEON(TransformType /*tx_type*/,
                                  TransformSize tx_size, int adjusted_tx_height,
                                  void* src_buffer, int /*start_x*/,
@@ -2420,7 +2490,8 @@ void Adst16TransformLoopRow_NEON(TransformType /*tx_type*/,
   const bool should_round = kShouldRound[tx_size];
   const uint8_t row_shift = kTransformRowShift[tx_size];
 
-  if (Adst16DcOnly(src, adjusted_tx_height, should_round, row_shift)) {
+  if (Adst16DcOnly<bitdepth>(src, adjusted_tx_height, should_round,
+                             row_shift)) {
     return;
   }
 
@@ -2432,12 +2503,14 @@ void Adst16TransformLoopRow_NEON(TransformType /*tx_type*/,
   int i = adjusted_tx_height;
   do {
     // Process 4 1d adst16 rows in parallel per iteration.
-    Adst16_NEON<ButterflyRotation_4>(src, 16, /*is_row=*/true, row_shift);
+    Adst16_NEON<bitdepth, ButterflyRotation_4>(src, 16, /*is_row=*/true,
+                                               row_shift);
     src += 64;
     i -= 4;
   } while (i != 0);
 }
 
+template <int bitdepth>
 void Adst16TransformLoopColumn_NEON(TransformType tx_type,
                                     TransformSize tx_size,
                                     int adjusted_tx_height,
@@ -2456,17 +2529,18 @@ void Adst16TransformLoopColumn_NEON(TransformType tx_type,
     auto* data = src;
     do {
       // Process 4 1d adst16 columns in parallel per iteration.
-      Adst16_NEON<ButterflyRotation_4>(data, tx_width, /*is_row=*/false,
-                                       /*row_shift=*/0);
+      Adst16_NEON<bitdepth, ButterflyRotation_4>(
+          data, tx_width, /*is_row=*/false, /*row_shift=*/0);
       data += 4;
       i -= 4;
     } while (i != 0);
   }
   auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
-  StoreToFrameWithRound<16, /*enable_flip_rows=*/true>(frame, start_x, start_y,
-                                                       tx_width, src, tx_type);
+  StoreToFrameWithRound<bitdepth, 16, /*enable_flip_rows=*/true>(
+      frame, start_x, start_y, tx_width, src, tx_type);
 }
 
+template <int bitdepth>
 void Identity4TransformLoopRow_NEON(TransformType tx_type,
                                     TransformSize tx_size,
                                     int adjusted_tx_height, void* src_buffer,
@@ -2483,7 +2557,8 @@ void Identity4TransformLoopRow_NEON(TransformType tx_type,
   const int tx_height = kTransformHeight[tx_size];
   const bool should_round = (tx_height == 8);
 
-  if (Identity4DcOnly(src, adjusted_tx_height, should_round, tx_height)) {
+  if (Identity4DcOnly<bitdepth>(src, adjusted_tx_height, should_round,
+                                tx_height)) {
     return;
   }
 
@@ -2494,12 +2569,13 @@ void Identity4TransformLoopRow_NEON(TransformType tx_type,
   const int shift = tx_height > 8 ? 1 : 0;
   int i = adjusted_tx_height;
   do {
-    Identity4_NEON(src, /*step=*/4, shift);
+    Identity4_NEON<bitdepth>(src, /*step=*/4, shift);
     src += 16;
     i -= 4;
   } while (i != 0);
 }
 
+template <int bitdepth>
 void Identity4TransformLoopColumn_NEON(TransformType tx_type,
                                        TransformSize tx_size,
                                        int adjusted_tx_height,
@@ -2513,8 +2589,8 @@ void Identity4TransformLoopColumn_NEON(TransformType tx_type,
   // Special case: Process row calculations during column transform call.
   if (tx_type == kTransformTypeIdentityIdentity &&
       (tx_size == kTransformSize4x4 || tx_size == kTransformSize8x4)) {
-    Identity4RowColumnStoreToFrame(frame, start_x, start_y, tx_width,
-                                   adjusted_tx_height, src);
+    Identity4RowColumnStoreToFrame<bitdepth>(frame, start_x, start_y, tx_width,
+                                             adjusted_tx_height, src);
     return;
   }
 
@@ -2522,10 +2598,11 @@ void Identity4TransformLoopColumn_NEON(TransformType tx_type,
     FlipColumns<4>(src, tx_width);
   }
 
-  IdentityColumnStoreToFrame<4>(frame, start_x, start_y, tx_width,
-                                adjusted_tx_height, src);
+  IdentityColumnStoreToFrame<bitdepth, 4>(frame, start_x, start_y, tx_width,
+                                          adjusted_tx_height, src);
 }
 
+template <int bitdepth>
 void Identity8TransformLoopRow_NEON(TransformType tx_type,
                                     TransformSize tx_size,
                                     int adjusted_tx_height, void* src_buffer,
@@ -2543,7 +2620,8 @@ void Identity8TransformLoopRow_NEON(TransformType tx_type,
   const bool should_round = kShouldRound[tx_size];
   const uint8_t row_shift = kTransformRowShift[tx_size];
 
-  if (Identity8DcOnly(src, adjusted_tx_height, should_round, row_shift)) {
+  if (Identity8DcOnly<bitdepth>(src, adjusted_tx_height, should_round,
+                                row_shift)) {
     return;
   }
   if (should_round) {
@@ -2558,15 +2636,15 @@ void Identity8TransformLoopRow_NEON(TransformType tx_type,
     for (int i = 0; i < tx_height; ++i) {
       const int32x4_t v_src_lo = vld1q_s32(&src[i * 8]);
       const int32x4_t v_src_hi = vld1q_s32(&src[(i * 8) + 4]);
-      vst1q_s32(&src[i * 8], vmovl_s16(vqmovn_s32(v_src_lo)));
-      vst1q_s32(&src[(i * 8) + 4], vmovl_s16(vqmovn_s32(v_src_hi)));
+      vst1q_s32(&src[i * 8], ClampIntermediate<bitdepth>(v_src_lo));
+      vst1q_s32(&src[(i * 8) + 4], ClampIntermediate<bitdepth>(v_src_hi));
     }
     return;
   }
   if (tx_height == 32) {
     int i = adjusted_tx_height;
     do {
-      Identity8Row32_NEON(src, /*step=*/8);
+      Identity8Row32_NEON<bitdepth>(src, /*step=*/8);
       src += 32;
       i -= 4;
     } while (i != 0);
@@ -2576,12 +2654,13 @@ void Identity8TransformLoopRow_NEON(TransformType tx_type,
   assert(tx_size == kTransformSize8x4);
   int i = adjusted_tx_height;
   do {
-    Identity8Row4_NEON(src, /*step=*/8);
+    Identity8Row4_NEON<bitdepth>(src, /*step=*/8);
     src += 32;
     i -= 4;
   } while (i != 0);
 }
 
+template <int bitdepth>
 void Identity8TransformLoopColumn_NEON(TransformType tx_type,
                                        TransformSize tx_size,
                                        int adjusted_tx_height,
@@ -2595,10 +2674,11 @@ void Identity8TransformLoopColumn_NEON(TransformType tx_type,
     FlipColumns<8>(src, tx_width);
   }
   auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
-  IdentityColumnStoreToFrame<8>(frame, start_x, start_y, tx_width,
-                                adjusted_tx_height, src);
+  IdentityColumnStoreToFrame<bitdepth, 8>(frame, start_x, start_y, tx_width,
+                                          adjusted_tx_height, src);
 }
 
+template <int bitdepth>
 void Identity16TransformLoopRow_NEON(TransformType /*tx_type*/,
                                      TransformSize tx_size,
                                      int adjusted_tx_height, void* src_buffer,
@@ -2608,7 +2688,8 @@ void Identity16TransformLoopRow_NEON(TransformType /*tx_type*/,
   const bool should_round = kShouldRound[tx_size];
   const uint8_t row_shift = kTransformRowShift[tx_size];
 
-  if (Identity16DcOnly(src, adjusted_tx_height, should_round, row_shift)) {
+  if (Identity16DcOnly<bitdepth>(src, adjusted_tx_height, should_round,
+                                 row_shift)) {
     return;
   }
 
@@ -2617,12 +2698,13 @@ void Identity16TransformLoopRow_NEON(TransformType /*tx_type*/,
   }
   int i = adjusted_tx_height;
   do {
-    Identity16Row_NEON(src, /*step=*/16, row_shift);
+    Identity16Row_NEON<bitdepth>(src, /*step=*/16, row_shift);
     src += 64;
     i -= 4;
   } while (i != 0);
 }
 
+template <int bitdepth>
 void Identity16TransformLoopColumn_NEON(TransformType tx_type,
                                         TransformSize tx_size,
                                         int adjusted_tx_height,
@@ -2636,8 +2718,8 @@ void Identity16TransformLoopColumn_NEON(TransformType tx_type,
     FlipColumns<16>(src, tx_width);
   }
   auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
-  IdentityColumnStoreToFrame<16>(frame, start_x, start_y, tx_width,
-                                 adjusted_tx_height, src);
+  IdentityColumnStoreToFrame<bitdepth, 16>(frame, start_x, start_y, tx_width,
+                                           adjusted_tx_height, src);
 }
 
 void Identity32TransformLoopRow_NEON(TransformType /*tx_type*/,
@@ -2671,6 +2753,7 @@ void Identity32TransformLoopRow_NEON(TransformType /*tx_type*/,
   } while (i != 0);
 }
 
+template <int bitdepth>
 void Identity32TransformLoopColumn_NEON(TransformType /*tx_type*/,
                                         TransformSize tx_size,
                                         int adjusted_tx_height,
@@ -2681,8 +2764,8 @@ void Identity32TransformLoopColumn_NEON(TransformType /*tx_type*/,
   auto* src = static_cast<int32_t*>(src_buffer);
   const int tx_width = kTransformWidth[tx_size];
 
-  IdentityColumnStoreToFrame<32>(frame, start_x, start_y, tx_width,
-                                 adjusted_tx_height, src);
+  IdentityColumnStoreToFrame<bitdepth, 32>(frame, start_x, start_y, tx_width,
+                                           adjusted_tx_height, src);
 }
 
 void Wht4TransformLoopRow_NEON(TransformType tx_type, TransformSize tx_size,
@@ -2696,6 +2779,7 @@ void Wht4TransformLoopRow_NEON(TransformType tx_type, TransformSize tx_size,
   // Do both row and column transforms in the column-transform pass.
 }
 
+template <int bitdepth>
 void Wht4TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
                                   int adjusted_tx_height,
                                   void* LIBGAV1_RESTRICT src_buffer,
@@ -2711,7 +2795,7 @@ void Wht4TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
   auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
   uint16_t* dst = frame[start_y] + start_x;
   const int dst_stride = frame.columns();
-  Wht4_NEON(dst, dst_stride, src, adjusted_tx_height);
+  Wht4_NEON<bitdepth>(dst, dst_stride, src, adjusted_tx_height);
 }
 
 //------------------------------------------------------------------------------
@@ -2721,68 +2805,139 @@ void Init10bpp() {
   assert(dsp != nullptr);
   // Maximum transform size for Dct is 64.
   dsp->inverse_transforms[kTransform1dDct][kTransform1dSize4][kRow] =
-      Dct4TransformLoopRow_NEON;
+      Dct4TransformLoopRow_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize4][kColumn] =
+      Dct4TransformLoopColumn_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize8][kRow] =
+      Dct8TransformLoopRow_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize8][kColumn] =
+      Dct8TransformLoopColumn_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize16][kRow] =
+      Dct16TransformLoopRow_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize16][kColumn] =
+      Dct16TransformLoopColumn_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize32][kRow] =
+      Dct32TransformLoopRow_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize32][kColumn] =
+      Dct32TransformLoopColumn_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kRow] =
+      Dct64TransformLoopRow_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kColumn] =
+      Dct64TransformLoopColumn_NEON<kBitdepth10>;
+
+  // Maximum transform size for Adst is 16.
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize4][kRow] =
+      Adst4TransformLoopRow_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize4][kColumn] =
+      Adst4TransformLoopColumn_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize8][kRow] =
+      Adst8TransformLoopRow_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize8][kColumn] =
+      Adst8TransformLoopColumn_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize16][kRow] =
+      Adst16TransformLoopRow_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize16][kColumn] =
+      Adst16TransformLoopColumn_NEON<kBitdepth10>;
+
+  // Maximum transform size for Identity transform is 32.
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize4][kRow] =
+      Identity4TransformLoopRow_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize4][kColumn] =
+      Identity4TransformLoopColumn_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize8][kRow] =
+      Identity8TransformLoopRow_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize8][kColumn] =
+      Identity8TransformLoopColumn_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize16][kRow] =
+      Identity16TransformLoopRow_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize16][kColumn] =
+      Identity16TransformLoopColumn_NEON<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize32][kRow] =
+      Identity32TransformLoopRow_NEON;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize32][kColumn] =
+      Identity32TransformLoopColumn_NEON<kBitdepth10>;
+
+  // Maximum transform size for Wht is 4.
+  dsp->inverse_transforms[kTransform1dWht][kTransform1dSize4][kRow] =
+      Wht4TransformLoopRow_NEON;
+  dsp->inverse_transforms[kTransform1dWht][kTransform1dSize4][kColumn] =
+      Wht4TransformLoopColumn_NEON<kBitdepth10>;
+}
+
+#if LIBGAV1_MAX_BITDEPTH == 12
+void Init12bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth12);
+  assert(dsp != nullptr);
+  // Maximum transform size for Dct is 64.
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize4][kRow] =
+      Dct4TransformLoopRow_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dDct][kTransform1dSize4][kColumn] =
-      Dct4TransformLoopColumn_NEON;
+      Dct4TransformLoopColumn_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dDct][kTransform1dSize8][kRow] =
-      Dct8TransformLoopRow_NEON;
+      Dct8TransformLoopRow_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dDct][kTransform1dSize8][kColumn] =
-      Dct8TransformLoopColumn_NEON;
+      Dct8TransformLoopColumn_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dDct][kTransform1dSize16][kRow] =
-      Dct16TransformLoopRow_NEON;
+      Dct16TransformLoopRow_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dDct][kTransform1dSize16][kColumn] =
-      Dct16TransformLoopColumn_NEON;
+      Dct16TransformLoopColumn_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dDct][kTransform1dSize32][kRow] =
-      Dct32TransformLoopRow_NEON;
+      Dct32TransformLoopRow_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dDct][kTransform1dSize32][kColumn] =
-      Dct32TransformLoopColumn_NEON;
+      Dct32TransformLoopColumn_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kRow] =
-      Dct64TransformLoopRow_NEON;
+      Dct64TransformLoopRow_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kColumn] =
-      Dct64TransformLoopColumn_NEON;
+      Dct64TransformLoopColumn_NEON<kBitdepth12>;
 
   // Maximum transform size for Adst is 16.
   dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize4][kRow] =
-      Adst4TransformLoopRow_NEON;
+      Adst4TransformLoopRow_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize4][kColumn] =
-      Adst4TransformLoopColumn_NEON;
+      Adst4TransformLoopColumn_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize8][kRow] =
-      Adst8TransformLoopRow_NEON;
+      Adst8TransformLoopRow_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize8][kColumn] =
-      Adst8TransformLoopColumn_NEON;
+      Adst8TransformLoopColumn_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize16][kRow] =
-      Adst16TransformLoopRow_NEON;
+      Adst16TransformLoopRow_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize16][kColumn] =
-      Adst16TransformLoopColumn_NEON;
+      Adst16TransformLoopColumn_NEON<kBitdepth12>;
 
   // Maximum transform size for Identity transform is 32.
   dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize4][kRow] =
-      Identity4TransformLoopRow_NEON;
+      Identity4TransformLoopRow_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize4][kColumn] =
-      Identity4TransformLoopColumn_NEON;
+      Identity4TransformLoopColumn_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize8][kRow] =
-      Identity8TransformLoopRow_NEON;
+      Identity8TransformLoopRow_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize8][kColumn] =
-      Identity8TransformLoopColumn_NEON;
+      Identity8TransformLoopColumn_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize16][kRow] =
-      Identity16TransformLoopRow_NEON;
+      Identity16TransformLoopRow_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize16][kColumn] =
-      Identity16TransformLoopColumn_NEON;
+      Identity16TransformLoopColumn_NEON<kBitdepth12>;
   dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize32][kRow] =
       Identity32TransformLoopRow_NEON;
   dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize32][kColumn] =
-      Identity32TransformLoopColumn_NEON;
+      Identity32TransformLoopColumn_NEON<kBitdepth12>;
 
   // Maximum transform size for Wht is 4.
   dsp->inverse_transforms[kTransform1dWht][kTransform1dSize4][kRow] =
       Wht4TransformLoopRow_NEON;
   dsp->inverse_transforms[kTransform1dWht][kTransform1dSize4][kColumn] =
-      Wht4TransformLoopColumn_NEON;
+      Wht4TransformLoopColumn_NEON<kBitdepth12>;
 }
+#endif  // LIBGAV1_MAX_BITDEPTH == 12
 
 }  // namespace
 
-void InverseTransformInit10bpp_NEON() { Init10bpp(); }
+void InverseTransformInit10bpp_NEON() {
+  Init10bpp();
+#if LIBGAV1_MAX_BITDEPTH == 12
+  Init12bpp();
+#endif
+}
 
 }  // namespace dsp
 }  // namespace libgav1
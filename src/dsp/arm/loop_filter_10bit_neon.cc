@@ -109,15 +109,17 @@ inline void Filter4Masks(const uint16x8_t p0q0, const uint16x8_t p1q1,
 
 // abs(p1 - p0) <= flat_thresh && abs(q1 - q0) <= flat_thresh &&
 //   abs(p2 - p0) <= flat_thresh && abs(q2 - q0) <= flat_thresh
-// |flat_thresh| == 4 for 10 bit decode.
+// |flat_thresh| == 4 for 10 bit decode and 16 for 12 bit decode.
+template <int bitdepth>
 inline uint16x4_t IsFlat3(const uint16x8_t abd_p0p1_q0q1,
                           const uint16x8_t abd_p0p2_q0q2) {
-  constexpr int flat_thresh = 1 << 2;
+  constexpr int flat_thresh = 1 << (bitdepth - 8);
   const uint16x8_t a = vmaxq_u16(abd_p0p1_q0q1, abd_p0p2_q0q2);
   const uint16x8_t b = vcleq_u16(a, vdupq_n_u16(flat_thresh));
   return vand_u16(vget_low_u16(b), vget_high_u16(b));
 }
 
+template <int bitdepth>
 inline void Filter6Masks(const uint16x8_t p2q2, const uint16x8_t p1q1,
                          const uint16x8_t p0q0, const uint16_t hev_thresh,
                          const uint16x4_t outer_mask,
@@ -127,7 +129,7 @@ inline void Filter6Masks(const uint16x8_t p2q2, const uint16x8_t p1q1,
                          uint16x4_t* const hev_mask) {
   const uint16x8_t abd_p0p1_q0q1 = vabdq_u16(p0q0, p1q1);
   *hev_mask = Hev(abd_p0p1_q0q1, hev_thresh);
-  *is_flat3_mask = IsFlat3(abd_p0p1_q0q1, vabdq_u16(p0q0, p2q2));
+  *is_flat3_mask = IsFlat3<bitdepth>(abd_p0p1_q0q1, vabdq_u16(p0q0, p2q2));
   *needs_filter6_mask = NeedsFilter6(abd_p0p1_q0q1, vabdq_u16(p1q1, p2q2),
                                      inner_thresh, outer_mask);
 }
@@ -136,17 +138,19 @@ inline void Filter6Masks(const uint16x8_t p2q2, const uint16x8_t p1q1,
 // abs(p[N] - p0) <= flat_thresh && abs(q[N] - q0) <= flat_thresh &&
 //   abs(p[N+1] - p0) <= flat_thresh && abs(q[N+1] - q0) <= flat_thresh &&
 //   abs(p[N+2] - p0) <= flat_thresh && abs(q[N+1] - q0) <= flat_thresh
-// |flat_thresh| == 4 for 10 bit decode.
+// |flat_thresh| == 4 for 10 bit decode and 16 for 12 bit decode.
+template <int bitdepth>
 inline uint16x4_t IsFlat4(const uint16x8_t abd_pnp0_qnq0,
                           const uint16x8_t abd_pn1p0_qn1q0,
                           const uint16x8_t abd_pn2p0_qn2q0) {
-  constexpr int flat_thresh = 1 << 2;
+  constexpr int flat_thresh = 1 << (bitdepth - 8);
   const uint16x8_t a = vmaxq_u16(abd_pnp0_qnq0, abd_pn1p0_qn1q0);
   const uint16x8_t b = vmaxq_u16(a, abd_pn2p0_qn2q0);
   const uint16x8_t c = vcleq_u16(b, vdupq_n_u16(flat_thresh));
   return vand_u16(vget_low_u16(c), vget_high_u16(c));
 }
 
+template <int bitdepth>
 inline void Filter8Masks(const uint16x8_t p3q3, const uint16x8_t p2q2,
                          const uint16x8_t p1q1, const uint16x8_t p0q0,
                          const uint16_t hev_thresh, const uint16x4_t outer_mask,
@@ -157,7 +161,8 @@ inline void Filter8Masks(const uint16x8_t p3q3, const uint16x8_t p2q2,
   const uint16x8_t abd_p0p1_q0q1 = vabdq_u16(p0q0, p1q1);
   *hev_mask = Hev(abd_p0p1_q0q1, hev_thresh);
   const uint16x4_t is_flat4 =
-      IsFlat4(abd_p0p1_q0q1, vabdq_u16(p0q0, p2q2), vabdq_u16(p0q0, p3q3));
+      IsFlat4<bitdepth>(abd_p0p1_q0q1, vabdq_u16(p0q0, p2q2),
+                        vabdq_u16(p0q0, p3q3));
   *needs_filter8_mask =
       NeedsFilter8(abd_p0p1_q0q1, vabdq_u16(p1q1, p2q2), vabdq_u16(p2q2, p3q3),
                    inner_thresh, outer_mask);
@@ -173,6 +178,7 @@ inline void Filter8Masks(const uint16x8_t p3q3, const uint16x8_t p2q2,
 // FilterN functions.
 
 // Calculate Filter4() or Filter2() based on |hev_mask|.
+template <int bitdepth>
 inline void Filter4(const uint16x8_t p0q0, const uint16x8_t p0q1,
                     const uint16x8_t p1q1, const uint16x4_t hev_mask,
                     uint16x8_t* const p1q1_result,
@@ -184,8 +190,8 @@ inline void Filter4(const uint16x8_t p0q0, const uint16x8_t p0q1,
   const int16x4_t q0mp0_3 = vmul_n_s16(vget_low_s16(q0mp0_p1mq1), 3);
 
   // If this is for Filter2() then include |p1mq1|. Otherwise zero it.
-  const int16x4_t min_signed_pixel = vdup_n_s16(-(1 << (9 /*bitdepth-1*/)));
-  const int16x4_t max_signed_pixel = vdup_n_s16((1 << (9 /*bitdepth-1*/)) - 1);
+  const int16x4_t min_signed_pixel = vdup_n_s16(-(1 << (bitdepth - 1)));
+  const int16x4_t max_signed_pixel = vdup_n_s16((1 << (bitdepth - 1)) - 1);
   const int16x4_t p1mq1 = vget_high_s16(q0mp0_p1mq1);
   const int16x4_t p1mq1_saturated =
       Clip3S16(p1mq1, min_signed_pixel, max_signed_pixel);
@@ -216,10 +222,11 @@ inline void Filter4(const uint16x8_t p0q0, const uint16x8_t p0q1,
   // Need to shift the second term or we end up with a2_ma2.
   const int16x8_t a2_ma1 = vcombine_s16(a2, vneg_s16(a1));
   const int16x8_t p0q0_a = vaddq_s16(vreinterpretq_s16_u16(p0q0), a2_ma1);
-  *p1q1_result = ConvertToUnsignedPixelU16(p1q1_a3, kBitdepth10);
-  *p0q0_result = ConvertToUnsignedPixelU16(p0q0_a, kBitdepth10);
+  *p1q1_result = ConvertToUnsignedPixelU16(p1q1_a3, bitdepth);
+  *p0q0_result = ConvertToUnsignedPixelU16(p0q0_a, bitdepth);
 }
 
+template <int bitdepth>
 void Horizontal4_NEON(void* const dest, const ptrdiff_t stride,
                       int outer_thresh, int inner_thresh, int hev_thresh) {
   auto* const dst = static_cast<uint8_t*>(dest);
@@ -232,9 +239,9 @@ void Horizontal4_NEON(void* const dest, const ptrdiff_t stride,
                              vld1_u16(dst_q0), vld1_u16(dst_q1)};
 
   // Adjust thresholds to bitdepth.
-  outer_thresh <<= 2;
-  inner_thresh <<= 2;
-  hev_thresh <<= 2;
+  outer_thresh <<= bitdepth - 8;
+  inner_thresh <<= bitdepth - 8;
+  hev_thresh <<= bitdepth - 8;
   const uint16x4_t outer_mask =
       OuterThreshold(src[0], src[1], src[2], src[3], outer_thresh);
   uint16x4_t hev_mask;
@@ -259,7 +266,7 @@ void Horizontal4_NEON(void* const dest, const ptrdiff_t stride,
   uint16x8_t f_p1q1;
   uint16x8_t f_p0q0;
   const uint16x8_t p0q1 = vcombine_u16(src[1], src[3]);
-  Filter4(p0q0, p0q1, p1q1, hev_mask, &f_p1q1, &f_p0q0);
+  Filter4<bitdepth>(p0q0, p0q1, p1q1, hev_mask, &f_p1q1, &f_p0q0);
 
   // Already integrated the Hev mask when calculating the filtered values.
   const uint16x8_t p0q0_output = vbslq_u16(needs_filter4_mask_8, f_p0q0, p0q0);
@@ -275,6 +282,7 @@ void Horizontal4_NEON(void* const dest, const ptrdiff_t stride,
   vst1_u16(dst_q1, vget_high_u16(p1q1_output));
 }
 
+template <int bitdepth>
 void Vertical4_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
                     int inner_thresh, int hev_thresh) {
   // Offset by 2 uint16_t values to load from first p1 position.
@@ -289,9 +297,9 @@ void Vertical4_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
   Transpose4x4(src);
 
   // Adjust thresholds to bitdepth.
-  outer_thresh <<= 2;
-  inner_thresh <<= 2;
-  hev_thresh <<= 2;
+  outer_thresh <<= bitdepth - 8;
+  inner_thresh <<= bitdepth - 8;
+  hev_thresh <<= bitdepth - 8;
   const uint16x4_t outer_mask =
       OuterThreshold(src[0], src[1], src[2], src[3], outer_thresh);
   uint16x4_t hev_mask;
@@ -316,7 +324,7 @@ void Vertical4_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
   uint16x8_t f_p1q1;
   uint16x8_t f_p0q0;
   const uint16x8_t p0q1 = vcombine_u16(src[1], src[3]);
-  Filter4(p0q0, p0q1, p1q1, hev_mask, &f_p1q1, &f_p0q0);
+  Filter4<bitdepth>(p0q0, p0q1, p1q1, hev_mask, &f_p1q1, &f_p0q0);
 
   // Already integrated the Hev mask when calculating the filtered values.
   const uint16x8_t p0q0_output = vbslq_u16(needs_filter4_mask_8, f_p0q0, p0q0);
@@ -386,6 +394,7 @@ inline void Filter6(const uint16x8_t p2q2, const uint16x8_t p1q1,
   *p0q0_output = vrshrq_n_u16(sum, 3);
 }
 
+template <int bitdepth>
 void Horizontal6_NEON(void* const dest, const ptrdiff_t stride,
                       int outer_thresh, int inner_thresh, int hev_thresh) {
   auto* const dst = static_cast<uint8_t*>(dest);
@@ -401,9 +410,9 @@ void Horizontal6_NEON(void* const dest, const ptrdiff_t stride,
                              vld1_u16(dst_q1), vld1_u16(dst_q2)};
 
   // Adjust thresholds to bitdepth.
-  outer_thresh <<= 2;
-  inner_thresh <<= 2;
-  hev_thresh <<= 2;
+  outer_thresh <<= bitdepth - 8;
+  inner_thresh <<= bitdepth - 8;
+  hev_thresh <<= bitdepth - 8;
   const uint16x4_t outer_mask =
       OuterThreshold(src[1], src[2], src[3], src[4], outer_thresh);
   uint16x4_t hev_mask;
@@ -412,8 +421,9 @@ void Horizontal6_NEON(void* const dest, const ptrdiff_t stride,
   const uint16x8_t p0q0 = vcombine_u16(src[2], src[3]);
   const uint16x8_t p1q1 = vcombine_u16(src[1], src[4]);
   const uint16x8_t p2q2 = vcombine_u16(src[0], src[5]);
-  Filter6Masks(p2q2, p1q1, p0q0, hev_thresh, outer_mask, inner_thresh,
-               &needs_filter_mask, &is_flat3_mask, &hev_mask);
+  Filter6Masks<bitdepth>(p2q2, p1q1, p0q0, hev_thresh, outer_mask,
+                         inner_thresh, &needs_filter_mask, &is_flat3_mask,
+                         &hev_mask);
 
 #if defined(__aarch64__)
   if (vaddv_u16(needs_filter_mask) == 0) {
@@ -432,7 +442,7 @@ void Horizontal6_NEON(void* const dest, const ptrdiff_t stride,
   uint16x8_t f4_p0q0;
   // ZIP1 p0q0, p1q1 may perform better here.
   const uint16x8_t p0q1 = vcombine_u16(src[2], src[4]);
-  Filter4(p0q0, p0q1, p1q1, hev_mask, &f4_p1q1, &f4_p0q0);
+  Filter4<bitdepth>(p0q0, p0q1, p1q1, hev_mask, &f4_p1q1, &f4_p0q0);
   f4_p1q1 = vbslq_u16(hev_mask_8, p1q1, f4_p1q1);
 
   uint16x8_t p0q0_output, p1q1_output;
@@ -460,6 +470,7 @@ void Horizontal6_NEON(void* const dest, const ptrdiff_t stride,
   vst1_u16(dst_q1, vget_high_u16(p1q1_output));
 }
 
+template <int bitdepth>
 void Vertical6_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
                     int inner_thresh, int hev_thresh) {
   // Left side of the filter window.
@@ -482,9 +493,9 @@ void Vertical6_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
   };
 
   // Adjust thresholds to bitdepth.
-  outer_thresh <<= 2;
-  inner_thresh <<= 2;
-  hev_thresh <<= 2;
+  outer_thresh <<= bitdepth - 8;
+  inner_thresh <<= bitdepth - 8;
+  hev_thresh <<= bitdepth - 8;
   const uint16x4_t outer_mask =
       OuterThreshold(src[1], src[2], src[3], src[4], outer_thresh);
   uint16x4_t hev_mask;
@@ -493,8 +504,9 @@ void Vertical6_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
   const uint16x8_t p0q0 = vcombine_u16(src[2], src[3]);
   const uint16x8_t p1q1 = vcombine_u16(src[1], src[4]);
   const uint16x8_t p2q2 = vcombine_u16(src[0], src[5]);
-  Filter6Masks(p2q2, p1q1, p0q0, hev_thresh, outer_mask, inner_thresh,
-               &needs_filter_mask, &is_flat3_mask, &hev_mask);
+  Filter6Masks<bitdepth>(p2q2, p1q1, p0q0, hev_thresh, outer_mask,
+                         inner_thresh, &needs_filter_mask, &is_flat3_mask,
+                         &hev_mask);
 
 #if defined(__aarch64__)
   if (vaddv_u16(needs_filter_mask) == 0) {
@@ -513,7 +525,7 @@ void Vertical6_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
   uint16x8_t f4_p0q0;
   // ZIP1 p0q0, p1q1 may perform better here.
   const uint16x8_t p0q1 = vcombine_u16(src[2], src[4]);
-  Filter4(p0q0, p0q1, p1q1, hev_mask, &f4_p1q1, &f4_p0q0);
+  Filter4<bitdepth>(p0q0, p0q1, p1q1, hev_mask, &f4_p1q1, &f4_p0q0);
   f4_p1q1 = vbslq_u16(hev_mask_8, p1q1, f4_p1q1);
 
   uint16x8_t p0q0_output, p1q1_output;
@@ -608,6 +620,7 @@ inline void Filter8(const uint16x8_t p3q3, const uint16x8_t p2q2,
   *p0q0_output = vrshrq_n_u16(sum, 3);
 }
 
+template <int bitdepth>
 void Horizontal8_NEON(void* const dest, const ptrdiff_t stride,
                       int outer_thresh, int inner_thresh, int hev_thresh) {
   auto* const dst = static_cast<uint8_t*>(dest);
@@ -625,9 +638,9 @@ void Horizontal8_NEON(void* const dest, const ptrdiff_t stride,
       vld1_u16(dst_q0), vld1_u16(dst_q1), vld1_u16(dst_q2), vld1_u16(dst_q3)};
 
   // Adjust thresholds to bitdepth.
-  outer_thresh <<= 2;
-  inner_thresh <<= 2;
-  hev_thresh <<= 2;
+  outer_thresh <<= bitdepth - 8;
+  inner_thresh <<= bitdepth - 8;
+  hev_thresh <<= bitdepth - 8;
   const uint16x4_t outer_mask =
       OuterThreshold(src[2], src[3], src[4], src[5], outer_thresh);
   uint16x4_t hev_mask;
@@ -637,8 +650,9 @@ void Horizontal8_NEON(void* const dest, const ptrdiff_t stride,
   const uint16x8_t p1q1 = vcombine_u16(src[2], src[5]);
   const uint16x8_t p2q2 = vcombine_u16(src[1], src[6]);
   const uint16x8_t p3q3 = vcombine_u16(src[0], src[7]);
-  Filter8Masks(p3q3, p2q2, p1q1, p0q0, hev_thresh, outer_mask, inner_thresh,
-               &needs_filter_mask, &is_flat4_mask, &hev_mask);
+  Filter8Masks<bitdepth>(p3q3, p2q2, p1q1, p0q0, hev_thresh, outer_mask,
+                         inner_thresh, &needs_filter_mask, &is_flat4_mask,
+                         &hev_mask);
 
 #if defined(__aarch64__)
   if (vaddv_u16(needs_filter_mask) == 0) {
@@ -656,7 +670,7 @@ void Horizontal8_NEON(void* const dest, const ptrdiff_t stride,
   uint16x8_t f4_p0q0;
   // ZIP1 p0q0, p1q1 may perform better here.
   const uint16x8_t p0q1 = vcombine_u16(src[3], src[5]);
-  Filter4(p0q0, p0q1, p1q1, hev_mask, &f4_p1q1, &f4_p0q0);
+  Filter4<bitdepth>(p0q0, p0q1, p1q1, hev_mask, &f4_p1q1, &f4_p0q0);
   f4_p1q1 = vbslq_u16(hev_mask_8, p1q1, f4_p1q1);
 
   uint16x8_t p0q0_output, p1q1_output, p2q2_output;
@@ -694,6 +708,7 @@ inline uint16x8_t ReverseLowHalf(const uint16x8_t a) {
   return vcombine_u16(vrev64_u16(vget_low_u16(a)), vget_high_u16(a));
 }
 
+template <int bitdepth>
 void Vertical8_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
                     int inner_thresh, int hev_thresh) {
   auto* const dst = static_cast<uint8_t*>(dest) - 4 * sizeof(uint16_t);
@@ -714,9 +729,9 @@ void Vertical8_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
   LoopFilterTranspose4x8(src);
 
   // Adjust thresholds to bitdepth.
-  outer_thresh <<= 2;
-  inner_thresh <<= 2;
-  hev_thresh <<= 2;
+  outer_thresh <<= bitdepth - 8;
+  inner_thresh <<= bitdepth - 8;
+  hev_thresh <<= bitdepth - 8;
   const uint16x4_t outer_mask = OuterThreshold(
       vget_low_u16(src[1]), vget_low_u16(src[0]), vget_high_u16(src[0]),
       vget_high_u16(src[1]), outer_thresh);
@@ -727,8 +742,9 @@ void Vertical8_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
   const uint16x8_t p1q1 = src[1];
   const uint16x8_t p2q2 = src[2];
   const uint16x8_t p3q3 = src[3];
-  Filter8Masks(p3q3, p2q2, p1q1, p0q0, hev_thresh, outer_mask, inner_thresh,
-               &needs_filter_mask, &is_flat4_mask, &hev_mask);
+  Filter8Masks<bitdepth>(p3q3, p2q2, p1q1, p0q0, hev_thresh, outer_mask,
+                         inner_thresh, &needs_filter_mask, &is_flat4_mask,
+                         &hev_mask);
 
 #if defined(__aarch64__)
   if (vaddv_u16(needs_filter_mask) == 0) {
@@ -745,7 +761,7 @@ void Vertical8_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
   uint16x8_t f4_p1q1;
   uint16x8_t f4_p0q0;
   const uint16x8_t p0q1 = vcombine_u16(vget_low_u16(p0q0), vget_high_u16(p1q1));
-  Filter4(p0q0, p0q1, p1q1, hev_mask, &f4_p1q1, &f4_p0q0);
+  Filter4<bitdepth>(p0q0, p0q1, p1q1, hev_mask, &f4_p1q1, &f4_p0q0);
   f4_p1q1 = vbslq_u16(hev_mask_8, p1q1, f4_p1q1);
 
   uint16x8_t p0q0_output, p1q1_output, p2q2_output;
@@ -874,6 +890,7 @@ inline void Filter14(const uint16x8_t p6q6, const uint16x8_t p5q5,
   *p0q0_output = vrshrq_n_u16(sum, 4);
 }
 
+template <int bitdepth>
 void Horizontal14_NEON(void* const dest, const ptrdiff_t stride,
                        int outer_thresh, int inner_thresh, int hev_thresh) {
   auto* const dst = static_cast<uint8_t*>(dest);
@@ -899,9 +916,9 @@ void Horizontal14_NEON(void* const dest, const ptrdiff_t stride,
       vld1_u16(dst_q5), vld1_u16(dst_q6)};
 
   // Adjust thresholds to bitdepth.
-  outer_thresh <<= 2;
-  inner_thresh <<= 2;
-  hev_thresh <<= 2;
+  outer_thresh <<= bitdepth - 8;
+  inner_thresh <<= bitdepth - 8;
+  hev_thresh <<= bitdepth - 8;
   const uint16x4_t outer_mask =
       OuterThreshold(src[5], src[6], src[7], src[8], outer_thresh);
   uint16x4_t hev_mask;
@@ -911,8 +928,9 @@ void Horizontal14_NEON(void* const dest, const ptrdiff_t stride,
   const uint16x8_t p1q1 = vcombine_u16(src[5], src[8]);
   const uint16x8_t p2q2 = vcombine_u16(src[4], src[9]);
   const uint16x8_t p3q3 = vcombine_u16(src[3], src[10]);
-  Filter8Masks(p3q3, p2q2, p1q1, p0q0, hev_thresh, outer_mask, inner_thresh,
-               &needs_filter_mask, &is_flat4_mask, &hev_mask);
+  Filter8Masks<bitdepth>(p3q3, p2q2, p1q1, p0q0, hev_thresh, outer_mask,
+                         inner_thresh, &needs_filter_mask, &is_flat4_mask,
+                         &hev_mask);
 
 #if defined(__aarch64__)
   if (vaddv_u16(needs_filter_mask) == 0) {
@@ -927,8 +945,9 @@ void Horizontal14_NEON(void* const dest, const ptrdiff_t stride,
   // As with the derivation of |is_flat4_mask|, the question of whether to use
   // Filter14 is only raised where |is_flat4_mask| is true.
   const uint16x4_t is_flat4_outer_mask = vand_u16(
-      is_flat4_mask, IsFlat4(vabdq_u16(p0q0, p4q4), vabdq_u16(p0q0, p5q5),
-                             vabdq_u16(p0q0, p6q6)));
+      is_flat4_mask,
+      IsFlat4<bitdepth>(vabdq_u16(p0q0, p4q4), vabdq_u16(p0q0, p5q5),
+                        vabdq_u16(p0q0, p6q6)));
   // Copy the masks to the high bits for packed comparisons later.
   const uint16x8_t hev_mask_8 = vcombine_u16(hev_mask, hev_mask);
   const uint16x8_t needs_filter_mask_8 =
@@ -938,7 +957,7 @@ void Horizontal14_NEON(void* const dest, const ptrdiff_t stride,
   uint16x8_t f4_p0q0;
   // ZIP1 p0q0, p1q1 may perform better here.
   const uint16x8_t p0q1 = vcombine_u16(src[6], src[8]);
-  Filter4(p0q0, p0q1, p1q1, hev_mask, &f4_p1q1, &f4_p0q0);
+  Filter4<bitdepth>(p0q0, p0q1, p1q1, hev_mask, &f4_p1q1, &f4_p0q0);
   f4_p1q1 = vbslq_u16(hev_mask_8, p1q1, f4_p1q1);
 
   uint16x8_t p0q0_output, p1q1_output, p2q2_output, p3q3_output, p4q4_output,
@@ -1032,6 +1051,7 @@ inline uint16x8x2_t PermuteACDB64(const uint16x8_t ab, const uint16x8_t cd) {
   return acdb;
 }
 
+template <int bitdepth>
 void Vertical14_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
                      int inner_thresh, int hev_thresh) {
   auto* const dst = static_cast<uint8_t*>(dest) - 8 * sizeof(uint16_t);
@@ -1055,9 +1075,9 @@ void Vertical14_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
   Transpose4x8(src_q);
 
   // Adjust thresholds to bitdepth.
-  outer_thresh <<= 2;
-  inner_thresh <<= 2;
-  hev_thresh <<= 2;
+  outer_thresh <<= bitdepth - 8;
+  inner_thresh <<= bitdepth - 8;
+  hev_thresh <<= bitdepth - 8;
   const uint16x4_t outer_mask = OuterThreshold(
       vget_high_u16(src_p[2]), vget_high_u16(src_p[3]), vget_low_u16(src_q[0]),
       vget_low_u16(src_q[1]), outer_thresh);
@@ -1068,8 +1088,9 @@ void Vertical14_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
   uint16x4_t hev_mask;
   uint16x4_t needs_filter_mask;
   uint16x4_t is_flat4_mask;
-  Filter8Masks(p3q3, p2q2, p1q1, p0q0, hev_thresh, outer_mask, inner_thresh,
-               &needs_filter_mask, &is_flat4_mask, &hev_mask);
+  Filter8Masks<bitdepth>(p3q3, p2q2, p1q1, p0q0, hev_thresh, outer_mask,
+                         inner_thresh, &needs_filter_mask, &is_flat4_mask,
+                         &hev_mask);
 
 #if defined(__aarch64__)
   if (vaddv_u16(needs_filter_mask) == 0) {
@@ -1089,8 +1110,9 @@ void Vertical14_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
   // As with the derivation of |is_flat4_mask|, the question of whether to use
   // Filter14 is only raised where |is_flat4_mask| is true.
   const uint16x4_t is_flat4_outer_mask = vand_u16(
-      is_flat4_mask, IsFlat4(vabdq_u16(p0q0, p4q4), vabdq_u16(p0q0, p5q5),
-                             vabdq_u16(p0q0, p6q6)));
+      is_flat4_mask,
+      IsFlat4<bitdepth>(vabdq_u16(p0q0, p4q4), vabdq_u16(p0q0, p5q5),
+                        vabdq_u16(p0q0, p6q6)));
   // Copy the masks to the high bits for packed comparisons later.
   const uint16x8_t hev_mask_8 = vcombine_u16(hev_mask, hev_mask);
   const uint16x8_t needs_filter_mask_8 =
@@ -1099,7 +1121,7 @@ void Vertical14_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
   uint16x8_t f4_p1q1;
   uint16x8_t f4_p0q0;
   const uint16x8_t p0q1 = vcombine_u16(vget_low_u16(p0q0), vget_high_u16(p1q1));
-  Filter4(p0q0, p0q1, p1q1, hev_mask, &f4_p1q1, &f4_p0q0);
+  Filter4<bitdepth>(p0q0, p0q1, p1q1, hev_mask, &f4_p1q1, &f4_p0q0);
   f4_p1q1 = vbslq_u16(hev_mask_8, p1q1, f4_p1q1);
 
   uint16x8_t p0q0_output, p1q1_output, p2q2_output, p3q3_output, p4q4_output,
@@ -1182,24 +1204,57 @@ void Vertical14_NEON(void* const dest, const ptrdiff_t stride, int outer_thresh,
   vst1q_u16(dst_3 + 8, output_q[3]);
 }
 
-}  // namespace
-
-void LoopFilterInit10bpp_NEON() {
+void Init10bpp() {
   Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
   assert(dsp != nullptr);
   dsp->loop_filters[kLoopFilterSize4][kLoopFilterTypeHorizontal] =
-      Horizontal4_NEON;
-  dsp->loop_filters[kLoopFilterSize4][kLoopFilterTypeVertical] = Vertical4_NEON;
+      Horizontal4_NEON<kBitdepth10>;
+  dsp->loop_filters[kLoopFilterSize4][kLoopFilterTypeVertical] =
+      Vertical4_NEON<kBitdepth10>;
+  dsp->loop_filters[kLoopFilterSize6][kLoopFilterTypeHorizontal] =
+      Horizontal6_NEON<kBitdepth10>;
+  dsp->loop_filters[kLoopFilterSize6][kLoopFilterTypeVertical] =
+      Vertical6_NEON<kBitdepth10>;
+  dsp->loop_filters[kLoopFilterSize8][kLoopFilterTypeHorizontal] =
+      Horizontal8_NEON<kBitdepth10>;
+  dsp->loop_filters[kLoopFilterSize8][kLoopFilterTypeVertical] =
+      Vertical8_NEON<kBitdepth10>;
+  dsp->loop_filters[kLoopFilterSize14][kLoopFilterTypeHorizontal] =
+      Horizontal14_NEON<kBitdepth10>;
+  dsp->loop_filters[kLoopFilterSize14][kLoopFilterTypeVertical] =
+      Vertical14_NEON<kBitdepth10>;
+}
+
+#if LIBGAV1_MAX_BITDEPTH == 12
+void Init12bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth12);
+  assert(dsp != nullptr);
+  dsp->loop_filters[kLoopFilterSize4][kLoopFilterTypeHorizontal] =
+      Horizontal4_NEON<kBitdepth12>;
+  dsp->loop_filters[kLoopFilterSize4][kLoopFilterTypeVertical] =
+      Vertical4_NEON<kBitdepth12>;
   dsp->loop_filters[kLoopFilterSize6][kLoopFilterTypeHorizontal] =
-      Horizontal6_NEON;
-  dsp->loop_filters[kLoopFilterSize6][kLoopFilterTypeVertical] = Vertical6_NEON;
+      Horizontal6_NEON<kBitdepth12>;
+  dsp->loop_filters[kLoopFilterSize6][kLoopFilterTypeVertical] =
+      Vertical6_NEON<kBitdepth12>;
   dsp->loop_filters[kLoopFilterSize8][kLoopFilterTypeHorizontal] =
-      Horizontal8_NEON;
-  dsp->loop_filters[kLoopFilterSize8][kLoopFilterTypeVertical] = Vertical8_NEON;
+      Horizontal8_NEON<kBitdepth12>;
+  dsp->loop_filters[kLoopFilterSize8][kLoopFilterTypeVertical] =
+      Vertical8_NEON<kBitdepth12>;
   dsp->loop_filters[kLoopFilterSize14][kLoopFilterTypeHorizontal] =
-      Horizontal14_NEON;
+      Horizontal14_NEON<kBitdepth12>;
   dsp->loop_filters[kLoopFilterSize14][kLoopFilterTypeVertical] =
-      Vertical14_NEON;
+      Vertical14_NEON<kBitdepth12>;
+}
+#endif  // LIBGAV1_MAX_BITDEPTH == 12
+
+}  // namespace
+
+void LoopFilterInit10bpp_NEON() {
+  Init10bpp();
+#if LIBGAV1_MAX_BITDEPTH == 12
+  Init12bpp();
+#endif
 }
 
 }  // namespace dsp
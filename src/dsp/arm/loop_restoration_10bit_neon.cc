@@ -57,34 +57,42 @@ inline int32x4x2_t WienerHorizontal2(const uint16x8_t s0, const uint16x8_t s1,
   return res;
 }
 
+template <int bitdepth>
 inline void WienerHorizontalSum(const uint16x8_t s[3], const int16_t filter[4],
                                 int32x4x2_t sum, int16_t* const wiener_buffer) {
+  constexpr int kRoundBitsHorizontal = (bitdepth == 12)
+                                           ? kInterRoundBitsHorizontal12bpp
+                                           : kInterRoundBitsHorizontal;
   constexpr int offset =
-      1 << (kBitdepth10 + kWienerFilterBits - kInterRoundBitsHorizontal - 1);
+      1 << (bitdepth + kWienerFilterBits - kRoundBitsHorizontal - 1);
   constexpr int limit = (offset << 2) - 1;
   const int16x8_t s_0_2 = vreinterpretq_s16_u16(vaddq_u16(s[0], s[2]));
   const int16x8_t s_1 = vreinterpretq_s16_u16(s[1]);
   int16x4x2_t sum16;
   sum.val[0] = vmlal_n_s16(sum.val[0], vget_low_s16(s_0_2), filter[2]);
   sum.val[0] = vmlal_n_s16(sum.val[0], vget_low_s16(s_1), filter[3]);
-  sum16.val[0] = vqshrn_n_s32(sum.val[0], kInterRoundBitsHorizontal);
+  sum16.val[0] = vqshrn_n_s32(sum.val[0], kRoundBitsHorizontal);
   sum16.val[0] = vmax_s16(sum16.val[0], vdup_n_s16(-offset));
   sum16.val[0] = vmin_s16(sum16.val[0], vdup_n_s16(limit - offset));
   vst1_s16(wiener_buffer, sum16.val[0]);
   sum.val[1] = vmlal_n_s16(sum.val[1], vget_high_s16(s_0_2), filter[2]);
   sum.val[1] = vmlal_n_s16(sum.val[1], vget_high_s16(s_1), filter[3]);
-  sum16.val[1] = vqshrn_n_s32(sum.val[1], kInterRoundBitsHorizontal);
+  sum16.val[1] = vqshrn_n_s32(sum.val[1], kRoundBitsHorizontal);
   sum16.val[1] = vmax_s16(sum16.val[1], vdup_n_s16(-offset));
   sum16.val[1] = vmin_s16(sum16.val[1], vdup_n_s16(limit - offset));
   vst1_s16(wiener_buffer + 4, sum16.val[1]);
 }
 
+template <int bitdepth>
 inline void WienerHorizontalTap7(const uint16_t* src,
                                  const ptrdiff_t src_stride,
                                  const ptrdiff_t wiener_stride,
                                  const ptrdiff_t width, const int height,
                                  const int16_t filter[4],
                                  int16_t** const wiener_buffer) {
+  constexpr int kRoundBitsHorizontal = (bitdepth == 12)
+                                           ? kInterRoundBitsHorizontal12bpp
+                                           : kInterRoundBitsHorizontal;
   const ptrdiff_t src_width =
       width + ((kRestorationHorizontalBorder - 1) * sizeof(*src));
   for (int y = height; y != 0; --y) {
@@ -104,11 +112,10 @@ inline void WienerHorizontalTap7(const uint16_t* src,
       s[5] = vextq_u16(s[0], s[7], 5);
       s[6] = vextq_u16(s[0], s[7], 6);
       int32x4x2_t sum;
-      sum.val[0] = sum.val[1] =
-          vdupq_n_s32(1 << (kInterRoundBitsHorizontal - 1));
+      sum.val[0] = sum.val[1] = vdupq_n_s32(1 << (kRoundBitsHorizontal - 1));
       sum = WienerHorizontal2(s[0], s[6], filter[0], sum);
       sum = WienerHorizontal2(s[1], s[5], filter[1], sum);
-      WienerHorizontalSum(s + 2, filter, sum, *wiener_buffer);
+      WienerHorizontalSum<bitdepth>(s + 2, filter, sum, *wiener_buffer);
       s[0] = s[7];
       *wiener_buffer += 8;
       x -= 8;
@@ -117,12 +124,16 @@ inline void WienerHorizontalTap7(const uint16_t* src,
   }
 }
 
+template <int bitdepth>
 inline void WienerHorizontalTap5(const uint16_t* src,
                                  const ptrdiff_t src_stride,
                                  const ptrdiff_t wiener_stride,
                                  const ptrdiff_t width, const int height,
                                  const int16_t filter[4],
                                  int16_t** const wiener_buffer) {
+  constexpr int kRoundBitsHorizontal = (bitdepth == 12)
+                                           ? kInterRoundBitsHorizontal12bpp
+                                           : kInterRoundBitsHorizontal;
   const ptrdiff_t src_width =
       width + ((kRestorationHorizontalBorder - 1) * sizeof(*src));
   for (int y = height; y != 0; --y) {
@@ -141,10 +152,9 @@ inline void WienerHorizontalTap5(const uint16_t* src,
       s[4] = vextq_u16(s[0], s[5], 4);
 
       int32x4x2_t sum;
-      sum.val[0] = sum.val[1] =
-          vdupq_n_s32(1 << (kInterRoundBitsHorizontal - 1));
+      sum.val[0] = sum.val[1] = vdupq_n_s32(1 << (kRoundBitsHorizontal - 1));
       sum = WienerHorizontal2(s[0], s[4], filter[1], sum);
-      WienerHorizontalSum(s + 1, filter, sum, *wiener_buffer);
+      WienerHorizontalSum<bitdepth>(s + 1, filter, sum, *wiener_buffer);
       s[0] = s[5];
       *wiener_buffer += 8;
       x -= 8;
@@ -153,11 +163,15 @@ inline void WienerHorizontalTap5(const uint16_t* src,
   }
 }
 
+template <int bitdepth>
 inline void WienerHorizontalTap3(const uint16_t* src,
                                  const ptrdiff_t src_stride,
                                  const ptrdiff_t width, const int height,
                                  const int16_t filter[4],
                                  int16_t** const wiener_buffer) {
+  constexpr int kRoundBitsHorizontal = (bitdepth == 12)
+                                           ? kInterRoundBitsHorizontal12bpp
+                                           : kInterRoundBitsHorizontal;
   for (int y = height; y != 0; --y) {
     const uint16_t* src_ptr = src;
     uint16x8_t s[3];
@@ -168,9 +182,8 @@ inline void WienerHorizontalTap3(const uint16_t* src,
       s[2] = vld1q_u16(src_ptr + 2);
 
       int32x4x2_t sum;
-      sum.val[0] = sum.val[1] =
-          vdupq_n_s32(1 << (kInterRoundBitsHorizontal - 1));
-      WienerHorizontalSum(s, filter, sum, *wiener_buffer);
+      sum.val[0] = sum.val[1] = vdupq_n_s32(1 << (kRoundBitsHorizontal - 1));
+      WienerHorizontalSum<bitdepth>(s, filter, sum, *wiener_buffer);
       src_ptr += 8;
       *wiener_buffer += 8;
       x -= 8;
@@ -179,15 +192,20 @@ inline void WienerHorizontalTap3(const uint16_t* src,
   }
 }
 
+template <int bitdepth>
 inline void WienerHorizontalTap1(const uint16_t* src,
                                  const ptrdiff_t src_stride,
                                  const ptrdiff_t width, const int height,
                                  int16_t** const wiener_buffer) {
+  constexpr int kRoundBitsHorizontal = (bitdepth == 12)
+                                           ? kInterRoundBitsHorizontal12bpp
+                                           : kInterRoundBitsHorizontal;
+  constexpr int kShift = kWienerFilterBits - kRoundBitsHorizontal;
   for (int y = height; y != 0; --y) {
     ptrdiff_t x = 0;
     do {
       const uint16x8_t s = vld1q_u16(src + x);
-      const int16x8_t d = vreinterpretq_s16_u16(vshlq_n_u16(s, 4));
+      const int16x8_t d = vreinterpretq_s16_u16(vshlq_n_u16(s, kShift));
       vst1q_s16(*wiener_buffer + x, d);
       x += 8;
     } while (x < width);
@@ -207,16 +225,20 @@ inline int32x4x2_t WienerVertical2(const int16x8_t a0, const int16x8_t a1,
   return d;
 }
 
+template <int bitdepth>
 inline uint16x8_t WienerVertical(const int16x8_t a[3], const int16_t filter[4],
                                  const int32x4x2_t sum) {
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
   int32x4x2_t d = WienerVertical2(a[0], a[2], filter[2], sum);
   d.val[0] = vmlal_n_s16(d.val[0], vget_low_s16(a[1]), filter[3]);
   d.val[1] = vmlal_n_s16(d.val[1], vget_high_s16(a[1]), filter[3]);
-  const uint16x4_t sum_lo_16 = vqrshrun_n_s32(d.val[0], 11);
-  const uint16x4_t sum_hi_16 = vqrshrun_n_s32(d.val[1], 11);
+  const uint16x4_t sum_lo_16 = vqrshrun_n_s32(d.val[0], kRoundBitsVertical);
+  const uint16x4_t sum_hi_16 = vqrshrun_n_s32(d.val[1], kRoundBitsVertical);
   return vcombine_u16(sum_lo_16, sum_hi_16);
 }
 
+template <int bitdepth>
 inline uint16x8_t WienerVerticalTap7Kernel(const int16_t* const wiener_buffer,
                                            const ptrdiff_t wiener_stride,
                                            const int16_t filter[4],
@@ -232,36 +254,41 @@ inline uint16x8_t WienerVerticalTap7Kernel(const int16_t* const wiener_buffer,
   a[2] = vld1q_s16(wiener_buffer + 2 * wiener_stride);
   a[3] = vld1q_s16(wiener_buffer + 3 * wiener_stride);
   a[4] = vld1q_s16(wiener_buffer + 4 * wiener_stride);
-  return WienerVertical(a + 2, filter, sum);
+  return WienerVertical<bitdepth>(a + 2, filter, sum);
 }
 
+template <int bitdepth>
 inline uint16x8x2_t WienerVerticalTap7Kernel2(
     const int16_t* const wiener_buffer, const ptrdiff_t wiener_stride,
     const int16_t filter[4]) {
   int16x8_t a[8];
   int32x4x2_t sum;
   uint16x8x2_t d;
-  d.val[0] = WienerVerticalTap7Kernel(wiener_buffer, wiener_stride, filter, a);
+  d.val[0] = WienerVerticalTap7Kernel<bitdepth>(wiener_buffer, wiener_stride,
+                                                filter, a);
   a[7] = vld1q_s16(wiener_buffer + 7 * wiener_stride);
   sum.val[0] = sum.val[1] = vdupq_n_s32(0);
   sum = WienerVertical2(a[1], a[7], filter[0], sum);
   sum = WienerVertical2(a[2], a[6], filter[1], sum);
-  d.val[1] = WienerVertical(a + 3, filter, sum);
+  d.val[1] = WienerVertical<bitdepth>(a + 3, filter, sum);
   return d;
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap7(const int16_t* wiener_buffer,
                                const ptrdiff_t width, const int height,
                                const int16_t filter[4], uint16_t* dst,
                                const ptrdiff_t dst_stride) {
-  const uint16x8_t v_max_bitdepth = vdupq_n_u16((1 << kBitdepth10) - 1);
+  const uint16x8_t v_max_bitdepth = vdupq_n_u16((1 << bitdepth) - 1);
   for (int y = height >> 1; y != 0; --y) {
     uint16_t* dst_ptr = dst;
     ptrdiff_t x = width;
     do {
       uint16x8x2_t d[2];
-      d[0] = WienerVerticalTap7Kernel2(wiener_buffer + 0, width, filter);
-      d[1] = WienerVerticalTap7Kernel2(wiener_buffer + 8, width, filter);
+      d[0] = WienerVerticalTap7Kernel2<bitdepth>(wiener_buffer + 0, width,
+                                                 filter);
+      d[1] = WienerVerticalTap7Kernel2<bitdepth>(wiener_buffer + 8, width,
+                                                 filter);
       vst1q_u16(dst_ptr, vminq_u16(d[0].val[0], v_max_bitdepth));
       vst1q_u16(dst_ptr + 8, vminq_u16(d[1].val[0], v_max_bitdepth));
       vst1q_u16(dst_ptr + dst_stride, vminq_u16(d[0].val[1], v_max_bitdepth));
@@ -280,9 +307,11 @@ inline void WienerVerticalTap7(const int16_t* wiener_buffer,
     do {
       int16x8_t a[7];
       const uint16x8_t d0 =
-          WienerVerticalTap7Kernel(wiener_buffer + 0, width, filter, a);
+          WienerVerticalTap7Kernel<bitdepth>(wiener_buffer + 0, width, filter,
+                                             a);
       const uint16x8_t d1 =
-          WienerVerticalTap7Kernel(wiener_buffer + 8, width, filter, a);
+          WienerVerticalTap7Kernel<bitdepth>(wiener_buffer + 8, width, filter,
+                                             a);
       vst1q_u16(dst, vminq_u16(d0, v_max_bitdepth));
       vst1q_u16(dst + 8, vminq_u16(d1, v_max_bitdepth));
       wiener_buffer += 16;
@@ -292,6 +321,7 @@ inline void WienerVerticalTap7(const int16_t* wiener_buffer,
   }
 }
 
+template <int bitdepth>
 inline uint16x8_t WienerVerticalTap5Kernel(const int16_t* const wiener_buffer,
                                            const ptrdiff_t wiener_stride,
                                            const int16_t filter[4],
@@ -304,35 +334,40 @@ inline uint16x8_t WienerVerticalTap5Kernel(const int16_t* const wiener_buffer,
   int32x4x2_t sum;
   sum.val[0] = sum.val[1] = vdupq_n_s32(0);
   sum = WienerVertical2(a[0], a[4], filter[1], sum);
-  return WienerVertical(a + 1, filter, sum);
+  return WienerVertical<bitdepth>(a + 1, filter, sum);
 }
 
+template <int bitdepth>
 inline uint16x8x2_t WienerVerticalTap5Kernel2(
     const int16_t* const wiener_buffer, const ptrdiff_t wiener_stride,
     const int16_t filter[4]) {
   int16x8_t a[6];
   int32x4x2_t sum;
   uint16x8x2_t d;
-  d.val[0] = WienerVerticalTap5Kernel(wiener_buffer, wiener_stride, filter, a);
+  d.val[0] = WienerVerticalTap5Kernel<bitdepth>(wiener_buffer, wiener_stride,
+                                                filter, a);
   a[5] = vld1q_s16(wiener_buffer + 5 * wiener_stride);
   sum.val[0] = sum.val[1] = vdupq_n_s32(0);
   sum = WienerVertical2(a[1], a[5], filter[1], sum);
-  d.val[1] = WienerVertical(a + 2, filter, sum);
+  d.val[1] = WienerVertical<bitdepth>(a + 2, filter, sum);
   return d;
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap5(const int16_t* wiener_buffer,
                                const ptrdiff_t width, const int height,
                                const int16_t filter[4], uint16_t* dst,
                                const ptrdiff_t dst_stride) {
-  const uint16x8_t v_max_bitdepth = vdupq_n_u16((1 << kBitdepth10) - 1);
+  const uint16x8_t v_max_bitdepth = vdupq_n_u16((1 << bitdepth) - 1);
   for (int y = height >> 1; y != 0; --y) {
     uint16_t* dst_ptr = dst;
     ptrdiff_t x = width;
     do {
       uint16x8x2_t d[2];
-      d[0] = WienerVerticalTap5Kernel2(wiener_buffer + 0, width, filter);
-      d[1] = WienerVerticalTap5Kernel2(wiener_buffer + 8, width, filter);
+      d[0] = WienerVerticalTap5Kernel2<bitdepth>(wiener_buffer + 0, width,
+                                                 filter);
+      d[1] = WienerVerticalTap5Kernel2<bitdepth>(wiener_buffer + 8, width,
+                                                 filter);
       vst1q_u16(dst_ptr, vminq_u16(d[0].val[0], v_max_bitdepth));
       vst1q_u16(dst_ptr + 8, vminq_u16(d[1].val[0], v_max_bitdepth));
       vst1q_u16(dst_ptr + dst_stride, vminq_u16(d[0].val[1], v_max_bitdepth));
@@ -351,9 +386,11 @@ inline void WienerVerticalTap5(const int16_t* wiener_buffer,
     do {
       int16x8_t a[5];
       const uint16x8_t d0 =
-          WienerVerticalTap5Kernel(wiener_buffer + 0, width, filter, a);
+          WienerVerticalTap5Kernel<bitdepth>(wiener_buffer + 0, width, filter,
+                                             a);
       const uint16x8_t d1 =
-          WienerVerticalTap5Kernel(wiener_buffer + 8, width, filter, a);
+          WienerVerticalTap5Kernel<bitdepth>(wiener_buffer + 8, width, filter,
+                                             a);
       vst1q_u16(dst, vminq_u16(d0, v_max_bitdepth));
       vst1q_u16(dst + 8, vminq_u16(d1, v_max_bitdepth));
       wiener_buffer += 16;
@@ -363,6 +400,7 @@ inline void WienerVerticalTap5(const int16_t* wiener_buffer,
   }
 }
 
+template <int bitdepth>
 inline uint16x8_t WienerVerticalTap3Kernel(const int16_t* const wiener_buffer,
                                            const ptrdiff_t wiener_stride,
                                            const int16_t filter[4],
@@ -372,35 +410,40 @@ inline uint16x8_t WienerVerticalTap3Kernel(const int16_t* const wiener_buffer,
   a[2] = vld1q_s16(wiener_buffer + 2 * wiener_stride);
   int32x4x2_t sum;
   sum.val[0] = sum.val[1] = vdupq_n_s32(0);
-  return WienerVertical(a, filter, sum);
+  return WienerVertical<bitdepth>(a, filter, sum);
 }
 
+template <int bitdepth>
 inline uint16x8x2_t WienerVerticalTap3Kernel2(
     const int16_t* const wiener_buffer, const ptrdiff_t wiener_stride,
     const int16_t filter[4]) {
   int16x8_t a[4];
   int32x4x2_t sum;
   uint16x8x2_t d;
-  d.val[0] = WienerVerticalTap3Kernel(wiener_buffer, wiener_stride, filter, a);
+  d.val[0] = WienerVerticalTap3Kernel<bitdepth>(wiener_buffer, wiener_stride,
+                                                filter, a);
   a[3] = vld1q_s16(wiener_buffer + 3 * wiener_stride);
   sum.val[0] = sum.val[1] = vdupq_n_s32(0);
-  d.val[1] = WienerVertical(a + 1, filter, sum);
+  d.val[1] = WienerVertical<bitdepth>(a + 1, filter, sum);
   return d;
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap3(const int16_t* wiener_buffer,
                                const ptrdiff_t width, const int height,
                                const int16_t filter[4], uint16_t* dst,
                                const ptrdiff_t dst_stride) {
-  const uint16x8_t v_max_bitdepth = vdupq_n_u16((1 << kBitdepth10) - 1);
+  const uint16x8_t v_max_bitdepth = vdupq_n_u16((1 << bitdepth) - 1);
 
   for (int y = height >> 1; y != 0; --y) {
     uint16_t* dst_ptr = dst;
     ptrdiff_t x = width;
     do {
       uint16x8x2_t d[2];
-      d[0] = WienerVerticalTap3Kernel2(wiener_buffer + 0, width, filter);
-      d[1] = WienerVerticalTap3Kernel2(wiener_buffer + 8, width, filter);
+      d[0] = WienerVerticalTap3Kernel2<bitdepth>(wiener_buffer + 0, width,
+                                                 filter);
+      d[1] = WienerVerticalTap3Kernel2<bitdepth>(wiener_buffer + 8, width,
+                                                 filter);
 
       vst1q_u16(dst_ptr, vminq_u16(d[0].val[0], v_max_bitdepth));
       vst1q_u16(dst_ptr + 8, vminq_u16(d[1].val[0], v_max_bitdepth));
@@ -421,9 +464,11 @@ inline void WienerVerticalTap3(const int16_t* wiener_buffer,
     do {
       int16x8_t a[3];
       const uint16x8_t d0 =
-          WienerVerticalTap3Kernel(wiener_buffer + 0, width, filter, a);
+          WienerVerticalTap3Kernel<bitdepth>(wiener_buffer + 0, width, filter,
+                                             a);
       const uint16x8_t d1 =
-          WienerVerticalTap3Kernel(wiener_buffer + 8, width, filter, a);
+          WienerVerticalTap3Kernel<bitdepth>(wiener_buffer + 8, width, filter,
+                                             a);
       vst1q_u16(dst, vminq_u16(d0, v_max_bitdepth));
       vst1q_u16(dst + 8, vminq_u16(d1, v_max_bitdepth));
       wiener_buffer += 16;
@@ -433,13 +478,17 @@ inline void WienerVerticalTap3(const int16_t* wiener_buffer,
   }
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap1Kernel(const int16_t* const wiener_buffer,
                                      uint16_t* const dst) {
-  const uint16x8_t v_max_bitdepth = vdupq_n_u16((1 << kBitdepth10) - 1);
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
+  constexpr int kShift = kRoundBitsVertical - kWienerFilterBits;
+  const uint16x8_t v_max_bitdepth = vdupq_n_u16((1 << bitdepth) - 1);
   const int16x8_t a0 = vld1q_s16(wiener_buffer + 0);
   const int16x8_t a1 = vld1q_s16(wiener_buffer + 8);
-  const int16x8_t d0 = vrshrq_n_s16(a0, 4);
-  const int16x8_t d1 = vrshrq_n_s16(a1, 4);
+  const int16x8_t d0 = vrshrq_n_s16(a0, kShift);
+  const int16x8_t d1 = vrshrq_n_s16(a1, kShift);
   vst1q_u16(dst, vminq_u16(vreinterpretq_u16_s16(vmaxq_s16(d0, vdupq_n_s16(0))),
                            v_max_bitdepth));
   vst1q_u16(dst + 8,
@@ -447,6 +496,7 @@ inline void WienerVerticalTap1Kernel(const int16_t* const wiener_buffer,
                       v_max_bitdepth));
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap1(const int16_t* wiener_buffer,
                                const ptrdiff_t width, const int height,
                                uint16_t* dst, const ptrdiff_t dst_stride) {
@@ -454,8 +504,9 @@ inline void WienerVerticalTap1(const int16_t* wiener_buffer,
     uint16_t* dst_ptr = dst;
     ptrdiff_t x = width;
     do {
-      WienerVerticalTap1Kernel(wiener_buffer, dst_ptr);
-      WienerVerticalTap1Kernel(wiener_buffer + width, dst_ptr + dst_stride);
+      WienerVerticalTap1Kernel<bitdepth>(wiener_buffer, dst_ptr);
+      WienerVerticalTap1Kernel<bitdepth>(wiener_buffer + width,
+                                         dst_ptr + dst_stride);
       wiener_buffer += 16;
       dst_ptr += 16;
       x -= 16;
@@ -467,7 +518,7 @@ inline void WienerVerticalTap1(const int16_t* wiener_buffer,
   if ((height & 1) != 0) {
     ptrdiff_t x = width;
     do {
-      WienerVerticalTap1Kernel(wiener_buffer, dst);
+      WienerVerticalTap1Kernel<bitdepth>(wiener_buffer, dst);
       wiener_buffer += 16;
       dst += 16;
       x -= 16;
@@ -478,6 +529,7 @@ inline void WienerVerticalTap1(const int16_t* wiener_buffer,
 // For width 16 and up, store the horizontal results, and then do the vertical
 // filter row by row. This is faster than doing it column by column when
 // considering cache issues.
+template <int bitdepth>
 void WienerFilter_NEON(
     const RestorationUnitInfo& LIBGAV1_RESTRICT restoration_info,
     const void* LIBGAV1_RESTRICT const source, const ptrdiff_t stride,
@@ -494,7 +546,7 @@ void WienerFilter_NEON(
       1);
   const ptrdiff_t wiener_stride = Align(width, 16);
   int16_t* const wiener_buffer_vertical = restoration_buffer->wiener_buffer;
-  // The values are saturated to 13 bits before storing.
+  // The values are saturated to 13 bits (15 bits for 12bpp) before storing.
   int16_t* wiener_buffer_horizontal =
       wiener_buffer_vertical + number_rows_to_skip * wiener_stride;
   int16_t filter_horizontal[(kWienerFilterTaps + 1) / 2];
@@ -512,41 +564,47 @@ void WienerFilter_NEON(
   const auto* const top = static_cast<const uint16_t*>(top_border);
   const auto* const bottom = static_cast<const uint16_t*>(bottom_border);
   if (number_leading_zero_coefficients[WienerInfo::kHorizontal] == 0) {
-    WienerHorizontalTap7(top + (2 - height_extra) * top_border_stride - 3,
-                         top_border_stride, wiener_stride, width, height_extra,
-                         filter_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap7(src - 3, stride, wiener_stride, width, height,
-                         filter_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap7(bottom - 3, bottom_border_stride, wiener_stride, width,
-                         height_extra, filter_horizontal,
-                         &wiener_buffer_horizontal);
+    WienerHorizontalTap7<bitdepth>(
+        top + (2 - height_extra) * top_border_stride - 3, top_border_stride,
+        wiener_stride, width, height_extra, filter_horizontal,
+        &wiener_buffer_horizontal);
+    WienerHorizontalTap7<bitdepth>(src - 3, stride, wiener_stride, width,
+                                   height, filter_horizontal,
+                                   &wiener_buffer_horizontal);
+    WienerHorizontalTap7<bitdepth>(
+        bottom - 3, bottom_border_stride, wiener_stride, width, height_extra,
+        filter_horizontal, &wiener_buffer_horizontal);
   } else if (number_leading_zero_coefficients[WienerInfo::kHorizontal] == 1) {
-    WienerHorizontalTap5(top + (2 - height_extra) * top_border_stride - 2,
-                         top_border_stride, wiener_stride, width, height_extra,
-                         filter_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap5(src - 2, stride, wiener_stride, width, height,
-                         filter_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap5(bottom - 2, bottom_border_stride, wiener_stride, width,
-                         height_extra, filter_horizontal,
-                         &wiener_buffer_horizontal);
+    WienerHorizontalTap5<bitdepth>(
+        top + (2 - height_extra) * top_border_stride - 2, top_border_stride,
+        wiener_stride, width, height_extra, filter_horizontal,
+        &wiener_buffer_horizontal);
+    WienerHorizontalTap5<bitdepth>(src - 2, stride, wiener_stride, width,
+                                   height, filter_horizontal,
+                                   &wiener_buffer_horizontal);
+    WienerHorizontalTap5<bitdepth>(
+        bottom - 2, bottom_border_stride, wiener_stride, width, height_extra,
+        filter_horizontal, &wiener_buffer_horizontal);
   } else if (number_leading_zero_coefficients[WienerInfo::kHorizontal] == 2) {
-    WienerHorizontalTap3(top + (2 - height_extra) * top_border_stride - 1,
-                         top_border_stride, wiener_stride, height_extra,
-                         filter_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap3(src - 1, stride, wiener_stride, height,
-                         filter_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap3(bottom - 1, bottom_border_stride, wiener_stride,
-                         height_extra, filter_horizontal,
-                         &wiener_buffer_horizontal);
+    WienerHorizontalTap3<bitdepth>(
+        top + (2 - height_extra) * top_border_stride - 1, top_border_stride,
+        wiener_stride, height_extra, filter_horizontal,
+        &wiener_buffer_horizontal);
+    WienerHorizontalTap3<bitdepth>(src - 1, stride, wiener_stride, height,
+                                   filter_horizontal,
+                                   &wiener_buffer_horizontal);
+    WienerHorizontalTap3<bitdepth>(
+        bottom - 1, bottom_border_stride, wiener_stride, height_extra,
+        filter_horizontal, &wiener_buffer_horizontal);
   } else {
     assert(number_leading_zero_coefficients[WienerInfo::kHorizontal] == 3);
-    WienerHorizontalTap1(top + (2 - height_extra) * top_border_stride,
-                         top_border_stride, wiener_stride, height_extra,
-                         &wiener_buffer_horizontal);
-    WienerHorizontalTap1(src, stride, wiener_stride, height,
-                         &wiener_buffer_horizontal);
-    WienerHorizontalTap1(bottom, bottom_border_stride, wiener_stride,
-                         height_extra, &wiener_buffer_horizontal);
+    WienerHorizontalTap1<bitdepth>(top + (2 - height_extra) * top_border_stride,
+                                   top_border_stride, wiener_stride,
+                                   height_extra, &wiener_buffer_horizontal);
+    WienerHorizontalTap1<bitdepth>(src, stride, wiener_stride, height,
+                                   &wiener_buffer_horizontal);
+    WienerHorizontalTap1<bitdepth>(bottom, bottom_border_stride, wiener_stride,
+                                   height_extra, &wiener_buffer_horizontal);
   }
 
   // vertical filtering.
@@ -560,18 +618,20 @@ void WienerFilter_NEON(
     memcpy(restoration_buffer->wiener_buffer,
            restoration_buffer->wiener_buffer + wiener_stride,
            sizeof(*restoration_buffer->wiener_buffer) * wiener_stride);
-    WienerVerticalTap7(wiener_buffer_vertical, wiener_stride, height,
-                       filter_vertical, dst, stride);
+    WienerVerticalTap7<bitdepth>(wiener_buffer_vertical, wiener_stride, height,
+                                 filter_vertical, dst, stride);
   } else if (number_leading_zero_coefficients[WienerInfo::kVertical] == 1) {
-    WienerVerticalTap5(wiener_buffer_vertical + wiener_stride, wiener_stride,
-                       height, filter_vertical, dst, stride);
+    WienerVerticalTap5<bitdepth>(wiener_buffer_vertical + wiener_stride,
+                                 wiener_stride, height, filter_vertical, dst,
+                                 stride);
   } else if (number_leading_zero_coefficients[WienerInfo::kVertical] == 2) {
-    WienerVerticalTap3(wiener_buffer_vertical + 2 * wiener_stride,
-                       wiener_stride, height, filter_vertical, dst, stride);
+    WienerVerticalTap3<bitdepth>(wiener_buffer_vertical + 2 * wiener_stride,
+                                 wiener_stride, height, filter_vertical, dst,
+                                 stride);
   } else {
     assert(number_leading_zero_coefficients[WienerInfo::kVertical] == 3);
-    WienerVerticalTap1(wiener_buffer_vertical + 3 * wiener_stride,
-                       wiener_stride, height, dst, stride);
+    WienerVerticalTap1<bitdepth>(wiener_buffer_vertical + 3 * wiener_stride,
+                                 wiener_stride, height, dst, stride);
   }
 }
 
@@ -801,6 +861,18 @@ inline uint16x8_t Sum5_16(const uint16x8_t src[5]) {
   return vaddq_u16(sum, src[4]);
 }
 
+// A 5x5 box sum of 12 bit pixels needs 17 bits.
+inline void Sum5W16(const uint16x8_t src[5], uint32x4_t dst[2]) {
+  const uint16x8_t sum01 = vaddq_u16(src[0], src[1]);
+  const uint16x8_t sum23 = vaddq_u16(src[2], src[3]);
+  const uint32x4_t sum0123_lo =
+      vaddl_u16(vget_low_u16(sum01), vget_low_u16(sum23));
+  const uint32x4_t sum0123_hi =
+      vaddl_u16(vget_high_u16(sum01), vget_high_u16(sum23));
+  dst[0] = vaddw_u16(sum0123_lo, vget_low_u16(src[4]));
+  dst[1] = vaddw_u16(sum0123_hi, vget_high_u16(src[4]));
+}
+
 inline uint32x4_t Sum5_32(const uint32x4_t* src0, const uint32x4_t* src1,
                           const uint32x4_t* src2, const uint32x4_t* src3,
                           const uint32x4_t* src4) {
@@ -1057,17 +1129,31 @@ inline uint16x4_t CalculateMa(const uint16x4_t sum, const uint32x4_t sum_sq,
   return vmovn_u32(shifted);
 }
 
-template <int n>
+template <int bitdepth, int n>
 inline uint16x8_t CalculateMa(const uint16x8_t sum, const uint32x4_t sum_sq[2],
                               const uint32_t scale) {
   static_assert(n == 9 || n == 25, "");
-  const uint16x8_t b = vrshrq_n_u16(sum, 2);
+  const uint16x8_t b = vrshrq_n_u16(sum, bitdepth - 8);
   const uint16x4_t sum_lo = vget_low_u16(b);
   const uint16x4_t sum_hi = vget_high_u16(b);
-  const uint16x4_t z0 =
-      CalculateMa<n>(sum_lo, vrshrq_n_u32(sum_sq[0], 4), scale);
-  const uint16x4_t z1 =
-      CalculateMa<n>(sum_hi, vrshrq_n_u32(sum_sq[1], 4), scale);
+  const uint16x4_t z0 = CalculateMa<n>(
+      sum_lo, vrshrq_n_u32(sum_sq[0], 2 * (bitdepth - 8)), scale);
+  const uint16x4_t z1 = CalculateMa<n>(
+      sum_hi, vrshrq_n_u32(sum_sq[1], 2 * (bitdepth - 8)), scale);
+  return vcombine_u16(z0, z1);
+}
+
+template <int bitdepth, int n>
+inline uint16x8_t CalculateMa(const uint32x4_t sum[2],
+                              const uint32x4_t sum_sq[2],
+                              const uint32_t scale) {
+  static_assert(n == 9 || n == 25, "");
+  const uint16x4_t sum_lo = vrshrn_n_u32(sum[0], bitdepth - 8);
+  const uint16x4_t sum_hi = vrshrn_n_u32(sum[1], bitdepth - 8);
+  const uint16x4_t z0 = CalculateMa<n>(
+      sum_lo, vrshrq_n_u32(sum_sq[0], 2 * (bitdepth - 8)), scale);
+  const uint16x4_t z1 = CalculateMa<n>(
+      sum_hi, vrshrq_n_u32(sum_sq[1], 2 * (bitdepth - 8)), scale);
   return vcombine_u16(z0, z1);
 }
 
@@ -1088,6 +1174,22 @@ inline void CalculateB5(const uint16x8_t sum, const uint16x8_t ma,
   b[1] = vrshrq_n_u32(m1, kSgrProjReciprocalBits - 2);
 }
 
+inline void CalculateB5(const uint32x4_t sum[2], const uint16x8_t ma,
+                        uint32x4_t b[2]) {
+  // one_over_n == 164.
+  constexpr uint32_t one_over_n =
+      ((1 << kSgrProjReciprocalBits) + (25 >> 1)) / 25;
+  // one_over_n_quarter == 41.
+  constexpr uint32_t one_over_n_quarter = one_over_n >> 2;
+  static_assert(one_over_n == one_over_n_quarter << 2, "");
+  // |ma| is in range [0, 255].
+  const uint16x8_t m = vmulq_n_u16(ma, one_over_n_quarter);
+  const uint32x4_t m0 = vmulq_u32(vmovl_u16(vget_low_u16(m)), sum[0]);
+  const uint32x4_t m1 = vmulq_u32(vmovl_u16(vget_high_u16(m)), sum[1]);
+  b[0] = vrshrq_n_u32(m0, kSgrProjReciprocalBits - 2);
+  b[1] = vrshrq_n_u32(m1, kSgrProjReciprocalBits - 2);
+}
+
 inline void CalculateB3(const uint16x8_t sum, const uint16x8_t ma,
                         uint32x4_t b[2]) {
   // one_over_n == 455.
@@ -1101,6 +1203,7 @@ inline void CalculateB3(const uint16x8_t sum, const uint16x8_t ma,
   b[1] = vrshrq_n_u32(m3, kSgrProjReciprocalBits);
 }
 
+template <int bitdepth>
 inline void CalculateSumAndIndex3(const uint16x8_t s3[3],
                                   const uint32x4_t sq3[3][2],
                                   const uint32_t scale, uint16x8_t* const sum,
@@ -1108,9 +1211,10 @@ inline void CalculateSumAndIndex3(const uint16x8_t s3[3],
   uint32x4_t sum_sq[2];
   *sum = Sum3_16(s3);
   Sum3_32(sq3, sum_sq);
-  *index = CalculateMa<9>(*sum, sum_sq, scale);
+  *index = CalculateMa<bitdepth, 9>(*sum, sum_sq, scale);
 }
 
+template <int bitdepth>
 inline void CalculateSumAndIndex5(const uint16x8_t s5[5],
                                   const uint32x4_t sq5[5][2],
                                   const uint32_t scale, uint16x8_t* const sum,
@@ -1118,13 +1222,24 @@ inline void CalculateSumAndIndex5(const uint16x8_t s5[5],
   uint32x4_t sum_sq[2];
   *sum = Sum5_16(s5);
   Sum5_32(sq5, sum_sq);
-  *index = CalculateMa<25>(*sum, sum_sq, scale);
+  *index = CalculateMa<bitdepth, 25>(*sum, sum_sq, scale);
 }
 
-template <int n, int offset>
-inline void LookupIntermediate(const uint16x8_t sum, const uint16x8_t index,
-                               uint8x16_t* const ma, uint32x4_t b[2]) {
-  static_assert(n == 9 || n == 25, "");
+// The 5x5 box sums of 12 bit pixels are widened to 32 bits.
+template <int bitdepth>
+inline void CalculateSumAndIndex5W(const uint16x8_t s5[5],
+                                   const uint32x4_t sq5[5][2],
+                                   const uint32_t scale, uint32x4_t sum[2],
+                                   uint16x8_t* const index) {
+  uint32x4_t sum_sq[2];
+  Sum5W16(s5, sum);
+  Sum5_32(sq5, sum_sq);
+  *index = CalculateMa<bitdepth, 25>(sum, sum_sq, scale);
+}
+
+// Returns the 8 |ma| values also inserted into |ma|, widened to 16 bits.
+template <int offset>
+inline uint16x8_t LookupMa(const uint16x8_t index, uint8x16_t* const ma) {
   static_assert(offset == 0 || offset == 8, "");
 
   const uint8x8_t idx = vqmovn_u16(index);
@@ -1144,6 +1259,14 @@ inline void LookupIntermediate(const uint16x8_t sum, const uint16x8_t index,
   *ma = vsetq_lane_u8(kSgrMaLookup[temp[5]], *ma, offset + 5);
   *ma = vsetq_lane_u8(kSgrMaLookup[temp[6]], *ma, offset + 6);
   *ma = vsetq_lane_u8(kSgrMaLookup[temp[7]], *ma, offset + 7);
+  return vmovl_u8((offset == 0) ? vget_low_u8(*ma) : vget_high_u8(*ma));
+}
+
+template <int n, int offset>
+inline void LookupIntermediate(const uint16x8_t sum, const uint16x8_t index,
+                               uint8x16_t* const ma, uint32x4_t b[2]) {
+  static_assert(n == 9 || n == 25, "");
+  const uint16x8_t maq = LookupMa<offset>(index, ma);
   // b = ma * b * one_over_n
   // |ma| = [0, 255]
   // |sum| is a box sum with radius 1 or 2.
@@ -1155,8 +1278,6 @@ inline void LookupIntermediate(const uint16x8_t sum, const uint16x8_t index,
   // |kSgrProjReciprocalBits| is 12.
   // Radius 2: 255 * 6375 * 164 >> 12 = 65088 (16 bits).
   // Radius 1: 255 * 2295 * 455 >> 12 = 65009 (16 bits).
-  const uint16x8_t maq =
-      vmovl_u8((offset == 0) ? vget_low_u8(*ma) : vget_high_u8(*ma));
   if (n == 9) {
     CalculateB3(sum, maq, b);
   } else {
@@ -1164,6 +1285,14 @@ inline void LookupIntermediate(const uint16x8_t sum, const uint16x8_t index,
   }
 }
 
+// 12 bit pixels only. The 5x5 box sums are 32 bits.
+template <int offset>
+inline void LookupIntermediate5(const uint32x4_t sum[2], const uint16x8_t index,
+                                uint8x16_t* const ma, uint32x4_t b[2]) {
+  const uint16x8_t maq = LookupMa<offset>(index, ma);
+  CalculateB5(sum, maq, b);
+}
+
 inline uint8x8_t AdjustValue(const uint8x8_t value, const uint8x8_t index,
                              const int threshold) {
   const uint8x8_t thresholds = vdup_n_u8(threshold);
@@ -1241,23 +1370,31 @@ inline void CalculateIntermediate(const uint16x8_t sum[2],
   ma[1] = vextq_u8(mas, vdupq_n_u8(0), 8);
 }
 
-template <int offset>
+template <int bitdepth, int offset>
 inline void CalculateIntermediate5(const uint16x8_t s5[5],
                                    const uint32x4_t sq5[5][2],
                                    const uint32_t scale, uint8x16_t* const ma,
                                    uint32x4_t b[2]) {
   static_assert(offset == 0 || offset == 8, "");
-  uint16x8_t sum, index;
-  CalculateSumAndIndex5(s5, sq5, scale, &sum, &index);
-  LookupIntermediate<25, offset>(sum, index, ma, b);
+  uint16x8_t index;
+  if (bitdepth == kBitdepth12) {
+    uint32x4_t sum[2];
+    CalculateSumAndIndex5W<bitdepth>(s5, sq5, scale, sum, &index);
+    LookupIntermediate5<offset>(sum, index, ma, b);
+  } else {
+    uint16x8_t sum;
+    CalculateSumAndIndex5<bitdepth>(s5, sq5, scale, &sum, &index);
+    LookupIntermediate<25, offset>(sum, index, ma, b);
+  }
 }
 
+template <int bitdepth>
 inline void CalculateIntermediate3(const uint16x8_t s3[3],
                                    const uint32x4_t sq3[3][2],
                                    const uint32_t scale, uint8x16_t* const ma,
                                    uint32x4_t b[2]) {
   uint16x8_t sum, index;
-  CalculateSumAndIndex3(s3, sq3, scale, &sum, &index);
+  CalculateSumAndIndex3<bitdepth>(s3, sq3, scale, &sum, &index);
   LookupIntermediate<9, 0>(sum, index, ma, b);
 }
 
@@ -1349,6 +1486,7 @@ inline void Store343_444Hi(const uint8x16_t ma3[3], const uint32x4_t b3[2],
   Store343_444Hi(ma3, b3, x, &sum_ma343, sum_b343, ma343, ma444, b343, b444);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5Lo(
     const uint16x8_t s[2][4], const uint32_t scale, uint16_t* const sum5[5],
     uint32_t* const square_sum5[5], uint32x4_t sq[2][8], uint8x16_t* const ma,
@@ -1367,9 +1505,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5Lo(
   StoreAligned32U32(square_sum5[4], sq5[4]);
   LoadAligned16x3U16(sum5, 0, s5[0]);
   LoadAligned32x3U32(square_sum5, 0, sq5);
-  CalculateIntermediate5<0>(s5[0], sq5, scale, ma, b);
+  CalculateIntermediate5<bitdepth, 0>(s5[0], sq5, scale, ma, b);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5(
     const uint16x8_t s[2][4], const ptrdiff_t sum_width, const ptrdiff_t x,
     const uint32_t scale, uint16_t* const sum5[5],
@@ -1393,7 +1532,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5(
   StoreAligned32U32(square_sum5[4] + x, sq5[4]);
   LoadAligned16x3U16(sum5, x, s5[0]);
   LoadAligned32x3U32(square_sum5, x, sq5);
-  CalculateIntermediate5<8>(s5[0], sq5, scale, &ma[0], b + 2);
+  CalculateIntermediate5<bitdepth, 8>(s5[0], sq5, scale, &ma[0], b + 2);
 
   Square(s[0][3], sq[0] + 6);
   Square(s[1][3], sq[1] + 6);
@@ -1403,9 +1542,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5(
   StoreAligned32U32(square_sum5[4] + x + 8, sq5[4]);
   LoadAligned16x3U16Msan(sum5, x + 8, sum_width, s5[1]);
   LoadAligned32x3U32Msan(square_sum5, x + 8, sum_width, sq5);
-  CalculateIntermediate5<0>(s5[1], sq5, scale, &ma[1], b + 4);
+  CalculateIntermediate5<bitdepth, 0>(s5[1], sq5, scale, &ma[1], b + 4);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5LastRowLo(
     const uint16x8_t s[2], const uint32_t scale, const uint16_t* const sum5[5],
     const uint32_t* const square_sum5[5], uint32x4_t sq[4],
@@ -1419,9 +1559,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5LastRowLo(
   sq5[4][1] = sq5[3][1];
   LoadAligned16x3U16(sum5, 0, s5);
   LoadAligned32x3U32(square_sum5, 0, sq5);
-  CalculateIntermediate5<0>(s5, sq5, scale, ma, b);
+  CalculateIntermediate5<bitdepth, 0>(s5, sq5, scale, ma, b);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5LastRow(
     const uint16x8_t s[4], const ptrdiff_t sum_width, const ptrdiff_t x,
     const uint32_t scale, const uint16_t* const sum5[5],
@@ -1439,7 +1580,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5LastRow(
   sq5[4][1] = sq5[3][1];
   LoadAligned16x3U16(sum5, x, s5[0]);
   LoadAligned32x3U32(square_sum5, x, sq5);
-  CalculateIntermediate5<8>(s5[0], sq5, scale, &ma[0], b + 2);
+  CalculateIntermediate5<bitdepth, 8>(s5[0], sq5, scale, &ma[0], b + 2);
 
   Square(s[3], sq + 6);
   Sum5Horizontal32(sq + 4, sq5[3]);
@@ -1447,9 +1588,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5LastRow(
   sq5[4][1] = sq5[3][1];
   LoadAligned16x3U16Msan(sum5, x + 8, sum_width, s5[1]);
   LoadAligned32x3U32Msan(square_sum5, x + 8, sum_width, sq5);
-  CalculateIntermediate5<0>(s5[1], sq5, scale, &ma[1], b + 4);
+  CalculateIntermediate5<bitdepth, 0>(s5[1], sq5, scale, &ma[1], b + 4);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess3Lo(
     const uint16x8_t s[2], const uint32_t scale, uint16_t* const sum3[3],
     uint32_t* const square_sum3[3], uint32x4_t sq[4], uint8x16_t* const ma,
@@ -1463,9 +1605,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess3Lo(
   StoreAligned32U32(square_sum3[2], sq3[2]);
   LoadAligned16x2U16(sum3, 0, s3);
   LoadAligned32x2U32(square_sum3, 0, sq3);
-  CalculateIntermediate3(s3, sq3, scale, ma, b);
+  CalculateIntermediate3<bitdepth>(s3, sq3, scale, ma, b);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess3(
     const uint16x8_t s[4], const ptrdiff_t x, const ptrdiff_t sum_width,
     const uint32_t scale, uint16_t* const sum3[3],
@@ -1482,17 +1625,18 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess3(
   StoreAligned32U32(square_sum3[2] + x + 0, sq3[2]);
   LoadAligned16x2U16(sum3, x, s3);
   LoadAligned32x2U32(square_sum3, x, sq3);
-  CalculateSumAndIndex3(s3, sq3, scale, &sum[0], &index[0]);
+  CalculateSumAndIndex3<bitdepth>(s3, sq3, scale, &sum[0], &index[0]);
 
   Square(s[3], sq + 6);
   Sum3Horizontal32(sq + 4, sq3[2]);
   StoreAligned32U32(square_sum3[2] + x + 8, sq3[2]);
   LoadAligned16x2U16Msan(sum3, x + 8, sum_width, s3 + 1);
   LoadAligned32x2U32Msan(square_sum3, x + 8, sum_width, sq3);
-  CalculateSumAndIndex3(s3 + 1, sq3, scale, &sum[1], &index[1]);
+  CalculateSumAndIndex3<bitdepth>(s3 + 1, sq3, scale, &sum[1], &index[1]);
   CalculateIntermediate(sum, index, ma, b + 2);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLo(
     const uint16x8_t s[2][4], const uint16_t scales[2], uint16_t* const sum3[4],
     uint16_t* const sum5[5], uint32_t* const square_sum3[4],
@@ -1519,13 +1663,16 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLo(
   LoadAligned32x2U32(square_sum3, 0, sq3);
   LoadAligned16x3U16(sum5, 0, s5);
   LoadAligned32x3U32(square_sum5, 0, sq5);
-  CalculateSumAndIndex3(s3 + 0, sq3 + 0, scales[1], &sum[0], &index[0]);
-  CalculateSumAndIndex3(s3 + 1, sq3 + 1, scales[1], &sum[1], &index[1]);
+  CalculateSumAndIndex3<bitdepth>(s3 + 0, sq3 + 0, scales[1], &sum[0],
+                                  &index[0]);
+  CalculateSumAndIndex3<bitdepth>(s3 + 1, sq3 + 1, scales[1], &sum[1],
+                                  &index[1]);
   CalculateIntermediate(sum, index, &ma3[0][0], b3[0], b3[1]);
   ma3[1][0] = vextq_u8(ma3[0][0], vdupq_n_u8(0), 8);
-  CalculateIntermediate5<0>(s5, sq5, scales[0], ma5, b5);
+  CalculateIntermediate5<bitdepth, 0>(s5, sq5, scales[0], ma5, b5);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess(
     const uint16x8_t s[2][4], const ptrdiff_t x, const uint16_t scales[2],
     uint16_t* const sum3[4], uint16_t* const sum5[5],
@@ -1555,12 +1702,13 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess(
   StoreAligned32U32(square_sum5[4] + x, sq5[4]);
   LoadAligned16x2U16(sum3, x, s3[0]);
   LoadAligned32x2U32(square_sum3, x, sq3);
-  CalculateSumAndIndex3(s3[0], sq3, scales[1], &sum[0][0], &index[0][0]);
-  CalculateSumAndIndex3(s3[0] + 1, sq3 + 1, scales[1], &sum[1][0],
-                        &index[1][0]);
+  CalculateSumAndIndex3<bitdepth>(s3[0], sq3, scales[1], &sum[0][0],
+                                  &index[0][0]);
+  CalculateSumAndIndex3<bitdepth>(s3[0] + 1, sq3 + 1, scales[1], &sum[1][0],
+                                  &index[1][0]);
   LoadAligned16x3U16(sum5, x, s5[0]);
   LoadAligned32x3U32(square_sum5, x, sq5);
-  CalculateIntermediate5<8>(s5[0], sq5, scales[0], &ma5[0], b5 + 2);
+  CalculateIntermediate5<bitdepth, 8>(s5[0], sq5, scales[0], &ma5[0], b5 + 2);
 
   Square(s[0][3], sq[0] + 6);
   Square(s[1][3], sq[1] + 6);
@@ -1572,16 +1720,18 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess(
   StoreAligned32U32(square_sum5[4] + x + 8, sq5[4]);
   LoadAligned16x2U16Msan(sum3, x + 8, sum_width, s3[1]);
   LoadAligned32x2U32Msan(square_sum3, x + 8, sum_width, sq3);
-  CalculateSumAndIndex3(s3[1], sq3, scales[1], &sum[0][1], &index[0][1]);
-  CalculateSumAndIndex3(s3[1] + 1, sq3 + 1, scales[1], &sum[1][1],
-                        &index[1][1]);
+  CalculateSumAndIndex3<bitdepth>(s3[1], sq3, scales[1], &sum[0][1],
+                                  &index[0][1]);
+  CalculateSumAndIndex3<bitdepth>(s3[1] + 1, sq3 + 1, scales[1], &sum[1][1],
+                                  &index[1][1]);
   CalculateIntermediate(sum[0], index[0], ma3[0], b3[0] + 2);
   CalculateIntermediate(sum[1], index[1], ma3[1], b3[1] + 2);
   LoadAligned16x3U16Msan(sum5, x + 8, sum_width, s5[1]);
   LoadAligned32x3U32Msan(square_sum5, x + 8, sum_width, sq5);
-  CalculateIntermediate5<0>(s5[1], sq5, scales[0], &ma5[1], b5 + 4);
+  CalculateIntermediate5<bitdepth, 0>(s5[1], sq5, scales[0], &ma5[1], b5 + 4);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRowLo(
     const uint16x8_t s[2], const uint16_t scales[2],
     const uint16_t* const sum3[4], const uint16_t* const sum5[5],
@@ -1599,12 +1749,13 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRowLo(
   LoadAligned32x3U32(square_sum5, 0, sq5);
   sq5[4][0] = sq5[3][0];
   sq5[4][1] = sq5[3][1];
-  CalculateIntermediate5<0>(s5, sq5, scales[0], ma5, b5);
+  CalculateIntermediate5<bitdepth, 0>(s5, sq5, scales[0], ma5, b5);
   LoadAligned16x2U16(sum3, 0, s3);
   LoadAligned32x2U32(square_sum3, 0, sq3);
-  CalculateIntermediate3(s3, sq3, scales[1], ma3, b3);
+  CalculateIntermediate3<bitdepth>(s3, sq3, scales[1], ma3, b3);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRow(
     const uint16x8_t s[4], const ptrdiff_t sum_width, const ptrdiff_t x,
     const uint16_t scales[2], const uint16_t* const sum3[4],
@@ -1622,10 +1773,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRow(
   LoadAligned32x3U32(square_sum5, x, sq5);
   sq5[4][0] = sq5[3][0];
   sq5[4][1] = sq5[3][1];
-  CalculateIntermediate5<8>(s5[0], sq5, scales[0], ma5, b5 + 2);
+  CalculateIntermediate5<bitdepth, 8>(s5[0], sq5, scales[0], ma5, b5 + 2);
   LoadAligned16x2U16(sum3, x, s3[0]);
   LoadAligned32x2U32(square_sum3, x, sq3);
-  CalculateSumAndIndex3(s3[0], sq3, scales[1], &sum[0], &index[0]);
+  CalculateSumAndIndex3<bitdepth>(s3[0], sq3, scales[1], &sum[0], &index[0]);
 
   Square(s[3], sq + 6);
   SumHorizontal32(sq + 4, &sq3[2][0], &sq3[2][1], &sq5[3][0], &sq5[3][1]);
@@ -1634,13 +1785,14 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRow(
   LoadAligned32x3U32Msan(square_sum5, x + 8, sum_width, sq5);
   sq5[4][0] = sq5[3][0];
   sq5[4][1] = sq5[3][1];
-  CalculateIntermediate5<0>(s5[1], sq5, scales[0], ma5 + 1, b5 + 4);
+  CalculateIntermediate5<bitdepth, 0>(s5[1], sq5, scales[0], ma5 + 1, b5 + 4);
   LoadAligned16x2U16Msan(sum3, x + 8, sum_width, s3[1]);
   LoadAligned32x2U32Msan(square_sum3, x + 8, sum_width, sq3);
-  CalculateSumAndIndex3(s3[1], sq3, scales[1], &sum[1], &index[1]);
+  CalculateSumAndIndex3<bitdepth>(s3[1], sq3, scales[1], &sum[1], &index[1]);
   CalculateIntermediate(sum, index, ma3, b3 + 2);
 }
 
+template <int bitdepth>
 inline void BoxSumFilterPreProcess5(const uint16_t* const src0,
                                     const uint16_t* const src1, const int width,
                                     const uint32_t scale,
@@ -1660,7 +1812,8 @@ inline void BoxSumFilterPreProcess5(const uint16_t* const src0,
   s[1][1] = Load1QMsanU16(src1 + 8, overread_in_bytes + 16);
   Square(s[0][0], sq[0]);
   Square(s[1][0], sq[1]);
-  BoxFilterPreProcess5Lo(s, scale, sum5, square_sum5, sq, &mas[0], bs);
+  BoxFilterPreProcess5Lo<bitdepth>(s, scale, sum5, square_sum5, sq, &mas[0],
+                                   bs);
 
   int x = 0;
   do {
@@ -1677,8 +1830,8 @@ inline void BoxSumFilterPreProcess5(const uint16_t* const src0,
     s[1][3] = Load1QMsanU16(src1 + x + 24,
                             overread_in_bytes + sizeof(*src1) * (x + 24));
 
-    BoxFilterPreProcess5(s, sum_width, x + 8, scale, sum5, square_sum5, sq, mas,
-                         bs);
+    BoxFilterPreProcess5<bitdepth>(s, sum_width, x + 8, scale, sum5,
+                                   square_sum5, sq, mas, bs);
     Prepare3_8<0>(mas, ma5);
     ma[0] = Sum565Lo(ma5);
     ma[1] = Sum565Hi(ma5);
@@ -1703,7 +1856,7 @@ inline void BoxSumFilterPreProcess5(const uint16_t* const src0,
   } while (x < width);
 }
 
-template <bool calculate444>
+template <int bitdepth, bool calculate444>
 LIBGAV1_ALWAYS_INLINE void BoxSumFilterPreProcess3(
     const uint16_t* const src, const int width, const uint32_t scale,
     uint16_t* const sum3[3], uint32_t* const square_sum3[3],
@@ -1718,7 +1871,8 @@ LIBGAV1_ALWAYS_INLINE void BoxSumFilterPreProcess3(
   s[0] = Load1QMsanU16(src + 0, overread_in_bytes + 0);
   s[1] = Load1QMsanU16(src + 8, overread_in_bytes + 16);
   Square(s[0], sq);
-  BoxFilterPreProcess3Lo(s, scale, sum3, square_sum3, sq, &mas[0], bs);
+  BoxFilterPreProcess3Lo<bitdepth>(s, scale, sum3, square_sum3, sq, &mas[0],
+                                   bs);
 
   int x = 0;
   do {
@@ -1726,8 +1880,8 @@ LIBGAV1_ALWAYS_INLINE void BoxSumFilterPreProcess3(
                          overread_in_bytes + sizeof(*src) * (x + 16));
     s[3] = Load1QMsanU16(src + x + 24,
                          overread_in_bytes + sizeof(*src) * (x + 24));
-    BoxFilterPreProcess3(s, x + 8, sum_width, scale, sum3, square_sum3, sq, mas,
-                         bs);
+    BoxFilterPreProcess3<bitdepth>(s, x + 8, sum_width, scale, sum3,
+                                   square_sum3, sq, mas, bs);
     uint8x16_t ma3[3];
     Prepare3_8<0>(mas, ma3);
     if (calculate444) {  // NOLINT(readability-simplify-boolean-expr)
@@ -1757,6 +1911,7 @@ LIBGAV1_ALWAYS_INLINE void BoxSumFilterPreProcess3(
   } while (x < width);
 }
 
+template <int bitdepth>
 inline void BoxSumFilterPreProcess(
     const uint16_t* const src0, const uint16_t* const src1, const int width,
     const uint16_t scales[2], uint16_t* const sum3[4], uint16_t* const sum5[5],
@@ -1776,8 +1931,8 @@ inline void BoxSumFilterPreProcess(
   s[1][1] = Load1QMsanU16(src1 + 8, overread_in_bytes + 16);
   Square(s[0][0], sq[0]);
   Square(s[1][0], sq[1]);
-  BoxFilterPreProcessLo(s, scales, sum3, sum5, square_sum3, square_sum5, sq,
-                        ma3, b3, &ma5[0], b5);
+  BoxFilterPreProcessLo<bitdepth>(s, scales, sum3, sum5, square_sum3,
+                                  square_sum5, sq, ma3, b3, &ma5[0], b5);
 
   int x = 0;
   do {
@@ -1793,8 +1948,8 @@ inline void BoxSumFilterPreProcess(
                             overread_in_bytes + sizeof(*src1) * (x + 16));
     s[1][3] = Load1QMsanU16(src1 + x + 24,
                             overread_in_bytes + sizeof(*src1) * (x + 24));
-    BoxFilterPreProcess(s, x + 8, scales, sum3, sum5, square_sum3, square_sum5,
-                        sum_width, sq, ma3, b3, ma5, b5);
+    BoxFilterPreProcess<bitdepth>(s, x + 8, scales, sum3, sum5, square_sum3,
+                                  square_sum5, sum_width, sq, ma3, b3, ma5, b5);
 
     Prepare3_8<0>(ma3[0], ma3x);
     ma[0] = Sum343Lo(ma3x);
@@ -1837,7 +1992,7 @@ inline void BoxSumFilterPreProcess(
 }
 
 template <int shift>
-inline int16x4_t FilterOutput(const uint32x4_t ma_x_src, const uint32x4_t b) {
+inline int32x4_t FilterOutput(const uint32x4_t ma_x_src, const uint32x4_t b) {
   // ma: 255 * 32 = 8160 (13 bits)
   // b: 65088 * 32 = 2082816 (21 bits)
   // v: b - ma * 255 (22 bits)
@@ -1845,38 +2000,40 @@ inline int16x4_t FilterOutput(const uint32x4_t ma_x_src, const uint32x4_t b) {
   // kSgrProjSgrBits = 8
   // kSgrProjRestoreBits = 4
   // shift = 4 or 5
-  // v >> 8 or 9 (13 bits)
-  return vqrshrn_n_s32(v, kSgrProjSgrBits + shift - kSgrProjRestoreBits);
+  // v >> 8 or 9 (13 bits, 15 bits for 12bpp)
+  return vrshrq_n_s32(v, kSgrProjSgrBits + shift - kSgrProjRestoreBits);
 }
 
+// The output is kept in 32 bits, so the 12bpp values are not saturated before
+// the final weighting.
 template <int shift>
-inline int16x8_t CalculateFilteredOutput(const uint16x8_t src,
-                                         const uint16x8_t ma,
-                                         const uint32x4_t b[2]) {
+inline void CalculateFilteredOutput(const uint16x8_t src, const uint16x8_t ma,
+                                    const uint32x4_t b[2], int32x4_t dst[2]) {
   const uint32x4_t ma_x_src_lo = VmullLo16(ma, src);
   const uint32x4_t ma_x_src_hi = VmullHi16(ma, src);
-  const int16x4_t dst_lo = FilterOutput<shift>(ma_x_src_lo, b[0]);
-  const int16x4_t dst_hi = FilterOutput<shift>(ma_x_src_hi, b[1]);
-  return vcombine_s16(dst_lo, dst_hi);  // 13 bits
+  dst[0] = FilterOutput<shift>(ma_x_src_lo, b[0]);
+  dst[1] = FilterOutput<shift>(ma_x_src_hi, b[1]);
 }
 
-inline int16x8_t CalculateFilteredOutputPass1(const uint16x8_t src,
-                                              const uint16x8_t ma[2],
-                                              const uint32x4_t b[2][2]) {
+inline void CalculateFilteredOutputPass1(const uint16x8_t src,
+                                         const uint16x8_t ma[2],
+                                         const uint32x4_t b[2][2],
+                                         int32x4_t dst[2]) {
   const uint16x8_t ma_sum = vaddq_u16(ma[0], ma[1]);
   uint32x4_t b_sum[2];
   b_sum[0] = vaddq_u32(b[0][0], b[1][0]);
   b_sum[1] = vaddq_u32(b[0][1], b[1][1]);
-  return CalculateFilteredOutput<5>(src, ma_sum, b_sum);
+  CalculateFilteredOutput<5>(src, ma_sum, b_sum, dst);
 }
 
-inline int16x8_t CalculateFilteredOutputPass2(const uint16x8_t src,
-                                              const uint16x8_t ma[3],
-                                              const uint32x4_t b[3][2]) {
+inline void CalculateFilteredOutputPass2(const uint16x8_t src,
+                                         const uint16x8_t ma[3],
+                                         const uint32x4_t b[3][2],
+                                         int32x4_t dst[2]) {
   const uint16x8_t ma_sum = Sum3_16(ma);
   uint32x4_t b_sum[2];
   Sum3_32(b, b_sum);
-  return CalculateFilteredOutput<5>(src, ma_sum, b_sum);
+  CalculateFilteredOutput<5>(src, ma_sum, b_sum, dst);
 }
 
 inline int16x8_t SelfGuidedFinal(const uint16x8_t src, const int32x4_t v[2]) {
@@ -1889,32 +2046,34 @@ inline int16x8_t SelfGuidedFinal(const uint16x8_t src, const int32x4_t v[2]) {
 }
 
 inline int16x8_t SelfGuidedDoubleMultiplier(const uint16x8_t src,
-                                            const int16x8_t filter[2],
+                                            const int32x4_t filter[2][2],
                                             const int w0, const int w2) {
   int32x4_t v[2];
-  v[0] = vmull_n_s16(vget_low_s16(filter[0]), w0);
-  v[1] = vmull_n_s16(vget_high_s16(filter[0]), w0);
-  v[0] = vmlal_n_s16(v[0], vget_low_s16(filter[1]), w2);
-  v[1] = vmlal_n_s16(v[1], vget_high_s16(filter[1]), w2);
+  v[0] = vmulq_n_s32(filter[0][0], w0);
+  v[1] = vmulq_n_s32(filter[0][1], w0);
+  v[0] = vmlaq_n_s32(v[0], filter[1][0], w2);
+  v[1] = vmlaq_n_s32(v[1], filter[1][1], w2);
   return SelfGuidedFinal(src, v);
 }
 
 inline int16x8_t SelfGuidedSingleMultiplier(const uint16x8_t src,
-                                            const int16x8_t filter,
+                                            const int32x4_t filter[2],
                                             const int w0) {
   // weight: -96 to 96 (Sgrproj_Xqd_Min/Max)
   int32x4_t v[2];
-  v[0] = vmull_n_s16(vget_low_s16(filter), w0);
-  v[1] = vmull_n_s16(vget_high_s16(filter), w0);
+  v[0] = vmulq_n_s32(filter[0], w0);
+  v[1] = vmulq_n_s32(filter[1], w0);
   return SelfGuidedFinal(src, v);
 }
 
+template <int bitdepth>
 inline void ClipAndStore(uint16_t* const dst, const int16x8_t val) {
   const uint16x8_t val0 = vreinterpretq_u16_s16(vmaxq_s16(val, vdupq_n_s16(0)));
-  const uint16x8_t val1 = vminq_u16(val0, vdupq_n_u16((1 << kBitdepth10) - 1));
+  const uint16x8_t val1 = vminq_u16(val0, vdupq_n_u16((1 << bitdepth) - 1));
   vst1q_u16(dst, val1);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
     const uint16_t* const src, const uint16_t* const src0,
     const uint16_t* const src1, const ptrdiff_t stride, uint16_t* const sum5[5],
@@ -1934,14 +2093,15 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
 
   Square(s[0][0], sq[0]);
   Square(s[1][0], sq[1]);
-  BoxFilterPreProcess5Lo(s, scale, sum5, square_sum5, sq, &mas[0], bs);
+  BoxFilterPreProcess5Lo<bitdepth>(s, scale, sum5, square_sum5, sq, &mas[0],
+                                   bs);
 
   int x = 0;
   do {
     uint16x8_t ma[2];
     uint32x4_t b[2][2];
     uint8x16_t ma5[3];
-    int16x8_t p[2];
+    int32x4_t p[2][2];
 
     s[0][2] = Load1QMsanU16(src0 + x + 16,
                             overread_in_bytes + sizeof(*src0) * (x + 16));
@@ -1951,8 +2111,8 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
                             overread_in_bytes + sizeof(*src1) * (x + 16));
     s[1][3] = Load1QMsanU16(src1 + x + 24,
                             overread_in_bytes + sizeof(*src1) * (x + 24));
-    BoxFilterPreProcess5(s, sum_width, x + 8, scale, sum5, square_sum5, sq, mas,
-                         bs);
+    BoxFilterPreProcess5<bitdepth>(s, sum_width, x + 8, scale, sum5,
+                                   square_sum5, sq, mas, bs);
     Prepare3_8<0>(mas, ma5);
     ma[1] = Sum565Lo(ma5);
     vst1q_u16(ma565[1] + x, ma[1]);
@@ -1962,8 +2122,8 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
     const uint16x8_t sr1_lo = vld1q_u16(src + stride + x + 0);
     ma[0] = vld1q_u16(ma565[0] + x);
     LoadAligned32U32(b565[0] + x, b[0]);
-    p[0] = CalculateFilteredOutputPass1(sr0_lo, ma, b);
-    p[1] = CalculateFilteredOutput<4>(sr1_lo, ma[1], b[1]);
+    CalculateFilteredOutputPass1(sr0_lo, ma, b, p[0]);
+    CalculateFilteredOutput<4>(sr1_lo, ma[1], b[1], p[1]);
     const int16x8_t d00 = SelfGuidedSingleMultiplier(sr0_lo, p[0], w0);
     const int16x8_t d10 = SelfGuidedSingleMultiplier(sr1_lo, p[1], w0);
 
@@ -1975,14 +2135,14 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
     const uint16x8_t sr1_hi = vld1q_u16(src + stride + x + 8);
     ma[0] = vld1q_u16(ma565[0] + x + 8);
     LoadAligned32U32(b565[0] + x + 8, b[0]);
-    p[0] = CalculateFilteredOutputPass1(sr0_hi, ma, b);
-    p[1] = CalculateFilteredOutput<4>(sr1_hi, ma[1], b[1]);
+    CalculateFilteredOutputPass1(sr0_hi, ma, b, p[0]);
+    CalculateFilteredOutput<4>(sr1_hi, ma[1], b[1], p[1]);
     const int16x8_t d01 = SelfGuidedSingleMultiplier(sr0_hi, p[0], w0);
-    ClipAndStore(dst + x + 0, d00);
-    ClipAndStore(dst + x + 8, d01);
+    ClipAndStore<bitdepth>(dst + x + 0, d00);
+    ClipAndStore<bitdepth>(dst + x + 8, d01);
     const int16x8_t d11 = SelfGuidedSingleMultiplier(sr1_hi, p[1], w0);
-    ClipAndStore(dst + stride + x + 0, d10);
-    ClipAndStore(dst + stride + x + 8, d11);
+    ClipAndStore<bitdepth>(dst + stride + x + 0, d10);
+    ClipAndStore<bitdepth>(dst + stride + x + 8, d11);
     s[0][0] = s[0][2];
     s[0][1] = s[0][3];
     s[1][0] = s[1][2];
@@ -1998,6 +2158,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
   } while (x < width);
 }
 
+template <int bitdepth>
 inline void BoxFilterPass1LastRow(
     const uint16_t* const src, const uint16_t* const src0, const int width,
     const ptrdiff_t sum_width, const uint32_t scale, const int16_t w0,
@@ -2012,7 +2173,8 @@ inline void BoxFilterPass1LastRow(
   s[0] = Load1QMsanU16(src0 + 0, overread_in_bytes + 0);
   s[1] = Load1QMsanU16(src0 + 8, overread_in_bytes + 16);
   Square(s[0], sq);
-  BoxFilterPreProcess5LastRowLo(s, scale, sum5, square_sum5, sq, &mas[0], bs);
+  BoxFilterPreProcess5LastRowLo<bitdepth>(s, scale, sum5, square_sum5, sq,
+                                          &mas[0], bs);
 
   int x = 0;
   do {
@@ -2024,15 +2186,16 @@ inline void BoxFilterPass1LastRow(
                          overread_in_bytes + sizeof(*src0) * (x + 16));
     s[3] = Load1QMsanU16(src0 + x + 24,
                          overread_in_bytes + sizeof(*src0) * (x + 24));
-    BoxFilterPreProcess5LastRow(s, sum_width, x + 8, scale, sum5, square_sum5,
-                                sq, mas, bs);
+    BoxFilterPreProcess5LastRow<bitdepth>(s, sum_width, x + 8, scale, sum5,
+                                          square_sum5, sq, mas, bs);
     Prepare3_8<0>(mas, ma5);
     ma[1] = Sum565Lo(ma5);
     Sum565(bs, b[1]);
     ma[0] = vld1q_u16(ma565);
     LoadAligned32U32(b565, b[0]);
     const uint16x8_t sr_lo = vld1q_u16(src + x + 0);
-    int16x8_t p = CalculateFilteredOutputPass1(sr_lo, ma, b);
+    int32x4_t p[2];
+    CalculateFilteredOutputPass1(sr_lo, ma, b, p);
     const int16x8_t d0 = SelfGuidedSingleMultiplier(sr_lo, p, w0);
 
     ma[1] = Sum565Hi(ma5);
@@ -2040,10 +2203,10 @@ inline void BoxFilterPass1LastRow(
     ma[0] = vld1q_u16(ma565 + 8);
     LoadAligned32U32(b565 + 8, b[0]);
     const uint16x8_t sr_hi = vld1q_u16(src + x + 8);
-    p = CalculateFilteredOutputPass1(sr_hi, ma, b);
+    CalculateFilteredOutputPass1(sr_hi, ma, b, p);
     const int16x8_t d1 = SelfGuidedSingleMultiplier(sr_hi, p, w0);
-    ClipAndStore(dst + x + 0, d0);
-    ClipAndStore(dst + x + 8, d1);
+    ClipAndStore<bitdepth>(dst + x + 0, d0);
+    ClipAndStore<bitdepth>(dst + x + 8, d1);
     s[1] = s[3];
     sq[2] = sq[6];
     sq[3] = sq[7];
@@ -2056,6 +2219,7 @@ inline void BoxFilterPass1LastRow(
   } while (x < width);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
     const uint16_t* const src, const uint16_t* const src0, const int width,
     const ptrdiff_t sum_width, const uint32_t scale, const int16_t w0,
@@ -2071,7 +2235,8 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
   s[0] = Load1QMsanU16(src0 + 0, overread_in_bytes + 0);
   s[1] = Load1QMsanU16(src0 + 8, overread_in_bytes + 16);
   Square(s[0], sq);
-  BoxFilterPreProcess3Lo(s, scale, sum3, square_sum3, sq, &mas[0], bs);
+  BoxFilterPreProcess3Lo<bitdepth>(s, scale, sum3, square_sum3, sq, &mas[0],
+                                   bs);
 
   int x = 0;
   do {
@@ -2079,8 +2244,8 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
                          overread_in_bytes + sizeof(*src0) * (x + 16));
     s[3] = Load1QMsanU16(src0 + x + 24,
                          overread_in_bytes + sizeof(*src0) * (x + 24));
-    BoxFilterPreProcess3(s, x + 8, sum_width, scale, sum3, square_sum3, sq, mas,
-                         bs);
+    BoxFilterPreProcess3<bitdepth>(s, x + 8, sum_width, scale, sum3,
+                                   square_sum3, sq, mas, bs);
     uint16x8_t ma[3];
     uint32x4_t b[3][2];
     uint8x16_t ma3[3];
@@ -2093,7 +2258,8 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
     ma[1] = vld1q_u16(ma444[0] + x);
     LoadAligned32U32(b343[0] + x, b[0]);
     LoadAligned32U32(b444[0] + x, b[1]);
-    const int16x8_t p0 = CalculateFilteredOutputPass2(sr_lo, ma, b);
+    int32x4_t p0[2], p1[2];
+    CalculateFilteredOutputPass2(sr_lo, ma, b, p0);
 
     Store343_444Hi(ma3, bs + 2, x + 8, &ma[2], b[2], ma343[2], ma444[1],
                    b343[2], b444[1]);
@@ -2102,11 +2268,11 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
     ma[1] = vld1q_u16(ma444[0] + x + 8);
     LoadAligned32U32(b343[0] + x + 8, b[0]);
     LoadAligned32U32(b444[0] + x + 8, b[1]);
-    const int16x8_t p1 = CalculateFilteredOutputPass2(sr_hi, ma, b);
+    CalculateFilteredOutputPass2(sr_hi, ma, b, p1);
     const int16x8_t d0 = SelfGuidedSingleMultiplier(sr_lo, p0, w0);
     const int16x8_t d1 = SelfGuidedSingleMultiplier(sr_hi, p1, w0);
-    ClipAndStore(dst + x + 0, d0);
-    ClipAndStore(dst + x + 8, d1);
+    ClipAndStore<bitdepth>(dst + x + 0, d0);
+    ClipAndStore<bitdepth>(dst + x + 8, d1);
     s[1] = s[3];
     sq[2] = sq[6];
     sq[3] = sq[7];
@@ -2117,6 +2283,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
   } while (x < width);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilter(
     const uint16_t* const src, const uint16_t* const src0,
     const uint16_t* const src1, const ptrdiff_t stride, const int width,
@@ -2138,15 +2305,15 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
   s[1][1] = Load1QMsanU16(src1 + 8, overread_in_bytes + 16);
   Square(s[0][0], sq[0]);
   Square(s[1][0], sq[1]);
-  BoxFilterPreProcessLo(s, scales, sum3, sum5, square_sum3, square_sum5, sq,
-                        ma3, b3, &ma5[0], b5);
+  BoxFilterPreProcessLo<bitdepth>(s, scales, sum3, sum5, square_sum3,
+                                  square_sum5, sq, ma3, b3, &ma5[0], b5);
 
   int x = 0;
   do {
     uint16x8_t ma[3][3];
     uint32x4_t b[3][3][2];
     uint8x16_t ma3x[2][3], ma5x[3];
-    int16x8_t p[2][2];
+    int32x4_t p[2][2][2];
 
     s[0][2] = Load1QMsanU16(src0 + x + 16,
                             overread_in_bytes + sizeof(*src0) * (x + 16));
@@ -2157,8 +2324,8 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
     s[1][3] = Load1QMsanU16(src1 + x + 24,
                             overread_in_bytes + sizeof(*src1) * (x + 24));
 
-    BoxFilterPreProcess(s, x + 8, scales, sum3, sum5, square_sum3, square_sum5,
-                        sum_width, sq, ma3, b3, ma5, b5);
+    BoxFilterPreProcess<bitdepth>(s, x + 8, scales, sum3, sum5, square_sum3,
+                                  square_sum5, sum_width, sq, ma3, b3, ma5, b5);
     Prepare3_8<0>(ma3[0], ma3x[0]);
     Prepare3_8<0>(ma3[1], ma3x[1]);
     Prepare3_8<0>(ma5, ma5x);
@@ -2174,17 +2341,17 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
     const uint16x8_t sr1_lo = vld1q_u16(src + stride + x);
     ma[0][0] = vld1q_u16(ma565[0] + x);
     LoadAligned32U32(b565[0] + x, b[0][0]);
-    p[0][0] = CalculateFilteredOutputPass1(sr0_lo, ma[0], b[0]);
-    p[1][0] = CalculateFilteredOutput<4>(sr1_lo, ma[0][1], b[0][1]);
+    CalculateFilteredOutputPass1(sr0_lo, ma[0], b[0], p[0][0]);
+    CalculateFilteredOutput<4>(sr1_lo, ma[0][1], b[0][1], p[1][0]);
     ma[1][0] = vld1q_u16(ma343[0] + x);
     ma[1][1] = vld1q_u16(ma444[0] + x);
     LoadAligned32U32(b343[0] + x, b[1][0]);
     LoadAligned32U32(b444[0] + x, b[1][1]);
-    p[0][1] = CalculateFilteredOutputPass2(sr0_lo, ma[1], b[1]);
+    CalculateFilteredOutputPass2(sr0_lo, ma[1], b[1], p[0][1]);
     const int16x8_t d00 = SelfGuidedDoubleMultiplier(sr0_lo, p[0], w0, w2);
     ma[2][0] = vld1q_u16(ma343[1] + x);
     LoadAligned32U32(b343[1] + x, b[2][0]);
-    p[1][1] = CalculateFilteredOutputPass2(sr1_lo, ma[2], b[2]);
+    CalculateFilteredOutputPass2(sr1_lo, ma[2], b[2], p[1][1]);
     const int16x8_t d10 = SelfGuidedDoubleMultiplier(sr1_lo, p[1], w0, w2);
 
     Store343_444Hi(ma3x[0], b3[0] + 2, x + 8, &ma[1][2], &ma[2][1], b[1][2],
@@ -2201,22 +2368,22 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
         src + stride + x + 8, overread_in_bytes + 4 + sizeof(*src) * (x + 8));
     ma[0][0] = vld1q_u16(ma565[0] + x + 8);
     LoadAligned32U32(b565[0] + x + 8, b[0][0]);
-    p[0][0] = CalculateFilteredOutputPass1(sr0_hi, ma[0], b[0]);
-    p[1][0] = CalculateFilteredOutput<4>(sr1_hi, ma[0][1], b[0][1]);
+    CalculateFilteredOutputPass1(sr0_hi, ma[0], b[0], p[0][0]);
+    CalculateFilteredOutput<4>(sr1_hi, ma[0][1], b[0][1], p[1][0]);
     ma[1][0] = vld1q_u16(ma343[0] + x + 8);
     ma[1][1] = vld1q_u16(ma444[0] + x + 8);
     LoadAligned32U32(b343[0] + x + 8, b[1][0]);
     LoadAligned32U32(b444[0] + x + 8, b[1][1]);
-    p[0][1] = CalculateFilteredOutputPass2(sr0_hi, ma[1], b[1]);
+    CalculateFilteredOutputPass2(sr0_hi, ma[1], b[1], p[0][1]);
     const int16x8_t d01 = SelfGuidedDoubleMultiplier(sr0_hi, p[0], w0, w2);
-    ClipAndStore(dst + x + 0, d00);
-    ClipAndStore(dst + x + 8, d01);
+    ClipAndStore<bitdepth>(dst + x + 0, d00);
+    ClipAndStore<bitdepth>(dst + x + 8, d01);
     ma[2][0] = vld1q_u16(ma343[1] + x + 8);
     LoadAligned32U32(b343[1] + x + 8, b[2][0]);
-    p[1][1] = CalculateFilteredOutputPass2(sr1_hi, ma[2], b[2]);
+    CalculateFilteredOutputPass2(sr1_hi, ma[2], b[2], p[1][1]);
     const int16x8_t d11 = SelfGuidedDoubleMultiplier(sr1_hi, p[1], w0, w2);
-    ClipAndStore(dst + stride + x + 0, d10);
-    ClipAndStore(dst + stride + x + 8, d11);
+    ClipAndStore<bitdepth>(dst + stride + x + 0, d10);
+    ClipAndStore<bitdepth>(dst + stride + x + 8, d11);
     s[0][0] = s[0][2];
     s[0][1] = s[0][3];
     s[1][0] = s[1][2];
@@ -2238,6 +2405,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
   } while (x < width);
 }
 
+template <int bitdepth>
 inline void BoxFilterLastRow(
     const uint16_t* const src, const uint16_t* const src0, const int width,
     const ptrdiff_t sum_width, const uint16_t scales[2], const int16_t w0,
@@ -2257,20 +2425,22 @@ inline void BoxFilterLastRow(
   s[0] = Load1QMsanU16(src0 + 0, overread_in_bytes + 0);
   s[1] = Load1QMsanU16(src0 + 8, overread_in_bytes + 16);
   Square(s[0], sq);
-  BoxFilterPreProcessLastRowLo(s, scales, sum3, sum5, square_sum3, square_sum5,
-                               sq, &ma3[0], &ma5[0], b3, b5);
+  BoxFilterPreProcessLastRowLo<bitdepth>(s, scales, sum3, sum5, square_sum3,
+                                         square_sum5, sq, &ma3[0], &ma5[0], b3,
+                                         b5);
 
   int x = 0;
   do {
     uint8x16_t ma3x[3], ma5x[3];
-    int16x8_t p[2];
+    int32x4_t p[2][2];
 
     s[2] = Load1QMsanU16(src0 + x + 16,
                          overread_in_bytes + sizeof(*src0) * (x + 16));
     s[3] = Load1QMsanU16(src0 + x + 24,
                          overread_in_bytes + sizeof(*src0) * (x + 24));
-    BoxFilterPreProcessLastRow(s, sum_width, x + 8, scales, sum3, sum5,
-                               square_sum3, square_sum5, sq, ma3, ma5, b3, b5);
+    BoxFilterPreProcessLastRow<bitdepth>(s, sum_width, x + 8, scales, sum3,
+                                         sum5, square_sum3, square_sum5, sq,
+                                         ma3, ma5, b3, b5);
     Prepare3_8<0>(ma3, ma3x);
     Prepare3_8<0>(ma5, ma5x);
     ma[1] = Sum565Lo(ma5x);
@@ -2280,12 +2450,12 @@ inline void BoxFilterLastRow(
     const uint16x8_t sr_lo = vld1q_u16(src + x + 0);
     ma[0] = vld1q_u16(ma565 + x);
     LoadAligned32U32(b565 + x, b[0]);
-    p[0] = CalculateFilteredOutputPass1(sr_lo, ma, b);
+    CalculateFilteredOutputPass1(sr_lo, ma, b, p[0]);
     ma[0] = vld1q_u16(ma343 + x);
     ma[1] = vld1q_u16(ma444 + x);
     LoadAligned32U32(b343 + x, b[0]);
     LoadAligned32U32(b444 + x, b[1]);
-    p[1] = CalculateFilteredOutputPass2(sr_lo, ma, b);
+    CalculateFilteredOutputPass2(sr_lo, ma, b, p[1]);
     const int16x8_t d0 = SelfGuidedDoubleMultiplier(sr_lo, p, w0, w2);
 
     ma[1] = Sum565Hi(ma5x);
@@ -2296,15 +2466,15 @@ inline void BoxFilterLastRow(
         src + x + 8, overread_in_bytes + 4 + sizeof(*src) * (x + 8));
     ma[0] = vld1q_u16(ma565 + x + 8);
     LoadAligned32U32(b565 + x + 8, b[0]);
-    p[0] = CalculateFilteredOutputPass1(sr_hi, ma, b);
+    CalculateFilteredOutputPass1(sr_hi, ma, b, p[0]);
     ma[0] = vld1q_u16(ma343 + x + 8);
     ma[1] = vld1q_u16(ma444 + x + 8);
     LoadAligned32U32(b343 + x + 8, b[0]);
     LoadAligned32U32(b444 + x + 8, b[1]);
-    p[1] = CalculateFilteredOutputPass2(sr_hi, ma, b);
+    CalculateFilteredOutputPass2(sr_hi, ma, b, p[1]);
     const int16x8_t d1 = SelfGuidedDoubleMultiplier(sr_hi, p, w0, w2);
-    ClipAndStore(dst + x + 0, d0);
-    ClipAndStore(dst + x + 8, d1);
+    ClipAndStore<bitdepth>(dst + x + 0, d0);
+    ClipAndStore<bitdepth>(dst + x + 8, d1);
     s[1] = s[3];
     sq[2] = sq[6];
     sq[3] = sq[7];
@@ -2318,6 +2488,7 @@ inline void BoxFilterLastRow(
   } while (x < width);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterProcess(
     const RestorationUnitInfo& restoration_info, const uint16_t* src,
     const ptrdiff_t stride, const uint16_t* const top_border,
@@ -2367,9 +2538,9 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterProcess(
   sum5[0] = sum5[1];
   square_sum5[0] = square_sum5[1];
   const uint16_t* const s = (height > 1) ? src + stride : bottom_border;
-  BoxSumFilterPreProcess(src, s, width, scales, sum3, sum5, square_sum3,
-                         square_sum5, sum_width, ma343, ma444[0], ma565[0],
-                         b343, b444[0], b565[0]);
+  BoxSumFilterPreProcess<bitdepth>(src, s, width, scales, sum3, sum5,
+                                   square_sum3, square_sum5, sum_width, ma343,
+                                   ma444[0], ma565[0], b343, b444[0], b565[0]);
   sum5[0] = sgr_buffer->sum5;
   square_sum5[0] = sgr_buffer->square_sum5;
 
@@ -2378,9 +2549,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterProcess(
     Circulate4PointersBy2<uint32_t>(square_sum3);
     Circulate5PointersBy2<uint16_t>(sum5);
     Circulate5PointersBy2<uint32_t>(square_sum5);
-    BoxFilter(src + 3, src + 2 * stride, src + 3 * stride, stride, width,
-              scales, w0, w2, sum3, sum5, square_sum3, square_sum5, sum_width,
-              ma343, ma444, ma565, b343, b444, b565, dst);
+    BoxFilter<bitdepth>(src + 3, src + 2 * stride, src + 3 * stride, stride,
+                        width, scales, w0, w2, sum3, sum5, square_sum3,
+                        square_sum5, sum_width, ma343, ma444, ma565, b343, b444,
+                        b565, dst);
     src += 2 * stride;
     dst += 2 * stride;
     Circulate4PointersBy2<uint16_t>(ma343);
@@ -2404,9 +2576,9 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterProcess(
       sr[0] = src + 2 * stride;
       sr[1] = bottom_border;
     }
-    BoxFilter(src + 3, sr[0], sr[1], stride, width, scales, w0, w2, sum3, sum5,
-              square_sum3, square_sum5, sum_width, ma343, ma444, ma565, b343,
-              b444, b565, dst);
+    BoxFilter<bitdepth>(src + 3, sr[0], sr[1], stride, width, scales, w0, w2,
+                        sum3, sum5, square_sum3, square_sum5, sum_width, ma343,
+                        ma444, ma565, b343, b444, b565, dst);
   }
   if ((height & 1) != 0) {
     if (height > 1) {
@@ -2423,13 +2595,14 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterProcess(
       std::swap(ma565[0], ma565[1]);
       std::swap(b565[0], b565[1]);
     }
-    BoxFilterLastRow(src + 3, bottom_border + bottom_border_stride, width,
-                     sum_width, scales, w0, w2, sum3, sum5, square_sum3,
-                     square_sum5, ma343[0], ma444[0], ma565[0], b343[0],
-                     b444[0], b565[0], dst);
+    BoxFilterLastRow<bitdepth>(src + 3, bottom_border + bottom_border_stride,
+                               width, sum_width, scales, w0, w2, sum3, sum5,
+                               square_sum3, square_sum5, ma343[0], ma444[0],
+                               ma565[0], b343[0], b444[0], b565[0], dst);
   }
 }
 
+template <int bitdepth>
 inline void BoxFilterProcessPass1(const RestorationUnitInfo& restoration_info,
                                   const uint16_t* src, const ptrdiff_t stride,
                                   const uint16_t* const top_border,
@@ -2463,16 +2636,17 @@ inline void BoxFilterProcessPass1(const RestorationUnitInfo& restoration_info,
   sum5[0] = sum5[1];
   square_sum5[0] = square_sum5[1];
   const uint16_t* const s = (height > 1) ? src + stride : bottom_border;
-  BoxSumFilterPreProcess5(src, s, width, scale, sum5, square_sum5, sum_width,
-                          ma565[0], b565[0]);
+  BoxSumFilterPreProcess5<bitdepth>(src, s, width, scale, sum5, square_sum5,
+                                    sum_width, ma565[0], b565[0]);
   sum5[0] = sgr_buffer->sum5;
   square_sum5[0] = sgr_buffer->square_sum5;
 
   for (int y = (height >> 1) - 1; y > 0; --y) {
     Circulate5PointersBy2<uint16_t>(sum5);
     Circulate5PointersBy2<uint32_t>(square_sum5);
-    BoxFilterPass1(src + 3, src + 2 * stride, src + 3 * stride, stride, sum5,
-                   square_sum5, width, sum_width, scale, w0, ma565, b565, dst);
+    BoxFilterPass1<bitdepth>(src + 3, src + 2 * stride, src + 3 * stride,
+                             stride, sum5, square_sum5, width, sum_width, scale,
+                             w0, ma565, b565, dst);
     src += 2 * stride;
     dst += 2 * stride;
     std::swap(ma565[0], ma565[1]);
@@ -2490,8 +2664,8 @@ inline void BoxFilterProcessPass1(const RestorationUnitInfo& restoration_info,
       sr[0] = src + 2 * stride;
       sr[1] = bottom_border;
     }
-    BoxFilterPass1(src + 3, sr[0], sr[1], stride, sum5, square_sum5, width,
-                   sum_width, scale, w0, ma565, b565, dst);
+    BoxFilterPass1<bitdepth>(src + 3, sr[0], sr[1], stride, sum5, square_sum5,
+                             width, sum_width, scale, w0, ma565, b565, dst);
   }
   if ((height & 1) != 0) {
     src += 3;
@@ -2503,12 +2677,13 @@ inline void BoxFilterProcessPass1(const RestorationUnitInfo& restoration_info,
       Circulate5PointersBy2<uint16_t>(sum5);
       Circulate5PointersBy2<uint32_t>(square_sum5);
     }
-    BoxFilterPass1LastRow(src, bottom_border + bottom_border_stride, width,
-                          sum_width, scale, w0, sum5, square_sum5, ma565[0],
-                          b565[0], dst);
+    BoxFilterPass1LastRow<bitdepth>(src, bottom_border + bottom_border_stride,
+                                    width, sum_width, scale, w0, sum5,
+                                    square_sum5, ma565[0], b565[0], dst);
   }
 }
 
+template <int bitdepth>
 inline void BoxFilterProcessPass2(const RestorationUnitInfo& restoration_info,
                                   const uint16_t* src, const ptrdiff_t stride,
                                   const uint16_t* const top_border,
@@ -2544,9 +2719,9 @@ inline void BoxFilterProcessPass2(const RestorationUnitInfo& restoration_info,
   assert(scale != 0);
   BoxSum<3>(top_border, top_border_stride, width, sum_stride, sum_width,
             sum3[0], square_sum3[0]);
-  BoxSumFilterPreProcess3<false>(src, width, scale, sum3, square_sum3,
-                                 sum_width, ma343[0], nullptr, b343[0],
-                                 nullptr);
+  BoxSumFilterPreProcess3<bitdepth, false>(src, width, scale, sum3, square_sum3,
+                                           sum_width, ma343[0], nullptr,
+                                           b343[0], nullptr);
   Circulate3PointersBy1<uint16_t>(sum3);
   Circulate3PointersBy1<uint32_t>(square_sum3);
   const uint16_t* s;
@@ -2556,14 +2731,16 @@ inline void BoxFilterProcessPass2(const RestorationUnitInfo& restoration_info,
     s = bottom_border;
     bottom_border += bottom_border_stride;
   }
-  BoxSumFilterPreProcess3<true>(s, width, scale, sum3, square_sum3, sum_width,
-                                ma343[1], ma444[0], b343[1], b444[0]);
+  BoxSumFilterPreProcess3<bitdepth, true>(s, width, scale, sum3, square_sum3,
+                                          sum_width, ma343[1], ma444[0],
+                                          b343[1], b444[0]);
 
   for (int y = height - 2; y > 0; --y) {
     Circulate3PointersBy1<uint16_t>(sum3);
     Circulate3PointersBy1<uint32_t>(square_sum3);
-    BoxFilterPass2(src + 2, src + 2 * stride, width, sum_width, scale, w0, sum3,
-                   square_sum3, ma343, ma444, b343, b444, dst);
+    BoxFilterPass2<bitdepth>(src + 2, src + 2 * stride, width, sum_width, scale,
+                             w0, sum3, square_sum3, ma343, ma444, b343, b444,
+                             dst);
     src += stride;
     dst += stride;
     Circulate3PointersBy1<uint16_t>(ma343);
@@ -2577,8 +2754,8 @@ inline void BoxFilterProcessPass2(const RestorationUnitInfo& restoration_info,
   do {
     Circulate3PointersBy1<uint16_t>(sum3);
     Circulate3PointersBy1<uint32_t>(square_sum3);
-    BoxFilterPass2(src, bottom_border, width, sum_width, scale, w0, sum3,
-                   square_sum3, ma343, ma444, b343, b444, dst);
+    BoxFilterPass2<bitdepth>(src, bottom_border, width, sum_width, scale, w0,
+                             sum3, square_sum3, ma343, ma444, b343, b444, dst);
     src += stride;
     dst += stride;
     bottom_border += bottom_border_stride;
@@ -2592,6 +2769,7 @@ inline void BoxFilterProcessPass2(const RestorationUnitInfo& restoration_info,
 // If |width| is non-multiple of 8, up to 7 more pixels are written to |dest| in
 // the end of each row. It is safe to overwrite the output as it will not be
 // part of the visible frame.
+template <int bitdepth>
 void SelfGuidedFilter_NEON(
     const RestorationUnitInfo& LIBGAV1_RESTRICT restoration_info,
     const void* LIBGAV1_RESTRICT const source, const ptrdiff_t stride,
@@ -2613,30 +2791,44 @@ void SelfGuidedFilter_NEON(
     // |radius_pass_0| and |radius_pass_1| cannot both be 0, so we have the
     // following assertion.
     assert(radius_pass_0 != 0);
-    BoxFilterProcessPass1(restoration_info, src - 3, stride, top - 3,
-                          top_border_stride, bottom - 3, bottom_border_stride,
-                          width, height, sgr_buffer, dst);
+    BoxFilterProcessPass1<bitdepth>(
+        restoration_info, src - 3, stride, top - 3, top_border_stride,
+        bottom - 3, bottom_border_stride, width, height, sgr_buffer, dst);
   } else if (radius_pass_0 == 0) {
-    BoxFilterProcessPass2(restoration_info, src - 2, stride, top - 2,
-                          top_border_stride, bottom - 2, bottom_border_stride,
-                          width, height, sgr_buffer, dst);
+    BoxFilterProcessPass2<bitdepth>(
+        restoration_info, src - 2, stride, top - 2, top_border_stride,
+        bottom - 2, bottom_border_stride, width, height, sgr_buffer, dst);
   } else {
-    BoxFilterProcess(restoration_info, src - 3, stride, top - 3,
-                     top_border_stride, bottom - 3, bottom_border_stride, width,
-                     height, sgr_buffer, dst);
+    BoxFilterProcess<bitdepth>(
+        restoration_info, src - 3, stride, top - 3, top_border_stride,
+        bottom - 3, bottom_border_stride, width, height, sgr_buffer, dst);
   }
 }
 
 void Init10bpp() {
   Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
   assert(dsp != nullptr);
-  dsp->loop_restorations[0] = WienerFilter_NEON;
-  dsp->loop_restorations[1] = SelfGuidedFilter_NEON;
+  dsp->loop_restorations[0] = WienerFilter_NEON<kBitdepth10>;
+  dsp->loop_restorations[1] = SelfGuidedFilter_NEON<kBitdepth10>;
+}
+
+#if LIBGAV1_MAX_BITDEPTH == 12
+void Init12bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth12);
+  assert(dsp != nullptr);
+  dsp->loop_restorations[0] = WienerFilter_NEON<kBitdepth12>;
+  dsp->loop_restorations[1] = SelfGuidedFilter_NEON<kBitdepth12>;
 }
+#endif  // LIBGAV1_MAX_BITDEPTH == 12
 
 }  // namespace
 
-void LoopRestorationInit10bpp_NEON() { Init10bpp(); }
+void LoopRestorationInit10bpp_NEON() {
+  Init10bpp();
+#if LIBGAV1_MAX_BITDEPTH == 12
+  Init12bpp();
+#endif
+}
 
 }  // namespace dsp
 }  // namespace libgav1
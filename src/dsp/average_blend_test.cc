@@ -78,6 +78,9 @@ class AverageBlendTest : public testing::TestWithParam<BlockSize>,
     } else if (absl::StartsWith(test_case, "SSE41/")) {
       if ((GetCpuInfo() & kSSE4_1) == 0) GTEST_SKIP() << "No SSE4.1 support!";
       AverageBlendInit_SSE4_1();
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) == 0) GTEST_SKIP() << "No AVX2 support!";
+      AverageBlendInit_AVX2();
     } else if (absl::StartsWith(test_case, "NEON/")) {
       AverageBlendInit_NEON();
     } else {
@@ -215,6 +218,10 @@ INSTANTIATE_TEST_SUITE_P(C, AverageBlendTest8bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, AverageBlendTest8bpp,
                          testing::ValuesIn(kTestParam));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, AverageBlendTest8bpp,
+                         testing::ValuesIn(kTestParam));
+#endif
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, AverageBlendTest8bpp,
                          testing::ValuesIn(kTestParam));
@@ -276,6 +283,10 @@ INSTANTIATE_TEST_SUITE_P(C, AverageBlendTest10bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, AverageBlendTest10bpp,
                          testing::ValuesIn(kTestParam));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, AverageBlendTest10bpp,
+                         testing::ValuesIn(kTestParam));
+#endif
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, AverageBlendTest10bpp,
                          testing::ValuesIn(kTestParam));
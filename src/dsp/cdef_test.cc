@@ -167,6 +167,14 @@ INSTANTIATE_TEST_SUITE_P(C, CdefDirectionTest10bpp, testing::Values(0));
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, CdefDirectionTest10bpp, testing::Values(0));
 #endif
+
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, CdefDirectionTest10bpp, testing::Values(0));
+#endif
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, CdefDirectionTest10bpp, testing::Values(0));
+#endif  // LIBGAV1_ENABLE_AVX2
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
 
 #if LIBGAV1_MAX_BITDEPTH == 12
@@ -179,6 +187,18 @@ TEST_P(CdefDirectionTest12bpp, DISABLED_Speed) {
 }
 
 INSTANTIATE_TEST_SUITE_P(C, CdefDirectionTest12bpp, testing::Values(0));
+
+#if LIBGAV1_ENABLE_NEON
+INSTANTIATE_TEST_SUITE_P(NEON, CdefDirectionTest12bpp, testing::Values(0));
+#endif
+
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, CdefDirectionTest12bpp, testing::Values(0));
+#endif
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, CdefDirectionTest12bpp, testing::Values(0));
+#endif  // LIBGAV1_ENABLE_AVX2
 #endif  // LIBGAV1_MAX_BITDEPTH == 12
 
 const char* GetDigest8bpp(int id) {
@@ -433,6 +453,16 @@ INSTANTIATE_TEST_SUITE_P(C, CdefFilteringTest10bpp,
 INSTANTIATE_TEST_SUITE_P(NEON, CdefFilteringTest10bpp,
                          testing::ValuesIn(cdef_test_param));
 #endif
+
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, CdefFilteringTest10bpp,
+                         testing::ValuesIn(cdef_test_param));
+#endif
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, CdefFilteringTest10bpp,
+                         testing::ValuesIn(cdef_test_param));
+#endif  // LIBGAV1_ENABLE_AVX2
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
 
 #if LIBGAV1_MAX_BITDEPTH == 12
@@ -446,6 +476,21 @@ TEST_P(CdefFilteringTest12bpp, DISABLED_Speed) {
 
 INSTANTIATE_TEST_SUITE_P(C, CdefFilteringTest12bpp,
                          testing::ValuesIn(cdef_test_param));
+
+#if LIBGAV1_ENABLE_NEON
+INSTANTIATE_TEST_SUITE_P(NEON, CdefFilteringTest12bpp,
+                         testing::ValuesIn(cdef_test_param));
+#endif
+
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, CdefFilteringTest12bpp,
+                         testing::ValuesIn(cdef_test_param));
+#endif
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, CdefFilteringTest12bpp,
+                         testing::ValuesIn(cdef_test_param));
+#endif  // LIBGAV1_ENABLE_AVX2
 #endif  // LIBGAV1_MAX_BITDEPTH == 12
 
 }  // namespace
@@ -629,6 +629,9 @@ class ConvolveTest : public testing::TestWithParam<
     } else if (absl::StartsWith(test_case, "AVX2/")) {
       if ((GetCpuInfo() & kAVX2) == 0) GTEST_SKIP() << "No AVX2 support!";
       ConvolveInit_AVX2();
+    } else if (absl::StartsWith(test_case, "AVX512/")) {
+      if ((GetCpuInfo() & kAVX512) == 0) GTEST_SKIP() << "No AVX512 support!";
+      ConvolveInit_AVX512();
     } else if (absl::StartsWith(test_case, "NEON/")) {
       ConvolveInit_NEON();
 #if LIBGAV1_MAX_BITDEPTH >= 10
@@ -1448,6 +1451,12 @@ INSTANTIATE_TEST_SUITE_P(AVX2, ConvolveScaleTest8bpp,
                                           testing::ValuesIn(kConvolveParam)));
 #endif  // LIBGAV1_ENABLE_AVX2
 
+#if LIBGAV1_ENABLE_AVX512
+INSTANTIATE_TEST_SUITE_P(AVX512, ConvolveTest8bpp,
+                         testing::Combine(testing::ValuesIn(kConvolveTypeParam),
+                                          testing::ValuesIn(kConvolveParam)));
+#endif  // LIBGAV1_ENABLE_AVX512
+
 #if LIBGAV1_MAX_BITDEPTH >= 10
 using ConvolveTest10bpp = ConvolveTest<10, uint16_t>;
 
@@ -1497,6 +1506,21 @@ INSTANTIATE_TEST_SUITE_P(NEON, ConvolveScaleTest10bpp,
                                           testing::ValuesIn(kConvolveParam)));
 #endif  // LIBGAV1_ENABLE_NEON
 
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, ConvolveTest10bpp,
+                         testing::Combine(testing::ValuesIn(kConvolveTypeParam),
+                                          testing::ValuesIn(kConvolveParam)));
+INSTANTIATE_TEST_SUITE_P(SSE41, ConvolveScaleTest10bpp,
+                         testing::Combine(testing::Bool(),
+                                          testing::ValuesIn(kConvolveParam)));
+#endif  // LIBGAV1_ENABLE_SSE4_1
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, ConvolveTest10bpp,
+                         testing::Combine(testing::ValuesIn(kConvolveTypeParam),
+                                          testing::ValuesIn(kConvolveParam)));
+#endif  // LIBGAV1_ENABLE_AVX2
+
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
 
 #if LIBGAV1_MAX_BITDEPTH == 12
@@ -1538,6 +1562,30 @@ INSTANTIATE_TEST_SUITE_P(C, ConvolveTest12bpp,
 INSTANTIATE_TEST_SUITE_P(C, ConvolveScaleTest12bpp,
                          testing::Combine(testing::Bool(),
                                           testing::ValuesIn(kConvolveParam)));
+
+#if LIBGAV1_ENABLE_NEON
+INSTANTIATE_TEST_SUITE_P(NEON, ConvolveTest12bpp,
+                         testing::Combine(testing::ValuesIn(kConvolveTypeParam),
+                                          testing::ValuesIn(kConvolveParam)));
+INSTANTIATE_TEST_SUITE_P(NEON, ConvolveScaleTest12bpp,
+                         testing::Combine(testing::Bool(),
+                                          testing::ValuesIn(kConvolveParam)));
+#endif  // LIBGAV1_ENABLE_NEON
+
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, ConvolveTest12bpp,
+                         testing::Combine(testing::ValuesIn(kConvolveTypeParam),
+                                          testing::ValuesIn(kConvolveParam)));
+INSTANTIATE_TEST_SUITE_P(SSE41, ConvolveScaleTest12bpp,
+                         testing::Combine(testing::Bool(),
+                                          testing::ValuesIn(kConvolveParam)));
+#endif  // LIBGAV1_ENABLE_SSE4_1
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, ConvolveTest12bpp,
+                         testing::Combine(testing::ValuesIn(kConvolveTypeParam),
+                                          testing::ValuesIn(kConvolveParam)));
+#endif  // LIBGAV1_ENABLE_AVX2
 #endif  // LIBGAV1_MAX_BITDEPTH == 12
 
 }  // namespace
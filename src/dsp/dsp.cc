@@ -123,20 +123,35 @@ void DspInit() {
       WarpInit_SSE4_1();
       WeightMaskInit_SSE4_1();
 #if LIBGAV1_MAX_BITDEPTH >= 10
+      InverseTransformInit10bpp_SSE4_1();
       LoopRestorationInit10bpp_SSE4_1();
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
     }
 #endif  // LIBGAV1_ENABLE_SSE4_1
 #if LIBGAV1_ENABLE_AVX2
     if ((cpu_features & kAVX2) != 0) {
+      AverageBlendInit_AVX2();
       CdefInit_AVX2();
       ConvolveInit_AVX2();
+      DistanceWeightedBlendInit_AVX2();
+      FilmGrainInit_AVX2();
+      InverseTransformInit_AVX2();
+      LoopFilterInit_AVX2();
       LoopRestorationInit_AVX2();
+      MaskBlendInit_AVX2();
+      WeightMaskInit_AVX2();
 #if LIBGAV1_MAX_BITDEPTH >= 10
+      InverseTransformInit10bpp_AVX2();
       LoopRestorationInit10bpp_AVX2();
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
     }
 #endif  // LIBGAV1_ENABLE_AVX2
+#if LIBGAV1_ENABLE_AVX512
+    if ((cpu_features & kAVX512) != 0) {
+      ConvolveInit_AVX512();
+      LoopRestorationInit_AVX512();
+    }
+#endif  // LIBGAV1_ENABLE_AVX512
 #endif  // LIBGAV1_ENABLE_SSE4_1 || LIBGAV1_ENABLE_AVX2
 #if LIBGAV1_ENABLE_NEON
     AverageBlendInit_NEON();
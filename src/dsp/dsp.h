@@ -879,6 +879,12 @@ struct Dsp {
   DirectionalIntraPredictorZone2Func directional_intra_predictor_zone2;
   DirectionalIntraPredictorZone3Func directional_intra_predictor_zone3;
   DistanceWeightedBlendFunc distance_weighted_blend;
+  // Apply the same filter to two adjacent edge segments, i.e., 8 pixels along
+  // the edge, sharing one set of thresholds. Equivalent to calling the
+  // corresponding |loop_filters| entry at |dst| and again 4 pixels further
+  // along the edge. There is no C reference implementation, so an entry may be
+  // nullptr, in which case callers fall back to |loop_filters|.
+  LoopFilterFuncs dual_loop_filters;
   FilmGrainFuncs film_grain;
   FilterIntraPredictorFunc filter_intra_predictor;
   InterIntraMaskBlendFuncs8bpp inter_intra_mask_blend_8bpp;
@@ -935,18 +941,33 @@ namespace dsp_internal {
 //  NEON support is the only extension available for ARM and it is always
 //  required. Because of this restriction DSP_ENABLED_8BPP_NEON(func) is always
 //  true and can be omitted.
+#define DSP_ENABLED_8BPP_AVX512(func)  \
+  (LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS || \
+   LIBGAV1_Dsp8bpp_##func == LIBGAV1_CPU_AVX512)
+#define DSP_ENABLED_10BPP_AVX512(func) \
+  (LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS || \
+   LIBGAV1_Dsp10bpp_##func == LIBGAV1_CPU_AVX512)
+#define DSP_ENABLED_12BPP_AVX512(func) \
+  (LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS || \
+   LIBGAV1_Dsp12bpp_##func == LIBGAV1_CPU_AVX512)
 #define DSP_ENABLED_8BPP_AVX2(func)    \
   (LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS || \
    LIBGAV1_Dsp8bpp_##func == LIBGAV1_CPU_AVX2)
 #define DSP_ENABLED_10BPP_AVX2(func)   \
   (LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS || \
    LIBGAV1_Dsp10bpp_##func == LIBGAV1_CPU_AVX2)
+#define DSP_ENABLED_12BPP_AVX2(func)   \
+  (LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS || \
+   LIBGAV1_Dsp12bpp_##func == LIBGAV1_CPU_AVX2)
 #define DSP_ENABLED_8BPP_SSE4_1(func)  \
   (LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS || \
    LIBGAV1_Dsp8bpp_##func == LIBGAV1_CPU_SSE4_1)
 #define DSP_ENABLED_10BPP_SSE4_1(func) \
   (LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS || \
    LIBGAV1_Dsp10bpp_##func == LIBGAV1_CPU_SSE4_1)
+#define DSP_ENABLED_12BPP_SSE4_1(func) \
+  (LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS || \
+   LIBGAV1_Dsp12bpp_##func == LIBGAV1_CPU_SSE4_1)
 
 // Initializes C-only function pointers. Note some entries may be set to
 // nullptr if LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS is not defined. This is meant
@@ -180,9 +180,14 @@ class InverseTransformTest
     const char* const test_case = test_info->test_suite_name();
     if (absl::StartsWith(test_case, "C/")) {
       memset(base_inverse_transforms_, 0, sizeof(base_inverse_transforms_));
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) == 0) GTEST_SKIP() << "No AVX2 support!";
+      InverseTransformInit_AVX2();
+      InverseTransformInit10bpp_AVX2();
     } else if (absl::StartsWith(test_case, "SSE41/")) {
       if ((GetCpuInfo() & kSSE4_1) == 0) GTEST_SKIP() << "No SSE4.1 support!";
       InverseTransformInit_SSE4_1();
+      InverseTransformInit10bpp_SSE4_1();
     } else if (absl::StartsWith(test_case, "NEON/")) {
       InverseTransformInit_NEON();
       InverseTransformInit10bpp_NEON();
@@ -515,6 +520,10 @@ INSTANTIATE_TEST_SUITE_P(NEON, InverseTransformTest8bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, InverseTransformTest8bpp,
                          testing::ValuesIn(kTransformSizesAll));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, InverseTransformTest8bpp,
+                         testing::ValuesIn(kTransformSizesAll));
+#endif
 
 #if LIBGAV1_MAX_BITDEPTH >= 10
 using InverseTransformTest10bpp = InverseTransformTest<10, int32_t, uint16_t>;
@@ -532,6 +541,14 @@ INSTANTIATE_TEST_SUITE_P(C, InverseTransformTest10bpp,
 INSTANTIATE_TEST_SUITE_P(NEON, InverseTransformTest10bpp,
                          testing::ValuesIn(kTransformSizesAll));
 #endif
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, InverseTransformTest10bpp,
+                         testing::ValuesIn(kTransformSizesAll));
+#endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, InverseTransformTest10bpp,
+                         testing::ValuesIn(kTransformSizesAll));
+#endif
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
 
 #if LIBGAV1_MAX_BITDEPTH == 12
@@ -545,6 +562,19 @@ TEST_P(InverseTransformTest12bpp, DcRandom) { TestDcOnlyRandomValue(1); }
 
 INSTANTIATE_TEST_SUITE_P(C, InverseTransformTest12bpp,
                          testing::ValuesIn(kTransformSizesAll));
+
+#if LIBGAV1_ENABLE_NEON
+INSTANTIATE_TEST_SUITE_P(NEON, InverseTransformTest12bpp,
+                         testing::ValuesIn(kTransformSizesAll));
+#endif
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, InverseTransformTest12bpp,
+                         testing::ValuesIn(kTransformSizesAll));
+#endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, InverseTransformTest12bpp,
+                         testing::ValuesIn(kTransformSizesAll));
+#endif
 #endif  // LIBGAV1_MAX_BITDEPTH == 12
 
 }  // namespace
@@ -15,6 +15,7 @@
 #include "src/dsp/loop_filter.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
@@ -225,6 +226,125 @@ void LoopFilterTest<bitdepth, Pixel>::TestSaturatedValues() const {
   }
 }
 
+//------------------------------------------------------------------------------
+// Dsp::dual_loop_filters have no C implementation. They are compared against
+// applying the C Dsp::loop_filters to each of the two segments.
+
+template <int bitdepth, typename Pixel>
+class DualLoopFilterTest : public testing::TestWithParam<LoopFilterSize> {
+ public:
+  static_assert(bitdepth >= kBitdepth8 && bitdepth <= LIBGAV1_MAX_BITDEPTH, "");
+  DualLoopFilterTest() = default;
+  DualLoopFilterTest(const DualLoopFilterTest&) = delete;
+  DualLoopFilterTest& operator=(const DualLoopFilterTest&) = delete;
+  ~DualLoopFilterTest() override = default;
+
+ protected:
+  void SetUp() override {
+    test_utils::ResetDspTable(bitdepth);
+    LoopFilterInit_C();
+
+    const Dsp* const dsp = GetDspTable(bitdepth);
+    ASSERT_NE(dsp, nullptr);
+    memcpy(base_loop_filters_, dsp->loop_filters[size_],
+           sizeof(base_loop_filters_));
+
+    const testing::TestInfo* const test_info =
+        testing::UnitTest::GetInstance()->current_test_info();
+    const char* const test_case = test_info->test_suite_name();
+    if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) == 0) GTEST_SKIP() << "No AVX2 support!";
+      LoopFilterInit_AVX2();
+    } else {
+      FAIL() << "Unrecognized architecture prefix in test case name: "
+             << test_case;
+    }
+
+    memcpy(dual_loop_filters_, dsp->dual_loop_filters[size_],
+           sizeof(dual_loop_filters_));
+  }
+
+  // Prints the filter timing if |print_timing| is true.
+  void TestRandomValues(int num_runs, bool print_timing) const;
+  void TestSaturatedValues() const;
+
+  const LoopFilterSize size_ = GetParam();
+  LoopFilterFunc base_loop_filters_[kNumLoopFilterTypes];
+  LoopFilterFunc dual_loop_filters_[kNumLoopFilterTypes];
+};
+
+template <int bitdepth, typename Pixel>
+void DualLoopFilterTest<bitdepth, Pixel>::TestRandomValues(
+    const int num_runs, const bool print_timing) const {
+  constexpr ptrdiff_t kStride = kBlockStride * sizeof(Pixel);
+  constexpr int kOffset = 8 + kBlockStride * 8;
+  for (int i = 0; i < kNumLoopFilterTypes; ++i) {
+    libvpx_test::ACMRandom rnd(libvpx_test::ACMRandom::DeterministicSeed());
+    ASSERT_NE(dual_loop_filters_[i], nullptr);
+    // The second segment starts 4 pixels further along the edge.
+    const int segment_offset =
+        (i == kLoopFilterTypeVertical) ? 4 * kBlockStride : 4;
+
+    absl::Duration elapsed_time;
+    for (int n = 0; n < num_runs; ++n) {
+      Pixel dst[kNumPixels];
+      Pixel ref[kNumPixels];
+      const auto outer_thresh = static_cast<uint8_t>(
+          rnd(3 * kMaxLoopFilterValue - 2) + 7);  // [7, 193].
+      const auto inner_thresh =
+          static_cast<uint8_t>(rnd(kMaxLoopFilterValue) + 1);  // [1, 63].
+      const auto hev_thresh =
+          static_cast<uint8_t>(rnd(kMaxLoopFilterValue + 1) >> 4);  // [0, 3].
+      InitInput(dst, kBlockStride, bitdepth, rnd, inner_thresh, (n & 1) == 0);
+      memcpy(ref, dst, sizeof(dst));
+
+      base_loop_filters_[i](ref + kOffset, kStride, outer_thresh, inner_thresh,
+                            hev_thresh);
+      base_loop_filters_[i](ref + kOffset + segment_offset, kStride,
+                            outer_thresh, inner_thresh, hev_thresh);
+      const absl::Time start = absl::Now();
+      dual_loop_filters_[i](dst + kOffset, kStride, outer_thresh, inner_thresh,
+                            hev_thresh);
+      elapsed_time += absl::Now() - start;
+
+      ASSERT_TRUE(test_utils::CompareBlocks(ref, dst, kBlockStride,
+                                            kBlockStride, kBlockStride,
+                                            kBlockStride, true))
+          << ToString(static_cast<LoopFilterType>(i))
+          << " output doesn't match reference, run " << n;
+    }
+    if (print_timing) {
+      const auto elapsed_time_us =
+          static_cast<int>(absl::ToInt64Microseconds(elapsed_time));
+      printf("Mode %s[%25s]: %5d us\n",
+             ToString(static_cast<LoopFilterSize>(size_)),
+             ToString(static_cast<LoopFilterType>(i)), elapsed_time_us);
+    }
+  }
+}
+
+template <int bitdepth, typename Pixel>
+void DualLoopFilterTest<bitdepth, Pixel>::TestSaturatedValues() const {
+  Pixel dst[kNumPixels], ref[kNumPixels];
+  const auto value = static_cast<Pixel>((1 << bitdepth) - 1);
+  for (auto& r : dst) r = value;
+  memcpy(ref, dst, sizeof(dst));
+
+  for (int i = 0; i < kNumLoopFilterTypes; ++i) {
+    ASSERT_NE(dual_loop_filters_[i], nullptr);
+    const int outer_thresh = 24;
+    const int inner_thresh = 8;
+    const int hev_thresh = 0;
+    dual_loop_filters_[i](dst + 8 + kBlockStride * 8,
+                          kBlockStride * sizeof(Pixel), outer_thresh,
+                          inner_thresh, hev_thresh);
+    ASSERT_TRUE(test_utils::CompareBlocks(ref, dst, kBlockStride, kBlockStride,
+                                          kBlockStride, kBlockStride, true))
+        << ToString(static_cast<LoopFilterType>(i))
+        << " output doesn't match reference";
+  }
+}
+
 //------------------------------------------------------------------------------
 
 using LoopFilterTest8bpp = LoopFilterTest<8, uint8_t>;
@@ -286,6 +406,26 @@ INSTANTIATE_TEST_SUITE_P(SSE41, LoopFilterTest8bpp,
 INSTANTIATE_TEST_SUITE_P(NEON, LoopFilterTest8bpp,
                          testing::ValuesIn(kLoopFilterSizes));
 #endif
+
+using DualLoopFilterTest8bpp = DualLoopFilterTest<8, uint8_t>;
+
+TEST_P(DualLoopFilterTest8bpp, DISABLED_Speed) {
+  TestRandomValues(kNumSpeedTests, /*print_timing=*/true);
+}
+
+TEST_P(DualLoopFilterTest8bpp, RandomValues) {
+  TestRandomValues(kNumTests, /*print_timing=*/false);
+}
+
+TEST_P(DualLoopFilterTest8bpp, SaturatedValues) { TestSaturatedValues(); }
+
+// There is no C implementation; targets without AVX2 have no instantiation.
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(DualLoopFilterTest8bpp);
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, DualLoopFilterTest8bpp,
+                         testing::ValuesIn(kLoopFilterSizes));
+#endif
 //------------------------------------------------------------------------------
 
 #if LIBGAV1_MAX_BITDEPTH >= 10
@@ -345,6 +485,26 @@ INSTANTIATE_TEST_SUITE_P(SSE41, LoopFilterTest10bpp,
 INSTANTIATE_TEST_SUITE_P(NEON, LoopFilterTest10bpp,
                          testing::ValuesIn(kLoopFilterSizes));
 #endif
+
+using DualLoopFilterTest10bpp = DualLoopFilterTest<10, uint16_t>;
+
+TEST_P(DualLoopFilterTest10bpp, DISABLED_Speed) {
+  TestRandomValues(kNumSpeedTests, /*print_timing=*/true);
+}
+
+TEST_P(DualLoopFilterTest10bpp, RandomValues) {
+  TestRandomValues(kNumTests, /*print_timing=*/false);
+}
+
+TEST_P(DualLoopFilterTest10bpp, SaturatedValues) { TestSaturatedValues(); }
+
+// There is no C implementation; targets without AVX2 have no instantiation.
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(DualLoopFilterTest10bpp);
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, DualLoopFilterTest10bpp,
+                         testing::ValuesIn(kLoopFilterSizes));
+#endif
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
 
 //------------------------------------------------------------------------------
@@ -397,6 +557,35 @@ TEST_P(LoopFilterTest12bpp, SaturatedValues) { TestSaturatedValues(); }
 
 INSTANTIATE_TEST_SUITE_P(C, LoopFilterTest12bpp,
                          testing::ValuesIn(kLoopFilterSizes));
+
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, LoopFilterTest12bpp,
+                         testing::ValuesIn(kLoopFilterSizes));
+#endif
+#if LIBGAV1_ENABLE_NEON
+INSTANTIATE_TEST_SUITE_P(NEON, LoopFilterTest12bpp,
+                         testing::ValuesIn(kLoopFilterSizes));
+#endif
+
+using DualLoopFilterTest12bpp = DualLoopFilterTest<12, uint16_t>;
+
+TEST_P(DualLoopFilterTest12bpp, DISABLED_Speed) {
+  TestRandomValues(kNumSpeedTests, /*print_timing=*/true);
+}
+
+TEST_P(DualLoopFilterTest12bpp, RandomValues) {
+  TestRandomValues(kNumTests, /*print_timing=*/false);
+}
+
+TEST_P(DualLoopFilterTest12bpp, SaturatedValues) { TestSaturatedValues(); }
+
+// There is no C implementation; targets without AVX2 have no instantiation.
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(DualLoopFilterTest12bpp);
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, DualLoopFilterTest12bpp,
+                         testing::ValuesIn(kLoopFilterSizes));
+#endif
 #endif  // LIBGAV1_MAX_BITDEPTH == 12
 
 }  // namespace
@@ -356,6 +356,19 @@ TEST_P(SelfGuidedFilterTest12bpp, DISABLED_Speed) { TestRandomValues(true); }
 
 INSTANTIATE_TEST_SUITE_P(C, SelfGuidedFilterTest12bpp,
                          testing::ValuesIn(kUnitWidths));
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, SelfGuidedFilterTest12bpp,
+                         testing::ValuesIn(kUnitWidths));
+#endif
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, SelfGuidedFilterTest12bpp,
+                         testing::ValuesIn(kUnitWidths));
+#endif
+#if LIBGAV1_ENABLE_NEON
+INSTANTIATE_TEST_SUITE_P(NEON, SelfGuidedFilterTest12bpp,
+                         testing::ValuesIn(kUnitWidths));
+#endif
 #endif  // LIBGAV1_MAX_BITDEPTH == 12
 
 template <int bitdepth, typename Pixel>
@@ -384,6 +397,9 @@ class WienerFilterTest : public testing::TestWithParam<int>,
 #if LIBGAV1_MAX_BITDEPTH >= 10
       LoopRestorationInit10bpp_AVX2();
 #endif
+    } else if (absl::StartsWith(test_case, "AVX512/")) {
+      if ((GetCpuInfo() & kAVX512) == 0) GTEST_SKIP() << "No AVX512 support!";
+      LoopRestorationInit_AVX512();
     } else if (absl::StartsWith(test_case, "SSE41/")) {
       if ((GetCpuInfo() & kSSE4_1) == 0) GTEST_SKIP() << "No SSE4.1 support!";
       LoopRestorationInit_SSE4_1();
@@ -637,6 +653,10 @@ INSTANTIATE_TEST_SUITE_P(C, WienerFilterTest8bpp,
 INSTANTIATE_TEST_SUITE_P(AVX2, WienerFilterTest8bpp,
                          testing::ValuesIn(kUnitWidths));
 #endif
+#if LIBGAV1_ENABLE_AVX512
+INSTANTIATE_TEST_SUITE_P(AVX512, WienerFilterTest8bpp,
+                         testing::ValuesIn(kUnitWidths));
+#endif
 #if LIBGAV1_ENABLE_SSE4_1
 INSTANTIATE_TEST_SUITE_P(SSE41, WienerFilterTest8bpp,
                          testing::ValuesIn(kUnitWidths));
@@ -695,6 +715,19 @@ TEST_P(WienerFilterTest12bpp, TestCompare2C) { TestCompare2C(); }
 
 INSTANTIATE_TEST_SUITE_P(C, WienerFilterTest12bpp,
                          testing::ValuesIn(kUnitWidths));
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, WienerFilterTest12bpp,
+                         testing::ValuesIn(kUnitWidths));
+#endif
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, WienerFilterTest12bpp,
+                         testing::ValuesIn(kUnitWidths));
+#endif
+#if LIBGAV1_ENABLE_NEON
+INSTANTIATE_TEST_SUITE_P(NEON, WienerFilterTest12bpp,
+                         testing::ValuesIn(kUnitWidths));
+#endif
 #endif  // LIBGAV1_MAX_BITDEPTH == 12
 
 }  // namespace
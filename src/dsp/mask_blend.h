@@ -30,6 +30,8 @@
 // The order of includes is important as each tests for a superior version
 // before setting the base.
 // clang-format off
+// AVX2
+#include "src/dsp/x86/mask_blend_avx2.h"
 // SSE4_1
 #include "src/dsp/x86/mask_blend_sse4.h"
 // clang-format on
@@ -225,6 +225,9 @@ class WeightMaskTest : public testing::TestWithParam<WeightMaskTestParam>,
     } else if (absl::StartsWith(test_case, "SSE41/")) {
       if ((GetCpuInfo() & kSSE4_1) == 0) GTEST_SKIP() << "No SSE4.1 support!";
       WeightMaskInit_SSE4_1();
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) == 0) GTEST_SKIP() << "No AVX2 support!";
+      WeightMaskInit_AVX2();
     }
     func_ = dsp->weight_mask[width_index][height_index][mask_is_inverse_];
   }
@@ -410,6 +413,10 @@ INSTANTIATE_TEST_SUITE_P(NEON, WeightMaskTest8bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, WeightMaskTest8bpp,
                          testing::ValuesIn(weight_mask_test_param));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, WeightMaskTest8bpp,
+                         testing::ValuesIn(weight_mask_test_param));
+#endif
 
 #if LIBGAV1_MAX_BITDEPTH >= 10
 using WeightMaskTest10bpp = WeightMaskTest<10>;
@@ -439,6 +446,10 @@ INSTANTIATE_TEST_SUITE_P(NEON, WeightMaskTest10bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, WeightMaskTest10bpp,
                          testing::ValuesIn(weight_mask_test_param));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, WeightMaskTest10bpp,
+                         testing::ValuesIn(weight_mask_test_param));
+#endif
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
 
 #if LIBGAV1_MAX_BITDEPTH == 12
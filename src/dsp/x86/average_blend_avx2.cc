@@ -0,0 +1,290 @@
+// Copyright 2023 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "src/dsp/average_blend.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace low_bitdepth {
+namespace {
+
+constexpr int kInterPostRoundBit = 4;
+
+// Blends 16 predictions. |prediction_0| and |prediction_1| are contiguous
+// with a stride of |width|, so narrow blocks cover several rows here.
+inline __m256i AverageBlend16(const int16_t* LIBGAV1_RESTRICT prediction_0,
+                              const int16_t* LIBGAV1_RESTRICT prediction_1) {
+  const __m256i pred_0 = LoadUnaligned32(prediction_0);
+  const __m256i pred_1 = LoadUnaligned32(prediction_1);
+  const __m256i sum = _mm256_add_epi16(pred_0, pred_1);
+  return RightShiftWithRounding_S16(sum, kInterPostRoundBit + 1);
+}
+
+// Blends 32 predictions and packs them into 32 pixels in order.
+inline __m256i AverageBlend32(const int16_t* LIBGAV1_RESTRICT prediction_0,
+                              const int16_t* LIBGAV1_RESTRICT prediction_1) {
+  const __m256i res_0 = AverageBlend16(prediction_0, prediction_1);
+  const __m256i res_1 = AverageBlend16(prediction_0 + 16, prediction_1 + 16);
+  // packus works within 128-bit lanes; restore the row order.
+  return _mm256_permute4x64_epi64(_mm256_packus_epi16(res_0, res_1), 0xd8);
+}
+
+void AverageBlend_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                       const void* LIBGAV1_RESTRICT prediction_1,
+                       const int width, const int height,
+                       void* LIBGAV1_RESTRICT const dest,
+                       const ptrdiff_t dest_stride) {
+  auto* dst = static_cast<uint8_t*>(dest);
+  const auto* pred_0 = static_cast<const int16_t*>(prediction_0);
+  const auto* pred_1 = static_cast<const int16_t*>(prediction_1);
+  int y = height;
+
+  if (width == 4) {
+    do {
+      const __m256i res = AverageBlend16(pred_0, pred_1);
+      const __m128i result_pixels = _mm_packus_epi16(
+          _mm256_castsi256_si128(res), _mm256_extracti128_si256(res, 1));
+      Store4(dst, result_pixels);
+      dst += dest_stride;
+      const int result_1 = _mm_extract_epi32(result_pixels, 1);
+      memcpy(dst, &result_1, sizeof(result_1));
+      dst += dest_stride;
+      const int result_2 = _mm_extract_epi32(result_pixels, 2);
+      memcpy(dst, &result_2, sizeof(result_2));
+      dst += dest_stride;
+      const int result_3 = _mm_extract_epi32(result_pixels, 3);
+      memcpy(dst, &result_3, sizeof(result_3));
+      dst += dest_stride;
+      pred_0 += 16;
+      pred_1 += 16;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 8) {
+    do {
+      const __m256i res = AverageBlend32(pred_0, pred_1);
+      const __m128i res_lo = _mm256_castsi256_si128(res);
+      const __m128i res_hi = _mm256_extracti128_si256(res, 1);
+      StoreLo8(dst, res_lo);
+      StoreHi8(dst + dest_stride, res_lo);
+      StoreLo8(dst + 2 * dest_stride, res_hi);
+      StoreHi8(dst + 3 * dest_stride, res_hi);
+      dst += dest_stride << 2;
+      pred_0 += 32;
+      pred_1 += 32;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 16) {
+    do {
+      const __m256i res = AverageBlend32(pred_0, pred_1);
+      StoreUnaligned16(dst, _mm256_castsi256_si128(res));
+      StoreUnaligned16(dst + dest_stride, _mm256_extracti128_si256(res, 1));
+      dst += dest_stride << 1;
+      pred_0 += 32;
+      pred_1 += 32;
+      y -= 2;
+    } while (y != 0);
+    return;
+  }
+
+  do {
+    int x = 0;
+    do {
+      StoreUnaligned32(dst + x, AverageBlend32(pred_0 + x, pred_1 + x));
+      x += 32;
+    } while (x < width);
+    dst += dest_stride;
+    pred_0 += width;
+    pred_1 += width;
+  } while (--y != 0);
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX2(AverageBlend)
+  dsp->average_blend = AverageBlend_AVX2;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+constexpr int kInterPostRoundBitPlusOne = 5;
+
+// Blends 16 predictions. The predictions use the full 16-bit range, so they
+// are biased into the signed range and summed in pairs with madd; the bias
+// is folded into |offset|.
+inline __m256i AverageBlend16(const uint16_t* LIBGAV1_RESTRICT prediction_0,
+                              const uint16_t* LIBGAV1_RESTRICT prediction_1,
+                              const __m256i& sign_bias, const __m256i& ones,
+                              const __m256i& offset, const __m256i& max) {
+  const __m256i pred_0 =
+      _mm256_xor_si256(LoadUnaligned32(prediction_0), sign_bias);
+  const __m256i pred_1 =
+      _mm256_xor_si256(LoadUnaligned32(prediction_1), sign_bias);
+  const __m256i sum_lo =
+      _mm256_madd_epi16(_mm256_unpacklo_epi16(pred_0, pred_1), ones);
+  const __m256i sum_hi =
+      _mm256_madd_epi16(_mm256_unpackhi_epi16(pred_0, pred_1), ones);
+  const __m256i res_lo = _mm256_srai_epi32(_mm256_add_epi32(sum_lo, offset),
+                                           kInterPostRoundBitPlusOne);
+  const __m256i res_hi = _mm256_srai_epi32(_mm256_add_epi32(sum_hi, offset),
+                                           kInterPostRoundBitPlusOne);
+  return _mm256_min_epu16(_mm256_packus_epi32(res_lo, res_hi), max);
+}
+
+void AverageBlend10bpp_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                            const void* LIBGAV1_RESTRICT prediction_1,
+                            const int width, const int height,
+                            void* LIBGAV1_RESTRICT const dest,
+                            const ptrdiff_t dst_stride) {
+  auto* dst = static_cast<uint16_t*>(dest);
+  const ptrdiff_t dest_stride = dst_stride / sizeof(dst[0]);
+  const auto* pred_0 = static_cast<const uint16_t*>(prediction_0);
+  const auto* pred_1 = static_cast<const uint16_t*>(prediction_1);
+  const __m256i sign_bias = _mm256_set1_epi16(static_cast<int16_t>(0x8000));
+  const __m256i ones = _mm256_set1_epi16(1);
+  // (p0 - 32768) + (p1 - 32768) is produced by madd.
+  const __m256i offset =
+      _mm256_set1_epi32(65536 - 2 * kCompoundOffset +
+                        ((1 << kInterPostRoundBitPlusOne) >> 1));
+  const __m256i max = _mm256_set1_epi16((1 << kBitdepth10) - 1);
+  int y = height;
+
+  if (width == 4) {
+    do {
+      const __m256i res =
+          AverageBlend16(pred_0, pred_1, sign_bias, ones, offset, max);
+      const __m128i res_lo = _mm256_castsi256_si128(res);
+      const __m128i res_hi = _mm256_extracti128_si256(res, 1);
+      StoreLo8(dst, res_lo);
+      StoreHi8(dst + dest_stride, res_lo);
+      StoreLo8(dst + 2 * dest_stride, res_hi);
+      StoreHi8(dst + 3 * dest_stride, res_hi);
+      dst += dest_stride << 2;
+      pred_0 += 16;
+      pred_1 += 16;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 8) {
+    do {
+      const __m256i res_0 =
+          AverageBlend16(pred_0, pred_1, sign_bias, ones, offset, max);
+      const __m256i res_1 = AverageBlend16(pred_0 + 16, pred_1 + 16,
+                                           sign_bias, ones, offset, max);
+      StoreUnaligned16(dst, _mm256_castsi256_si128(res_0));
+      StoreUnaligned16(dst + dest_stride, _mm256_extracti128_si256(res_0, 1));
+      StoreUnaligned16(dst + 2 * dest_stride, _mm256_castsi256_si128(res_1));
+      StoreUnaligned16(dst + 3 * dest_stride,
+                       _mm256_extracti128_si256(res_1, 1));
+      dst += dest_stride << 2;
+      pred_0 += 32;
+      pred_1 += 32;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 16) {
+    do {
+      StoreUnaligned32(
+          dst, AverageBlend16(pred_0, pred_1, sign_bias, ones, offset, max));
+      StoreUnaligned32(dst + dest_stride,
+                       AverageBlend16(pred_0 + 16, pred_1 + 16, sign_bias,
+                                      ones, offset, max));
+      dst += dest_stride << 1;
+      pred_0 += 32;
+      pred_1 += 32;
+      y -= 2;
+    } while (y != 0);
+    return;
+  }
+
+  do {
+    int x = 0;
+    do {
+      StoreUnaligned32(dst + x, AverageBlend16(pred_0 + x, pred_1 + x,
+                                               sign_bias, ones, offset, max));
+      StoreUnaligned32(dst + x + 16,
+                       AverageBlend16(pred_0 + x + 16, pred_1 + x + 16,
+                                      sign_bias, ones, offset, max));
+      x += 32;
+    } while (x < width);
+    dst += dest_stride;
+    pred_0 += width;
+    pred_1 += width;
+  } while (--y != 0);
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_AVX2(AverageBlend)
+  dsp->average_blend = AverageBlend10bpp_AVX2;
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void AverageBlendInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX2
+
+namespace libgav1 {
+namespace dsp {
+
+void AverageBlendInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
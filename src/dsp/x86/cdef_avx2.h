@@ -40,6 +40,22 @@ void CdefInit_AVX2();
 #define LIBGAV1_Dsp8bpp_CdefFilters LIBGAV1_CPU_AVX2
 #endif
 
+#ifndef LIBGAV1_Dsp10bpp_CdefDirection
+#define LIBGAV1_Dsp10bpp_CdefDirection LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_CdefFilters
+#define LIBGAV1_Dsp10bpp_CdefFilters LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_CdefDirection
+#define LIBGAV1_Dsp12bpp_CdefDirection LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_CdefFilters
+#define LIBGAV1_Dsp12bpp_CdefFilters LIBGAV1_CPU_AVX2
+#endif
+
 #endif  // LIBGAV1_TARGETING_AVX2
 
 #endif  // LIBGAV1_SRC_DSP_X86_CDEF_AVX2_H_
@@ -25,6 +25,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <type_traits>
 
 #include "src/dsp/constants.h"
 #include "src/dsp/dsp.h"
@@ -35,7 +36,6 @@
 
 namespace libgav1 {
 namespace dsp {
-namespace low_bitdepth {
 namespace {
 
 #include "src/dsp/cdef.inc"
@@ -241,9 +241,12 @@ LIBGAV1_ALWAYS_INLINE void AddPartial_D5_D7(__m128i* v_src, __m128i* partial_lo,
   *partial_hi = _mm_add_epi16(*partial_hi, _mm_srli_si128(v_pair_add[3], 10));
 }
 
-LIBGAV1_ALWAYS_INLINE void AddPartial(const uint8_t* LIBGAV1_RESTRICT src,
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE void AddPartial(const void* LIBGAV1_RESTRICT const source,
                                       ptrdiff_t stride, __m128i* partial_lo,
                                       __m128i* partial_hi) {
+  const auto* src = static_cast<const uint8_t*>(source);
+
   // 8x8 input
   // 00 01 02 03 04 05 06 07
   // 10 11 12 13 14 15 16 17
@@ -254,9 +257,20 @@ LIBGAV1_ALWAYS_INLINE void AddPartial(const uint8_t* LIBGAV1_RESTRICT src,
   // 60 61 62 63 64 65 66 67
   // 70 71 72 73 74 75 76 77
   __m128i v_src[8];
-  for (auto& i : v_src) {
-    i = LoadLo8(src);
-    src += stride;
+  if (bitdepth == kBitdepth8) {
+    for (auto& i : v_src) {
+      i = LoadLo8(src);
+      src += stride;
+    }
+  } else {
+    // bitdepth - 8
+    constexpr int src_shift = (bitdepth == kBitdepth10) ? 2 : 4;
+    const __m128i v_zero = _mm_setzero_si128();
+    for (auto& i : v_src) {
+      i = _mm_packus_epi16(_mm_srli_epi16(LoadUnaligned16(src), src_shift),
+                           v_zero);
+      src += stride;
+    }
   }
 
   const __m128i v_zero = _mm_setzero_si128();
@@ -395,17 +409,17 @@ inline uint32_t SquareSum_S16(const __m128i a) {
   return SumVector_S32(square);
 }
 
+template <int bitdepth>
 void CdefDirection_SSE4_1(const void* LIBGAV1_RESTRICT const source,
                           ptrdiff_t stride,
                           uint8_t* LIBGAV1_RESTRICT const direction,
                           int* LIBGAV1_RESTRICT const variance) {
   assert(direction != nullptr);
   assert(variance != nullptr);
-  const auto* src = static_cast<const uint8_t*>(source);
   uint32_t cost[8];
   __m128i partial_lo[8], partial_hi[8];
 
-  AddPartial(src, stride, partial_lo, partial_hi);
+  AddPartial<bitdepth>(source, stride, partial_lo, partial_hi);
 
   cost[2] = kCdefDivisionTable[7] * SquareSum_S16(partial_lo[2]);
   cost[6] = kCdefDivisionTable[7] * SquareSum_S16(partial_lo[6]);
@@ -510,7 +524,71 @@ inline __m128i ApplyConstrainAndTap(const __m128i& pixel, const __m128i& val,
   return _mm_mullo_epi16(constrained, tap);
 }
 
-template <int width, bool enable_primary = true, bool enable_secondary = true>
+template <typename Pixel>
+__m128i GetMaxPrimary(const __m128i* primary_val, __m128i max,
+                      const __m128i cdef_large_value_mask) {
+  if (sizeof(Pixel) == 1) {
+    // The source is 16 bits, however, we only really care about the lower
+    // 8 bits.  The upper 8 bits contain the "large" flag.  After the final
+    // primary max has been calculated, zero out the upper 8 bits.  Use this
+    // to find the "16 bit" max.
+    const __m128i max_p01 = _mm_max_epu8(primary_val[0], primary_val[1]);
+    const __m128i max_p23 = _mm_max_epu8(primary_val[2], primary_val[3]);
+    const __m128i max_p = _mm_max_epu8(max_p01, max_p23);
+    max = _mm_max_epu16(max, _mm_and_si128(max_p, cdef_large_value_mask));
+  } else {
+    // Convert kCdefLargeValue to 0 before calculating max.
+    for (int i = 0; i < 4; ++i) {
+      max = _mm_max_epu16(max,
+                          _mm_and_si128(primary_val[i], cdef_large_value_mask));
+    }
+  }
+  return max;
+}
+
+template <typename Pixel>
+__m128i GetMaxSecondary(const __m128i* secondary_val, __m128i max,
+                        const __m128i cdef_large_value_mask) {
+  if (sizeof(Pixel) == 1) {
+    const __m128i max_s01 = _mm_max_epu8(secondary_val[0], secondary_val[1]);
+    const __m128i max_s23 = _mm_max_epu8(secondary_val[2], secondary_val[3]);
+    const __m128i max_s45 = _mm_max_epu8(secondary_val[4], secondary_val[5]);
+    const __m128i max_s67 = _mm_max_epu8(secondary_val[6], secondary_val[7]);
+    const __m128i max_s = _mm_max_epu8(_mm_max_epu8(max_s01, max_s23),
+                                       _mm_max_epu8(max_s45, max_s67));
+    max = _mm_max_epu16(max, _mm_and_si128(max_s, cdef_large_value_mask));
+  } else {
+    for (int i = 0; i < 8; ++i) {
+      max = _mm_max_epu16(
+          max, _mm_and_si128(secondary_val[i], cdef_large_value_mask));
+    }
+  }
+  return max;
+}
+
+template <typename Pixel, int width>
+void StorePixels(void* dest, ptrdiff_t dst_stride, __m128i result) {
+  auto* const dst8 = static_cast<uint8_t*>(dest);
+  if (sizeof(Pixel) == 1) {
+    const __m128i dst_pixel = _mm_packus_epi16(result, result);
+    if (width == 8) {
+      StoreLo8(dst8, dst_pixel);
+    } else {
+      Store4(dst8, dst_pixel);
+      Store4(dst8 + dst_stride, _mm_srli_si128(dst_pixel, 4));
+    }
+  } else {
+    if (width == 8) {
+      StoreUnaligned16(dst8, result);
+    } else {
+      StoreLo8(dst8, result);
+      StoreHi8(dst8 + dst_stride, result);
+    }
+  }
+}
+
+template <int width, int bitdepth, bool enable_primary = true,
+          bool enable_secondary = true>
 void CdefFilter_SSE4_1(const uint16_t* LIBGAV1_RESTRICT src,
                        const ptrdiff_t src_stride, const int height,
                        const int primary_strength, const int secondary_strength,
@@ -519,30 +597,45 @@ void CdefFilter_SSE4_1(const uint16_t* LIBGAV1_RESTRICT src,
                        const ptrdiff_t dst_stride) {
   static_assert(width == 8 || width == 4, "Invalid CDEF width.");
   static_assert(enable_primary || enable_secondary, "");
+  using Pixel =
+      typename std::conditional<bitdepth == 8, uint8_t, uint16_t>::type;
   constexpr bool clipping_required = enable_primary && enable_secondary;
   auto* dst = static_cast<uint8_t*>(dest);
   __m128i primary_damping_shift, secondary_damping_shift;
 
   // FloorLog2() requires input to be > 0.
   // 8-bit damping range: Y: [3, 6], UV: [2, 5].
+  // 10-bit damping range: Y: [3, 6 + 2], UV: [2, 5 + 2].
+  // 12-bit damping range: Y: [3, 6 + 4], UV: [2, 5 + 4].
   if (enable_primary) {
-    // primary_strength: [0, 15] -> FloorLog2: [0, 3] so a clamp is necessary
-    // for UV filtering.
+    // 8-bit primary_strength: [0, 15] -> FloorLog2: [0, 3] so a clamp is
+    // necessary for UV filtering.
+    // 10-bit primary_strength: [0, 15 << 2].
+    // 12-bit primary_strength: [0, 15 << 4].
     primary_damping_shift =
         _mm_cvtsi32_si128(std::max(0, damping - FloorLog2(primary_strength)));
   }
   if (enable_secondary) {
-    // secondary_strength: [0, 4] -> FloorLog2: [0, 2] so no clamp to 0 is
-    // necessary.
-    assert(damping - FloorLog2(secondary_strength) >= 0);
-    secondary_damping_shift =
-        _mm_cvtsi32_si128(damping - FloorLog2(secondary_strength));
+    if (sizeof(Pixel) == 1) {
+      // secondary_strength: [0, 4] -> FloorLog2: [0, 2] so no clamp to 0 is
+      // necessary.
+      assert(damping - FloorLog2(secondary_strength) >= 0);
+      secondary_damping_shift =
+          _mm_cvtsi32_si128(damping - FloorLog2(secondary_strength));
+    } else {
+      // 10-bit secondary_strength: [0, 4 << 2].
+      // 12-bit secondary_strength: [0, 4 << 4].
+      secondary_damping_shift = _mm_cvtsi32_si128(
+          std::max(0, damping - FloorLog2(secondary_strength)));
+    }
   }
 
+  constexpr int coeff_shift = bitdepth - 8;
+  const int primary_tap_index = (primary_strength >> coeff_shift) & 1;
   const __m128i primary_tap_0 =
-      _mm_set1_epi16(kCdefPrimaryTaps[primary_strength & 1][0]);
+      _mm_set1_epi16(kCdefPrimaryTaps[primary_tap_index][0]);
   const __m128i primary_tap_1 =
-      _mm_set1_epi16(kCdefPrimaryTaps[primary_strength & 1][1]);
+      _mm_set1_epi16(kCdefPrimaryTaps[primary_tap_index][1]);
   const __m128i secondary_tap_0 = _mm_set1_epi16(kCdefSecondaryTap0);
   const __m128i secondary_tap_1 = _mm_set1_epi16(kCdefSecondaryTap1);
   const __m128i cdef_large_value_mask =
@@ -578,14 +671,7 @@ void CdefFilter_SSE4_1(const uint16_t* LIBGAV1_RESTRICT src,
         min = _mm_min_epu16(min, primary_val[2]);
         min = _mm_min_epu16(min, primary_val[3]);
 
-        // The source is 16 bits, however, we only really care about the lower
-        // 8 bits.  The upper 8 bits contain the "large" flag.  After the final
-        // primary max has been calculated, zero out the upper 8 bits.  Use this
-        // to find the "16 bit" max.
-        const __m128i max_p01 = _mm_max_epu8(primary_val[0], primary_val[1]);
-        const __m128i max_p23 = _mm_max_epu8(primary_val[2], primary_val[3]);
-        const __m128i max_p = _mm_max_epu8(max_p01, max_p23);
-        max = _mm_max_epu16(max, _mm_and_si128(max_p, cdef_large_value_mask));
+        max = GetMaxPrimary<Pixel>(primary_val, max, cdef_large_value_mask);
       }
 
       sum = ApplyConstrainAndTap(pixel, primary_val[0], primary_tap_0,
@@ -624,17 +710,7 @@ void CdefFilter_SSE4_1(const uint16_t* LIBGAV1_RESTRICT src,
         min = _mm_min_epu16(min, secondary_val[6]);
         min = _mm_min_epu16(min, secondary_val[7]);
 
-        const __m128i max_s01 =
-            _mm_max_epu8(secondary_val[0], secondary_val[1]);
-        const __m128i max_s23 =
-            _mm_max_epu8(secondary_val[2], secondary_val[3]);
-        const __m128i max_s45 =
-            _mm_max_epu8(secondary_val[4], secondary_val[5]);
-        const __m128i max_s67 =
-            _mm_max_epu8(secondary_val[6], secondary_val[7]);
-        const __m128i max_s = _mm_max_epu8(_mm_max_epu8(max_s01, max_s23),
-                                           _mm_max_epu8(max_s45, max_s67));
-        max = _mm_max_epu16(max, _mm_and_si128(max_s, cdef_large_value_mask));
+        max = GetMaxSecondary<Pixel>(secondary_val, max, cdef_large_value_mask);
       }
 
       sum = _mm_add_epi16(
@@ -685,41 +761,95 @@ void CdefFilter_SSE4_1(const uint16_t* LIBGAV1_RESTRICT src,
       sum = _mm_max_epi16(sum, min);
     }
 
-    const __m128i result = _mm_packus_epi16(sum, sum);
-    if (width == 8) {
-      src += src_stride;
-      StoreLo8(dst, result);
-      dst += dst_stride;
-      --y;
-    } else {
-      src += src_stride << 1;
-      Store4(dst, result);
-      dst += dst_stride;
-      Store4(dst, _mm_srli_si128(result, 4));
-      dst += dst_stride;
-      y -= 2;
-    }
+    StorePixels<Pixel, width>(dst, dst_stride, sum);
+
+    src += (width == 8) ? src_stride : src_stride << 1;
+    dst += (width == 8) ? dst_stride : dst_stride << 1;
+    y -= (width == 8) ? 1 : 2;
   } while (y != 0);
 }
 
+}  // namespace
+
+namespace low_bitdepth {
+namespace {
+
 void Init8bpp() {
   Dsp* const dsp = dsp_internal::GetWritableDspTable(8);
   assert(dsp != nullptr);
-  dsp->cdef_direction = CdefDirection_SSE4_1;
-  dsp->cdef_filters[0][0] = CdefFilter_SSE4_1<4>;
+  dsp->cdef_direction = CdefDirection_SSE4_1<kBitdepth8>;
+  dsp->cdef_filters[0][0] = CdefFilter_SSE4_1<4, kBitdepth8>;
   dsp->cdef_filters[0][1] =
-      CdefFilter_SSE4_1<4, /*enable_primary=*/true, /*enable_secondary=*/false>;
-  dsp->cdef_filters[0][2] = CdefFilter_SSE4_1<4, /*enable_primary=*/false>;
-  dsp->cdef_filters[1][0] = CdefFilter_SSE4_1<8>;
+      CdefFilter_SSE4_1<4, kBitdepth8, /*enable_primary=*/true,
+                        /*enable_secondary=*/false>;
+  dsp->cdef_filters[0][2] =
+      CdefFilter_SSE4_1<4, kBitdepth8, /*enable_primary=*/false>;
+  dsp->cdef_filters[1][0] = CdefFilter_SSE4_1<8, kBitdepth8>;
   dsp->cdef_filters[1][1] =
-      CdefFilter_SSE4_1<8, /*enable_primary=*/true, /*enable_secondary=*/false>;
-  dsp->cdef_filters[1][2] = CdefFilter_SSE4_1<8, /*enable_primary=*/false>;
+      CdefFilter_SSE4_1<8, kBitdepth8, /*enable_primary=*/true,
+                        /*enable_secondary=*/false>;
+  dsp->cdef_filters[1][2] =
+      CdefFilter_SSE4_1<8, kBitdepth8, /*enable_primary=*/false>;
 }
 
 }  // namespace
 }  // namespace low_bitdepth
 
-void CdefInit_SSE4_1() { low_bitdepth::Init8bpp(); }
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+  dsp->cdef_direction = CdefDirection_SSE4_1<kBitdepth10>;
+  dsp->cdef_filters[0][0] = CdefFilter_SSE4_1<4, kBitdepth10>;
+  dsp->cdef_filters[0][1] =
+      CdefFilter_SSE4_1<4, kBitdepth10, /*enable_primary=*/true,
+                        /*enable_secondary=*/false>;
+  dsp->cdef_filters[0][2] =
+      CdefFilter_SSE4_1<4, kBitdepth10, /*enable_primary=*/false>;
+  dsp->cdef_filters[1][0] = CdefFilter_SSE4_1<8, kBitdepth10>;
+  dsp->cdef_filters[1][1] =
+      CdefFilter_SSE4_1<8, kBitdepth10, /*enable_primary=*/true,
+                        /*enable_secondary=*/false>;
+  dsp->cdef_filters[1][2] =
+      CdefFilter_SSE4_1<8, kBitdepth10, /*enable_primary=*/false>;
+}
+
+#if LIBGAV1_MAX_BITDEPTH == 12
+void Init12bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth12);
+  assert(dsp != nullptr);
+  dsp->cdef_direction = CdefDirection_SSE4_1<kBitdepth12>;
+  dsp->cdef_filters[0][0] = CdefFilter_SSE4_1<4, kBitdepth12>;
+  dsp->cdef_filters[0][1] =
+      CdefFilter_SSE4_1<4, kBitdepth12, /*enable_primary=*/true,
+                        /*enable_secondary=*/false>;
+  dsp->cdef_filters[0][2] =
+      CdefFilter_SSE4_1<4, kBitdepth12, /*enable_primary=*/false>;
+  dsp->cdef_filters[1][0] = CdefFilter_SSE4_1<8, kBitdepth12>;
+  dsp->cdef_filters[1][1] =
+      CdefFilter_SSE4_1<8, kBitdepth12, /*enable_primary=*/true,
+                        /*enable_secondary=*/false>;
+  dsp->cdef_filters[1][2] =
+      CdefFilter_SSE4_1<8, kBitdepth12, /*enable_primary=*/false>;
+}
+#endif  // LIBGAV1_MAX_BITDEPTH == 12
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void CdefInit_SSE4_1() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+#if LIBGAV1_MAX_BITDEPTH == 12
+  high_bitdepth::Init12bpp();
+#endif
+}
 
 }  // namespace dsp
 }  // namespace libgav1
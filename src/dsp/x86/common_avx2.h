@@ -68,6 +68,7 @@ using avx2::StoreAligned16;
 using avx2::StoreHi8;
 using avx2::StoreLo8;
 using avx2::StoreUnaligned16;
+using avx2::VariableRightShiftWithRounding_S32;
 
 // common_avx2.inc
 using avx2::LoadAligned32;
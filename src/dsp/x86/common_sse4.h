@@ -121,6 +121,7 @@ using sse4::StoreAligned16;
 using sse4::StoreHi8;
 using sse4::StoreLo8;
 using sse4::StoreUnaligned16;
+using sse4::VariableRightShiftWithRounding_S32;
 // NOLINTEND
 
 }  // namespace dsp
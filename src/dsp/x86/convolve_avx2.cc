@@ -1480,7 +1480,420 @@ void Init8bpp() {
 }  // namespace
 }  // namespace low_bitdepth
 
-void ConvolveInit_AVX2() { low_bitdepth::Init8bpp(); }
+//------------------------------------------------------------------------------
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+// The 128 bit helpers handle blocks narrower than 16 pixels.
+#include "src/dsp/x86/convolve_10bit_sse4.inc"
+
+template <int num_taps>
+LIBGAV1_ALWAYS_INLINE void SetupTaps(const int8_t* const filter,
+                                     __m256i* const v_tap) {
+  __m128i v_tap_128[4];
+  SetupTaps<num_taps>(filter, v_tap_128);
+  for (int k = 0; k < num_taps / 2; ++k) {
+    v_tap[k] = _mm256_broadcastsi128_si256(v_tap_128[k]);
+  }
+}
+
+template <int bitdepth, int shift, bool is_compound>
+inline __m256i RoundShiftAndPack(const __m256i sum_lo, const __m256i sum_hi) {
+  __m256i lo = RightShiftWithRounding_S32(sum_lo, shift);
+  __m256i hi = RightShiftWithRounding_S32(sum_hi, shift);
+  if (is_compound) {
+    const __m256i compound_offset = _mm256_set1_epi32(kCompoundOffset);
+    lo = _mm256_add_epi32(lo, compound_offset);
+    hi = _mm256_add_epi32(hi, compound_offset);
+    return _mm256_packus_epi32(lo, hi);
+  }
+  return _mm256_min_epu16(_mm256_packus_epi32(lo, hi),
+                          _mm256_set1_epi16((1 << bitdepth) - 1));
+}
+
+template <int bitdepth, bool is_2d, bool is_compound>
+inline __m256i HorizontalResult(const __m256i sum_lo, const __m256i sum_hi) {
+  constexpr int kRoundBitsHorizontal = HorizontalRoundBits<bitdepth>();
+  if (is_2d) {
+    return _mm256_packs_epi32(
+        RightShiftWithRounding_S32(sum_lo, kRoundBitsHorizontal - 1),
+        RightShiftWithRounding_S32(sum_hi, kRoundBitsHorizontal - 1));
+  }
+  if (is_compound) {
+    return RoundShiftAndPack<bitdepth, kRoundBitsHorizontal - 1,
+                             /*is_compound=*/true>(sum_lo, sum_hi);
+  }
+  // See the 128 bit HorizontalResult() for the combined rounding.
+  const __m256i first_shift_rounding_bit =
+      _mm256_set1_epi32(1 << (kRoundBitsHorizontal - 2));
+  return RoundShiftAndPack<bitdepth, kFilterBits - 1, /*is_compound=*/false>(
+      _mm256_add_epi32(sum_lo, first_shift_rounding_bit),
+      _mm256_add_epi32(sum_hi, first_shift_rounding_bit));
+}
+
+// Filters 16 consecutive outputs. |src| points to the first nonzero tap. The
+// two loads are offset by 8 pixels so that the in-lane _mm256_alignr_epi8()
+// produces outputs 0-7 in the low lane and 8-15 in the high lane.
+template <int num_taps>
+inline void SumHorizontalTaps16(const uint16_t* LIBGAV1_RESTRICT const src,
+                                const __m256i* const v_tap, __m256i* sum_lo,
+                                __m256i* sum_hi) {
+  const __m256i s0 = LoadUnaligned32(src);
+  const __m256i s1 = LoadUnaligned32(src + 8);
+  __m256i s[8];
+  s[0] = s0;
+  s[1] = _mm256_alignr_epi8(s1, s0, 2);
+  if (num_taps > 2) {
+    s[2] = _mm256_alignr_epi8(s1, s0, 4);
+    s[3] = _mm256_alignr_epi8(s1, s0, 6);
+  }
+  if (num_taps > 4) {
+    s[4] = _mm256_alignr_epi8(s1, s0, 8);
+    s[5] = _mm256_alignr_epi8(s1, s0, 10);
+  }
+  if (num_taps > 6) {
+    s[6] = _mm256_alignr_epi8(s1, s0, 12);
+    s[7] = _mm256_alignr_epi8(s1, s0, 14);
+  }
+  __m256i lo =
+      _mm256_madd_epi16(_mm256_unpacklo_epi16(s[0], s[1]), v_tap[0]);
+  __m256i hi =
+      _mm256_madd_epi16(_mm256_unpackhi_epi16(s[0], s[1]), v_tap[0]);
+  for (int k = 1; k < num_taps / 2; ++k) {
+    lo = _mm256_add_epi32(
+        lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(s[2 * k], s[2 * k + 1]),
+                              v_tap[k]));
+    hi = _mm256_add_epi32(
+        hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(s[2 * k], s[2 * k + 1]),
+                              v_tap[k]));
+  }
+  *sum_lo = lo;
+  *sum_hi = hi;
+}
+
+template <int bitdepth, int num_taps, bool is_2d, bool is_compound>
+void FilterHorizontal16xH(const uint16_t* LIBGAV1_RESTRICT src,
+                          const ptrdiff_t src_stride,
+                          void* LIBGAV1_RESTRICT const dest,
+                          const ptrdiff_t pred_stride, const int width,
+                          const int height, const int8_t* const filter) {
+  assert(width >= 16);
+  __m256i v_tap[4];
+  SetupTaps<num_taps>(filter, v_tap);
+  auto* dest16 = static_cast<uint16_t*>(dest);
+  int y = height;
+  do {
+    int x = 0;
+    do {
+      __m256i sum_lo, sum_hi;
+      SumHorizontalTaps16<num_taps>(src + x, v_tap, &sum_lo, &sum_hi);
+      StoreUnaligned32(
+          dest16 + x,
+          HorizontalResult<bitdepth, is_2d, is_compound>(sum_lo, sum_hi));
+      x += 16;
+    } while (x < width);
+    src += src_stride;
+    dest16 += pred_stride;
+  } while (--y != 0);
+}
+
+// |src| is set to the outermost tap of an 8 tap filter.
+template <int bitdepth, bool is_2d = false, bool is_compound = false>
+LIBGAV1_ALWAYS_INLINE void DoHorizontalPass_AVX2(
+    const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
+    void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
+    const int width, const int height, const int filter_id,
+    const int filter_index) {
+  if (width < 16) {
+    DoHorizontalPass<bitdepth, is_2d, is_compound>(
+        src, src_stride, dst, dst_stride, width, height, filter_id,
+        filter_index);
+    return;
+  }
+  assert(filter_id != 0);
+  const int8_t* const filter = kHalfSubPixelFilters[filter_index][filter_id];
+  // Blocks of width 16 and above only use filter indices [0, 3].
+  if (filter_index == 2) {  // 8 tap.
+    FilterHorizontal16xH<bitdepth, 8, is_2d, is_compound>(
+        src, src_stride, dst, dst_stride, width, height, filter);
+  } else if (filter_index < 2) {  // 6 tap.
+    FilterHorizontal16xH<bitdepth, 6, is_2d, is_compound>(
+        src + 1, src_stride, dst, dst_stride, width, height, filter);
+  } else {  // 2 tap.
+    assert(filter_index == 3);
+    FilterHorizontal16xH<bitdepth, 2, is_2d, is_compound>(
+        src + 3, src_stride, dst, dst_stride, width, height, filter);
+  }
+}
+
+template <int num_taps>
+inline void SumVerticalTaps(const __m256i* const srcs,
+                            const __m256i* const v_tap, __m256i* sum_lo,
+                            __m256i* sum_hi) {
+  __m256i lo =
+      _mm256_madd_epi16(_mm256_unpacklo_epi16(srcs[0], srcs[1]), v_tap[0]);
+  __m256i hi =
+      _mm256_madd_epi16(_mm256_unpackhi_epi16(srcs[0], srcs[1]), v_tap[0]);
+  for (int k = 1; k < num_taps / 2; ++k) {
+    lo = _mm256_add_epi32(
+        lo, _mm256_madd_epi16(
+                _mm256_unpacklo_epi16(srcs[2 * k], srcs[2 * k + 1]), v_tap[k]));
+    hi = _mm256_add_epi32(
+        hi, _mm256_madd_epi16(
+                _mm256_unpackhi_epi16(srcs[2 * k], srcs[2 * k + 1]), v_tap[k]));
+  }
+  *sum_lo = lo;
+  *sum_hi = hi;
+}
+
+// Filters columns of 16 for |width| >= 16. The output is rounded by |shift|.
+template <int bitdepth, int num_taps, int shift, bool is_compound>
+void FilterVertical16xH(const uint16_t* LIBGAV1_RESTRICT const src,
+                        const ptrdiff_t src_stride,
+                        void* LIBGAV1_RESTRICT const dst,
+                        const ptrdiff_t dst_stride, const int width,
+                        const int height, const int8_t* const filter) {
+  constexpr int next_row = num_taps - 1;
+  auto* const dst16 = static_cast<uint16_t*>(dst);
+  assert(width >= 16);
+  __m256i v_tap[4];
+  SetupTaps<num_taps>(filter, v_tap);
+
+  int x = 0;
+  do {
+    const uint16_t* src_x = src + x;
+    __m256i srcs[8];
+    for (int i = 0; i < next_row; ++i) {
+      srcs[i] = LoadUnaligned32(src_x);
+      src_x += src_stride;
+    }
+
+    auto* dst16_x = dst16 + x;
+    int y = height;
+    do {
+      srcs[next_row] = LoadUnaligned32(src_x);
+      src_x += src_stride;
+
+      __m256i sum_lo, sum_hi;
+      SumVerticalTaps<num_taps>(srcs, v_tap, &sum_lo, &sum_hi);
+      StoreUnaligned32(dst16_x, RoundShiftAndPack<bitdepth, shift, is_compound>(
+                                    sum_lo, sum_hi));
+      dst16_x += dst_stride;
+
+      for (int i = 0; i < next_row; ++i) {
+        srcs[i] = srcs[i + 1];
+      }
+    } while (--y != 0);
+    x += 16;
+  } while (x < width);
+}
+
+// |src| is positioned at the row corresponding to the first nonzero tap.
+template <int bitdepth, int shift, bool is_compound>
+LIBGAV1_ALWAYS_INLINE void DoVerticalPass_AVX2(
+    const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
+    void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
+    const int width, const int height, const int vertical_taps,
+    const int8_t* const filter) {
+  if (width < 16) {
+    DoVerticalPass<bitdepth, shift, is_compound>(src, src_stride, dst,
+                                                 dst_stride, width, height,
+                                                 vertical_taps, filter);
+    return;
+  }
+  if (vertical_taps == 8) {
+    FilterVertical16xH<bitdepth, 8, shift, is_compound>(
+        src, src_stride, dst, dst_stride, width, height, filter);
+  } else if (vertical_taps == 6) {
+    FilterVertical16xH<bitdepth, 6, shift, is_compound>(
+        src, src_stride, dst, dst_stride, width, height, filter);
+  } else if (vertical_taps == 4) {
+    FilterVertical16xH<bitdepth, 4, shift, is_compound>(
+        src, src_stride, dst, dst_stride, width, height, filter);
+  } else {  // |vertical_taps| == 2
+    assert(vertical_taps == 2);
+    FilterVertical16xH<bitdepth, 2, shift, is_compound>(
+        src, src_stride, dst, dst_stride, width, height, filter);
+  }
+}
+
+template <int bitdepth>
+void ConvolveHorizontal_AVX2(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int /*vertical_filter_index*/, const int horizontal_filter_id,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT prediction, const ptrdiff_t pred_stride) {
+  const int filter_index = GetFilterIndex(horizontal_filter_index, width);
+  // Set |src| to the outermost tap.
+  const auto* const src =
+      static_cast<const uint16_t*>(reference) - kHorizontalOffset;
+  DoHorizontalPass_AVX2<bitdepth>(src, reference_stride >> 1, prediction,
+                                  pred_stride >> 1, width, height,
+                                  horizontal_filter_id, filter_index);
+}
+
+template <int bitdepth>
+void ConvolveCompoundHorizontal_AVX2(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int /*vertical_filter_index*/, const int horizontal_filter_id,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT prediction, const ptrdiff_t /*pred_stride*/) {
+  const int filter_index = GetFilterIndex(horizontal_filter_index, width);
+  const auto* const src =
+      static_cast<const uint16_t*>(reference) - kHorizontalOffset;
+  DoHorizontalPass_AVX2<bitdepth, /*is_2d=*/false, /*is_compound=*/true>(
+      src, reference_stride >> 1, prediction, width, width, height,
+      horizontal_filter_id, filter_index);
+}
+
+template <int bitdepth>
+void ConvolveVertical_AVX2(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int vertical_filter_index, const int /*horizontal_filter_id*/,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT prediction, const ptrdiff_t pred_stride) {
+  const int filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(filter_index);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const auto* const src = static_cast<const uint16_t*>(reference) -
+                          (vertical_taps / 2 - 1) * src_stride;
+  assert(vertical_filter_id != 0);
+
+  DoVerticalPass_AVX2<bitdepth, kFilterBits - 1, /*is_compound=*/false>(
+      src, src_stride, prediction, pred_stride >> 1, width, height,
+      vertical_taps, kHalfSubPixelFilters[filter_index][vertical_filter_id]);
+}
+
+template <int bitdepth>
+void ConvolveCompoundVertical_AVX2(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int vertical_filter_index, const int /*horizontal_filter_id*/,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT prediction, const ptrdiff_t /*pred_stride*/) {
+  const int filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(filter_index);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const auto* const src = static_cast<const uint16_t*>(reference) -
+                          (vertical_taps / 2 - 1) * src_stride;
+  assert(vertical_filter_id != 0);
+
+  DoVerticalPass_AVX2<bitdepth, HorizontalRoundBits<bitdepth>() - 1,
+                      /*is_compound=*/true>(
+      src, src_stride, prediction, width, width, height, vertical_taps,
+      kHalfSubPixelFilters[filter_index][vertical_filter_id]);
+}
+
+template <int bitdepth, bool is_compound>
+void Convolve2D_AVX2(const void* LIBGAV1_RESTRICT const reference,
+                     const ptrdiff_t reference_stride,
+                     const int horizontal_filter_index,
+                     const int vertical_filter_index,
+                     const int horizontal_filter_id,
+                     const int vertical_filter_id, const int width,
+                     const int height, void* LIBGAV1_RESTRICT prediction,
+                     const ptrdiff_t pred_stride) {
+  const int horiz_filter_index = GetFilterIndex(horizontal_filter_index, width);
+  const int vert_filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(vert_filter_index);
+
+  // The output of the horizontal filter is guaranteed to fit in 16 bits.
+  alignas(32) uint16_t
+      intermediate_result[kMaxSuperBlockSizeInPixels *
+                          (kMaxSuperBlockSizeInPixels + kSubPixelTaps - 1)];
+#if LIBGAV1_MSAN
+  // Quiet msan warnings. Set with random non-zero value to aid in debugging.
+  memset(intermediate_result, 0x33, sizeof(intermediate_result));
+#endif
+  const int intermediate_height = height + vertical_taps - 1;
+
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const auto* const src = static_cast<const uint16_t*>(reference) -
+                          (vertical_taps / 2 - 1) * src_stride -
+                          kHorizontalOffset;
+
+  DoHorizontalPass_AVX2<bitdepth, /*is_2d=*/true>(
+      src, src_stride, intermediate_result, width, width, intermediate_height,
+      horizontal_filter_id, horiz_filter_index);
+
+  // Vertical filter.
+  assert(vertical_filter_id != 0);
+  constexpr int kRoundBitsVertical =
+      is_compound ? kInterRoundBitsCompoundVertical
+                  : VerticalRoundBits<bitdepth>();
+  DoVerticalPass_AVX2<bitdepth, kRoundBitsVertical - 1, is_compound>(
+      intermediate_result, width, prediction,
+      is_compound ? width : pred_stride >> 1, width, height, vertical_taps,
+      kHalfSubPixelFilters[vert_filter_index][vertical_filter_id]);
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_AVX2(ConvolveHorizontal)
+  dsp->convolve[0][0][0][1] = ConvolveHorizontal_AVX2<10>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(ConvolveVertical)
+  dsp->convolve[0][0][1][0] = ConvolveVertical_AVX2<10>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(Convolve2D)
+  dsp->convolve[0][0][1][1] = Convolve2D_AVX2<10, /*is_compound=*/false>;
+#endif
+
+#if DSP_ENABLED_10BPP_AVX2(ConvolveCompoundHorizontal)
+  dsp->convolve[0][1][0][1] = ConvolveCompoundHorizontal_AVX2<10>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(ConvolveCompoundVertical)
+  dsp->convolve[0][1][1][0] = ConvolveCompoundVertical_AVX2<10>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(ConvolveCompound2D)
+  dsp->convolve[0][1][1][1] = Convolve2D_AVX2<10, /*is_compound=*/true>;
+#endif
+}
+
+#if LIBGAV1_MAX_BITDEPTH == 12
+void Init12bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth12);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_12BPP_AVX2(ConvolveHorizontal)
+  dsp->convolve[0][0][0][1] = ConvolveHorizontal_AVX2<12>;
+#endif
+#if DSP_ENABLED_12BPP_AVX2(ConvolveVertical)
+  dsp->convolve[0][0][1][0] = ConvolveVertical_AVX2<12>;
+#endif
+#if DSP_ENABLED_12BPP_AVX2(Convolve2D)
+  dsp->convolve[0][0][1][1] = Convolve2D_AVX2<12, /*is_compound=*/false>;
+#endif
+
+#if DSP_ENABLED_12BPP_AVX2(ConvolveCompoundHorizontal)
+  dsp->convolve[0][1][0][1] = ConvolveCompoundHorizontal_AVX2<12>;
+#endif
+#if DSP_ENABLED_12BPP_AVX2(ConvolveCompoundVertical)
+  dsp->convolve[0][1][1][0] = ConvolveCompoundVertical_AVX2<12>;
+#endif
+#if DSP_ENABLED_12BPP_AVX2(ConvolveCompound2D)
+  dsp->convolve[0][1][1][1] = Convolve2D_AVX2<12, /*is_compound=*/true>;
+#endif
+}
+#endif  // LIBGAV1_MAX_BITDEPTH == 12
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void ConvolveInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+#if LIBGAV1_MAX_BITDEPTH == 12
+  high_bitdepth::Init12bpp();
+#endif
+}
 
 }  // namespace dsp
 }  // namespace libgav1
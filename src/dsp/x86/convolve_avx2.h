@@ -54,6 +54,60 @@ void ConvolveInit_AVX2();
 #define LIBGAV1_Dsp8bpp_ConvolveCompoundVertical LIBGAV1_CPU_AVX2
 #endif
 
+//------------------------------------------------------------------------------
+// 10bpp
+
+#ifndef LIBGAV1_Dsp10bpp_ConvolveHorizontal
+#define LIBGAV1_Dsp10bpp_ConvolveHorizontal LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_ConvolveCompoundHorizontal
+#define LIBGAV1_Dsp10bpp_ConvolveCompoundHorizontal LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_ConvolveVertical
+#define LIBGAV1_Dsp10bpp_ConvolveVertical LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_Convolve2D
+#define LIBGAV1_Dsp10bpp_Convolve2D LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_ConvolveCompoundVertical
+#define LIBGAV1_Dsp10bpp_ConvolveCompoundVertical LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_ConvolveCompound2D
+#define LIBGAV1_Dsp10bpp_ConvolveCompound2D LIBGAV1_CPU_AVX2
+#endif
+
+//------------------------------------------------------------------------------
+// 12bpp
+
+#ifndef LIBGAV1_Dsp12bpp_ConvolveHorizontal
+#define LIBGAV1_Dsp12bpp_ConvolveHorizontal LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_ConvolveCompoundHorizontal
+#define LIBGAV1_Dsp12bpp_ConvolveCompoundHorizontal LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_ConvolveVertical
+#define LIBGAV1_Dsp12bpp_ConvolveVertical LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_Convolve2D
+#define LIBGAV1_Dsp12bpp_Convolve2D LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_ConvolveCompoundVertical
+#define LIBGAV1_Dsp12bpp_ConvolveCompoundVertical LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_ConvolveCompound2D
+#define LIBGAV1_Dsp12bpp_ConvolveCompound2D LIBGAV1_CPU_AVX2
+#endif
+
 #endif  // LIBGAV1_TARGETING_AVX2
 
 #endif  // LIBGAV1_SRC_DSP_X86_CONVOLVE_AVX2_H_
@@ -0,0 +1,566 @@
+// Copyright 2023 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/convolve.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX512
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx512.h"
+#include "src/utils/common.h"
+#include "src/utils/compiler_attributes.h"
+#include "src/utils/constants.h"
+
+// The AVX-512 intrinsics of GCC 12 and older initialize their unused source
+// operand from itself (_mm512_undefined_epi32()), which is reported by
+// -Wmaybe-uninitialized once they are inlined (GCC bug 105593).
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ < 13
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+
+namespace libgav1 {
+namespace dsp {
+namespace low_bitdepth {
+namespace {
+
+#include "src/dsp/x86/convolve_sse4.inc"
+
+// Multiply every entry in |src[]| by the corresponding entry in |taps[]| and
+// sum. The filters in |taps[]| are pre-shifted by 1. This prevents the final
+// sum from outranging int16_t.
+template <int num_taps>
+__m512i SumOnePassTaps(const __m512i* const src, const __m512i* const taps) {
+  __m512i sum;
+  if (num_taps == 6) {
+    // 6 taps.
+    const __m512i v_madd_21 = _mm512_maddubs_epi16(src[0], taps[0]);  // k2k1
+    const __m512i v_madd_43 = _mm512_maddubs_epi16(src[1], taps[1]);  // k4k3
+    const __m512i v_madd_65 = _mm512_maddubs_epi16(src[2], taps[2]);  // k6k5
+    sum = _mm512_add_epi16(v_madd_21, v_madd_43);
+    sum = _mm512_add_epi16(sum, v_madd_65);
+  } else if (num_taps == 8) {
+    // 8 taps.
+    const __m512i v_madd_10 = _mm512_maddubs_epi16(src[0], taps[0]);  // k1k0
+    const __m512i v_madd_32 = _mm512_maddubs_epi16(src[1], taps[1]);  // k3k2
+    const __m512i v_madd_54 = _mm512_maddubs_epi16(src[2], taps[2]);  // k5k4
+    const __m512i v_madd_76 = _mm512_maddubs_epi16(src[3], taps[3]);  // k7k6
+    const __m512i v_sum_3210 = _mm512_add_epi16(v_madd_10, v_madd_32);
+    const __m512i v_sum_7654 = _mm512_add_epi16(v_madd_54, v_madd_76);
+    sum = _mm512_add_epi16(v_sum_7654, v_sum_3210);
+  } else if (num_taps == 2) {
+    // 2 taps.
+    sum = _mm512_maddubs_epi16(src[0], taps[0]);  // k4k3
+  } else {
+    // 4 taps.
+    const __m512i v_madd_32 = _mm512_maddubs_epi16(src[0], taps[0]);  // k3k2
+    const __m512i v_madd_54 = _mm512_maddubs_epi16(src[1], taps[1]);  // k5k4
+    sum = _mm512_add_epi16(v_madd_32, v_madd_54);
+  }
+  return sum;
+}
+
+// Each 128-bit lane of |src_long| holds the 16 source pixels used to produce 8
+// outputs.
+template <int num_taps>
+__m512i HorizontalTaps8To16(const __m512i src_long,
+                            const __m512i* const v_tap) {
+  __m512i v_src[4];
+  const __m512i src_long_dup_lo = _mm512_unpacklo_epi8(src_long, src_long);
+  const __m512i src_long_dup_hi = _mm512_unpackhi_epi8(src_long, src_long);
+
+  if (num_taps == 6) {
+    // 6 taps.
+    v_src[0] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 3);   // _21
+    v_src[1] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 7);   // _43
+    v_src[2] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 11);  // _65
+  } else if (num_taps == 8) {
+    // 8 taps.
+    v_src[0] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 1);   // _10
+    v_src[1] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 5);   // _32
+    v_src[2] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 9);   // _54
+    v_src[3] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 13);  // _76
+  } else if (num_taps == 2) {
+    // 2 taps.
+    v_src[0] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 7);  // _43
+  } else {
+    // 4 taps.
+    v_src[0] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 5);  // _32
+    v_src[1] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 9);  // _54
+  }
+  const __m512i sum = SumOnePassTaps<num_taps>(v_src, v_tap);
+
+  return RightShiftWithRounding_S16(sum, kInterRoundBitsHorizontal - 1);
+}
+
+// Horizontal pass of the 2D filters. The intermediate buffer uses |width| as
+// its stride, so narrow blocks pack 2 (|width| == 16) or 4 (|width| <= 8) rows
+// into each vector. When |height| is not a multiple of that count the last
+// source row is repeated; |dest| has room for the extra rows.
+template <int num_taps>
+void FilterHorizontal2D(const uint8_t* LIBGAV1_RESTRICT src,
+                        const ptrdiff_t src_stride,
+                        uint16_t* LIBGAV1_RESTRICT dest, const int width,
+                        const int height, const __m512i* const v_tap) {
+  if (width >= 32) {
+    int y = height;
+    do {
+      int x = 0;
+      do {
+        // Lanes 0-3 hold the source for dest[x], dest[x + 8], dest[x + 16]
+        // and dest[x + 24].
+        const __m512i src_x0_x8 =
+            SetrM256i(LoadUnaligned32(&src[x]), LoadUnaligned32(&src[x + 8]));
+        const __m512i src_long = _mm512_shuffle_i64x2(src_x0_x8, src_x0_x8,
+                                                      _MM_SHUFFLE(3, 1, 2, 0));
+        const __m512i result = HorizontalTaps8To16<num_taps>(src_long, v_tap);
+        StoreAligned64(&dest[x], result);
+        x += 32;
+      } while (x < width);
+      src += src_stride;
+      dest += width;
+    } while (--y != 0);
+    return;
+  }
+
+  const int last_row = height - 1;
+  int y = 0;
+  do {
+    const uint8_t* const src0 = src + y * src_stride;
+    const uint8_t* const src1 = src + std::min(y + 1, last_row) * src_stride;
+    if (width == 16) {
+      const __m512i src_long =
+          SetrM128i(LoadUnaligned16(&src0[0]), LoadUnaligned16(&src0[8]),
+                    LoadUnaligned16(&src1[0]), LoadUnaligned16(&src1[8]));
+      StoreAligned64(dest, HorizontalTaps8To16<num_taps>(src_long, v_tap));
+      dest += 32;
+      y += 2;
+      continue;
+    }
+
+    const uint8_t* const src2 = src + std::min(y + 2, last_row) * src_stride;
+    const uint8_t* const src3 = src + std::min(y + 3, last_row) * src_stride;
+    if (width == 8) {
+      const __m512i src_long =
+          SetrM128i(LoadUnaligned16(src0), LoadUnaligned16(src1),
+                    LoadUnaligned16(src2), LoadUnaligned16(src3));
+      StoreAligned64(dest, HorizontalTaps8To16<num_taps>(src_long, v_tap));
+      dest += 32;
+    } else if (width == 4) {
+      const __m512i src_long =
+          SetrM128i(LoadUnaligned16(src0), LoadUnaligned16(src1),
+                    LoadUnaligned16(src2), LoadUnaligned16(src3));
+      const __m512i result = HorizontalTaps8To16<num_taps>(src_long, v_tap);
+      // Keep the low 4 outputs of each lane.
+      const __m512i packed = _mm512_permutexvar_epi64(
+          _mm512_setr_epi64(0, 2, 4, 6, 0, 2, 4, 6), result);
+      StoreAligned32(dest, _mm512_castsi512_si256(packed));
+      dest += 16;
+    } else {  // width == 2
+      // Only 4 taps are used by 2xH blocks so 8 bytes cover each row.
+      assert(num_taps <= 4);
+      const __m512i src_long = SetrM128i(LoadLo8(src0), LoadLo8(src1),
+                                         LoadLo8(src2), LoadLo8(src3));
+      const __m512i result = HorizontalTaps8To16<num_taps>(src_long, v_tap);
+      // Keep the low 2 outputs of each lane.
+      const __m512i packed = _mm512_permutexvar_epi32(
+          _mm512_setr_epi32(0, 4, 8, 12, 0, 4, 8, 12, 0, 4, 8, 12, 0, 4, 8, 12),
+          result);
+      StoreAligned16(dest, _mm512_castsi512_si128(packed));
+      dest += 8;
+    }
+    y += 4;
+  } while (y < height);
+}
+
+template <int num_taps, bool is_2d_vertical = false>
+LIBGAV1_ALWAYS_INLINE void SetupTaps(const __m128i* const filter,
+                                     __m512i* v_tap) {
+  if (num_taps == 8) {
+    if (is_2d_vertical) {
+      v_tap[0] = BroadcastLo32(*filter);                      // k1k0
+      v_tap[1] = BroadcastLo32(_mm_srli_si128(*filter, 4));   // k3k2
+      v_tap[2] = BroadcastLo32(_mm_srli_si128(*filter, 8));   // k5k4
+      v_tap[3] = BroadcastLo32(_mm_srli_si128(*filter, 12));  // k7k6
+    } else {
+      v_tap[0] = BroadcastLo16(*filter);                     // k1k0
+      v_tap[1] = BroadcastLo16(_mm_srli_si128(*filter, 2));  // k3k2
+      v_tap[2] = BroadcastLo16(_mm_srli_si128(*filter, 4));  // k5k4
+      v_tap[3] = BroadcastLo16(_mm_srli_si128(*filter, 6));  // k7k6
+    }
+  } else if (num_taps == 6) {
+    if (is_2d_vertical) {
+      v_tap[0] = BroadcastLo32(_mm_srli_si128(*filter, 2));   // k2k1
+      v_tap[1] = BroadcastLo32(_mm_srli_si128(*filter, 6));   // k4k3
+      v_tap[2] = BroadcastLo32(_mm_srli_si128(*filter, 10));  // k6k5
+    } else {
+      v_tap[0] = BroadcastLo16(_mm_srli_si128(*filter, 1));  // k2k1
+      v_tap[1] = BroadcastLo16(_mm_srli_si128(*filter, 3));  // k4k3
+      v_tap[2] = BroadcastLo16(_mm_srli_si128(*filter, 5));  // k6k5
+    }
+  } else if (num_taps == 4) {
+    if (is_2d_vertical) {
+      v_tap[0] = BroadcastLo32(_mm_srli_si128(*filter, 4));  // k3k2
+      v_tap[1] = BroadcastLo32(_mm_srli_si128(*filter, 8));  // k5k4
+    } else {
+      v_tap[0] = BroadcastLo16(_mm_srli_si128(*filter, 2));  // k3k2
+      v_tap[1] = BroadcastLo16(_mm_srli_si128(*filter, 4));  // k5k4
+    }
+  } else {  // num_taps == 2
+    if (is_2d_vertical) {
+      v_tap[0] = BroadcastLo32(_mm_srli_si128(*filter, 6));  // k4k3
+    } else {
+      v_tap[0] = BroadcastLo16(_mm_srli_si128(*filter, 3));  // k4k3
+    }
+  }
+}
+
+template <int num_taps, bool is_compound>
+__m512i SimpleSum2DVerticalTaps(const __m512i* const src,
+                                const __m512i* const taps) {
+  __m512i sum_lo =
+      _mm512_madd_epi16(_mm512_unpacklo_epi16(src[0], src[1]), taps[0]);
+  __m512i sum_hi =
+      _mm512_madd_epi16(_mm512_unpackhi_epi16(src[0], src[1]), taps[0]);
+  if (num_taps >= 4) {
+    __m512i madd_lo =
+        _mm512_madd_epi16(_mm512_unpacklo_epi16(src[2], src[3]), taps[1]);
+    __m512i madd_hi =
+        _mm512_madd_epi16(_mm512_unpackhi_epi16(src[2], src[3]), taps[1]);
+    sum_lo = _mm512_add_epi32(sum_lo, madd_lo);
+    sum_hi = _mm512_add_epi32(sum_hi, madd_hi);
+    if (num_taps >= 6) {
+      madd_lo =
+          _mm512_madd_epi16(_mm512_unpacklo_epi16(src[4], src[5]), taps[2]);
+      madd_hi =
+          _mm512_madd_epi16(_mm512_unpackhi_epi16(src[4], src[5]), taps[2]);
+      sum_lo = _mm512_add_epi32(sum_lo, madd_lo);
+      sum_hi = _mm512_add_epi32(sum_hi, madd_hi);
+      if (num_taps == 8) {
+        madd_lo =
+            _mm512_madd_epi16(_mm512_unpacklo_epi16(src[6], src[7]), taps[3]);
+        madd_hi =
+            _mm512_madd_epi16(_mm512_unpackhi_epi16(src[6], src[7]), taps[3]);
+        sum_lo = _mm512_add_epi32(sum_lo, madd_lo);
+        sum_hi = _mm512_add_epi32(sum_hi, madd_hi);
+      }
+    }
+  }
+
+  if (is_compound) {
+    return _mm512_packs_epi32(
+        RightShiftWithRounding_S32(sum_lo, kInterRoundBitsCompoundVertical - 1),
+        RightShiftWithRounding_S32(sum_hi,
+                                   kInterRoundBitsCompoundVertical - 1));
+  }
+
+  return _mm512_packs_epi32(
+      RightShiftWithRounding_S32(sum_lo, kInterRoundBitsVertical - 1),
+      RightShiftWithRounding_S32(sum_hi, kInterRoundBitsVertical - 1));
+}
+
+// Saturates the 32 int16_t values in |sum| to uint8_t.
+inline __m256i PackUnsigned(const __m512i sum) {
+  return _mm512_cvtusepi16_epi8(_mm512_max_epi16(sum, _mm512_setzero_si512()));
+}
+
+template <int num_taps, bool is_compound = false>
+void Filter2DVertical32xH(const uint16_t* LIBGAV1_RESTRICT src,
+                          void* LIBGAV1_RESTRICT const dst,
+                          const ptrdiff_t dst_stride, const int width,
+                          const int height, const __m512i* const taps) {
+  assert(width >= 32);
+  constexpr int next_row = num_taps - 1;
+  // The Horizontal pass uses |width| as |stride| for the intermediate buffer.
+  const ptrdiff_t src_stride = width;
+
+  auto* dst8 = static_cast<uint8_t*>(dst);
+  auto* dst16 = static_cast<uint16_t*>(dst);
+
+  int x = 0;
+  do {
+    __m512i srcs[8];
+    const uint16_t* src_x = src + x;
+    srcs[0] = LoadAligned64(src_x);
+    src_x += src_stride;
+    if (num_taps >= 4) {
+      srcs[1] = LoadAligned64(src_x);
+      src_x += src_stride;
+      srcs[2] = LoadAligned64(src_x);
+      src_x += src_stride;
+      if (num_taps >= 6) {
+        srcs[3] = LoadAligned64(src_x);
+        src_x += src_stride;
+        srcs[4] = LoadAligned64(src_x);
+        src_x += src_stride;
+        if (num_taps == 8) {
+          srcs[5] = LoadAligned64(src_x);
+          src_x += src_stride;
+          srcs[6] = LoadAligned64(src_x);
+          src_x += src_stride;
+        }
+      }
+    }
+
+    auto* dst8_x = dst8 + x;
+    auto* dst16_x = dst16 + x;
+    int y = height;
+    do {
+      srcs[next_row] = LoadAligned64(src_x);
+      src_x += src_stride;
+
+      const __m512i sum =
+          SimpleSum2DVerticalTaps<num_taps, is_compound>(srcs, taps);
+      if (is_compound) {
+        StoreUnaligned64(dst16_x, sum);
+        dst16_x += dst_stride;
+      } else {
+        StoreUnaligned32(dst8_x, PackUnsigned(sum));
+        dst8_x += dst_stride;
+      }
+
+      srcs[0] = srcs[1];
+      if (num_taps >= 4) {
+        srcs[1] = srcs[2];
+        srcs[2] = srcs[3];
+        if (num_taps >= 6) {
+          srcs[3] = srcs[4];
+          srcs[4] = srcs[5];
+          if (num_taps == 8) {
+            srcs[5] = srcs[6];
+            srcs[6] = srcs[7];
+          }
+        }
+      }
+    } while (--y != 0);
+    x += 32;
+  } while (x < width);
+}
+
+// Take advantage of |src_stride| == |width| to process 2 (|width| == 16) or 4
+// (|width| == 8) rows at a time. Each vector loaded at row |y| + k holds tap k
+// for all of the output rows.
+template <int width, int num_taps, bool is_compound = false>
+void Filter2DVerticalMultiRow(const uint16_t* LIBGAV1_RESTRICT src,
+                              void* LIBGAV1_RESTRICT const dst,
+                              const ptrdiff_t dst_stride, const int height,
+                              const __m512i* const taps) {
+  static_assert(width == 8 || width == 16, "");
+  constexpr int kRows = 32 / width;
+  assert(height % kRows == 0);
+
+  auto* dst8 = static_cast<uint8_t*>(dst);
+  auto* dst16 = static_cast<uint16_t*>(dst);
+
+  int y = height;
+  do {
+    __m512i srcs[8];
+    for (int k = 0; k < num_taps; ++k) {
+      srcs[k] = LoadUnaligned64(src + k * width);
+    }
+    const __m512i sum =
+        SimpleSum2DVerticalTaps<num_taps, is_compound>(srcs, taps);
+
+    if (is_compound) {
+      if (width == 16) {
+        StoreUnaligned32(dst16, _mm512_castsi512_si256(sum));
+        StoreUnaligned32(dst16 + dst_stride, _mm512_extracti64x4_epi64(sum, 1));
+      } else {
+        StoreUnaligned16(dst16, _mm512_castsi512_si128(sum));
+        StoreUnaligned16(dst16 + dst_stride, _mm512_extracti32x4_epi32(sum, 1));
+        StoreUnaligned16(dst16 + 2 * dst_stride,
+                         _mm512_extracti32x4_epi32(sum, 2));
+        StoreUnaligned16(dst16 + 3 * dst_stride,
+                         _mm512_extracti32x4_epi32(sum, 3));
+      }
+      dst16 += kRows * dst_stride;
+    } else {
+      const __m256i packed = PackUnsigned(sum);
+      const __m128i packed_lo = _mm256_castsi256_si128(packed);
+      const __m128i packed_hi = _mm256_extracti128_si256(packed, 1);
+      if (width == 16) {
+        StoreUnaligned16(dst8, packed_lo);
+        StoreUnaligned16(dst8 + dst_stride, packed_hi);
+      } else {
+        StoreLo8(dst8, packed_lo);
+        StoreHi8(dst8 + dst_stride, packed_lo);
+        StoreLo8(dst8 + 2 * dst_stride, packed_hi);
+        StoreHi8(dst8 + 3 * dst_stride, packed_hi);
+      }
+      dst8 += kRows * dst_stride;
+    }
+    src += 32;
+    y -= kRows;
+  } while (y != 0);
+}
+
+void DoHorizontalPass2D(const uint8_t* LIBGAV1_RESTRICT const src,
+                        const ptrdiff_t src_stride,
+                        uint16_t* LIBGAV1_RESTRICT const dst, const int width,
+                        const int height, const int filter_id,
+                        const int filter_index) {
+  assert(filter_id != 0);
+  __m512i v_tap[4];
+  const __m128i v_horizontal_filter =
+      LoadLo8(kHalfSubPixelFilters[filter_index][filter_id]);
+
+  if (filter_index == 2) {  // 8 tap.
+    SetupTaps<8>(&v_horizontal_filter, v_tap);
+    FilterHorizontal2D<8>(src, src_stride, dst, width, height, v_tap);
+  } else if (filter_index < 2) {  // 6 tap.
+    SetupTaps<6>(&v_horizontal_filter, v_tap);
+    FilterHorizontal2D<6>(src, src_stride, dst, width, height, v_tap);
+  } else if ((filter_index & 0x4) != 0) {  // 4 tap.
+    // ((filter_index == 4) | (filter_index == 5))
+    SetupTaps<4>(&v_horizontal_filter, v_tap);
+    FilterHorizontal2D<4>(src, src_stride, dst, width, height, v_tap);
+  } else {  // 2 tap.
+    SetupTaps<2>(&v_horizontal_filter, v_tap);
+    FilterHorizontal2D<2>(src, src_stride, dst, width, height, v_tap);
+  }
+}
+
+template <int num_taps, bool is_compound>
+void DoVerticalPass2D(const uint16_t* LIBGAV1_RESTRICT const src,
+                      void* LIBGAV1_RESTRICT const dst,
+                      const ptrdiff_t dst_stride, const int width,
+                      const int height, const __m128i v_filter) {
+  // 8x2 blocks have too few rows to fill a vector.
+  if (width >= 16 || (width == 8 && height >= 4)) {
+    __m512i taps_512[4];
+    const __m128i v_filter_ext = _mm_cvtepi8_epi16(v_filter);
+    SetupTaps<num_taps, /*is_2d_vertical=*/true>(&v_filter_ext, taps_512);
+    if (width >= 32) {
+      Filter2DVertical32xH<num_taps, is_compound>(src, dst, dst_stride, width,
+                                                  height, taps_512);
+    } else if (width == 16) {
+      Filter2DVerticalMultiRow<16, num_taps, is_compound>(
+          src, dst, dst_stride, height, taps_512);
+    } else {
+      Filter2DVerticalMultiRow<8, num_taps, is_compound>(
+          src, dst, dst_stride, height, taps_512);
+    }
+    return;
+  }
+
+  // Use 128 bit code.
+  __m128i taps[4];
+  SetupTaps<num_taps, /*is_2d_vertical=*/true>(&v_filter, taps);
+  if (width == 2) {
+    assert(!is_compound);
+    Filter2DVertical2xH<num_taps>(src, dst, dst_stride, height, taps);
+  } else if (width == 4) {
+    Filter2DVertical4xH<num_taps, is_compound>(src, dst, dst_stride, height,
+                                               taps);
+  } else {
+    Filter2DVertical<num_taps, is_compound>(src, dst, dst_stride, width,
+                                            height, taps);
+  }
+}
+
+template <bool is_compound>
+void Convolve2D_AVX512(const void* LIBGAV1_RESTRICT const reference,
+                       const ptrdiff_t reference_stride,
+                       const int horizontal_filter_index,
+                       const int vertical_filter_index,
+                       const int horizontal_filter_id,
+                       const int vertical_filter_id, const int width,
+                       const int height, void* LIBGAV1_RESTRICT prediction,
+                       const ptrdiff_t pred_stride) {
+  const int horiz_filter_index = GetFilterIndex(horizontal_filter_index, width);
+  const int vert_filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps =
+      GetNumTapsInFilter(vert_filter_index, vertical_filter_id);
+
+  // The output of the horizontal filter is guaranteed to fit in 16 bits.
+  alignas(64) uint16_t
+      intermediate_result[kMaxSuperBlockSizeInPixels *
+                          (kMaxSuperBlockSizeInPixels + kSubPixelTaps - 1)];
+#if LIBGAV1_MSAN
+  // Quiet msan warnings. Set with random non-zero value to aid in debugging.
+  memset(intermediate_result, 0x33, sizeof(intermediate_result));
+#endif
+  const int intermediate_height = height + vertical_taps - 1;
+
+  const ptrdiff_t src_stride = reference_stride;
+  const auto* src = static_cast<const uint8_t*>(reference) -
+                    (vertical_taps / 2 - 1) * src_stride - kHorizontalOffset;
+  DoHorizontalPass2D(src, src_stride, intermediate_result, width,
+                     intermediate_height, horizontal_filter_id,
+                     horiz_filter_index);
+
+  // Vertical filter.
+  auto* dest = static_cast<uint8_t*>(prediction);
+  const ptrdiff_t dest_stride = pred_stride;
+  assert(vertical_filter_id != 0);
+
+  const __m128i v_filter =
+      LoadLo8(kHalfSubPixelFilters[vert_filter_index][vertical_filter_id]);
+
+  if (vertical_taps == 8) {
+    DoVerticalPass2D<8, is_compound>(intermediate_result, dest, dest_stride,
+                                     width, height, v_filter);
+  } else if (vertical_taps == 6) {
+    DoVerticalPass2D<6, is_compound>(intermediate_result, dest, dest_stride,
+                                     width, height, v_filter);
+  } else if (vertical_taps == 4) {
+    DoVerticalPass2D<4, is_compound>(intermediate_result, dest, dest_stride,
+                                     width, height, v_filter);
+  } else {  // |vertical_taps| == 2
+    DoVerticalPass2D<2, is_compound>(intermediate_result, dest, dest_stride,
+                                     width, height, v_filter);
+  }
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX512(Convolve2D)
+  dsp->convolve[0][0][1][1] = Convolve2D_AVX512</*is_compound=*/false>;
+#endif
+#if DSP_ENABLED_8BPP_AVX512(ConvolveCompound2D)
+  dsp->convolve[0][1][1][1] = Convolve2D_AVX512</*is_compound=*/true>;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+void ConvolveInit_AVX512() { low_bitdepth::Init8bpp(); }
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ < 13
+#pragma GCC diagnostic pop
+#endif
+
+#else   // !LIBGAV1_TARGETING_AVX512
+namespace libgav1 {
+namespace dsp {
+
+void ConvolveInit_AVX512() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX512
@@ -1889,7 +1889,589 @@ void Init8bpp() {
 }  // namespace
 }  // namespace low_bitdepth
 
-void ConvolveInit_SSE4_1() { low_bitdepth::Init8bpp(); }
+//------------------------------------------------------------------------------
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+#include "src/dsp/x86/convolve_10bit_sse4.inc"
+
+template <int bitdepth>
+void ConvolveHorizontal_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int /*vertical_filter_index*/, const int horizontal_filter_id,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT prediction, const ptrdiff_t pred_stride) {
+  const int filter_index = GetFilterIndex(horizontal_filter_index, width);
+  // Set |src| to the outermost tap.
+  const auto* const src =
+      static_cast<const uint16_t*>(reference) - kHorizontalOffset;
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const ptrdiff_t dest_stride = pred_stride >> 1;
+
+  DoHorizontalPass<bitdepth>(src, src_stride, prediction, dest_stride, width,
+                             height, horizontal_filter_id, filter_index);
+}
+
+template <int bitdepth>
+void ConvolveCompoundHorizontal_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int /*vertical_filter_index*/, const int horizontal_filter_id,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT prediction, const ptrdiff_t /*pred_stride*/) {
+  const int filter_index = GetFilterIndex(horizontal_filter_index, width);
+  const auto* const src =
+      static_cast<const uint16_t*>(reference) - kHorizontalOffset;
+  const ptrdiff_t src_stride = reference_stride >> 1;
+
+  DoHorizontalPass<bitdepth, /*is_2d=*/false, /*is_compound=*/true>(
+      src, src_stride, prediction, width, width, height, horizontal_filter_id,
+      filter_index);
+}
+
+template <int bitdepth>
+void ConvolveVertical_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int vertical_filter_index, const int /*horizontal_filter_id*/,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT prediction, const ptrdiff_t pred_stride) {
+  const int filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(filter_index);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const auto* const src = static_cast<const uint16_t*>(reference) -
+                          (vertical_taps / 2 - 1) * src_stride;
+  assert(vertical_filter_id != 0);
+
+  DoVerticalPass<bitdepth, kFilterBits - 1, /*is_compound=*/false>(
+      src, src_stride, prediction, pred_stride >> 1, width, height,
+      vertical_taps, kHalfSubPixelFilters[filter_index][vertical_filter_id]);
+}
+
+template <int bitdepth>
+void ConvolveCompoundVertical_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int vertical_filter_index, const int /*horizontal_filter_id*/,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT prediction, const ptrdiff_t /*pred_stride*/) {
+  const int filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(filter_index);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const auto* const src = static_cast<const uint16_t*>(reference) -
+                          (vertical_taps / 2 - 1) * src_stride;
+  assert(vertical_filter_id != 0);
+
+  DoVerticalPass<bitdepth, HorizontalRoundBits<bitdepth>() - 1,
+                 /*is_compound=*/true>(
+      src, src_stride, prediction, width, width, height, vertical_taps,
+      kHalfSubPixelFilters[filter_index][vertical_filter_id]);
+}
+
+template <int bitdepth, bool is_compound>
+void Convolve2D_SSE4_1(const void* LIBGAV1_RESTRICT const reference,
+                       const ptrdiff_t reference_stride,
+                       const int horizontal_filter_index,
+                       const int vertical_filter_index,
+                       const int horizontal_filter_id,
+                       const int vertical_filter_id, const int width,
+                       const int height, void* LIBGAV1_RESTRICT prediction,
+                       const ptrdiff_t pred_stride) {
+  const int horiz_filter_index = GetFilterIndex(horizontal_filter_index, width);
+  const int vert_filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(vert_filter_index);
+
+  // The output of the horizontal filter is guaranteed to fit in 16 bits.
+  alignas(16) uint16_t
+      intermediate_result[kMaxSuperBlockSizeInPixels *
+                          (kMaxSuperBlockSizeInPixels + kSubPixelTaps - 1)];
+#if LIBGAV1_MSAN
+  // Quiet msan warnings. Set with random non-zero value to aid in debugging.
+  memset(intermediate_result, 0x33, sizeof(intermediate_result));
+#endif
+  const int intermediate_height = height + vertical_taps - 1;
+
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const auto* const src = static_cast<const uint16_t*>(reference) -
+                          (vertical_taps / 2 - 1) * src_stride -
+                          kHorizontalOffset;
+
+  DoHorizontalPass<bitdepth, /*is_2d=*/true>(
+      src, src_stride, intermediate_result, width, width, intermediate_height,
+      horizontal_filter_id, horiz_filter_index);
+
+  // Vertical filter.
+  assert(vertical_filter_id != 0);
+  constexpr int kRoundBitsVertical =
+      is_compound ? kInterRoundBitsCompoundVertical
+                  : VerticalRoundBits<bitdepth>();
+  DoVerticalPass<bitdepth, kRoundBitsVertical - 1, is_compound>(
+      intermediate_result, width, prediction,
+      is_compound ? width : pred_stride >> 1, width, height, vertical_taps,
+      kHalfSubPixelFilters[vert_filter_index][vertical_filter_id]);
+}
+
+template <int bitdepth>
+void ConvolveCompoundCopy_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int /*vertical_filter_index*/, const int /*horizontal_filter_id*/,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT prediction, const ptrdiff_t /*pred_stride*/) {
+  const auto* src = static_cast<const uint16_t*>(reference);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  auto* dest = static_cast<uint16_t*>(prediction);
+  constexpr int kRoundBitsVertical =
+      VerticalRoundBits<bitdepth>() - kInterRoundBitsCompoundVertical;
+  const __m128i v_offset =
+      _mm_set1_epi16((1 << bitdepth) + (1 << (bitdepth - 1)));
+  // Compound functions start at 4x4.
+  assert(width >= 4 && height >= 4);
+
+  int y = height;
+  if (width >= 8) {
+    do {
+      int x = 0;
+      do {
+        const __m128i v_src = LoadUnaligned16(&src[x]);
+        StoreUnaligned16(&dest[x],
+                         _mm_slli_epi16(_mm_add_epi16(v_src, v_offset),
+                                        kRoundBitsVertical));
+        x += 8;
+      } while (x < width);
+      src += src_stride;
+      dest += width;
+    } while (--y != 0);
+  } else {
+    assert(width == 4);
+    do {
+      const __m128i v_src = LoadLo8(src);
+      StoreLo8(dest, _mm_slli_epi16(_mm_add_epi16(v_src, v_offset),
+                                    kRoundBitsVertical));
+      src += src_stride;
+      dest += width;
+    } while (--y != 0);
+  }
+}
+
+// Computes the horizontal pass for |width| columns of |intermediate_height|
+// rows. The source offsets and filters only depend on the column, so they are
+// computed once up front. Groups of 4 outputs are formed with
+// _mm_madd_epi16() against all 8 taps followed by a horizontal add tree.
+template <int bitdepth>
+inline void ConvolveHorizontalScale(const uint16_t* LIBGAV1_RESTRICT src,
+                                    const ptrdiff_t src_stride,
+                                    const int width, const int subpixel_x,
+                                    const int step_x,
+                                    const int intermediate_height,
+                                    const int filter_index,
+                                    int16_t* LIBGAV1_RESTRICT intermediate,
+                                    const ptrdiff_t intermediate_stride) {
+  constexpr int kRoundBitsHorizontal = HorizontalRoundBits<bitdepth>();
+  const int ref_x = subpixel_x >> kScaleSubPixelBits;
+  int offsets[kMaxSuperBlockSizeInPixels];
+  __m128i filters[kMaxSuperBlockSizeInPixels];
+  // Pad to a multiple of 4 columns by repeating the last column. The extra
+  // outputs land in the intermediate stride padding.
+  const int padded_width = Align(width, 4);
+  int p = subpixel_x;
+  for (int x = 0; x < padded_width; ++x) {
+    offsets[x] = (p >> kScaleSubPixelBits) - ref_x;
+    filters[x] = _mm_cvtepi8_epi16(
+        LoadLo8(kHalfSubPixelFilters[filter_index]
+                                    [(p >> kFilterIndexShift) & kSubPixelMask]));
+    if (x + 1 < width) p += step_x;
+  }
+
+  int y = intermediate_height;
+  do {
+    int x = 0;
+    do {
+      const __m128i sum0 = _mm_madd_epi16(
+          LoadUnaligned16(&src[offsets[x + 0]]), filters[x + 0]);
+      const __m128i sum1 = _mm_madd_epi16(
+          LoadUnaligned16(&src[offsets[x + 1]]), filters[x + 1]);
+      const __m128i sum2 = _mm_madd_epi16(
+          LoadUnaligned16(&src[offsets[x + 2]]), filters[x + 2]);
+      const __m128i sum3 = _mm_madd_epi16(
+          LoadUnaligned16(&src[offsets[x + 3]]), filters[x + 3]);
+      const __m128i sum = _mm_hadd_epi32(_mm_hadd_epi32(sum0, sum1),
+                                         _mm_hadd_epi32(sum2, sum3));
+      const __m128i result =
+          RightShiftWithRounding_S32(sum, kRoundBitsHorizontal - 1);
+      StoreLo8(&intermediate[x], _mm_packs_epi32(result, result));
+      x += 4;
+    } while (x < width);
+    src += src_stride;
+    intermediate += intermediate_stride;
+  } while (--y != 0);
+}
+
+template <int bitdepth, int num_taps, bool is_compound>
+inline void ConvolveVerticalScale(const int16_t* LIBGAV1_RESTRICT src,
+                                  const ptrdiff_t src_stride, const int width,
+                                  const int subpixel_y, const int filter_index,
+                                  const int step_y, const int height,
+                                  void* LIBGAV1_RESTRICT dest,
+                                  const ptrdiff_t dest_stride) {
+  constexpr int kRoundBitsVertical =
+      is_compound ? kInterRoundBitsCompoundVertical
+                  : VerticalRoundBits<bitdepth>();
+  auto* dest16 = static_cast<uint16_t*>(dest);
+  int p = subpixel_y & 1023;
+  int y = height;
+  do {
+    __m128i v_tap[4];
+    SetupTaps<num_taps>(
+        kHalfSubPixelFilters[filter_index]
+                            [(p >> kFilterIndexShift) & kSubPixelMask],
+        v_tap);
+    const int16_t* const src_y = src + (p >> kScaleSubPixelBits) * src_stride;
+    __m128i srcs[8];
+    __m128i sum_lo, sum_hi;
+    if (width >= 8) {
+      int x = 0;
+      do {
+        for (int k = 0; k < num_taps; ++k) {
+          srcs[k] = LoadUnaligned16(&src_y[k * src_stride + x]);
+        }
+        SumVerticalTaps<num_taps>(srcs, v_tap, &sum_lo, &sum_hi);
+        StoreUnaligned16(&dest16[x],
+                         RoundShiftAndPack<bitdepth, kRoundBitsVertical - 1,
+                                           is_compound>(sum_lo, sum_hi));
+        x += 8;
+      } while (x < width);
+    } else {
+      for (int k = 0; k < num_taps; ++k) {
+        srcs[k] = LoadLo8(&src_y[k * src_stride]);
+      }
+      SumVerticalTaps<num_taps>(srcs, v_tap, &sum_lo, &sum_hi);
+      const __m128i result =
+          RoundShiftAndPack<bitdepth, kRoundBitsVertical - 1, is_compound>(
+              sum_lo, sum_lo);
+      if (width == 4) {
+        StoreLo8(dest16, result);
+      } else {
+        assert(width == 2 && !is_compound);
+        Store4(dest16, result);
+      }
+    }
+    dest16 += dest_stride;
+    p += step_y;
+  } while (--y != 0);
+}
+
+template <int bitdepth, bool is_compound>
+void ConvolveScale2D_SSE4_1(const void* LIBGAV1_RESTRICT const reference,
+                            const ptrdiff_t reference_stride,
+                            const int horizontal_filter_index,
+                            const int vertical_filter_index,
+                            const int subpixel_x, const int subpixel_y,
+                            const int step_x, const int step_y, const int width,
+                            const int height, void* LIBGAV1_RESTRICT prediction,
+                            const ptrdiff_t pred_stride) {
+  const int horiz_filter_index = GetFilterIndex(horizontal_filter_index, width);
+  const int vert_filter_index = GetFilterIndex(vertical_filter_index, height);
+  assert(step_x <= 2048);
+  // The output of the horizontal filter, i.e. the intermediate_result, is
+  // guaranteed to fit in int16_t.
+  alignas(16) int16_t
+      intermediate_result[kIntermediateAllocWidth *
+                          (2 * kIntermediateAllocWidth + kSubPixelTaps)];
+#if LIBGAV1_MSAN
+  // Quiet msan warnings. Set with random non-zero value to aid in debugging.
+  memset(intermediate_result, 0x44, sizeof(intermediate_result));
+#endif
+  const int num_vert_taps = GetNumTapsInFilter(vert_filter_index);
+  const int intermediate_height =
+      (((height - 1) * step_y + (1 << kScaleSubPixelBits) - 1) >>
+       kScaleSubPixelBits) +
+      num_vert_taps;
+  // Narrow blocks are padded to 4 columns for the horizontal pass.
+  const ptrdiff_t intermediate_stride = std::max(width, 4);
+
+  // Horizontal filter.
+  // Only the rows used by the |num_vert_taps| center taps are filtered.
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const int vert_kernel_offset = (8 - num_vert_taps) / 2;
+  const auto* const src = static_cast<const uint16_t*>(reference) +
+                          vert_kernel_offset * src_stride;
+  ConvolveHorizontalScale<bitdepth>(src, src_stride, width, subpixel_x, step_x,
+                                    intermediate_height, horiz_filter_index,
+                                    intermediate_result, intermediate_stride);
+
+  // Vertical filter.
+  const ptrdiff_t dest_stride = is_compound ? width : pred_stride >> 1;
+  switch (num_vert_taps) {
+    case 6:
+      ConvolveVerticalScale<bitdepth, 6, is_compound>(
+          intermediate_result, intermediate_stride, width, subpixel_y,
+          vert_filter_index, step_y, height, prediction, dest_stride);
+      break;
+    case 8:
+      ConvolveVerticalScale<bitdepth, 8, is_compound>(
+          intermediate_result, intermediate_stride, width, subpixel_y,
+          vert_filter_index, step_y, height, prediction, dest_stride);
+      break;
+    case 2:
+      ConvolveVerticalScale<bitdepth, 2, is_compound>(
+          intermediate_result, intermediate_stride, width, subpixel_y,
+          vert_filter_index, step_y, height, prediction, dest_stride);
+      break;
+    default:
+      assert(num_vert_taps == 4);
+      ConvolveVerticalScale<bitdepth, 4, is_compound>(
+          intermediate_result, intermediate_stride, width, subpixel_y,
+          vert_filter_index, step_y, height, prediction, dest_stride);
+  }
+}
+
+void ConvolveIntraBlockCopyHorizontal_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int /*vertical_filter_index*/, const int /*subpixel_x*/,
+    const int /*subpixel_y*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t pred_stride) {
+  const auto* src = static_cast<const uint16_t*>(reference);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  auto* dest = static_cast<uint16_t*>(prediction);
+  const ptrdiff_t dest_stride = pred_stride >> 1;
+
+  int y = height;
+  if (width >= 8) {
+    do {
+      int x = 0;
+      do {
+        StoreUnaligned16(&dest[x],
+                         _mm_avg_epu16(LoadUnaligned16(&src[x]),
+                                       LoadUnaligned16(&src[x + 1])));
+        x += 8;
+      } while (x < width);
+      src += src_stride;
+      dest += dest_stride;
+    } while (--y != 0);
+  } else if (width == 4) {
+    do {
+      StoreLo8(dest, _mm_avg_epu16(LoadLo8(src), LoadLo8(src + 1)));
+      src += src_stride;
+      dest += dest_stride;
+    } while (--y != 0);
+  } else {
+    assert(width == 2);
+    do {
+      Store4(dest, _mm_avg_epu16(Load4(src), Load4(src + 1)));
+      src += src_stride;
+      dest += dest_stride;
+    } while (--y != 0);
+  }
+}
+
+void ConvolveIntraBlockCopyVertical_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int /*vertical_filter_index*/, const int /*horizontal_filter_id*/,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t pred_stride) {
+  const auto* src = static_cast<const uint16_t*>(reference);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  auto* dest = static_cast<uint16_t*>(prediction);
+  const ptrdiff_t dest_stride = pred_stride >> 1;
+
+  int y = height;
+  if (width >= 8) {
+    do {
+      int x = 0;
+      do {
+        StoreUnaligned16(&dest[x],
+                         _mm_avg_epu16(LoadUnaligned16(&src[x]),
+                                       LoadUnaligned16(&src[x + src_stride])));
+        x += 8;
+      } while (x < width);
+      src += src_stride;
+      dest += dest_stride;
+    } while (--y != 0);
+  } else if (width == 4) {
+    do {
+      StoreLo8(dest, _mm_avg_epu16(LoadLo8(src), LoadLo8(src + src_stride)));
+      src += src_stride;
+      dest += dest_stride;
+    } while (--y != 0);
+  } else {
+    assert(width == 2);
+    do {
+      Store4(dest, _mm_avg_epu16(Load4(src), Load4(src + src_stride)));
+      src += src_stride;
+      dest += dest_stride;
+    } while (--y != 0);
+  }
+}
+
+// Returns (|row| + |below| + 2) >> 2 where each input is the sum of two
+// horizontally adjacent pixels.
+inline __m128i IntraBlockCopy2DResult(const __m128i row, const __m128i below) {
+  return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(row, below),
+                                      _mm_set1_epi16(2)),
+                        2);
+}
+
+void ConvolveIntraBlockCopy2D_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int /*vertical_filter_index*/, const int /*horizontal_filter_id*/,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t pred_stride) {
+  const auto* src = static_cast<const uint16_t*>(reference);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  auto* dest = static_cast<uint16_t*>(prediction);
+  const ptrdiff_t dest_stride = pred_stride >> 1;
+
+  if (width >= 8) {
+    int x = 0;
+    do {
+      const uint16_t* src_x = src + x;
+      uint16_t* dest_x = dest + x;
+      __m128i row =
+          _mm_add_epi16(LoadUnaligned16(src_x), LoadUnaligned16(src_x + 1));
+      int y = height;
+      do {
+        src_x += src_stride;
+        const __m128i below =
+            _mm_add_epi16(LoadUnaligned16(src_x), LoadUnaligned16(src_x + 1));
+        StoreUnaligned16(dest_x, IntraBlockCopy2DResult(row, below));
+        dest_x += dest_stride;
+        row = below;
+      } while (--y != 0);
+      x += 8;
+    } while (x < width);
+  } else if (width == 4) {
+    __m128i row = _mm_add_epi16(LoadLo8(src), LoadLo8(src + 1));
+    int y = height;
+    do {
+      src += src_stride;
+      const __m128i below = _mm_add_epi16(LoadLo8(src), LoadLo8(src + 1));
+      StoreLo8(dest, IntraBlockCopy2DResult(row, below));
+      dest += dest_stride;
+      row = below;
+    } while (--y != 0);
+  } else {
+    assert(width == 2);
+    __m128i row = _mm_add_epi16(Load4(src), Load4(src + 1));
+    int y = height;
+    do {
+      src += src_stride;
+      const __m128i below = _mm_add_epi16(Load4(src), Load4(src + 1));
+      Store4(dest, IntraBlockCopy2DResult(row, below));
+      dest += dest_stride;
+      row = below;
+    } while (--y != 0);
+  }
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_SSE4_1(ConvolveHorizontal)
+  dsp->convolve[0][0][0][1] = ConvolveHorizontal_SSE4_1<10>;
+#endif
+#if DSP_ENABLED_10BPP_SSE4_1(ConvolveVertical)
+  dsp->convolve[0][0][1][0] = ConvolveVertical_SSE4_1<10>;
+#endif
+#if DSP_ENABLED_10BPP_SSE4_1(Convolve2D)
+  dsp->convolve[0][0][1][1] = Convolve2D_SSE4_1<10, /*is_compound=*/false>;
+#endif
+
+#if DSP_ENABLED_10BPP_SSE4_1(ConvolveCompoundCopy)
+  dsp->convolve[0][1][0][0] = ConvolveCompoundCopy_SSE4_1<10>;
+#endif
+#if DSP_ENABLED_10BPP_SSE4_1(ConvolveCompoundHorizontal)
+  dsp->convolve[0][1][0][1] = ConvolveCompoundHorizontal_SSE4_1<10>;
+#endif
+#if DSP_ENABLED_10BPP_SSE4_1(ConvolveCompoundVertical)
+  dsp->convolve[0][1][1][0] = ConvolveCompoundVertical_SSE4_1<10>;
+#endif
+#if DSP_ENABLED_10BPP_SSE4_1(ConvolveCompound2D)
+  dsp->convolve[0][1][1][1] = Convolve2D_SSE4_1<10, /*is_compound=*/true>;
+#endif
+
+#if DSP_ENABLED_10BPP_SSE4_1(ConvolveIntraBlockCopyHorizontal)
+  dsp->convolve[1][0][0][1] = ConvolveIntraBlockCopyHorizontal_SSE4_1;
+#endif
+#if DSP_ENABLED_10BPP_SSE4_1(ConvolveIntraBlockCopyVertical)
+  dsp->convolve[1][0][1][0] = ConvolveIntraBlockCopyVertical_SSE4_1;
+#endif
+#if DSP_ENABLED_10BPP_SSE4_1(ConvolveIntraBlockCopy2D)
+  dsp->convolve[1][0][1][1] = ConvolveIntraBlockCopy2D_SSE4_1;
+#endif
+
+#if DSP_ENABLED_10BPP_SSE4_1(ConvolveScale2D)
+  dsp->convolve_scale[0] = ConvolveScale2D_SSE4_1<10, /*is_compound=*/false>;
+#endif
+#if DSP_ENABLED_10BPP_SSE4_1(ConvolveCompoundScale2D)
+  dsp->convolve_scale[1] = ConvolveScale2D_SSE4_1<10, /*is_compound=*/true>;
+#endif
+}
+
+#if LIBGAV1_MAX_BITDEPTH == 12
+void Init12bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth12);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_12BPP_SSE4_1(ConvolveHorizontal)
+  dsp->convolve[0][0][0][1] = ConvolveHorizontal_SSE4_1<12>;
+#endif
+#if DSP_ENABLED_12BPP_SSE4_1(ConvolveVertical)
+  dsp->convolve[0][0][1][0] = ConvolveVertical_SSE4_1<12>;
+#endif
+#if DSP_ENABLED_12BPP_SSE4_1(Convolve2D)
+  dsp->convolve[0][0][1][1] = Convolve2D_SSE4_1<12, /*is_compound=*/false>;
+#endif
+
+#if DSP_ENABLED_12BPP_SSE4_1(ConvolveCompoundCopy)
+  dsp->convolve[0][1][0][0] = ConvolveCompoundCopy_SSE4_1<12>;
+#endif
+#if DSP_ENABLED_12BPP_SSE4_1(ConvolveCompoundHorizontal)
+  dsp->convolve[0][1][0][1] = ConvolveCompoundHorizontal_SSE4_1<12>;
+#endif
+#if DSP_ENABLED_12BPP_SSE4_1(ConvolveCompoundVertical)
+  dsp->convolve[0][1][1][0] = ConvolveCompoundVertical_SSE4_1<12>;
+#endif
+#if DSP_ENABLED_12BPP_SSE4_1(ConvolveCompound2D)
+  dsp->convolve[0][1][1][1] = Convolve2D_SSE4_1<12, /*is_compound=*/true>;
+#endif
+
+#if DSP_ENABLED_12BPP_SSE4_1(ConvolveIntraBlockCopyHorizontal)
+  dsp->convolve[1][0][0][1] = ConvolveIntraBlockCopyHorizontal_SSE4_1;
+#endif
+#if DSP_ENABLED_12BPP_SSE4_1(ConvolveIntraBlockCopyVertical)
+  dsp->convolve[1][0][1][0] = ConvolveIntraBlockCopyVertical_SSE4_1;
+#endif
+#if DSP_ENABLED_12BPP_SSE4_1(ConvolveIntraBlockCopy2D)
+  dsp->convolve[1][0][1][1] = ConvolveIntraBlockCopy2D_SSE4_1;
+#endif
+
+#if DSP_ENABLED_12BPP_SSE4_1(ConvolveScale2D)
+  dsp->convolve_scale[0] = ConvolveScale2D_SSE4_1<12, /*is_compound=*/false>;
+#endif
+#if DSP_ENABLED_12BPP_SSE4_1(ConvolveCompoundScale2D)
+  dsp->convolve_scale[1] = ConvolveScale2D_SSE4_1<12, /*is_compound=*/true>;
+#endif
+}
+#endif  // LIBGAV1_MAX_BITDEPTH == 12
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void ConvolveInit_SSE4_1() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+#if LIBGAV1_MAX_BITDEPTH == 12
+  high_bitdepth::Init12bpp();
+#endif
+}
 
 }  // namespace dsp
 }  // namespace libgav1
@@ -0,0 +1,310 @@
+// Copyright 2023 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "src/dsp/distance_weighted_blend.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace low_bitdepth {
+namespace {
+
+constexpr int kInterPostRoundBit = 4;
+constexpr int kInterPostRhsAdjust = 1 << (16 - kInterPostRoundBit - 1);
+
+// Blends 16 predictions. |prediction_0| and |prediction_1| are contiguous
+// with a stride of |width|, so narrow blocks cover several rows here.
+// See ComputeWeightedAverage8() in distance_weighted_blend_sse4.cc for the
+// derivation, which avoids lengthening to 32 bits.
+inline __m256i ComputeWeightedAverage16(
+    const int16_t* LIBGAV1_RESTRICT prediction_0,
+    const int16_t* LIBGAV1_RESTRICT prediction_1, const __m256i& weight) {
+  const __m256i pred_0 = LoadUnaligned32(prediction_0);
+  const __m256i pred_1 = LoadUnaligned32(prediction_1);
+  const __m256i diff = _mm256_slli_epi16(_mm256_sub_epi16(pred_0, pred_1), 1);
+  const __m256i weighted_diff = _mm256_mulhi_epi16(diff, weight);
+  const __m256i upscaled_average = _mm256_add_epi16(weighted_diff, pred_1);
+  const __m256i right_shift_prep = _mm256_set1_epi16(kInterPostRhsAdjust);
+  return _mm256_mulhrs_epi16(upscaled_average, right_shift_prep);
+}
+
+// Blends 32 predictions and packs them into 32 pixels in order.
+inline __m256i ComputeWeightedAverage32(
+    const int16_t* LIBGAV1_RESTRICT prediction_0,
+    const int16_t* LIBGAV1_RESTRICT prediction_1, const __m256i& weight) {
+  const __m256i res_0 =
+      ComputeWeightedAverage16(prediction_0, prediction_1, weight);
+  const __m256i res_1 =
+      ComputeWeightedAverage16(prediction_0 + 16, prediction_1 + 16, weight);
+  // packus works within 128-bit lanes; restore the row order.
+  return _mm256_permute4x64_epi64(_mm256_packus_epi16(res_0, res_1), 0xd8);
+}
+
+void DistanceWeightedBlend_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                                const void* LIBGAV1_RESTRICT prediction_1,
+                                const uint8_t weight_0,
+                                const uint8_t /*weight_1*/, const int width,
+                                const int height,
+                                void* LIBGAV1_RESTRICT const dest,
+                                const ptrdiff_t dest_stride) {
+  auto* dst = static_cast<uint8_t*>(dest);
+  const auto* pred_0 = static_cast<const int16_t*>(prediction_0);
+  const auto* pred_1 = static_cast<const int16_t*>(prediction_1);
+  // Upscale the weight for mulhi.
+  const __m256i weight = _mm256_set1_epi16(weight_0 << 11);
+  int y = height;
+
+  if (width == 4) {
+    do {
+      const __m256i res = ComputeWeightedAverage16(pred_0, pred_1, weight);
+      const __m128i result_pixels = _mm_packus_epi16(
+          _mm256_castsi256_si128(res), _mm256_extracti128_si256(res, 1));
+      Store4(dst, result_pixels);
+      dst += dest_stride;
+      const int result_1 = _mm_extract_epi32(result_pixels, 1);
+      memcpy(dst, &result_1, sizeof(result_1));
+      dst += dest_stride;
+      const int result_2 = _mm_extract_epi32(result_pixels, 2);
+      memcpy(dst, &result_2, sizeof(result_2));
+      dst += dest_stride;
+      const int result_3 = _mm_extract_epi32(result_pixels, 3);
+      memcpy(dst, &result_3, sizeof(result_3));
+      dst += dest_stride;
+      pred_0 += 16;
+      pred_1 += 16;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 8) {
+    do {
+      const __m256i res = ComputeWeightedAverage32(pred_0, pred_1, weight);
+      const __m128i res_lo = _mm256_castsi256_si128(res);
+      const __m128i res_hi = _mm256_extracti128_si256(res, 1);
+      StoreLo8(dst, res_lo);
+      StoreHi8(dst + dest_stride, res_lo);
+      StoreLo8(dst + 2 * dest_stride, res_hi);
+      StoreHi8(dst + 3 * dest_stride, res_hi);
+      dst += dest_stride << 2;
+      pred_0 += 32;
+      pred_1 += 32;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 16) {
+    do {
+      const __m256i res = ComputeWeightedAverage32(pred_0, pred_1, weight);
+      StoreUnaligned16(dst, _mm256_castsi256_si128(res));
+      StoreUnaligned16(dst + dest_stride, _mm256_extracti128_si256(res, 1));
+      dst += dest_stride << 1;
+      pred_0 += 32;
+      pred_1 += 32;
+      y -= 2;
+    } while (y != 0);
+    return;
+  }
+
+  do {
+    int x = 0;
+    do {
+      StoreUnaligned32(
+          dst + x, ComputeWeightedAverage32(pred_0 + x, pred_1 + x, weight));
+      x += 32;
+    } while (x < width);
+    dst += dest_stride;
+    pred_0 += width;
+    pred_1 += width;
+  } while (--y != 0);
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX2(DistanceWeightedBlend)
+  dsp->distance_weighted_blend = DistanceWeightedBlend_AVX2;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+constexpr int kMax10bppSample = (1 << 10) - 1;
+constexpr int kInterPostRoundBit = 4;
+
+// Blends 16 predictions. The predictions use the full 16-bit range, so they
+// are biased into the signed range and weighted in pairs with madd. Since
+// weight_0 + weight_1 = 16 the bias contributes 16 * 32768, which is folded
+// into |offset| together with the rounding and compound offsets.
+inline __m256i ComputeWeightedAverage16(
+    const uint16_t* LIBGAV1_RESTRICT prediction_0,
+    const uint16_t* LIBGAV1_RESTRICT prediction_1, const __m256i& weights,
+    const __m256i& sign_bias, const __m256i& offset) {
+  const __m256i pred_0 =
+      _mm256_xor_si256(LoadUnaligned32(prediction_0), sign_bias);
+  const __m256i pred_1 =
+      _mm256_xor_si256(LoadUnaligned32(prediction_1), sign_bias);
+  const __m256i sum_lo =
+      _mm256_madd_epi16(_mm256_unpacklo_epi16(pred_0, pred_1), weights);
+  const __m256i sum_hi =
+      _mm256_madd_epi16(_mm256_unpackhi_epi16(pred_0, pred_1), weights);
+  const __m256i res_lo = _mm256_srai_epi32(_mm256_add_epi32(sum_lo, offset),
+                                           kInterPostRoundBit + 4);
+  const __m256i res_hi = _mm256_srai_epi32(_mm256_add_epi32(sum_hi, offset),
+                                           kInterPostRoundBit + 4);
+  return _mm256_min_epu16(_mm256_packus_epi32(res_lo, res_hi),
+                          _mm256_set1_epi16(kMax10bppSample));
+}
+
+void DistanceWeightedBlend10bpp_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                                     const void* LIBGAV1_RESTRICT prediction_1,
+                                     const uint8_t weight_0,
+                                     const uint8_t weight_1, const int width,
+                                     const int height,
+                                     void* LIBGAV1_RESTRICT const dest,
+                                     const ptrdiff_t dest_stride) {
+  auto* dst = static_cast<uint16_t*>(dest);
+  const ptrdiff_t dst_stride = dest_stride / sizeof(dst[0]);
+  const auto* pred_0 = static_cast<const uint16_t*>(prediction_0);
+  const auto* pred_1 = static_cast<const uint16_t*>(prediction_1);
+  const __m256i weights = _mm256_set1_epi32(weight_0 | (weight_1 << 16));
+  const __m256i sign_bias = _mm256_set1_epi16(static_cast<int16_t>(0x8000));
+  const __m256i offset =
+      _mm256_set1_epi32((16 << 15) + (1 << ((kInterPostRoundBit + 4) - 1)) -
+                        (kCompoundOffset << 4));
+  int y = height;
+
+  if (width == 4) {
+    do {
+      const __m256i res = ComputeWeightedAverage16(pred_0, pred_1, weights,
+                                                   sign_bias, offset);
+      const __m128i res_lo = _mm256_castsi256_si128(res);
+      const __m128i res_hi = _mm256_extracti128_si256(res, 1);
+      StoreLo8(dst, res_lo);
+      StoreHi8(dst + dst_stride, res_lo);
+      StoreLo8(dst + 2 * dst_stride, res_hi);
+      StoreHi8(dst + 3 * dst_stride, res_hi);
+      dst += dst_stride << 2;
+      pred_0 += 16;
+      pred_1 += 16;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 8) {
+    do {
+      const __m256i res_0 = ComputeWeightedAverage16(pred_0, pred_1, weights,
+                                                     sign_bias, offset);
+      const __m256i res_1 = ComputeWeightedAverage16(
+          pred_0 + 16, pred_1 + 16, weights, sign_bias, offset);
+      StoreUnaligned16(dst, _mm256_castsi256_si128(res_0));
+      StoreUnaligned16(dst + dst_stride, _mm256_extracti128_si256(res_0, 1));
+      StoreUnaligned16(dst + 2 * dst_stride, _mm256_castsi256_si128(res_1));
+      StoreUnaligned16(dst + 3 * dst_stride,
+                       _mm256_extracti128_si256(res_1, 1));
+      dst += dst_stride << 2;
+      pred_0 += 32;
+      pred_1 += 32;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 16) {
+    do {
+      StoreUnaligned32(dst, ComputeWeightedAverage16(pred_0, pred_1, weights,
+                                                     sign_bias, offset));
+      StoreUnaligned32(dst + dst_stride,
+                       ComputeWeightedAverage16(pred_0 + 16, pred_1 + 16,
+                                                weights, sign_bias, offset));
+      dst += dst_stride << 1;
+      pred_0 += 32;
+      pred_1 += 32;
+      y -= 2;
+    } while (y != 0);
+    return;
+  }
+
+  do {
+    int x = 0;
+    do {
+      StoreUnaligned32(dst + x,
+                       ComputeWeightedAverage16(pred_0 + x, pred_1 + x,
+                                                weights, sign_bias, offset));
+      StoreUnaligned32(
+          dst + x + 16,
+          ComputeWeightedAverage16(pred_0 + x + 16, pred_1 + x + 16, weights,
+                                   sign_bias, offset));
+      x += 32;
+    } while (x < width);
+    dst += dst_stride;
+    pred_0 += width;
+    pred_1 += width;
+  } while (--y != 0);
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_AVX2(DistanceWeightedBlend)
+  dsp->distance_weighted_blend = DistanceWeightedBlend10bpp_AVX2;
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void DistanceWeightedBlendInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX2
+
+namespace libgav1 {
+namespace dsp {
+
+void DistanceWeightedBlendInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
@@ -0,0 +1,560 @@
+// Copyright 2023 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/film_grain.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/film_grain_common.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/array_2d.h"
+#include "src/utils/common.h"
+#include "src/utils/compiler_attributes.h"
+#include "src/utils/constants.h"
+#include "src/utils/types.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace film_grain {
+namespace {
+
+// Load 16 values from source, widening to int16_t intermediate value size.
+// The function is overloaded for each type and bitdepth for simplicity.
+inline __m256i LoadSource(const int8_t* src) {
+  return _mm256_cvtepi8_epi16(LoadUnaligned16(src));
+}
+
+// Load 16 values from source, widening to int16_t intermediate value size.
+inline __m256i LoadSource(const uint8_t* src) {
+  return _mm256_cvtepu8_epi16(LoadUnaligned16(src));
+}
+
+// Load 8 values from source into the low half of the result, widening to
+// int16_t intermediate value size.
+inline __m256i LoadSourceHalf(const int8_t* src) {
+  return _mm256_cvtepi8_epi16(LoadLo8(src));
+}
+
+// Store 16 values to dest, narrowing to uint8_t from int16_t intermediate
+// value.
+inline void StoreUnsigned(uint8_t* dest, const __m256i data) {
+  const __m256i packed = _mm256_packus_epi16(data, data);
+  StoreUnaligned16(dest, _mm256_castsi256_si128(
+                             _mm256_permute4x64_epi64(packed, 0xd8)));
+}
+
+// Store 16 values to dest, narrowing to int8_t from int16_t intermediate value.
+inline void StoreSigned(int8_t* dest, const __m256i data) {
+  const __m256i packed = _mm256_packs_epi16(data, data);
+  StoreUnaligned16(dest, _mm256_castsi256_si128(
+                             _mm256_permute4x64_epi64(packed, 0xd8)));
+}
+
+// Store the 8 values in the low half of |data| to dest, narrowing to int8_t
+// from int16_t intermediate value.
+inline void StoreSignedHalf(int8_t* dest, const __m256i data) {
+  StoreLo8(dest, _mm256_castsi256_si128(_mm256_packs_epi16(data, data)));
+}
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+// Load 16 values from source.
+inline __m256i LoadSource(const int16_t* src) { return LoadUnaligned32(src); }
+
+// Load 16 values from source.
+inline __m256i LoadSource(const uint16_t* src) { return LoadUnaligned32(src); }
+
+// Load 8 values from source into the low half of the result.
+inline __m256i LoadSourceHalf(const int16_t* src) {
+  return _mm256_castsi128_si256(LoadUnaligned16(src));
+}
+
+// Store 16 values to dest.
+inline void StoreUnsigned(uint16_t* dest, const __m256i data) {
+  StoreUnaligned32(dest, data);
+}
+
+// Store 16 values to dest.
+inline void StoreSigned(int16_t* dest, const __m256i data) {
+  StoreUnaligned32(dest, data);
+}
+
+// Store the 8 values in the low half of |data| to dest.
+inline void StoreSignedHalf(int16_t* dest, const __m256i data) {
+  StoreUnaligned16(dest, _mm256_castsi256_si128(data));
+}
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+// For BlendNoiseWithImageChromaWithCfl, only |subsampling_x| is needed.
+inline __m256i GetAverageLuma(const uint8_t* const luma, int subsampling_x) {
+  if (subsampling_x != 0) {
+    // Averaging the even and odd bytes gives the rounded average of each
+    // horizontal pair, i.e. RightShiftWithRounding(a + b, 1).
+    const __m256i src = LoadUnaligned32(luma);
+    const __m256i even = _mm256_and_si256(src, _mm256_set1_epi16(0x00ff));
+    const __m256i odd = _mm256_srli_epi16(src, 8);
+    return _mm256_avg_epu16(even, odd);
+  }
+  return _mm256_cvtepu8_epi16(LoadUnaligned16(luma));
+}
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+// For BlendNoiseWithImageChromaWithCfl, only |subsampling_x| is needed.
+inline __m256i GetAverageLuma(const uint16_t* const luma, int subsampling_x) {
+  if (subsampling_x != 0) {
+    const __m256i mask = _mm256_set1_epi32(0xffff);
+    const __m256i src0 = LoadUnaligned32(luma);
+    const __m256i src1 = LoadUnaligned32(luma + 16);
+    const __m256i average0 = _mm256_avg_epu16(_mm256_and_si256(src0, mask),
+                                              _mm256_srli_epi32(src0, 16));
+    const __m256i average1 = _mm256_avg_epu16(_mm256_and_si256(src1, mask),
+                                              _mm256_srli_epi32(src1, 16));
+    return _mm256_permute4x64_epi64(_mm256_packus_epi32(average0, average1),
+                                    0xd8);
+  }
+  return LoadUnaligned32(luma);
+}
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+inline __m256i Clip3(const __m256i value, const __m256i low,
+                     const __m256i high) {
+  const __m256i clipped_to_ceiling = _mm256_min_epi16(high, value);
+  return _mm256_max_epi16(low, clipped_to_ceiling);
+}
+
+// Looks up the scaling factors of the 16 pixel values in |source| with two
+// 8-lane gathers. Each lane fetches 32 bits, i.e. the requested int16_t entry
+// and its successor, which is masked off. The table padding keeps the
+// successor of the largest valid index in bounds.
+template <int bitdepth>
+inline __m256i GetScalingFactors(const int16_t* scaling_lut,
+                                 const __m256i source) {
+  static_assert(bitdepth <= kBitdepth10,
+                "AVX2 Film Grain is not yet implemented for 12bpp.");
+  const auto* const table = reinterpret_cast<const int*>(scaling_lut);
+  const __m256i index_lo =
+      _mm256_cvtepu16_epi32(_mm256_castsi256_si128(source));
+  const __m256i index_hi =
+      _mm256_cvtepu16_epi32(_mm256_extracti128_si256(source, 1));
+  const __m256i mask = _mm256_set1_epi32(0xffff);
+  const __m256i scaling_lo =
+      _mm256_and_si256(_mm256_i32gather_epi32(table, index_lo, 2), mask);
+  const __m256i scaling_hi =
+      _mm256_and_si256(_mm256_i32gather_epi32(table, index_hi, 2), mask);
+  // The scaling values are in [0, 255], so the saturating pack is lossless.
+  return _mm256_permute4x64_epi64(_mm256_packus_epi32(scaling_lo, scaling_hi),
+                                  0xd8);
+}
+
+// |scaling_shift| is in range [8,11].
+inline __m256i ScaleNoise(const __m256i noise, const __m256i scaling,
+                          const __m128i scaling_shift) {
+  const __m256i shifted_scale_factors =
+      _mm256_sll_epi16(scaling, scaling_shift);
+  return _mm256_mulhrs_epi16(noise, shifted_scale_factors);
+}
+
+// Returns |orig| plus the noise at |noise_image_cursor|, scaled by the lookup
+// of |scaling_index| in |scaling_lut|.
+template <int bitdepth, typename GrainType>
+inline __m256i AddScaledNoise(const __m256i orig, const __m256i scaling_index,
+                              const int16_t* scaling_lut,
+                              const GrainType* noise_image_cursor,
+                              const __m128i scaling_shift) {
+  const __m256i scaling =
+      GetScalingFactors<bitdepth>(scaling_lut, scaling_index);
+  const __m256i noise =
+      ScaleNoise(LoadSource(noise_image_cursor), scaling, scaling_shift);
+  return _mm256_add_epi16(orig, noise);
+}
+
+template <int bitdepth, typename GrainType, typename Pixel>
+void BlendNoiseWithImageLuma_AVX2(
+    const void* LIBGAV1_RESTRICT noise_image_ptr, int min_value, int max_luma,
+    int scaling_shift, int width, int height, int start_height,
+    const int16_t* scaling_lut_y, const void* source_plane_y,
+    ptrdiff_t source_stride_y, void* dest_plane_y, ptrdiff_t dest_stride_y) {
+  const auto* noise_image =
+      static_cast<const Array2D<GrainType>*>(noise_image_ptr);
+  const auto* in_y_row = static_cast<const Pixel*>(source_plane_y);
+  source_stride_y /= sizeof(Pixel);
+  auto* out_y_row = static_cast<Pixel*>(dest_plane_y);
+  dest_stride_y /= sizeof(Pixel);
+  const __m256i floor = _mm256_set1_epi16(min_value);
+  const __m256i ceiling = _mm256_set1_epi16(max_luma);
+  const int safe_width = width & ~15;
+  const __m128i derived_scaling_shift = _mm_cvtsi32_si128(15 - scaling_shift);
+  int y = 0;
+  do {
+    const GrainType* const noise_row = noise_image[kPlaneY][y + start_height];
+    int x = 0;
+    for (; x < safe_width; x += 16) {
+      const __m256i orig = LoadSource(&in_y_row[x]);
+      const __m256i blended = AddScaledNoise<bitdepth>(
+          orig, orig, scaling_lut_y, &noise_row[x], derived_scaling_shift);
+      StoreUnsigned(&out_y_row[x], Clip3(blended, floor, ceiling));
+    }
+
+    if (x < width) {
+      // The remaining pixels are blended in a local buffer to avoid reading
+      // and writing past the end of the row. The unused entries are zeroed to
+      // keep their scaling lookups inside the table.
+      alignas(32) Pixel luma_buffer[16];
+      memset(luma_buffer, 0, sizeof(luma_buffer));
+      const int valid_range = width - x;
+      assert(valid_range < 16);
+      memcpy(luma_buffer, &in_y_row[x], valid_range * sizeof(in_y_row[0]));
+      const __m256i orig = LoadSource(luma_buffer);
+      const __m256i blended = AddScaledNoise<bitdepth>(
+          orig, orig, scaling_lut_y, &noise_row[x], derived_scaling_shift);
+      StoreUnsigned(luma_buffer, Clip3(blended, floor, ceiling));
+      memcpy(&out_y_row[x], luma_buffer, valid_range * sizeof(out_y_row[0]));
+    }
+    in_y_row += source_stride_y;
+    out_y_row += dest_stride_y;
+  } while (++y < height);
+}
+
+// When |use_cfl| is false, the scaling index is the combination of the
+// average luma and the original chroma described in section 7.18.3.5.
+// |offset| is the chroma offset upscaled to be added before the downshift of
+// the 32-bit products, and |weights| packs the luma and chroma multipliers for
+// _mm256_madd_epi16.
+template <int bitdepth, bool use_cfl, typename GrainType>
+inline __m256i BlendChromaVals(const int16_t* scaling_lut, const __m256i orig,
+                               const GrainType* noise_image_cursor,
+                               const __m256i average_luma,
+                               const __m128i scaling_shift,
+                               const __m256i offset, const __m256i weights) {
+  if (use_cfl) {
+    return AddScaledNoise<bitdepth>(orig, average_luma, scaling_lut,
+                                    noise_image_cursor, scaling_shift);
+  }
+  const __m256i combined_lo =
+      _mm256_madd_epi16(_mm256_unpacklo_epi16(average_luma, orig), weights);
+  const __m256i combined_hi =
+      _mm256_madd_epi16(_mm256_unpackhi_epi16(average_luma, orig), weights);
+  const __m256i merged_lo =
+      _mm256_srai_epi32(_mm256_add_epi32(combined_lo, offset), 6);
+  const __m256i merged_hi =
+      _mm256_srai_epi32(_mm256_add_epi32(combined_hi, offset), 6);
+  // The unpack and pack operate within each 128-bit lane, so the pixel order
+  // is preserved.
+  const __m256i merged =
+      _mm256_min_epu16(_mm256_packus_epi32(merged_lo, merged_hi),
+                       _mm256_set1_epi16((1 << bitdepth) - 1));
+  return AddScaledNoise<bitdepth>(orig, merged, scaling_lut,
+                                  noise_image_cursor, scaling_shift);
+}
+
+template <int bitdepth, bool use_cfl, typename GrainType, typename Pixel>
+LIBGAV1_ALWAYS_INLINE void BlendChromaPlane_AVX2(
+    const Array2D<GrainType>& noise_image, int min_value, int max_chroma,
+    int width, int height, int start_height, int subsampling_x,
+    int subsampling_y, int scaling_shift, int chroma_offset,
+    int chroma_multiplier, int luma_multiplier, const int16_t* scaling_lut,
+    const Pixel* LIBGAV1_RESTRICT in_y_row, ptrdiff_t source_stride_y,
+    const Pixel* in_chroma_row, ptrdiff_t source_stride_chroma,
+    Pixel* out_chroma_row, ptrdiff_t dest_stride) {
+  const __m256i floor = _mm256_set1_epi16(min_value);
+  const __m256i ceiling = _mm256_set1_epi16(max_chroma);
+
+  const int chroma_height = (height + subsampling_y) >> subsampling_y;
+  const int chroma_width = (width + subsampling_x) >> subsampling_x;
+  // |chroma_width| is rounded up. If |width| is odd, then the final luma pixel
+  // will need to be guarded from overread, even if |chroma_width| is a
+  // multiple of 16.
+  const int safe_chroma_width = (chroma_width - (width & 1)) & ~15;
+  // The offset is added before downshifting, so it has to be upscaled by 6
+  // bits, plus the bitdepth adjustment.
+  const __m256i offset = _mm256_set1_epi32(
+      LeftShift(chroma_offset, 6 + bitdepth - kBitdepth8));
+  const __m256i multipliers = _mm256_set1_epi32(
+      LeftShift(chroma_multiplier, 16) | (luma_multiplier & 0xFFFF));
+  const __m128i derived_scaling_shift = _mm_cvtsi32_si128(15 - scaling_shift);
+
+  assert(start_height % 2 == 0);
+  start_height >>= subsampling_y;
+  int y = 0;
+  do {
+    const GrainType* const noise_row = noise_image[y + start_height];
+    int x = 0;
+    for (; x < safe_chroma_width; x += 16) {
+      const int luma_x = x << subsampling_x;
+      const __m256i average_luma =
+          GetAverageLuma(&in_y_row[luma_x], subsampling_x);
+      const __m256i orig_chroma = LoadSource(&in_chroma_row[x]);
+      const __m256i blended = BlendChromaVals<bitdepth, use_cfl>(
+          scaling_lut, orig_chroma, &noise_row[x], average_luma,
+          derived_scaling_shift, offset, multipliers);
+      StoreUnsigned(&out_chroma_row[x], Clip3(blended, floor, ceiling));
+    }
+
+    if (x < chroma_width) {
+      // Begin right edge iteration. Same as the normal iterations, but the
+      // |average_luma| computation requires a duplicated luma value at the
+      // end, and the results are written through a local buffer to avoid
+      // writing past the end of the row.
+      alignas(32) Pixel luma_buffer[32];
+      alignas(32) Pixel chroma_buffer[16];
+      memset(luma_buffer, 0, sizeof(luma_buffer));
+      memset(chroma_buffer, 0, sizeof(chroma_buffer));
+      const int luma_x = x << subsampling_x;
+      const int valid_range = width - luma_x;
+      assert(valid_range < 32);
+      memcpy(luma_buffer, &in_y_row[luma_x], valid_range * sizeof(in_y_row[0]));
+      luma_buffer[valid_range] = in_y_row[width - 1];
+      const int valid_range_chroma = chroma_width - x;
+      assert(valid_range_chroma <= 16);
+      memcpy(chroma_buffer, &in_chroma_row[x],
+             valid_range_chroma * sizeof(in_chroma_row[0]));
+
+      const __m256i average_luma = GetAverageLuma(luma_buffer, subsampling_x);
+      const __m256i orig_chroma = LoadSource(chroma_buffer);
+      const __m256i blended = BlendChromaVals<bitdepth, use_cfl>(
+          scaling_lut, orig_chroma, &noise_row[x], average_luma,
+          derived_scaling_shift, offset, multipliers);
+      StoreUnsigned(chroma_buffer, Clip3(blended, floor, ceiling));
+      memcpy(&out_chroma_row[x], chroma_buffer,
+             valid_range_chroma * sizeof(out_chroma_row[0]));
+      // End of right edge iteration.
+    }
+
+    in_y_row += source_stride_y << subsampling_y;
+    in_chroma_row += source_stride_chroma;
+    out_chroma_row += dest_stride;
+  } while (++y < chroma_height);
+}
+
+// |use_cfl| is params_.chroma_scaling_from_luma. When it is true,
+// scaling_lut_u == scaling_lut_v == scaling_lut_y and the chroma offset and
+// multipliers are unused.
+template <int bitdepth, bool use_cfl, typename GrainType, typename Pixel>
+void BlendNoiseWithImageChroma_AVX2(
+    Plane plane, const FilmGrainParams& params,
+    const void* LIBGAV1_RESTRICT noise_image_ptr, int min_value, int max_chroma,
+    int width, int height, int start_height, int subsampling_x,
+    int subsampling_y, const int16_t* scaling_lut,
+    const void* LIBGAV1_RESTRICT source_plane_y, ptrdiff_t source_stride_y,
+    const void* source_plane_uv, ptrdiff_t source_stride_uv,
+    void* dest_plane_uv, ptrdiff_t dest_stride_uv) {
+  assert(plane == kPlaneU || plane == kPlaneV);
+  const auto* noise_image =
+      static_cast<const Array2D<GrainType>*>(noise_image_ptr);
+  const auto* in_y = static_cast<const Pixel*>(source_plane_y);
+  source_stride_y /= sizeof(Pixel);
+  const auto* in_uv = static_cast<const Pixel*>(source_plane_uv);
+  source_stride_uv /= sizeof(Pixel);
+  auto* out_uv = static_cast<Pixel*>(dest_plane_uv);
+  dest_stride_uv /= sizeof(Pixel);
+
+  const int offset = (plane == kPlaneU) ? params.u_offset : params.v_offset;
+  const int luma_multiplier =
+      (plane == kPlaneU) ? params.u_luma_multiplier : params.v_luma_multiplier;
+  const int multiplier =
+      (plane == kPlaneU) ? params.u_multiplier : params.v_multiplier;
+  BlendChromaPlane_AVX2<bitdepth, use_cfl, GrainType, Pixel>(
+      noise_image[plane], min_value, max_chroma, width, height, start_height,
+      subsampling_x, subsampling_y, params.chroma_scaling, offset, multiplier,
+      luma_multiplier, scaling_lut, in_y, source_stride_y, in_uv,
+      source_stride_uv, out_uv, dest_stride_uv);
+}
+
+template <int bitdepth>
+inline __m256i BlendOverlap(const __m256i grain, const __m256i old,
+                            const __m256i grain_coeff,
+                            const __m256i old_coeff) {
+  // Maximum magnitude of the sum is 512 * (27 + 17) = 0x5800.
+  const __m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(grain, grain_coeff),
+                                       _mm256_mullo_epi16(old, old_coeff));
+  return Clip3(RightShiftWithRounding_S16(sum, 5),
+               _mm256_set1_epi16(GetGrainMin<bitdepth>()),
+               _mm256_set1_epi16(GetGrainMax<bitdepth>()));
+}
+
+template <int bitdepth, typename GrainType>
+inline void WriteOverlapLine_AVX2(
+    const GrainType* LIBGAV1_RESTRICT noise_stripe_row,
+    const GrainType* LIBGAV1_RESTRICT noise_stripe_row_prev, int plane_width,
+    const __m256i grain_coeff, const __m256i old_coeff,
+    GrainType* LIBGAV1_RESTRICT noise_image_row) {
+  int x = 0;
+  for (; x + 16 <= plane_width; x += 16) {
+    const __m256i grain = LoadSource(noise_stripe_row + x);
+    const __m256i old = LoadSource(noise_stripe_row_prev + x);
+    StoreSigned(noise_image_row + x,
+                BlendOverlap<bitdepth>(grain, old, grain_coeff, old_coeff));
+  }
+  for (; x < plane_width; x += 8) {
+    // Note that these reads may exceed noise_stripe_row's width by up to 7
+    // values, and the write may exceed noise_image_row's width by up to 7
+    // values.
+    const __m256i grain = LoadSourceHalf(noise_stripe_row + x);
+    const __m256i old = LoadSourceHalf(noise_stripe_row_prev + x);
+    StoreSignedHalf(noise_image_row + x,
+                    BlendOverlap<bitdepth>(grain, old, grain_coeff, old_coeff));
+  }
+}
+
+template <int bitdepth, typename GrainType>
+void ConstructNoiseImageOverlap_AVX2(
+    const void* LIBGAV1_RESTRICT noise_stripes_buffer, int width, int height,
+    int subsampling_x, int subsampling_y,
+    void* LIBGAV1_RESTRICT noise_image_buffer) {
+  const auto* noise_stripes =
+      static_cast<const Array2DView<GrainType>*>(noise_stripes_buffer);
+  auto* noise_image = static_cast<Array2D<GrainType>*>(noise_image_buffer);
+  const int plane_width = (width + subsampling_x) >> subsampling_x;
+  const int plane_height = (height + subsampling_y) >> subsampling_y;
+  const int stripe_height = 32 >> subsampling_y;
+  const int stripe_mask = stripe_height - 1;
+  int y = stripe_height;
+  int luma_num = 1;
+  if (subsampling_y == 0) {
+    const __m256i first_row_grain_coeff = _mm256_set1_epi16(17);
+    const __m256i first_row_old_coeff = _mm256_set1_epi16(27);
+    const __m256i second_row_grain_coeff = first_row_old_coeff;
+    const __m256i second_row_old_coeff = first_row_grain_coeff;
+    for (; y < (plane_height & ~stripe_mask); ++luma_num, y += stripe_height) {
+      const GrainType* noise_stripe = (*noise_stripes)[luma_num];
+      const GrainType* noise_stripe_prev = (*noise_stripes)[luma_num - 1];
+      WriteOverlapLine_AVX2<bitdepth>(
+          noise_stripe, &noise_stripe_prev[32 * plane_width], plane_width,
+          first_row_grain_coeff, first_row_old_coeff, (*noise_image)[y]);
+
+      WriteOverlapLine_AVX2<bitdepth>(
+          &noise_stripe[plane_width],
+          &noise_stripe_prev[(32 + 1) * plane_width], plane_width,
+          second_row_grain_coeff, second_row_old_coeff, (*noise_image)[y + 1]);
+    }
+    // Either one partial stripe remains (remaining_height > 0),
+    // OR image is less than one stripe high (remaining_height < 0),
+    // OR all stripes are completed (remaining_height == 0).
+    const int remaining_height = plane_height - y;
+    if (remaining_height <= 0) {
+      return;
+    }
+    const GrainType* noise_stripe = (*noise_stripes)[luma_num];
+    const GrainType* noise_stripe_prev = (*noise_stripes)[luma_num - 1];
+    WriteOverlapLine_AVX2<bitdepth>(
+        noise_stripe, &noise_stripe_prev[32 * plane_width], plane_width,
+        first_row_grain_coeff, first_row_old_coeff, (*noise_image)[y]);
+
+    if (remaining_height > 1) {
+      WriteOverlapLine_AVX2<bitdepth>(
+          &noise_stripe[plane_width],
+          &noise_stripe_prev[(32 + 1) * plane_width], plane_width,
+          second_row_grain_coeff, second_row_old_coeff, (*noise_image)[y + 1]);
+    }
+  } else {  // subsampling_y == 1
+    const __m256i first_row_grain_coeff = _mm256_set1_epi16(22);
+    const __m256i first_row_old_coeff = _mm256_set1_epi16(23);
+    for (; y < plane_height; ++luma_num, y += stripe_height) {
+      const GrainType* noise_stripe = (*noise_stripes)[luma_num];
+      const GrainType* noise_stripe_prev = (*noise_stripes)[luma_num - 1];
+      WriteOverlapLine_AVX2<bitdepth>(
+          noise_stripe, &noise_stripe_prev[16 * plane_width], plane_width,
+          first_row_grain_coeff, first_row_old_coeff, (*noise_image)[y]);
+    }
+  }
+}
+
+}  // namespace
+
+namespace low_bitdepth {
+namespace {
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX2(FilmGrainConstructNoiseImageOverlap)
+  dsp->film_grain.construct_noise_image_overlap =
+      ConstructNoiseImageOverlap_AVX2<kBitdepth8, int8_t>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(FilmGrainBlendNoiseLuma)
+  dsp->film_grain.blend_noise_luma =
+      BlendNoiseWithImageLuma_AVX2<kBitdepth8, int8_t, uint8_t>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(FilmGrainBlendNoiseChroma)
+  dsp->film_grain.blend_noise_chroma[0] =
+      BlendNoiseWithImageChroma_AVX2<kBitdepth8, false, int8_t, uint8_t>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(FilmGrainBlendNoiseChromaWithCfl)
+  dsp->film_grain.blend_noise_chroma[1] =
+      BlendNoiseWithImageChroma_AVX2<kBitdepth8, true, int8_t, uint8_t>;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_AVX2(FilmGrainConstructNoiseImageOverlap)
+  dsp->film_grain.construct_noise_image_overlap =
+      ConstructNoiseImageOverlap_AVX2<kBitdepth10, int16_t>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(FilmGrainBlendNoiseLuma)
+  dsp->film_grain.blend_noise_luma =
+      BlendNoiseWithImageLuma_AVX2<kBitdepth10, int16_t, uint16_t>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(FilmGrainBlendNoiseChroma)
+  dsp->film_grain.blend_noise_chroma[0] =
+      BlendNoiseWithImageChroma_AVX2<kBitdepth10, false, int16_t, uint16_t>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(FilmGrainBlendNoiseChromaWithCfl)
+  dsp->film_grain.blend_noise_chroma[1] =
+      BlendNoiseWithImageChroma_AVX2<kBitdepth10, true, int16_t, uint16_t>;
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+}  // namespace film_grain
+
+void FilmGrainInit_AVX2() {
+  film_grain::low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  film_grain::high_bitdepth::Init10bpp();
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX2
+
+namespace libgav1 {
+namespace dsp {
+
+void FilmGrainInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
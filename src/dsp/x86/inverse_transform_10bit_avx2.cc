@@ -0,0 +1,2732 @@
+// Copyright 2023 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/inverse_transform.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2 && LIBGAV1_MAX_BITDEPTH >= 10
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/array_2d.h"
+#include "src/utils/common.h"
+#include "src/utils/compiler_attributes.h"
+#include "src/utils/constants.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+// Include the constants and utility functions inside the anonymous namespace.
+#include "src/dsp/inverse_transform.inc"
+
+//------------------------------------------------------------------------------
+
+// Transposes the 4x4 blocks held in each 128-bit lane of |in|.
+LIBGAV1_ALWAYS_INLINE void Transpose4x4(const __m256i in[4], __m256i out[4]) {
+  // in (per lane):
+  // 00 01 02 03
+  // 10 11 12 13
+  // 20 21 22 23
+  // 30 31 32 33
+
+  // 00 10 01 11
+  // 02 12 03 13
+  // 20 30 21 31
+  // 22 32 23 33
+  const __m256i a0 = _mm256_unpacklo_epi32(in[0], in[1]);
+  const __m256i a1 = _mm256_unpackhi_epi32(in[0], in[1]);
+  const __m256i b0 = _mm256_unpacklo_epi32(in[2], in[3]);
+  const __m256i b1 = _mm256_unpackhi_epi32(in[2], in[3]);
+  out[0] = _mm256_unpacklo_epi64(a0, b0);
+  out[1] = _mm256_unpackhi_epi64(a0, b0);
+  out[2] = _mm256_unpacklo_epi64(a1, b1);
+  out[3] = _mm256_unpackhi_epi64(a1, b1);
+  // out (per lane):
+  // 00 10 20 30
+  // 01 11 21 31
+  // 02 12 22 32
+  // 03 13 23 33
+}
+
+//------------------------------------------------------------------------------
+// The row transforms process 8 rows at a time. Rows 0-3 are held in the low
+// 128 bits of each register and rows 4-7 in the high 128 bits, which allows the
+// 4x4 transposes to be done per lane. When |is_half| is true only rows 0-3 are
+// valid.
+template <int load_count>
+LIBGAV1_ALWAYS_INLINE void LoadRows(const int32_t* LIBGAV1_RESTRICT src,
+                                    int32_t stride, __m256i* x,
+                                    const bool is_half) {
+  static_assert(load_count % 4 == 0, "");
+  for (int idx = 0; idx < load_count; idx += 4) {
+    __m256i v[4];
+    for (int i = 0; i < 4; ++i) {
+      const __m128i lo = LoadUnaligned16(&src[i * stride + idx]);
+      v[i] = is_half ? _mm256_castsi128_si256(lo)
+                     : SetrM128i(lo, LoadUnaligned16(
+                                         &src[(i + 4) * stride + idx]));
+    }
+    Transpose4x4(v, &x[idx]);
+  }
+}
+
+template <int store_count>
+LIBGAV1_ALWAYS_INLINE void StoreRows(int32_t* LIBGAV1_RESTRICT dst,
+                                     int32_t stride, const __m256i* x,
+                                     const bool is_half) {
+  static_assert(store_count % 4 == 0, "");
+  for (int idx = 0; idx < store_count; idx += 4) {
+    __m256i v[4];
+    Transpose4x4(&x[idx], v);
+    for (int i = 0; i < 4; ++i) {
+      StoreUnaligned16(&dst[i * stride + idx], _mm256_castsi256_si128(v[i]));
+      if (!is_half) {
+        StoreUnaligned16(&dst[(i + 4) * stride + idx],
+                         _mm256_extracti128_si256(v[i], 1));
+      }
+    }
+  }
+}
+
+// The column transforms process 8 columns at a time. When |is_half| is true
+// the transform is 4 columns wide and only the low 128 bits are used.
+template <int load_count>
+LIBGAV1_ALWAYS_INLINE void LoadColumns(const int32_t* LIBGAV1_RESTRICT src,
+                                       int32_t stride, __m256i* x,
+                                       const bool is_half) {
+  for (int i = 0; i < load_count; ++i) {
+    x[i] = is_half ? _mm256_castsi128_si256(LoadUnaligned16(&src[i * stride]))
+                   : LoadUnaligned32(&src[i * stride]);
+  }
+}
+
+template <int store_count>
+LIBGAV1_ALWAYS_INLINE void StoreColumns(int32_t* LIBGAV1_RESTRICT dst,
+                                        int32_t stride, const __m256i* x,
+                                        const bool is_half) {
+  for (int i = 0; i < store_count; ++i) {
+    if (is_half) {
+      StoreUnaligned16(&dst[i * stride], _mm256_castsi256_si128(x[i]));
+    } else {
+      StoreUnaligned32(&dst[i * stride], x[i]);
+    }
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE __m256i MultiplyByConstant(const __m256i a,
+                                                 const int32_t b) {
+  return _mm256_mullo_epi32(a, _mm256_set1_epi32(b));
+}
+
+// Computes (a * multiplier + 2048) >> 12 in each lane. The products of the
+// coefficient ranges and the 12 bit multipliers fit in 32 bits.
+LIBGAV1_ALWAYS_INLINE __m256i MultiplyShiftRound12(const __m256i a,
+                                                   const int32_t multiplier) {
+  return RightShiftWithRounding_S32(MultiplyByConstant(a, multiplier), 12);
+}
+
+// Computes (a * multiplier + rounding) >> (12 + shift) in each lane for the
+// identity row transforms. For 12bpp the product of the 20 bit row inputs and
+// the identity multipliers may not fit in 32 bits, so the integral part of
+// multiplier / 4096 is added after the shift by 12.
+template <int bitdepth, int32_t multiplier>
+LIBGAV1_ALWAYS_INLINE __m256i IdentityRowMultiply(const __m256i a,
+                                                  const int shift) {
+  const __m256i v_dual_round = _mm256_set1_epi32((1 + (shift << 1)) << 11);
+  if (bitdepth == kBitdepth10) {
+    const __m256i b =
+        _mm256_add_epi32(v_dual_round, MultiplyByConstant(a, multiplier));
+    return _mm256_sra_epi32(b, _mm_cvtsi32_si128(12 + shift));
+  }
+  static_assert(multiplier >> 12 == 1 || multiplier >> 12 == 2, "");
+  const __m256i b =
+      _mm256_add_epi32(v_dual_round, MultiplyByConstant(a, multiplier & 4095));
+  const __m256i a_integral =
+      (multiplier >> 12 == 1) ? a : _mm256_add_epi32(a, a);
+  const __m256i c = _mm256_add_epi32(_mm256_srai_epi32(b, 12), a_integral);
+  return _mm256_sra_epi32(c, _mm_cvtsi32_si128(shift));
+}
+
+// Saturates each 32 bit lane to the Max(bitdepth + 6, 16) bit range of the
+// row transform outputs.
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE __m256i ClampIntermediate(const __m256i a) {
+  const __m256i max = _mm256_set1_epi32((1 << (bitdepth + 5)) - 1);
+  const __m256i min = _mm256_set1_epi32(-(1 << (bitdepth + 5)));
+  return _mm256_max_epi32(_mm256_min_epi32(a, max), min);
+}
+
+// Applies the rounded row shift and clamps the result to the intermediate
+// range.
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE __m256i RowShiftAndClamp(const __m256i a,
+                                               const int row_shift) {
+  const __m256i v_round = _mm256_set1_epi32((1 << row_shift) >> 1);
+  const __m256i b = _mm256_sra_epi32(_mm256_add_epi32(a, v_round),
+                                     _mm_cvtsi32_si128(row_shift));
+  return ClampIntermediate<bitdepth>(b);
+}
+
+// Adds the residual to 8 pixels of |dst| and stores the clamped result.
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE void AddResidual8(uint16_t* LIBGAV1_RESTRICT dst,
+                                        const __m256i residual) {
+  const __m256i frame_data = _mm256_cvtepu16_epi32(LoadUnaligned16(dst));
+  const __m256i b = _mm256_add_epi32(residual, frame_data);
+  // Move the packed values of each lane into the low 128 bits.
+  const __m256i d =
+      _mm256_permute4x64_epi64(_mm256_packus_epi32(b, b), 0x08);
+  StoreUnaligned16(dst, _mm_min_epu16(_mm256_castsi256_si128(d),
+                                      _mm_set1_epi16((1 << bitdepth) - 1)));
+}
+
+// Adds the residual rows in the low and high 128 bits to 4 pixels of |dst|
+// and |dst + stride| respectively and stores the clamped result.
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE void AddResidual4x2(uint16_t* LIBGAV1_RESTRICT dst,
+                                          const int stride,
+                                          const __m256i residual) {
+  const __m128i frame_data =
+      _mm_unpacklo_epi64(LoadLo8(dst), LoadLo8(dst + stride));
+  const __m256i b =
+      _mm256_add_epi32(residual, _mm256_cvtepu16_epi32(frame_data));
+  const __m256i d =
+      _mm256_permute4x64_epi64(_mm256_packus_epi32(b, b), 0x08);
+  const __m128i e = _mm_min_epu16(_mm256_castsi256_si128(d),
+                                  _mm_set1_epi16((1 << bitdepth) - 1));
+  StoreLo8(dst, e);
+  StoreHi8(dst + stride, e);
+}
+
+// Butterfly rotate 4 values.
+LIBGAV1_ALWAYS_INLINE void ButterflyRotation_4(__m256i* a, __m256i* b,
+                                               const int angle,
+                                               const bool flip) {
+  const int32_t cos128 = Cos128(angle);
+  const int32_t sin128 = Sin128(angle);
+  const __m256i acc_x = MultiplyByConstant(*a, cos128);
+  const __m256i acc_y = MultiplyByConstant(*a, sin128);
+  // The max range for the input is 18 bits. The cos128/sin128 is 13 bits,
+  // which leaves 1 bit for the add/subtract. For 10bpp, x/y will fit in a 32
+  // bit lane. For 12bpp the input has 20 bits and the products may wrap, but
+  // x/y are representable in 32 bits for conformant streams, so the wrapped
+  // sums are exact.
+  const __m256i x0 = _mm256_sub_epi32(acc_x, MultiplyByConstant(*b, sin128));
+  const __m256i y0 = _mm256_add_epi32(acc_y, MultiplyByConstant(*b, cos128));
+  const __m256i x = RightShiftWithRounding_S32(x0, 12);
+  const __m256i y = RightShiftWithRounding_S32(y0, 12);
+  if (flip) {
+    *a = y;
+    *b = x;
+  } else {
+    *a = x;
+    *b = y;
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE void ButterflyRotation_FirstIsZero(__m256i* a,
+                                                         __m256i* b,
+                                                         const int angle,
+                                                         const bool flip) {
+  const int32_t cos128 = Cos128(angle);
+  const int32_t sin128 = Sin128(angle);
+  const __m256i x0 = MultiplyByConstant(*b, -sin128);
+  const __m256i y0 = MultiplyByConstant(*b, cos128);
+  const __m256i x = RightShiftWithRounding_S32(x0, 12);
+  const __m256i y = RightShiftWithRounding_S32(y0, 12);
+  if (flip) {
+    *a = y;
+    *b = x;
+  } else {
+    *a = x;
+    *b = y;
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE void ButterflyRotation_SecondIsZero(__m256i* a,
+                                                          __m256i* b,
+                                                          const int angle,
+                                                          const bool flip) {
+  const int32_t cos128 = Cos128(angle);
+  const int32_t sin128 = Sin128(angle);
+  const __m256i x0 = MultiplyByConstant(*a, cos128);
+  const __m256i y0 = MultiplyByConstant(*a, sin128);
+  const __m256i x = RightShiftWithRounding_S32(x0, 12);
+  const __m256i y = RightShiftWithRounding_S32(y0, 12);
+  if (flip) {
+    *a = y;
+    *b = x;
+  } else {
+    *a = x;
+    *b = y;
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE void HadamardRotation(__m256i* a, __m256i* b,
+                                            bool flip) {
+  __m256i x, y;
+  if (flip) {
+    y = _mm256_add_epi32(*b, *a);
+    x = _mm256_sub_epi32(*b, *a);
+  } else {
+    x = _mm256_add_epi32(*a, *b);
+    y = _mm256_sub_epi32(*a, *b);
+  }
+  *a = x;
+  *b = y;
+}
+
+LIBGAV1_ALWAYS_INLINE void HadamardRotation(__m256i* a, __m256i* b,
+                                            bool flip, const __m256i min,
+                                            const __m256i max) {
+  __m256i x, y;
+  if (flip) {
+    y = _mm256_add_epi32(*b, *a);
+    x = _mm256_sub_epi32(*b, *a);
+  } else {
+    x = _mm256_add_epi32(*a, *b);
+    y = _mm256_sub_epi32(*a, *b);
+  }
+  *a = _mm256_max_epi32(_mm256_min_epi32(x, max), min);
+  *b = _mm256_max_epi32(_mm256_min_epi32(y, max), min);
+}
+
+using ButterflyRotationFunc = void (*)(__m256i* a, __m256i* b, int angle,
+                                       bool flip);
+
+//------------------------------------------------------------------------------
+// Discrete Cosine Transforms (DCT).
+
+template <int bitdepth, int width>
+LIBGAV1_ALWAYS_INLINE bool DctDcOnly(void* dest, int adjusted_tx_height,
+                                     bool should_round, int row_shift) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int32_t*>(dest);
+  const __m256i v_src0 = _mm256_set1_epi32(dst[0]);
+  const __m256i v_src =
+      should_round ? MultiplyShiftRound12(v_src0, kTransformRowMultiplier)
+                   : v_src0;
+  const int32_t cos128 = Cos128(32);
+  const __m256i xy = MultiplyShiftRound12(v_src, cos128);
+  // Clamp result to signed 16 bits.
+  const __m256i result = RowShiftAndClamp<bitdepth>(xy, row_shift);
+  if (width == 4) {
+    StoreUnaligned16(dst, _mm256_castsi256_si128(result));
+  } else {
+    for (int i = 0; i < width; i += 8) {
+      StoreUnaligned32(dst, result);
+      dst += 8;
+    }
+  }
+  return true;
+}
+
+template <int height>
+LIBGAV1_ALWAYS_INLINE bool DctDcOnlyColumn(void* dest, int adjusted_tx_height,
+                                           int width) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int32_t*>(dest);
+  const int32_t cos128 = Cos128(32);
+
+  // Calculate dc values for first row.
+  if (width == 4) {
+    const __m128i v_src = LoadUnaligned16(dst);
+    const __m256i xy =
+        MultiplyShiftRound12(_mm256_castsi128_si256(v_src), cos128);
+    StoreUnaligned16(dst, _mm256_castsi256_si128(xy));
+  } else {
+    int i = 0;
+    do {
+      const __m256i v_src = LoadUnaligned32(&dst[i]);
+      const __m256i xy = MultiplyShiftRound12(v_src, cos128);
+      StoreUnaligned32(&dst[i], xy);
+      i += 8;
+    } while (i < width);
+  }
+
+  // Copy first row to the rest of the block.
+  for (int y = 1; y < height; ++y) {
+    memcpy(&dst[y * width], dst, width * sizeof(dst[0]));
+  }
+  return true;
+}
+
+template <ButterflyRotationFunc butterfly_rotation,
+          bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct4Stages(__m256i* s, const __m256i min,
+                                      const __m256i max,
+                                      const bool is_last_stage) {
+  // stage 12.
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[0], &s[1], 32, true);
+    ButterflyRotation_SecondIsZero(&s[2], &s[3], 48, false);
+  } else {
+    butterfly_rotation(&s[0], &s[1], 32, true);
+    butterfly_rotation(&s[2], &s[3], 48, false);
+  }
+
+  // stage 17.
+  if (is_last_stage) {
+    HadamardRotation(&s[0], &s[3], false);
+    HadamardRotation(&s[1], &s[2], false);
+  } else {
+    HadamardRotation(&s[0], &s[3], false, min, max);
+    HadamardRotation(&s[1], &s[2], false, min, max);
+  }
+}
+
+template <int bitdepth, ButterflyRotationFunc butterfly_rotation>
+LIBGAV1_ALWAYS_INLINE void Dct4_AVX2(void* dest, int32_t step, bool is_row,
+                                     int row_shift, bool is_half) {
+  auto* const dst = static_cast<int32_t*>(dest);
+  // When |is_row| is true, set range to the row range, otherwise, set to the
+  // column range.
+  const int32_t range = is_row ? bitdepth + 7 : bitdepth + 5;
+  const __m256i min = _mm256_set1_epi32(-(1 << range));
+  const __m256i max = _mm256_set1_epi32((1 << range) - 1);
+  __m256i s[4], x[4];
+
+  if (is_row) {
+    assert(step == 4);
+    LoadRows<4>(dst, step, x, is_half);
+  } else {
+    LoadColumns<4>(dst, step, x, is_half);
+  }
+
+  // stage 1.
+  // kBitReverseLookup 0, 2, 1, 3
+  s[0] = x[0];
+  s[1] = x[2];
+  s[2] = x[1];
+  s[3] = x[3];
+
+  Dct4Stages<butterfly_rotation>(s, min, max, /*is_last_stage=*/true);
+
+  if (is_row) {
+    for (auto& i : s) {
+      i = RowShiftAndClamp<bitdepth>(i, row_shift);
+    }
+    StoreRows<4>(dst, step, s, is_half);
+  } else {
+    StoreColumns<4>(dst, step, s, is_half);
+  }
+}
+
+template <ButterflyRotationFunc butterfly_rotation,
+          bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct8Stages(__m256i* s, const __m256i min,
+                                      const __m256i max,
+                                      const bool is_last_stage) {
+  // stage 8.
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[4], &s[7], 56, false);
+    ButterflyRotation_FirstIsZero(&s[5], &s[6], 24, false);
+  } else {
+    butterfly_rotation(&s[4], &s[7], 56, false);
+    butterfly_rotation(&s[5], &s[6], 24, false);
+  }
+
+  // stage 13.
+  HadamardRotation(&s[4], &s[5], false, min, max);
+  HadamardRotation(&s[6], &s[7], true, min, max);
+
+  // stage 18.
+  butterfly_rotation(&s[6], &s[5], 32, true);
+
+  // stage 22.
+  if (is_last_stage) {
+    HadamardRotation(&s[0], &s[7], false);
+    HadamardRotation(&s[1], &s[6], false);
+    HadamardRotation(&s[2], &s[5], false);
+    HadamardRotation(&s[3], &s[4], false);
+  } else {
+    HadamardRotation(&s[0], &s[7], false, min, max);
+    HadamardRotation(&s[1], &s[6], false, min, max);
+    HadamardRotation(&s[2], &s[5], false, min, max);
+    HadamardRotation(&s[3], &s[4], false, min, max);
+  }
+}
+
+// Process dct8 rows or columns, depending on the |is_row| flag.
+template <int bitdepth, ButterflyRotationFunc butterfly_rotation>
+LIBGAV1_ALWAYS_INLINE void Dct8_AVX2(void* dest, int32_t step, bool is_row,
+                                     int row_shift, bool is_half) {
+  auto* const dst = static_cast<int32_t*>(dest);
+  const int32_t range = is_row ? bitdepth + 7 : bitdepth + 5;
+  const __m256i min = _mm256_set1_epi32(-(1 << range));
+  const __m256i max = _mm256_set1_epi32((1 << range) - 1);
+  __m256i s[8], x[8];
+
+  if (is_row) {
+    LoadRows<8>(dst, step, x, is_half);
+  } else {
+    LoadColumns<8>(dst, step, x, is_half);
+  }
+
+  // stage 1.
+  // kBitReverseLookup 0, 4, 2, 6, 1, 5, 3, 7,
+  s[0] = x[0];
+  s[1] = x[4];
+  s[2] = x[2];
+  s[3] = x[6];
+  s[4] = x[1];
+  s[5] = x[5];
+  s[6] = x[3];
+  s[7] = x[7];
+
+  Dct4Stages<butterfly_rotation>(s, min, max, /*is_last_stage=*/false);
+  Dct8Stages<butterfly_rotation>(s, min, max, /*is_last_stage=*/true);
+
+  if (is_row) {
+    for (auto& i : s) {
+      i = RowShiftAndClamp<bitdepth>(i, row_shift);
+    }
+    StoreRows<8>(dst, step, s, is_half);
+  } else {
+    StoreColumns<8>(dst, step, s, is_half);
+  }
+}
+
+template <ButterflyRotationFunc butterfly_rotation,
+          bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct16Stages(__m256i* s, const __m256i min,
+                                       const __m256i max,
+                                       const bool is_last_stage) {
+  // stage 5.
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[8], &s[15], 60, false);
+    ButterflyRotation_FirstIsZero(&s[9], &s[14], 28, false);
+    ButterflyRotation_SecondIsZero(&s[10], &s[13], 44, false);
+    ButterflyRotation_FirstIsZero(&s[11], &s[12], 12, false);
+  } else {
+    butterfly_rotation(&s[8], &s[15], 60, false);
+    butterfly_rotation(&s[9], &s[14], 28, false);
+    butterfly_rotation(&s[10], &s[13], 44, false);
+    butterfly_rotation(&s[11], &s[12], 12, false);
+  }
+
+  // stage 9.
+  HadamardRotation(&s[8], &s[9], false, min, max);
+  HadamardRotation(&s[10], &s[11], true, min, max);
+  HadamardRotation(&s[12], &s[13], false, min, max);
+  HadamardRotation(&s[14], &s[15], true, min, max);
+
+  // stage 14.
+  butterfly_rotation(&s[14], &s[9], 48, true);
+  butterfly_rotation(&s[13], &s[10], 112, true);
+
+  // stage 19.
+  HadamardRotation(&s[8], &s[11], false, min, max);
+  HadamardRotation(&s[9], &s[10], false, min, max);
+  HadamardRotation(&s[12], &s[15], true, min, max);
+  HadamardRotation(&s[13], &s[14], true, min, max);
+
+  // stage 23.
+  butterfly_rotation(&s[13], &s[10], 32, true);
+  butterfly_rotation(&s[12], &s[11], 32, true);
+
+  // stage 26.
+  if (is_last_stage) {
+    HadamardRotation(&s[0], &s[15], false);
+    HadamardRotation(&s[1], &s[14], false);
+    HadamardRotation(&s[2], &s[13], false);
+    HadamardRotation(&s[3], &s[12], false);
+    HadamardRotation(&s[4], &s[11], false);
+    HadamardRotation(&s[5], &s[10], false);
+    HadamardRotation(&s[6], &s[9], false);
+    HadamardRotation(&s[7], &s[8], false);
+  } else {
+    HadamardRotation(&s[0], &s[15], false, min, max);
+    HadamardRotation(&s[1], &s[14], false, min, max);
+    HadamardRotation(&s[2], &s[13], false, min, max);
+    HadamardRotation(&s[3], &s[12], false, min, max);
+    HadamardRotation(&s[4], &s[11], false, min, max);
+    HadamardRotation(&s[5], &s[10], false, min, max);
+    HadamardRotation(&s[6], &s[9], false, min, max);
+    HadamardRotation(&s[7], &s[8], false, min, max);
+  }
+}
+
+// Process dct16 rows or columns, depending on the |is_row| flag.
+template <int bitdepth, ButterflyRotationFunc butterfly_rotation>
+LIBGAV1_ALWAYS_INLINE void Dct16_AVX2(void* dest, int32_t step, bool is_row,
+                                      int row_shift, bool is_half) {
+  auto* const dst = static_cast<int32_t*>(dest);
+  const int32_t range = is_row ? bitdepth + 7 : bitdepth + 5;
+  const __m256i min = _mm256_set1_epi32(-(1 << range));
+  const __m256i max = _mm256_set1_epi32((1 << range) - 1);
+  __m256i s[16], x[16];
+
+  if (is_row) {
+    LoadRows<16>(dst, step, x, is_half);
+  } else {
+    LoadColumns<16>(dst, step, x, is_half);
+  }
+
+  // stage 1
+  // kBitReverseLookup 0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15,
+  s[0] = x[0];
+  s[1] = x[8];
+  s[2] = x[4];
+  s[3] = x[12];
+  s[4] = x[2];
+  s[5] = x[10];
+  s[6] = x[6];
+  s[7] = x[14];
+  s[8] = x[1];
+  s[9] = x[9];
+  s[10] = x[5];
+  s[11] = x[13];
+  s[12] = x[3];
+  s[13] = x[11];
+  s[14] = x[7];
+  s[15] = x[15];
+
+  Dct4Stages<butterfly_rotation>(s, min, max, /*is_last_stage=*/false);
+  Dct8Stages<butterfly_rotation>(s, min, max, /*is_last_stage=*/false);
+  Dct16Stages<butterfly_rotation>(s, min, max, /*is_last_stage=*/true);
+
+  if (is_row) {
+    for (auto& i : s) {
+      i = RowShiftAndClamp<bitdepth>(i, row_shift);
+    }
+    StoreRows<16>(dst, step, s, is_half);
+  } else {
+    StoreColumns<16>(dst, step, s, is_half);
+  }
+}
+
+template <ButterflyRotationFunc butterfly_rotation,
+          bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct32Stages(__m256i* s, const __m256i min,
+                                       const __m256i max,
+                                       const bool is_last_stage) {
+  // stage 3
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[16], &s[31], 62, false);
+    ButterflyRotation_FirstIsZero(&s[17], &s[30], 30, false);
+    ButterflyRotation_SecondIsZero(&s[18], &s[29], 46, false);
+    ButterflyRotation_FirstIsZero(&s[19], &s[28], 14, false);
+    ButterflyRotation_SecondIsZero(&s[20], &s[27], 54, false);
+    ButterflyRotation_FirstIsZero(&s[21], &s[26], 22, false);
+    ButterflyRotation_SecondIsZero(&s[22], &s[25], 38, false);
+    ButterflyRotation_FirstIsZero(&s[23], &s[24], 6, false);
+  } else {
+    butterfly_rotation(&s[16], &s[31], 62, false);
+    butterfly_rotation(&s[17], &s[30], 30, false);
+    butterfly_rotation(&s[18], &s[29], 46, false);
+    butterfly_rotation(&s[19], &s[28], 14, false);
+    butterfly_rotation(&s[20], &s[27], 54, false);
+    butterfly_rotation(&s[21], &s[26], 22, false);
+    butterfly_rotation(&s[22], &s[25], 38, false);
+    butterfly_rotation(&s[23], &s[24], 6, false);
+  }
+
+  // stage 6.
+  HadamardRotation(&s[16], &s[17], false, min, max);
+  HadamardRotation(&s[18], &s[19], true, min, max);
+  HadamardRotation(&s[20], &s[21], false, min, max);
+  HadamardRotation(&s[22], &s[23], true, min, max);
+  HadamardRotation(&s[24], &s[25], false, min, max);
+  HadamardRotation(&s[26], &s[27], true, min, max);
+  HadamardRotation(&s[28], &s[29], false, min, max);
+  HadamardRotation(&s[30], &s[31], true, min, max);
+
+  // stage 10.
+  butterfly_rotation(&s[30], &s[17], 24 + 32, true);
+  butterfly_rotation(&s[29], &s[18], 24 + 64 + 32, true);
+  butterfly_rotation(&s[26], &s[21], 24, true);
+  butterfly_rotation(&s[25], &s[22], 24 + 64, true);
+
+  // stage 15.
+  HadamardRotation(&s[16], &s[19], false, min, max);
+  HadamardRotation(&s[17], &s[18], false, min, max);
+  HadamardRotation(&s[20], &s[23], true, min, max);
+  HadamardRotation(&s[21], &s[22], true, min, max);
+  HadamardRotation(&s[24], &s[27], false, min, max);
+  HadamardRotation(&s[25], &s[26], false, min, max);
+  HadamardRotation(&s[28], &s[31], true, min, max);
+  HadamardRotation(&s[29], &s[30], true, min, max);
+
+  // stage 20.
+  butterfly_rotation(&s[29], &s[18], 48, true);
+  butterfly_rotation(&s[28], &s[19], 48, true);
+  butterfly_rotation(&s[27], &s[20], 48 + 64, true);
+  butterfly_rotation(&s[26], &s[21], 48 + 64, true);
+
+  // stage 24.
+  HadamardRotation(&s[16], &s[23], false, min, max);
+  HadamardRotation(&s[17], &s[22], false, min, max);
+  HadamardRotation(&s[18], &s[21], false, min, max);
+  HadamardRotation(&s[19], &s[20], false, min, max);
+  HadamardRotation(&s[24], &s[31], true, min, max);
+  HadamardRotation(&s[25], &s[30], true, min, max);
+  HadamardRotation(&s[26], &s[29], true, min, max);
+  HadamardRotation(&s[27], &s[28], true, min, max);
+
+  // stage 27.
+  butterfly_rotation(&s[27], &s[20], 32, true);
+  butterfly_rotation(&s[26], &s[21], 32, true);
+  butterfly_rotation(&s[25], &s[22], 32, true);
+  butterfly_rotation(&s[24], &s[23], 32, true);
+
+  // stage 29.
+  if (is_last_stage) {
+    HadamardRotation(&s[0], &s[31], false);
+    HadamardRotation(&s[1], &s[30], false);
+    HadamardRotation(&s[2], &s[29], false);
+    HadamardRotation(&s[3], &s[28], false);
+    HadamardRotation(&s[4], &s[27], false);
+    HadamardRotation(&s[5], &s[26], false);
+    HadamardRotation(&s[6], &s[25], false);
+    HadamardRotation(&s[7], &s[24], false);
+    HadamardRotation(&s[8], &s[23], false);
+    HadamardRotation(&s[9], &s[22], false);
+    HadamardRotation(&s[10], &s[21], false);
+    HadamardRotation(&s[11], &s[20], false);
+    HadamardRotation(&s[12], &s[19], false);
+    HadamardRotation(&s[13], &s[18], false);
+    HadamardRotation(&s[14], &s[17], false);
+    HadamardRotation(&s[15], &s[16], false);
+  } else {
+    HadamardRotation(&s[0], &s[31], false, min, max);
+    HadamardRotation(&s[1], &s[30], false, min, max);
+    HadamardRotation(&s[2], &s[29], false, min, max);
+    HadamardRotation(&s[3], &s[28], false, min, max);
+    HadamardRotation(&s[4], &s[27], false, min, max);
+    HadamardRotation(&s[5], &s[26], false, min, max);
+    HadamardRotation(&s[6], &s[25], false, min, max);
+    HadamardRotation(&s[7], &s[24], false, min, max);
+    HadamardRotation(&s[8], &s[23], false, min, max);
+    HadamardRotation(&s[9], &s[22], false, min, max);
+    HadamardRotation(&s[10], &s[21], false, min, max);
+    HadamardRotation(&s[11], &s[20], false, min, max);
+    HadamardRotation(&s[12], &s[19], false, min, max);
+    HadamardRotation(&s[13], &s[18], false, min, max);
+    HadamardRotation(&s[14], &s[17], false, min, max);
+    HadamardRotation(&s[15], &s[16], false, min, max);
+  }
+}
+
+// Process dct32 rows or columns, depending on the |is_row| flag.
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE void Dct32_AVX2(void* dest, const int32_t step,
+                                      const bool is_row, int row_shift,
+                                      bool is_half) {
+  auto* const dst = static_cast<int32_t*>(dest);
+  const int32_t range = is_row ? bitdepth + 7 : bitdepth + 5;
+  const __m256i min = _mm256_set1_epi32(-(1 << range));
+  const __m256i max = _mm256_set1_epi32((1 << range) - 1);
+  __m256i s[32], x[32];
+
+  if (is_row) {
+    LoadRows<32>(dst, step, x, is_half);
+  } else {
+    LoadColumns<32>(dst, step, x, is_half);
+  }
+
+  // stage 1
+  // kBitReverseLookup
+  // 0, 16, 8, 24, 4, 20, 12, 28, 2, 18, 10, 26, 6, 22, 14, 30,
+  s[0] = x[0];
+  s[1] = x[16];
+  s[2] = x[8];
+  s[3] = x[24];
+  s[4] = x[4];
+  s[5] = x[20];
+  s[6] = x[12];
+  s[7] = x[28];
+  s[8] = x[2];
+  s[9] = x[18];
+  s[10] = x[10];
+  s[11] = x[26];
+  s[12] = x[6];
+  s[13] = x[22];
+  s[14] = x[14];
+  s[15] = x[30];
+
+  // 1, 17, 9, 25, 5, 21, 13, 29, 3, 19, 11, 27, 7, 23, 15, 31,
+  s[16] = x[1];
+  s[17] = x[17];
+  s[18] = x[9];
+  s[19] = x[25];
+  s[20] = x[5];
+  s[21] = x[21];
+  s[22] = x[13];
+  s[23] = x[29];
+  s[24] = x[3];
+  s[25] = x[19];
+  s[26] = x[11];
+  s[27] = x[27];
+  s[28] = x[7];
+  s[29] = x[23];
+  s[30] = x[15];
+  s[31] = x[31];
+
+  Dct4Stages<ButterflyRotation_4>(s, min, max, /*is_last_stage=*/false);
+  Dct8Stages<ButterflyRotation_4>(s, min, max, /*is_last_stage=*/false);
+  Dct16Stages<ButterflyRotation_4>(s, min, max, /*is_last_stage=*/false);
+  Dct32Stages<ButterflyRotation_4>(s, min, max, /*is_last_stage=*/true);
+
+  if (is_row) {
+    for (auto& i : s) {
+      i = RowShiftAndClamp<bitdepth>(i, row_shift);
+    }
+    StoreRows<32>(dst, step, s, is_half);
+  } else {
+    StoreColumns<32>(dst, step, s, is_half);
+  }
+}
+
+template <int bitdepth>
+void Dct64_AVX2(void* dest, int32_t step, bool is_row, int row_shift,
+                bool is_half) {
+  auto* const dst = static_cast<int32_t*>(dest);
+  const int32_t range = is_row ? bitdepth + 7 : bitdepth + 5;
+  const __m256i min = _mm256_set1_epi32(-(1 << range));
+  const __m256i max = _mm256_set1_epi32((1 << range) - 1);
+  __m256i s[64], x[32];
+
+  if (is_row) {
+    // The last 32 values of every row are always zero if the |tx_width| is
+    // 64.
+    LoadRows<32>(dst, step, x, is_half);
+  } else {
+    // The last 32 values of every column are always zero if the |tx_height| is
+    // 64.
+    LoadColumns<32>(dst, step, x, is_half);
+  }
+
+  // stage 1
+  // kBitReverseLookup
+  // 0, 32, 16, 48, 8, 40, 24, 56, 4, 36, 20, 52, 12, 44, 28, 60,
+  s[0] = x[0];
+  s[2] = x[16];
+  s[4] = x[8];
+  s[6] = x[24];
+  s[8] = x[4];
+  s[10] = x[20];
+  s[12] = x[12];
+  s[14] = x[28];
+
+  // 2, 34, 18, 50, 10, 42, 26, 58, 6, 38, 22, 54, 14, 46, 30, 62,
+  s[16] = x[2];
+  s[18] = x[18];
+  s[20] = x[10];
+  s[22] = x[26];
+  s[24] = x[6];
+  s[26] = x[22];
+  s[28] = x[14];
+  s[30] = x[30];
+
+  // 1, 33, 17, 49, 9, 41, 25, 57, 5, 37, 21, 53, 13, 45, 29, 61,
+  s[32] = x[1];
+  s[34] = x[17];
+  s[36] = x[9];
+  s[38] = x[25];
+  s[40] = x[5];
+  s[42] = x[21];
+  s[44] = x[13];
+  s[46] = x[29];
+
+  // 3, 35, 19, 51, 11, 43, 27, 59, 7, 39, 23, 55, 15, 47, 31, 63
+  s[48] = x[3];
+  s[50] = x[19];
+  s[52] = x[11];
+  s[54] = x[27];
+  s[56] = x[7];
+  s[58] = x[23];
+  s[60] = x[15];
+  s[62] = x[31];
+
+  Dct4Stages<ButterflyRotation_4, /*is_fast_butterfly=*/true>(
+      s, min, max, /*is_last_stage=*/false);
+  Dct8Stages<ButterflyRotation_4, /*is_fast_butterfly=*/true>(
+      s, min, max, /*is_last_stage=*/false);
+  Dct16Stages<ButterflyRotation_4, /*is_fast_butterfly=*/true>(
+      s, min, max, /*is_last_stage=*/false);
+  Dct32Stages<ButterflyRotation_4, /*is_fast_butterfly=*/true>(
+      s, min, max, /*is_last_stage=*/false);
+
+  //-- start dct 64 stages
+  // stage 2.
+  ButterflyRotation_SecondIsZero(&s[32], &s[63], 63 - 0, false);
+  ButterflyRotation_FirstIsZero(&s[33], &s[62], 63 - 32, false);
+  ButterflyRotation_SecondIsZero(&s[34], &s[61], 63 - 16, false);
+  ButterflyRotation_FirstIsZero(&s[35], &s[60], 63 - 48, false);
+  ButterflyRotation_SecondIsZero(&s[36], &s[59], 63 - 8, false);
+  ButterflyRotation_FirstIsZero(&s[37], &s[58], 63 - 40, false);
+  ButterflyRotation_SecondIsZero(&s[38], &s[57], 63 - 24, false);
+  ButterflyRotation_FirstIsZero(&s[39], &s[56], 63 - 56, false);
+  ButterflyRotation_SecondIsZero(&s[40], &s[55], 63 - 4, false);
+  ButterflyRotation_FirstIsZero(&s[41], &s[54], 63 - 36, false);
+  ButterflyRotation_SecondIsZero(&s[42], &s[53], 63 - 20, false);
+  ButterflyRotation_FirstIsZero(&s[43], &s[52], 63 - 52, false);
+  ButterflyRotation_SecondIsZero(&s[44], &s[51], 63 - 12, false);
+  ButterflyRotation_FirstIsZero(&s[45], &s[50], 63 - 44, false);
+  ButterflyRotation_SecondIsZero(&s[46], &s[49], 63 - 28, false);
+  ButterflyRotation_FirstIsZero(&s[47], &s[48], 63 - 60, false);
+
+  // stage 4.
+  HadamardRotation(&s[32], &s[33], false, min, max);
+  HadamardRotation(&s[34], &s[35], true, min, max);
+  HadamardRotation(&s[36], &s[37], false, min, max);
+  HadamardRotation(&s[38], &s[39], true, min, max);
+  HadamardRotation(&s[40], &s[41], false, min, max);
+  HadamardRotation(&s[42], &s[43], true, min, max);
+  HadamardRotation(&s[44], &s[45], false, min, max);
+  HadamardRotation(&s[46], &s[47], true, min, max);
+  HadamardRotation(&s[48], &s[49], false, min, max);
+  HadamardRotation(&s[50], &s[51], true, min, max);
+  HadamardRotation(&s[52], &s[53], false, min, max);
+  HadamardRotation(&s[54], &s[55], true, min, max);
+  HadamardRotation(&s[56], &s[57], false, min, max);
+  HadamardRotation(&s[58], &s[59], true, min, max);
+  HadamardRotation(&s[60], &s[61], false, min, max);
+  HadamardRotation(&s[62], &s[63], true, min, max);
+
+  // stage 7.
+  ButterflyRotation_4(&s[62], &s[33], 60 - 0, true);
+  ButterflyRotation_4(&s[61], &s[34], 60 - 0 + 64, true);
+  ButterflyRotation_4(&s[58], &s[37], 60 - 32, true);
+  ButterflyRotation_4(&s[57], &s[38], 60 - 32 + 64, true);
+  ButterflyRotation_4(&s[54], &s[41], 60 - 16, true);
+  ButterflyRotation_4(&s[53], &s[42], 60 - 16 + 64, true);
+  ButterflyRotation_4(&s[50], &s[45], 60 - 48, true);
+  ButterflyRotation_4(&s[49], &s[46], 60 - 48 + 64, true);
+
+  // stage 11.
+  HadamardRotation(&s[32], &s[35], false, min, max);
+  HadamardRotation(&s[33], &s[34], false, min, max);
+  HadamardRotation(&s[36], &s[39], true, min, max);
+  HadamardRotation(&s[37], &s[38], true, min, max);
+  HadamardRotation(&s[40], &s[43], false, min, max);
+  HadamardRotation(&s[41], &s[42], false, min, max);
+  HadamardRotation(&s[44], &s[47], true, min, max);
+  HadamardRotation(&s[45], &s[46], true, min, max);
+  HadamardRotation(&s[48], &s[51], false, min, max);
+  HadamardRotation(&s[49], &s[50], false, min, max);
+  HadamardRotation(&s[52], &s[55], true, min, max);
+  HadamardRotation(&s[53], &s[54], true, min, max);
+  HadamardRotation(&s[56], &s[59], false, min, max);
+  HadamardRotation(&s[57], &s[58], false, min, max);
+  HadamardRotation(&s[60], &s[63], true, min, max);
+  HadamardRotation(&s[61], &s[62], true, min, max);
+
+  // stage 16.
+  ButterflyRotation_4(&s[61], &s[34], 56, true);
+  ButterflyRotation_4(&s[60], &s[35], 56, true);
+  ButterflyRotation_4(&s[59], &s[36], 56 + 64, true);
+  ButterflyRotation_4(&s[58], &s[37], 56 + 64, true);
+  ButterflyRotation_4(&s[53], &s[42], 56 - 32, true);
+  ButterflyRotation_4(&s[52], &s[43], 56 - 32, true);
+  ButterflyRotation_4(&s[51], &s[44], 56 - 32 + 64, true);
+  ButterflyRotation_4(&s[50], &s[45], 56 - 32 + 64, true);
+
+  // stage 21.
+  HadamardRotation(&s[32], &s[39], false, min, max);
+  HadamardRotation(&s[33], &s[38], false, min, max);
+  HadamardRotation(&s[34], &s[37], false, min, max);
+  HadamardRotation(&s[35], &s[36], false, min, max);
+  HadamardRotation(&s[40], &s[47], true, min, max);
+  HadamardRotation(&s[41], &s[46], true, min, max);
+  HadamardRotation(&s[42], &s[45], true, min, max);
+  HadamardRotation(&s[43], &s[44], true, min, max);
+  HadamardRotation(&s[48], &s[55], false, min, max);
+  HadamardRotation(&s[49], &s[54], false, min, max);
+  HadamardRotation(&s[50], &s[53], false, min, max);
+  HadamardRotation(&s[51], &s[52], false, min, max);
+  HadamardRotation(&s[56], &s[63], true, min, max);
+  HadamardRotation(&s[57], &s[62], true, min, max);
+  HadamardRotation(&s[58], &s[61], true, min, max);
+  HadamardRotation(&s[59], &s[60], true, min, max);
+
+  // stage 25.
+  ButterflyRotation_4(&s[59], &s[36], 48, true);
+  ButterflyRotation_4(&s[58], &s[37], 48, true);
+  ButterflyRotation_4(&s[57], &s[38], 48, true);
+  ButterflyRotation_4(&s[56], &s[39], 48, true);
+  ButterflyRotation_4(&s[55], &s[40], 112, true);
+  ButterflyRotation_4(&s[54], &s[41], 112, true);
+  ButterflyRotation_4(&s[53], &s[42], 112, true);
+  ButterflyRotation_4(&s[52], &s[43], 112, true);
+
+  // stage 28.
+  HadamardRotation(&s[32], &s[47], false, min, max);
+  HadamardRotation(&s[33], &s[46], false, min, max);
+  HadamardRotation(&s[34], &s[45], false, min, max);
+  HadamardRotation(&s[35], &s[44], false, min, max);
+  HadamardRotation(&s[36], &s[43], false, min, max);
+  HadamardRotation(&s[37], &s[42], false, min, max);
+  HadamardRotation(&s[38], &s[41], false, min, max);
+  HadamardRotation(&s[39], &s[40], false, min, max);
+  HadamardRotation(&s[48], &s[63], true, min, max);
+  HadamardRotation(&s[49], &s[62], true, min, max);
+  HadamardRotation(&s[50], &s[61], true, min, max);
+  HadamardRotation(&s[51], &s[60], true, min, max);
+  HadamardRotation(&s[52], &s[59], true, min, max);
+  HadamardRotation(&s[53], &s[58], true, min, max);
+  HadamardRotation(&s[54], &s[57], true, min, max);
+  HadamardRotation(&s[55], &s[56], true, min, max);
+
+  // stage 30.
+  ButterflyRotation_4(&s[55], &s[40], 32, true);
+  ButterflyRotation_4(&s[54], &s[41], 32, true);
+  ButterflyRotation_4(&s[53], &s[42], 32, true);
+  ButterflyRotation_4(&s[52], &s[43], 32, true);
+  ButterflyRotation_4(&s[51], &s[44], 32, true);
+  ButterflyRotation_4(&s[50], &s[45], 32, true);
+  ButterflyRotation_4(&s[49], &s[46], 32, true);
+  ButterflyRotation_4(&s[48], &s[47], 32, true);
+
+  // stage 31.
+  for (int i = 0; i < 32; i += 4) {
+    HadamardRotation(&s[i], &s[63 - i], false, min, max);
+    HadamardRotation(&s[i + 1], &s[63 - i - 1], false, min, max);
+    HadamardRotation(&s[i + 2], &s[63 - i - 2], false, min, max);
+    HadamardRotation(&s[i + 3], &s[63 - i - 3], false, min, max);
+  }
+  //-- end dct 64 stages
+  if (is_row) {
+    for (auto& i : s) {
+      i = RowShiftAndClamp<bitdepth>(i, row_shift);
+    }
+    StoreRows<64>(dst, step, s, is_half);
+  } else {
+    StoreColumns<64>(dst, step, s, is_half);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Asymmetric Discrete Sine Transforms (ADST).
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE void Adst4_AVX2(void* dest, int32_t step, bool is_row,
+                                      int row_shift, bool is_half) {
+  auto* const dst = static_cast<int32_t*>(dest);
+  __m256i s[8];
+  __m256i x[4];
+
+  if (is_row) {
+    assert(step == 4);
+    LoadRows<4>(dst, step, x, is_half);
+  } else {
+    LoadColumns<4>(dst, step, x, is_half);
+  }
+
+  // stage 1.
+  s[5] = MultiplyByConstant(x[3], kAdst4Multiplier[1]);
+  s[6] = MultiplyByConstant(x[3], kAdst4Multiplier[3]);
+
+  // stage 2.
+  const __m256i a7 = _mm256_sub_epi32(x[0], x[2]);
+  const __m256i b7 = _mm256_add_epi32(a7, x[3]);
+
+  // stage 3.
+  s[0] = MultiplyByConstant(x[0], kAdst4Multiplier[0]);
+  s[1] = MultiplyByConstant(x[0], kAdst4Multiplier[1]);
+  // s[0] = s[0] + s[3]
+  s[0] = _mm256_add_epi32(s[0], MultiplyByConstant(x[2], kAdst4Multiplier[3]));
+  // s[1] = s[1] - s[4]
+  s[1] = _mm256_sub_epi32(s[1], MultiplyByConstant(x[2], kAdst4Multiplier[0]));
+
+  s[3] = MultiplyByConstant(x[1], kAdst4Multiplier[2]);
+  s[2] = MultiplyByConstant(b7, kAdst4Multiplier[2]);
+
+  // stage 4.
+  s[0] = _mm256_add_epi32(s[0], s[5]);
+  s[1] = _mm256_sub_epi32(s[1], s[6]);
+
+  // stages 5 and 6.
+  const __m256i x0 = _mm256_add_epi32(s[0], s[3]);
+  const __m256i x1 = _mm256_add_epi32(s[1], s[3]);
+  const __m256i x3_a = _mm256_add_epi32(s[0], s[1]);
+  const __m256i x3 = _mm256_sub_epi32(x3_a, s[3]);
+  x[0] = RightShiftWithRounding_S32(x0, 12);
+  x[1] = RightShiftWithRounding_S32(x1, 12);
+  x[2] = RightShiftWithRounding_S32(s[2], 12);
+  x[3] = RightShiftWithRounding_S32(x3, 12);
+
+  if (is_row) {
+    for (auto& i : x) {
+      i = RowShiftAndClamp<bitdepth>(i, row_shift);
+    }
+    StoreRows<4>(dst, step, x, is_half);
+  } else {
+    StoreColumns<4>(dst, step, x, is_half);
+  }
+}
+
+alignas(16) constexpr int32_t kAdst4DcOnlyMultiplier[4] = {1321, 2482, 3344,
+                                                           2482};
+
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE bool Adst4DcOnly(void* dest, int adjusted_tx_height,
+                                       bool should_round, int row_shift) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int32_t*>(dest);
+  __m256i s[2];
+
+  const __m256i v_src0 = _mm256_set1_epi32(dst[0]);
+  const __m256i v_src =
+      should_round ? MultiplyShiftRound12(v_src0, kTransformRowMultiplier)
+                   : v_src0;
+  const __m256i kAdst4DcOnlyMultipliers =
+      _mm256_castsi128_si256(LoadAligned16(kAdst4DcOnlyMultiplier));
+
+  // s0*k0 s0*k1 s0*k2 s0*k1
+  s[0] = _mm256_mullo_epi32(kAdst4DcOnlyMultipliers, v_src);
+  // 0     0     0     s0*k0
+  s[1] = _mm256_slli_si256(s[0], 12);
+
+  const __m256i x3 = _mm256_add_epi32(s[0], s[1]);
+  const __m256i dst_0 = RightShiftWithRounding_S32(x3, 12);
+
+  StoreUnaligned16(
+      dst, _mm256_castsi256_si128(
+          RowShiftAndClamp<bitdepth>(dst_0, row_shift)));
+
+  return true;
+}
+
+LIBGAV1_ALWAYS_INLINE bool Adst4DcOnlyColumn(void* dest, int adjusted_tx_height,
+                                             int width) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int32_t*>(dest);
+  const bool is_half = width == 4;
+  __m256i s[4];
+
+  int i = 0;
+  do {
+    __m256i v_src;
+    LoadColumns<1>(&dst[i], width, &v_src, is_half);
+
+    s[0] = MultiplyByConstant(v_src, kAdst4Multiplier[0]);
+    s[1] = MultiplyByConstant(v_src, kAdst4Multiplier[1]);
+    s[2] = MultiplyByConstant(v_src, kAdst4Multiplier[2]);
+
+    __m256i x[4];
+    x[0] = RightShiftWithRounding_S32(s[0], 12);
+    x[1] = RightShiftWithRounding_S32(s[1], 12);
+    x[2] = RightShiftWithRounding_S32(s[2], 12);
+    x[3] = RightShiftWithRounding_S32(_mm256_add_epi32(s[0], s[1]), 12);
+
+    StoreColumns<4>(&dst[i], width, x, is_half);
+    i += 8;
+  } while (i < width);
+
+  return true;
+}
+
+template <int bitdepth, ButterflyRotationFunc butterfly_rotation>
+LIBGAV1_ALWAYS_INLINE void Adst8_AVX2(void* dest, int32_t step, bool is_row,
+                                      int row_shift, bool is_half) {
+  auto* const dst = static_cast<int32_t*>(dest);
+  const int32_t range = is_row ? bitdepth + 7 : bitdepth + 5;
+  const __m256i min = _mm256_set1_epi32(-(1 << range));
+  const __m256i max = _mm256_set1_epi32((1 << range) - 1);
+  __m256i s[8], x[8];
+
+  if (is_row) {
+    LoadRows<8>(dst, step, x, is_half);
+  } else {
+    LoadColumns<8>(dst, step, x, is_half);
+  }
+
+  // stage 1.
+  s[0] = x[7];
+  s[1] = x[0];
+  s[2] = x[5];
+  s[3] = x[2];
+  s[4] = x[3];
+  s[5] = x[4];
+  s[6] = x[1];
+  s[7] = x[6];
+
+  // stage 2.
+  butterfly_rotation(&s[0], &s[1], 60 - 0, true);
+  butterfly_rotation(&s[2], &s[3], 60 - 16, true);
+  butterfly_rotation(&s[4], &s[5], 60 - 32, true);
+  butterfly_rotation(&s[6], &s[7], 60 - 48, true);
+
+  // stage 3.
+  HadamardRotation(&s[0], &s[4], false, min, max);
+  HadamardRotation(&s[1], &s[5], false, min, max);
+  HadamardRotation(&s[2], &s[6], false, min, max);
+  HadamardRotation(&s[3], &s[7], false, min, max);
+
+  // stage 4.
+  butterfly_rotation(&s[4], &s[5], 48 - 0, true);
+  butterfly_rotation(&s[7], &s[6], 48 - 32, true);
+
+  // stage 5.
+  HadamardRotation(&s[0], &s[2], false, min, max);
+  HadamardRotation(&s[4], &s[6], false, min, max);
+  HadamardRotation(&s[1], &s[3], false, min, max);
+  HadamardRotation(&s[5], &s[7], false, min, max);
+
+  // stage 6.
+  butterfly_rotation(&s[2], &s[3], 32, true);
+  butterfly_rotation(&s[6], &s[7], 32, true);
+
+  // stage 7.
+  const __m256i v_zero = _mm256_setzero_si256();
+  x[0] = s[0];
+  x[1] = _mm256_sub_epi32(v_zero, s[4]);
+  x[2] = s[6];
+  x[3] = _mm256_sub_epi32(v_zero, s[2]);
+  x[4] = s[3];
+  x[5] = _mm256_sub_epi32(v_zero, s[7]);
+  x[6] = s[5];
+  x[7] = _mm256_sub_epi32(v_zero, s[1]);
+
+  if (is_row) {
+    for (auto& i : x) {
+      i = RowShiftAndClamp<bitdepth>(i, row_shift);
+    }
+    StoreRows<8>(dst, step, x, is_half);
+  } else {
+    StoreColumns<8>(dst, step, x, is_half);
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE void Adst8DcOnlyInternal(__m256i* s, __m256i* x) {
+  // stage 2.
+  ButterflyRotation_FirstIsZero(&s[0], &s[1], 60, true);
+
+  // stage 3.
+  s[4] = s[0];
+  s[5] = s[1];
+
+  // stage 4.
+  ButterflyRotation_4(&s[4], &s[5], 48, true);
+
+  // stage 5.
+  s[2] = s[0];
+  s[3] = s[1];
+  s[6] = s[4];
+  s[7] = s[5];
+
+  // stage 6.
+  ButterflyRotation_4(&s[2], &s[3], 32, true);
+  ButterflyRotation_4(&s[6], &s[7], 32, true);
+
+  // stage 7.
+  const __m256i v_zero = _mm256_setzero_si256();
+  x[0] = s[0];
+  x[1] = _mm256_sub_epi32(v_zero, s[4]);
+  x[2] = s[6];
+  x[3] = _mm256_sub_epi32(v_zero, s[2]);
+  x[4] = s[3];
+  x[5] = _mm256_sub_epi32(v_zero, s[7]);
+  x[6] = s[5];
+  x[7] = _mm256_sub_epi32(v_zero, s[1]);
+}
+
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE bool Adst8DcOnly(void* dest, int adjusted_tx_height,
+                                       bool should_round, int row_shift) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int32_t*>(dest);
+  __m256i s[8];
+  __m256i x[8];
+
+  const __m256i v_src = _mm256_castsi128_si256(_mm_cvtsi32_si128(dst[0]));
+  // stage 1.
+  s[1] = should_round ? MultiplyShiftRound12(v_src, kTransformRowMultiplier)
+                      : v_src;
+
+  Adst8DcOnlyInternal(s, x);
+
+  for (int i = 0; i < 8; ++i) {
+    dst[i] = _mm_cvtsi128_si32(
+        _mm256_castsi256_si128(RowShiftAndClamp<bitdepth>(x[i], row_shift)));
+  }
+
+  return true;
+}
+
+LIBGAV1_ALWAYS_INLINE bool Adst8DcOnlyColumn(void* dest, int adjusted_tx_height,
+                                             int width) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int32_t*>(dest);
+  const bool is_half = width == 4;
+  __m256i s[8];
+
+  int i = 0;
+  do {
+    // stage 1.
+    LoadColumns<1>(dst, width, &s[1], is_half);
+
+    __m256i x[8];
+    Adst8DcOnlyInternal(s, x);
+
+    StoreColumns<8>(dst, width, x, is_half);
+    i += 8;
+    dst += 8;
+  } while (i < width);
+
+  return true;
+}
+
+template <int bitdepth, ButterflyRotationFunc butterfly_rotation>
+LIBGAV1_ALWAYS_INLINE void Adst16_AVX2(void* dest, int32_t step, bool is_row,
+                                       int row_shift, bool is_half) {
+  auto* const dst = static_cast<int32_t*>(dest);
+  const int32_t range = is_row ? bitdepth + 7 : bitdepth + 5;
+  const __m256i min = _mm256_set1_epi32(-(1 << range));
+  const __m256i max = _mm256_set1_epi32((1 << range) - 1);
+  __m256i s[16], x[16];
+
+  if (is_row) {
+    LoadRows<16>(dst, step, x, is_half);
+  } else {
+    LoadColumns<16>(dst, step, x, is_half);
+  }
+
+  // stage 1.
+  s[0] = x[15];
+  s[1] = x[0];
+  s[2] = x[13];
+  s[3] = x[2];
+  s[4] = x[11];
+  s[5] = x[4];
+  s[6] = x[9];
+  s[7] = x[6];
+  s[8] = x[7];
+  s[9] = x[8];
+  s[10] = x[5];
+  s[11] = x[10];
+  s[12] = x[3];
+  s[13] = x[12];
+  s[14] = x[1];
+  s[15] = x[14];
+
+  // stage 2.
+  butterfly_rotation(&s[0], &s[1], 62 - 0, true);
+  butterfly_rotation(&s[2], &s[3], 62 - 8, true);
+  butterfly_rotation(&s[4], &s[5], 62 - 16, true);
+  butterfly_rotation(&s[6], &s[7], 62 - 24, true);
+  butterfly_rotation(&s[8], &s[9], 62 - 32, true);
+  butterfly_rotation(&s[10], &s[11], 62 - 40, true);
+  butterfly_rotation(&s[12], &s[13], 62 - 48, true);
+  butterfly_rotation(&s[14], &s[15], 62 - 56, true);
+
+  // stage 3.
+  HadamardRotation(&s[0], &s[8], false, min, max);
+  HadamardRotation(&s[1], &s[9], false, min, max);
+  HadamardRotation(&s[2], &s[10], false, min, max);
+  HadamardRotation(&s[3], &s[11], false, min, max);
+  HadamardRotation(&s[4], &s[12], false, min, max);
+  HadamardRotation(&s[5], &s[13], false, min, max);
+  HadamardRotation(&s[6], &s[14], false, min, max);
+  HadamardRotation(&s[7], &s[15], false, min, max);
+
+  // stage 4.
+  butterfly_rotation(&s[8], &s[9], 56 - 0, true);
+  butterfly_rotation(&s[13], &s[12], 8 + 0, true);
+  butterfly_rotation(&s[10], &s[11], 56 - 32, true);
+  butterfly_rotation(&s[15], &s[14], 8 + 32, true);
+
+  // stage 5.
+  HadamardRotation(&s[0], &s[4], false, min, max);
+  HadamardRotation(&s[8], &s[12], false, min, max);
+  HadamardRotation(&s[1], &s[5], false, min, max);
+  HadamardRotation(&s[9], &s[13], false, min, max);
+  HadamardRotation(&s[2], &s[6], false, min, max);
+  HadamardRotation(&s[10], &s[14], false, min, max);
+  HadamardRotation(&s[3], &s[7], false, min, max);
+  HadamardRotation(&s[11], &s[15], false, min, max);
+
+  // stage 6.
+  butterfly_rotation(&s[4], &s[5], 48 - 0, true);
+  butterfly_rotation(&s[12], &s[13], 48 - 0, true);
+  butterfly_rotation(&s[7], &s[6], 48 - 32, true);
+  butterfly_rotation(&s[15], &s[14], 48 - 32, true);
+
+  // stage 7.
+  HadamardRotation(&s[0], &s[2], false, min, max);
+  HadamardRotation(&s[4], &s[6], false, min, max);
+  HadamardRotation(&s[8], &s[10], false, min, max);
+  HadamardRotation(&s[12], &s[14], false, min, max);
+  HadamardRotation(&s[1], &s[3], false, min, max);
+  HadamardRotation(&s[5], &s[7], false, min, max);
+  HadamardRotation(&s[9], &s[11], false, min, max);
+  HadamardRotation(&s[13], &s[15], false, min, max);
+
+  // stage 8.
+  butterfly_rotation(&s[2], &s[3], 32, true);
+  butterfly_rotation(&s[6], &s[7], 32, true);
+  butterfly_rotation(&s[10], &s[11], 32, true);
+  butterfly_rotation(&s[14], &s[15], 32, true);
+
+  // stage 9.
+  const __m256i v_zero = _mm256_setzero_si256();
+  x[0] = s[0];
+  x[1] = _mm256_sub_epi32(v_zero, s[8]);
+  x[2] = s[12];
+  x[3] = _mm256_sub_epi32(v_zero, s[4]);
+  x[4] = s[6];
+  x[5] = _mm256_sub_epi32(v_zero, s[14]);
+  x[6] = s[10];
+  x[7] = _mm256_sub_epi32(v_zero, s[2]);
+  x[8] = s[3];
+  x[9] = _mm256_sub_epi32(v_zero, s[11]);
+  x[10] = s[15];
+  x[11] = _mm256_sub_epi32(v_zero, s[7]);
+  x[12] = s[5];
+  x[13] = _mm256_sub_epi32(v_zero, s[13]);
+  x[14] = s[9];
+  x[15] = _mm256_sub_epi32(v_zero, s[1]);
+
+  if (is_row) {
+    for (auto& i : x) {
+      i = RowShiftAndClamp<bitdepth>(i, row_shift);
+    }
+    StoreRows<16>(dst, step, x, is_half);
+  } else {
+    StoreColumns<16>(dst, step, x, is_half);
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE void Adst16DcOnlyInternal(__m256i* s, __m256i* x) {
+  // stage 2.
+  ButterflyRotation_FirstIsZero(&s[0], &s[1], 62, true);
+
+  // stage 3.
+  s[8] = s[0];
+  s[9] = s[1];
+
+  // stage 4.
+  ButterflyRotation_4(&s[8], &s[9], 56, true);
+
+  // stage 5.
+  s[4] = s[0];
+  s[12] = s[8];
+  s[5] = s[1];
+  s[13] = s[9];
+
+  // stage 6.
+  ButterflyRotation_4(&s[4], &s[5], 48, true);
+  ButterflyRotation_4(&s[12], &s[13], 48, true);
+
+  // stage 7.
+  s[2] = s[0];
+  s[6] = s[4];
+  s[10] = s[8];
+  s[14] = s[12];
+  s[3] = s[1];
+  s[7] = s[5];
+  s[11] = s[9];
+  s[15] = s[13];
+
+  // stage 8.
+  ButterflyRotation_4(&s[2], &s[3], 32, true);
+  ButterflyRotation_4(&s[6], &s[7], 32, true);
+  ButterflyRotation_4(&s[10], &s[11], 32, true);
+  ButterflyRotation_4(&s[14], &s[15], 32, true);
+
+  // stage 9.
+  const __m256i v_zero = _mm256_setzero_si256();
+  x[0] = s[0];
+  x[1] = _mm256_sub_epi32(v_zero, s[8]);
+  x[2] = s[12];
+  x[3] = _mm256_sub_epi32(v_zero, s[4]);
+  x[4] = s[6];
+  x[5] = _mm256_sub_epi32(v_zero, s[14]);
+  x[6] = s[10];
+  x[7] = _mm256_sub_epi32(v_zero, s[2]);
+  x[8] = s[3];
+  x[9] = _mm256_sub_epi32(v_zero, s[11]);
+  x[10] = s[15];
+  x[11] = _mm256_sub_epi32(v_zero, s[7]);
+  x[12] = s[5];
+  x[13] = _mm256_sub_epi32(v_zero, s[13]);
+  x[14] = s[9];
+  x[15] = _mm256_sub_epi32(v_zero, s[1]);
+}
+
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE bool Adst16DcOnly(void* dest, int adjusted_tx_height,
+                                        bool should_round, int row_shift) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int32_t*>(dest);
+  __m256i s[16];
+  __m256i x[16];
+  const __m256i v_src = _mm256_castsi128_si256(_mm_cvtsi32_si128(dst[0]));
+  // stage 1.
+  s[1] = should_round ? MultiplyShiftRound12(v_src, kTransformRowMultiplier)
+                      : v_src;
+
+  Adst16DcOnlyInternal(s, x);
+
+  for (int i = 0; i < 16; ++i) {
+    dst[i] = _mm_cvtsi128_si32(
+        _mm256_castsi256_si128(RowShiftAndClamp<bitdepth>(x[i], row_shift)));
+  }
+
+  return true;
+}
+
+LIBGAV1_ALWAYS_INLINE bool Adst16DcOnlyColumn(void* dest,
+                                              int adjusted_tx_height,
+                                              int width) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int32_t*>(dest);
+  const bool is_half = width == 4;
+  int i = 0;
+  do {
+    __m256i s[16];
+    __m256i x[16];
+    // stage 1.
+    LoadColumns<1>(dst, width, &s[1], is_half);
+
+    Adst16DcOnlyInternal(s, x);
+
+    StoreColumns<16>(dst, width, x, is_half);
+    i += 8;
+    dst += 8;
+  } while (i < width);
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Identity Transforms.
+
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE void Identity4_AVX2(void* dest, int num_values,
+                                          int shift) {
+  auto* const dst = static_cast<int32_t*>(dest);
+  int i = 0;
+  do {
+    const __m256i v_src = LoadUnaligned32(&dst[i]);
+    const __m256i a =
+        IdentityRowMultiply<bitdepth, kIdentity4Multiplier>(v_src, shift);
+    StoreUnaligned32(&dst[i], ClampIntermediate<bitdepth>(a));
+    i += 8;
+  } while (i < num_values);
+}
+
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE bool Identity4DcOnly(void* dest, int adjusted_tx_height,
+                                           bool should_round, int tx_height) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int32_t*>(dest);
+  const __m256i v_src0 = _mm256_castsi128_si256(_mm_cvtsi32_si128(dst[0]));
+  const __m256i v_src =
+      should_round ? MultiplyShiftRound12(v_src0, kTransformRowMultiplier)
+                   : v_src0;
+  const int shift = tx_height < 16 ? 0 : 1;
+  const __m256i dst_0 =
+      IdentityRowMultiply<bitdepth, kIdentity4Multiplier>(v_src, shift);
+  dst[0] = _mm_cvtsi128_si32(
+      _mm256_castsi256_si128(ClampIntermediate<bitdepth>(dst_0)));
+  return true;
+}
+
+// Applies the identity column transform for |identity_size| along with the
+// final rounding shift of 4.
+template <int identity_size>
+LIBGAV1_ALWAYS_INLINE __m256i IdentityColumn(const __m256i v_src) {
+  const __m256i v_dual_round = _mm256_set1_epi32((1 + (1 << 4)) << 11);
+  if (identity_size == 4) {
+    const __m256i v_dst_i = _mm256_add_epi32(
+        v_dual_round, MultiplyByConstant(v_src, kIdentity4Multiplier));
+    return _mm256_srai_epi32(v_dst_i, 4 + 12);
+  }
+  if (identity_size == 8) {
+    const __m256i v_dst_i = _mm256_add_epi32(v_src, v_src);
+    return RightShiftWithRounding_S32(v_dst_i, 4);
+  }
+  if (identity_size == 16) {
+    const __m256i v_dst_i = _mm256_add_epi32(
+        v_dual_round, MultiplyByConstant(v_src, kIdentity16Multiplier));
+    return _mm256_srai_epi32(v_dst_i, 4 + 12);
+  }
+  return RightShiftWithRounding_S32(v_src, 2);
+}
+
+template <int bitdepth, int identity_size>
+LIBGAV1_ALWAYS_INLINE void IdentityColumnStoreToFrame(
+    Array2DView<uint16_t> frame, const int start_x, const int start_y,
+    const int tx_width, const int tx_height,
+    const int32_t* LIBGAV1_RESTRICT source) {
+  static_assert(identity_size == 4 || identity_size == 8 ||
+                    identity_size == 16 || identity_size == 32,
+                "Invalid identity_size.");
+  const int stride = frame.columns();
+  uint16_t* LIBGAV1_RESTRICT dst = frame[start_y] + start_x;
+
+  if (tx_width == 4) {
+    // Process two rows per iteration.
+    int i = 0;
+    do {
+      const __m256i v_src = LoadUnaligned32(&source[i * 4]);
+      AddResidual4x2<bitdepth>(dst, stride,
+                               IdentityColumn<identity_size>(v_src));
+      dst += stride << 1;
+      i += 2;
+    } while (i < tx_height);
+  } else {
+    int i = 0;
+    do {
+      const int row = i * tx_width;
+      int j = 0;
+      do {
+        const __m256i v_src = LoadUnaligned32(&source[row + j]);
+        AddResidual8<bitdepth>(dst + j, IdentityColumn<identity_size>(v_src));
+        j += 8;
+      } while (j < tx_width);
+      dst += stride;
+    } while (++i < tx_height);
+  }
+}
+
+// Applies the identity4 row and column transforms and the rounding shift of 4.
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE __m256i Identity4RowColumn(const __m256i v_src,
+                                                 const bool is_4x4) {
+  const __m256i v_round = _mm256_set1_epi32((1 + (0)) << 11);
+  __m256i v_dst_row;
+  if (is_4x4) {
+    v_dst_row = IdentityRowMultiply<bitdepth, kIdentity4Multiplier>(v_src, 0);
+  } else {
+    const __m256i v_src_round = _mm256_srai_epi32(
+        _mm256_add_epi32(v_round,
+                         MultiplyByConstant(v_src, kTransformRowMultiplier)),
+        12);
+    v_dst_row = _mm256_add_epi32(v_src_round, v_src_round);
+  }
+  v_dst_row = ClampIntermediate<bitdepth>(v_dst_row);
+  const __m256i v_dst_col = _mm256_add_epi32(
+      v_round, MultiplyByConstant(v_dst_row, kIdentity4Multiplier));
+  return RightShiftWithRounding_S32(v_dst_col, 4 + 12);
+}
+
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE void Identity4RowColumnStoreToFrame(
+    Array2DView<uint16_t> frame, const int start_x, const int start_y,
+    const int tx_width, const int tx_height,
+    const int32_t* LIBGAV1_RESTRICT source) {
+  const int stride = frame.columns();
+  uint16_t* LIBGAV1_RESTRICT dst = frame[start_y] + start_x;
+
+  if (tx_width == 4) {
+    // Process two rows per iteration.
+    int i = 0;
+    do {
+      const __m256i v_src = LoadUnaligned32(&source[i * 4]);
+      AddResidual4x2<bitdepth>(
+          dst, stride, Identity4RowColumn<bitdepth>(v_src, /*is_4x4=*/true));
+      dst += stride << 1;
+      i += 2;
+    } while (i < tx_height);
+  } else {
+    int i = 0;
+    do {
+      const __m256i v_src = LoadUnaligned32(&source[i * 8]);
+      AddResidual8<bitdepth>(
+          dst, Identity4RowColumn<bitdepth>(v_src, /*is_4x4=*/false));
+      dst += stride;
+    } while (++i < tx_height);
+  }
+}
+
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE void Identity8Row32_AVX2(void* dest, int num_values) {
+  auto* const dst = static_cast<int32_t*>(dest);
+
+  // When combining the identity8 multiplier with the row shift, the
+  // calculations for tx_height equal to 32 can be simplified from
+  // ((A * 2) + 2) >> 2) to ((A + 1) >> 1).
+  int i = 0;
+  do {
+    const __m256i v_src = LoadUnaligned32(&dst[i]);
+    const __m256i a = RightShiftWithRounding_S32(v_src, 1);
+    StoreUnaligned32(&dst[i], ClampIntermediate<bitdepth>(a));
+    i += 8;
+  } while (i < num_values);
+}
+
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE void Identity8Row4_AVX2(void* dest, int num_values) {
+  auto* const dst = static_cast<int32_t*>(dest);
+
+  int i = 0;
+  do {
+    const __m256i v_src = LoadUnaligned32(&dst[i]);
+    const __m256i v_srcx2 = _mm256_add_epi32(v_src, v_src);
+    StoreUnaligned32(&dst[i], ClampIntermediate<bitdepth>(v_srcx2));
+    i += 8;
+  } while (i < num_values);
+}
+
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE bool Identity8DcOnly(void* dest, int adjusted_tx_height,
+                                           bool should_round, int row_shift) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int32_t*>(dest);
+  const __m256i v_src0 = _mm256_castsi128_si256(_mm_cvtsi32_si128(dst[0]));
+  const __m256i v_src =
+      should_round ? MultiplyShiftRound12(v_src0, kTransformRowMultiplier)
+                   : v_src0;
+  const __m256i v_srcx2 = _mm256_add_epi32(v_src, v_src);
+  dst[0] = _mm_cvtsi128_si32(
+      _mm256_castsi256_si128(RowShiftAndClamp<bitdepth>(v_srcx2, row_shift)));
+  return true;
+}
+
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE void Identity16Row_AVX2(void* dest, int num_values,
+                                              int shift) {
+  auto* const dst = static_cast<int32_t*>(dest);
+
+  int i = 0;
+  do {
+    const __m256i v_src = LoadUnaligned32(&dst[i]);
+    const __m256i a =
+        IdentityRowMultiply<bitdepth, kIdentity16Multiplier>(v_src, shift);
+    StoreUnaligned32(&dst[i], ClampIntermediate<bitdepth>(a));
+    i += 8;
+  } while (i < num_values);
+}
+
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE bool Identity16DcOnly(void* dest, int adjusted_tx_height,
+                                            bool should_round, int shift) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int32_t*>(dest);
+  const __m256i v_src0 = _mm256_castsi128_si256(_mm_cvtsi32_si128(dst[0]));
+  const __m256i v_src =
+      should_round ? MultiplyShiftRound12(v_src0, kTransformRowMultiplier)
+                   : v_src0;
+  const __m256i dst_0 =
+      IdentityRowMultiply<bitdepth, kIdentity16Multiplier>(v_src, shift);
+  dst[0] = _mm_cvtsi128_si32(
+      _mm256_castsi256_si128(ClampIntermediate<bitdepth>(dst_0)));
+  return true;
+}
+
+LIBGAV1_ALWAYS_INLINE void Identity32Row16_AVX2(void* dest,
+                                                const int num_values) {
+  auto* const dst = static_cast<int32_t*>(dest);
+
+  // When combining the identity32 multiplier with the row shift, the
+  // calculation for tx_height equal to 16 can be simplified from
+  // ((A * 4) + 1) >> 1) to (A * 2).
+  int i = 0;
+  do {
+    const __m256i v_src = LoadUnaligned32(&dst[i]);
+    StoreUnaligned32(&dst[i], _mm256_add_epi32(v_src, v_src));
+    i += 8;
+  } while (i < num_values);
+}
+
+LIBGAV1_ALWAYS_INLINE bool Identity32DcOnly(void* dest,
+                                            int adjusted_tx_height) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int32_t*>(dest);
+  const __m256i v_src0 = _mm256_castsi128_si256(_mm_cvtsi32_si128(dst[0]));
+  const __m256i v_src = MultiplyShiftRound12(v_src0, kTransformRowMultiplier);
+  // When combining the identity32 multiplier with the row shift, the
+  // calculation for tx_height equal to 16 can be simplified from
+  // ((A * 4) + 1) >> 1) to (A * 2).
+  const __m256i v_dst_0 = _mm256_add_epi32(v_src, v_src);
+  dst[0] = _mm_cvtsi128_si32(_mm256_castsi256_si128(v_dst_0));
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// row/column transform loops
+
+template <int tx_height>
+LIBGAV1_ALWAYS_INLINE void FlipColumns(int32_t* source, int tx_width) {
+  const __m256i v_reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+  if (tx_width >= 16) {
+    int i = 0;
+    do {
+      // 00 01 02 03 04 05 06 07
+      const __m256i a = LoadUnaligned32(&source[i]);
+      const __m256i b = LoadUnaligned32(&source[i + 8]);
+      // 07 06 05 04 03 02 01 00
+      StoreUnaligned32(&source[i], _mm256_permutevar8x32_epi32(b, v_reverse));
+      StoreUnaligned32(&source[i + 8],
+                       _mm256_permutevar8x32_epi32(a, v_reverse));
+      i += 16;
+    } while (i < tx_width * tx_height);
+  } else if (tx_width == 8) {
+    for (int i = 0; i < 8 * tx_height; i += 8) {
+      const __m256i a = LoadUnaligned32(&source[i]);
+      StoreUnaligned32(&source[i], _mm256_permutevar8x32_epi32(a, v_reverse));
+    }
+  } else {
+    // Process two rows per iteration.
+    for (int i = 0; i < 4 * tx_height; i += 8) {
+      // 00 01 02 03 10 11 12 13
+      const __m256i a = LoadUnaligned32(&source[i]);
+      // 03 02 01 00 13 12 11 10
+      StoreUnaligned32(&source[i], _mm256_shuffle_epi32(a, 0x1b));
+    }
+  }
+}
+
+template <int tx_width>
+LIBGAV1_ALWAYS_INLINE void ApplyRounding(int32_t* source, int num_rows) {
+  int i = 0;
+  do {
+    const __m256i a = LoadUnaligned32(&source[i]);
+    const __m256i b = MultiplyShiftRound12(a, kTransformRowMultiplier);
+    StoreUnaligned32(&source[i], b);
+    i += 8;
+  } while (i < tx_width * num_rows);
+}
+
+template <int bitdepth, int tx_height, bool enable_flip_rows = false>
+LIBGAV1_ALWAYS_INLINE void StoreToFrameWithRound(
+    Array2DView<uint16_t> frame, const int start_x, const int start_y,
+    const int tx_width, const int32_t* LIBGAV1_RESTRICT source,
+    TransformType tx_type) {
+  const bool flip_rows =
+      enable_flip_rows ? kTransformFlipRowsMask.Contains(tx_type) : false;
+  const int stride = frame.columns();
+  uint16_t* LIBGAV1_RESTRICT dst = frame[start_y] + start_x;
+
+  if (tx_width == 4) {
+    // Process two rows per iteration.
+    for (int i = 0; i < tx_height; i += 2) {
+      const int row = flip_rows ? (tx_height - i - 1) * 4 : i * 4;
+      const int next_row = flip_rows ? row - 4 : row + 4;
+      const __m256i residual = SetrM128i(LoadUnaligned16(&source[row]),
+                                         LoadUnaligned16(&source[next_row]));
+      AddResidual4x2<bitdepth>(dst, stride,
+                               RightShiftWithRounding_S32(residual, 4));
+      dst += stride << 1;
+    }
+  } else {
+    for (int i = 0; i < tx_height; ++i) {
+      const int row = flip_rows ? (tx_height - i - 1) * tx_width : i * tx_width;
+      int j = 0;
+      do {
+        const __m256i residual = LoadUnaligned32(&source[row + j]);
+        AddResidual8<bitdepth>(dst + j,
+                               RightShiftWithRounding_S32(residual, 4));
+        j += 8;
+      } while (j < tx_width);
+      dst += stride;
+    }
+  }
+}
+
+template <int bitdepth>
+void Dct4TransformLoopRow_AVX2(TransformType /*tx_type*/,
+                               TransformSize tx_size, int adjusted_tx_height,
+                               void* src_buffer, int /*start_x*/,
+                               int /*start_y*/, void* /*dst_frame*/) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_height = kTransformHeight[tx_size];
+  const bool should_round = (tx_height == 8);
+  const int row_shift = static_cast<int>(tx_height == 16);
+
+  if (DctDcOnly<bitdepth, 4>(src, adjusted_tx_height, should_round,
+                             row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<4>(src, adjusted_tx_height);
+  }
+
+  // Process 8 1d dct4 rows in parallel per iteration.
+  int i = adjusted_tx_height;
+  auto* data = src;
+  do {
+    Dct4_AVX2<bitdepth, ButterflyRotation_4>(data, /*step=*/4, /*is_row=*/true,
+                                             row_shift, /*is_half=*/i == 4);
+    data += 32;
+    i -= 8;
+  } while (i > 0);
+}
+
+template <int bitdepth>
+void Dct4TransformLoopColumn_AVX2(TransformType tx_type,
+                                  TransformSize tx_size,
+                                  int adjusted_tx_height,
+                                  void* LIBGAV1_RESTRICT src_buffer,
+                                  int start_x, int start_y,
+                                  void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (kTransformFlipColumnsMask.Contains(tx_type)) {
+    FlipColumns<4>(src, tx_width);
+  }
+
+  if (!DctDcOnlyColumn<4>(src, adjusted_tx_height, tx_width)) {
+    // Process 8 1d dct4 columns in parallel per iteration.
+    int i = tx_width;
+    auto* data = src;
+    do {
+      Dct4_AVX2<bitdepth, ButterflyRotation_4>(data, tx_width, /*is_row=*/false,
+                                               /*row_shift=*/0,
+                                               /*is_half=*/tx_width == 4);
+      data += 8;
+      i -= 8;
+    } while (i > 0);
+  }
+
+  auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
+  StoreToFrameWithRound<bitdepth, 4>(frame, start_x, start_y, tx_width, src,
+                                     tx_type);
+}
+
+template <int bitdepth>
+void Dct8TransformLoopRow_AVX2(TransformType /*tx_type*/,
+                               TransformSize tx_size, int adjusted_tx_height,
+                               void* src_buffer, int /*start_x*/,
+                               int /*start_y*/, void* /*dst_frame*/) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  if (DctDcOnly<bitdepth, 8>(src, adjusted_tx_height, should_round,
+                             row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<8>(src, adjusted_tx_height);
+  }
+
+  // Process 8 1d dct8 rows in parallel per iteration.
+  int i = adjusted_tx_height;
+  auto* data = src;
+  do {
+    Dct8_AVX2<bitdepth, ButterflyRotation_4>(data, /*step=*/8, /*is_row=*/true,
+                                             row_shift, /*is_half=*/i == 4);
+    data += 64;
+    i -= 8;
+  } while (i > 0);
+}
+
+template <int bitdepth>
+void Dct8TransformLoopColumn_AVX2(TransformType tx_type,
+                                  TransformSize tx_size,
+                                  int adjusted_tx_height,
+                                  void* LIBGAV1_RESTRICT src_buffer,
+                                  int start_x, int start_y,
+                                  void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (kTransformFlipColumnsMask.Contains(tx_type)) {
+    FlipColumns<8>(src, tx_width);
+  }
+
+  if (!DctDcOnlyColumn<8>(src, adjusted_tx_height, tx_width)) {
+    // Process 8 1d dct8 columns in parallel per iteration.
+    int i = tx_width;
+    auto* data = src;
+    do {
+      Dct8_AVX2<bitdepth, ButterflyRotation_4>(data, tx_width, /*is_row=*/false,
+                                               /*row_shift=*/0,
+                                               /*is_half=*/tx_width == 4);
+      data += 8;
+      i -= 8;
+    } while (i > 0);
+  }
+  auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
+  StoreToFrameWithRound<bitdepth, 8>(frame, start_x, start_y, tx_width, src,
+                                     tx_type);
+}
+
+template <int bitdepth>
+void Dct16TransformLoopRow_AVX2(TransformType /*tx_type*/,
+                                TransformSize tx_size,
+                                int adjusted_tx_height, void* src_buffer,
+                                int /*start_x*/, int /*start_y*/,
+                                void* /*dst_frame*/) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  if (DctDcOnly<bitdepth, 16>(src, adjusted_tx_height, should_round,
+                              row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<16>(src, adjusted_tx_height);
+  }
+
+  assert(adjusted_tx_height % 4 == 0);
+  int i = adjusted_tx_height;
+  auto* data = src;
+  do {
+    // Process 8 1d dct16 rows in parallel per iteration.
+    Dct16_AVX2<bitdepth, ButterflyRotation_4>(data, 16, /*is_row=*/true,
+                                              row_shift, /*is_half=*/i == 4);
+    data += 128;
+    i -= 8;
+  } while (i > 0);
+}
+
+template <int bitdepth>
+void Dct16TransformLoopColumn_AVX2(TransformType tx_type,
+                                   TransformSize tx_size,
+                                   int adjusted_tx_height,
+                                   void* LIBGAV1_RESTRICT src_buffer,
+                                   int start_x, int start_y,
+                                   void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (kTransformFlipColumnsMask.Contains(tx_type)) {
+    FlipColumns<16>(src, tx_width);
+  }
+
+  if (!DctDcOnlyColumn<16>(src, adjusted_tx_height, tx_width)) {
+    // Process 8 1d dct16 columns in parallel per iteration.
+    int i = tx_width;
+    auto* data = src;
+    do {
+      Dct16_AVX2<bitdepth, ButterflyRotation_4>(
+          data, tx_width, /*is_row=*/false, /*row_shift=*/0,
+          /*is_half=*/tx_width == 4);
+      data += 8;
+      i -= 8;
+    } while (i > 0);
+  }
+  auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
+  StoreToFrameWithRound<bitdepth, 16>(frame, start_x, start_y, tx_width, src,
+                                      tx_type);
+}
+
+template <int bitdepth>
+void Dct32TransformLoopRow_AVX2(TransformType /*tx_type*/,
+                                TransformSize tx_size,
+                                int adjusted_tx_height, void* src_buffer,
+                                int /*start_x*/, int /*start_y*/,
+                                void* /*dst_frame*/) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  if (DctDcOnly<bitdepth, 32>(src, adjusted_tx_height, should_round,
+                              row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<32>(src, adjusted_tx_height);
+  }
+
+  assert(adjusted_tx_height % 4 == 0);
+  int i = adjusted_tx_height;
+  auto* data = src;
+  do {
+    // Process 8 1d dct32 rows in parallel per iteration.
+    Dct32_AVX2<bitdepth>(data, 32, /*is_row=*/true, row_shift,
+                         /*is_half=*/i == 4);
+    data += 256;
+    i -= 8;
+  } while (i > 0);
+}
+
+template <int bitdepth>
+void Dct32TransformLoopColumn_AVX2(TransformType tx_type,
+                                   TransformSize tx_size,
+                                   int adjusted_tx_height,
+                                   void* LIBGAV1_RESTRICT src_buffer,
+                                   int start_x, int start_y,
+                                   void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (kTransformFlipColumnsMask.Contains(tx_type)) {
+    FlipColumns<32>(src, tx_width);
+  }
+
+  if (!DctDcOnlyColumn<32>(src, adjusted_tx_height, tx_width)) {
+    // Process 8 1d dct32 columns in parallel per iteration.
+    int i = tx_width;
+    auto* data = src;
+    do {
+      Dct32_AVX2<bitdepth>(data, tx_width, /*is_row=*/false, /*row_shift=*/0,
+                           /*is_half=*/tx_width == 4);
+      data += 8;
+      i -= 8;
+    } while (i > 0);
+  }
+  auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
+  StoreToFrameWithRound<bitdepth, 32>(frame, start_x, start_y, tx_width, src,
+                                      tx_type);
+}
+
+template <int bitdepth>
+void Dct64TransformLoopRow_AVX2(TransformType /*tx_type*/,
+                                TransformSize tx_size,
+                                int adjusted_tx_height, void* src_buffer,
+                                int /*start_x*/, int /*start_y*/,
+                                void* /*dst_frame*/) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  if (DctDcOnly<bitdepth, 64>(src, adjusted_tx_height, should_round,
+                              row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<64>(src, adjusted_tx_height);
+  }
+
+  assert(adjusted_tx_height % 4 == 0);
+  int i = adjusted_tx_height;
+  auto* data = src;
+  do {
+    // Process 8 1d dct64 rows in parallel per iteration.
+    Dct64_AVX2<bitdepth>(data, 64, /*is_row=*/true, row_shift,
+                         /*is_half=*/i == 4);
+    data += 512;
+    i -= 8;
+  } while (i > 0);
+}
+
+template <int bitdepth>
+void Dct64TransformLoopColumn_AVX2(TransformType tx_type,
+                                   TransformSize tx_size,
+                                   int adjusted_tx_height,
+                                   void* LIBGAV1_RESTRICT src_buffer,
+                                   int start_x, int start_y,
+                                   void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (kTransformFlipColumnsMask.Contains(tx_type)) {
+    FlipColumns<64>(src, tx_width);
+  }
+
+  if (!DctDcOnlyColumn<64>(src, adjusted_tx_height, tx_width)) {
+    // Process 8 1d dct64 columns in parallel per iteration.
+    int i = tx_width;
+    auto* data = src;
+    do {
+      Dct64_AVX2<bitdepth>(data, tx_width, /*is_row=*/false, /*row_shift=*/0,
+                           /*is_half=*/tx_width == 4);
+      data += 8;
+      i -= 8;
+    } while (i > 0);
+  }
+  auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
+  StoreToFrameWithRound<bitdepth, 64>(frame, start_x, start_y, tx_width, src,
+                                      tx_type);
+}
+
+template <int bitdepth>
+void Adst4TransformLoopRow_AVX2(TransformType /*tx_type*/,
+                                TransformSize tx_size,
+                                int adjusted_tx_height, void* src_buffer,
+                                int /*start_x*/, int /*start_y*/,
+                                void* /*dst_frame*/) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_height = kTransformHeight[tx_size];
+  const int row_shift = static_cast<int>(tx_height == 16);
+  const bool should_round = (tx_height == 8);
+
+  if (Adst4DcOnly<bitdepth>(src, adjusted_tx_height, should_round, row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<4>(src, adjusted_tx_height);
+  }
+
+  // Process 8 1d adst4 rows in parallel per iteration.
+  int i = adjusted_tx_height;
+  auto* data = src;
+  do {
+    Adst4_AVX2<bitdepth>(data, /*step=*/4, /*is_row=*/true, row_shift,
+                         /*is_half=*/i == 4);
+    data += 32;
+    i -= 8;
+  } while (i > 0);
+}
+
+template <int bitdepth>
+void Adst4TransformLoopColumn_AVX2(TransformType tx_type,
+                                   TransformSize tx_size,
+                                   int adjusted_tx_height,
+                                   void* LIBGAV1_RESTRICT src_buffer,
+                                   int start_x, int start_y,
+                                   void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (kTransformFlipColumnsMask.Contains(tx_type)) {
+    FlipColumns<4>(src, tx_width);
+  }
+
+  if (!Adst4DcOnlyColumn(src, adjusted_tx_height, tx_width)) {
+    // Process 8 1d adst4 columns in parallel per iteration.
+    int i = tx_width;
+    auto* data = src;
+    do {
+      Adst4_AVX2<bitdepth>(data, tx_width, /*is_row=*/false, /*row_shift=*/0,
+                           /*is_half=*/tx_width == 4);
+      data += 8;
+      i -= 8;
+    } while (i > 0);
+  }
+
+  auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
+  StoreToFrameWithRound<bitdepth, 4, /*enable_flip_rows=*/true>(
+      frame, start_x, start_y, tx_width, src, tx_type);
+}
+
+template <int bitdepth>
+void Adst8TransformLoopRow_AVX2(TransformType /*tx_type*/,
+                                TransformSize tx_size,
+                                int adjusted_tx_height, void* src_buffer,
+                                int /*start_x*/, int /*start_y*/,
+                                void* /*dst_frame*/) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  if (Adst8DcOnly<bitdepth>(src, adjusted_tx_height, should_round, row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<8>(src, adjusted_tx_height);
+  }
+
+  // Process 8 1d adst8 rows in parallel per iteration.
+  assert(adjusted_tx_height % 4 == 0);
+  int i = adjusted_tx_height;
+  auto* data = src;
+  do {
+    Adst8_AVX2<bitdepth, ButterflyRotation_4>(data, /*step=*/8, /*is_row=*/true,
+                                              row_shift, /*is_half=*/i == 4);
+    data += 64;
+    i -= 8;
+  } while (i > 0);
+}
+
+template <int bitdepth>
+void Adst8TransformLoopColumn_AVX2(TransformType tx_type,
+                                   TransformSize tx_size,
+                                   int adjusted_tx_height,
+                                   void* LIBGAV1_RESTRICT src_buffer,
+                                   int start_x, int start_y,
+                                   void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (kTransformFlipColumnsMask.Contains(tx_type)) {
+    FlipColumns<8>(src, tx_width);
+  }
+
+  if (!Adst8DcOnlyColumn(src, adjusted_tx_height, tx_width)) {
+    // Process 8 1d adst8 columns in parallel per iteration.
+    int i = tx_width;
+    auto* data = src;
+    do {
+      Adst8_AVX2<bitdepth, ButterflyRotation_4>(
+          data, tx_width, /*is_row=*/false, /*row_shift=*/0,
+          /*is_half=*/tx_width == 4);
+      data += 8;
+      i -= 8;
+    } while (i > 0);
+  }
+  auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
+  StoreToFrameWithRound<bitdepth, 8, /*enable_flip_rows=*/true>(
+      frame, start_x, start_y, tx_width, src, tx_type);
+}
+
+template <int bitdepth>
+void Adst16TransformLoopRow_AVX2(TransformType /*tx_type*/,
+                                 TransformSize tx_size,
+                                 int adjusted_tx_height, void* src_buffer,
+                                 int /*start_x*/, int /*start_y*/,
+                                 void* /*dst_frame*/) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  if (Adst16DcOnly<bitdepth>(src, adjusted_tx_height, should_round,
+                             row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<16>(src, adjusted_tx_height);
+  }
+
+  assert(adjusted_tx_height % 4 == 0);
+  int i = adjusted_tx_height;
+  do {
+    // Process 8 1d adst16 rows in parallel per iteration.
+    Adst16_AVX2<bitdepth, ButterflyRotation_4>(src, 16, /*is_row=*/true,
+                                               row_shift, /*is_half=*/i == 4);
+    src += 128;
+    i -= 8;
+  } while (i > 0);
+}
+
+template <int bitdepth>
+void Adst16TransformLoopColumn_AVX2(TransformType tx_type,
+                                    TransformSize tx_size,
+                                    int adjusted_tx_height,
+                                    void* LIBGAV1_RESTRICT src_buffer,
+                                    int start_x, int start_y,
+                                    void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (kTransformFlipColumnsMask.Contains(tx_type)) {
+    FlipColumns<16>(src, tx_width);
+  }
+
+  if (!Adst16DcOnlyColumn(src, adjusted_tx_height, tx_width)) {
+    int i = tx_width;
+    auto* data = src;
+    do {
+      // Process 8 1d adst16 columns in parallel per iteration.
+      Adst16_AVX2<bitdepth, ButterflyRotation_4>(
+          data, tx_width, /*is_row=*/false, /*row_shift=*/0,
+          /*is_half=*/tx_width == 4);
+      data += 8;
+      i -= 8;
+    } while (i > 0);
+  }
+  auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
+  StoreToFrameWithRound<bitdepth, 16, /*enable_flip_rows=*/true>(
+      frame, start_x, start_y, tx_width, src, tx_type);
+}
+
+template <int bitdepth>
+void Identity4TransformLoopRow_AVX2(TransformType tx_type,
+                                    TransformSize tx_size,
+                                    int adjusted_tx_height, void* src_buffer,
+                                    int /*start_x*/, int /*start_y*/,
+                                    void* /*dst_frame*/) {
+  // Special case: Process row calculations during column transform call.
+  // Improves performance.
+  if (tx_type == kTransformTypeIdentityIdentity &&
+      tx_size == kTransformSize4x4) {
+    return;
+  }
+
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_height = kTransformHeight[tx_size];
+  const bool should_round = (tx_height == 8);
+
+  if (Identity4DcOnly<bitdepth>(src, adjusted_tx_height, should_round,
+                                tx_height)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<4>(src, adjusted_tx_height);
+  }
+
+  const int shift = tx_height > 8 ? 1 : 0;
+  Identity4_AVX2<bitdepth>(src, /*num_values=*/adjusted_tx_height * 4, shift);
+}
+
+template <int bitdepth>
+void Identity4TransformLoopColumn_AVX2(TransformType tx_type,
+                                       TransformSize tx_size,
+                                       int adjusted_tx_height,
+                                       void* LIBGAV1_RESTRICT src_buffer,
+                                       int start_x, int start_y,
+                                       void* LIBGAV1_RESTRICT dst_frame) {
+  auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  // Special case: Process row calculations during column transform call.
+  if (tx_type == kTransformTypeIdentityIdentity &&
+      (tx_size == kTransformSize4x4 || tx_size == kTransformSize8x4)) {
+    Identity4RowColumnStoreToFrame<bitdepth>(frame, start_x, start_y, tx_width,
+                                             adjusted_tx_height, src);
+    return;
+  }
+
+  if (kTransformFlipColumnsMask.Contains(tx_type)) {
+    FlipColumns<4>(src, tx_width);
+  }
+
+  IdentityColumnStoreToFrame<bitdepth, 4>(frame, start_x, start_y, tx_width,
+                                          adjusted_tx_height, src);
+}
+
+template <int bitdepth>
+void Identity8TransformLoopRow_AVX2(TransformType tx_type,
+                                    TransformSize tx_size,
+                                    int adjusted_tx_height, void* src_buffer,
+                                    int /*start_x*/, int /*start_y*/,
+                                    void* /*dst_frame*/) {
+  // Special case: Process row calculations during column transform call.
+  // Improves performance.
+  if (tx_type == kTransformTypeIdentityIdentity &&
+      tx_size == kTransformSize8x4) {
+    return;
+  }
+
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_height = kTransformHeight[tx_size];
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  if (Identity8DcOnly<bitdepth>(src, adjusted_tx_height, should_round,
+                                row_shift)) {
+    return;
+  }
+  if (should_round) {
+    ApplyRounding<8>(src, adjusted_tx_height);
+  }
+
+  // When combining the identity8 multiplier with the row shift, the
+  // calculations for tx_height == 8 and tx_height == 16 can be simplified
+  // from ((A * 2) + 1) >> 1) to A. For 10bpp, A must be clamped to a signed 16
+  // bit value.
+  if ((tx_height & 0x18) != 0) {
+    for (int i = 0; i < tx_height; ++i) {
+      const __m256i v_src = LoadUnaligned32(&src[i * 8]);
+      StoreUnaligned32(&src[i * 8], ClampIntermediate<bitdepth>(v_src));
+    }
+    return;
+  }
+  if (tx_height == 32) {
+    Identity8Row32_AVX2<bitdepth>(src, /*num_values=*/adjusted_tx_height * 8);
+    return;
+  }
+
+  assert(tx_size == kTransformSize8x4);
+  Identity8Row4_AVX2<bitdepth>(src, /*num_values=*/adjusted_tx_height * 8);
+}
+
+template <int bitdepth>
+void Identity8TransformLoopColumn_AVX2(TransformType tx_type,
+                                       TransformSize tx_size,
+                                       int adjusted_tx_height,
+                                       void* LIBGAV1_RESTRICT src_buffer,
+                                       int start_x, int start_y,
+                                       void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (kTransformFlipColumnsMask.Contains(tx_type)) {
+    FlipColumns<8>(src, tx_width);
+  }
+  auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
+  IdentityColumnStoreToFrame<bitdepth, 8>(frame, start_x, start_y, tx_width,
+                                          adjusted_tx_height, src);
+}
+
+template <int bitdepth>
+void Identity16TransformLoopRow_AVX2(TransformType /*tx_type*/,
+                                     TransformSize tx_size,
+                                     int adjusted_tx_height, void* src_buffer,
+                                     int /*start_x*/, int /*start_y*/,
+                                     void* /*dst_frame*/) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  if (Identity16DcOnly<bitdepth>(src, adjusted_tx_height, should_round,
+                                 row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<16>(src, adjusted_tx_height);
+  }
+  Identity16Row_AVX2<bitdepth>(src, /*num_values=*/adjusted_tx_height * 16,
+                               row_shift);
+}
+
+template <int bitdepth>
+void Identity16TransformLoopColumn_AVX2(TransformType tx_type,
+                                        TransformSize tx_size,
+                                        int adjusted_tx_height,
+                                        void* LIBGAV1_RESTRICT src_buffer,
+                                        int start_x, int start_y,
+                                        void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (kTransformFlipColumnsMask.Contains(tx_type)) {
+    FlipColumns<16>(src, tx_width);
+  }
+  auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
+  IdentityColumnStoreToFrame<bitdepth, 16>(frame, start_x, start_y, tx_width,
+                                           adjusted_tx_height, src);
+}
+
+void Identity32TransformLoopRow_AVX2(TransformType /*tx_type*/,
+                                     TransformSize tx_size,
+                                     int adjusted_tx_height, void* src_buffer,
+                                     int /*start_x*/, int /*start_y*/,
+                                     void* /*dst_frame*/) {
+  const int tx_height = kTransformHeight[tx_size];
+
+  // When combining the identity32 multiplier with the row shift, the
+  // calculations for tx_height == 8 and tx_height == 32 can be simplified
+  // from ((A * 4) + 2) >> 2) to A.
+  if ((tx_height & 0x28) != 0) {
+    return;
+  }
+
+  // Process kTransformSize32x16. The src is always rounded before the identity
+  // transform and shifted by 1 afterwards.
+  auto* src = static_cast<int32_t*>(src_buffer);
+  if (Identity32DcOnly(src, adjusted_tx_height)) {
+    return;
+  }
+
+  assert(tx_size == kTransformSize32x16);
+  ApplyRounding<32>(src, adjusted_tx_height);
+  Identity32Row16_AVX2(src, /*num_values=*/adjusted_tx_height * 32);
+}
+
+template <int bitdepth>
+void Identity32TransformLoopColumn_AVX2(TransformType /*tx_type*/,
+                                        TransformSize tx_size,
+                                        int adjusted_tx_height,
+                                        void* LIBGAV1_RESTRICT src_buffer,
+                                        int start_x, int start_y,
+                                        void* LIBGAV1_RESTRICT dst_frame) {
+  auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  IdentityColumnStoreToFrame<bitdepth, 32>(frame, start_x, start_y, tx_width,
+                                           adjusted_tx_height, src);
+}
+
+//------------------------------------------------------------------------------
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+
+  // Maximum transform size for Dct is 64.
+#if DSP_ENABLED_10BPP_AVX2(Transform1dSize4_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize4][kRow] =
+      Dct4TransformLoopRow_AVX2<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize4][kColumn] =
+      Dct4TransformLoopColumn_AVX2<kBitdepth10>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(Transform1dSize8_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize8][kRow] =
+      Dct8TransformLoopRow_AVX2<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize8][kColumn] =
+      Dct8TransformLoopColumn_AVX2<kBitdepth10>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(Transform1dSize16_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize16][kRow] =
+      Dct16TransformLoopRow_AVX2<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize16][kColumn] =
+      Dct16TransformLoopColumn_AVX2<kBitdepth10>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(Transform1dSize32_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize32][kRow] =
+      Dct32TransformLoopRow_AVX2<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize32][kColumn] =
+      Dct32TransformLoopColumn_AVX2<kBitdepth10>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(Transform1dSize64_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kRow] =
+      Dct64TransformLoopRow_AVX2<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kColumn] =
+      Dct64TransformLoopColumn_AVX2<kBitdepth10>;
+#endif
+
+  // Maximum transform size for Adst is 16.
+#if DSP_ENABLED_10BPP_AVX2(Transform1dSize4_Transform1dAdst)
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize4][kRow] =
+      Adst4TransformLoopRow_AVX2<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize4][kColumn] =
+      Adst4TransformLoopColumn_AVX2<kBitdepth10>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(Transform1dSize8_Transform1dAdst)
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize8][kRow] =
+      Adst8TransformLoopRow_AVX2<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize8][kColumn] =
+      Adst8TransformLoopColumn_AVX2<kBitdepth10>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(Transform1dSize16_Transform1dAdst)
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize16][kRow] =
+      Adst16TransformLoopRow_AVX2<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize16][kColumn] =
+      Adst16TransformLoopColumn_AVX2<kBitdepth10>;
+#endif
+
+  // Maximum transform size for Identity transform is 32.
+#if DSP_ENABLED_10BPP_AVX2(Transform1dSize4_Transform1dIdentity)
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize4][kRow] =
+      Identity4TransformLoopRow_AVX2<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize4][kColumn] =
+      Identity4TransformLoopColumn_AVX2<kBitdepth10>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(Transform1dSize8_Transform1dIdentity)
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize8][kRow] =
+      Identity8TransformLoopRow_AVX2<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize8][kColumn] =
+      Identity8TransformLoopColumn_AVX2<kBitdepth10>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(Transform1dSize16_Transform1dIdentity)
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize16][kRow] =
+      Identity16TransformLoopRow_AVX2<kBitdepth10>;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize16][kColumn] =
+      Identity16TransformLoopColumn_AVX2<kBitdepth10>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(Transform1dSize32_Transform1dIdentity)
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize32][kRow] =
+      Identity32TransformLoopRow_AVX2;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize32][kColumn] =
+      Identity32TransformLoopColumn_AVX2<kBitdepth10>;
+#endif
+}
+
+#if LIBGAV1_MAX_BITDEPTH == 12
+void Init12bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth12);
+  assert(dsp != nullptr);
+
+  // Maximum transform size for Dct is 64.
+#if DSP_ENABLED_12BPP_AVX2(Transform1dSize4_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize4][kRow] =
+      Dct4TransformLoopRow_AVX2<kBitdepth12>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize4][kColumn] =
+      Dct4TransformLoopColumn_AVX2<kBitdepth12>;
+#endif
+#if DSP_ENABLED_12BPP_AVX2(Transform1dSize8_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize8][kRow] =
+      Dct8TransformLoopRow_AVX2<kBitdepth12>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize8][kColumn] =
+      Dct8TransformLoopColumn_AVX2<kBitdepth12>;
+#endif
+#if DSP_ENABLED_12BPP_AVX2(Transform1dSize16_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize16][kRow] =
+      Dct16TransformLoopRow_AVX2<kBitdepth12>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize16][kColumn] =
+      Dct16TransformLoopColumn_AVX2<kBitdepth12>;
+#endif
+#if DSP_ENABLED_12BPP_AVX2(Transform1dSize32_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize32][kRow] =
+      Dct32TransformLoopRow_AVX2<kBitdepth12>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize32][kColumn] =
+      Dct32TransformLoopColumn_AVX2<kBitdepth12>;
+#endif
+#if DSP_ENABLED_12BPP_AVX2(Transform1dSize64_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kRow] =
+      Dct64TransformLoopRow_AVX2<kBitdepth12>;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kColumn] =
+      Dct64TransformLoopColumn_AVX2<kBitdepth12>;
+#endif
+
+  // Maximum transform size for Adst is 16.
+#if DSP_ENABLED_12BPP_AVX2(Transform1dSize4_Transform1dAdst)
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize4][kRow] =
+      Adst4TransformLoopRow_AVX2<kBitdepth12>;
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize4][kColumn] =
+      Adst4TransformLoopColumn_AVX2<kBitdepth12>;
+#endif
+#if DSP_ENABLED_12BPP_AVX2(Transform1dSize8_Transform1dAdst)
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize8][kRow] =
+      Adst8TransformLoopRow_AVX2<kBitdepth12>;
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize8][kColumn] =
+      Adst8TransformLoopColumn_AVX2<kBitdepth12>;
+#endif
+#if DSP_ENABLED_12BPP_AVX2(Transform1dSize16_Transform1dAdst)
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize16][kRow] =
+      Adst16TransformLoopRow_AVX2<kBitdepth12>;
+  dsp->inverse_transforms[kTransform1dAdst][kTransform1dSize16][kColumn] =
+      Adst16TransformLoopColumn_AVX2<kBitdepth12>;
+#endif
+
+  // Maximum transform size for Identity transform is 32.
+#if DSP_ENABLED_12BPP_AVX2(Transform1dSize4_Transform1dIdentity)
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize4][kRow] =
+      Identity4TransformLoopRow_AVX2<kBitdepth12>;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize4][kColumn] =
+      Identity4TransformLoopColumn_AVX2<kBitdepth12>;
+#endif
+#if DSP_ENABLED_12BPP_AVX2(Transform1dSize8_Transform1dIdentity)
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize8][kRow] =
+      Identity8TransformLoopRow_AVX2<kBitdepth12>;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize8][kColumn] =
+      Identity8TransformLoopColumn_AVX2<kBitdepth12>;
+#endif
+#if DSP_ENABLED_12BPP_AVX2(Transform1dSize16_Transform1dIdentity)
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize16][kRow] =
+      Identity16TransformLoopRow_AVX2<kBitdepth12>;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize16][kColumn] =
+      Identity16TransformLoopColumn_AVX2<kBitdepth12>;
+#endif
+#if DSP_ENABLED_12BPP_AVX2(Transform1dSize32_Transform1dIdentity)
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize32][kRow] =
+      Identity32TransformLoopRow_AVX2;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize32][kColumn] =
+      Identity32TransformLoopColumn_AVX2<kBitdepth12>;
+#endif
+}
+#endif  // LIBGAV1_MAX_BITDEPTH == 12
+
+}  // namespace
+
+void InverseTransformInit10bpp_AVX2() {
+  Init10bpp();
+#if LIBGAV1_MAX_BITDEPTH == 12
+  Init12bpp();
+#endif
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+#else   // !(LIBGAV1_TARGETING_AVX2 && LIBGAV1_MAX_BITDEPTH >= 10)
+namespace libgav1 {
+namespace dsp {
+
+void InverseTransformInit10bpp_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2 && LIBGAV1_MAX_BITDEPTH >= 10
@@ -0,0 +1,1414 @@
+// Copyright 2023 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/inverse_transform.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/array_2d.h"
+#include "src/utils/common.h"
+#include "src/utils/compiler_attributes.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace low_bitdepth {
+namespace {
+
+// Include the constants and utility functions inside the anonymous namespace.
+#include "src/dsp/inverse_transform.inc"
+
+// Transposes the 8x8 blocks held in each 128-bit lane of |in|.
+LIBGAV1_ALWAYS_INLINE void Transpose8x8_U16(const __m256i* const in,
+                                            __m256i* const out) {
+  // in (per lane):
+  // 00 01 02 03  04 05 06 07
+  // ...
+  // 70 71 72 73  74 75 76 77
+  const __m256i a0 = _mm256_unpacklo_epi16(in[0], in[1]);
+  const __m256i a1 = _mm256_unpacklo_epi16(in[2], in[3]);
+  const __m256i a2 = _mm256_unpacklo_epi16(in[4], in[5]);
+  const __m256i a3 = _mm256_unpacklo_epi16(in[6], in[7]);
+  const __m256i a4 = _mm256_unpackhi_epi16(in[0], in[1]);
+  const __m256i a5 = _mm256_unpackhi_epi16(in[2], in[3]);
+  const __m256i a6 = _mm256_unpackhi_epi16(in[4], in[5]);
+  const __m256i a7 = _mm256_unpackhi_epi16(in[6], in[7]);
+
+  const __m256i b0 = _mm256_unpacklo_epi32(a0, a1);
+  const __m256i b1 = _mm256_unpacklo_epi32(a2, a3);
+  const __m256i b2 = _mm256_unpacklo_epi32(a4, a5);
+  const __m256i b3 = _mm256_unpacklo_epi32(a6, a7);
+  const __m256i b4 = _mm256_unpackhi_epi32(a0, a1);
+  const __m256i b5 = _mm256_unpackhi_epi32(a2, a3);
+  const __m256i b6 = _mm256_unpackhi_epi32(a4, a5);
+  const __m256i b7 = _mm256_unpackhi_epi32(a6, a7);
+
+  out[0] = _mm256_unpacklo_epi64(b0, b1);
+  out[1] = _mm256_unpackhi_epi64(b0, b1);
+  out[2] = _mm256_unpacklo_epi64(b4, b5);
+  out[3] = _mm256_unpackhi_epi64(b4, b5);
+  out[4] = _mm256_unpacklo_epi64(b2, b3);
+  out[5] = _mm256_unpackhi_epi64(b2, b3);
+  out[6] = _mm256_unpacklo_epi64(b6, b7);
+  out[7] = _mm256_unpackhi_epi64(b6, b7);
+  // out (per lane):
+  // 00 10 20 30  40 50 60 70
+  // ...
+  // 07 17 27 37  47 57 67 77
+}
+
+//------------------------------------------------------------------------------
+// The row transforms process up to 16 rows at a time. Rows 0-7 are held in the
+// low 128 bits of each register and rows 8-15 in the high 128 bits, which
+// allows the 8x8 transposes to be done per lane. Rows beyond |num_rows| are
+// neither loaded nor stored.
+template <int load_count>
+LIBGAV1_ALWAYS_INLINE void LoadRows(const int16_t* LIBGAV1_RESTRICT src,
+                                    int32_t stride, int num_rows, __m256i* x) {
+  static_assert(load_count % 8 == 0, "");
+  for (int idx = 0; idx < load_count; idx += 8) {
+    __m256i v[8];
+    for (int i = 0; i < 8; ++i) {
+      if (i >= num_rows) {
+        v[i] = _mm256_setzero_si256();
+        continue;
+      }
+      const __m128i lo = LoadUnaligned16(&src[i * stride + idx]);
+      v[i] = (i + 8 < num_rows)
+                 ? SetrM128i(lo, LoadUnaligned16(&src[(i + 8) * stride + idx]))
+                 : _mm256_castsi128_si256(lo);
+    }
+    Transpose8x8_U16(v, &x[idx]);
+  }
+}
+
+template <int store_count>
+LIBGAV1_ALWAYS_INLINE void StoreRows(int16_t* LIBGAV1_RESTRICT dst,
+                                     int32_t stride, int num_rows,
+                                     const __m256i* x) {
+  static_assert(store_count % 8 == 0, "");
+  const int lo_rows = std::min(num_rows, 8);
+  for (int idx = 0; idx < store_count; idx += 8) {
+    __m256i v[8];
+    Transpose8x8_U16(&x[idx], v);
+    for (int i = 0; i < lo_rows; ++i) {
+      StoreUnaligned16(&dst[i * stride + idx], _mm256_castsi256_si128(v[i]));
+      if (i + 8 < num_rows) {
+        StoreUnaligned16(&dst[(i + 8) * stride + idx],
+                         _mm256_extracti128_si256(v[i], 1));
+      }
+    }
+  }
+}
+
+// The column transforms process up to 16 columns at a time, one row per
+// register. |num_columns| is 4, 8 or 16.
+template <int load_count>
+LIBGAV1_ALWAYS_INLINE void LoadColumns(const int16_t* LIBGAV1_RESTRICT src,
+                                       int32_t stride, int num_columns,
+                                       __m256i* x) {
+  for (int i = 0; i < load_count; ++i) {
+    if (num_columns == 16) {
+      x[i] = LoadUnaligned32(&src[i * stride]);
+    } else if (num_columns == 8) {
+      x[i] = _mm256_castsi128_si256(LoadUnaligned16(&src[i * stride]));
+    } else {
+      x[i] = _mm256_castsi128_si256(LoadLo8(&src[i * stride]));
+    }
+  }
+}
+
+template <int store_count>
+LIBGAV1_ALWAYS_INLINE void StoreColumns(int16_t* LIBGAV1_RESTRICT dst,
+                                        int32_t stride, int num_columns,
+                                        const __m256i* x) {
+  for (int i = 0; i < store_count; ++i) {
+    if (num_columns == 16) {
+      StoreUnaligned32(&dst[i * stride], x[i]);
+    } else if (num_columns == 8) {
+      StoreUnaligned16(&dst[i * stride], _mm256_castsi256_si128(x[i]));
+    } else {
+      StoreLo8(&dst[i * stride], _mm256_castsi256_si128(x[i]));
+    }
+  }
+}
+
+// Butterfly rotate 16 values.
+LIBGAV1_ALWAYS_INLINE void ButterflyRotation_16(__m256i* a, __m256i* b,
+                                                const int angle,
+                                                const bool flip) {
+  const int16_t cos128 = Cos128(angle);
+  const int16_t sin128 = Sin128(angle);
+  const __m256i psin_pcos = _mm256_set1_epi32(
+      static_cast<uint16_t>(cos128) | (static_cast<uint32_t>(sin128) << 16));
+  const __m256i sign = _mm256_set1_epi32(static_cast<int>(0x80000001));
+  // -sin cos, -sin cos, -sin cos, -sin cos
+  const __m256i msin_pcos = _mm256_sign_epi16(psin_pcos, sign);
+  const __m256i ba = _mm256_unpacklo_epi16(*a, *b);
+  const __m256i ab = _mm256_unpacklo_epi16(*b, *a);
+  const __m256i ba_hi = _mm256_unpackhi_epi16(*a, *b);
+  const __m256i ab_hi = _mm256_unpackhi_epi16(*b, *a);
+  const __m256i x0 = _mm256_madd_epi16(ba, msin_pcos);
+  const __m256i y0 = _mm256_madd_epi16(ab, psin_pcos);
+  const __m256i x0_hi = _mm256_madd_epi16(ba_hi, msin_pcos);
+  const __m256i y0_hi = _mm256_madd_epi16(ab_hi, psin_pcos);
+  const __m256i x1 = RightShiftWithRounding_S32(x0, 12);
+  const __m256i y1 = RightShiftWithRounding_S32(y0, 12);
+  const __m256i x1_hi = RightShiftWithRounding_S32(x0_hi, 12);
+  const __m256i y1_hi = RightShiftWithRounding_S32(y0_hi, 12);
+  // The unpacks and packs both work per lane, so the order is preserved.
+  const __m256i x = _mm256_packs_epi32(x1, x1_hi);
+  const __m256i y = _mm256_packs_epi32(y1, y1_hi);
+  if (flip) {
+    *a = y;
+    *b = x;
+  } else {
+    *a = x;
+    *b = y;
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE void ButterflyRotation_FirstIsZero(__m256i* a, __m256i* b,
+                                                         const int angle,
+                                                         const bool flip) {
+  const int16_t cos128 = Cos128(angle);
+  const int16_t sin128 = Sin128(angle);
+  const __m256i pcos = _mm256_set1_epi16(cos128 << 3);
+  const __m256i psin = _mm256_set1_epi16(-(sin128 << 3));
+  const __m256i x = _mm256_mulhrs_epi16(*b, psin);
+  const __m256i y = _mm256_mulhrs_epi16(*b, pcos);
+  if (flip) {
+    *a = y;
+    *b = x;
+  } else {
+    *a = x;
+    *b = y;
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE void ButterflyRotation_SecondIsZero(__m256i* a,
+                                                          __m256i* b,
+                                                          const int angle,
+                                                          const bool flip) {
+  const int16_t cos128 = Cos128(angle);
+  const int16_t sin128 = Sin128(angle);
+  const __m256i pcos = _mm256_set1_epi16(cos128 << 3);
+  const __m256i psin = _mm256_set1_epi16(sin128 << 3);
+  const __m256i x = _mm256_mulhrs_epi16(*a, pcos);
+  const __m256i y = _mm256_mulhrs_epi16(*a, psin);
+  if (flip) {
+    *a = y;
+    *b = x;
+  } else {
+    *a = x;
+    *b = y;
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE void HadamardRotation(__m256i* a, __m256i* b, bool flip) {
+  __m256i x, y;
+  if (flip) {
+    y = _mm256_adds_epi16(*b, *a);
+    x = _mm256_subs_epi16(*b, *a);
+  } else {
+    x = _mm256_adds_epi16(*a, *b);
+    y = _mm256_subs_epi16(*a, *b);
+  }
+  *a = x;
+  *b = y;
+}
+
+LIBGAV1_ALWAYS_INLINE __m256i ShiftResidual(const __m256i residual,
+                                            const __m256i v_row_shift_add,
+                                            const __m128i v_row_shift) {
+  const __m256i k7ffd = _mm256_set1_epi16(0x7ffd);
+  // The max row_shift is 2, so int16_t values greater than 0x7ffd may
+  // overflow.  Generate a mask for this case.
+  const __m256i mask = _mm256_cmpgt_epi16(residual, k7ffd);
+  const __m256i x = _mm256_add_epi16(residual, v_row_shift_add);
+  // Assume int16_t values.
+  const __m256i a = _mm256_sra_epi16(x, v_row_shift);
+  // Assume uint16_t values.
+  const __m256i b = _mm256_srl_epi16(x, v_row_shift);
+  // Select the correct shifted value.
+  return _mm256_blendv_epi8(a, b, mask);
+}
+
+//------------------------------------------------------------------------------
+// Discrete Cosine Transforms (DCT).
+
+template <int width>
+LIBGAV1_ALWAYS_INLINE bool DctDcOnly(void* dest, int adjusted_tx_height,
+                                     bool should_round, int row_shift) {
+  static_assert(width >= 16, "");
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int16_t*>(dest);
+  const __m128i v_src = _mm_set1_epi16(dst[0]);
+  const __m128i v_mask =
+      _mm_set1_epi16(should_round ? static_cast<int16_t>(0xffff) : 0);
+  const __m128i v_kTransformRowMultiplier =
+      _mm_set1_epi16(kTransformRowMultiplier << 3);
+  const __m128i v_src_round =
+      _mm_mulhrs_epi16(v_src, v_kTransformRowMultiplier);
+  const __m128i s0 = _mm_blendv_epi8(v_src, v_src_round, v_mask);
+  const int16_t cos128 = Cos128(32);
+  const __m128i xy = _mm_mulhrs_epi16(s0, _mm_set1_epi16(cos128 << 3));
+
+  // Expand to 32 bits to prevent int16_t overflows during the shift add.
+  const __m128i v_row_shift_add = _mm_set1_epi32(row_shift);
+  const __m128i v_row_shift = _mm_cvtepu32_epi64(v_row_shift_add);
+  const __m128i a = _mm_cvtepi16_epi32(xy);
+  const __m128i b = _mm_add_epi32(a, v_row_shift_add);
+  const __m128i c = _mm_sra_epi32(b, v_row_shift);
+  const __m256i xy_shifted = _mm256_broadcastsi128_si256(_mm_packs_epi32(c, c));
+
+  for (int i = 0; i < width; i += 16) {
+    StoreUnaligned32(&dst[i], xy_shifted);
+  }
+  return true;
+}
+
+template <int height>
+LIBGAV1_ALWAYS_INLINE bool DctDcOnlyColumn(void* dest, int adjusted_tx_height,
+                                           int width) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int16_t*>(dest);
+  const int16_t cos128 = Cos128(32);
+
+  // Calculate dc values for first row.
+  if (width == 4) {
+    const __m128i v_src = LoadLo8(dst);
+    const __m128i xy = _mm_mulhrs_epi16(v_src, _mm_set1_epi16(cos128 << 3));
+    StoreLo8(dst, xy);
+  } else if (width == 8) {
+    const __m128i v_src = LoadUnaligned16(dst);
+    const __m128i xy = _mm_mulhrs_epi16(v_src, _mm_set1_epi16(cos128 << 3));
+    StoreUnaligned16(dst, xy);
+  } else {
+    int i = 0;
+    do {
+      const __m256i v_src = LoadUnaligned32(&dst[i]);
+      const __m256i xy =
+          _mm256_mulhrs_epi16(v_src, _mm256_set1_epi16(cos128 << 3));
+      StoreUnaligned32(&dst[i], xy);
+      i += 16;
+    } while (i < width);
+  }
+
+  // Copy first row to the rest of the block.
+  for (int y = 1; y < height; ++y) {
+    memcpy(&dst[y * width], dst, width * sizeof(dst[0]));
+  }
+  return true;
+}
+
+template <bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct4Stages(__m256i* s) {
+  // stage 12.
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[0], &s[1], 32, true);
+    ButterflyRotation_SecondIsZero(&s[2], &s[3], 48, false);
+  } else {
+    ButterflyRotation_16(&s[0], &s[1], 32, true);
+    ButterflyRotation_16(&s[2], &s[3], 48, false);
+  }
+
+  // stage 17.
+  HadamardRotation(&s[0], &s[3], false);
+  HadamardRotation(&s[1], &s[2], false);
+}
+
+template <bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct8Stages(__m256i* s) {
+  // stage 8.
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[4], &s[7], 56, false);
+    ButterflyRotation_FirstIsZero(&s[5], &s[6], 24, false);
+  } else {
+    ButterflyRotation_16(&s[4], &s[7], 56, false);
+    ButterflyRotation_16(&s[5], &s[6], 24, false);
+  }
+
+  // stage 13.
+  HadamardRotation(&s[4], &s[5], false);
+  HadamardRotation(&s[6], &s[7], true);
+
+  // stage 18.
+  ButterflyRotation_16(&s[6], &s[5], 32, true);
+
+  // stage 22.
+  HadamardRotation(&s[0], &s[7], false);
+  HadamardRotation(&s[1], &s[6], false);
+  HadamardRotation(&s[2], &s[5], false);
+  HadamardRotation(&s[3], &s[4], false);
+}
+
+template <bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct16Stages(__m256i* s) {
+  // stage 5.
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[8], &s[15], 60, false);
+    ButterflyRotation_FirstIsZero(&s[9], &s[14], 28, false);
+    ButterflyRotation_SecondIsZero(&s[10], &s[13], 44, false);
+    ButterflyRotation_FirstIsZero(&s[11], &s[12], 12, false);
+  } else {
+    ButterflyRotation_16(&s[8], &s[15], 60, false);
+    ButterflyRotation_16(&s[9], &s[14], 28, false);
+    ButterflyRotation_16(&s[10], &s[13], 44, false);
+    ButterflyRotation_16(&s[11], &s[12], 12, false);
+  }
+
+  // stage 9.
+  HadamardRotation(&s[8], &s[9], false);
+  HadamardRotation(&s[10], &s[11], true);
+  HadamardRotation(&s[12], &s[13], false);
+  HadamardRotation(&s[14], &s[15], true);
+
+  // stage 14.
+  ButterflyRotation_16(&s[14], &s[9], 48, true);
+  ButterflyRotation_16(&s[13], &s[10], 112, true);
+
+  // stage 19.
+  HadamardRotation(&s[8], &s[11], false);
+  HadamardRotation(&s[9], &s[10], false);
+  HadamardRotation(&s[12], &s[15], true);
+  HadamardRotation(&s[13], &s[14], true);
+
+  // stage 23.
+  ButterflyRotation_16(&s[13], &s[10], 32, true);
+  ButterflyRotation_16(&s[12], &s[11], 32, true);
+
+  // stage 26.
+  HadamardRotation(&s[0], &s[15], false);
+  HadamardRotation(&s[1], &s[14], false);
+  HadamardRotation(&s[2], &s[13], false);
+  HadamardRotation(&s[3], &s[12], false);
+  HadamardRotation(&s[4], &s[11], false);
+  HadamardRotation(&s[5], &s[10], false);
+  HadamardRotation(&s[6], &s[9], false);
+  HadamardRotation(&s[7], &s[8], false);
+}
+
+// Process dct16 rows or columns, depending on the transpose flag. |count| is
+// the number of rows or columns to process.
+LIBGAV1_ALWAYS_INLINE void Dct16_AVX2(void* dest, int32_t step, bool transpose,
+                                      int count) {
+  auto* const dst = static_cast<int16_t*>(dest);
+  __m256i s[16], x[16];
+
+  if (transpose) {
+    LoadRows<16>(dst, step, count, x);
+  } else {
+    LoadColumns<16>(dst, step, count, x);
+  }
+
+  // stage 1
+  // kBitReverseLookup 0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15,
+  s[0] = x[0];
+  s[1] = x[8];
+  s[2] = x[4];
+  s[3] = x[12];
+  s[4] = x[2];
+  s[5] = x[10];
+  s[6] = x[6];
+  s[7] = x[14];
+  s[8] = x[1];
+  s[9] = x[9];
+  s[10] = x[5];
+  s[11] = x[13];
+  s[12] = x[3];
+  s[13] = x[11];
+  s[14] = x[7];
+  s[15] = x[15];
+
+  Dct4Stages(s);
+  Dct8Stages(s);
+  Dct16Stages(s);
+
+  if (transpose) {
+    StoreRows<16>(dst, step, count, s);
+  } else {
+    StoreColumns<16>(dst, step, count, s);
+  }
+}
+
+template <bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct32Stages(__m256i* s) {
+  // stage 3
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[16], &s[31], 62, false);
+    ButterflyRotation_FirstIsZero(&s[17], &s[30], 30, false);
+    ButterflyRotation_SecondIsZero(&s[18], &s[29], 46, false);
+    ButterflyRotation_FirstIsZero(&s[19], &s[28], 14, false);
+    ButterflyRotation_SecondIsZero(&s[20], &s[27], 54, false);
+    ButterflyRotation_FirstIsZero(&s[21], &s[26], 22, false);
+    ButterflyRotation_SecondIsZero(&s[22], &s[25], 38, false);
+    ButterflyRotation_FirstIsZero(&s[23], &s[24], 6, false);
+  } else {
+    ButterflyRotation_16(&s[16], &s[31], 62, false);
+    ButterflyRotation_16(&s[17], &s[30], 30, false);
+    ButterflyRotation_16(&s[18], &s[29], 46, false);
+    ButterflyRotation_16(&s[19], &s[28], 14, false);
+    ButterflyRotation_16(&s[20], &s[27], 54, false);
+    ButterflyRotation_16(&s[21], &s[26], 22, false);
+    ButterflyRotation_16(&s[22], &s[25], 38, false);
+    ButterflyRotation_16(&s[23], &s[24], 6, false);
+  }
+  // stage 6.
+  HadamardRotation(&s[16], &s[17], false);
+  HadamardRotation(&s[18], &s[19], true);
+  HadamardRotation(&s[20], &s[21], false);
+  HadamardRotation(&s[22], &s[23], true);
+  HadamardRotation(&s[24], &s[25], false);
+  HadamardRotation(&s[26], &s[27], true);
+  HadamardRotation(&s[28], &s[29], false);
+  HadamardRotation(&s[30], &s[31], true);
+
+  // stage 10.
+  ButterflyRotation_16(&s[30], &s[17], 24 + 32, true);
+  ButterflyRotation_16(&s[29], &s[18], 24 + 64 + 32, true);
+  ButterflyRotation_16(&s[26], &s[21], 24, true);
+  ButterflyRotation_16(&s[25], &s[22], 24 + 64, true);
+
+  // stage 15.
+  HadamardRotation(&s[16], &s[19], false);
+  HadamardRotation(&s[17], &s[18], false);
+  HadamardRotation(&s[20], &s[23], true);
+  HadamardRotation(&s[21], &s[22], true);
+  HadamardRotation(&s[24], &s[27], false);
+  HadamardRotation(&s[25], &s[26], false);
+  HadamardRotation(&s[28], &s[31], true);
+  HadamardRotation(&s[29], &s[30], true);
+
+  // stage 20.
+  ButterflyRotation_16(&s[29], &s[18], 48, true);
+  ButterflyRotation_16(&s[28], &s[19], 48, true);
+  ButterflyRotation_16(&s[27], &s[20], 48 + 64, true);
+  ButterflyRotation_16(&s[26], &s[21], 48 + 64, true);
+
+  // stage 24.
+  HadamardRotation(&s[16], &s[23], false);
+  HadamardRotation(&s[17], &s[22], false);
+  HadamardRotation(&s[18], &s[21], false);
+  HadamardRotation(&s[19], &s[20], false);
+  HadamardRotation(&s[24], &s[31], true);
+  HadamardRotation(&s[25], &s[30], true);
+  HadamardRotation(&s[26], &s[29], true);
+  HadamardRotation(&s[27], &s[28], true);
+
+  // stage 27.
+  ButterflyRotation_16(&s[27], &s[20], 32, true);
+  ButterflyRotation_16(&s[26], &s[21], 32, true);
+  ButterflyRotation_16(&s[25], &s[22], 32, true);
+  ButterflyRotation_16(&s[24], &s[23], 32, true);
+
+  // stage 29.
+  HadamardRotation(&s[0], &s[31], false);
+  HadamardRotation(&s[1], &s[30], false);
+  HadamardRotation(&s[2], &s[29], false);
+  HadamardRotation(&s[3], &s[28], false);
+  HadamardRotation(&s[4], &s[27], false);
+  HadamardRotation(&s[5], &s[26], false);
+  HadamardRotation(&s[6], &s[25], false);
+  HadamardRotation(&s[7], &s[24], false);
+  HadamardRotation(&s[8], &s[23], false);
+  HadamardRotation(&s[9], &s[22], false);
+  HadamardRotation(&s[10], &s[21], false);
+  HadamardRotation(&s[11], &s[20], false);
+  HadamardRotation(&s[12], &s[19], false);
+  HadamardRotation(&s[13], &s[18], false);
+  HadamardRotation(&s[14], &s[17], false);
+  HadamardRotation(&s[15], &s[16], false);
+}
+
+// Process dct32 rows or columns, depending on the transpose flag. |count| is
+// the number of rows or columns to process.
+LIBGAV1_ALWAYS_INLINE void Dct32_AVX2(void* dest, const int32_t step,
+                                      const bool transpose, const int count) {
+  auto* const dst = static_cast<int16_t*>(dest);
+  __m256i s[32], x[32];
+
+  if (transpose) {
+    LoadRows<32>(dst, step, count, x);
+  } else {
+    LoadColumns<32>(dst, step, count, x);
+  }
+
+  // stage 1
+  // kBitReverseLookup
+  // 0, 16, 8, 24, 4, 20, 12, 28, 2, 18, 10, 26, 6, 22, 14, 30,
+  s[0] = x[0];
+  s[1] = x[16];
+  s[2] = x[8];
+  s[3] = x[24];
+  s[4] = x[4];
+  s[5] = x[20];
+  s[6] = x[12];
+  s[7] = x[28];
+  s[8] = x[2];
+  s[9] = x[18];
+  s[10] = x[10];
+  s[11] = x[26];
+  s[12] = x[6];
+  s[13] = x[22];
+  s[14] = x[14];
+  s[15] = x[30];
+
+  // 1, 17, 9, 25, 5, 21, 13, 29, 3, 19, 11, 27, 7, 23, 15, 31,
+  s[16] = x[1];
+  s[17] = x[17];
+  s[18] = x[9];
+  s[19] = x[25];
+  s[20] = x[5];
+  s[21] = x[21];
+  s[22] = x[13];
+  s[23] = x[29];
+  s[24] = x[3];
+  s[25] = x[19];
+  s[26] = x[11];
+  s[27] = x[27];
+  s[28] = x[7];
+  s[29] = x[23];
+  s[30] = x[15];
+  s[31] = x[31];
+
+  Dct4Stages(s);
+  Dct8Stages(s);
+  Dct16Stages(s);
+  Dct32Stages(s);
+
+  if (transpose) {
+    StoreRows<32>(dst, step, count, s);
+  } else {
+    StoreColumns<32>(dst, step, count, s);
+  }
+}
+
+// Allow the compiler to call this function instead of force inlining. Tests
+// show the performance is slightly faster.
+void Dct64_AVX2(void* dest, int32_t step, bool transpose, int count) {
+  auto* const dst = static_cast<int16_t*>(dest);
+  __m256i s[64], x[32];
+
+  if (transpose) {
+    // The last 32 values of every row are always zero if the |tx_width| is
+    // 64.
+    LoadRows<32>(dst, step, count, x);
+  } else {
+    // The last 32 values of every column are always zero if the |tx_height| is
+    // 64.
+    LoadColumns<32>(dst, step, count, x);
+  }
+
+  // stage 1
+  // kBitReverseLookup
+  // 0, 32, 16, 48, 8, 40, 24, 56, 4, 36, 20, 52, 12, 44, 28, 60,
+  s[0] = x[0];
+  s[2] = x[16];
+  s[4] = x[8];
+  s[6] = x[24];
+  s[8] = x[4];
+  s[10] = x[20];
+  s[12] = x[12];
+  s[14] = x[28];
+
+  // 2, 34, 18, 50, 10, 42, 26, 58, 6, 38, 22, 54, 14, 46, 30, 62,
+  s[16] = x[2];
+  s[18] = x[18];
+  s[20] = x[10];
+  s[22] = x[26];
+  s[24] = x[6];
+  s[26] = x[22];
+  s[28] = x[14];
+  s[30] = x[30];
+
+  // 1, 33, 17, 49, 9, 41, 25, 57, 5, 37, 21, 53, 13, 45, 29, 61,
+  s[32] = x[1];
+  s[34] = x[17];
+  s[36] = x[9];
+  s[38] = x[25];
+  s[40] = x[5];
+  s[42] = x[21];
+  s[44] = x[13];
+  s[46] = x[29];
+
+  // 3, 35, 19, 51, 11, 43, 27, 59, 7, 39, 23, 55, 15, 47, 31, 63
+  s[48] = x[3];
+  s[50] = x[19];
+  s[52] = x[11];
+  s[54] = x[27];
+  s[56] = x[7];
+  s[58] = x[23];
+  s[60] = x[15];
+  s[62] = x[31];
+
+  Dct4Stages</*is_fast_butterfly=*/true>(s);
+  Dct8Stages</*is_fast_butterfly=*/true>(s);
+  Dct16Stages</*is_fast_butterfly=*/true>(s);
+  Dct32Stages</*is_fast_butterfly=*/true>(s);
+
+  //-- start dct 64 stages
+  // stage 2.
+  ButterflyRotation_SecondIsZero(&s[32], &s[63], 63 - 0, false);
+  ButterflyRotation_FirstIsZero(&s[33], &s[62], 63 - 32, false);
+  ButterflyRotation_SecondIsZero(&s[34], &s[61], 63 - 16, false);
+  ButterflyRotation_FirstIsZero(&s[35], &s[60], 63 - 48, false);
+  ButterflyRotation_SecondIsZero(&s[36], &s[59], 63 - 8, false);
+  ButterflyRotation_FirstIsZero(&s[37], &s[58], 63 - 40, false);
+  ButterflyRotation_SecondIsZero(&s[38], &s[57], 63 - 24, false);
+  ButterflyRotation_FirstIsZero(&s[39], &s[56], 63 - 56, false);
+  ButterflyRotation_SecondIsZero(&s[40], &s[55], 63 - 4, false);
+  ButterflyRotation_FirstIsZero(&s[41], &s[54], 63 - 36, false);
+  ButterflyRotation_SecondIsZero(&s[42], &s[53], 63 - 20, false);
+  ButterflyRotation_FirstIsZero(&s[43], &s[52], 63 - 52, false);
+  ButterflyRotation_SecondIsZero(&s[44], &s[51], 63 - 12, false);
+  ButterflyRotation_FirstIsZero(&s[45], &s[50], 63 - 44, false);
+  ButterflyRotation_SecondIsZero(&s[46], &s[49], 63 - 28, false);
+  ButterflyRotation_FirstIsZero(&s[47], &s[48], 63 - 60, false);
+
+  // stage 4.
+  HadamardRotation(&s[32], &s[33], false);
+  HadamardRotation(&s[34], &s[35], true);
+  HadamardRotation(&s[36], &s[37], false);
+  HadamardRotation(&s[38], &s[39], true);
+  HadamardRotation(&s[40], &s[41], false);
+  HadamardRotation(&s[42], &s[43], true);
+  HadamardRotation(&s[44], &s[45], false);
+  HadamardRotation(&s[46], &s[47], true);
+  HadamardRotation(&s[48], &s[49], false);
+  HadamardRotation(&s[50], &s[51], true);
+  HadamardRotation(&s[52], &s[53], false);
+  HadamardRotation(&s[54], &s[55], true);
+  HadamardRotation(&s[56], &s[57], false);
+  HadamardRotation(&s[58], &s[59], true);
+  HadamardRotation(&s[60], &s[61], false);
+  HadamardRotation(&s[62], &s[63], true);
+
+  // stage 7.
+  ButterflyRotation_16(&s[62], &s[33], 60 - 0, true);
+  ButterflyRotation_16(&s[61], &s[34], 60 - 0 + 64, true);
+  ButterflyRotation_16(&s[58], &s[37], 60 - 32, true);
+  ButterflyRotation_16(&s[57], &s[38], 60 - 32 + 64, true);
+  ButterflyRotation_16(&s[54], &s[41], 60 - 16, true);
+  ButterflyRotation_16(&s[53], &s[42], 60 - 16 + 64, true);
+  ButterflyRotation_16(&s[50], &s[45], 60 - 48, true);
+  ButterflyRotation_16(&s[49], &s[46], 60 - 48 + 64, true);
+
+  // stage 11.
+  HadamardRotation(&s[32], &s[35], false);
+  HadamardRotation(&s[33], &s[34], false);
+  HadamardRotation(&s[36], &s[39], true);
+  HadamardRotation(&s[37], &s[38], true);
+  HadamardRotation(&s[40], &s[43], false);
+  HadamardRotation(&s[41], &s[42], false);
+  HadamardRotation(&s[44], &s[47], true);
+  HadamardRotation(&s[45], &s[46], true);
+  HadamardRotation(&s[48], &s[51], false);
+  HadamardRotation(&s[49], &s[50], false);
+  HadamardRotation(&s[52], &s[55], true);
+  HadamardRotation(&s[53], &s[54], true);
+  HadamardRotation(&s[56], &s[59], false);
+  HadamardRotation(&s[57], &s[58], false);
+  HadamardRotation(&s[60], &s[63], true);
+  HadamardRotation(&s[61], &s[62], true);
+
+  // stage 16.
+  ButterflyRotation_16(&s[61], &s[34], 56, true);
+  ButterflyRotation_16(&s[60], &s[35], 56, true);
+  ButterflyRotation_16(&s[59], &s[36], 56 + 64, true);
+  ButterflyRotation_16(&s[58], &s[37], 56 + 64, true);
+  ButterflyRotation_16(&s[53], &s[42], 56 - 32, true);
+  ButterflyRotation_16(&s[52], &s[43], 56 - 32, true);
+  ButterflyRotation_16(&s[51], &s[44], 56 - 32 + 64, true);
+  ButterflyRotation_16(&s[50], &s[45], 56 - 32 + 64, true);
+
+  // stage 21.
+  HadamardRotation(&s[32], &s[39], false);
+  HadamardRotation(&s[33], &s[38], false);
+  HadamardRotation(&s[34], &s[37], false);
+  HadamardRotation(&s[35], &s[36], false);
+  HadamardRotation(&s[40], &s[47], true);
+  HadamardRotation(&s[41], &s[46], true);
+  HadamardRotation(&s[42], &s[45], true);
+  HadamardRotation(&s[43], &s[44], true);
+  HadamardRotation(&s[48], &s[55], false);
+  HadamardRotation(&s[49], &s[54], false);
+  HadamardRotation(&s[50], &s[53], false);
+  HadamardRotation(&s[51], &s[52], false);
+  HadamardRotation(&s[56], &s[63], true);
+  HadamardRotation(&s[57], &s[62], true);
+  HadamardRotation(&s[58], &s[61], true);
+  HadamardRotation(&s[59], &s[60], true);
+
+  // stage 25.
+  ButterflyRotation_16(&s[59], &s[36], 48, true);
+  ButterflyRotation_16(&s[58], &s[37], 48, true);
+  ButterflyRotation_16(&s[57], &s[38], 48, true);
+  ButterflyRotation_16(&s[56], &s[39], 48, true);
+  ButterflyRotation_16(&s[55], &s[40], 112, true);
+  ButterflyRotation_16(&s[54], &s[41], 112, true);
+  ButterflyRotation_16(&s[53], &s[42], 112, true);
+  ButterflyRotation_16(&s[52], &s[43], 112, true);
+
+  // stage 28.
+  HadamardRotation(&s[32], &s[47], false);
+  HadamardRotation(&s[33], &s[46], false);
+  HadamardRotation(&s[34], &s[45], false);
+  HadamardRotation(&s[35], &s[44], false);
+  HadamardRotation(&s[36], &s[43], false);
+  HadamardRotation(&s[37], &s[42], false);
+  HadamardRotation(&s[38], &s[41], false);
+  HadamardRotation(&s[39], &s[40], false);
+  HadamardRotation(&s[48], &s[63], true);
+  HadamardRotation(&s[49], &s[62], true);
+  HadamardRotation(&s[50], &s[61], true);
+  HadamardRotation(&s[51], &s[60], true);
+  HadamardRotation(&s[52], &s[59], true);
+  HadamardRotation(&s[53], &s[58], true);
+  HadamardRotation(&s[54], &s[57], true);
+  HadamardRotation(&s[55], &s[56], true);
+
+  // stage 30.
+  ButterflyRotation_16(&s[55], &s[40], 32, true);
+  ButterflyRotation_16(&s[54], &s[41], 32, true);
+  ButterflyRotation_16(&s[53], &s[42], 32, true);
+  ButterflyRotation_16(&s[52], &s[43], 32, true);
+  ButterflyRotation_16(&s[51], &s[44], 32, true);
+  ButterflyRotation_16(&s[50], &s[45], 32, true);
+  ButterflyRotation_16(&s[49], &s[46], 32, true);
+  ButterflyRotation_16(&s[48], &s[47], 32, true);
+
+  // stage 31.
+  for (int i = 0; i < 32; i += 4) {
+    HadamardRotation(&s[i], &s[63 - i], false);
+    HadamardRotation(&s[i + 1], &s[63 - i - 1], false);
+    HadamardRotation(&s[i + 2], &s[63 - i - 2], false);
+    HadamardRotation(&s[i + 3], &s[63 - i - 3], false);
+  }
+  //-- end dct 64 stages
+
+  if (transpose) {
+    StoreRows<64>(dst, step, count, s);
+  } else {
+    StoreColumns<64>(dst, step, count, s);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Identity Transforms.
+
+LIBGAV1_ALWAYS_INLINE void Identity16Row_AVX2(void* dest, int32_t step,
+                                              int shift) {
+  auto* const dst = static_cast<int16_t*>(dest);
+
+  const __m256i v_dual_round = _mm256_set1_epi16((1 + (shift << 1)) << 11);
+  const __m256i v_multiplier_one =
+      _mm256_set1_epi32((kIdentity16Multiplier << 16) | 0x0001);
+  const __m128i v_shift = _mm_set_epi64x(0, 12 + shift);
+
+  for (int h = 0; h < 4; ++h) {
+    const __m256i v_src = LoadUnaligned32(&dst[h * step]);
+    const __m256i v_src_round0 = _mm256_unpacklo_epi16(v_dual_round, v_src);
+    const __m256i v_src_round1 = _mm256_unpackhi_epi16(v_dual_round, v_src);
+    const __m256i madd0 = _mm256_madd_epi16(v_src_round0, v_multiplier_one);
+    const __m256i madd1 = _mm256_madd_epi16(v_src_round1, v_multiplier_one);
+    const __m256i shift0 = _mm256_sra_epi32(madd0, v_shift);
+    const __m256i shift1 = _mm256_sra_epi32(madd1, v_shift);
+    StoreUnaligned32(&dst[h * step], _mm256_packs_epi32(shift0, shift1));
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE bool Identity16DcOnly(void* dest, int adjusted_tx_height,
+                                            bool should_round, int shift) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int16_t*>(dest);
+  const __m128i v_src0 = _mm_cvtsi32_si128(dst[0]);
+  const __m128i v_mask =
+      _mm_set1_epi16(should_round ? static_cast<int16_t>(0xffff) : 0);
+  const __m128i v_kTransformRowMultiplier =
+      _mm_set1_epi16(kTransformRowMultiplier << 3);
+  const __m128i v_src_round0 =
+      _mm_mulhrs_epi16(v_src0, v_kTransformRowMultiplier);
+  const __m128i v_src = _mm_blendv_epi8(v_src0, v_src_round0, v_mask);
+  const __m128i v_dual_round = _mm_set1_epi16((1 + (shift << 1)) << 11);
+  const __m128i v_multiplier_one =
+      _mm_set1_epi32((kIdentity16Multiplier << 16) | 0x0001);
+  const __m128i v_shift = _mm_set_epi64x(0, 12 + shift);
+  const __m128i v_src_round = _mm_unpacklo_epi16(v_dual_round, v_src);
+  const __m128i a = _mm_madd_epi16(v_src_round, v_multiplier_one);
+  const __m128i b = _mm_sra_epi32(a, v_shift);
+  dst[0] = _mm_extract_epi16(_mm_packs_epi32(b, b), 0);
+  return true;
+}
+
+LIBGAV1_ALWAYS_INLINE void Identity16ColumnStoreToFrame_AVX2(
+    Array2DView<uint8_t> frame, const int start_x, const int start_y,
+    const int tx_width, const int tx_height,
+    const int16_t* LIBGAV1_RESTRICT source) {
+  const int stride = frame.columns();
+  uint8_t* LIBGAV1_RESTRICT dst = frame[start_y] + start_x;
+
+  if (tx_width < 16) {
+    const __m128i v_eight = _mm_set1_epi16(8);
+    const __m128i v_multiplier =
+        _mm_set1_epi16(static_cast<int16_t>(kIdentity4MultiplierFraction << 4));
+    int i = 0;
+    do {
+      const __m128i v_src = (tx_width == 4)
+                                ? LoadLo8(&source[i * tx_width])
+                                : LoadUnaligned16(&source[i * tx_width]);
+      const __m128i v_src_mult = _mm_mulhrs_epi16(v_src, v_multiplier);
+      const __m128i frame_data = (tx_width == 4) ? Load4(dst) : LoadLo8(dst);
+      const __m128i v_srcx2 = _mm_adds_epi16(v_src, v_src);
+      const __m128i v_dst_i = _mm_adds_epi16(v_src_mult, v_srcx2);
+      const __m128i a = _mm_adds_epi16(v_dst_i, v_eight);
+      const __m128i b = _mm_srai_epi16(a, 4);
+      const __m128i c = _mm_cvtepu8_epi16(frame_data);
+      const __m128i d = _mm_adds_epi16(c, b);
+      const __m128i e = _mm_packus_epi16(d, d);
+      if (tx_width == 4) {
+        Store4(dst, e);
+      } else {
+        StoreLo8(dst, e);
+      }
+      dst += stride;
+    } while (++i < tx_height);
+    return;
+  }
+
+  const __m256i v_eight = _mm256_set1_epi16(8);
+  const __m256i v_multiplier = _mm256_set1_epi16(
+      static_cast<int16_t>(kIdentity4MultiplierFraction << 4));
+  int i = 0;
+  do {
+    const int row = i * tx_width;
+    int j = 0;
+    do {
+      const __m256i v_src = LoadUnaligned32(&source[row + j]);
+      const __m256i v_src_mult = _mm256_mulhrs_epi16(v_src, v_multiplier);
+      const __m128i frame_data = LoadUnaligned16(dst + j);
+      const __m256i v_srcx2 = _mm256_adds_epi16(v_src, v_src);
+      const __m256i v_dst_i = _mm256_adds_epi16(v_src_mult, v_srcx2);
+      const __m256i a = _mm256_adds_epi16(v_dst_i, v_eight);
+      const __m256i b = _mm256_srai_epi16(a, 4);
+      const __m256i c = _mm256_cvtepu8_epi16(frame_data);
+      const __m256i d = _mm256_adds_epi16(c, b);
+      // Move the packed values of each lane into the low 128 bits.
+      const __m256i e =
+          _mm256_permute4x64_epi64(_mm256_packus_epi16(d, d), 0x08);
+      StoreUnaligned16(dst + j, _mm256_castsi256_si128(e));
+      j += 16;
+    } while (j < tx_width);
+    dst += stride;
+  } while (++i < tx_height);
+}
+
+LIBGAV1_ALWAYS_INLINE void Identity32Row16_AVX2(void* dest,
+                                                const int32_t step) {
+  auto* const dst = static_cast<int16_t*>(dest);
+
+  // When combining the identity32 multiplier with the row shift, the
+  // calculation for tx_height equal to 16 can be simplified from
+  // ((A * 4) + 1) >> 1) to (A * 2).
+  for (int h = 0; h < 4; ++h) {
+    for (int i = 0; i < 32; i += 16) {
+      const __m256i v_src = LoadUnaligned32(&dst[h * step + i]);
+      // For bitdepth == 8, the identity row clamps to a signed 16bit value, so
+      // saturating add here is ok.
+      const __m256i v_dst_i = _mm256_adds_epi16(v_src, v_src);
+      StoreUnaligned32(&dst[h * step + i], v_dst_i);
+    }
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE bool Identity32DcOnly(void* dest,
+                                            int adjusted_tx_height) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int16_t*>(dest);
+  const __m128i v_src0 = _mm_cvtsi32_si128(dst[0]);
+  const __m128i v_kTransformRowMultiplier =
+      _mm_set1_epi16(kTransformRowMultiplier << 3);
+  const __m128i v_src = _mm_mulhrs_epi16(v_src0, v_kTransformRowMultiplier);
+
+  // When combining the identity32 multiplier with the row shift, the
+  // calculation for tx_height equal to 16 can be simplified from
+  // ((A * 4) + 1) >> 1) to (A * 2).
+  const __m128i v_dst_0 = _mm_adds_epi16(v_src, v_src);
+  dst[0] = _mm_extract_epi16(v_dst_0, 0);
+  return true;
+}
+
+LIBGAV1_ALWAYS_INLINE void Identity32ColumnStoreToFrame(
+    Array2DView<uint8_t> frame, const int start_x, const int start_y,
+    const int tx_width, const int tx_height,
+    const int16_t* LIBGAV1_RESTRICT source) {
+  const int stride = frame.columns();
+  uint8_t* LIBGAV1_RESTRICT dst = frame[start_y] + start_x;
+
+  if (tx_width == 8) {
+    const __m128i v_two = _mm_set1_epi16(2);
+    int i = 0;
+    do {
+      const __m128i v_dst_i = LoadUnaligned16(&source[i * tx_width]);
+      const __m128i frame_data = LoadLo8(dst);
+      const __m128i a = _mm_adds_epi16(v_dst_i, v_two);
+      const __m128i b = _mm_srai_epi16(a, 2);
+      const __m128i c = _mm_cvtepu8_epi16(frame_data);
+      const __m128i d = _mm_adds_epi16(c, b);
+      StoreLo8(dst, _mm_packus_epi16(d, d));
+      dst += stride;
+    } while (++i < tx_height);
+    return;
+  }
+
+  const __m256i v_two = _mm256_set1_epi16(2);
+  int i = 0;
+  do {
+    const int row = i * tx_width;
+    int j = 0;
+    do {
+      const __m256i v_dst_i = LoadUnaligned32(&source[row + j]);
+      const __m128i frame_data = LoadUnaligned16(dst + j);
+      const __m256i a = _mm256_adds_epi16(v_dst_i, v_two);
+      const __m256i b = _mm256_srai_epi16(a, 2);
+      const __m256i c = _mm256_cvtepu8_epi16(frame_data);
+      const __m256i d = _mm256_adds_epi16(c, b);
+      const __m256i e =
+          _mm256_permute4x64_epi64(_mm256_packus_epi16(d, d), 0x08);
+      StoreUnaligned16(dst + j, _mm256_castsi256_si128(e));
+      j += 16;
+    } while (j < tx_width);
+    dst += stride;
+  } while (++i < tx_height);
+}
+
+//------------------------------------------------------------------------------
+// row/column transform loops
+
+LIBGAV1_ALWAYS_INLINE void StoreToFrameWithRound(
+    Array2DView<uint8_t> frame, const int start_x, const int start_y,
+    const int tx_width, const int tx_height,
+    const int16_t* LIBGAV1_RESTRICT source) {
+  const int stride = frame.columns();
+  uint8_t* LIBGAV1_RESTRICT dst = frame[start_y] + start_x;
+  if (tx_width < 16) {
+    const __m128i v_eight = _mm_set1_epi16(8);
+    for (int i = 0; i < tx_height; ++i) {
+      const __m128i residual = (tx_width == 4)
+                                   ? LoadLo8(&source[i * tx_width])
+                                   : LoadUnaligned16(&source[i * tx_width]);
+      const __m128i frame_data = (tx_width == 4) ? Load4(dst) : LoadLo8(dst);
+      // Saturate to prevent overflowing int16_t
+      const __m128i a = _mm_adds_epi16(residual, v_eight);
+      const __m128i b = _mm_srai_epi16(a, 4);
+      const __m128i c = _mm_cvtepu8_epi16(frame_data);
+      const __m128i d = _mm_adds_epi16(c, b);
+      const __m128i e = _mm_packus_epi16(d, d);
+      if (tx_width == 4) {
+        Store4(dst, e);
+      } else {
+        StoreLo8(dst, e);
+      }
+      dst += stride;
+    }
+    return;
+  }
+
+  const __m256i v_eight = _mm256_set1_epi16(8);
+  for (int i = 0; i < tx_height; ++i) {
+    const int row = i * tx_width;
+    int j = 0;
+    do {
+      const __m256i residual = LoadUnaligned32(&source[row + j]);
+      const __m128i frame_data = LoadUnaligned16(dst + j);
+      // Saturate to prevent overflowing int16_t
+      const __m256i a = _mm256_adds_epi16(residual, v_eight);
+      const __m256i b = _mm256_srai_epi16(a, 4);
+      const __m256i c = _mm256_cvtepu8_epi16(frame_data);
+      const __m256i d = _mm256_adds_epi16(c, b);
+      // Move the packed values of each lane into the low 128 bits.
+      const __m256i e =
+          _mm256_permute4x64_epi64(_mm256_packus_epi16(d, d), 0x08);
+      StoreUnaligned16(dst + j, _mm256_castsi256_si128(e));
+      j += 16;
+    } while (j < tx_width);
+    dst += stride;
+  }
+}
+
+template <int tx_height>
+LIBGAV1_ALWAYS_INLINE void FlipColumns(int16_t* source, int tx_width) {
+  const __m128i word_reverse_8 =
+      _mm_set_epi32(0x01000302, 0x05040706, 0x09080b0a, 0x0d0c0f0e);
+  if (tx_width >= 16) {
+    const __m256i word_reverse_16 =
+        _mm256_broadcastsi128_si256(word_reverse_8);
+    int i = 0;
+    do {
+      // Reverse each lane, then swap the lanes.
+      const __m256i a = LoadUnaligned32(&source[i]);
+      const __m256i b = _mm256_shuffle_epi8(a, word_reverse_16);
+      StoreUnaligned32(&source[i], _mm256_permute4x64_epi64(b, 0x4e));
+      i += 16;
+    } while (i < tx_width * tx_height);
+  } else if (tx_width == 8) {
+    for (int i = 0; i < 8 * tx_height; i += 8) {
+      const __m128i a = LoadUnaligned16(&source[i]);
+      const __m128i b = _mm_shuffle_epi8(a, word_reverse_8);
+      StoreUnaligned16(&source[i], b);
+    }
+  } else {
+    const __m128i dual_word_reverse_4 =
+        _mm_set_epi32(0x09080b0a, 0x0d0c0f0e, 0x01000302, 0x05040706);
+    // Process two rows per iteration.
+    for (int i = 0; i < 4 * tx_height; i += 8) {
+      const __m128i a = LoadUnaligned16(&source[i]);
+      const __m128i b = _mm_shuffle_epi8(a, dual_word_reverse_4);
+      StoreUnaligned16(&source[i], b);
+    }
+  }
+}
+
+template <int tx_width>
+LIBGAV1_ALWAYS_INLINE void ApplyRounding(int16_t* source, int num_rows) {
+  static_assert(tx_width >= 16, "");
+  const __m256i v_kTransformRowMultiplier =
+      _mm256_set1_epi16(kTransformRowMultiplier << 3);
+  // The last 32 values of every row are always zero if the |tx_width| is 64.
+  constexpr int non_zero_width = (tx_width < 64) ? tx_width : 32;
+  int i = 0;
+  do {
+    for (int j = 0; j < non_zero_width; j += 16) {
+      const __m256i a = LoadUnaligned32(&source[i * tx_width + j]);
+      const __m256i b = _mm256_mulhrs_epi16(a, v_kTransformRowMultiplier);
+      StoreUnaligned32(&source[i * tx_width + j], b);
+    }
+  } while (++i < num_rows);
+}
+
+template <int tx_width>
+LIBGAV1_ALWAYS_INLINE void RowShift(int16_t* source, int num_rows,
+                                    int row_shift) {
+  static_assert(tx_width >= 16, "");
+  const __m256i v_row_shift_add = _mm256_set1_epi16(row_shift);
+  const __m128i v_row_shift = _mm_cvtsi32_si128(row_shift);
+  int i = 0;
+  do {
+    for (int j = 0; j < tx_width; j += 16) {
+      const __m256i residual = LoadUnaligned32(&source[i * tx_width + j]);
+      const __m256i shifted_residual =
+          ShiftResidual(residual, v_row_shift_add, v_row_shift);
+      StoreUnaligned32(&source[i * tx_width + j], shifted_residual);
+    }
+  } while (++i < num_rows);
+}
+
+void Dct16TransformLoopRow_AVX2(TransformType /*tx_type*/,
+                                TransformSize tx_size, int adjusted_tx_height,
+                                void* src_buffer, int /*start_x*/,
+                                int /*start_y*/, void* /*dst_frame*/) {
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  if (DctDcOnly<16>(src, adjusted_tx_height, should_round, row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<16>(src, adjusted_tx_height);
+  }
+
+  // Process up to 16 1d dct16 rows in parallel per iteration.
+  int i = 0;
+  do {
+    Dct16_AVX2(&src[i * 16], 16, /*transpose=*/true,
+               std::min(adjusted_tx_height - i, 16));
+    i += 16;
+  } while (i < adjusted_tx_height);
+  // row_shift is always non zero here.
+  RowShift<16>(src, adjusted_tx_height, row_shift);
+}
+
+void Dct16TransformLoopColumn_AVX2(TransformType tx_type,
+                                   TransformSize tx_size,
+                                   int adjusted_tx_height,
+                                   void* LIBGAV1_RESTRICT src_buffer,
+                                   int start_x, int start_y,
+                                   void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (kTransformFlipColumnsMask.Contains(tx_type)) {
+    FlipColumns<16>(src, tx_width);
+  }
+
+  if (!DctDcOnlyColumn<16>(src, adjusted_tx_height, tx_width)) {
+    // Process up to 16 1d dct16 columns in parallel per iteration.
+    int i = 0;
+    do {
+      Dct16_AVX2(&src[i], tx_width, /*transpose=*/false,
+                 std::min(tx_width, 16));
+      i += 16;
+    } while (i < tx_width);
+  }
+  auto& frame = *static_cast<Array2DView<uint8_t>*>(dst_frame);
+  StoreToFrameWithRound(frame, start_x, start_y, tx_width, 16, src);
+}
+
+void Dct32TransformLoopRow_AVX2(TransformType /*tx_type*/,
+                                TransformSize tx_size, int adjusted_tx_height,
+                                void* src_buffer, int /*start_x*/,
+                                int /*start_y*/, void* /*dst_frame*/) {
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  if (DctDcOnly<32>(src, adjusted_tx_height, should_round, row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<32>(src, adjusted_tx_height);
+  }
+  // Process up to 16 1d dct32 rows in parallel per iteration.
+  int i = 0;
+  do {
+    Dct32_AVX2(&src[i * 32], 32, /*transpose=*/true,
+               std::min(adjusted_tx_height - i, 16));
+    i += 16;
+  } while (i < adjusted_tx_height);
+  // row_shift is always non zero here.
+  RowShift<32>(src, adjusted_tx_height, row_shift);
+}
+
+void Dct32TransformLoopColumn_AVX2(TransformType /*tx_type*/,
+                                   TransformSize tx_size,
+                                   int adjusted_tx_height,
+                                   void* LIBGAV1_RESTRICT src_buffer,
+                                   int start_x, int start_y,
+                                   void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (!DctDcOnlyColumn<32>(src, adjusted_tx_height, tx_width)) {
+    // Process up to 16 1d dct32 columns in parallel per iteration.
+    int i = 0;
+    do {
+      Dct32_AVX2(&src[i], tx_width, /*transpose=*/false,
+                 std::min(tx_width, 16));
+      i += 16;
+    } while (i < tx_width);
+  }
+  auto& frame = *static_cast<Array2DView<uint8_t>*>(dst_frame);
+  StoreToFrameWithRound(frame, start_x, start_y, tx_width, 32, src);
+}
+
+void Dct64TransformLoopRow_AVX2(TransformType /*tx_type*/,
+                                TransformSize tx_size, int adjusted_tx_height,
+                                void* src_buffer, int /*start_x*/,
+                                int /*start_y*/, void* /*dst_frame*/) {
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  if (DctDcOnly<64>(src, adjusted_tx_height, should_round, row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<64>(src, adjusted_tx_height);
+  }
+  // Process up to 16 1d dct64 rows in parallel per iteration.
+  int i = 0;
+  do {
+    Dct64_AVX2(&src[i * 64], 64, /*transpose=*/true,
+               std::min(adjusted_tx_height - i, 16));
+    i += 16;
+  } while (i < adjusted_tx_height);
+  // row_shift is always non zero here.
+  RowShift<64>(src, adjusted_tx_height, row_shift);
+}
+
+void Dct64TransformLoopColumn_AVX2(TransformType /*tx_type*/,
+                                   TransformSize tx_size,
+                                   int adjusted_tx_height,
+                                   void* LIBGAV1_RESTRICT src_buffer,
+                                   int start_x, int start_y,
+                                   void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (!DctDcOnlyColumn<64>(src, adjusted_tx_height, tx_width)) {
+    // Process 16 1d dct64 columns in parallel per iteration.
+    int i = 0;
+    do {
+      Dct64_AVX2(&src[i], tx_width, /*transpose=*/false, 16);
+      i += 16;
+    } while (i < tx_width);
+  }
+  auto& frame = *static_cast<Array2DView<uint8_t>*>(dst_frame);
+  StoreToFrameWithRound(frame, start_x, start_y, tx_width, 64, src);
+}
+
+void Identity16TransformLoopRow_AVX2(TransformType /*tx_type*/,
+                                     TransformSize tx_size,
+                                     int adjusted_tx_height, void* src_buffer,
+                                     int /*start_x*/, int /*start_y*/,
+                                     void* /*dst_frame*/) {
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+  if (Identity16DcOnly(src, adjusted_tx_height, should_round, row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<16>(src, adjusted_tx_height);
+  }
+  int i = 0;
+  do {
+    Identity16Row_AVX2(&src[i * 16], /*step=*/16, row_shift);
+    i += 4;
+  } while (i < adjusted_tx_height);
+}
+
+void Identity16TransformLoopColumn_AVX2(TransformType tx_type,
+                                        TransformSize tx_size,
+                                        int adjusted_tx_height,
+                                        void* LIBGAV1_RESTRICT src_buffer,
+                                        int start_x, int start_y,
+                                        void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (kTransformFlipColumnsMask.Contains(tx_type)) {
+    FlipColumns<16>(src, tx_width);
+  }
+  auto& frame = *static_cast<Array2DView<uint8_t>*>(dst_frame);
+  Identity16ColumnStoreToFrame_AVX2(frame, start_x, start_y, tx_width,
+                                    adjusted_tx_height, src);
+}
+
+void Identity32TransformLoopRow_AVX2(TransformType /*tx_type*/,
+                                     TransformSize tx_size,
+                                     int adjusted_tx_height, void* src_buffer,
+                                     int /*start_x*/, int /*start_y*/,
+                                     void* /*dst_frame*/) {
+  const int tx_height = kTransformHeight[tx_size];
+  // When combining the identity32 multiplier with the row shift, the
+  // calculations for tx_height == 8 and tx_height == 32 can be simplified
+  // from ((A * 4) + 2) >> 2) to A.
+  if ((tx_height & 0x28) != 0) {
+    return;
+  }
+
+  // Process kTransformSize32x16. The src is always rounded before the
+  // identity transform and shifted by 1 afterwards.
+  auto* src = static_cast<int16_t*>(src_buffer);
+  if (Identity32DcOnly(src, adjusted_tx_height)) {
+    return;
+  }
+
+  assert(tx_size == kTransformSize32x16);
+  ApplyRounding<32>(src, adjusted_tx_height);
+  int i = 0;
+  do {
+    Identity32Row16_AVX2(&src[i * 32], /*step=*/32);
+    i += 4;
+  } while (i < adjusted_tx_height);
+}
+
+void Identity32TransformLoopColumn_AVX2(TransformType /*tx_type*/,
+                                        TransformSize tx_size,
+                                        int adjusted_tx_height,
+                                        void* LIBGAV1_RESTRICT src_buffer,
+                                        int start_x, int start_y,
+                                        void* LIBGAV1_RESTRICT dst_frame) {
+  auto& frame = *static_cast<Array2DView<uint8_t>*>(dst_frame);
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  Identity32ColumnStoreToFrame(frame, start_x, start_y, tx_width,
+                               adjusted_tx_height, src);
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+
+  // The 4 and 8 point transforms and all of the Adst sizes are left to the
+  // SSE4.1 implementation.
+#if DSP_ENABLED_8BPP_AVX2(Transform1dSize16_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize16][kRow] =
+      Dct16TransformLoopRow_AVX2;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize16][kColumn] =
+      Dct16TransformLoopColumn_AVX2;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(Transform1dSize32_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize32][kRow] =
+      Dct32TransformLoopRow_AVX2;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize32][kColumn] =
+      Dct32TransformLoopColumn_AVX2;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(Transform1dSize64_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kRow] =
+      Dct64TransformLoopRow_AVX2;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kColumn] =
+      Dct64TransformLoopColumn_AVX2;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(Transform1dSize16_Transform1dIdentity)
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize16][kRow] =
+      Identity16TransformLoopRow_AVX2;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize16][kColumn] =
+      Identity16TransformLoopColumn_AVX2;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(Transform1dSize32_Transform1dIdentity)
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize32][kRow] =
+      Identity32TransformLoopRow_AVX2;
+  dsp->inverse_transforms[kTransform1dIdentity][kTransform1dSize32][kColumn] =
+      Identity32TransformLoopColumn_AVX2;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+void InverseTransformInit_AVX2() { low_bitdepth::Init8bpp(); }
+
+}  // namespace dsp
+}  // namespace libgav1
+#else   // !LIBGAV1_TARGETING_AVX2
+namespace libgav1 {
+namespace dsp {
+
+void InverseTransformInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2023 The libgav1 Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIBGAV1_SRC_DSP_X86_INVERSE_TRANSFORM_AVX2_H_
+#define LIBGAV1_SRC_DSP_X86_INVERSE_TRANSFORM_AVX2_H_
+
+#include "src/dsp/dsp.h"
+#include "src/utils/cpu.h"
+
+namespace libgav1 {
+namespace dsp {
+
+// Initializes Dsp::inverse_transforms, see the defines below for specifics.
+// These functions are not thread-safe.
+void InverseTransformInit_AVX2();
+void InverseTransformInit10bpp_AVX2();
+
+}  // namespace dsp
+}  // namespace libgav1
+
+// If avx2 is enabled and the baseline isn't set due to a higher level of
+// optimization being enabled, signal the avx2 implementation should be used.
+#if LIBGAV1_TARGETING_AVX2
+
+#ifndef LIBGAV1_Dsp8bpp_Transform1dSize16_Transform1dDct
+#define LIBGAV1_Dsp8bpp_Transform1dSize16_Transform1dDct LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp8bpp_Transform1dSize32_Transform1dDct
+#define LIBGAV1_Dsp8bpp_Transform1dSize32_Transform1dDct LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp8bpp_Transform1dSize64_Transform1dDct
+#define LIBGAV1_Dsp8bpp_Transform1dSize64_Transform1dDct LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp8bpp_Transform1dSize16_Transform1dIdentity
+#define LIBGAV1_Dsp8bpp_Transform1dSize16_Transform1dIdentity LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp8bpp_Transform1dSize32_Transform1dIdentity
+#define LIBGAV1_Dsp8bpp_Transform1dSize32_Transform1dIdentity LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_Transform1dSize4_Transform1dDct
+#define LIBGAV1_Dsp10bpp_Transform1dSize4_Transform1dDct LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_Transform1dSize8_Transform1dDct
+#define LIBGAV1_Dsp10bpp_Transform1dSize8_Transform1dDct LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_Transform1dSize16_Transform1dDct
+#define LIBGAV1_Dsp10bpp_Transform1dSize16_Transform1dDct LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_Transform1dSize32_Transform1dDct
+#define LIBGAV1_Dsp10bpp_Transform1dSize32_Transform1dDct LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_Transform1dSize64_Transform1dDct
+#define LIBGAV1_Dsp10bpp_Transform1dSize64_Transform1dDct LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_Transform1dSize4_Transform1dAdst
+#define LIBGAV1_Dsp10bpp_Transform1dSize4_Transform1dAdst LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_Transform1dSize8_Transform1dAdst
+#define LIBGAV1_Dsp10bpp_Transform1dSize8_Transform1dAdst LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_Transform1dSize16_Transform1dAdst
+#define LIBGAV1_Dsp10bpp_Transform1dSize16_Transform1dAdst LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_Transform1dSize4_Transform1dIdentity
+#define LIBGAV1_Dsp10bpp_Transform1dSize4_Transform1dIdentity LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_Transform1dSize8_Transform1dIdentity
+#define LIBGAV1_Dsp10bpp_Transform1dSize8_Transform1dIdentity LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_Transform1dSize16_Transform1dIdentity
+#define LIBGAV1_Dsp10bpp_Transform1dSize16_Transform1dIdentity LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_Transform1dSize32_Transform1dIdentity
+#define LIBGAV1_Dsp10bpp_Transform1dSize32_Transform1dIdentity LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_Transform1dSize4_Transform1dDct
+#define LIBGAV1_Dsp12bpp_Transform1dSize4_Transform1dDct LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_Transform1dSize8_Transform1dDct
+#define LIBGAV1_Dsp12bpp_Transform1dSize8_Transform1dDct LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_Transform1dSize16_Transform1dDct
+#define LIBGAV1_Dsp12bpp_Transform1dSize16_Transform1dDct LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_Transform1dSize32_Transform1dDct
+#define LIBGAV1_Dsp12bpp_Transform1dSize32_Transform1dDct LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_Transform1dSize64_Transform1dDct
+#define LIBGAV1_Dsp12bpp_Transform1dSize64_Transform1dDct LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_Transform1dSize4_Transform1dAdst
+#define LIBGAV1_Dsp12bpp_Transform1dSize4_Transform1dAdst LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_Transform1dSize8_Transform1dAdst
+#define LIBGAV1_Dsp12bpp_Transform1dSize8_Transform1dAdst LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_Transform1dSize16_Transform1dAdst
+#define LIBGAV1_Dsp12bpp_Transform1dSize16_Transform1dAdst LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_Transform1dSize4_Transform1dIdentity
+#define LIBGAV1_Dsp12bpp_Transform1dSize4_Transform1dIdentity LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_Transform1dSize8_Transform1dIdentity
+#define LIBGAV1_Dsp12bpp_Transform1dSize8_Transform1dIdentity LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_Transform1dSize16_Transform1dIdentity
+#define LIBGAV1_Dsp12bpp_Transform1dSize16_Transform1dIdentity LIBGAV1_CPU_AVX2
+#endif
+
+#ifndef LIBGAV1_Dsp12bpp_Transform1dSize32_Transform1dIdentity
+#define LIBGAV1_Dsp12bpp_Transform1dSize32_Transform1dIdentity LIBGAV1_CPU_AVX2
+#endif
+
+#endif  // LIBGAV1_TARGETING_AVX2
+
+#endif  // LIBGAV1_SRC_DSP_X86_INVERSE_TRANSFORM_AVX2_H_
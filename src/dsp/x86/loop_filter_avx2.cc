@@ -0,0 +1,785 @@
+// Copyright 2023 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/loop_filter.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/constants.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+// The dual filters process 8 positions along the edge. Pixels are widened to
+// 16 bits and each vector holds one tap for both sides of the edge, with the
+// p side in the low 128-bit lane and the q side in the high lane, e.g., |qp1|
+// holds p1 for the 8 positions followed by q1. The 7.14.6.4 filters are
+// symmetric about the edge so both sides are computed at once.
+
+inline __m256i SwapHalves(const __m256i x) {
+  return _mm256_permute4x64_epi64(x, 0x4e);
+}
+
+// Returns the larger of the p and q side values in both halves.
+inline __m256i MaxPQ(const __m256i x) {
+  return _mm256_max_epi16(x, SwapHalves(x));
+}
+
+inline __m256i AbsDiff(const __m256i a, const __m256i b) {
+  return _mm256_abs_epi16(_mm256_sub_epi16(a, b));
+}
+
+inline __m256i Clamp(const __m256i x, const __m256i min, const __m256i max) {
+  return _mm256_min_epi16(_mm256_max_epi16(x, min), max);
+}
+
+inline __m256i LessEqual(const __m256i a, const __m256i b) {
+  return _mm256_cmpeq_epi16(_mm256_min_epi16(a, b), a);
+}
+
+template <int bitdepth>
+inline __m256i Threshold(const int thresh) {
+  return _mm256_set1_epi16(thresh << (bitdepth - 8));
+}
+
+//------------------------------------------------------------------------------
+// Load and store functions.
+
+inline __m256i LoadQp(const uint8_t* const p, const uint8_t* const q) {
+  return _mm256_cvtepu8_epi16(_mm_unpacklo_epi64(LoadLo8(p), LoadLo8(q)));
+}
+
+inline __m256i LoadQp(const uint16_t* const p, const uint16_t* const q) {
+  return SetrM128i(LoadUnaligned16(p), LoadUnaligned16(q));
+}
+
+inline void StoreQp(uint8_t* const p, uint8_t* const q, const __m256i qp) {
+  const __m128i x = _mm_packus_epi16(_mm256_castsi256_si128(qp),
+                                     _mm256_extracti128_si256(qp, 1));
+  StoreLo8(p, x);
+  StoreHi8(q, x);
+}
+
+inline void StoreQp(uint16_t* const p, uint16_t* const q, const __m256i qp) {
+  StoreUnaligned16(p, _mm256_castsi256_si128(qp));
+  StoreUnaligned16(q, _mm256_extracti128_si256(qp, 1));
+}
+
+// Stores pixels 2 to 5 of each half to the same positions in |p| and |q|.
+inline void StoreQpMiddle4(uint8_t* const p, uint8_t* const q,
+                           const __m256i qp) {
+  const __m128i x = _mm_packus_epi16(_mm256_castsi256_si128(qp),
+                                     _mm256_extracti128_si256(qp, 1));
+  Store4(p + 2, _mm_srli_si128(x, 2));
+  Store4(q + 2, _mm_srli_si128(x, 10));
+}
+
+inline void StoreQpMiddle4(uint16_t* const p, uint16_t* const q,
+                           const __m256i qp) {
+  StoreLo8(p + 2, _mm_srli_si128(_mm256_castsi256_si128(qp), 4));
+  StoreLo8(q + 2, _mm_srli_si128(_mm256_extracti128_si256(qp, 1), 4));
+}
+
+// Transposes an 8x8 block of 16-bit values. |in[i]| holds rows i and i + 4 in
+// its low and high lanes. |out[i]| receives columns 2 * i and 2 * i + 1.
+inline void Transpose8x8(const __m256i in[4], __m256i out[4]) {
+  // in[0]: 00 01 02 03 04 05 06 07  40 41 42 43 44 45 46 47
+  // in[1]: 10 11 12 13 14 15 16 17  50 51 52 53 54 55 56 57
+  // in[2]: 20 21 22 23 24 25 26 27  60 61 62 63 64 65 66 67
+  // in[3]: 30 31 32 33 34 35 36 37  70 71 72 73 74 75 76 77
+
+  // 00 10 01 11 02 12 03 13  40 50 41 51 42 52 43 53
+  const __m256i a0 = _mm256_unpacklo_epi16(in[0], in[1]);
+  // 04 14 05 15 06 16 07 17  44 54 45 55 46 56 47 57
+  const __m256i a1 = _mm256_unpackhi_epi16(in[0], in[1]);
+  // 20 30 21 31 22 32 23 33  60 70 61 71 62 72 63 73
+  const __m256i a2 = _mm256_unpacklo_epi16(in[2], in[3]);
+  // 24 34 25 35 26 36 27 37  64 74 65 75 66 76 67 77
+  const __m256i a3 = _mm256_unpackhi_epi16(in[2], in[3]);
+
+  // 00 10 20 30 01 11 21 31  40 50 60 70 41 51 61 71
+  const __m256i b0 = _mm256_unpacklo_epi32(a0, a2);
+  // 02 12 22 32 03 13 23 33  42 52 62 72 43 53 63 73
+  const __m256i b1 = _mm256_unpackhi_epi32(a0, a2);
+  // 04 14 24 34 05 15 25 35  44 54 64 74 45 55 65 75
+  const __m256i b2 = _mm256_unpacklo_epi32(a1, a3);
+  // 06 16 26 36 07 17 27 37  46 56 66 76 47 57 67 77
+  const __m256i b3 = _mm256_unpackhi_epi32(a1, a3);
+
+  // 00 10 20 30 40 50 60 70  01 11 21 31 41 51 61 71
+  out[0] = _mm256_permute4x64_epi64(b0, 0xd8);
+  // 02 12 22 32 42 52 62 72  03 13 23 33 43 53 63 73
+  out[1] = _mm256_permute4x64_epi64(b1, 0xd8);
+  // 04 14 24 34 44 54 64 74  05 15 25 35 45 55 65 75
+  out[2] = _mm256_permute4x64_epi64(b2, 0xd8);
+  // 06 16 26 36 46 56 66 76  07 17 27 37 47 57 67 77
+  out[3] = _mm256_permute4x64_epi64(b3, 0xd8);
+}
+
+// Loads 8 rows of p3..q3 starting at |src| and transposes them into
+// |qp3|..|qp0|.
+template <typename Pixel>
+inline void LoadVertical8(const Pixel* const src, const ptrdiff_t stride,
+                          __m256i* const qp3, __m256i* const qp2,
+                          __m256i* const qp1, __m256i* const qp0) {
+  __m256i rows[4];
+  __m256i columns[4];
+  for (int i = 0; i < 4; ++i) {
+    rows[i] = LoadQp(src + i * stride, src + (i + 4) * stride);
+  }
+  // columns: p3 p2, p1 p0, q0 q1, q2 q3.
+  Transpose8x8(rows, columns);
+  *qp3 = _mm256_blend_epi32(columns[0], columns[3], 0xf0);
+  *qp2 = _mm256_permute2x128_si256(columns[0], columns[3], 0x21);
+  *qp1 = _mm256_blend_epi32(columns[1], columns[2], 0xf0);
+  *qp0 = _mm256_permute2x128_si256(columns[1], columns[2], 0x21);
+}
+
+// Transposes |qp3|..|qp0| back into 8 rows. Returns the rows in pairs, see
+// Transpose8x8().
+inline void TransposeVertical8(const __m256i qp3, const __m256i qp2,
+                               const __m256i qp1, const __m256i qp0,
+                               __m256i rows[4]) {
+  __m256i columns[4];
+  // columns: p3 q0, p2 q1, p1 q2, p0 q3.
+  columns[0] = _mm256_blend_epi32(qp3, qp0, 0xf0);
+  columns[1] = _mm256_blend_epi32(qp2, qp1, 0xf0);
+  columns[2] = _mm256_blend_epi32(qp1, qp2, 0xf0);
+  columns[3] = _mm256_blend_epi32(qp0, qp3, 0xf0);
+  Transpose8x8(columns, rows);
+}
+
+//------------------------------------------------------------------------------
+// Filter masks. 7.14.6.2.
+
+// Returns the mask of the positions to filter. |inner| is the largest
+// difference between neighboring pixels on either side of the edge.
+inline __m256i NeedsFilter(const __m256i inner, const __m256i qp1,
+                           const __m256i qp0, const __m256i outer_thresh,
+                           const __m256i inner_thresh) {
+  const __m256i abs_p0q0 = AbsDiff(qp0, SwapHalves(qp0));
+  const __m256i abs_p1q1 = AbsDiff(qp1, SwapHalves(qp1));
+  const __m256i outer = _mm256_add_epi16(_mm256_add_epi16(abs_p0q0, abs_p0q0),
+                                         _mm256_srli_epi16(abs_p1q1, 1));
+  return _mm256_and_si256(LessEqual(inner, inner_thresh),
+                          LessEqual(outer, outer_thresh));
+}
+
+//------------------------------------------------------------------------------
+// Filters. 7.14.6.3 and 7.14.6.4.
+
+// Applies the 4-tap filter, or the 2-tap filter where |hev_mask| is set, to
+// the positions in |needs_mask|.
+template <int bitdepth>
+inline void Filter4(const __m256i qp1, const __m256i qp0,
+                    const __m256i needs_mask, const __m256i hev_mask,
+                    __m256i* const oqp1, __m256i* const oqp0) {
+  const __m256i min_signed = _mm256_set1_epi16(-(1 << (bitdepth - 1)));
+  const __m256i max_signed = _mm256_set1_epi16((1 << (bitdepth - 1)) - 1);
+  // Negates the q side so differences taken across the edge hold the same
+  // value in both halves.
+  const __m256i sign = _mm256_setr_epi16(1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1,
+                                         -1, -1, -1, -1, -1);
+  const __m256i q0_p0 =
+      _mm256_sign_epi16(_mm256_sub_epi16(SwapHalves(qp0), qp0), sign);
+  const __m256i p1_q1 =
+      _mm256_sign_epi16(_mm256_sub_epi16(qp1, SwapHalves(qp1)), sign);
+  // 8bpp: [-893,892], 10bpp: [-3581,3580], 12bpp [-14333,14332]
+  const __m256i a = _mm256_add_epi16(
+      _mm256_add_epi16(q0_p0, _mm256_add_epi16(q0_p0, q0_p0)),
+      _mm256_and_si256(hev_mask, Clamp(p1_q1, min_signed, max_signed)));
+  const __m256i a1 = _mm256_srai_epi16(
+      Clamp(_mm256_add_epi16(a, _mm256_set1_epi16(4)), min_signed, max_signed),
+      3);
+  const __m256i a2 = _mm256_srai_epi16(
+      Clamp(_mm256_add_epi16(a, _mm256_set1_epi16(3)), min_signed, max_signed),
+      3);
+  const __m256i a3 =
+      _mm256_srai_epi16(_mm256_add_epi16(a1, _mm256_set1_epi16(1)), 1);
+  // p0 + a2, q0 - a1.
+  const __m256i delta0 = _mm256_and_si256(
+      needs_mask, _mm256_sign_epi16(_mm256_blend_epi32(a2, a1, 0xf0), sign));
+  // p1 + a3, q1 - a3. Only the 4-tap filter modifies p1 and q1.
+  const __m256i delta1 = _mm256_and_si256(
+      _mm256_andnot_si256(hev_mask, needs_mask), _mm256_sign_epi16(a3, sign));
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i max_pixel = _mm256_set1_epi16((1 << bitdepth) - 1);
+  *oqp1 = Clamp(_mm256_add_epi16(qp1, delta1), zero, max_pixel);
+  *oqp0 = Clamp(_mm256_add_epi16(qp0, delta0), zero, max_pixel);
+}
+
+// 6 pixels in, 4 pixels out.
+inline void Filter6(const __m256i qp2, const __m256i qp1, const __m256i qp0,
+                    __m256i* const oqp1, __m256i* const oqp0) {
+  const __m256i qp1s = SwapHalves(qp1);
+  const __m256i qp0s = SwapHalves(qp0);
+  // The max is 8 * max_pixel + 4 for the rounder.
+  // 8bpp: 2044 (11 bits), 10bpp: 8188 (13 bits), 12bpp: 32764 (15 bits)
+  // p2 * 3 + p1 * 2 + p0 * 2 + q0
+  __m256i sum = _mm256_add_epi16(_mm256_add_epi16(qp2, qp2), qp2);
+  sum = _mm256_add_epi16(sum, _mm256_slli_epi16(_mm256_add_epi16(qp1, qp0), 1));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(qp0s, _mm256_set1_epi16(4)));
+  *oqp1 = _mm256_srli_epi16(sum, 3);
+
+  // p2 + p1 * 2 + p0 * 2 + q0 * 2 + q1
+  sum = _mm256_sub_epi16(sum, _mm256_slli_epi16(qp2, 1));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(qp0s, qp1s));
+  *oqp0 = _mm256_srli_epi16(sum, 3);
+}
+
+// 8 pixels in, 6 pixels out.
+inline void Filter8(const __m256i qp3, const __m256i qp2, const __m256i qp1,
+                    const __m256i qp0, __m256i* const oqp2,
+                    __m256i* const oqp1, __m256i* const oqp0) {
+  const __m256i qp2s = SwapHalves(qp2);
+  const __m256i qp1s = SwapHalves(qp1);
+  const __m256i qp0s = SwapHalves(qp0);
+  // The max is 8 * max_pixel + 4 for the rounder.
+  // 8bpp: 2044 (11 bits), 10bpp: 8188 (13 bits), 12bpp: 32764 (15 bits)
+  // p3 * 3 + p2 * 2 + p1 + p0 + q0
+  __m256i sum = _mm256_add_epi16(_mm256_add_epi16(qp3, qp3),
+                                 _mm256_add_epi16(qp3, qp2));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(qp2, qp1));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(qp0, qp0s));
+  sum = _mm256_add_epi16(sum, _mm256_set1_epi16(4));
+  *oqp2 = _mm256_srli_epi16(sum, 3);
+
+  // p3 * 2 + p2 + p1 * 2 + p0 + q0 + q1
+  sum = _mm256_sub_epi16(sum, _mm256_add_epi16(qp3, qp2));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(qp1, qp1s));
+  *oqp1 = _mm256_srli_epi16(sum, 3);
+
+  // p3 + p2 + p1 + p0 * 2 + q0 + q1 + q2
+  sum = _mm256_sub_epi16(sum, _mm256_add_epi16(qp3, qp1));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(qp0, qp2s));
+  *oqp0 = _mm256_srli_epi16(sum, 3);
+}
+
+// 14 pixels in, 12 pixels out.
+inline void Filter14(const __m256i qp6, const __m256i qp5, const __m256i qp4,
+                     const __m256i qp3, const __m256i qp2, const __m256i qp1,
+                     const __m256i qp0, __m256i* const oqp5,
+                     __m256i* const oqp4, __m256i* const oqp3,
+                     __m256i* const oqp2, __m256i* const oqp1,
+                     __m256i* const oqp0) {
+  const __m256i qp5s = SwapHalves(qp5);
+  const __m256i qp4s = SwapHalves(qp4);
+  const __m256i qp3s = SwapHalves(qp3);
+  const __m256i qp2s = SwapHalves(qp2);
+  const __m256i qp1s = SwapHalves(qp1);
+  const __m256i qp0s = SwapHalves(qp0);
+  // The max is 16 * max_pixel + 8 for the rounder.
+  // 8bpp: 4088 (12 bits), 10bpp: 16376 (14 bits), 12bpp: 65528 (16 bits)
+  // The 12bpp sums wrap as signed values so they are shifted as unsigned.
+  // p6 * 7 + p5 * 2 + p4 * 2 + p3 + p2 + p1 + p0 + q0
+  __m256i sum = _mm256_sub_epi16(_mm256_slli_epi16(qp6, 3), qp6);
+  sum = _mm256_add_epi16(sum, _mm256_slli_epi16(_mm256_add_epi16(qp5, qp4), 1));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(qp3, qp2));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(qp1, qp0));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(qp0s, _mm256_set1_epi16(8)));
+  *oqp5 = _mm256_srli_epi16(sum, 4);
+
+  // p6 * 5 + p5 * 2 + p4 * 2 + p3 * 2 + p2 + p1 + p0 + q0 + q1
+  sum = _mm256_sub_epi16(sum, _mm256_slli_epi16(qp6, 1));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(qp3, qp1s));
+  *oqp4 = _mm256_srli_epi16(sum, 4);
+
+  // p6 * 4 + p5 + p4 * 2 + p3 * 2 + p2 * 2 + p1 + p0 + q0 + q1 + q2
+  sum = _mm256_sub_epi16(sum, _mm256_add_epi16(qp6, qp5));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(qp2, qp2s));
+  *oqp3 = _mm256_srli_epi16(sum, 4);
+
+  // p6 * 3 + p5 + p4 + p3 * 2 + p2 * 2 + p1 * 2 + p0 + q0 + q1 + q2 + q3
+  sum = _mm256_sub_epi16(sum, _mm256_add_epi16(qp6, qp4));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(qp1, qp3s));
+  *oqp2 = _mm256_srli_epi16(sum, 4);
+
+  // p6 * 2 + p5 + p4 + p3 + p2 * 2 + p1 * 2 + p0 * 2 + q0 + q1 + q2 + q3 +
+  // q4
+  sum = _mm256_sub_epi16(sum, _mm256_add_epi16(qp6, qp3));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(qp0, qp4s));
+  *oqp1 = _mm256_srli_epi16(sum, 4);
+
+  // p6 + p5 + p4 + p3 + p2 + p1 * 2 + p0 * 2 + q0 * 2 + q1 + q2 + q3 + q4 +
+  // q5
+  sum = _mm256_sub_epi16(sum, _mm256_add_epi16(qp6, qp2));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(qp0s, qp5s));
+  *oqp0 = _mm256_srli_epi16(sum, 4);
+}
+
+//------------------------------------------------------------------------------
+// Edge filters. Each returns false when none of the positions need filtering
+// in which case the outputs are not written.
+
+template <int bitdepth>
+inline bool FilterEdge4(const __m256i qp1, const __m256i qp0,
+                        const int outer_thresh, const int inner_thresh,
+                        const int hev_thresh, __m256i* const oqp1,
+                        __m256i* const oqp0) {
+  const __m256i abs_qp1qp0 = MaxPQ(AbsDiff(qp1, qp0));
+  const __m256i needs_mask =
+      NeedsFilter(abs_qp1qp0, qp1, qp0, Threshold<bitdepth>(outer_thresh),
+                  Threshold<bitdepth>(inner_thresh));
+  if (_mm256_testz_si256(needs_mask, needs_mask) != 0) return false;
+
+  const __m256i hev_mask =
+      _mm256_cmpgt_epi16(abs_qp1qp0, Threshold<bitdepth>(hev_thresh));
+  Filter4<bitdepth>(qp1, qp0, needs_mask, hev_mask, oqp1, oqp0);
+  return true;
+}
+
+template <int bitdepth>
+inline bool FilterEdge6(const __m256i qp2, const __m256i qp1,
+                        const __m256i qp0, const int outer_thresh,
+                        const int inner_thresh, const int hev_thresh,
+                        __m256i* const oqp1, __m256i* const oqp0) {
+  const __m256i abs_qp1qp0 = AbsDiff(qp1, qp0);
+  const __m256i hev_max = MaxPQ(abs_qp1qp0);
+  const __m256i inner_max = _mm256_max_epi16(hev_max, MaxPQ(AbsDiff(qp2, qp1)));
+  const __m256i needs_mask =
+      NeedsFilter(inner_max, qp1, qp0, Threshold<bitdepth>(outer_thresh),
+                  Threshold<bitdepth>(inner_thresh));
+  if (_mm256_testz_si256(needs_mask, needs_mask) != 0) return false;
+
+  const __m256i hev_mask =
+      _mm256_cmpgt_epi16(hev_max, Threshold<bitdepth>(hev_thresh));
+  Filter4<bitdepth>(qp1, qp0, needs_mask, hev_mask, oqp1, oqp0);
+
+  const __m256i flat_max =
+      MaxPQ(_mm256_max_epi16(abs_qp1qp0, AbsDiff(qp2, qp0)));
+  const __m256i flat_mask = _mm256_and_si256(
+      needs_mask, LessEqual(flat_max, Threshold<bitdepth>(1)));
+  if (_mm256_testz_si256(flat_mask, flat_mask) == 0) {
+    __m256i oqp1_f6;
+    __m256i oqp0_f6;
+    Filter6(qp2, qp1, qp0, &oqp1_f6, &oqp0_f6);
+    *oqp1 = _mm256_blendv_epi8(*oqp1, oqp1_f6, flat_mask);
+    *oqp0 = _mm256_blendv_epi8(*oqp0, oqp0_f6, flat_mask);
+  }
+  return true;
+}
+
+// Computes the filter, flat and high edge variance masks shared by the 8 and
+// 14 tap filters.
+template <int bitdepth>
+inline void FilterMasks8(const __m256i qp3, const __m256i qp2,
+                         const __m256i qp1, const __m256i qp0,
+                         const int outer_thresh, const int inner_thresh,
+                         const int hev_thresh, __m256i* const needs_mask,
+                         __m256i* const flat_mask, __m256i* const hev_mask) {
+  const __m256i abs_qp1qp0 = AbsDiff(qp1, qp0);
+  const __m256i hev_max = MaxPQ(abs_qp1qp0);
+  const __m256i inner_max = _mm256_max_epi16(
+      hev_max, MaxPQ(_mm256_max_epi16(AbsDiff(qp2, qp1), AbsDiff(qp3, qp2))));
+  *needs_mask =
+      NeedsFilter(inner_max, qp1, qp0, Threshold<bitdepth>(outer_thresh),
+                  Threshold<bitdepth>(inner_thresh));
+  *hev_mask = _mm256_cmpgt_epi16(hev_max, Threshold<bitdepth>(hev_thresh));
+  const __m256i flat_max = MaxPQ(_mm256_max_epi16(
+      abs_qp1qp0,
+      _mm256_max_epi16(AbsDiff(qp2, qp0), AbsDiff(qp3, qp0))));
+  *flat_mask = _mm256_and_si256(*needs_mask,
+                                LessEqual(flat_max, Threshold<bitdepth>(1)));
+}
+
+template <int bitdepth>
+inline bool FilterEdge8(const __m256i qp3, const __m256i qp2,
+                        const __m256i qp1, const __m256i qp0,
+                        const int outer_thresh, const int inner_thresh,
+                        const int hev_thresh, __m256i* const oqp2,
+                        __m256i* const oqp1, __m256i* const oqp0) {
+  __m256i needs_mask;
+  __m256i flat_mask;
+  __m256i hev_mask;
+  FilterMasks8<bitdepth>(qp3, qp2, qp1, qp0, outer_thresh, inner_thresh,
+                         hev_thresh, &needs_mask, &flat_mask, &hev_mask);
+  if (_mm256_testz_si256(needs_mask, needs_mask) != 0) return false;
+
+  Filter4<bitdepth>(qp1, qp0, needs_mask, hev_mask, oqp1, oqp0);
+  *oqp2 = qp2;
+  if (_mm256_testz_si256(flat_mask, flat_mask) == 0) {
+    __m256i oqp2_f8;
+    __m256i oqp1_f8;
+    __m256i oqp0_f8;
+    Filter8(qp3, qp2, qp1, qp0, &oqp2_f8, &oqp1_f8, &oqp0_f8);
+    *oqp2 = _mm256_blendv_epi8(qp2, oqp2_f8, flat_mask);
+    *oqp1 = _mm256_blendv_epi8(*oqp1, oqp1_f8, flat_mask);
+    *oqp0 = _mm256_blendv_epi8(*oqp0, oqp0_f8, flat_mask);
+  }
+  return true;
+}
+
+template <int bitdepth>
+inline bool FilterEdge14(const __m256i qp6, const __m256i qp5,
+                         const __m256i qp4, const __m256i qp3,
+                         const __m256i qp2, const __m256i qp1,
+                         const __m256i qp0, const int outer_thresh,
+                         const int inner_thresh, const int hev_thresh,
+                         __m256i oqp[6]) {
+  __m256i needs_mask;
+  __m256i flat_mask;
+  __m256i hev_mask;
+  FilterMasks8<bitdepth>(qp3, qp2, qp1, qp0, outer_thresh, inner_thresh,
+                         hev_thresh, &needs_mask, &flat_mask, &hev_mask);
+  if (_mm256_testz_si256(needs_mask, needs_mask) != 0) return false;
+
+  // |oqp| is indexed by tap, i.e., oqp[5] holds the filtered qp5.
+  Filter4<bitdepth>(qp1, qp0, needs_mask, hev_mask, &oqp[1], &oqp[0]);
+  oqp[2] = qp2;
+  oqp[3] = qp3;
+  oqp[4] = qp4;
+  oqp[5] = qp5;
+  if (_mm256_testz_si256(flat_mask, flat_mask) == 0) {
+    __m256i oqp2_f8;
+    __m256i oqp1_f8;
+    __m256i oqp0_f8;
+    Filter8(qp3, qp2, qp1, qp0, &oqp2_f8, &oqp1_f8, &oqp0_f8);
+    oqp[2] = _mm256_blendv_epi8(qp2, oqp2_f8, flat_mask);
+    oqp[1] = _mm256_blendv_epi8(oqp[1], oqp1_f8, flat_mask);
+    oqp[0] = _mm256_blendv_epi8(oqp[0], oqp0_f8, flat_mask);
+
+    const __m256i flat2_max = MaxPQ(_mm256_max_epi16(
+        AbsDiff(qp4, qp0),
+        _mm256_max_epi16(AbsDiff(qp5, qp0), AbsDiff(qp6, qp0))));
+    const __m256i flat2_mask = _mm256_and_si256(
+        flat_mask, LessEqual(flat2_max, Threshold<bitdepth>(1)));
+    if (_mm256_testz_si256(flat2_mask, flat2_mask) == 0) {
+      __m256i oqp_f14[6];
+      Filter14(qp6, qp5, qp4, qp3, qp2, qp1, qp0, &oqp_f14[5], &oqp_f14[4],
+               &oqp_f14[3], &oqp_f14[2], &oqp_f14[1], &oqp_f14[0]);
+      for (int i = 0; i < 6; ++i) {
+        oqp[i] = _mm256_blendv_epi8(oqp[i], oqp_f14[i], flat2_mask);
+      }
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+template <int bitdepth, typename Pixel>
+struct DualLoopFilterFuncs_AVX2 {
+  DualLoopFilterFuncs_AVX2() = delete;
+
+  static void Vertical4(void* dest, ptrdiff_t stride, int outer_thresh,
+                        int inner_thresh, int hev_thresh);
+  static void Horizontal4(void* dest, ptrdiff_t stride, int outer_thresh,
+                          int inner_thresh, int hev_thresh);
+  static void Vertical6(void* dest, ptrdiff_t stride, int outer_thresh,
+                        int inner_thresh, int hev_thresh);
+  static void Horizontal6(void* dest, ptrdiff_t stride, int outer_thresh,
+                          int inner_thresh, int hev_thresh);
+  static void Vertical8(void* dest, ptrdiff_t stride, int outer_thresh,
+                        int inner_thresh, int hev_thresh);
+  static void Horizontal8(void* dest, ptrdiff_t stride, int outer_thresh,
+                          int inner_thresh, int hev_thresh);
+  static void Vertical14(void* dest, ptrdiff_t stride, int outer_thresh,
+                         int inner_thresh, int hev_thresh);
+  static void Horizontal14(void* dest, ptrdiff_t stride, int outer_thresh,
+                           int inner_thresh, int hev_thresh);
+};
+
+template <int bitdepth, typename Pixel>
+void DualLoopFilterFuncs_AVX2<bitdepth, Pixel>::Horizontal4(
+    void* dest, ptrdiff_t stride, int outer_thresh, int inner_thresh,
+    int hev_thresh) {
+  auto* const dst = static_cast<Pixel*>(dest);
+  stride /= sizeof(Pixel);
+  const __m256i qp1 = LoadQp(dst - 2 * stride, dst + 1 * stride);
+  const __m256i qp0 = LoadQp(dst - 1 * stride, dst + 0 * stride);
+  __m256i oqp1;
+  __m256i oqp0;
+  if (!FilterEdge4<bitdepth>(qp1, qp0, outer_thresh, inner_thresh, hev_thresh,
+                             &oqp1, &oqp0)) {
+    return;
+  }
+  StoreQp(dst - 2 * stride, dst + 1 * stride, oqp1);
+  StoreQp(dst - 1 * stride, dst + 0 * stride, oqp0);
+}
+
+template <int bitdepth, typename Pixel>
+void DualLoopFilterFuncs_AVX2<bitdepth, Pixel>::Vertical4(void* dest,
+                                                          ptrdiff_t stride,
+                                                          int outer_thresh,
+                                                          int inner_thresh,
+                                                          int hev_thresh) {
+  auto* const dst = static_cast<Pixel*>(dest) - 4;
+  stride /= sizeof(Pixel);
+  __m256i qp3, qp2, qp1, qp0;
+  LoadVertical8(dst, stride, &qp3, &qp2, &qp1, &qp0);
+  __m256i oqp1;
+  __m256i oqp0;
+  if (!FilterEdge4<bitdepth>(qp1, qp0, outer_thresh, inner_thresh, hev_thresh,
+                             &oqp1, &oqp0)) {
+    return;
+  }
+  __m256i rows[4];
+  TransposeVertical8(qp3, qp2, oqp1, oqp0, rows);
+  // Only p1..q1 are modified.
+  for (int i = 0; i < 4; ++i) {
+    StoreQpMiddle4(dst + (2 * i) * stride, dst + (2 * i + 1) * stride,
+                   rows[i]);
+  }
+}
+
+template <int bitdepth, typename Pixel>
+void DualLoopFilterFuncs_AVX2<bitdepth, Pixel>::Horizontal6(
+    void* dest, ptrdiff_t stride, int outer_thresh, int inner_thresh,
+    int hev_thresh) {
+  auto* const dst = static_cast<Pixel*>(dest);
+  stride /= sizeof(Pixel);
+  const __m256i qp2 = LoadQp(dst - 3 * stride, dst + 2 * stride);
+  const __m256i qp1 = LoadQp(dst - 2 * stride, dst + 1 * stride);
+  const __m256i qp0 = LoadQp(dst - 1 * stride, dst + 0 * stride);
+  __m256i oqp1;
+  __m256i oqp0;
+  if (!FilterEdge6<bitdepth>(qp2, qp1, qp0, outer_thresh, inner_thresh,
+                             hev_thresh, &oqp1, &oqp0)) {
+    return;
+  }
+  StoreQp(dst - 2 * stride, dst + 1 * stride, oqp1);
+  StoreQp(dst - 1 * stride, dst + 0 * stride, oqp0);
+}
+
+template <int bitdepth, typename Pixel>
+void DualLoopFilterFuncs_AVX2<bitdepth, Pixel>::Vertical6(void* dest,
+                                                          ptrdiff_t stride,
+                                                          int outer_thresh,
+                                                          int inner_thresh,
+                                                          int hev_thresh) {
+  auto* const dst = static_cast<Pixel*>(dest) - 4;
+  stride /= sizeof(Pixel);
+  __m256i qp3, qp2, qp1, qp0;
+  LoadVertical8(dst, stride, &qp3, &qp2, &qp1, &qp0);
+  __m256i oqp1;
+  __m256i oqp0;
+  if (!FilterEdge6<bitdepth>(qp2, qp1, qp0, outer_thresh, inner_thresh,
+                             hev_thresh, &oqp1, &oqp0)) {
+    return;
+  }
+  __m256i rows[4];
+  TransposeVertical8(qp3, qp2, oqp1, oqp0, rows);
+  // Only p1..q1 are modified.
+  for (int i = 0; i < 4; ++i) {
+    StoreQpMiddle4(dst + (2 * i) * stride, dst + (2 * i + 1) * stride,
+                   rows[i]);
+  }
+}
+
+template <int bitdepth, typename Pixel>
+void DualLoopFilterFuncs_AVX2<bitdepth, Pixel>::Horizontal8(
+    void* dest, ptrdiff_t stride, int outer_thresh, int inner_thresh,
+    int hev_thresh) {
+  auto* const dst = static_cast<Pixel*>(dest);
+  stride /= sizeof(Pixel);
+  const __m256i qp3 = LoadQp(dst - 4 * stride, dst + 3 * stride);
+  const __m256i qp2 = LoadQp(dst - 3 * stride, dst + 2 * stride);
+  const __m256i qp1 = LoadQp(dst - 2 * stride, dst + 1 * stride);
+  const __m256i qp0 = LoadQp(dst - 1 * stride, dst + 0 * stride);
+  __m256i oqp2;
+  __m256i oqp1;
+  __m256i oqp0;
+  if (!FilterEdge8<bitdepth>(qp3, qp2, qp1, qp0, outer_thresh, inner_thresh,
+                             hev_thresh, &oqp2, &oqp1, &oqp0)) {
+    return;
+  }
+  StoreQp(dst - 3 * stride, dst + 2 * stride, oqp2);
+  StoreQp(dst - 2 * stride, dst + 1 * stride, oqp1);
+  StoreQp(dst - 1 * stride, dst + 0 * stride, oqp0);
+}
+
+template <int bitdepth, typename Pixel>
+void DualLoopFilterFuncs_AVX2<bitdepth, Pixel>::Vertical8(void* dest,
+                                                          ptrdiff_t stride,
+                                                          int outer_thresh,
+                                                          int inner_thresh,
+                                                          int hev_thresh) {
+  auto* const dst = static_cast<Pixel*>(dest) - 4;
+  stride /= sizeof(Pixel);
+  __m256i qp3, qp2, qp1, qp0;
+  LoadVertical8(dst, stride, &qp3, &qp2, &qp1, &qp0);
+  __m256i oqp2;
+  __m256i oqp1;
+  __m256i oqp0;
+  if (!FilterEdge8<bitdepth>(qp3, qp2, qp1, qp0, outer_thresh, inner_thresh,
+                             hev_thresh, &oqp2, &oqp1, &oqp0)) {
+    return;
+  }
+  __m256i rows[4];
+  TransposeVertical8(qp3, oqp2, oqp1, oqp0, rows);
+  for (int i = 0; i < 4; ++i) {
+    StoreQp(dst + (2 * i) * stride, dst + (2 * i + 1) * stride, rows[i]);
+  }
+}
+
+template <int bitdepth, typename Pixel>
+void DualLoopFilterFuncs_AVX2<bitdepth, Pixel>::Horizontal14(
+    void* dest, ptrdiff_t stride, int outer_thresh, int inner_thresh,
+    int hev_thresh) {
+  auto* const dst = static_cast<Pixel*>(dest);
+  stride /= sizeof(Pixel);
+  __m256i qp[7];
+  for (int i = 0; i < 7; ++i) {
+    qp[i] = LoadQp(dst - (i + 1) * stride, dst + i * stride);
+  }
+  __m256i oqp[6];
+  if (!FilterEdge14<bitdepth>(qp[6], qp[5], qp[4], qp[3], qp[2], qp[1], qp[0],
+                              outer_thresh, inner_thresh, hev_thresh, oqp)) {
+    return;
+  }
+  for (int i = 0; i < 6; ++i) {
+    StoreQp(dst - (i + 1) * stride, dst + i * stride, oqp[i]);
+  }
+}
+
+template <int bitdepth, typename Pixel>
+void DualLoopFilterFuncs_AVX2<bitdepth, Pixel>::Vertical14(void* dest,
+                                                           ptrdiff_t stride,
+                                                           int outer_thresh,
+                                                           int inner_thresh,
+                                                           int hev_thresh) {
+  auto* const dst = static_cast<Pixel*>(dest);
+  stride /= sizeof(Pixel);
+  __m256i rows[4];
+  __m256i left[4];
+  __m256i right[4];
+  for (int i = 0; i < 4; ++i) {
+    rows[i] = LoadQp(dst - 8 + i * stride, dst - 8 + (i + 4) * stride);
+  }
+  // left: p7 p6, p5 p4, p3 p2, p1 p0.
+  Transpose8x8(rows, left);
+  for (int i = 0; i < 4; ++i) {
+    rows[i] = LoadQp(dst + i * stride, dst + (i + 4) * stride);
+  }
+  // right: q0 q1, q2 q3, q4 q5, q6 q7.
+  Transpose8x8(rows, right);
+
+  __m256i qp[8];
+  for (int i = 0; i < 4; ++i) {
+    qp[2 * i] = _mm256_permute2x128_si256(left[3 - i], right[i], 0x21);
+    qp[2 * i + 1] = _mm256_blend_epi32(left[3 - i], right[i], 0xf0);
+  }
+  __m256i oqp[6];
+  if (!FilterEdge14<bitdepth>(qp[6], qp[5], qp[4], qp[3], qp[2], qp[1], qp[0],
+                              outer_thresh, inner_thresh, hev_thresh, oqp)) {
+    return;
+  }
+  for (int i = 0; i < 6; ++i) qp[i] = oqp[i];
+
+  // p7 p3, p6 p2, p5 p1, p4 p0.
+  for (int i = 0; i < 4; ++i) {
+    left[i] = _mm256_permute2x128_si256(qp[7 - i], qp[3 - i], 0x20);
+  }
+  Transpose8x8(left, rows);
+  for (int i = 0; i < 4; ++i) {
+    StoreQp(dst - 8 + (2 * i) * stride, dst - 8 + (2 * i + 1) * stride,
+            rows[i]);
+  }
+  // q0 q4, q1 q5, q2 q6, q3 q7.
+  for (int i = 0; i < 4; ++i) {
+    right[i] = _mm256_permute2x128_si256(qp[i], qp[i + 4], 0x31);
+  }
+  Transpose8x8(right, rows);
+  for (int i = 0; i < 4; ++i) {
+    StoreQp(dst + (2 * i) * stride, dst + (2 * i + 1) * stride, rows[i]);
+  }
+}
+
+template <int bitdepth, typename Pixel>
+void InitDualLoopFilters(Dsp* const dsp) {
+  using Defs = DualLoopFilterFuncs_AVX2<bitdepth, Pixel>;
+  dsp->dual_loop_filters[kLoopFilterSize4][kLoopFilterTypeHorizontal] =
+      Defs::Horizontal4;
+  dsp->dual_loop_filters[kLoopFilterSize4][kLoopFilterTypeVertical] =
+      Defs::Vertical4;
+  dsp->dual_loop_filters[kLoopFilterSize6][kLoopFilterTypeHorizontal] =
+      Defs::Horizontal6;
+  dsp->dual_loop_filters[kLoopFilterSize6][kLoopFilterTypeVertical] =
+      Defs::Vertical6;
+  dsp->dual_loop_filters[kLoopFilterSize8][kLoopFilterTypeHorizontal] =
+      Defs::Horizontal8;
+  dsp->dual_loop_filters[kLoopFilterSize8][kLoopFilterTypeVertical] =
+      Defs::Vertical8;
+  dsp->dual_loop_filters[kLoopFilterSize14][kLoopFilterTypeHorizontal] =
+      Defs::Horizontal14;
+  dsp->dual_loop_filters[kLoopFilterSize14][kLoopFilterTypeVertical] =
+      Defs::Vertical14;
+}
+
+}  // namespace
+
+namespace low_bitdepth {
+namespace {
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+  InitDualLoopFilters<kBitdepth8, uint8_t>(dsp);
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+  InitDualLoopFilters<kBitdepth10, uint16_t>(dsp);
+}
+
+#if LIBGAV1_MAX_BITDEPTH == 12
+void Init12bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth12);
+  assert(dsp != nullptr);
+  InitDualLoopFilters<kBitdepth12, uint16_t>(dsp);
+}
+#endif  // LIBGAV1_MAX_BITDEPTH == 12
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void LoopFilterInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+#if LIBGAV1_MAX_BITDEPTH == 12
+  high_bitdepth::Init12bpp();
+#endif
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+#else   // !LIBGAV1_TARGETING_AVX2
+namespace libgav1 {
+namespace dsp {
+
+void LoopFilterInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
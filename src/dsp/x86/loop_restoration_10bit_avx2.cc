@@ -35,26 +35,29 @@ namespace libgav1 {
 namespace dsp {
 namespace {
 
+template <int bitdepth>
 inline void WienerHorizontalClip(const __m256i s[2],
                                  int16_t* const wiener_buffer) {
+  constexpr int kRoundBitsHorizontal = (bitdepth == 12)
+                                           ? kInterRoundBitsHorizontal12bpp
+                                           : kInterRoundBitsHorizontal;
   constexpr int offset =
-      1 << (10 + kWienerFilterBits - kInterRoundBitsHorizontal - 1);
+      1 << (bitdepth + kWienerFilterBits - kRoundBitsHorizontal - 1);
   constexpr int limit = (offset << 2) - 1;
   const __m256i offsets = _mm256_set1_epi16(-offset);
   const __m256i limits = _mm256_set1_epi16(limit - offset);
-  const __m256i round = _mm256_set1_epi32(1 << (kInterRoundBitsHorizontal - 1));
+  const __m256i round = _mm256_set1_epi32(1 << (kRoundBitsHorizontal - 1));
   const __m256i sum0 = _mm256_add_epi32(s[0], round);
   const __m256i sum1 = _mm256_add_epi32(s[1], round);
-  const __m256i rounded_sum0 =
-      _mm256_srai_epi32(sum0, kInterRoundBitsHorizontal);
-  const __m256i rounded_sum1 =
-      _mm256_srai_epi32(sum1, kInterRoundBitsHorizontal);
+  const __m256i rounded_sum0 = _mm256_srai_epi32(sum0, kRoundBitsHorizontal);
+  const __m256i rounded_sum1 = _mm256_srai_epi32(sum1, kRoundBitsHorizontal);
   const __m256i rounded_sum = _mm256_packs_epi32(rounded_sum0, rounded_sum1);
   const __m256i d0 = _mm256_max_epi16(rounded_sum, offsets);
   const __m256i d1 = _mm256_min_epi16(d0, limits);
   StoreAligned32(wiener_buffer, d1);
 }
 
+template <int bitdepth>
 inline void WienerHorizontalTap7Kernel(const __m256i s[7],
                                        const __m256i filter[2],
                                        int16_t* const wiener_buffer) {
@@ -72,9 +75,10 @@ inline void WienerHorizontalTap7Kernel(const __m256i s[7],
   madds[3] = _mm256_madd_epi16(ss3, filter[1]);
   madds[0] = _mm256_add_epi32(madds[0], madds[2]);
   madds[1] = _mm256_add_epi32(madds[1], madds[3]);
-  WienerHorizontalClip(madds, wiener_buffer);
+  WienerHorizontalClip<bitdepth>(madds, wiener_buffer);
 }
 
+template <int bitdepth>
 inline void WienerHorizontalTap5Kernel(const __m256i s[5], const __m256i filter,
                                        int16_t* const wiener_buffer) {
   const __m256i s04 = _mm256_add_epi16(s[0], s[4]);
@@ -93,9 +97,10 @@ inline void WienerHorizontalTap5Kernel(const __m256i s[5], const __m256i filter,
   const __m256i s2x128_hi = _mm256_slli_epi32(s2_hi, 7);
   madds[0] = _mm256_add_epi32(madds[0], s2x128_lo);
   madds[1] = _mm256_add_epi32(madds[1], s2x128_hi);
-  WienerHorizontalClip(madds, wiener_buffer);
+  WienerHorizontalClip<bitdepth>(madds, wiener_buffer);
 }
 
+template <int bitdepth>
 inline void WienerHorizontalTap3Kernel(const __m256i s[3], const __m256i filter,
                                        int16_t* const wiener_buffer) {
   const __m256i s02 = _mm256_add_epi16(s[0], s[2]);
@@ -104,9 +109,10 @@ inline void WienerHorizontalTap3Kernel(const __m256i s[3], const __m256i filter,
   __m256i madds[2];
   madds[0] = _mm256_madd_epi16(ss0, filter);
   madds[1] = _mm256_madd_epi16(ss1, filter);
-  WienerHorizontalClip(madds, wiener_buffer);
+  WienerHorizontalClip<bitdepth>(madds, wiener_buffer);
 }
 
+template <int bitdepth>
 inline void WienerHorizontalTap7(const uint16_t* src,
                                  const ptrdiff_t src_stride,
                                  const ptrdiff_t width, const int height,
@@ -126,7 +132,7 @@ inline void WienerHorizontalTap7(const uint16_t* src,
       s[4] = LoadUnaligned32(src + x + 4);
       s[5] = LoadUnaligned32(src + x + 5);
       s[6] = LoadUnaligned32(src + x + 6);
-      WienerHorizontalTap7Kernel(s, filter, *wiener_buffer + x);
+      WienerHorizontalTap7Kernel<bitdepth>(s, filter, *wiener_buffer + x);
       x += 16;
     } while (x < width);
     src += src_stride;
@@ -134,6 +140,7 @@ inline void WienerHorizontalTap7(const uint16_t* src,
   }
 }
 
+template <int bitdepth>
 inline void WienerHorizontalTap5(const uint16_t* src,
                                  const ptrdiff_t src_stride,
                                  const ptrdiff_t width, const int height,
@@ -150,7 +157,7 @@ inline void WienerHorizontalTap5(const uint16_t* src,
       s[2] = LoadUnaligned32(src + x + 2);
       s[3] = LoadUnaligned32(src + x + 3);
       s[4] = LoadUnaligned32(src + x + 4);
-      WienerHorizontalTap5Kernel(s, filter, *wiener_buffer + x);
+      WienerHorizontalTap5Kernel<bitdepth>(s, filter, *wiener_buffer + x);
       x += 16;
     } while (x < width);
     src += src_stride;
@@ -158,6 +165,7 @@ inline void WienerHorizontalTap5(const uint16_t* src,
   }
 }
 
+template <int bitdepth>
 inline void WienerHorizontalTap3(const uint16_t* src,
                                  const ptrdiff_t src_stride,
                                  const ptrdiff_t width, const int height,
@@ -171,7 +179,7 @@ inline void WienerHorizontalTap3(const uint16_t* src,
       s[0] = LoadUnaligned32(src + x + 0);
       s[1] = LoadUnaligned32(src + x + 1);
       s[2] = LoadUnaligned32(src + x + 2);
-      WienerHorizontalTap3Kernel(s, filter, *wiener_buffer + x);
+      WienerHorizontalTap3Kernel<bitdepth>(s, filter, *wiener_buffer + x);
       x += 16;
     } while (x < width);
     src += src_stride;
@@ -179,15 +187,20 @@ inline void WienerHorizontalTap3(const uint16_t* src,
   }
 }
 
+template <int bitdepth>
 inline void WienerHorizontalTap1(const uint16_t* src,
                                  const ptrdiff_t src_stride,
                                  const ptrdiff_t width, const int height,
                                  int16_t** const wiener_buffer) {
+  constexpr int kRoundBitsHorizontal = (bitdepth == 12)
+                                           ? kInterRoundBitsHorizontal12bpp
+                                           : kInterRoundBitsHorizontal;
+  constexpr int kShift = kWienerFilterBits - kRoundBitsHorizontal;
   for (int y = height; y != 0; --y) {
     ptrdiff_t x = 0;
     do {
       const __m256i s0 = LoadUnaligned32(src + x);
-      const __m256i d0 = _mm256_slli_epi16(s0, 4);
+      const __m256i d0 = _mm256_slli_epi16(s0, kShift);
       StoreAligned32(*wiener_buffer + x, d0);
       x += 16;
     } while (x < width);
@@ -196,7 +209,10 @@ inline void WienerHorizontalTap1(const uint16_t* src,
   }
 }
 
+template <int bitdepth>
 inline __m256i WienerVertical7(const __m256i a[4], const __m256i filter[4]) {
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
   const __m256i madd0 = _mm256_madd_epi16(a[0], filter[0]);
   const __m256i madd1 = _mm256_madd_epi16(a[1], filter[1]);
   const __m256i madd2 = _mm256_madd_epi16(a[2], filter[2]);
@@ -204,75 +220,92 @@ inline __m256i WienerVertical7(const __m256i a[4], const __m256i filter[4]) {
   const __m256i madd01 = _mm256_add_epi32(madd0, madd1);
   const __m256i madd23 = _mm256_add_epi32(madd2, madd3);
   const __m256i sum = _mm256_add_epi32(madd01, madd23);
-  return _mm256_srai_epi32(sum, kInterRoundBitsVertical);
+  return _mm256_srai_epi32(sum, kRoundBitsVertical);
 }
 
+template <int bitdepth>
 inline __m256i WienerVertical5(const __m256i a[3], const __m256i filter[3]) {
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
   const __m256i madd0 = _mm256_madd_epi16(a[0], filter[0]);
   const __m256i madd1 = _mm256_madd_epi16(a[1], filter[1]);
   const __m256i madd2 = _mm256_madd_epi16(a[2], filter[2]);
   const __m256i madd01 = _mm256_add_epi32(madd0, madd1);
   const __m256i sum = _mm256_add_epi32(madd01, madd2);
-  return _mm256_srai_epi32(sum, kInterRoundBitsVertical);
+  return _mm256_srai_epi32(sum, kRoundBitsVertical);
 }
 
+template <int bitdepth>
 inline __m256i WienerVertical3(const __m256i a[2], const __m256i filter[2]) {
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
   const __m256i madd0 = _mm256_madd_epi16(a[0], filter[0]);
   const __m256i madd1 = _mm256_madd_epi16(a[1], filter[1]);
   const __m256i sum = _mm256_add_epi32(madd0, madd1);
-  return _mm256_srai_epi32(sum, kInterRoundBitsVertical);
+  return _mm256_srai_epi32(sum, kRoundBitsVertical);
 }
 
+template <int bitdepth>
 inline __m256i WienerVerticalClip(const __m256i s[2]) {
   const __m256i d = _mm256_packus_epi32(s[0], s[1]);
-  return _mm256_min_epu16(d, _mm256_set1_epi16(1023));
+  return _mm256_min_epu16(d, _mm256_set1_epi16((1 << bitdepth) - 1));
 }
 
+template <int bitdepth>
 inline __m256i WienerVerticalFilter7(const __m256i a[7],
                                      const __m256i filter[2]) {
-  const __m256i round = _mm256_set1_epi16(1 << (kInterRoundBitsVertical - 1));
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
+  const __m256i round = _mm256_set1_epi16(1 << (kRoundBitsVertical - 1));
   __m256i b[4], c[2];
   b[0] = _mm256_unpacklo_epi16(a[0], a[1]);
   b[1] = _mm256_unpacklo_epi16(a[2], a[3]);
   b[2] = _mm256_unpacklo_epi16(a[4], a[5]);
   b[3] = _mm256_unpacklo_epi16(a[6], round);
-  c[0] = WienerVertical7(b, filter);
+  c[0] = WienerVertical7<bitdepth>(b, filter);
   b[0] = _mm256_unpackhi_epi16(a[0], a[1]);
   b[1] = _mm256_unpackhi_epi16(a[2], a[3]);
   b[2] = _mm256_unpackhi_epi16(a[4], a[5]);
   b[3] = _mm256_unpackhi_epi16(a[6], round);
-  c[1] = WienerVertical7(b, filter);
-  return WienerVerticalClip(c);
+  c[1] = WienerVertical7<bitdepth>(b, filter);
+  return WienerVerticalClip<bitdepth>(c);
 }
 
+template <int bitdepth>
 inline __m256i WienerVerticalFilter5(const __m256i a[5],
                                      const __m256i filter[3]) {
-  const __m256i round = _mm256_set1_epi16(1 << (kInterRoundBitsVertical - 1));
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
+  const __m256i round = _mm256_set1_epi16(1 << (kRoundBitsVertical - 1));
   __m256i b[3], c[2];
   b[0] = _mm256_unpacklo_epi16(a[0], a[1]);
   b[1] = _mm256_unpacklo_epi16(a[2], a[3]);
   b[2] = _mm256_unpacklo_epi16(a[4], round);
-  c[0] = WienerVertical5(b, filter);
+  c[0] = WienerVertical5<bitdepth>(b, filter);
   b[0] = _mm256_unpackhi_epi16(a[0], a[1]);
   b[1] = _mm256_unpackhi_epi16(a[2], a[3]);
   b[2] = _mm256_unpackhi_epi16(a[4], round);
-  c[1] = WienerVertical5(b, filter);
-  return WienerVerticalClip(c);
+  c[1] = WienerVertical5<bitdepth>(b, filter);
+  return WienerVerticalClip<bitdepth>(c);
 }
 
+template <int bitdepth>
 inline __m256i WienerVerticalFilter3(const __m256i a[3],
                                      const __m256i filter[2]) {
-  const __m256i round = _mm256_set1_epi16(1 << (kInterRoundBitsVertical - 1));
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
+  const __m256i round = _mm256_set1_epi16(1 << (kRoundBitsVertical - 1));
   __m256i b[2], c[2];
   b[0] = _mm256_unpacklo_epi16(a[0], a[1]);
   b[1] = _mm256_unpacklo_epi16(a[2], round);
-  c[0] = WienerVertical3(b, filter);
+  c[0] = WienerVertical3<bitdepth>(b, filter);
   b[0] = _mm256_unpackhi_epi16(a[0], a[1]);
   b[1] = _mm256_unpackhi_epi16(a[2], round);
-  c[1] = WienerVertical3(b, filter);
-  return WienerVerticalClip(c);
+  c[1] = WienerVertical3<bitdepth>(b, filter);
+  return WienerVerticalClip<bitdepth>(c);
 }
 
+template <int bitdepth>
 inline __m256i WienerVerticalTap7Kernel(const int16_t* wiener_buffer,
                                         const ptrdiff_t wiener_stride,
                                         const __m256i filter[2], __m256i a[7]) {
@@ -283,9 +316,10 @@ inline __m256i WienerVerticalTap7Kernel(const int16_t* wiener_buffer,
   a[4] = LoadAligned32(wiener_buffer + 4 * wiener_stride);
   a[5] = LoadAligned32(wiener_buffer + 5 * wiener_stride);
   a[6] = LoadAligned32(wiener_buffer + 6 * wiener_stride);
-  return WienerVerticalFilter7(a, filter);
+  return WienerVerticalFilter7<bitdepth>(a, filter);
 }
 
+template <int bitdepth>
 inline __m256i WienerVerticalTap5Kernel(const int16_t* wiener_buffer,
                                         const ptrdiff_t wiener_stride,
                                         const __m256i filter[3], __m256i a[5]) {
@@ -294,45 +328,53 @@ inline __m256i WienerVerticalTap5Kernel(const int16_t* wiener_buffer,
   a[2] = LoadAligned32(wiener_buffer + 2 * wiener_stride);
   a[3] = LoadAligned32(wiener_buffer + 3 * wiener_stride);
   a[4] = LoadAligned32(wiener_buffer + 4 * wiener_stride);
-  return WienerVerticalFilter5(a, filter);
+  return WienerVerticalFilter5<bitdepth>(a, filter);
 }
 
+template <int bitdepth>
 inline __m256i WienerVerticalTap3Kernel(const int16_t* wiener_buffer,
                                         const ptrdiff_t wiener_stride,
                                         const __m256i filter[2], __m256i a[3]) {
   a[0] = LoadAligned32(wiener_buffer + 0 * wiener_stride);
   a[1] = LoadAligned32(wiener_buffer + 1 * wiener_stride);
   a[2] = LoadAligned32(wiener_buffer + 2 * wiener_stride);
-  return WienerVerticalFilter3(a, filter);
+  return WienerVerticalFilter3<bitdepth>(a, filter);
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap7Kernel2(const int16_t* wiener_buffer,
                                       const ptrdiff_t wiener_stride,
                                       const __m256i filter[2], __m256i d[2]) {
   __m256i a[8];
-  d[0] = WienerVerticalTap7Kernel(wiener_buffer, wiener_stride, filter, a);
+  d[0] = WienerVerticalTap7Kernel<bitdepth>(wiener_buffer, wiener_stride,
+                                            filter, a);
   a[7] = LoadAligned32(wiener_buffer + 7 * wiener_stride);
-  d[1] = WienerVerticalFilter7(a + 1, filter);
+  d[1] = WienerVerticalFilter7<bitdepth>(a + 1, filter);
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap5Kernel2(const int16_t* wiener_buffer,
                                       const ptrdiff_t wiener_stride,
                                       const __m256i filter[3], __m256i d[2]) {
   __m256i a[6];
-  d[0] = WienerVerticalTap5Kernel(wiener_buffer, wiener_stride, filter, a);
+  d[0] = WienerVerticalTap5Kernel<bitdepth>(wiener_buffer, wiener_stride,
+                                            filter, a);
   a[5] = LoadAligned32(wiener_buffer + 5 * wiener_stride);
-  d[1] = WienerVerticalFilter5(a + 1, filter);
+  d[1] = WienerVerticalFilter5<bitdepth>(a + 1, filter);
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap3Kernel2(const int16_t* wiener_buffer,
                                       const ptrdiff_t wiener_stride,
                                       const __m256i filter[2], __m256i d[2]) {
   __m256i a[4];
-  d[0] = WienerVerticalTap3Kernel(wiener_buffer, wiener_stride, filter, a);
+  d[0] = WienerVerticalTap3Kernel<bitdepth>(wiener_buffer, wiener_stride,
+                                            filter, a);
   a[3] = LoadAligned32(wiener_buffer + 3 * wiener_stride);
-  d[1] = WienerVerticalFilter3(a + 1, filter);
+  d[1] = WienerVerticalFilter3<bitdepth>(a + 1, filter);
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap7(const int16_t* wiener_buffer,
                                const ptrdiff_t width, const int height,
                                const int16_t coefficients[4], uint16_t* dst,
@@ -348,7 +390,7 @@ inline void WienerVerticalTap7(const int16_t* wiener_buffer,
     ptrdiff_t x = 0;
     do {
       __m256i d[2];
-      WienerVerticalTap7Kernel2(wiener_buffer + x, width, filter, d);
+      WienerVerticalTap7Kernel2<bitdepth>(wiener_buffer + x, width, filter, d);
       StoreUnaligned32(dst + x, d[0]);
       StoreUnaligned32(dst + dst_stride + x, d[1]);
       x += 16;
@@ -361,14 +403,15 @@ inline void WienerVerticalTap7(const int16_t* wiener_buffer,
     ptrdiff_t x = 0;
     do {
       __m256i a[7];
-      const __m256i d =
-          WienerVerticalTap7Kernel(wiener_buffer + x, width, filter, a);
+      const __m256i d = WienerVerticalTap7Kernel<bitdepth>(
+          wiener_buffer + x, width, filter, a);
       StoreUnaligned32(dst + x, d);
       x += 16;
     } while (x < width);
   }
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap5(const int16_t* wiener_buffer,
                                const ptrdiff_t width, const int height,
                                const int16_t coefficients[3], uint16_t* dst,
@@ -383,7 +426,7 @@ inline void WienerVerticalTap5(const int16_t* wiener_buffer,
     ptrdiff_t x = 0;
     do {
       __m256i d[2];
-      WienerVerticalTap5Kernel2(wiener_buffer + x, width, filter, d);
+      WienerVerticalTap5Kernel2<bitdepth>(wiener_buffer + x, width, filter, d);
       StoreUnaligned32(dst + x, d[0]);
       StoreUnaligned32(dst + dst_stride + x, d[1]);
       x += 16;
@@ -396,14 +439,15 @@ inline void WienerVerticalTap5(const int16_t* wiener_buffer,
     ptrdiff_t x = 0;
     do {
       __m256i a[5];
-      const __m256i d =
-          WienerVerticalTap5Kernel(wiener_buffer + x, width, filter, a);
+      const __m256i d = WienerVerticalTap5Kernel<bitdepth>(
+          wiener_buffer + x, width, filter, a);
       StoreUnaligned32(dst + x, d);
       x += 16;
     } while (x < width);
   }
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap3(const int16_t* wiener_buffer,
                                const ptrdiff_t width, const int height,
                                const int16_t coefficients[2], uint16_t* dst,
@@ -417,7 +461,8 @@ inline void WienerVerticalTap3(const int16_t* wiener_buffer,
     ptrdiff_t x = 0;
     do {
       __m256i d[2][2];
-      WienerVerticalTap3Kernel2(wiener_buffer + x, width, filter, d[0]);
+      WienerVerticalTap3Kernel2<bitdepth>(wiener_buffer + x, width, filter,
+                                          d[0]);
       StoreUnaligned32(dst + x, d[0][0]);
       StoreUnaligned32(dst + dst_stride + x, d[0][1]);
       x += 16;
@@ -430,32 +475,38 @@ inline void WienerVerticalTap3(const int16_t* wiener_buffer,
     ptrdiff_t x = 0;
     do {
       __m256i a[3];
-      const __m256i d =
-          WienerVerticalTap3Kernel(wiener_buffer + x, width, filter, a);
+      const __m256i d = WienerVerticalTap3Kernel<bitdepth>(
+          wiener_buffer + x, width, filter, a);
       StoreUnaligned32(dst + x, d);
       x += 16;
     } while (x < width);
   }
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap1Kernel(const int16_t* const wiener_buffer,
                                      uint16_t* const dst) {
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
   const __m256i a = LoadAligned32(wiener_buffer);
-  const __m256i b = _mm256_add_epi16(a, _mm256_set1_epi16(8));
-  const __m256i c = _mm256_srai_epi16(b, 4);
+  constexpr int kShift = kRoundBitsVertical - kWienerFilterBits;
+  const __m256i b = _mm256_add_epi16(a, _mm256_set1_epi16(1 << (kShift - 1)));
+  const __m256i c = _mm256_srai_epi16(b, kShift);
   const __m256i d = _mm256_max_epi16(c, _mm256_setzero_si256());
-  const __m256i e = _mm256_min_epi16(d, _mm256_set1_epi16(1023));
+  const __m256i e = _mm256_min_epi16(d, _mm256_set1_epi16((1 << bitdepth) - 1));
   StoreUnaligned32(dst, e);
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap1(const int16_t* wiener_buffer,
                                const ptrdiff_t width, const int height,
                                uint16_t* dst, const ptrdiff_t dst_stride) {
   for (int y = height >> 1; y > 0; --y) {
     ptrdiff_t x = 0;
     do {
-      WienerVerticalTap1Kernel(wiener_buffer + x, dst + x);
-      WienerVerticalTap1Kernel(wiener_buffer + width + x, dst + dst_stride + x);
+      WienerVerticalTap1Kernel<bitdepth>(wiener_buffer + x, dst + x);
+      WienerVerticalTap1Kernel<bitdepth>(wiener_buffer + width + x,
+                                         dst + dst_stride + x);
       x += 16;
     } while (x < width);
     dst += 2 * dst_stride;
@@ -465,12 +516,13 @@ inline void WienerVerticalTap1(const int16_t* wiener_buffer,
   if ((height & 1) != 0) {
     ptrdiff_t x = 0;
     do {
-      WienerVerticalTap1Kernel(wiener_buffer + x, dst + x);
+      WienerVerticalTap1Kernel<bitdepth>(wiener_buffer + x, dst + x);
       x += 16;
     } while (x < width);
   }
 }
 
+template <int bitdepth>
 void WienerFilter_AVX2(
     const RestorationUnitInfo& LIBGAV1_RESTRICT restoration_info,
     const void* LIBGAV1_RESTRICT const source, const ptrdiff_t stride,
@@ -487,7 +539,7 @@ void WienerFilter_AVX2(
       1);
   const ptrdiff_t wiener_stride = Align(width, 16);
   int16_t* const wiener_buffer_vertical = restoration_buffer->wiener_buffer;
-  // The values are saturated to 13 bits before storing.
+  // The values are saturated to 13 bits (15 bits for 12bpp) before storing.
   int16_t* wiener_buffer_horizontal =
       wiener_buffer_vertical + number_rows_to_skip * wiener_stride;
 
@@ -504,42 +556,51 @@ void WienerFilter_AVX2(
       LoadLo8(restoration_info.wiener_info.filter[WienerInfo::kHorizontal]);
   const __m256i coefficients_horizontal = _mm256_broadcastq_epi64(c);
   if (number_leading_zero_coefficients[WienerInfo::kHorizontal] == 0) {
-    WienerHorizontalTap7(top + (2 - height_extra) * top_border_stride - 3,
-                         top_border_stride, wiener_stride, height_extra,
-                         &coefficients_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap7(src - 3, stride, wiener_stride, height,
-                         &coefficients_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap7(bottom - 3, bottom_border_stride, wiener_stride,
-                         height_extra, &coefficients_horizontal,
-                         &wiener_buffer_horizontal);
+    WienerHorizontalTap7<bitdepth>(
+        top + (2 - height_extra) * top_border_stride - 3, top_border_stride,
+        wiener_stride, height_extra, &coefficients_horizontal,
+        &wiener_buffer_horizontal);
+    WienerHorizontalTap7<bitdepth>(src - 3, stride, wiener_stride, height,
+                                   &coefficients_horizontal,
+                                   &wiener_buffer_horizontal);
+    WienerHorizontalTap7<bitdepth>(bottom - 3, bottom_border_stride,
+                                   wiener_stride, height_extra,
+                                   &coefficients_horizontal,
+                                   &wiener_buffer_horizontal);
   } else if (number_leading_zero_coefficients[WienerInfo::kHorizontal] == 1) {
-    WienerHorizontalTap5(top + (2 - height_extra) * top_border_stride - 2,
-                         top_border_stride, wiener_stride, height_extra,
-                         &coefficients_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap5(src - 2, stride, wiener_stride, height,
-                         &coefficients_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap5(bottom - 2, bottom_border_stride, wiener_stride,
-                         height_extra, &coefficients_horizontal,
-                         &wiener_buffer_horizontal);
+    WienerHorizontalTap5<bitdepth>(
+        top + (2 - height_extra) * top_border_stride - 2, top_border_stride,
+        wiener_stride, height_extra, &coefficients_horizontal,
+        &wiener_buffer_horizontal);
+    WienerHorizontalTap5<bitdepth>(src - 2, stride, wiener_stride, height,
+                                   &coefficients_horizontal,
+                                   &wiener_buffer_horizontal);
+    WienerHorizontalTap5<bitdepth>(bottom - 2, bottom_border_stride,
+                                   wiener_stride, height_extra,
+                                   &coefficients_horizontal,
+                                   &wiener_buffer_horizontal);
   } else if (number_leading_zero_coefficients[WienerInfo::kHorizontal] == 2) {
     // The maximum over-reads happen here.
-    WienerHorizontalTap3(top + (2 - height_extra) * top_border_stride - 1,
-                         top_border_stride, wiener_stride, height_extra,
-                         &coefficients_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap3(src - 1, stride, wiener_stride, height,
-                         &coefficients_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap3(bottom - 1, bottom_border_stride, wiener_stride,
-                         height_extra, &coefficients_horizontal,
-                         &wiener_buffer_horizontal);
+    WienerHorizontalTap3<bitdepth>(
+        top + (2 - height_extra) * top_border_stride - 1, top_border_stride,
+        wiener_stride, height_extra, &coefficients_horizontal,
+        &wiener_buffer_horizontal);
+    WienerHorizontalTap3<bitdepth>(src - 1, stride, wiener_stride, height,
+                                   &coefficients_horizontal,
+                                   &wiener_buffer_horizontal);
+    WienerHorizontalTap3<bitdepth>(bottom - 1, bottom_border_stride,
+                                   wiener_stride, height_extra,
+                                   &coefficients_horizontal,
+                                   &wiener_buffer_horizontal);
   } else {
     assert(number_leading_zero_coefficients[WienerInfo::kHorizontal] == 3);
-    WienerHorizontalTap1(top + (2 - height_extra) * top_border_stride,
-                         top_border_stride, wiener_stride, height_extra,
-                         &wiener_buffer_horizontal);
-    WienerHorizontalTap1(src, stride, wiener_stride, height,
-                         &wiener_buffer_horizontal);
-    WienerHorizontalTap1(bottom, bottom_border_stride, wiener_stride,
-                         height_extra, &wiener_buffer_horizontal);
+    WienerHorizontalTap1<bitdepth>(top + (2 - height_extra) * top_border_stride,
+                                   top_border_stride, wiener_stride,
+                                   height_extra, &wiener_buffer_horizontal);
+    WienerHorizontalTap1<bitdepth>(src, stride, wiener_stride, height,
+                                   &wiener_buffer_horizontal);
+    WienerHorizontalTap1<bitdepth>(bottom, bottom_border_stride, wiener_stride,
+                                   height_extra, &wiener_buffer_horizontal);
   }
 
   // vertical filtering.
@@ -556,18 +617,20 @@ void WienerFilter_AVX2(
     memcpy(restoration_buffer->wiener_buffer,
            restoration_buffer->wiener_buffer + wiener_stride,
            sizeof(*restoration_buffer->wiener_buffer) * wiener_stride);
-    WienerVerticalTap7(wiener_buffer_vertical, wiener_stride, height,
-                       filter_vertical, dst, stride);
+    WienerVerticalTap7<bitdepth>(wiener_buffer_vertical, wiener_stride, height,
+                                 filter_vertical, dst, stride);
   } else if (number_leading_zero_coefficients[WienerInfo::kVertical] == 1) {
-    WienerVerticalTap5(wiener_buffer_vertical + wiener_stride, wiener_stride,
-                       height, filter_vertical + 1, dst, stride);
+    WienerVerticalTap5<bitdepth>(wiener_buffer_vertical + wiener_stride,
+                                 wiener_stride, height, filter_vertical + 1,
+                                 dst, stride);
   } else if (number_leading_zero_coefficients[WienerInfo::kVertical] == 2) {
-    WienerVerticalTap3(wiener_buffer_vertical + 2 * wiener_stride,
-                       wiener_stride, height, filter_vertical + 2, dst, stride);
+    WienerVerticalTap3<bitdepth>(wiener_buffer_vertical + 2 * wiener_stride,
+                                 wiener_stride, height, filter_vertical + 2,
+                                 dst, stride);
   } else {
     assert(number_leading_zero_coefficients[WienerInfo::kVertical] == 3);
-    WienerVerticalTap1(wiener_buffer_vertical + 3 * wiener_stride,
-                       wiener_stride, height, dst, stride);
+    WienerVerticalTap1<bitdepth>(wiener_buffer_vertical + 3 * wiener_stride,
+                                 wiener_stride, height, dst, stride);
   }
 }
 
@@ -722,6 +785,30 @@ inline __m256i VaddwHi8(const __m256i src0, const __m256i src1) {
   return _mm256_add_epi16(src0, s1);
 }
 
+inline __m128i VaddlLo16(const __m128i src0, const __m128i src1) {
+  const __m128i s0 = _mm_unpacklo_epi16(src0, _mm_setzero_si128());
+  const __m128i s1 = _mm_unpacklo_epi16(src1, _mm_setzero_si128());
+  return _mm_add_epi32(s0, s1);
+}
+
+inline __m256i VaddlLo16(const __m256i src0, const __m256i src1) {
+  const __m256i s0 = _mm256_unpacklo_epi16(src0, _mm256_setzero_si256());
+  const __m256i s1 = _mm256_unpacklo_epi16(src1, _mm256_setzero_si256());
+  return _mm256_add_epi32(s0, s1);
+}
+
+inline __m128i VaddlHi16(const __m128i src0, const __m128i src1) {
+  const __m128i s0 = _mm_unpackhi_epi16(src0, _mm_setzero_si128());
+  const __m128i s1 = _mm_unpackhi_epi16(src1, _mm_setzero_si128());
+  return _mm_add_epi32(s0, s1);
+}
+
+inline __m256i VaddlHi16(const __m256i src0, const __m256i src1) {
+  const __m256i s0 = _mm256_unpackhi_epi16(src0, _mm256_setzero_si256());
+  const __m256i s1 = _mm256_unpackhi_epi16(src1, _mm256_setzero_si256());
+  return _mm256_add_epi32(s0, s1);
+}
+
 inline __m256i VmullNLo8(const __m256i src0, const int src1) {
   const __m256i s0 = _mm256_unpacklo_epi16(src0, _mm256_setzero_si256());
   return _mm256_madd_epi16(s0, _mm256_set1_epi32(src1));
@@ -756,6 +843,22 @@ inline __m256i VmullHi16(const __m256i src0, const __m256i src1) {
   return _mm256_madd_epi16(s0, s1);
 }
 
+// The products may use all 32 bits, unlike VmullLo16() and VmullHi16() whose
+// inputs are limited to 15 bits by _mm_madd_epi16().
+inline void VmullU16(const __m128i src0, const __m128i src1, __m128i dst[2]) {
+  const __m128i lo = _mm_mullo_epi16(src0, src1);
+  const __m128i hi = _mm_mulhi_epu16(src0, src1);
+  dst[0] = _mm_unpacklo_epi16(lo, hi);
+  dst[1] = _mm_unpackhi_epi16(lo, hi);
+}
+
+inline void VmullU16(const __m256i src0, const __m256i src1, __m256i dst[2]) {
+  const __m256i lo = _mm256_mullo_epi16(src0, src1);
+  const __m256i hi = _mm256_mulhi_epu16(src0, src1);
+  dst[0] = _mm256_unpacklo_epi16(lo, hi);
+  dst[1] = _mm256_unpackhi_epi16(lo, hi);
+}
+
 inline __m128i VrshrU16(const __m128i src0, const int src1) {
   const __m128i sum = _mm_add_epi16(src0, _mm_set1_epi16(1 << (src1 - 1)));
   return _mm_srli_epi16(sum, src1);
@@ -914,6 +1017,27 @@ inline __m256i Sum5_16(const __m256i src[5]) {
   return _mm256_add_epi16(sum, src[4]);
 }
 
+// A 5x5 box sum of 12 bit pixels needs 17 bits.
+inline void Sum5W16(const __m128i src[5], __m128i dst[2]) {
+  const __m128i sum01 = _mm_add_epi16(src[0], src[1]);
+  const __m128i sum23 = _mm_add_epi16(src[2], src[3]);
+  const __m128i sum4 = src[4];
+  dst[0] = _mm_add_epi32(VaddlLo16(sum01, sum23),
+                         _mm_unpacklo_epi16(sum4, _mm_setzero_si128()));
+  dst[1] = _mm_add_epi32(VaddlHi16(sum01, sum23),
+                         _mm_unpackhi_epi16(sum4, _mm_setzero_si128()));
+}
+
+inline void Sum5W16(const __m256i src[5], __m256i dst[2]) {
+  const __m256i sum01 = _mm256_add_epi16(src[0], src[1]);
+  const __m256i sum23 = _mm256_add_epi16(src[2], src[3]);
+  const __m256i sum4 = src[4];
+  const __m256i sum4_lo = _mm256_unpacklo_epi16(sum4, _mm256_setzero_si256());
+  dst[0] = _mm256_add_epi32(VaddlLo16(sum01, sum23), sum4_lo);
+  const __m256i sum4_hi = _mm256_unpackhi_epi16(sum4, _mm256_setzero_si256());
+  dst[1] = _mm256_add_epi32(VaddlHi16(sum01, sum23), sum4_hi);
+}
+
 inline __m128i Sum5_32(const __m128i* const src0, const __m128i* const src1,
                        const __m128i* const src2, const __m128i* const src3,
                        const __m128i* const src4) {
@@ -1311,15 +1435,30 @@ inline __m128i CalculateMa(const __m128i sum, const __m128i sum_sq,
   return VrshrU32(pxs, kSgrProjScaleBits);
 }
 
-template <int n>
+template <int bitdepth, int n>
 inline __m128i CalculateMa(const __m128i sum, const __m128i sum_sq[2],
                            const uint32_t scale) {
   static_assert(n == 9 || n == 25, "");
-  const __m128i b = VrshrU16(sum, 2);
+  const __m128i b = VrshrU16(sum, bitdepth - 8);
   const __m128i sum_lo = _mm_unpacklo_epi16(b, _mm_setzero_si128());
   const __m128i sum_hi = _mm_unpackhi_epi16(b, _mm_setzero_si128());
-  const __m128i z0 = CalculateMa<n>(sum_lo, VrshrU32(sum_sq[0], 4), scale);
-  const __m128i z1 = CalculateMa<n>(sum_hi, VrshrU32(sum_sq[1], 4), scale);
+  const __m128i z0 =
+      CalculateMa<n>(sum_lo, VrshrU32(sum_sq[0], 2 * (bitdepth - 8)), scale);
+  const __m128i z1 =
+      CalculateMa<n>(sum_hi, VrshrU32(sum_sq[1], 2 * (bitdepth - 8)), scale);
+  return _mm_packus_epi32(z0, z1);
+}
+
+template <int bitdepth, int n>
+inline __m128i CalculateMa(const __m128i sum[2], const __m128i sum_sq[2],
+                           const uint32_t scale) {
+  static_assert(n == 9 || n == 25, "");
+  const __m128i sum_lo = VrshrU32(sum[0], bitdepth - 8);
+  const __m128i sum_hi = VrshrU32(sum[1], bitdepth - 8);
+  const __m128i z0 =
+      CalculateMa<n>(sum_lo, VrshrU32(sum_sq[0], 2 * (bitdepth - 8)), scale);
+  const __m128i z1 =
+      CalculateMa<n>(sum_hi, VrshrU32(sum_sq[1], 2 * (bitdepth - 8)), scale);
   return _mm_packus_epi32(z0, z1);
 }
 
@@ -1342,15 +1481,30 @@ inline __m256i CalculateMa(const __m256i sum, const __m256i sum_sq,
   return VrshrU32(pxs, kSgrProjScaleBits);
 }
 
-template <int n>
+template <int bitdepth, int n>
 inline __m256i CalculateMa(const __m256i sum, const __m256i sum_sq[2],
                            const uint32_t scale) {
   static_assert(n == 9 || n == 25, "");
-  const __m256i b = VrshrU16(sum, 2);
+  const __m256i b = VrshrU16(sum, bitdepth - 8);
   const __m256i sum_lo = _mm256_unpacklo_epi16(b, _mm256_setzero_si256());
   const __m256i sum_hi = _mm256_unpackhi_epi16(b, _mm256_setzero_si256());
-  const __m256i z0 = CalculateMa<n>(sum_lo, VrshrU32(sum_sq[0], 4), scale);
-  const __m256i z1 = CalculateMa<n>(sum_hi, VrshrU32(sum_sq[1], 4), scale);
+  const __m256i z0 =
+      CalculateMa<n>(sum_lo, VrshrU32(sum_sq[0], 2 * (bitdepth - 8)), scale);
+  const __m256i z1 =
+      CalculateMa<n>(sum_hi, VrshrU32(sum_sq[1], 2 * (bitdepth - 8)), scale);
+  return _mm256_packus_epi32(z0, z1);
+}
+
+template <int bitdepth, int n>
+inline __m256i CalculateMa(const __m256i sum[2], const __m256i sum_sq[2],
+                           const uint32_t scale) {
+  static_assert(n == 9 || n == 25, "");
+  const __m256i sum_lo = VrshrU32(sum[0], bitdepth - 8);
+  const __m256i sum_hi = VrshrU32(sum[1], bitdepth - 8);
+  const __m256i z0 =
+      CalculateMa<n>(sum_lo, VrshrU32(sum_sq[0], 2 * (bitdepth - 8)), scale);
+  const __m256i z1 =
+      CalculateMa<n>(sum_hi, VrshrU32(sum_sq[1], 2 * (bitdepth - 8)), scale);
   return _mm256_packus_epi32(z0, z1);
 }
 
@@ -1385,14 +1539,50 @@ inline void CalculateB5(const __m256i sum, const __m256i ma, __m256i b[2]) {
   b[1] = VrshrU32(m1, kSgrProjReciprocalBits - 2);
 }
 
+inline void CalculateB5(const __m128i sum[2], const __m128i ma, __m128i b[2]) {
+  // one_over_n == 164.
+  constexpr uint32_t one_over_n =
+      ((1 << kSgrProjReciprocalBits) + (25 >> 1)) / 25;
+  // one_over_n_quarter == 41.
+  constexpr uint32_t one_over_n_quarter = one_over_n >> 2;
+  static_assert(one_over_n == one_over_n_quarter << 2, "");
+  // |ma| is in range [0, 255].
+  const __m128i m = _mm_maddubs_epi16(ma, _mm_set1_epi16(one_over_n_quarter));
+  const __m128i m_lo = _mm_unpacklo_epi16(m, _mm_setzero_si128());
+  const __m128i m_hi = _mm_unpackhi_epi16(m, _mm_setzero_si128());
+  const __m128i m0 = _mm_mullo_epi32(m_lo, sum[0]);
+  const __m128i m1 = _mm_mullo_epi32(m_hi, sum[1]);
+  b[0] = VrshrU32(m0, kSgrProjReciprocalBits - 2);
+  b[1] = VrshrU32(m1, kSgrProjReciprocalBits - 2);
+}
+
+inline void CalculateB5(const __m256i sum[2], const __m256i ma, __m256i b[2]) {
+  // one_over_n == 164.
+  constexpr uint32_t one_over_n =
+      ((1 << kSgrProjReciprocalBits) + (25 >> 1)) / 25;
+  // one_over_n_quarter == 41.
+  constexpr uint32_t one_over_n_quarter = one_over_n >> 2;
+  static_assert(one_over_n == one_over_n_quarter << 2, "");
+  // |ma| is in range [0, 255].
+  const __m256i m =
+      _mm256_maddubs_epi16(ma, _mm256_set1_epi16(one_over_n_quarter));
+  const __m256i m_lo = _mm256_unpacklo_epi16(m, _mm256_setzero_si256());
+  const __m256i m_hi = _mm256_unpackhi_epi16(m, _mm256_setzero_si256());
+  const __m256i m0 = _mm256_mullo_epi32(m_lo, sum[0]);
+  const __m256i m1 = _mm256_mullo_epi32(m_hi, sum[1]);
+  b[0] = VrshrU32(m0, kSgrProjReciprocalBits - 2);
+  b[1] = VrshrU32(m1, kSgrProjReciprocalBits - 2);
+}
+
 inline void CalculateB3(const __m128i sum, const __m128i ma, __m128i b[2]) {
   // one_over_n == 455.
   constexpr uint32_t one_over_n =
       ((1 << kSgrProjReciprocalBits) + (9 >> 1)) / 9;
-  const __m128i m0 = VmullLo16(ma, sum);
-  const __m128i m1 = VmullHi16(ma, sum);
-  const __m128i m2 = _mm_mullo_epi32(m0, _mm_set1_epi32(one_over_n));
-  const __m128i m3 = _mm_mullo_epi32(m1, _mm_set1_epi32(one_over_n));
+  // A 3x3 box sum of 12 bit pixels uses all 16 bits.
+  __m128i m[2];
+  VmullU16(ma, sum, m);
+  const __m128i m2 = _mm_mullo_epi32(m[0], _mm_set1_epi32(one_over_n));
+  const __m128i m3 = _mm_mullo_epi32(m[1], _mm_set1_epi32(one_over_n));
   b[0] = VrshrU32(m2, kSgrProjReciprocalBits);
   b[1] = VrshrU32(m3, kSgrProjReciprocalBits);
 }
@@ -1401,54 +1591,76 @@ inline void CalculateB3(const __m256i sum, const __m256i ma, __m256i b[2]) {
   // one_over_n == 455.
   constexpr uint32_t one_over_n =
       ((1 << kSgrProjReciprocalBits) + (9 >> 1)) / 9;
-  const __m256i m0 = VmullLo16(ma, sum);
-  const __m256i m1 = VmullHi16(ma, sum);
-  const __m256i m2 = _mm256_mullo_epi32(m0, _mm256_set1_epi32(one_over_n));
-  const __m256i m3 = _mm256_mullo_epi32(m1, _mm256_set1_epi32(one_over_n));
+  // A 3x3 box sum of 12 bit pixels uses all 16 bits.
+  __m256i m[2];
+  VmullU16(ma, sum, m);
+  const __m256i m2 = _mm256_mullo_epi32(m[0], _mm256_set1_epi32(one_over_n));
+  const __m256i m3 = _mm256_mullo_epi32(m[1], _mm256_set1_epi32(one_over_n));
   b[0] = VrshrU32(m2, kSgrProjReciprocalBits);
   b[1] = VrshrU32(m3, kSgrProjReciprocalBits);
 }
 
+template <int bitdepth>
 inline void CalculateSumAndIndex5(const __m128i s5[5], const __m128i sq5[5][2],
                                   const uint32_t scale, __m128i* const sum,
                                   __m128i* const index) {
   __m128i sum_sq[2];
   *sum = Sum5_16(s5);
   Sum5_32(sq5, sum_sq);
-  *index = CalculateMa<25>(*sum, sum_sq, scale);
+  *index = CalculateMa<bitdepth, 25>(*sum, sum_sq, scale);
 }
 
+// The 5x5 box sums of 12 bit pixels are widened to 32 bits.
+template <int bitdepth>
+inline void CalculateSumAndIndex5W(const __m128i s5[5], const __m128i sq5[5][2],
+                                   const uint32_t scale, __m128i sum[2],
+                                   __m128i* const index) {
+  __m128i sum_sq[2];
+  Sum5W16(s5, sum);
+  Sum5_32(sq5, sum_sq);
+  *index = CalculateMa<bitdepth, 25>(sum, sum_sq, scale);
+}
+
+// For 12 bit pixels |sum| wraps around and only |index| is valid.
+// CalculateIntermediate5() computes the 32 bit box sums again from |s5|.
+template <int bitdepth>
 inline void CalculateSumAndIndex5(const __m256i s5[5], const __m256i sq5[5][2],
                                   const uint32_t scale, __m256i* const sum,
                                   __m256i* const index) {
   __m256i sum_sq[2];
   *sum = Sum5_16(s5);
   Sum5_32(sq5, sum_sq);
-  *index = CalculateMa<25>(*sum, sum_sq, scale);
+  if (bitdepth == kBitdepth12) {
+    __m256i sum_w[2];
+    Sum5W16(s5, sum_w);
+    *index = CalculateMa<bitdepth, 25>(sum_w, sum_sq, scale);
+  } else {
+    *index = CalculateMa<bitdepth, 25>(*sum, sum_sq, scale);
+  }
 }
 
+template <int bitdepth>
 inline void CalculateSumAndIndex3(const __m128i s3[3], const __m128i sq3[3][2],
                                   const uint32_t scale, __m128i* const sum,
                                   __m128i* const index) {
   __m128i sum_sq[2];
   *sum = Sum3_16(s3);
   Sum3_32(sq3, sum_sq);
-  *index = CalculateMa<9>(*sum, sum_sq, scale);
+  *index = CalculateMa<bitdepth, 9>(*sum, sum_sq, scale);
 }
 
+template <int bitdepth>
 inline void CalculateSumAndIndex3(const __m256i s3[3], const __m256i sq3[3][2],
                                   const uint32_t scale, __m256i* const sum,
                                   __m256i* const index) {
   __m256i sum_sq[2];
   *sum = Sum3_16(s3);
   Sum3_32(sq3, sum_sq);
-  *index = CalculateMa<9>(*sum, sum_sq, scale);
+  *index = CalculateMa<bitdepth, 9>(*sum, sum_sq, scale);
 }
 
-template <int n>
-inline void LookupIntermediate(const __m128i sum, const __m128i index,
-                               __m128i* const ma, __m128i b[2]) {
-  static_assert(n == 9 || n == 25, "");
+// Returns the 8 |ma| values also stored in |ma|, widened to 16 bits.
+inline __m128i LookupMa(const __m128i index, __m128i* const ma) {
   const __m128i idx = _mm_packus_epi16(index, index);
   // Actually it's not stored and loaded. The compiler will use a 64-bit
   // general-purpose register to process. Faster than using _mm_extract_epi8().
@@ -1462,6 +1674,14 @@ inline void LookupIntermediate(const __m128i sum, const __m128i index,
   *ma = _mm_insert_epi8(*ma, kSgrMaLookup[temp[5]], 5);
   *ma = _mm_insert_epi8(*ma, kSgrMaLookup[temp[6]], 6);
   *ma = _mm_insert_epi8(*ma, kSgrMaLookup[temp[7]], 7);
+  return _mm_unpacklo_epi8(*ma, _mm_setzero_si128());
+}
+
+template <int n>
+inline void LookupIntermediate(const __m128i sum, const __m128i index,
+                               __m128i* const ma, __m128i b[2]) {
+  static_assert(n == 9 || n == 25, "");
+  const __m128i maq = LookupMa(index, ma);
   // b = ma * b * one_over_n
   // |ma| = [0, 255]
   // |sum| is a box sum with radius 1 or 2.
@@ -1473,7 +1693,6 @@ inline void LookupIntermediate(const __m128i sum, const __m128i index,
   // |kSgrProjReciprocalBits| is 12.
   // Radius 2: 255 * 6375 * 164 >> 12 = 65088 (16 bits).
   // Radius 1: 255 * 2295 * 455 >> 12 = 65009 (16 bits).
-  const __m128i maq = _mm_unpacklo_epi8(*ma, _mm_setzero_si128());
   if (n == 9) {
     CalculateB3(sum, maq, b);
   } else {
@@ -1481,6 +1700,13 @@ inline void LookupIntermediate(const __m128i sum, const __m128i index,
   }
 }
 
+// 12 bit pixels only. The 5x5 box sums are 32 bits.
+inline void LookupIntermediate5(const __m128i sum[2], const __m128i index,
+                                __m128i* const ma, __m128i b[2]) {
+  const __m128i maq = LookupMa(index, ma);
+  CalculateB5(sum, maq, b);
+}
+
 // Repeat the first 48 elements in kSgrMaLookup with a period of 16.
 alignas(32) constexpr uint8_t kSgrMaLookupAvx2[96] = {
     255, 128, 85, 64, 51, 43, 37, 32, 28, 26, 23, 21, 20, 18, 17, 16,
@@ -1577,10 +1803,7 @@ inline void CalculateIntermediate(const __m128i sum[2], const __m128i index[2],
   CalculateB3(sum[1], maq1, b1);
 }
 
-template <int n>
-inline void CalculateIntermediate(const __m256i sum[2], const __m256i index[2],
-                                  __m256i ma[3], __m256i b0[2], __m256i b1[2]) {
-  static_assert(n == 9 || n == 25, "");
+inline void LookupMa(const __m256i index[2], __m256i ma[3]) {
   // Use table lookup to read elements whose indices are less than 48.
   const __m256i c0 = LoadAligned32(kSgrMaLookupAvx2 + 0 * 32);
   const __m256i c1 = LoadAligned32(kSgrMaLookupAvx2 + 1 * 32);
@@ -1620,6 +1843,13 @@ inline void CalculateIntermediate(const __m256i sum[2], const __m256i index[2],
   ma[2] = _mm256_permute4x64_epi64(mas, 0x63);     // 32-39 8-15 16-23 24-31
   ma[0] = _mm256_blend_epi32(ma[0], ma[2], 0xfc);  //  0-7  8-15 16-23 24-31
   ma[1] = _mm256_permute2x128_si256(ma[0], ma[2], 0x21);
+}
+
+template <int n>
+inline void CalculateIntermediate(const __m256i sum[2], const __m256i index[2],
+                                  __m256i ma[3], __m256i b0[2], __m256i b1[2]) {
+  static_assert(n == 9 || n == 25, "");
+  LookupMa(index, ma);
 
   // b = ma * b * one_over_n
   // |ma| = [0, 255]
@@ -1646,19 +1876,53 @@ inline void CalculateIntermediate(const __m256i sum[2], const __m256i index[2],
   }
 }
 
+// For 12 bit pixels the 5x5 box sums are computed again from |s5| in 32 bits,
+// in the lane order of the 16 bit |sum| after the permutes above.
+template <int bitdepth>
+inline void CalculateIntermediate5(const __m256i s5[2][5],
+                                   const __m256i sum[2],
+                                   const __m256i index[2], __m256i ma[3],
+                                   __m256i b0[2], __m256i b1[2]) {
+  if (bitdepth != kBitdepth12) {
+    CalculateIntermediate<25>(sum, index, ma, b0, b1);
+    return;
+  }
+  LookupMa(index, ma);
+  const __m256i maq0 = _mm256_unpackhi_epi8(ma[0], _mm256_setzero_si256());
+  const __m256i maq1 = _mm256_unpacklo_epi8(ma[1], _mm256_setzero_si256());
+  __m256i sum_w[2][2], sums[2];
+  Sum5W16(s5[0], sum_w[0]);
+  Sum5W16(s5[1], sum_w[1]);
+  sums[0] = _mm256_permute2x128_si256(sum_w[0][0], sum_w[1][0], 0x20);
+  sums[1] = _mm256_permute2x128_si256(sum_w[0][1], sum_w[1][1], 0x20);
+  CalculateB5(sums, maq0, b0);
+  sums[0] = _mm256_permute2x128_si256(sum_w[0][0], sum_w[1][0], 0x31);
+  sums[1] = _mm256_permute2x128_si256(sum_w[0][1], sum_w[1][1], 0x31);
+  CalculateB5(sums, maq1, b1);
+}
+
+template <int bitdepth>
 inline void CalculateIntermediate5(const __m128i s5[5], const __m128i sq5[5][2],
                                    const uint32_t scale, __m128i* const ma,
                                    __m128i b[2]) {
-  __m128i sum, index;
-  CalculateSumAndIndex5(s5, sq5, scale, &sum, &index);
-  LookupIntermediate<25>(sum, index, ma, b);
+  __m128i index;
+  if (bitdepth == kBitdepth12) {
+    __m128i sum[2];
+    CalculateSumAndIndex5W<bitdepth>(s5, sq5, scale, sum, &index);
+    LookupIntermediate5(sum, index, ma, b);
+  } else {
+    __m128i sum;
+    CalculateSumAndIndex5<bitdepth>(s5, sq5, scale, &sum, &index);
+    LookupIntermediate<25>(sum, index, ma, b);
+  }
 }
 
+template <int bitdepth>
 inline void CalculateIntermediate3(const __m128i s3[3], const __m128i sq3[3][2],
                                    const uint32_t scale, __m128i* const ma,
                                    __m128i b[2]) {
   __m128i sum, index;
-  CalculateSumAndIndex3(s3, sq3, scale, &sum, &index);
+  CalculateSumAndIndex3<bitdepth>(s3, sq3, scale, &sum, &index);
   LookupIntermediate<9>(sum, index, ma, b);
 }
 
@@ -1827,6 +2091,7 @@ inline void PermuteB(const __m256i t[4], __m256i b[7]) {
   b[6] = t[3];
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5Lo(
     const __m128i s[2][2], const uint32_t scale, uint16_t* const sum5[5],
     uint32_t* const square_sum5[5], __m128i sq[2][4], __m128i* const ma,
@@ -1844,9 +2109,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5Lo(
   StoreAligned32U32(square_sum5[4], sq5[4]);
   LoadAligned16x3U16(sum5, 0, s5[0]);
   LoadAligned32x3U32(square_sum5, 0, sq5);
-  CalculateIntermediate5(s5[0], sq5, scale, ma, b);
+  CalculateIntermediate5<bitdepth>(s5[0], sq5, scale, ma, b);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5(
     const uint16_t* const src0, const uint16_t* const src1,
     const ptrdiff_t over_read_in_bytes, const ptrdiff_t sum_width,
@@ -1876,7 +2142,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5(
   StoreAligned64(square_sum5[4] + x, sq5[4]);
   LoadAligned32x3U16(sum5, x, s5[0]);
   LoadAligned64x3U32(square_sum5, x, sq5);
-  CalculateSumAndIndex5(s5[0], sq5, scale, &sum[0], &index[0]);
+  CalculateSumAndIndex5<bitdepth>(s5[0], sq5, scale, &sum[0], &index[0]);
 
   s[0] = LoadUnaligned32Msan(src0 + 24, over_read_in_bytes + 48);
   s[1] = LoadUnaligned32Msan(src1 + 24, over_read_in_bytes + 48);
@@ -1892,11 +2158,12 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5(
   StoreAligned64(square_sum5[4] + x + 16, sq5[4]);
   LoadAligned32x3U16Msan(sum5, x + 16, sum_width, s5[1]);
   LoadAligned64x3U32Msan(square_sum5, x + 16, sum_width, sq5);
-  CalculateSumAndIndex5(s5[1], sq5, scale, &sum[1], &index[1]);
-  CalculateIntermediate<25>(sum, index, ma, t, t + 2);
+  CalculateSumAndIndex5<bitdepth>(s5[1], sq5, scale, &sum[1], &index[1]);
+  CalculateIntermediate5<bitdepth>(s5, sum, index, ma, t, t + 2);
   PermuteB(t, b);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5LastRowLo(
     const __m128i s[2], const uint32_t scale, const uint16_t* const sum5[5],
     const uint32_t* const square_sum5[5], __m128i sq[4], __m128i* const ma,
@@ -1909,9 +2176,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5LastRowLo(
   sq5[4][1] = sq5[3][1];
   LoadAligned16x3U16(sum5, 0, s5);
   LoadAligned32x3U32(square_sum5, 0, sq5);
-  CalculateIntermediate5(s5, sq5, scale, ma, b);
+  CalculateIntermediate5<bitdepth>(s5, sq5, scale, ma, b);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5LastRow(
     const uint16_t* const src, const ptrdiff_t over_read_in_bytes,
     const ptrdiff_t sum_width, const ptrdiff_t x, const uint32_t scale,
@@ -1931,7 +2199,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5LastRow(
   sq5[4][1] = sq5[3][1];
   LoadAligned32x3U16(sum5, x, s5[0]);
   LoadAligned64x3U32(square_sum5, x, sq5);
-  CalculateSumAndIndex5(s5[0], sq5, scale, &sum[0], &index[0]);
+  CalculateSumAndIndex5<bitdepth>(s5[0], sq5, scale, &sum[0], &index[0]);
 
   const __m256i s1 = LoadUnaligned32Msan(src + 24, over_read_in_bytes + 48);
   Square(s1, sq + 6);
@@ -1942,11 +2210,12 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5LastRow(
   sq5[4][1] = sq5[3][1];
   LoadAligned32x3U16Msan(sum5, x + 16, sum_width, s5[1]);
   LoadAligned64x3U32Msan(square_sum5, x + 16, sum_width, sq5);
-  CalculateSumAndIndex5(s5[1], sq5, scale, &sum[1], &index[1]);
-  CalculateIntermediate<25>(sum, index, ma, t, t + 2);
+  CalculateSumAndIndex5<bitdepth>(s5[1], sq5, scale, &sum[1], &index[1]);
+  CalculateIntermediate5<bitdepth>(s5, sum, index, ma, t, t + 2);
   PermuteB(t, b);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess3Lo(
     const __m128i s[2], const uint32_t scale, uint16_t* const sum3[3],
     uint32_t* const square_sum3[3], __m128i sq[4], __m128i* const ma,
@@ -1959,9 +2228,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess3Lo(
   StoreAligned32U32(square_sum3[2], sq3[2]);
   LoadAligned16x2U16(sum3, 0, s3);
   LoadAligned32x2U32(square_sum3, 0, sq3);
-  CalculateIntermediate3(s3, sq3, scale, ma, b);
+  CalculateIntermediate3<bitdepth>(s3, sq3, scale, ma, b);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess3(
     const uint16_t* const src, const ptrdiff_t over_read_in_bytes,
     const ptrdiff_t x, const ptrdiff_t sum_width, const uint32_t scale,
@@ -1980,7 +2250,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess3(
   StoreAligned64(square_sum3[2] + x, sq3[2]);
   LoadAligned32x2U16(sum3, x, s3);
   LoadAligned64x2U32(square_sum3, x, sq3);
-  CalculateSumAndIndex3(s3, sq3, scale, &sum[0], &index[0]);
+  CalculateSumAndIndex3<bitdepth>(s3, sq3, scale, &sum[0], &index[0]);
 
   Square(s[1], sq + 6);
   sq[4] = _mm256_permute2x128_si256(sq[2], sq[6], 0x21);
@@ -1989,11 +2259,12 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess3(
   StoreAligned64(square_sum3[2] + x + 16, sq3[2]);
   LoadAligned32x2U16Msan(sum3, x + 16, sum_width, s3 + 1);
   LoadAligned64x2U32Msan(square_sum3, x + 16, sum_width, sq3);
-  CalculateSumAndIndex3(s3 + 1, sq3, scale, &sum[1], &index[1]);
+  CalculateSumAndIndex3<bitdepth>(s3 + 1, sq3, scale, &sum[1], &index[1]);
   CalculateIntermediate<9>(sum, index, ma, t, t + 2);
   PermuteB(t, b);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLo(
     const __m128i s[2][4], const uint16_t scales[2], uint16_t* const sum3[4],
     uint16_t* const sum5[5], uint32_t* const square_sum3[4],
@@ -2018,13 +2289,16 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLo(
   LoadAligned32x2U32(square_sum3, 0, sq3);
   LoadAligned16x3U16(sum5, 0, s5);
   LoadAligned32x3U32(square_sum5, 0, sq5);
-  CalculateSumAndIndex3(s3 + 0, sq3 + 0, scales[1], &sum[0], &index[0]);
-  CalculateSumAndIndex3(s3 + 1, sq3 + 1, scales[1], &sum[1], &index[1]);
+  CalculateSumAndIndex3<bitdepth>(s3 + 0, sq3 + 0, scales[1], &sum[0],
+                                  &index[0]);
+  CalculateSumAndIndex3<bitdepth>(s3 + 1, sq3 + 1, scales[1], &sum[1],
+                                  &index[1]);
   CalculateIntermediate(sum, index, &ma3[0][0], b3[0], b3[1]);
   ma3[1][0] = _mm_srli_si128(ma3[0][0], 8);
-  CalculateIntermediate5(s5, sq5, scales[0], ma5, b5);
+  CalculateIntermediate5<bitdepth>(s5, sq5, scales[0], ma5, b5);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess(
     const uint16_t* const src0, const uint16_t* const src1,
     const ptrdiff_t over_read_in_bytes, const ptrdiff_t x,
@@ -2062,12 +2336,14 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess(
   StoreAligned64(square_sum5[4] + x, sq5[4]);
   LoadAligned32x2U16(sum3, x, s3[0]);
   LoadAligned64x2U32(square_sum3, x, sq3);
-  CalculateSumAndIndex3(s3[0], sq3, scales[1], &sum_3[0][0], &index_3[0][0]);
-  CalculateSumAndIndex3(s3[0] + 1, sq3 + 1, scales[1], &sum_3[1][0],
-                        &index_3[1][0]);
+  CalculateSumAndIndex3<bitdepth>(s3[0], sq3, scales[1], &sum_3[0][0],
+                                  &index_3[0][0]);
+  CalculateSumAndIndex3<bitdepth>(s3[0] + 1, sq3 + 1, scales[1], &sum_3[1][0],
+                                  &index_3[1][0]);
   LoadAligned32x3U16(sum5, x, s5[0]);
   LoadAligned64x3U32(square_sum5, x, sq5);
-  CalculateSumAndIndex5(s5[0], sq5, scales[0], &sum_5[0], &index_5[0]);
+  CalculateSumAndIndex5<bitdepth>(s5[0], sq5, scales[0], &sum_5[0],
+                                  &index_5[0]);
 
   s[0] = LoadUnaligned32Msan(src0 + 24, over_read_in_bytes + 48);
   s[1] = LoadUnaligned32Msan(src1 + 24, over_read_in_bytes + 48);
@@ -2085,20 +2361,23 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess(
   StoreAligned64(square_sum5[4] + x + 16, sq5[4]);
   LoadAligned32x2U16Msan(sum3, x + 16, sum_width, s3[1]);
   LoadAligned64x2U32Msan(square_sum3, x + 16, sum_width, sq3);
-  CalculateSumAndIndex3(s3[1], sq3, scales[1], &sum_3[0][1], &index_3[0][1]);
-  CalculateSumAndIndex3(s3[1] + 1, sq3 + 1, scales[1], &sum_3[1][1],
-                        &index_3[1][1]);
+  CalculateSumAndIndex3<bitdepth>(s3[1], sq3, scales[1], &sum_3[0][1],
+                                  &index_3[0][1]);
+  CalculateSumAndIndex3<bitdepth>(s3[1] + 1, sq3 + 1, scales[1], &sum_3[1][1],
+                                  &index_3[1][1]);
   CalculateIntermediate<9>(sum_3[0], index_3[0], ma3[0], t, t + 2);
   PermuteB(t, b3[0]);
   CalculateIntermediate<9>(sum_3[1], index_3[1], ma3[1], t, t + 2);
   PermuteB(t, b3[1]);
   LoadAligned32x3U16Msan(sum5, x + 16, sum_width, s5[1]);
   LoadAligned64x3U32Msan(square_sum5, x + 16, sum_width, sq5);
-  CalculateSumAndIndex5(s5[1], sq5, scales[0], &sum_5[1], &index_5[1]);
-  CalculateIntermediate<25>(sum_5, index_5, ma5, t, t + 2);
+  CalculateSumAndIndex5<bitdepth>(s5[1], sq5, scales[0], &sum_5[1],
+                                  &index_5[1]);
+  CalculateIntermediate5<bitdepth>(s5, sum_5, index_5, ma5, t, t + 2);
   PermuteB(t, b5);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRowLo(
     const __m128i s[2], const uint16_t scales[2], const uint16_t* const sum3[4],
     const uint16_t* const sum5[5], const uint32_t* const square_sum3[4],
@@ -2113,12 +2392,13 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRowLo(
   LoadAligned32x3U32(square_sum5, 0, sq5);
   sq5[4][0] = sq5[3][0];
   sq5[4][1] = sq5[3][1];
-  CalculateIntermediate5(s5, sq5, scales[0], ma5, b5);
+  CalculateIntermediate5<bitdepth>(s5, sq5, scales[0], ma5, b5);
   LoadAligned16x2U16(sum3, 0, s3);
   LoadAligned32x2U32(square_sum3, 0, sq3);
-  CalculateIntermediate3(s3, sq3, scales[1], ma3, b3);
+  CalculateIntermediate3<bitdepth>(s3, sq3, scales[1], ma3, b3);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRow(
     const uint16_t* const src, const ptrdiff_t over_read_in_bytes,
     const ptrdiff_t sum_width, const ptrdiff_t x, const uint16_t scales[2],
@@ -2137,13 +2417,15 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRow(
   SumHorizontal32(sq, &sq3[2][0], &sq3[2][1], &sq5[3][0], &sq5[3][1]);
   LoadAligned32x2U16(sum3, x, s3[0]);
   LoadAligned64x2U32(square_sum3, x, sq3);
-  CalculateSumAndIndex3(s3[0], sq3, scales[1], &sum_3[0], &index_3[0]);
+  CalculateSumAndIndex3<bitdepth>(s3[0], sq3, scales[1], &sum_3[0],
+                                  &index_3[0]);
   LoadAligned32x3U16(sum5, x, s5[0]);
   s5[0][4] = s5[0][3];
   LoadAligned64x3U32(square_sum5, x, sq5);
   sq5[4][0] = sq5[3][0];
   sq5[4][1] = sq5[3][1];
-  CalculateSumAndIndex5(s5[0], sq5, scales[0], &sum_5[0], &index_5[0]);
+  CalculateSumAndIndex5<bitdepth>(s5[0], sq5, scales[0], &sum_5[0],
+                                  &index_5[0]);
 
   const __m256i s1 = LoadUnaligned32Msan(src + 24, over_read_in_bytes + 48);
   Square(s1, sq + 6);
@@ -2152,7 +2434,8 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRow(
   SumHorizontal32(sq + 4, &sq3[2][0], &sq3[2][1], &sq5[3][0], &sq5[3][1]);
   LoadAligned32x2U16Msan(sum3, x + 16, sum_width, s3[1]);
   LoadAligned64x2U32Msan(square_sum3, x + 16, sum_width, sq3);
-  CalculateSumAndIndex3(s3[1], sq3, scales[1], &sum_3[1], &index_3[1]);
+  CalculateSumAndIndex3<bitdepth>(s3[1], sq3, scales[1], &sum_3[1],
+                                  &index_3[1]);
   CalculateIntermediate<9>(sum_3, index_3, ma3, t, t + 2);
   PermuteB(t, b3);
   LoadAligned32x3U16Msan(sum5, x + 16, sum_width, s5[1]);
@@ -2160,11 +2443,13 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRow(
   LoadAligned64x3U32Msan(square_sum5, x + 16, sum_width, sq5);
   sq5[4][0] = sq5[3][0];
   sq5[4][1] = sq5[3][1];
-  CalculateSumAndIndex5(s5[1], sq5, scales[0], &sum_5[1], &index_5[1]);
-  CalculateIntermediate<25>(sum_5, index_5, ma5, t, t + 2);
+  CalculateSumAndIndex5<bitdepth>(s5[1], sq5, scales[0], &sum_5[1],
+                                  &index_5[1]);
+  CalculateIntermediate5<bitdepth>(s5, sum_5, index_5, ma5, t, t + 2);
   PermuteB(t, b5);
 }
 
+template <int bitdepth>
 inline void BoxSumFilterPreProcess5(const uint16_t* const src0,
                                     const uint16_t* const src1, const int width,
                                     const uint32_t scale,
@@ -2182,7 +2467,8 @@ inline void BoxSumFilterPreProcess5(const uint16_t* const src0,
   s[1][1] = LoadUnaligned16Msan(src1 + 8, overread_in_bytes + 16);
   Square(s[0][0], sq_128[0]);
   Square(s[1][0], sq_128[1]);
-  BoxFilterPreProcess5Lo(s, scale, sum5, square_sum5, sq_128, &ma0, b0);
+  BoxFilterPreProcess5Lo<bitdepth>(s, scale, sum5, square_sum5, sq_128, &ma0,
+                                   b0);
   sq[0][0] = SetrM128i(sq_128[0][2], sq_128[0][2]);
   sq[0][1] = SetrM128i(sq_128[0][3], sq_128[0][3]);
   sq[1][0] = SetrM128i(sq_128[1][2], sq_128[1][2]);
@@ -2194,7 +2480,7 @@ inline void BoxSumFilterPreProcess5(const uint16_t* const src0,
   int x = 0;
   do {
     __m256i ma5[3], ma[2], b[4];
-    BoxFilterPreProcess5(
+    BoxFilterPreProcess5<bitdepth>(
         src0 + x + 8, src1 + x + 8,
         kOverreadInBytesPass1_256 + sizeof(*src0) * (x + 8 - width), sum_width,
         x + 8, scale, sum5, square_sum5, sq, mas, bs);
@@ -2219,7 +2505,7 @@ inline void BoxSumFilterPreProcess5(const uint16_t* const src0,
   } while (x < width);
 }
 
-template <bool calculate444>
+template <int bitdepth, bool calculate444>
 LIBGAV1_ALWAYS_INLINE void BoxSumFilterPreProcess3(
     const uint16_t* const src, const int width, const uint32_t scale,
     uint16_t* const sum3[3], uint32_t* const square_sum3[3],
@@ -2232,7 +2518,8 @@ LIBGAV1_ALWAYS_INLINE void BoxSumFilterPreProcess3(
   s[0] = LoadUnaligned16Msan(src + 0, overread_in_bytes_128 + 0);
   s[1] = LoadUnaligned16Msan(src + 8, overread_in_bytes_128 + 16);
   Square(s[0], sq_128);
-  BoxFilterPreProcess3Lo(s, scale, sum3, square_sum3, sq_128, &ma0, b0);
+  BoxFilterPreProcess3Lo<bitdepth>(s, scale, sum3, square_sum3, sq_128, &ma0,
+                                   b0);
   sq[0] = SetrM128i(sq_128[2], sq_128[2]);
   sq[1] = SetrM128i(sq_128[3], sq_128[3]);
   mas[0] = SetrM128i(ma0, ma0);
@@ -2242,7 +2529,7 @@ LIBGAV1_ALWAYS_INLINE void BoxSumFilterPreProcess3(
   int x = 0;
   do {
     __m256i ma3[3];
-    BoxFilterPreProcess3(
+    BoxFilterPreProcess3<bitdepth>(
         src + x + 8, kOverreadInBytesPass2_256 + sizeof(*src) * (x + 8 - width),
         x + 8, sum_width, scale, sum3, square_sum3, sq, mas, bs);
     Prepare3_8(mas, ma3);
@@ -2272,6 +2559,7 @@ LIBGAV1_ALWAYS_INLINE void BoxSumFilterPreProcess3(
   } while (x < width);
 }
 
+template <int bitdepth>
 inline void BoxSumFilterPreProcess(
     const uint16_t* const src0, const uint16_t* const src1, const int width,
     const uint16_t scales[2], uint16_t* const sum3[4], uint16_t* const sum5[5],
@@ -2290,8 +2578,9 @@ inline void BoxSumFilterPreProcess(
   s[1][1] = LoadUnaligned16Msan(src1 + 8, overread_in_bytes + 16);
   Square(s[0][0], sq_128[0]);
   Square(s[1][0], sq_128[1]);
-  BoxFilterPreProcessLo(s, scales, sum3, sum5, square_sum3, square_sum5, sq_128,
-                        ma3_128, b3_128, &ma5_128[0], b5_128);
+  BoxFilterPreProcessLo<bitdepth>(s, scales, sum3, sum5, square_sum3,
+                                  square_sum5, sq_128, ma3_128, b3_128,
+                                  &ma5_128[0], b5_128);
   sq[0][0] = SetrM128i(sq_128[0][2], sq_128[0][2]);
   sq[0][1] = SetrM128i(sq_128[0][3], sq_128[0][3]);
   sq[1][0] = SetrM128i(sq_128[1][2], sq_128[1][2]);
@@ -2309,7 +2598,7 @@ inline void BoxSumFilterPreProcess(
   int x = 0;
   do {
     __m256i ma[2], b[4], ma3x[3], ma5x[3];
-    BoxFilterPreProcess(
+    BoxFilterPreProcess<bitdepth>(
         src0 + x + 8, src1 + x + 8,
         kOverreadInBytesPass1_256 + sizeof(*src0) * (x + 8 - width), x + 8,
         scales, sum3, sum5, square_sum3, square_sum5, sum_width, sq, ma3, b3,
@@ -2366,33 +2655,34 @@ inline __m256i FilterOutput(const __m256i ma_x_src, const __m256i b) {
   return VrshrS32(v, kSgrProjSgrBits + shift - kSgrProjRestoreBits);
 }
 
+// The output is kept in 32 bits. It needs 15 bits for 10 bit pixels and is
+// packed by the multipliers, but up to 17 bits for 12 bit pixels.
 template <int shift>
-inline __m256i CalculateFilteredOutput(const __m256i src, const __m256i ma,
-                                       const __m256i b[2]) {
+inline void CalculateFilteredOutput(const __m256i src, const __m256i ma,
+                                    const __m256i b[2], __m256i dst[2]) {
   const __m256i ma_x_src_lo = VmullLo16(ma, src);
   const __m256i ma_x_src_hi = VmullHi16(ma, src);
-  const __m256i dst_lo = FilterOutput<shift>(ma_x_src_lo, b[0]);
-  const __m256i dst_hi = FilterOutput<shift>(ma_x_src_hi, b[1]);
-  return _mm256_packs_epi32(dst_lo, dst_hi);  // 13 bits
+  dst[0] = FilterOutput<shift>(ma_x_src_lo, b[0]);
+  dst[1] = FilterOutput<shift>(ma_x_src_hi, b[1]);
 }
 
-inline __m256i CalculateFilteredOutputPass1(const __m256i src,
-                                            const __m256i ma[2],
-                                            const __m256i b[2][2]) {
+inline void CalculateFilteredOutputPass1(const __m256i src, const __m256i ma[2],
+                                         const __m256i b[2][2],
+                                         __m256i dst[2]) {
   const __m256i ma_sum = _mm256_add_epi16(ma[0], ma[1]);
   __m256i b_sum[2];
   b_sum[0] = _mm256_add_epi32(b[0][0], b[1][0]);
   b_sum[1] = _mm256_add_epi32(b[0][1], b[1][1]);
-  return CalculateFilteredOutput<5>(src, ma_sum, b_sum);
+  CalculateFilteredOutput<5>(src, ma_sum, b_sum, dst);
 }
 
-inline __m256i CalculateFilteredOutputPass2(const __m256i src,
-                                            const __m256i ma[3],
-                                            const __m256i b[3][2]) {
+inline void CalculateFilteredOutputPass2(const __m256i src, const __m256i ma[3],
+                                         const __m256i b[3][2],
+                                         __m256i dst[2]) {
   const __m256i ma_sum = Sum3_16(ma);
   __m256i b_sum[2];
   Sum3_32(b, b_sum);
-  return CalculateFilteredOutput<5>(src, ma_sum, b_sum);
+  CalculateFilteredOutput<5>(src, ma_sum, b_sum, dst);
 }
 
 inline __m256i SelfGuidedFinal(const __m256i src, const __m256i v[2]) {
@@ -2404,34 +2694,57 @@ inline __m256i SelfGuidedFinal(const __m256i src, const __m256i v[2]) {
   return _mm256_add_epi16(src, vv);
 }
 
+template <int bitdepth>
 inline __m256i SelfGuidedDoubleMultiplier(const __m256i src,
-                                          const __m256i filter[2], const int w0,
-                                          const int w2) {
+                                          const __m256i filter[2][2],
+                                          const int w0, const int w2) {
   __m256i v[2];
+  if (bitdepth == kBitdepth12) {
+    const __m256i w0_32 = _mm256_set1_epi32(w0);
+    const __m256i w2_32 = _mm256_set1_epi32(w2);
+    v[0] = _mm256_add_epi32(_mm256_mullo_epi32(w0_32, filter[0][0]),
+                            _mm256_mullo_epi32(w2_32, filter[1][0]));
+    v[1] = _mm256_add_epi32(_mm256_mullo_epi32(w0_32, filter[0][1]),
+                            _mm256_mullo_epi32(w2_32, filter[1][1]));
+    return SelfGuidedFinal(src, v);
+  }
   const __m256i w0_w2 =
       _mm256_set1_epi32((w2 << 16) | static_cast<uint16_t>(w0));
-  const __m256i f_lo = _mm256_unpacklo_epi16(filter[0], filter[1]);
-  const __m256i f_hi = _mm256_unpackhi_epi16(filter[0], filter[1]);
+  const __m256i f0 = _mm256_packs_epi32(filter[0][0], filter[0][1]);
+  const __m256i f1 = _mm256_packs_epi32(filter[1][0], filter[1][1]);
+  const __m256i f_lo = _mm256_unpacklo_epi16(f0, f1);
+  const __m256i f_hi = _mm256_unpackhi_epi16(f0, f1);
   v[0] = _mm256_madd_epi16(w0_w2, f_lo);
   v[1] = _mm256_madd_epi16(w0_w2, f_hi);
   return SelfGuidedFinal(src, v);
 }
 
+template <int bitdepth>
 inline __m256i SelfGuidedSingleMultiplier(const __m256i src,
-                                          const __m256i filter, const int w0) {
+                                          const __m256i filter[2],
+                                          const int w0) {
   // weight: -96 to 96 (Sgrproj_Xqd_Min/Max)
   __m256i v[2];
-  v[0] = VmullNLo8(filter, w0);
-  v[1] = VmullNHi8(filter, w0);
+  if (bitdepth == kBitdepth12) {
+    v[0] = _mm256_mullo_epi32(filter[0], _mm256_set1_epi32(w0));
+    v[1] = _mm256_mullo_epi32(filter[1], _mm256_set1_epi32(w0));
+    return SelfGuidedFinal(src, v);
+  }
+  const __m256i f = _mm256_packs_epi32(filter[0], filter[1]);
+  v[0] = VmullNLo8(f, w0);
+  v[1] = VmullNHi8(f, w0);
   return SelfGuidedFinal(src, v);
 }
 
+template <int bitdepth>
 inline void ClipAndStore(uint16_t* const dst, const __m256i val) {
   const __m256i val0 = _mm256_max_epi16(val, _mm256_setzero_si256());
-  const __m256i val1 = _mm256_min_epi16(val0, _mm256_set1_epi16(1023));
+  const __m256i val1 =
+      _mm256_min_epi16(val0, _mm256_set1_epi16((1 << bitdepth) - 1));
   StoreUnaligned32(dst, val1);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
     const uint16_t* const src, const uint16_t* const src0,
     const uint16_t* const src1, const ptrdiff_t stride, uint16_t* const sum5[5],
@@ -2448,7 +2761,8 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
   s[1][1] = LoadUnaligned16Msan(src1 + 8, overread_in_bytes + 16);
   Square(s[0][0], sq_128[0]);
   Square(s[1][0], sq_128[1]);
-  BoxFilterPreProcess5Lo(s, scale, sum5, square_sum5, sq_128, &ma0, b0);
+  BoxFilterPreProcess5Lo<bitdepth>(s, scale, sum5, square_sum5, sq_128, &ma0,
+                                   b0);
   sq[0][0] = SetrM128i(sq_128[0][2], sq_128[0][2]);
   sq[0][1] = SetrM128i(sq_128[0][3], sq_128[0][3]);
   sq[1][0] = SetrM128i(sq_128[1][2], sq_128[1][2]);
@@ -2460,7 +2774,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
   int x = 0;
   do {
     __m256i ma5[3], ma[4], b[4][2];
-    BoxFilterPreProcess5(
+    BoxFilterPreProcess5<bitdepth>(
         src0 + x + 8, src1 + x + 8,
         kOverreadInBytesPass1_256 + sizeof(*src0) * (x + 8 - width), sum_width,
         x + 8, scale, sum5, square_sum5, sq, mas, bs);
@@ -2478,23 +2792,27 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
     const __m256i sr0_lo = LoadUnaligned32(src + x + 0);
     ma[0] = LoadAligned32(ma565[0] + x);
     LoadAligned64(b565[0] + x, b[0]);
-    const __m256i p0 = CalculateFilteredOutputPass1(sr0_lo, ma, b);
-    const __m256i d0 = SelfGuidedSingleMultiplier(sr0_lo, p0, w0);
-    ClipAndStore(dst + x + 0, d0);
+    __m256i p0[2];
+    CalculateFilteredOutputPass1(sr0_lo, ma, b, p0);
+    const __m256i d0 = SelfGuidedSingleMultiplier<bitdepth>(sr0_lo, p0, w0);
+    ClipAndStore<bitdepth>(dst + x + 0, d0);
     const __m256i sr0_hi = LoadUnaligned32(src + x + 16);
     ma[2] = LoadAligned32(ma565[0] + x + 16);
     LoadAligned64(b565[0] + x + 16, b[2]);
-    const __m256i p1 = CalculateFilteredOutputPass1(sr0_hi, ma + 2, b + 2);
-    const __m256i d1 = SelfGuidedSingleMultiplier(sr0_hi, p1, w0);
-    ClipAndStore(dst + x + 16, d1);
+    __m256i p1[2];
+    CalculateFilteredOutputPass1(sr0_hi, ma + 2, b + 2, p1);
+    const __m256i d1 = SelfGuidedSingleMultiplier<bitdepth>(sr0_hi, p1, w0);
+    ClipAndStore<bitdepth>(dst + x + 16, d1);
     const __m256i sr1_lo = LoadUnaligned32(src + stride + x + 0);
-    const __m256i p10 = CalculateFilteredOutput<4>(sr1_lo, ma[1], b[1]);
-    const __m256i d10 = SelfGuidedSingleMultiplier(sr1_lo, p10, w0);
-    ClipAndStore(dst + stride + x + 0, d10);
+    __m256i p10[2];
+    CalculateFilteredOutput<4>(sr1_lo, ma[1], b[1], p10);
+    const __m256i d10 = SelfGuidedSingleMultiplier<bitdepth>(sr1_lo, p10, w0);
+    ClipAndStore<bitdepth>(dst + stride + x + 0, d10);
     const __m256i sr1_hi = LoadUnaligned32(src + stride + x + 16);
-    const __m256i p11 = CalculateFilteredOutput<4>(sr1_hi, ma[3], b[3]);
-    const __m256i d11 = SelfGuidedSingleMultiplier(sr1_hi, p11, w0);
-    ClipAndStore(dst + stride + x + 16, d11);
+    __m256i p11[2];
+    CalculateFilteredOutput<4>(sr1_hi, ma[3], b[3], p11);
+    const __m256i d11 = SelfGuidedSingleMultiplier<bitdepth>(sr1_hi, p11, w0);
+    ClipAndStore<bitdepth>(dst + stride + x + 16, d11);
     sq[0][0] = sq[0][6];
     sq[0][1] = sq[0][7];
     sq[1][0] = sq[1][6];
@@ -2506,6 +2824,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
   } while (x < width);
 }
 
+template <int bitdepth>
 inline void BoxFilterPass1LastRow(
     const uint16_t* const src, const uint16_t* const src0, const int width,
     const ptrdiff_t sum_width, const uint32_t scale, const int16_t w0,
@@ -2518,8 +2837,8 @@ inline void BoxFilterPass1LastRow(
   s[0] = LoadUnaligned16Msan(src0 + 0, overread_in_bytes + 0);
   s[1] = LoadUnaligned16Msan(src0 + 8, overread_in_bytes + 16);
   Square(s[0], sq_128);
-  BoxFilterPreProcess5LastRowLo(s, scale, sum5, square_sum5, sq_128, &ma0[0],
-                                b0);
+  BoxFilterPreProcess5LastRowLo<bitdepth>(s, scale, sum5, square_sum5, sq_128,
+                                          &ma0[0], b0);
   sq[0] = SetrM128i(sq_128[2], sq_128[2]);
   sq[1] = SetrM128i(sq_128[3], sq_128[3]);
   mas[0] = SetrM128i(ma0[0], ma0[0]);
@@ -2529,7 +2848,7 @@ inline void BoxFilterPass1LastRow(
   int x = 0;
   do {
     __m256i ma5[3], ma[4], b[4][2];
-    BoxFilterPreProcess5LastRow(
+    BoxFilterPreProcess5LastRow<bitdepth>(
         src0 + x + 8,
         kOverreadInBytesPass1_256 + sizeof(*src0) * (x + 8 - width), sum_width,
         x + 8, scale, sum5, square_sum5, sq, mas, bs);
@@ -2542,16 +2861,18 @@ inline void BoxFilterPass1LastRow(
     ma[0] = LoadAligned32(ma565 + x);
     ma[1] = _mm256_permute2x128_si256(ma[2], ma[3], 0x20);
     LoadAligned64(b565 + x, b[0]);
-    const __m256i p0 = CalculateFilteredOutputPass1(sr0_lo, ma, b);
-    const __m256i d0 = SelfGuidedSingleMultiplier(sr0_lo, p0, w0);
-    ClipAndStore(dst + x + 0, d0);
+    __m256i p0[2];
+    CalculateFilteredOutputPass1(sr0_lo, ma, b, p0);
+    const __m256i d0 = SelfGuidedSingleMultiplier<bitdepth>(sr0_lo, p0, w0);
+    ClipAndStore<bitdepth>(dst + x + 0, d0);
     const __m256i sr0_hi = LoadUnaligned32(src + x + 16);
     ma[0] = LoadAligned32(ma565 + x + 16);
     ma[1] = _mm256_permute2x128_si256(ma[2], ma[3], 0x31);
     LoadAligned64(b565 + x + 16, b[2]);
-    const __m256i p1 = CalculateFilteredOutputPass1(sr0_hi, ma, b + 2);
-    const __m256i d1 = SelfGuidedSingleMultiplier(sr0_hi, p1, w0);
-    ClipAndStore(dst + x + 16, d1);
+    __m256i p1[2];
+    CalculateFilteredOutputPass1(sr0_hi, ma, b + 2, p1);
+    const __m256i d1 = SelfGuidedSingleMultiplier<bitdepth>(sr0_hi, p1, w0);
+    ClipAndStore<bitdepth>(dst + x + 16, d1);
     sq[0] = sq[6];
     sq[1] = sq[7];
     mas[0] = mas[2];
@@ -2561,6 +2882,7 @@ inline void BoxFilterPass1LastRow(
   } while (x < width);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
     const uint16_t* const src, const uint16_t* const src0, const int width,
     const ptrdiff_t sum_width, const uint32_t scale, const int16_t w0,
@@ -2574,7 +2896,8 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
   s0[0] = LoadUnaligned16Msan(src0 + 0, overread_in_bytes_128 + 0);
   s0[1] = LoadUnaligned16Msan(src0 + 8, overread_in_bytes_128 + 16);
   Square(s0[0], sq_128);
-  BoxFilterPreProcess3Lo(s0, scale, sum3, square_sum3, sq_128, &ma0, b0);
+  BoxFilterPreProcess3Lo<bitdepth>(s0, scale, sum3, square_sum3, sq_128, &ma0,
+                                   b0);
   sq[0] = SetrM128i(sq_128[2], sq_128[2]);
   sq[1] = SetrM128i(sq_128[3], sq_128[3]);
   mas[0] = SetrM128i(ma0, ma0);
@@ -2584,7 +2907,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
   int x = 0;
   do {
     __m256i ma[4], b[4][2], ma3[3];
-    BoxFilterPreProcess3(
+    BoxFilterPreProcess3<bitdepth>(
         src0 + x + 8,
         kOverreadInBytesPass2_256 + sizeof(*src0) * (x + 8 - width), x + 8,
         sum_width, scale, sum3, square_sum3, sq, mas, bs);
@@ -2597,16 +2920,18 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
     ma[1] = LoadAligned32(ma444[0] + x);
     LoadAligned64(b343[0] + x, b[0]);
     LoadAligned64(b444[0] + x, b[1]);
-    const __m256i p0 = CalculateFilteredOutputPass2(sr_lo, ma, b);
+    __m256i p0[2];
+    CalculateFilteredOutputPass2(sr_lo, ma, b, p0);
     ma[1] = LoadAligned32(ma343[0] + x + 16);
     ma[2] = LoadAligned32(ma444[0] + x + 16);
     LoadAligned64(b343[0] + x + 16, b[1]);
     LoadAligned64(b444[0] + x + 16, b[2]);
-    const __m256i p1 = CalculateFilteredOutputPass2(sr_hi, ma + 1, b + 1);
-    const __m256i d0 = SelfGuidedSingleMultiplier(sr_lo, p0, w0);
-    const __m256i d1 = SelfGuidedSingleMultiplier(sr_hi, p1, w0);
-    ClipAndStore(dst + x + 0, d0);
-    ClipAndStore(dst + x + 16, d1);
+    __m256i p1[2];
+    CalculateFilteredOutputPass2(sr_hi, ma + 1, b + 1, p1);
+    const __m256i d0 = SelfGuidedSingleMultiplier<bitdepth>(sr_lo, p0, w0);
+    const __m256i d1 = SelfGuidedSingleMultiplier<bitdepth>(sr_hi, p1, w0);
+    ClipAndStore<bitdepth>(dst + x + 0, d0);
+    ClipAndStore<bitdepth>(dst + x + 16, d1);
     sq[0] = sq[6];
     sq[1] = sq[7];
     mas[0] = mas[2];
@@ -2616,6 +2941,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
   } while (x < width);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilter(
     const uint16_t* const src, const uint16_t* const src0,
     const uint16_t* const src1, const ptrdiff_t stride, const int width,
@@ -2635,8 +2961,9 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
   s[1][1] = LoadUnaligned16Msan(src1 + 8, overread_in_bytes + 16);
   Square(s[0][0], sq_128[0]);
   Square(s[1][0], sq_128[1]);
-  BoxFilterPreProcessLo(s, scales, sum3, sum5, square_sum3, square_sum5, sq_128,
-                        ma3_128, b3_128, &ma5_0, b5_128);
+  BoxFilterPreProcessLo<bitdepth>(s, scales, sum3, sum5, square_sum3,
+                                  square_sum5, sq_128, ma3_128, b3_128, &ma5_0,
+                                  b5_128);
   sq[0][0] = SetrM128i(sq_128[0][2], sq_128[0][2]);
   sq[0][1] = SetrM128i(sq_128[0][3], sq_128[0][3]);
   sq[1][0] = SetrM128i(sq_128[1][2], sq_128[1][2]);
@@ -2653,9 +2980,9 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
 
   int x = 0;
   do {
-    __m256i ma[3][4], mat[3][3], b[3][3][2], bt[3][3][2], p[2][2], ma3x[2][3],
-        ma5x[3];
-    BoxFilterPreProcess(
+    __m256i ma[3][4], mat[3][3], b[3][3][2], bt[3][3][2], p[2][2][2],
+        ma3x[2][3], ma5x[3];
+    BoxFilterPreProcess<bitdepth>(
         src0 + x + 8, src1 + x + 8,
         kOverreadInBytesPass1_256 + sizeof(*src0) * (x + 8 - width), x + 8,
         scales, sum3, sum5, square_sum3, square_sum5, sum_width, sq, ma3, b3,
@@ -2681,8 +3008,8 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
     const __m256i sr1_lo = LoadUnaligned32(src + stride + x);
     ma[0][0] = LoadAligned32(ma565[0] + x);
     LoadAligned64(b565[0] + x, b[0][0]);
-    p[0][0] = CalculateFilteredOutputPass1(sr0_lo, ma[0], b[0]);
-    p[1][0] = CalculateFilteredOutput<4>(sr1_lo, ma[0][1], b[0][1]);
+    CalculateFilteredOutputPass1(sr0_lo, ma[0], b[0], p[0][0]);
+    CalculateFilteredOutput<4>(sr1_lo, ma[0][1], b[0][1], p[1][0]);
     ma[1][0] = LoadAligned32(ma343[0] + x);
     ma[1][1] = LoadAligned32(ma444[0] + x);
     // Keeping the following 4 redundant lines is faster. The reason is that
@@ -2691,15 +3018,17 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
     ma[1][2] = LoadAligned32(ma343[2] + x);  // Redundant line 1.
     LoadAligned64(b343[0] + x, b[1][0]);
     LoadAligned64(b444[0] + x, b[1][1]);
-    p[0][1] = CalculateFilteredOutputPass2(sr0_lo, ma[1], b[1]);
+    CalculateFilteredOutputPass2(sr0_lo, ma[1], b[1], p[0][1]);
     ma[2][0] = LoadAligned32(ma343[1] + x);
     ma[2][1] = LoadAligned32(ma444[1] + x);  // Redundant line 2.
     LoadAligned64(b343[1] + x, b[2][0]);
-    p[1][1] = CalculateFilteredOutputPass2(sr1_lo, ma[2], b[2]);
-    const __m256i d00 = SelfGuidedDoubleMultiplier(sr0_lo, p[0], w0, w2);
-    ClipAndStore(dst + x, d00);
-    const __m256i d10x = SelfGuidedDoubleMultiplier(sr1_lo, p[1], w0, w2);
-    ClipAndStore(dst + stride + x, d10x);
+    CalculateFilteredOutputPass2(sr1_lo, ma[2], b[2], p[1][1]);
+    const __m256i d00 =
+        SelfGuidedDoubleMultiplier<bitdepth>(sr0_lo, p[0], w0, w2);
+    ClipAndStore<bitdepth>(dst + x, d00);
+    const __m256i d10x =
+        SelfGuidedDoubleMultiplier<bitdepth>(sr1_lo, p[1], w0, w2);
+    ClipAndStore<bitdepth>(dst + stride + x, d10x);
 
     Sum565(b5 + 3, bt[0][1]);
     StoreAligned64(b565[1] + x + 16, bt[0][1]);
@@ -2707,22 +3036,24 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
     const __m256i sr1_hi = LoadUnaligned32(src + stride + x + 16);
     ma[0][2] = LoadAligned32(ma565[0] + x + 16);
     LoadAligned64(b565[0] + x + 16, bt[0][0]);
-    p[0][0] = CalculateFilteredOutputPass1(sr0_hi, ma[0] + 2, bt[0]);
-    p[1][0] = CalculateFilteredOutput<4>(sr1_hi, ma[0][3], bt[0][1]);
+    CalculateFilteredOutputPass1(sr0_hi, ma[0] + 2, bt[0], p[0][0]);
+    CalculateFilteredOutput<4>(sr1_hi, ma[0][3], bt[0][1], p[1][0]);
     mat[1][0] = LoadAligned32(ma343[0] + x + 16);
     mat[1][1] = LoadAligned32(ma444[0] + x + 16);
     mat[1][2] = LoadAligned32(ma343[2] + x + 16);  // Redundant line 3.
     LoadAligned64(b343[0] + x + 16, bt[1][0]);
     LoadAligned64(b444[0] + x + 16, bt[1][1]);
-    p[0][1] = CalculateFilteredOutputPass2(sr0_hi, mat[1], bt[1]);
+    CalculateFilteredOutputPass2(sr0_hi, mat[1], bt[1], p[0][1]);
     mat[2][0] = LoadAligned32(ma343[1] + x + 16);
     mat[2][1] = LoadAligned32(ma444[1] + x + 16);  // Redundant line 4.
     LoadAligned64(b343[1] + x + 16, bt[2][0]);
-    p[1][1] = CalculateFilteredOutputPass2(sr1_hi, mat[2], bt[2]);
-    const __m256i d01 = SelfGuidedDoubleMultiplier(sr0_hi, p[0], w0, w2);
-    ClipAndStore(dst + x + 16, d01);
-    const __m256i d11 = SelfGuidedDoubleMultiplier(sr1_hi, p[1], w0, w2);
-    ClipAndStore(dst + stride + x + 16, d11);
+    CalculateFilteredOutputPass2(sr1_hi, mat[2], bt[2], p[1][1]);
+    const __m256i d01 =
+        SelfGuidedDoubleMultiplier<bitdepth>(sr0_hi, p[0], w0, w2);
+    ClipAndStore<bitdepth>(dst + x + 16, d01);
+    const __m256i d11 =
+        SelfGuidedDoubleMultiplier<bitdepth>(sr1_hi, p[1], w0, w2);
+    ClipAndStore<bitdepth>(dst + stride + x + 16, d11);
 
     sq[0][0] = sq[0][6];
     sq[0][1] = sq[0][7];
@@ -2741,6 +3072,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
   } while (x < width);
 }
 
+template <int bitdepth>
 inline void BoxFilterLastRow(
     const uint16_t* const src, const uint16_t* const src0, const int width,
     const ptrdiff_t sum_width, const uint16_t scales[2], const int16_t w0,
@@ -2756,8 +3088,9 @@ inline void BoxFilterLastRow(
   s[0] = LoadUnaligned16Msan(src0 + 0, overread_in_bytes + 0);
   s[1] = LoadUnaligned16Msan(src0 + 8, overread_in_bytes + 16);
   Square(s[0], sq_128);
-  BoxFilterPreProcessLastRowLo(s, scales, sum3, sum5, square_sum3, square_sum5,
-                               sq_128, &ma3_0, &ma5_0, b3_128, b5_128);
+  BoxFilterPreProcessLastRowLo<bitdepth>(s, scales, sum3, sum5, square_sum3,
+                                         square_sum5, sq_128, &ma3_0, &ma5_0,
+                                         b3_128, b5_128);
   sq[0] = SetrM128i(sq_128[2], sq_128[2]);
   sq[1] = SetrM128i(sq_128[3], sq_128[3]);
   ma3[0] = SetrM128i(ma3_0, ma3_0);
@@ -2769,8 +3102,8 @@ inline void BoxFilterLastRow(
 
   int x = 0;
   do {
-    __m256i ma[4], mat[4], b[3][2], bt[3][2], ma3x[3], ma5x[3], p[2];
-    BoxFilterPreProcessLastRow(
+    __m256i ma[4], mat[4], b[3][2], bt[3][2], ma3x[3], ma5x[3], p[2][2];
+    BoxFilterPreProcessLastRow<bitdepth>(
         src0 + x + 8,
         kOverreadInBytesPass1_256 + sizeof(*src0) * (x + 8 - width), sum_width,
         x + 8, scales, sum3, sum5, square_sum3, square_sum5, sq, ma3, ma5, b3,
@@ -2791,28 +3124,28 @@ inline void BoxFilterLastRow(
     ma[1] = _mm256_permute2x128_si256(ma[2], mat[1], 0x20);
     mat[1] = _mm256_permute2x128_si256(ma[2], mat[1], 0x31);
     LoadAligned64(b565 + x, b[0]);
-    p[0] = CalculateFilteredOutputPass1(sr_lo, ma, b);
+    CalculateFilteredOutputPass1(sr_lo, ma, b, p[0]);
     ma[0] = LoadAligned32(ma343 + x);
     ma[1] = LoadAligned32(ma444 + x);
     ma[2] = _mm256_permute2x128_si256(ma[3], mat[2], 0x20);
     LoadAligned64(b343 + x, b[0]);
     LoadAligned64(b444 + x, b[1]);
-    p[1] = CalculateFilteredOutputPass2(sr_lo, ma, b);
-    const __m256i d0 = SelfGuidedDoubleMultiplier(sr_lo, p, w0, w2);
+    CalculateFilteredOutputPass2(sr_lo, ma, b, p[1]);
+    const __m256i d0 = SelfGuidedDoubleMultiplier<bitdepth>(sr_lo, p, w0, w2);
 
     const __m256i sr_hi = LoadUnaligned32(src + x + 16);
     mat[0] = LoadAligned32(ma565 + x + 16);
     LoadAligned64(b565 + x + 16, bt[0]);
-    p[0] = CalculateFilteredOutputPass1(sr_hi, mat, bt);
+    CalculateFilteredOutputPass1(sr_hi, mat, bt, p[0]);
     mat[0] = LoadAligned32(ma343 + x + 16);
     mat[1] = LoadAligned32(ma444 + x + 16);
     mat[2] = _mm256_permute2x128_si256(ma[3], mat[2], 0x31);
     LoadAligned64(b343 + x + 16, bt[0]);
     LoadAligned64(b444 + x + 16, bt[1]);
-    p[1] = CalculateFilteredOutputPass2(sr_hi, mat, bt);
-    const __m256i d1 = SelfGuidedDoubleMultiplier(sr_hi, p, w0, w2);
-    ClipAndStore(dst + x + 0, d0);
-    ClipAndStore(dst + x + 16, d1);
+    CalculateFilteredOutputPass2(sr_hi, mat, bt, p[1]);
+    const __m256i d1 = SelfGuidedDoubleMultiplier<bitdepth>(sr_hi, p, w0, w2);
+    ClipAndStore<bitdepth>(dst + x + 0, d0);
+    ClipAndStore<bitdepth>(dst + x + 16, d1);
 
     sq[0] = sq[6];
     sq[1] = sq[7];
@@ -2826,6 +3159,7 @@ inline void BoxFilterLastRow(
   } while (x < width);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterProcess(
     const RestorationUnitInfo& restoration_info, const uint16_t* src,
     const ptrdiff_t stride, const uint16_t* const top_border,
@@ -2875,9 +3209,9 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterProcess(
   sum5[0] = sum5[1];
   square_sum5[0] = square_sum5[1];
   const uint16_t* const s = (height > 1) ? src + stride : bottom_border;
-  BoxSumFilterPreProcess(src, s, width, scales, sum3, sum5, square_sum3,
-                         square_sum5, sum_width, ma343, ma444[0], ma565[0],
-                         b343, b444[0], b565[0]);
+  BoxSumFilterPreProcess<bitdepth>(src, s, width, scales, sum3, sum5,
+                                   square_sum3, square_sum5, sum_width, ma343,
+                                   ma444[0], ma565[0], b343, b444[0], b565[0]);
   sum5[0] = sgr_buffer->sum5 + kSumOffset;
   square_sum5[0] = sgr_buffer->square_sum5 + kSumOffset;
 
@@ -2886,9 +3220,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterProcess(
     Circulate4PointersBy2<uint32_t>(square_sum3);
     Circulate5PointersBy2<uint16_t>(sum5);
     Circulate5PointersBy2<uint32_t>(square_sum5);
-    BoxFilter(src + 3, src + 2 * stride, src + 3 * stride, stride, width,
-              scales, w0, w2, sum3, sum5, square_sum3, square_sum5, sum_width,
-              ma343, ma444, ma565, b343, b444, b565, dst);
+    BoxFilter<bitdepth>(src + 3, src + 2 * stride, src + 3 * stride, stride,
+                        width, scales, w0, w2, sum3, sum5, square_sum3,
+                        square_sum5, sum_width, ma343, ma444, ma565, b343, b444,
+                        b565, dst);
     src += 2 * stride;
     dst += 2 * stride;
     Circulate4PointersBy2<uint16_t>(ma343);
@@ -2912,9 +3247,9 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterProcess(
       sr[0] = src + 2 * stride;
       sr[1] = bottom_border;
     }
-    BoxFilter(src + 3, sr[0], sr[1], stride, width, scales, w0, w2, sum3, sum5,
-              square_sum3, square_sum5, sum_width, ma343, ma444, ma565, b343,
-              b444, b565, dst);
+    BoxFilter<bitdepth>(src + 3, sr[0], sr[1], stride, width, scales, w0, w2,
+                        sum3, sum5, square_sum3, square_sum5, sum_width, ma343,
+                        ma444, ma565, b343, b444, b565, dst);
   }
   if ((height & 1) != 0) {
     if (height > 1) {
@@ -2931,13 +3266,14 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterProcess(
       std::swap(ma565[0], ma565[1]);
       std::swap(b565[0], b565[1]);
     }
-    BoxFilterLastRow(src + 3, bottom_border + bottom_border_stride, width,
-                     sum_width, scales, w0, w2, sum3, sum5, square_sum3,
-                     square_sum5, ma343[0], ma444[0], ma565[0], b343[0],
-                     b444[0], b565[0], dst);
+    BoxFilterLastRow<bitdepth>(src + 3, bottom_border + bottom_border_stride,
+                               width, sum_width, scales, w0, w2, sum3, sum5,
+                               square_sum3, square_sum5, ma343[0], ma444[0],
+                               ma565[0], b343[0], b444[0], b565[0], dst);
   }
 }
 
+template <int bitdepth>
 inline void BoxFilterProcessPass1(const RestorationUnitInfo& restoration_info,
                                   const uint16_t* src, const ptrdiff_t stride,
                                   const uint16_t* const top_border,
@@ -2970,16 +3306,17 @@ inline void BoxFilterProcessPass1(const RestorationUnitInfo& restoration_info,
   sum5[0] = sum5[1];
   square_sum5[0] = square_sum5[1];
   const uint16_t* const s = (height > 1) ? src + stride : bottom_border;
-  BoxSumFilterPreProcess5(src, s, width, scale, sum5, square_sum5, sum_width,
-                          ma565[0], b565[0]);
+  BoxSumFilterPreProcess5<bitdepth>(src, s, width, scale, sum5, square_sum5,
+                                    sum_width, ma565[0], b565[0]);
   sum5[0] = sgr_buffer->sum5 + kSumOffset;
   square_sum5[0] = sgr_buffer->square_sum5 + kSumOffset;
 
   for (int y = (height >> 1) - 1; y > 0; --y) {
     Circulate5PointersBy2<uint16_t>(sum5);
     Circulate5PointersBy2<uint32_t>(square_sum5);
-    BoxFilterPass1(src + 3, src + 2 * stride, src + 3 * stride, stride, sum5,
-                   square_sum5, width, sum_width, scale, w0, ma565, b565, dst);
+    BoxFilterPass1<bitdepth>(src + 3, src + 2 * stride, src + 3 * stride,
+                             stride, sum5, square_sum5, width, sum_width, scale,
+                             w0, ma565, b565, dst);
     src += 2 * stride;
     dst += 2 * stride;
     std::swap(ma565[0], ma565[1]);
@@ -2997,8 +3334,8 @@ inline void BoxFilterProcessPass1(const RestorationUnitInfo& restoration_info,
       sr[0] = src + 2 * stride;
       sr[1] = bottom_border;
     }
-    BoxFilterPass1(src + 3, sr[0], sr[1], stride, sum5, square_sum5, width,
-                   sum_width, scale, w0, ma565, b565, dst);
+    BoxFilterPass1<bitdepth>(src + 3, sr[0], sr[1], stride, sum5, square_sum5,
+                             width, sum_width, scale, w0, ma565, b565, dst);
   }
   if ((height & 1) != 0) {
     src += 3;
@@ -3010,12 +3347,13 @@ inline void BoxFilterProcessPass1(const RestorationUnitInfo& restoration_info,
       Circulate5PointersBy2<uint16_t>(sum5);
       Circulate5PointersBy2<uint32_t>(square_sum5);
     }
-    BoxFilterPass1LastRow(src, bottom_border + bottom_border_stride, width,
-                          sum_width, scale, w0, sum5, square_sum5, ma565[0],
-                          b565[0], dst);
+    BoxFilterPass1LastRow<bitdepth>(src, bottom_border + bottom_border_stride,
+                                    width, sum_width, scale, w0, sum5,
+                                    square_sum5, ma565[0], b565[0], dst);
   }
 }
 
+template <int bitdepth>
 inline void BoxFilterProcessPass2(const RestorationUnitInfo& restoration_info,
                                   const uint16_t* src, const ptrdiff_t stride,
                                   const uint16_t* const top_border,
@@ -3051,9 +3389,9 @@ inline void BoxFilterProcessPass2(const RestorationUnitInfo& restoration_info,
   assert(scale != 0);
   BoxSum<3>(top_border, top_border_stride, width, sum_stride, temp_stride,
             sum3[0], square_sum3[0]);
-  BoxSumFilterPreProcess3<false>(src, width, scale, sum3, square_sum3,
-                                 sum_width, ma343[0], nullptr, b343[0],
-                                 nullptr);
+  BoxSumFilterPreProcess3<bitdepth, false>(src, width, scale, sum3, square_sum3,
+                                           sum_width, ma343[0], nullptr,
+                                           b343[0], nullptr);
   Circulate3PointersBy1<uint16_t>(sum3);
   Circulate3PointersBy1<uint32_t>(square_sum3);
   const uint16_t* s;
@@ -3063,14 +3401,16 @@ inline void BoxFilterProcessPass2(const RestorationUnitInfo& restoration_info,
     s = bottom_border;
     bottom_border += bottom_border_stride;
   }
-  BoxSumFilterPreProcess3<true>(s, width, scale, sum3, square_sum3, sum_width,
-                                ma343[1], ma444[0], b343[1], b444[0]);
+  BoxSumFilterPreProcess3<bitdepth, true>(s, width, scale, sum3, square_sum3,
+                                          sum_width, ma343[1], ma444[0],
+                                          b343[1], b444[0]);
 
   for (int y = height - 2; y > 0; --y) {
     Circulate3PointersBy1<uint16_t>(sum3);
     Circulate3PointersBy1<uint32_t>(square_sum3);
-    BoxFilterPass2(src + 2, src + 2 * stride, width, sum_width, scale, w0, sum3,
-                   square_sum3, ma343, ma444, b343, b444, dst);
+    BoxFilterPass2<bitdepth>(src + 2, src + 2 * stride, width, sum_width, scale,
+                             w0, sum3, square_sum3, ma343, ma444, b343, b444,
+                             dst);
     src += stride;
     dst += stride;
     Circulate3PointersBy1<uint16_t>(ma343);
@@ -3084,8 +3424,8 @@ inline void BoxFilterProcessPass2(const RestorationUnitInfo& restoration_info,
   do {
     Circulate3PointersBy1<uint16_t>(sum3);
     Circulate3PointersBy1<uint32_t>(square_sum3);
-    BoxFilterPass2(src, bottom_border, width, sum_width, scale, w0, sum3,
-                   square_sum3, ma343, ma444, b343, b444, dst);
+    BoxFilterPass2<bitdepth>(src, bottom_border, width, sum_width, scale, w0,
+                             sum3, square_sum3, ma343, ma444, b343, b444, dst);
     src += stride;
     dst += stride;
     bottom_border += bottom_border_stride;
@@ -3099,6 +3439,7 @@ inline void BoxFilterProcessPass2(const RestorationUnitInfo& restoration_info,
 // If |width| is non-multiple of 32, up to 31 more pixels are written to |dest|
 // in the end of each row. It is safe to overwrite the output as it will not be
 // part of the visible frame.
+template <int bitdepth>
 void SelfGuidedFilter_AVX2(
     const RestorationUnitInfo& LIBGAV1_RESTRICT restoration_info,
     const void* LIBGAV1_RESTRICT const source, const ptrdiff_t stride,
@@ -3120,17 +3461,17 @@ void SelfGuidedFilter_AVX2(
     // |radius_pass_0| and |radius_pass_1| cannot both be 0, so we have the
     // following assertion.
     assert(radius_pass_0 != 0);
-    BoxFilterProcessPass1(restoration_info, src - 3, stride, top - 3,
-                          top_border_stride, bottom - 3, bottom_border_stride,
-                          width, height, sgr_buffer, dst);
+    BoxFilterProcessPass1<bitdepth>(
+        restoration_info, src - 3, stride, top - 3, top_border_stride,
+        bottom - 3, bottom_border_stride, width, height, sgr_buffer, dst);
   } else if (radius_pass_0 == 0) {
-    BoxFilterProcessPass2(restoration_info, src - 2, stride, top - 2,
-                          top_border_stride, bottom - 2, bottom_border_stride,
-                          width, height, sgr_buffer, dst);
+    BoxFilterProcessPass2<bitdepth>(
+        restoration_info, src - 2, stride, top - 2, top_border_stride,
+        bottom - 2, bottom_border_stride, width, height, sgr_buffer, dst);
   } else {
-    BoxFilterProcess(restoration_info, src - 3, stride, top - 3,
-                     top_border_stride, bottom - 3, bottom_border_stride, width,
-                     height, sgr_buffer, dst);
+    BoxFilterProcess<bitdepth>(
+        restoration_info, src - 3, stride, top - 3, top_border_stride,
+        bottom - 3, bottom_border_stride, width, height, sgr_buffer, dst);
   }
 }
 
@@ -3138,16 +3479,35 @@ void Init10bpp() {
   Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
   assert(dsp != nullptr);
 #if DSP_ENABLED_10BPP_AVX2(WienerFilter)
-  dsp->loop_restorations[0] = WienerFilter_AVX2;
+  dsp->loop_restorations[0] = WienerFilter_AVX2<kBitdepth10>;
 #endif
 #if DSP_ENABLED_10BPP_AVX2(SelfGuidedFilter)
-  dsp->loop_restorations[1] = SelfGuidedFilter_AVX2;
+  dsp->loop_restorations[1] = SelfGuidedFilter_AVX2<kBitdepth10>;
 #endif
 }
 
+#if LIBGAV1_MAX_BITDEPTH == 12
+void Init12bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth12);
+  assert(dsp != nullptr);
+  static_cast<void>(dsp);
+#if DSP_ENABLED_12BPP_AVX2(WienerFilter)
+  dsp->loop_restorations[0] = WienerFilter_AVX2<kBitdepth12>;
+#endif
+#if DSP_ENABLED_12BPP_AVX2(SelfGuidedFilter)
+  dsp->loop_restorations[1] = SelfGuidedFilter_AVX2<kBitdepth12>;
+#endif
+}
+#endif  // LIBGAV1_MAX_BITDEPTH == 12
+
 }  // namespace
 
-void LoopRestorationInit10bpp_AVX2() { Init10bpp(); }
+void LoopRestorationInit10bpp_AVX2() {
+  Init10bpp();
+#if LIBGAV1_MAX_BITDEPTH == 12
+  Init12bpp();
+#endif
+}
 
 }  // namespace dsp
 }  // namespace libgav1
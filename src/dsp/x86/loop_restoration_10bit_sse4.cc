@@ -35,24 +35,29 @@ namespace libgav1 {
 namespace dsp {
 namespace {
 
+template <int bitdepth>
 inline void WienerHorizontalClip(const __m128i s[2],
                                  int16_t* const wiener_buffer) {
+  constexpr int kRoundBitsHorizontal = (bitdepth == 12)
+                                           ? kInterRoundBitsHorizontal12bpp
+                                           : kInterRoundBitsHorizontal;
   constexpr int offset =
-      1 << (10 + kWienerFilterBits - kInterRoundBitsHorizontal - 1);
+      1 << (bitdepth + kWienerFilterBits - kRoundBitsHorizontal - 1);
   constexpr int limit = (offset << 2) - 1;
   const __m128i offsets = _mm_set1_epi16(-offset);
   const __m128i limits = _mm_set1_epi16(limit - offset);
-  const __m128i round = _mm_set1_epi32(1 << (kInterRoundBitsHorizontal - 1));
+  const __m128i round = _mm_set1_epi32(1 << (kRoundBitsHorizontal - 1));
   const __m128i sum0 = _mm_add_epi32(s[0], round);
   const __m128i sum1 = _mm_add_epi32(s[1], round);
-  const __m128i rounded_sum0 = _mm_srai_epi32(sum0, kInterRoundBitsHorizontal);
-  const __m128i rounded_sum1 = _mm_srai_epi32(sum1, kInterRoundBitsHorizontal);
+  const __m128i rounded_sum0 = _mm_srai_epi32(sum0, kRoundBitsHorizontal);
+  const __m128i rounded_sum1 = _mm_srai_epi32(sum1, kRoundBitsHorizontal);
   const __m128i rounded_sum = _mm_packs_epi32(rounded_sum0, rounded_sum1);
   const __m128i d0 = _mm_max_epi16(rounded_sum, offsets);
   const __m128i d1 = _mm_min_epi16(d0, limits);
   StoreAligned16(wiener_buffer, d1);
 }
 
+template <int bitdepth>
 inline void WienerHorizontalTap7(const uint16_t* src,
                                  const ptrdiff_t src_stride,
                                  const ptrdiff_t width, const int height,
@@ -85,7 +90,7 @@ inline void WienerHorizontalTap7(const uint16_t* src,
       madds[3] = _mm_madd_epi16(ss3, filter[1]);
       madds[0] = _mm_add_epi32(madds[0], madds[2]);
       madds[1] = _mm_add_epi32(madds[1], madds[3]);
-      WienerHorizontalClip(madds, *wiener_buffer + x);
+      WienerHorizontalClip<bitdepth>(madds, *wiener_buffer + x);
       x += 8;
     } while (x < width);
     src += src_stride;
@@ -93,6 +98,7 @@ inline void WienerHorizontalTap7(const uint16_t* src,
   }
 }
 
+template <int bitdepth>
 inline void WienerHorizontalTap5(const uint16_t* src,
                                  const ptrdiff_t src_stride,
                                  const ptrdiff_t width, const int height,
@@ -124,7 +130,7 @@ inline void WienerHorizontalTap5(const uint16_t* src,
       const __m128i s2x128_hi = _mm_slli_epi32(s2_hi, 7);
       madds[0] = _mm_add_epi32(madds[0], s2x128_lo);
       madds[1] = _mm_add_epi32(madds[1], s2x128_hi);
-      WienerHorizontalClip(madds, *wiener_buffer + x);
+      WienerHorizontalClip<bitdepth>(madds, *wiener_buffer + x);
       x += 8;
     } while (x < width);
     src += src_stride;
@@ -132,6 +138,7 @@ inline void WienerHorizontalTap5(const uint16_t* src,
   }
 }
 
+template <int bitdepth>
 inline void WienerHorizontalTap3(const uint16_t* src,
                                  const ptrdiff_t src_stride,
                                  const ptrdiff_t width, const int height,
@@ -150,7 +157,7 @@ inline void WienerHorizontalTap3(const uint16_t* src,
       const __m128i ss1 = _mm_unpackhi_epi16(s02, s[1]);
       madds[0] = _mm_madd_epi16(ss0, filter);
       madds[1] = _mm_madd_epi16(ss1, filter);
-      WienerHorizontalClip(madds, *wiener_buffer + x);
+      WienerHorizontalClip<bitdepth>(madds, *wiener_buffer + x);
       x += 8;
     } while (x < width);
     src += src_stride;
@@ -158,15 +165,20 @@ inline void WienerHorizontalTap3(const uint16_t* src,
   }
 }
 
+template <int bitdepth>
 inline void WienerHorizontalTap1(const uint16_t* src,
                                  const ptrdiff_t src_stride,
                                  const ptrdiff_t width, const int height,
                                  int16_t** const wiener_buffer) {
+  constexpr int kRoundBitsHorizontal = (bitdepth == 12)
+                                           ? kInterRoundBitsHorizontal12bpp
+                                           : kInterRoundBitsHorizontal;
+  constexpr int kShift = kWienerFilterBits - kRoundBitsHorizontal;
   for (int y = height; y != 0; --y) {
     ptrdiff_t x = 0;
     do {
       const __m128i s = LoadUnaligned16(src + x);
-      const __m128i d = _mm_slli_epi16(s, 4);
+      const __m128i d = _mm_slli_epi16(s, kShift);
       StoreAligned16(*wiener_buffer + x, d);
       x += 8;
     } while (x < width);
@@ -175,7 +187,10 @@ inline void WienerHorizontalTap1(const uint16_t* src,
   }
 }
 
+template <int bitdepth>
 inline __m128i WienerVertical7(const __m128i a[4], const __m128i filter[4]) {
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
   const __m128i madd0 = _mm_madd_epi16(a[0], filter[0]);
   const __m128i madd1 = _mm_madd_epi16(a[1], filter[1]);
   const __m128i madd2 = _mm_madd_epi16(a[2], filter[2]);
@@ -183,75 +198,92 @@ inline __m128i WienerVertical7(const __m128i a[4], const __m128i filter[4]) {
   const __m128i madd01 = _mm_add_epi32(madd0, madd1);
   const __m128i madd23 = _mm_add_epi32(madd2, madd3);
   const __m128i sum = _mm_add_epi32(madd01, madd23);
-  return _mm_srai_epi32(sum, kInterRoundBitsVertical);
+  return _mm_srai_epi32(sum, kRoundBitsVertical);
 }
 
+template <int bitdepth>
 inline __m128i WienerVertical5(const __m128i a[3], const __m128i filter[3]) {
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
   const __m128i madd0 = _mm_madd_epi16(a[0], filter[0]);
   const __m128i madd1 = _mm_madd_epi16(a[1], filter[1]);
   const __m128i madd2 = _mm_madd_epi16(a[2], filter[2]);
   const __m128i madd01 = _mm_add_epi32(madd0, madd1);
   const __m128i sum = _mm_add_epi32(madd01, madd2);
-  return _mm_srai_epi32(sum, kInterRoundBitsVertical);
+  return _mm_srai_epi32(sum, kRoundBitsVertical);
 }
 
+template <int bitdepth>
 inline __m128i WienerVertical3(const __m128i a[2], const __m128i filter[2]) {
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
   const __m128i madd0 = _mm_madd_epi16(a[0], filter[0]);
   const __m128i madd1 = _mm_madd_epi16(a[1], filter[1]);
   const __m128i sum = _mm_add_epi32(madd0, madd1);
-  return _mm_srai_epi32(sum, kInterRoundBitsVertical);
+  return _mm_srai_epi32(sum, kRoundBitsVertical);
 }
 
+template <int bitdepth>
 inline __m128i WienerVerticalClip(const __m128i s[2]) {
   const __m128i d = _mm_packus_epi32(s[0], s[1]);
-  return _mm_min_epu16(d, _mm_set1_epi16(1023));
+  return _mm_min_epu16(d, _mm_set1_epi16((1 << bitdepth) - 1));
 }
 
+template <int bitdepth>
 inline __m128i WienerVerticalFilter7(const __m128i a[7],
                                      const __m128i filter[2]) {
-  const __m128i round = _mm_set1_epi16(1 << (kInterRoundBitsVertical - 1));
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
+  const __m128i round = _mm_set1_epi16(1 << (kRoundBitsVertical - 1));
   __m128i b[4], c[2];
   b[0] = _mm_unpacklo_epi16(a[0], a[1]);
   b[1] = _mm_unpacklo_epi16(a[2], a[3]);
   b[2] = _mm_unpacklo_epi16(a[4], a[5]);
   b[3] = _mm_unpacklo_epi16(a[6], round);
-  c[0] = WienerVertical7(b, filter);
+  c[0] = WienerVertical7<bitdepth>(b, filter);
   b[0] = _mm_unpackhi_epi16(a[0], a[1]);
   b[1] = _mm_unpackhi_epi16(a[2], a[3]);
   b[2] = _mm_unpackhi_epi16(a[4], a[5]);
   b[3] = _mm_unpackhi_epi16(a[6], round);
-  c[1] = WienerVertical7(b, filter);
-  return WienerVerticalClip(c);
+  c[1] = WienerVertical7<bitdepth>(b, filter);
+  return WienerVerticalClip<bitdepth>(c);
 }
 
+template <int bitdepth>
 inline __m128i WienerVerticalFilter5(const __m128i a[5],
                                      const __m128i filter[3]) {
-  const __m128i round = _mm_set1_epi16(1 << (kInterRoundBitsVertical - 1));
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
+  const __m128i round = _mm_set1_epi16(1 << (kRoundBitsVertical - 1));
   __m128i b[3], c[2];
   b[0] = _mm_unpacklo_epi16(a[0], a[1]);
   b[1] = _mm_unpacklo_epi16(a[2], a[3]);
   b[2] = _mm_unpacklo_epi16(a[4], round);
-  c[0] = WienerVertical5(b, filter);
+  c[0] = WienerVertical5<bitdepth>(b, filter);
   b[0] = _mm_unpackhi_epi16(a[0], a[1]);
   b[1] = _mm_unpackhi_epi16(a[2], a[3]);
   b[2] = _mm_unpackhi_epi16(a[4], round);
-  c[1] = WienerVertical5(b, filter);
-  return WienerVerticalClip(c);
+  c[1] = WienerVertical5<bitdepth>(b, filter);
+  return WienerVerticalClip<bitdepth>(c);
 }
 
+template <int bitdepth>
 inline __m128i WienerVerticalFilter3(const __m128i a[3],
                                      const __m128i filter[2]) {
-  const __m128i round = _mm_set1_epi16(1 << (kInterRoundBitsVertical - 1));
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
+  const __m128i round = _mm_set1_epi16(1 << (kRoundBitsVertical - 1));
   __m128i b[2], c[2];
   b[0] = _mm_unpacklo_epi16(a[0], a[1]);
   b[1] = _mm_unpacklo_epi16(a[2], round);
-  c[0] = WienerVertical3(b, filter);
+  c[0] = WienerVertical3<bitdepth>(b, filter);
   b[0] = _mm_unpackhi_epi16(a[0], a[1]);
   b[1] = _mm_unpackhi_epi16(a[2], round);
-  c[1] = WienerVertical3(b, filter);
-  return WienerVerticalClip(c);
+  c[1] = WienerVertical3<bitdepth>(b, filter);
+  return WienerVerticalClip<bitdepth>(c);
 }
 
+template <int bitdepth>
 inline __m128i WienerVerticalTap7Kernel(const int16_t* wiener_buffer,
                                         const ptrdiff_t wiener_stride,
                                         const __m128i filter[2], __m128i a[7]) {
@@ -262,9 +294,10 @@ inline __m128i WienerVerticalTap7Kernel(const int16_t* wiener_buffer,
   a[4] = LoadAligned16(wiener_buffer + 4 * wiener_stride);
   a[5] = LoadAligned16(wiener_buffer + 5 * wiener_stride);
   a[6] = LoadAligned16(wiener_buffer + 6 * wiener_stride);
-  return WienerVerticalFilter7(a, filter);
+  return WienerVerticalFilter7<bitdepth>(a, filter);
 }
 
+template <int bitdepth>
 inline __m128i WienerVerticalTap5Kernel(const int16_t* wiener_buffer,
                                         const ptrdiff_t wiener_stride,
                                         const __m128i filter[3], __m128i a[5]) {
@@ -273,18 +306,20 @@ inline __m128i WienerVerticalTap5Kernel(const int16_t* wiener_buffer,
   a[2] = LoadAligned16(wiener_buffer + 2 * wiener_stride);
   a[3] = LoadAligned16(wiener_buffer + 3 * wiener_stride);
   a[4] = LoadAligned16(wiener_buffer + 4 * wiener_stride);
-  return WienerVerticalFilter5(a, filter);
+  return WienerVerticalFilter5<bitdepth>(a, filter);
 }
 
+template <int bitdepth>
 inline __m128i WienerVerticalTap3Kernel(const int16_t* wiener_buffer,
                                         const ptrdiff_t wiener_stride,
                                         const __m128i filter[2], __m128i a[3]) {
   a[0] = LoadAligned16(wiener_buffer + 0 * wiener_stride);
   a[1] = LoadAligned16(wiener_buffer + 1 * wiener_stride);
   a[2] = LoadAligned16(wiener_buffer + 2 * wiener_stride);
-  return WienerVerticalFilter3(a, filter);
+  return WienerVerticalFilter3<bitdepth>(a, filter);
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap7(const int16_t* wiener_buffer,
                                const ptrdiff_t width, const int height,
                                const int16_t coefficients[4], uint16_t* dst,
@@ -300,9 +335,10 @@ inline void WienerVerticalTap7(const int16_t* wiener_buffer,
     ptrdiff_t x = 0;
     do {
       __m128i a[8], d[2];
-      d[0] = WienerVerticalTap7Kernel(wiener_buffer + x, width, filter, a);
+      d[0] = WienerVerticalTap7Kernel<bitdepth>(wiener_buffer + x, width,
+                                                filter, a);
       a[7] = LoadAligned16(wiener_buffer + x + 7 * width);
-      d[1] = WienerVerticalFilter7(a + 1, filter);
+      d[1] = WienerVerticalFilter7<bitdepth>(a + 1, filter);
       StoreAligned16(dst + x, d[0]);
       StoreAligned16(dst + dst_stride + x, d[1]);
       x += 8;
@@ -315,14 +351,15 @@ inline void WienerVerticalTap7(const int16_t* wiener_buffer,
     ptrdiff_t x = 0;
     do {
       __m128i a[7];
-      const __m128i d =
-          WienerVerticalTap7Kernel(wiener_buffer + x, width, filter, a);
+      const __m128i d = WienerVerticalTap7Kernel<bitdepth>(
+          wiener_buffer + x, width, filter, a);
       StoreAligned16(dst + x, d);
       x += 8;
     } while (x < width);
   }
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap5(const int16_t* wiener_buffer,
                                const ptrdiff_t width, const int height,
                                const int16_t coefficients[3], uint16_t* dst,
@@ -337,9 +374,10 @@ inline void WienerVerticalTap5(const int16_t* wiener_buffer,
     ptrdiff_t x = 0;
     do {
       __m128i a[6], d[2];
-      d[0] = WienerVerticalTap5Kernel(wiener_buffer + x, width, filter, a);
+      d[0] = WienerVerticalTap5Kernel<bitdepth>(wiener_buffer + x, width,
+                                                filter, a);
       a[5] = LoadAligned16(wiener_buffer + x + 5 * width);
-      d[1] = WienerVerticalFilter5(a + 1, filter);
+      d[1] = WienerVerticalFilter5<bitdepth>(a + 1, filter);
       StoreAligned16(dst + x, d[0]);
       StoreAligned16(dst + dst_stride + x, d[1]);
       x += 8;
@@ -352,14 +390,15 @@ inline void WienerVerticalTap5(const int16_t* wiener_buffer,
     ptrdiff_t x = 0;
     do {
       __m128i a[5];
-      const __m128i d =
-          WienerVerticalTap5Kernel(wiener_buffer + x, width, filter, a);
+      const __m128i d = WienerVerticalTap5Kernel<bitdepth>(
+          wiener_buffer + x, width, filter, a);
       StoreAligned16(dst + x, d);
       x += 8;
     } while (x < width);
   }
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap3(const int16_t* wiener_buffer,
                                const ptrdiff_t width, const int height,
                                const int16_t coefficients[2], uint16_t* dst,
@@ -372,9 +411,10 @@ inline void WienerVerticalTap3(const int16_t* wiener_buffer,
     ptrdiff_t x = 0;
     do {
       __m128i a[4], d[2];
-      d[0] = WienerVerticalTap3Kernel(wiener_buffer + x, width, filter, a);
+      d[0] = WienerVerticalTap3Kernel<bitdepth>(wiener_buffer + x, width,
+                                                filter, a);
       a[3] = LoadAligned16(wiener_buffer + x + 3 * width);
-      d[1] = WienerVerticalFilter3(a + 1, filter);
+      d[1] = WienerVerticalFilter3<bitdepth>(a + 1, filter);
       StoreAligned16(dst + x, d[0]);
       StoreAligned16(dst + dst_stride + x, d[1]);
       x += 8;
@@ -387,32 +427,38 @@ inline void WienerVerticalTap3(const int16_t* wiener_buffer,
     ptrdiff_t x = 0;
     do {
       __m128i a[3];
-      const __m128i d =
-          WienerVerticalTap3Kernel(wiener_buffer + x, width, filter, a);
+      const __m128i d = WienerVerticalTap3Kernel<bitdepth>(
+          wiener_buffer + x, width, filter, a);
       StoreAligned16(dst + x, d);
       x += 8;
     } while (x < width);
   }
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap1Kernel(const int16_t* const wiener_buffer,
                                      uint16_t* const dst) {
+  constexpr int kRoundBitsVertical =
+      (bitdepth == 12) ? kInterRoundBitsVertical12bpp : kInterRoundBitsVertical;
   const __m128i a = LoadAligned16(wiener_buffer);
-  const __m128i b = _mm_add_epi16(a, _mm_set1_epi16(8));
-  const __m128i c = _mm_srai_epi16(b, 4);
+  constexpr int kShift = kRoundBitsVertical - kWienerFilterBits;
+  const __m128i b = _mm_add_epi16(a, _mm_set1_epi16(1 << (kShift - 1)));
+  const __m128i c = _mm_srai_epi16(b, kShift);
   const __m128i d = _mm_max_epi16(c, _mm_setzero_si128());
-  const __m128i e = _mm_min_epi16(d, _mm_set1_epi16(1023));
+  const __m128i e = _mm_min_epi16(d, _mm_set1_epi16((1 << bitdepth) - 1));
   StoreAligned16(dst, e);
 }
 
+template <int bitdepth>
 inline void WienerVerticalTap1(const int16_t* wiener_buffer,
                                const ptrdiff_t width, const int height,
                                uint16_t* dst, const ptrdiff_t dst_stride) {
   for (int y = height >> 1; y > 0; --y) {
     ptrdiff_t x = 0;
     do {
-      WienerVerticalTap1Kernel(wiener_buffer + x, dst + x);
-      WienerVerticalTap1Kernel(wiener_buffer + width + x, dst + dst_stride + x);
+      WienerVerticalTap1Kernel<bitdepth>(wiener_buffer + x, dst + x);
+      WienerVerticalTap1Kernel<bitdepth>(wiener_buffer + width + x,
+                                         dst + dst_stride + x);
       x += 8;
     } while (x < width);
     dst += 2 * dst_stride;
@@ -422,12 +468,13 @@ inline void WienerVerticalTap1(const int16_t* wiener_buffer,
   if ((height & 1) != 0) {
     ptrdiff_t x = 0;
     do {
-      WienerVerticalTap1Kernel(wiener_buffer + x, dst + x);
+      WienerVerticalTap1Kernel<bitdepth>(wiener_buffer + x, dst + x);
       x += 8;
     } while (x < width);
   }
 }
 
+template <int bitdepth>
 void WienerFilter_SSE4_1(
     const RestorationUnitInfo& LIBGAV1_RESTRICT restoration_info,
     const void* LIBGAV1_RESTRICT const source, const ptrdiff_t stride,
@@ -444,7 +491,7 @@ void WienerFilter_SSE4_1(
       1);
   const ptrdiff_t wiener_stride = Align(width, 16);
   int16_t* const wiener_buffer_vertical = restoration_buffer->wiener_buffer;
-  // The values are saturated to 13 bits before storing.
+  // The values are saturated to 13 bits (15 bits for 12bpp) before storing.
   int16_t* wiener_buffer_horizontal =
       wiener_buffer_vertical + number_rows_to_skip * wiener_stride;
 
@@ -460,42 +507,51 @@ void WienerFilter_SSE4_1(
   const __m128i coefficients_horizontal =
       LoadLo8(restoration_info.wiener_info.filter[WienerInfo::kHorizontal]);
   if (number_leading_zero_coefficients[WienerInfo::kHorizontal] == 0) {
-    WienerHorizontalTap7(top + (2 - height_extra) * top_border_stride - 3,
-                         top_border_stride, wiener_stride, height_extra,
-                         coefficients_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap7(src - 3, stride, wiener_stride, height,
-                         coefficients_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap7(bottom - 3, bottom_border_stride, wiener_stride,
-                         height_extra, coefficients_horizontal,
-                         &wiener_buffer_horizontal);
+    WienerHorizontalTap7<bitdepth>(
+        top + (2 - height_extra) * top_border_stride - 3, top_border_stride,
+        wiener_stride, height_extra, coefficients_horizontal,
+        &wiener_buffer_horizontal);
+    WienerHorizontalTap7<bitdepth>(src - 3, stride, wiener_stride, height,
+                                   coefficients_horizontal,
+                                   &wiener_buffer_horizontal);
+    WienerHorizontalTap7<bitdepth>(bottom - 3, bottom_border_stride,
+                                   wiener_stride, height_extra,
+                                   coefficients_horizontal,
+                                   &wiener_buffer_horizontal);
   } else if (number_leading_zero_coefficients[WienerInfo::kHorizontal] == 1) {
-    WienerHorizontalTap5(top + (2 - height_extra) * top_border_stride - 2,
-                         top_border_stride, wiener_stride, height_extra,
-                         coefficients_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap5(src - 2, stride, wiener_stride, height,
-                         coefficients_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap5(bottom - 2, bottom_border_stride, wiener_stride,
-                         height_extra, coefficients_horizontal,
-                         &wiener_buffer_horizontal);
+    WienerHorizontalTap5<bitdepth>(
+        top + (2 - height_extra) * top_border_stride - 2, top_border_stride,
+        wiener_stride, height_extra, coefficients_horizontal,
+        &wiener_buffer_horizontal);
+    WienerHorizontalTap5<bitdepth>(src - 2, stride, wiener_stride, height,
+                                   coefficients_horizontal,
+                                   &wiener_buffer_horizontal);
+    WienerHorizontalTap5<bitdepth>(bottom - 2, bottom_border_stride,
+                                   wiener_stride, height_extra,
+                                   coefficients_horizontal,
+                                   &wiener_buffer_horizontal);
   } else if (number_leading_zero_coefficients[WienerInfo::kHorizontal] == 2) {
     // The maximum over-reads happen here.
-    WienerHorizontalTap3(top + (2 - height_extra) * top_border_stride - 1,
-                         top_border_stride, wiener_stride, height_extra,
-                         coefficients_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap3(src - 1, stride, wiener_stride, height,
-                         coefficients_horizontal, &wiener_buffer_horizontal);
-    WienerHorizontalTap3(bottom - 1, bottom_border_stride, wiener_stride,
-                         height_extra, coefficients_horizontal,
-                         &wiener_buffer_horizontal);
+    WienerHorizontalTap3<bitdepth>(
+        top + (2 - height_extra) * top_border_stride - 1, top_border_stride,
+        wiener_stride, height_extra, coefficients_horizontal,
+        &wiener_buffer_horizontal);
+    WienerHorizontalTap3<bitdepth>(src - 1, stride, wiener_stride, height,
+                                   coefficients_horizontal,
+                                   &wiener_buffer_horizontal);
+    WienerHorizontalTap3<bitdepth>(bottom - 1, bottom_border_stride,
+                                   wiener_stride, height_extra,
+                                   coefficients_horizontal,
+                                   &wiener_buffer_horizontal);
   } else {
     assert(number_leading_zero_coefficients[WienerInfo::kHorizontal] == 3);
-    WienerHorizontalTap1(top + (2 - height_extra) * top_border_stride,
-                         top_border_stride, wiener_stride, height_extra,
-                         &wiener_buffer_horizontal);
-    WienerHorizontalTap1(src, stride, wiener_stride, height,
-                         &wiener_buffer_horizontal);
-    WienerHorizontalTap1(bottom, bottom_border_stride, wiener_stride,
-                         height_extra, &wiener_buffer_horizontal);
+    WienerHorizontalTap1<bitdepth>(top + (2 - height_extra) * top_border_stride,
+                                   top_border_stride, wiener_stride,
+                                   height_extra, &wiener_buffer_horizontal);
+    WienerHorizontalTap1<bitdepth>(src, stride, wiener_stride, height,
+                                   &wiener_buffer_horizontal);
+    WienerHorizontalTap1<bitdepth>(bottom, bottom_border_stride, wiener_stride,
+                                   height_extra, &wiener_buffer_horizontal);
   }
 
   // vertical filtering.
@@ -512,18 +568,20 @@ void WienerFilter_SSE4_1(
     memcpy(restoration_buffer->wiener_buffer,
            restoration_buffer->wiener_buffer + wiener_stride,
            sizeof(*restoration_buffer->wiener_buffer) * wiener_stride);
-    WienerVerticalTap7(wiener_buffer_vertical, wiener_stride, height,
-                       filter_vertical, dst, stride);
+    WienerVerticalTap7<bitdepth>(wiener_buffer_vertical, wiener_stride, height,
+                                 filter_vertical, dst, stride);
   } else if (number_leading_zero_coefficients[WienerInfo::kVertical] == 1) {
-    WienerVerticalTap5(wiener_buffer_vertical + wiener_stride, wiener_stride,
-                       height, filter_vertical + 1, dst, stride);
+    WienerVerticalTap5<bitdepth>(wiener_buffer_vertical + wiener_stride,
+                                 wiener_stride, height, filter_vertical + 1,
+                                 dst, stride);
   } else if (number_leading_zero_coefficients[WienerInfo::kVertical] == 2) {
-    WienerVerticalTap3(wiener_buffer_vertical + 2 * wiener_stride,
-                       wiener_stride, height, filter_vertical + 2, dst, stride);
+    WienerVerticalTap3<bitdepth>(wiener_buffer_vertical + 2 * wiener_stride,
+                                 wiener_stride, height, filter_vertical + 2,
+                                 dst, stride);
   } else {
     assert(number_leading_zero_coefficients[WienerInfo::kVertical] == 3);
-    WienerVerticalTap1(wiener_buffer_vertical + 3 * wiener_stride,
-                       wiener_stride, height, dst, stride);
+    WienerVerticalTap1<bitdepth>(wiener_buffer_vertical + 3 * wiener_stride,
+                                 wiener_stride, height, dst, stride);
   }
 }
 
@@ -643,6 +701,18 @@ inline __m128i VaddwHi8(const __m128i src0, const __m128i src1) {
   return _mm_add_epi16(src0, s1);
 }
 
+inline __m128i VaddlLo16(const __m128i src0, const __m128i src1) {
+  const __m128i s0 = _mm_unpacklo_epi16(src0, _mm_setzero_si128());
+  const __m128i s1 = _mm_unpacklo_epi16(src1, _mm_setzero_si128());
+  return _mm_add_epi32(s0, s1);
+}
+
+inline __m128i VaddlHi16(const __m128i src0, const __m128i src1) {
+  const __m128i s0 = _mm_unpackhi_epi16(src0, _mm_setzero_si128());
+  const __m128i s1 = _mm_unpackhi_epi16(src1, _mm_setzero_si128());
+  return _mm_add_epi32(s0, s1);
+}
+
 inline __m128i VmullNLo8(const __m128i src0, const int src1) {
   const __m128i s0 = _mm_unpacklo_epi16(src0, _mm_setzero_si128());
   return _mm_madd_epi16(s0, _mm_set1_epi32(src1));
@@ -665,6 +735,15 @@ inline __m128i VmullHi16(const __m128i src0, const __m128i src1) {
   return _mm_madd_epi16(s0, s1);
 }
 
+// The products may use all 32 bits, unlike VmullLo16() and VmullHi16() whose
+// inputs are limited to 15 bits by _mm_madd_epi16().
+inline void VmullU16(const __m128i src0, const __m128i src1, __m128i dst[2]) {
+  const __m128i lo = _mm_mullo_epi16(src0, src1);
+  const __m128i hi = _mm_mulhi_epu16(src0, src1);
+  dst[0] = _mm_unpacklo_epi16(lo, hi);
+  dst[1] = _mm_unpackhi_epi16(lo, hi);
+}
+
 inline __m128i VrshrU16(const __m128i src0, const int src1) {
   const __m128i sum = _mm_add_epi16(src0, _mm_set1_epi16(1 << (src1 - 1)));
   return _mm_srli_epi16(sum, src1);
@@ -760,6 +839,17 @@ inline __m128i Sum5_16(const __m128i src[5]) {
   return _mm_add_epi16(sum, src[4]);
 }
 
+// A 5x5 box sum of 12 bit pixels needs 17 bits.
+inline void Sum5W16(const __m128i src[5], __m128i dst[2]) {
+  const __m128i sum01 = _mm_add_epi16(src[0], src[1]);
+  const __m128i sum23 = _mm_add_epi16(src[2], src[3]);
+  const __m128i sum4 = src[4];
+  dst[0] = _mm_add_epi32(VaddlLo16(sum01, sum23),
+                         _mm_unpacklo_epi16(sum4, _mm_setzero_si128()));
+  dst[1] = _mm_add_epi32(VaddlHi16(sum01, sum23),
+                         _mm_unpackhi_epi16(sum4, _mm_setzero_si128()));
+}
+
 inline __m128i Sum5_32(const __m128i* const src0, const __m128i* const src1,
                        const __m128i* const src2, const __m128i* const src3,
                        const __m128i* const src4) {
@@ -1012,15 +1102,30 @@ inline __m128i CalculateMa(const __m128i sum, const __m128i sum_sq,
   return VrshrU32(pxs, kSgrProjScaleBits);
 }
 
-template <int n>
+template <int bitdepth, int n>
 inline __m128i CalculateMa(const __m128i sum, const __m128i sum_sq[2],
                            const uint32_t scale) {
   static_assert(n == 9 || n == 25, "");
-  const __m128i b = VrshrU16(sum, 2);
+  const __m128i b = VrshrU16(sum, bitdepth - 8);
   const __m128i sum_lo = _mm_unpacklo_epi16(b, _mm_setzero_si128());
   const __m128i sum_hi = _mm_unpackhi_epi16(b, _mm_setzero_si128());
-  const __m128i z0 = CalculateMa<n>(sum_lo, VrshrU32(sum_sq[0], 4), scale);
-  const __m128i z1 = CalculateMa<n>(sum_hi, VrshrU32(sum_sq[1], 4), scale);
+  const __m128i z0 =
+      CalculateMa<n>(sum_lo, VrshrU32(sum_sq[0], 2 * (bitdepth - 8)), scale);
+  const __m128i z1 =
+      CalculateMa<n>(sum_hi, VrshrU32(sum_sq[1], 2 * (bitdepth - 8)), scale);
+  return _mm_packus_epi32(z0, z1);
+}
+
+template <int bitdepth, int n>
+inline __m128i CalculateMa(const __m128i sum[2], const __m128i sum_sq[2],
+                           const uint32_t scale) {
+  static_assert(n == 9 || n == 25, "");
+  const __m128i sum_lo = VrshrU32(sum[0], bitdepth - 8);
+  const __m128i sum_hi = VrshrU32(sum[1], bitdepth - 8);
+  const __m128i z0 =
+      CalculateMa<n>(sum_lo, VrshrU32(sum_sq[0], 2 * (bitdepth - 8)), scale);
+  const __m128i z1 =
+      CalculateMa<n>(sum_hi, VrshrU32(sum_sq[1], 2 * (bitdepth - 8)), scale);
   return _mm_packus_epi32(z0, z1);
 }
 
@@ -1039,40 +1144,70 @@ inline void CalculateB5(const __m128i sum, const __m128i ma, __m128i b[2]) {
   b[1] = VrshrU32(m1, kSgrProjReciprocalBits - 2);
 }
 
+inline void CalculateB5(const __m128i sum[2], const __m128i ma, __m128i b[2]) {
+  // one_over_n == 164.
+  constexpr uint32_t one_over_n =
+      ((1 << kSgrProjReciprocalBits) + (25 >> 1)) / 25;
+  // one_over_n_quarter == 41.
+  constexpr uint32_t one_over_n_quarter = one_over_n >> 2;
+  static_assert(one_over_n == one_over_n_quarter << 2, "");
+  // |ma| is in range [0, 255].
+  const __m128i m = _mm_maddubs_epi16(ma, _mm_set1_epi16(one_over_n_quarter));
+  const __m128i m_lo = _mm_unpacklo_epi16(m, _mm_setzero_si128());
+  const __m128i m_hi = _mm_unpackhi_epi16(m, _mm_setzero_si128());
+  const __m128i m0 = _mm_mullo_epi32(m_lo, sum[0]);
+  const __m128i m1 = _mm_mullo_epi32(m_hi, sum[1]);
+  b[0] = VrshrU32(m0, kSgrProjReciprocalBits - 2);
+  b[1] = VrshrU32(m1, kSgrProjReciprocalBits - 2);
+}
+
 inline void CalculateB3(const __m128i sum, const __m128i ma, __m128i b[2]) {
   // one_over_n == 455.
   constexpr uint32_t one_over_n =
       ((1 << kSgrProjReciprocalBits) + (9 >> 1)) / 9;
-  const __m128i m0 = VmullLo16(ma, sum);
-  const __m128i m1 = VmullHi16(ma, sum);
-  const __m128i m2 = _mm_mullo_epi32(m0, _mm_set1_epi32(one_over_n));
-  const __m128i m3 = _mm_mullo_epi32(m1, _mm_set1_epi32(one_over_n));
+  // A 3x3 box sum of 12 bit pixels uses all 16 bits.
+  __m128i m[2];
+  VmullU16(ma, sum, m);
+  const __m128i m2 = _mm_mullo_epi32(m[0], _mm_set1_epi32(one_over_n));
+  const __m128i m3 = _mm_mullo_epi32(m[1], _mm_set1_epi32(one_over_n));
   b[0] = VrshrU32(m2, kSgrProjReciprocalBits);
   b[1] = VrshrU32(m3, kSgrProjReciprocalBits);
 }
 
+template <int bitdepth>
 inline void CalculateSumAndIndex5(const __m128i s5[5], const __m128i sq5[5][2],
                                   const uint32_t scale, __m128i* const sum,
                                   __m128i* const index) {
   __m128i sum_sq[2];
   *sum = Sum5_16(s5);
   Sum5_32(sq5, sum_sq);
-  *index = CalculateMa<25>(*sum, sum_sq, scale);
+  *index = CalculateMa<bitdepth, 25>(*sum, sum_sq, scale);
 }
 
+// The 5x5 box sums of 12 bit pixels are widened to 32 bits.
+template <int bitdepth>
+inline void CalculateSumAndIndex5W(const __m128i s5[5], const __m128i sq5[5][2],
+                                   const uint32_t scale, __m128i sum[2],
+                                   __m128i* const index) {
+  __m128i sum_sq[2];
+  Sum5W16(s5, sum);
+  Sum5_32(sq5, sum_sq);
+  *index = CalculateMa<bitdepth, 25>(sum, sum_sq, scale);
+}
+
+template <int bitdepth>
 inline void CalculateSumAndIndex3(const __m128i s3[3], const __m128i sq3[3][2],
                                   const uint32_t scale, __m128i* const sum,
                                   __m128i* const index) {
   __m128i sum_sq[2];
   *sum = Sum3_16(s3);
   Sum3_32(sq3, sum_sq);
-  *index = CalculateMa<9>(*sum, sum_sq, scale);
+  *index = CalculateMa<bitdepth, 9>(*sum, sum_sq, scale);
 }
 
-template <int n, int offset>
-inline void LookupIntermediate(const __m128i sum, const __m128i index,
-                               __m128i* const ma, __m128i b[2]) {
-  static_assert(n == 9 || n == 25, "");
+// Returns the 8 |ma| values also inserted into |ma|, widened to 16 bits.
+template <int offset>
+inline __m128i LookupMa(const __m128i index, __m128i* const ma) {
   static_assert(offset == 0 || offset == 8, "");
   const __m128i idx = _mm_packus_epi16(index, index);
   // Actually it's not stored and loaded. The compiler will use a 64-bit
@@ -1094,6 +1229,15 @@ inline void LookupIntermediate(const __m128i sum, const __m128i index,
   *ma = _mm_insert_epi8(*ma, kSgrMaLookup[temp[5]], offset + 5);
   *ma = _mm_insert_epi8(*ma, kSgrMaLookup[temp[6]], offset + 6);
   *ma = _mm_insert_epi8(*ma, kSgrMaLookup[temp[7]], offset + 7);
+  if (offset == 0) return _mm_unpacklo_epi8(*ma, _mm_setzero_si128());
+  return _mm_unpackhi_epi8(*ma, _mm_setzero_si128());
+}
+
+template <int n, int offset>
+inline void LookupIntermediate(const __m128i sum, const __m128i index,
+                               __m128i* const ma, __m128i b[2]) {
+  static_assert(n == 9 || n == 25, "");
+  const __m128i maq = LookupMa<offset>(index, ma);
   // b = ma * b * one_over_n
   // |ma| = [0, 255]
   // |sum| is a box sum with radius 1 or 2.
@@ -1105,12 +1249,6 @@ inline void LookupIntermediate(const __m128i sum, const __m128i index,
   // |kSgrProjReciprocalBits| is 12.
   // Radius 2: 255 * 6375 * 164 >> 12 = 65088 (16 bits).
   // Radius 1: 255 * 2295 * 455 >> 12 = 65009 (16 bits).
-  __m128i maq;
-  if (offset == 0) {
-    maq = _mm_unpacklo_epi8(*ma, _mm_setzero_si128());
-  } else {
-    maq = _mm_unpackhi_epi8(*ma, _mm_setzero_si128());
-  }
   if (n == 9) {
     CalculateB3(sum, maq, b);
   } else {
@@ -1118,6 +1256,14 @@ inline void LookupIntermediate(const __m128i sum, const __m128i index,
   }
 }
 
+// 12 bit pixels only. The 5x5 box sums are 32 bits.
+template <int offset>
+inline void LookupIntermediate5(const __m128i sum[2], const __m128i index,
+                                __m128i* const ma, __m128i b[2]) {
+  const __m128i maq = LookupMa<offset>(index, ma);
+  CalculateB5(sum, maq, b);
+}
+
 // Set the shuffle control mask of indices out of range [0, 15] to (1xxxxxxx)b
 // to get value 0 as the shuffle result. The most significiant bit 1 comes
 // either from the comparison instruction, or from the sign bit of the index.
@@ -1202,21 +1348,29 @@ inline void CalculateIntermediate(const __m128i sum[2], const __m128i index[2],
 // Note: It has been tried to call CalculateIntermediate() to replace the slow
 // LookupIntermediate() when calculating 16 intermediate data points. However,
 // the compiler generates even slower code.
-template <int offset>
+template <int bitdepth, int offset>
 inline void CalculateIntermediate5(const __m128i s5[5], const __m128i sq5[5][2],
                                    const uint32_t scale, __m128i* const ma,
                                    __m128i b[2]) {
   static_assert(offset == 0 || offset == 8, "");
-  __m128i sum, index;
-  CalculateSumAndIndex5(s5, sq5, scale, &sum, &index);
-  LookupIntermediate<25, offset>(sum, index, ma, b);
+  __m128i index;
+  if (bitdepth == kBitdepth12) {
+    __m128i sum[2];
+    CalculateSumAndIndex5W<bitdepth>(s5, sq5, scale, sum, &index);
+    LookupIntermediate5<offset>(sum, index, ma, b);
+  } else {
+    __m128i sum;
+    CalculateSumAndIndex5<bitdepth>(s5, sq5, scale, &sum, &index);
+    LookupIntermediate<25, offset>(sum, index, ma, b);
+  }
 }
 
+template <int bitdepth>
 inline void CalculateIntermediate3(const __m128i s3[3], const __m128i sq3[3][2],
                                    const uint32_t scale, __m128i* const ma,
                                    __m128i b[2]) {
   __m128i sum, index;
-  CalculateSumAndIndex3(s3, sq3, scale, &sum, &index);
+  CalculateSumAndIndex3<bitdepth>(s3, sq3, scale, &sum, &index);
   LookupIntermediate<9, 0>(sum, index, ma, b);
 }
 
@@ -1304,6 +1458,7 @@ inline void Store343_444Hi(const __m128i ma3[3], const __m128i b3[2],
   Store343_444Hi(ma3, b3, x, &sum_ma343, sum_b343, ma343, ma444, b343, b444);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5Lo(
     const __m128i s[2][4], const uint32_t scale, uint16_t* const sum5[5],
     uint32_t* const square_sum5[5], __m128i sq[2][8], __m128i* const ma,
@@ -1321,9 +1476,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5Lo(
   StoreAligned32U32(square_sum5[4], sq5[4]);
   LoadAligned16x3U16(sum5, 0, s5[0]);
   LoadAligned32x3U32(square_sum5, 0, sq5);
-  CalculateIntermediate5<0>(s5[0], sq5, scale, ma, b);
+  CalculateIntermediate5<bitdepth, 0>(s5[0], sq5, scale, ma, b);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5(
     const __m128i s[2][4], const ptrdiff_t sum_width, const ptrdiff_t x,
     const uint32_t scale, uint16_t* const sum5[5],
@@ -1346,7 +1502,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5(
   StoreAligned32U32(square_sum5[4] + x, sq5[4]);
   LoadAligned16x3U16(sum5, x, s5[0]);
   LoadAligned32x3U32(square_sum5, x, sq5);
-  CalculateIntermediate5<8>(s5[0], sq5, scale, &ma[0], b + 2);
+  CalculateIntermediate5<bitdepth, 8>(s5[0], sq5, scale, &ma[0], b + 2);
 
   Square(s[0][3], sq[0] + 6);
   Square(s[1][3], sq[1] + 6);
@@ -1356,9 +1512,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5(
   StoreAligned32U32(square_sum5[4] + x + 8, sq5[4]);
   LoadAligned16x3U16Msan(sum5, x + 8, sum_width, s5[1]);
   LoadAligned32x3U32Msan(square_sum5, x + 8, sum_width, sq5);
-  CalculateIntermediate5<0>(s5[1], sq5, scale, &ma[1], b + 4);
+  CalculateIntermediate5<bitdepth, 0>(s5[1], sq5, scale, &ma[1], b + 4);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5LastRowLo(
     const __m128i s[2], const uint32_t scale, const uint16_t* const sum5[5],
     const uint32_t* const square_sum5[5], __m128i sq[4], __m128i* const ma,
@@ -1371,9 +1528,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5LastRowLo(
   sq5[4][1] = sq5[3][1];
   LoadAligned16x3U16(sum5, 0, s5);
   LoadAligned32x3U32(square_sum5, 0, sq5);
-  CalculateIntermediate5<0>(s5, sq5, scale, ma, b);
+  CalculateIntermediate5<bitdepth, 0>(s5, sq5, scale, ma, b);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5LastRow(
     const __m128i s[4], const ptrdiff_t sum_width, const ptrdiff_t x,
     const uint32_t scale, const uint16_t* const sum5[5],
@@ -1390,7 +1548,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5LastRow(
   sq5[4][1] = sq5[3][1];
   LoadAligned16x3U16(sum5, x, s5[0]);
   LoadAligned32x3U32(square_sum5, x, sq5);
-  CalculateIntermediate5<8>(s5[0], sq5, scale, &ma[0], b + 2);
+  CalculateIntermediate5<bitdepth, 8>(s5[0], sq5, scale, &ma[0], b + 2);
 
   Square(s[3], sq + 6);
   Sum5Horizontal32(sq + 4, sq5[3]);
@@ -1398,9 +1556,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess5LastRow(
   sq5[4][1] = sq5[3][1];
   LoadAligned16x3U16Msan(sum5, x + 8, sum_width, s5[1]);
   LoadAligned32x3U32Msan(square_sum5, x + 8, sum_width, sq5);
-  CalculateIntermediate5<0>(s5[1], sq5, scale, &ma[1], b + 4);
+  CalculateIntermediate5<bitdepth, 0>(s5[1], sq5, scale, &ma[1], b + 4);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess3Lo(
     const __m128i s[2], const uint32_t scale, uint16_t* const sum3[3],
     uint32_t* const square_sum3[3], __m128i sq[4], __m128i* const ma,
@@ -1413,9 +1572,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess3Lo(
   StoreAligned32U32(square_sum3[2], sq3[2]);
   LoadAligned16x2U16(sum3, 0, s3);
   LoadAligned32x2U32(square_sum3, 0, sq3);
-  CalculateIntermediate3(s3, sq3, scale, ma, b);
+  CalculateIntermediate3<bitdepth>(s3, sq3, scale, ma, b);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess3(
     const __m128i s[4], const ptrdiff_t x, const ptrdiff_t sum_width,
     const uint32_t scale, uint16_t* const sum3[3],
@@ -1430,17 +1590,18 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess3(
   StoreAligned32U32(square_sum3[2] + x + 0, sq3[2]);
   LoadAligned16x2U16(sum3, x, s3);
   LoadAligned32x2U32(square_sum3, x, sq3);
-  CalculateSumAndIndex3(s3, sq3, scale, &sum[0], &index[0]);
+  CalculateSumAndIndex3<bitdepth>(s3, sq3, scale, &sum[0], &index[0]);
 
   Square(s[3], sq + 6);
   Sum3Horizontal32(sq + 4, sq3[2]);
   StoreAligned32U32(square_sum3[2] + x + 8, sq3[2]);
   LoadAligned16x2U16Msan(sum3, x + 8, sum_width, s3 + 1);
   LoadAligned32x2U32Msan(square_sum3, x + 8, sum_width, sq3);
-  CalculateSumAndIndex3(s3 + 1, sq3, scale, &sum[1], &index[1]);
+  CalculateSumAndIndex3<bitdepth>(s3 + 1, sq3, scale, &sum[1], &index[1]);
   CalculateIntermediate(sum, index, ma, b + 2);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLo(
     const __m128i s[2][4], const uint16_t scales[2], uint16_t* const sum3[4],
     uint16_t* const sum5[5], uint32_t* const square_sum3[4],
@@ -1465,13 +1626,16 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLo(
   LoadAligned32x2U32(square_sum3, 0, sq3);
   LoadAligned16x3U16(sum5, 0, s5);
   LoadAligned32x3U32(square_sum5, 0, sq5);
-  CalculateSumAndIndex3(s3 + 0, sq3 + 0, scales[1], &sum[0], &index[0]);
-  CalculateSumAndIndex3(s3 + 1, sq3 + 1, scales[1], &sum[1], &index[1]);
+  CalculateSumAndIndex3<bitdepth>(s3 + 0, sq3 + 0, scales[1], &sum[0],
+                                  &index[0]);
+  CalculateSumAndIndex3<bitdepth>(s3 + 1, sq3 + 1, scales[1], &sum[1],
+                                  &index[1]);
   CalculateIntermediate(sum, index, &ma3[0][0], b3[0], b3[1]);
   ma3[1][0] = _mm_srli_si128(ma3[0][0], 8);
-  CalculateIntermediate5<0>(s5, sq5, scales[0], ma5, b5);
+  CalculateIntermediate5<bitdepth, 0>(s5, sq5, scales[0], ma5, b5);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess(
     const __m128i s[2][4], const ptrdiff_t x, const uint16_t scales[2],
     uint16_t* const sum3[4], uint16_t* const sum5[5],
@@ -1499,12 +1663,13 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess(
   StoreAligned32U32(square_sum5[4] + x, sq5[4]);
   LoadAligned16x2U16(sum3, x, s3[0]);
   LoadAligned32x2U32(square_sum3, x, sq3);
-  CalculateSumAndIndex3(s3[0], sq3, scales[1], &sum[0][0], &index[0][0]);
-  CalculateSumAndIndex3(s3[0] + 1, sq3 + 1, scales[1], &sum[1][0],
-                        &index[1][0]);
+  CalculateSumAndIndex3<bitdepth>(s3[0], sq3, scales[1], &sum[0][0],
+                                  &index[0][0]);
+  CalculateSumAndIndex3<bitdepth>(s3[0] + 1, sq3 + 1, scales[1], &sum[1][0],
+                                  &index[1][0]);
   LoadAligned16x3U16(sum5, x, s5[0]);
   LoadAligned32x3U32(square_sum5, x, sq5);
-  CalculateIntermediate5<8>(s5[0], sq5, scales[0], &ma5[0], b5 + 2);
+  CalculateIntermediate5<bitdepth, 8>(s5[0], sq5, scales[0], &ma5[0], b5 + 2);
 
   Square(s[0][3], sq[0] + 6);
   Square(s[1][3], sq[1] + 6);
@@ -1516,16 +1681,18 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcess(
   StoreAligned32U32(square_sum5[4] + x + 8, sq5[4]);
   LoadAligned16x2U16Msan(sum3, x + 8, sum_width, s3[1]);
   LoadAligned32x2U32Msan(square_sum3, x + 8, sum_width, sq3);
-  CalculateSumAndIndex3(s3[1], sq3, scales[1], &sum[0][1], &index[0][1]);
-  CalculateSumAndIndex3(s3[1] + 1, sq3 + 1, scales[1], &sum[1][1],
-                        &index[1][1]);
+  CalculateSumAndIndex3<bitdepth>(s3[1], sq3, scales[1], &sum[0][1],
+                                  &index[0][1]);
+  CalculateSumAndIndex3<bitdepth>(s3[1] + 1, sq3 + 1, scales[1], &sum[1][1],
+                                  &index[1][1]);
   CalculateIntermediate(sum[0], index[0], ma3[0], b3[0] + 2);
   CalculateIntermediate(sum[1], index[1], ma3[1], b3[1] + 2);
   LoadAligned16x3U16Msan(sum5, x + 8, sum_width, s5[1]);
   LoadAligned32x3U32Msan(square_sum5, x + 8, sum_width, sq5);
-  CalculateIntermediate5<0>(s5[1], sq5, scales[0], &ma5[1], b5 + 4);
+  CalculateIntermediate5<bitdepth, 0>(s5[1], sq5, scales[0], &ma5[1], b5 + 4);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRowLo(
     const __m128i s[2], const uint16_t scales[2], const uint16_t* const sum3[4],
     const uint16_t* const sum5[5], const uint32_t* const square_sum3[4],
@@ -1540,12 +1707,13 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRowLo(
   LoadAligned32x3U32(square_sum5, 0, sq5);
   sq5[4][0] = sq5[3][0];
   sq5[4][1] = sq5[3][1];
-  CalculateIntermediate5<0>(s5, sq5, scales[0], ma5, b5);
+  CalculateIntermediate5<bitdepth, 0>(s5, sq5, scales[0], ma5, b5);
   LoadAligned16x2U16(sum3, 0, s3);
   LoadAligned32x2U32(square_sum3, 0, sq3);
-  CalculateIntermediate3(s3, sq3, scales[1], ma3, b3);
+  CalculateIntermediate3<bitdepth>(s3, sq3, scales[1], ma3, b3);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRow(
     const __m128i s[4], const ptrdiff_t sum_width, const ptrdiff_t x,
     const uint16_t scales[2], const uint16_t* const sum3[4],
@@ -1561,10 +1729,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRow(
   LoadAligned32x3U32(square_sum5, x, sq5);
   sq5[4][0] = sq5[3][0];
   sq5[4][1] = sq5[3][1];
-  CalculateIntermediate5<8>(s5[0], sq5, scales[0], ma5, b5 + 2);
+  CalculateIntermediate5<bitdepth, 8>(s5[0], sq5, scales[0], ma5, b5 + 2);
   LoadAligned16x2U16(sum3, x, s3[0]);
   LoadAligned32x2U32(square_sum3, x, sq3);
-  CalculateSumAndIndex3(s3[0], sq3, scales[1], &sum[0], &index[0]);
+  CalculateSumAndIndex3<bitdepth>(s3[0], sq3, scales[1], &sum[0], &index[0]);
 
   Square(s[3], sq + 6);
   SumHorizontal32(sq + 4, &sq3[2][0], &sq3[2][1], &sq5[3][0], &sq5[3][1]);
@@ -1573,13 +1741,14 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPreProcessLastRow(
   LoadAligned32x3U32Msan(square_sum5, x + 8, sum_width, sq5);
   sq5[4][0] = sq5[3][0];
   sq5[4][1] = sq5[3][1];
-  CalculateIntermediate5<0>(s5[1], sq5, scales[0], ma5 + 1, b5 + 4);
+  CalculateIntermediate5<bitdepth, 0>(s5[1], sq5, scales[0], ma5 + 1, b5 + 4);
   LoadAligned16x2U16Msan(sum3, x + 8, sum_width, s3[1]);
   LoadAligned32x2U32Msan(square_sum3, x + 8, sum_width, sq3);
-  CalculateSumAndIndex3(s3[1], sq3, scales[1], &sum[1], &index[1]);
+  CalculateSumAndIndex3<bitdepth>(s3[1], sq3, scales[1], &sum[1], &index[1]);
   CalculateIntermediate(sum, index, ma3, b3 + 2);
 }
 
+template <int bitdepth>
 inline void BoxSumFilterPreProcess5(const uint16_t* const src0,
                                     const uint16_t* const src1, const int width,
                                     const uint32_t scale,
@@ -1596,7 +1765,8 @@ inline void BoxSumFilterPreProcess5(const uint16_t* const src0,
   s[1][1] = LoadUnaligned16Msan(src1 + 8, overread_in_bytes + 16);
   Square(s[0][0], sq[0]);
   Square(s[1][0], sq[1]);
-  BoxFilterPreProcess5Lo(s, scale, sum5, square_sum5, sq, &mas[0], bs);
+  BoxFilterPreProcess5Lo<bitdepth>(s, scale, sum5, square_sum5, sq, &mas[0],
+                                   bs);
 
   int x = 0;
   do {
@@ -1609,8 +1779,8 @@ inline void BoxSumFilterPreProcess5(const uint16_t* const src0,
                                   overread_in_bytes + sizeof(*src1) * (x + 16));
     s[1][3] = LoadUnaligned16Msan(src1 + x + 24,
                                   overread_in_bytes + sizeof(*src1) * (x + 24));
-    BoxFilterPreProcess5(s, sum_width, x + 8, scale, sum5, square_sum5, sq, mas,
-                         bs);
+    BoxFilterPreProcess5<bitdepth>(s, sum_width, x + 8, scale, sum5,
+                                   square_sum5, sq, mas, bs);
     Prepare3_8<0>(mas, ma5);
     ma[0] = Sum565Lo(ma5);
     ma[1] = Sum565Hi(ma5);
@@ -1635,7 +1805,7 @@ inline void BoxSumFilterPreProcess5(const uint16_t* const src0,
   } while (x < width);
 }
 
-template <bool calculate444>
+template <int bitdepth, bool calculate444>
 LIBGAV1_ALWAYS_INLINE void BoxSumFilterPreProcess3(
     const uint16_t* const src, const int width, const uint32_t scale,
     uint16_t* const sum3[3], uint32_t* const square_sum3[3],
@@ -1647,7 +1817,8 @@ LIBGAV1_ALWAYS_INLINE void BoxSumFilterPreProcess3(
   s[0] = LoadUnaligned16Msan(src + 0, overread_in_bytes + 0);
   s[1] = LoadUnaligned16Msan(src + 8, overread_in_bytes + 16);
   Square(s[0], sq);
-  BoxFilterPreProcess3Lo(s, scale, sum3, square_sum3, sq, &mas[0], bs);
+  BoxFilterPreProcess3Lo<bitdepth>(s, scale, sum3, square_sum3, sq, &mas[0],
+                                   bs);
 
   int x = 0;
   do {
@@ -1655,8 +1826,8 @@ LIBGAV1_ALWAYS_INLINE void BoxSumFilterPreProcess3(
                                overread_in_bytes + sizeof(*src) * (x + 16));
     s[3] = LoadUnaligned16Msan(src + x + 24,
                                overread_in_bytes + sizeof(*src) * (x + 24));
-    BoxFilterPreProcess3(s, x + 8, sum_width, scale, sum3, square_sum3, sq, mas,
-                         bs);
+    BoxFilterPreProcess3<bitdepth>(s, x + 8, sum_width, scale, sum3,
+                                   square_sum3, sq, mas, bs);
     __m128i ma3[3];
     Prepare3_8<0>(mas, ma3);
     if (calculate444) {  // NOLINT(readability-simplify-boolean-expr)
@@ -1685,6 +1856,7 @@ LIBGAV1_ALWAYS_INLINE void BoxSumFilterPreProcess3(
   } while (x < width);
 }
 
+template <int bitdepth>
 inline void BoxSumFilterPreProcess(
     const uint16_t* const src0, const uint16_t* const src1, const int width,
     const uint16_t scales[2], uint16_t* const sum3[4], uint16_t* const sum5[5],
@@ -1701,8 +1873,8 @@ inline void BoxSumFilterPreProcess(
   s[1][1] = LoadUnaligned16Msan(src1 + 8, overread_in_bytes + 16);
   Square(s[0][0], sq[0]);
   Square(s[1][0], sq[1]);
-  BoxFilterPreProcessLo(s, scales, sum3, sum5, square_sum3, square_sum5, sq,
-                        ma3, b3, &ma5[0], b5);
+  BoxFilterPreProcessLo<bitdepth>(s, scales, sum3, sum5, square_sum3,
+                                  square_sum5, sq, ma3, b3, &ma5[0], b5);
 
   int x = 0;
   do {
@@ -1715,8 +1887,8 @@ inline void BoxSumFilterPreProcess(
                                   overread_in_bytes + sizeof(*src1) * (x + 16));
     s[1][3] = LoadUnaligned16Msan(src1 + x + 24,
                                   overread_in_bytes + sizeof(*src1) * (x + 24));
-    BoxFilterPreProcess(s, x + 8, scales, sum3, sum5, square_sum3, square_sum5,
-                        sum_width, sq, ma3, b3, ma5, b5);
+    BoxFilterPreProcess<bitdepth>(s, x + 8, scales, sum3, sum5, square_sum3,
+                                  square_sum5, sum_width, sq, ma3, b3, ma5, b5);
 
     Prepare3_8<0>(ma3[0], ma3x);
     ma[0] = Sum343Lo(ma3x);
@@ -1771,33 +1943,34 @@ inline __m128i FilterOutput(const __m128i ma_x_src, const __m128i b) {
   return VrshrS32(v, kSgrProjSgrBits + shift - kSgrProjRestoreBits);
 }
 
+// The output is kept in 32 bits. It needs 15 bits for 10 bit pixels and is
+// packed by the multipliers, but up to 17 bits for 12 bit pixels.
 template <int shift>
-inline __m128i CalculateFilteredOutput(const __m128i src, const __m128i ma,
-                                       const __m128i b[2]) {
+inline void CalculateFilteredOutput(const __m128i src, const __m128i ma,
+                                    const __m128i b[2], __m128i dst[2]) {
   const __m128i ma_x_src_lo = VmullLo16(ma, src);
   const __m128i ma_x_src_hi = VmullHi16(ma, src);
-  const __m128i dst_lo = FilterOutput<shift>(ma_x_src_lo, b[0]);
-  const __m128i dst_hi = FilterOutput<shift>(ma_x_src_hi, b[1]);
-  return _mm_packs_epi32(dst_lo, dst_hi);  // 13 bits
+  dst[0] = FilterOutput<shift>(ma_x_src_lo, b[0]);
+  dst[1] = FilterOutput<shift>(ma_x_src_hi, b[1]);
 }
 
-inline __m128i CalculateFilteredOutputPass1(const __m128i src,
-                                            const __m128i ma[2],
-                                            const __m128i b[2][2]) {
+inline void CalculateFilteredOutputPass1(const __m128i src, const __m128i ma[2],
+                                         const __m128i b[2][2],
+                                         __m128i dst[2]) {
   const __m128i ma_sum = _mm_add_epi16(ma[0], ma[1]);
   __m128i b_sum[2];
   b_sum[0] = _mm_add_epi32(b[0][0], b[1][0]);
   b_sum[1] = _mm_add_epi32(b[0][1], b[1][1]);
-  return CalculateFilteredOutput<5>(src, ma_sum, b_sum);
+  CalculateFilteredOutput<5>(src, ma_sum, b_sum, dst);
 }
 
-inline __m128i CalculateFilteredOutputPass2(const __m128i src,
-                                            const __m128i ma[3],
-                                            const __m128i b[3][2]) {
+inline void CalculateFilteredOutputPass2(const __m128i src, const __m128i ma[3],
+                                         const __m128i b[3][2],
+                                         __m128i dst[2]) {
   const __m128i ma_sum = Sum3_16(ma);
   __m128i b_sum[2];
   Sum3_32(b, b_sum);
-  return CalculateFilteredOutput<5>(src, ma_sum, b_sum);
+  CalculateFilteredOutput<5>(src, ma_sum, b_sum, dst);
 }
 
 inline __m128i SelfGuidedFinal(const __m128i src, const __m128i v[2]) {
@@ -1809,33 +1982,56 @@ inline __m128i SelfGuidedFinal(const __m128i src, const __m128i v[2]) {
   return _mm_add_epi16(src, vv);
 }
 
+template <int bitdepth>
 inline __m128i SelfGuidedDoubleMultiplier(const __m128i src,
-                                          const __m128i filter[2], const int w0,
-                                          const int w2) {
+                                          const __m128i filter[2][2],
+                                          const int w0, const int w2) {
   __m128i v[2];
+  if (bitdepth == kBitdepth12) {
+    const __m128i w0_32 = _mm_set1_epi32(w0);
+    const __m128i w2_32 = _mm_set1_epi32(w2);
+    v[0] = _mm_add_epi32(_mm_mullo_epi32(w0_32, filter[0][0]),
+                         _mm_mullo_epi32(w2_32, filter[1][0]));
+    v[1] = _mm_add_epi32(_mm_mullo_epi32(w0_32, filter[0][1]),
+                         _mm_mullo_epi32(w2_32, filter[1][1]));
+    return SelfGuidedFinal(src, v);
+  }
   const __m128i w0_w2 = _mm_set1_epi32((w2 << 16) | static_cast<uint16_t>(w0));
-  const __m128i f_lo = _mm_unpacklo_epi16(filter[0], filter[1]);
-  const __m128i f_hi = _mm_unpackhi_epi16(filter[0], filter[1]);
+  const __m128i f0 = _mm_packs_epi32(filter[0][0], filter[0][1]);
+  const __m128i f1 = _mm_packs_epi32(filter[1][0], filter[1][1]);
+  const __m128i f_lo = _mm_unpacklo_epi16(f0, f1);
+  const __m128i f_hi = _mm_unpackhi_epi16(f0, f1);
   v[0] = _mm_madd_epi16(w0_w2, f_lo);
   v[1] = _mm_madd_epi16(w0_w2, f_hi);
   return SelfGuidedFinal(src, v);
 }
 
+template <int bitdepth>
 inline __m128i SelfGuidedSingleMultiplier(const __m128i src,
-                                          const __m128i filter, const int w0) {
+                                          const __m128i filter[2],
+                                          const int w0) {
   // weight: -96 to 96 (Sgrproj_Xqd_Min/Max)
   __m128i v[2];
-  v[0] = VmullNLo8(filter, w0);
-  v[1] = VmullNHi8(filter, w0);
+  if (bitdepth == kBitdepth12) {
+    v[0] = _mm_mullo_epi32(filter[0], _mm_set1_epi32(w0));
+    v[1] = _mm_mullo_epi32(filter[1], _mm_set1_epi32(w0));
+    return SelfGuidedFinal(src, v);
+  }
+  const __m128i f = _mm_packs_epi32(filter[0], filter[1]);
+  v[0] = VmullNLo8(f, w0);
+  v[1] = VmullNHi8(f, w0);
   return SelfGuidedFinal(src, v);
 }
 
+template <int bitdepth>
 inline void ClipAndStore(uint16_t* const dst, const __m128i val) {
   const __m128i val0 = _mm_max_epi16(val, _mm_setzero_si128());
-  const __m128i val1 = _mm_min_epi16(val0, _mm_set1_epi16(1023));
+  const __m128i val1 =
+      _mm_min_epi16(val0, _mm_set1_epi16((1 << bitdepth) - 1));
   StoreAligned16(dst, val1);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
     const uint16_t* const src, const uint16_t* const src0,
     const uint16_t* const src1, const ptrdiff_t stride, uint16_t* const sum5[5],
@@ -1851,11 +2047,12 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
   s[1][1] = LoadUnaligned16Msan(src1 + 8, overread_in_bytes + 16);
   Square(s[0][0], sq[0]);
   Square(s[1][0], sq[1]);
-  BoxFilterPreProcess5Lo(s, scale, sum5, square_sum5, sq, &mas[0], bs);
+  BoxFilterPreProcess5Lo<bitdepth>(s, scale, sum5, square_sum5, sq, &mas[0],
+                                   bs);
 
   int x = 0;
   do {
-    __m128i ma[2], ma5[3], b[2][2], p[2];
+    __m128i ma[2], ma5[3], b[2][2], p[2][2];
     s[0][2] = LoadUnaligned16Msan(src0 + x + 16,
                                   overread_in_bytes + sizeof(*src0) * (x + 16));
     s[0][3] = LoadUnaligned16Msan(src0 + x + 24,
@@ -1864,8 +2061,8 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
                                   overread_in_bytes + sizeof(*src1) * (x + 16));
     s[1][3] = LoadUnaligned16Msan(src1 + x + 24,
                                   overread_in_bytes + sizeof(*src1) * (x + 24));
-    BoxFilterPreProcess5(s, sum_width, x + 8, scale, sum5, square_sum5, sq, mas,
-                         bs);
+    BoxFilterPreProcess5<bitdepth>(s, sum_width, x + 8, scale, sum5,
+                                   square_sum5, sq, mas, bs);
     Prepare3_8<0>(mas, ma5);
     ma[1] = Sum565Lo(ma5);
     StoreAligned16(ma565[1] + x, ma[1]);
@@ -1875,10 +2072,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
     const __m128i sr1_lo = LoadAligned16(src + stride + x + 0);
     ma[0] = LoadAligned16(ma565[0] + x);
     LoadAligned32U32(b565[0] + x, b[0]);
-    p[0] = CalculateFilteredOutputPass1(sr0_lo, ma, b);
-    p[1] = CalculateFilteredOutput<4>(sr1_lo, ma[1], b[1]);
-    const __m128i d00 = SelfGuidedSingleMultiplier(sr0_lo, p[0], w0);
-    const __m128i d10 = SelfGuidedSingleMultiplier(sr1_lo, p[1], w0);
+    CalculateFilteredOutputPass1(sr0_lo, ma, b, p[0]);
+    CalculateFilteredOutput<4>(sr1_lo, ma[1], b[1], p[1]);
+    const __m128i d00 = SelfGuidedSingleMultiplier<bitdepth>(sr0_lo, p[0], w0);
+    const __m128i d10 = SelfGuidedSingleMultiplier<bitdepth>(sr1_lo, p[1], w0);
 
     ma[1] = Sum565Hi(ma5);
     StoreAligned16(ma565[1] + x + 8, ma[1]);
@@ -1888,14 +2085,14 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
     const __m128i sr1_hi = LoadAligned16(src + stride + x + 8);
     ma[0] = LoadAligned16(ma565[0] + x + 8);
     LoadAligned32U32(b565[0] + x + 8, b[0]);
-    p[0] = CalculateFilteredOutputPass1(sr0_hi, ma, b);
-    p[1] = CalculateFilteredOutput<4>(sr1_hi, ma[1], b[1]);
-    const __m128i d01 = SelfGuidedSingleMultiplier(sr0_hi, p[0], w0);
-    ClipAndStore(dst + x + 0, d00);
-    ClipAndStore(dst + x + 8, d01);
-    const __m128i d11 = SelfGuidedSingleMultiplier(sr1_hi, p[1], w0);
-    ClipAndStore(dst + stride + x + 0, d10);
-    ClipAndStore(dst + stride + x + 8, d11);
+    CalculateFilteredOutputPass1(sr0_hi, ma, b, p[0]);
+    CalculateFilteredOutput<4>(sr1_hi, ma[1], b[1], p[1]);
+    const __m128i d01 = SelfGuidedSingleMultiplier<bitdepth>(sr0_hi, p[0], w0);
+    ClipAndStore<bitdepth>(dst + x + 0, d00);
+    ClipAndStore<bitdepth>(dst + x + 8, d01);
+    const __m128i d11 = SelfGuidedSingleMultiplier<bitdepth>(sr1_hi, p[1], w0);
+    ClipAndStore<bitdepth>(dst + stride + x + 0, d10);
+    ClipAndStore<bitdepth>(dst + stride + x + 8, d11);
     s[0][0] = s[0][2];
     s[0][1] = s[0][3];
     s[1][0] = s[1][2];
@@ -1911,6 +2108,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass1(
   } while (x < width);
 }
 
+template <int bitdepth>
 inline void BoxFilterPass1LastRow(
     const uint16_t* const src, const uint16_t* const src0, const int width,
     const ptrdiff_t sum_width, const uint32_t scale, const int16_t w0,
@@ -1922,7 +2120,8 @@ inline void BoxFilterPass1LastRow(
   s[0] = LoadUnaligned16Msan(src0 + 0, overread_in_bytes + 0);
   s[1] = LoadUnaligned16Msan(src0 + 8, overread_in_bytes + 16);
   Square(s[0], sq);
-  BoxFilterPreProcess5LastRowLo(s, scale, sum5, square_sum5, sq, &mas[0], bs);
+  BoxFilterPreProcess5LastRowLo<bitdepth>(s, scale, sum5, square_sum5, sq,
+                                          &mas[0], bs);
 
   int x = 0;
   do {
@@ -1931,26 +2130,27 @@ inline void BoxFilterPass1LastRow(
                                overread_in_bytes + sizeof(*src0) * (x + 16));
     s[3] = LoadUnaligned16Msan(src0 + x + 24,
                                overread_in_bytes + sizeof(*src0) * (x + 24));
-    BoxFilterPreProcess5LastRow(s, sum_width, x + 8, scale, sum5, square_sum5,
-                                sq, mas, bs);
+    BoxFilterPreProcess5LastRow<bitdepth>(s, sum_width, x + 8, scale, sum5,
+                                          square_sum5, sq, mas, bs);
     Prepare3_8<0>(mas, ma5);
     ma[1] = Sum565Lo(ma5);
     Sum565(bs, b[1]);
     ma[0] = LoadAligned16(ma565);
     LoadAligned32U32(b565, b[0]);
     const __m128i sr_lo = LoadAligned16(src + x + 0);
-    __m128i p = CalculateFilteredOutputPass1(sr_lo, ma, b);
-    const __m128i d0 = SelfGuidedSingleMultiplier(sr_lo, p, w0);
+    __m128i p[2];
+    CalculateFilteredOutputPass1(sr_lo, ma, b, p);
+    const __m128i d0 = SelfGuidedSingleMultiplier<bitdepth>(sr_lo, p, w0);
 
     ma[1] = Sum565Hi(ma5);
     Sum565(bs + 2, b[1]);
     ma[0] = LoadAligned16(ma565 + 8);
     LoadAligned32U32(b565 + 8, b[0]);
     const __m128i sr_hi = LoadAligned16(src + x + 8);
-    p = CalculateFilteredOutputPass1(sr_hi, ma, b);
-    const __m128i d1 = SelfGuidedSingleMultiplier(sr_hi, p, w0);
-    ClipAndStore(dst + x + 0, d0);
-    ClipAndStore(dst + x + 8, d1);
+    CalculateFilteredOutputPass1(sr_hi, ma, b, p);
+    const __m128i d1 = SelfGuidedSingleMultiplier<bitdepth>(sr_hi, p, w0);
+    ClipAndStore<bitdepth>(dst + x + 0, d0);
+    ClipAndStore<bitdepth>(dst + x + 8, d1);
     s[1] = s[3];
     sq[2] = sq[6];
     sq[3] = sq[7];
@@ -1963,6 +2163,7 @@ inline void BoxFilterPass1LastRow(
   } while (x < width);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
     const uint16_t* const src, const uint16_t* const src0, const int width,
     const ptrdiff_t sum_width, const uint32_t scale, const int16_t w0,
@@ -1975,7 +2176,8 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
   s[0] = LoadUnaligned16Msan(src0 + 0, overread_in_bytes + 0);
   s[1] = LoadUnaligned16Msan(src0 + 8, overread_in_bytes + 16);
   Square(s[0], sq);
-  BoxFilterPreProcess3Lo(s, scale, sum3, square_sum3, sq, &mas[0], bs);
+  BoxFilterPreProcess3Lo<bitdepth>(s, scale, sum3, square_sum3, sq, &mas[0],
+                                   bs);
 
   int x = 0;
   do {
@@ -1983,8 +2185,8 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
                                overread_in_bytes + sizeof(*src0) * (x + 16));
     s[3] = LoadUnaligned16Msan(src0 + x + 24,
                                overread_in_bytes + sizeof(*src0) * (x + 24));
-    BoxFilterPreProcess3(s, x + 8, sum_width, scale, sum3, square_sum3, sq, mas,
-                         bs);
+    BoxFilterPreProcess3<bitdepth>(s, x + 8, sum_width, scale, sum3,
+                                   square_sum3, sq, mas, bs);
     __m128i ma[3], b[3][2], ma3[3];
     Prepare3_8<0>(mas, ma3);
     Store343_444Lo(ma3, bs + 0, x, &ma[2], b[2], ma343[2], ma444[1], b343[2],
@@ -1994,7 +2196,8 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
     ma[1] = LoadAligned16(ma444[0] + x);
     LoadAligned32U32(b343[0] + x, b[0]);
     LoadAligned32U32(b444[0] + x, b[1]);
-    const __m128i p0 = CalculateFilteredOutputPass2(sr_lo, ma, b);
+    __m128i p0[2];
+    CalculateFilteredOutputPass2(sr_lo, ma, b, p0);
 
     Store343_444Hi(ma3, bs + 2, x + 8, &ma[2], b[2], ma343[2], ma444[1],
                    b343[2], b444[1]);
@@ -2003,11 +2206,12 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
     ma[1] = LoadAligned16(ma444[0] + x + 8);
     LoadAligned32U32(b343[0] + x + 8, b[0]);
     LoadAligned32U32(b444[0] + x + 8, b[1]);
-    const __m128i p1 = CalculateFilteredOutputPass2(sr_hi, ma, b);
-    const __m128i d0 = SelfGuidedSingleMultiplier(sr_lo, p0, w0);
-    const __m128i d1 = SelfGuidedSingleMultiplier(sr_hi, p1, w0);
-    ClipAndStore(dst + x + 0, d0);
-    ClipAndStore(dst + x + 8, d1);
+    __m128i p1[2];
+    CalculateFilteredOutputPass2(sr_hi, ma, b, p1);
+    const __m128i d0 = SelfGuidedSingleMultiplier<bitdepth>(sr_lo, p0, w0);
+    const __m128i d1 = SelfGuidedSingleMultiplier<bitdepth>(sr_hi, p1, w0);
+    ClipAndStore<bitdepth>(dst + x + 0, d0);
+    ClipAndStore<bitdepth>(dst + x + 8, d1);
     s[1] = s[3];
     sq[2] = sq[6];
     sq[3] = sq[7];
@@ -2018,6 +2222,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterPass2(
   } while (x < width);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilter(
     const uint16_t* const src, const uint16_t* const src0,
     const uint16_t* const src1, const ptrdiff_t stride, const int width,
@@ -2036,12 +2241,12 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
   s[1][1] = LoadUnaligned16Msan(src1 + 8, overread_in_bytes + 16);
   Square(s[0][0], sq[0]);
   Square(s[1][0], sq[1]);
-  BoxFilterPreProcessLo(s, scales, sum3, sum5, square_sum3, square_sum5, sq,
-                        ma3, b3, &ma5[0], b5);
+  BoxFilterPreProcessLo<bitdepth>(s, scales, sum3, sum5, square_sum3,
+                                  square_sum5, sq, ma3, b3, &ma5[0], b5);
 
   int x = 0;
   do {
-    __m128i ma[3][3], b[3][3][2], p[2][2], ma3x[2][3], ma5x[3];
+    __m128i ma[3][3], b[3][3][2], p[2][2][2], ma3x[2][3], ma5x[3];
     s[0][2] = LoadUnaligned16Msan(src0 + x + 16,
                                   overread_in_bytes + sizeof(*src0) * (x + 16));
     s[0][3] = LoadUnaligned16Msan(src0 + x + 24,
@@ -2050,8 +2255,8 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
                                   overread_in_bytes + sizeof(*src1) * (x + 16));
     s[1][3] = LoadUnaligned16Msan(src1 + x + 24,
                                   overread_in_bytes + sizeof(*src1) * (x + 24));
-    BoxFilterPreProcess(s, x + 8, scales, sum3, sum5, square_sum3, square_sum5,
-                        sum_width, sq, ma3, b3, ma5, b5);
+    BoxFilterPreProcess<bitdepth>(s, x + 8, scales, sum3, sum5, square_sum3,
+                                  square_sum5, sum_width, sq, ma3, b3, ma5, b5);
     Prepare3_8<0>(ma3[0], ma3x[0]);
     Prepare3_8<0>(ma3[1], ma3x[1]);
     Prepare3_8<0>(ma5, ma5x);
@@ -2067,18 +2272,20 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
     const __m128i sr1_lo = LoadAligned16(src + stride + x);
     ma[0][0] = LoadAligned16(ma565[0] + x);
     LoadAligned32U32(b565[0] + x, b[0][0]);
-    p[0][0] = CalculateFilteredOutputPass1(sr0_lo, ma[0], b[0]);
-    p[1][0] = CalculateFilteredOutput<4>(sr1_lo, ma[0][1], b[0][1]);
+    CalculateFilteredOutputPass1(sr0_lo, ma[0], b[0], p[0][0]);
+    CalculateFilteredOutput<4>(sr1_lo, ma[0][1], b[0][1], p[1][0]);
     ma[1][0] = LoadAligned16(ma343[0] + x);
     ma[1][1] = LoadAligned16(ma444[0] + x);
     LoadAligned32U32(b343[0] + x, b[1][0]);
     LoadAligned32U32(b444[0] + x, b[1][1]);
-    p[0][1] = CalculateFilteredOutputPass2(sr0_lo, ma[1], b[1]);
-    const __m128i d00 = SelfGuidedDoubleMultiplier(sr0_lo, p[0], w0, w2);
+    CalculateFilteredOutputPass2(sr0_lo, ma[1], b[1], p[0][1]);
+    const __m128i d00 =
+        SelfGuidedDoubleMultiplier<bitdepth>(sr0_lo, p[0], w0, w2);
     ma[2][0] = LoadAligned16(ma343[1] + x);
     LoadAligned32U32(b343[1] + x, b[2][0]);
-    p[1][1] = CalculateFilteredOutputPass2(sr1_lo, ma[2], b[2]);
-    const __m128i d10 = SelfGuidedDoubleMultiplier(sr1_lo, p[1], w0, w2);
+    CalculateFilteredOutputPass2(sr1_lo, ma[2], b[2], p[1][1]);
+    const __m128i d10 =
+        SelfGuidedDoubleMultiplier<bitdepth>(sr1_lo, p[1], w0, w2);
 
     Store343_444Hi(ma3x[0], b3[0] + 2, x + 8, &ma[1][2], &ma[2][1], b[1][2],
                    b[2][1], ma343[2], ma444[1], b343[2], b444[1]);
@@ -2092,22 +2299,24 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
     const __m128i sr1_hi = LoadAligned16(src + stride + x + 8);
     ma[0][0] = LoadAligned16(ma565[0] + x + 8);
     LoadAligned32U32(b565[0] + x + 8, b[0][0]);
-    p[0][0] = CalculateFilteredOutputPass1(sr0_hi, ma[0], b[0]);
-    p[1][0] = CalculateFilteredOutput<4>(sr1_hi, ma[0][1], b[0][1]);
+    CalculateFilteredOutputPass1(sr0_hi, ma[0], b[0], p[0][0]);
+    CalculateFilteredOutput<4>(sr1_hi, ma[0][1], b[0][1], p[1][0]);
     ma[1][0] = LoadAligned16(ma343[0] + x + 8);
     ma[1][1] = LoadAligned16(ma444[0] + x + 8);
     LoadAligned32U32(b343[0] + x + 8, b[1][0]);
     LoadAligned32U32(b444[0] + x + 8, b[1][1]);
-    p[0][1] = CalculateFilteredOutputPass2(sr0_hi, ma[1], b[1]);
-    const __m128i d01 = SelfGuidedDoubleMultiplier(sr0_hi, p[0], w0, w2);
-    ClipAndStore(dst + x + 0, d00);
-    ClipAndStore(dst + x + 8, d01);
+    CalculateFilteredOutputPass2(sr0_hi, ma[1], b[1], p[0][1]);
+    const __m128i d01 =
+        SelfGuidedDoubleMultiplier<bitdepth>(sr0_hi, p[0], w0, w2);
+    ClipAndStore<bitdepth>(dst + x + 0, d00);
+    ClipAndStore<bitdepth>(dst + x + 8, d01);
     ma[2][0] = LoadAligned16(ma343[1] + x + 8);
     LoadAligned32U32(b343[1] + x + 8, b[2][0]);
-    p[1][1] = CalculateFilteredOutputPass2(sr1_hi, ma[2], b[2]);
-    const __m128i d11 = SelfGuidedDoubleMultiplier(sr1_hi, p[1], w0, w2);
-    ClipAndStore(dst + stride + x + 0, d10);
-    ClipAndStore(dst + stride + x + 8, d11);
+    CalculateFilteredOutputPass2(sr1_hi, ma[2], b[2], p[1][1]);
+    const __m128i d11 =
+        SelfGuidedDoubleMultiplier<bitdepth>(sr1_hi, p[1], w0, w2);
+    ClipAndStore<bitdepth>(dst + stride + x + 0, d10);
+    ClipAndStore<bitdepth>(dst + stride + x + 8, d11);
     s[0][0] = s[0][2];
     s[0][1] = s[0][3];
     s[1][0] = s[1][2];
@@ -2129,6 +2338,7 @@ LIBGAV1_ALWAYS_INLINE void BoxFilter(
   } while (x < width);
 }
 
+template <int bitdepth>
 inline void BoxFilterLastRow(
     const uint16_t* const src, const uint16_t* const src0, const int width,
     const ptrdiff_t sum_width, const uint16_t scales[2], const int16_t w0,
@@ -2143,18 +2353,20 @@ inline void BoxFilterLastRow(
   s[0] = LoadUnaligned16Msan(src0 + 0, overread_in_bytes + 0);
   s[1] = LoadUnaligned16Msan(src0 + 8, overread_in_bytes + 16);
   Square(s[0], sq);
-  BoxFilterPreProcessLastRowLo(s, scales, sum3, sum5, square_sum3, square_sum5,
-                               sq, &ma3[0], &ma5[0], b3, b5);
+  BoxFilterPreProcessLastRowLo<bitdepth>(s, scales, sum3, sum5, square_sum3,
+                                         square_sum5, sq, &ma3[0], &ma5[0], b3,
+                                         b5);
 
   int x = 0;
   do {
-    __m128i ma3x[3], ma5x[3], p[2];
+    __m128i ma3x[3], ma5x[3], p[2][2];
     s[2] = LoadUnaligned16Msan(src0 + x + 16,
                                overread_in_bytes + sizeof(*src0) * (x + 16));
     s[3] = LoadUnaligned16Msan(src0 + x + 24,
                                overread_in_bytes + sizeof(*src0) * (x + 24));
-    BoxFilterPreProcessLastRow(s, sum_width, x + 8, scales, sum3, sum5,
-                               square_sum3, square_sum5, sq, ma3, ma5, b3, b5);
+    BoxFilterPreProcessLastRow<bitdepth>(s, sum_width, x + 8, scales, sum3,
+                                         sum5, square_sum3, square_sum5, sq,
+                                         ma3, ma5, b3, b5);
     Prepare3_8<0>(ma3, ma3x);
     Prepare3_8<0>(ma5, ma5x);
     ma[1] = Sum565Lo(ma5x);
@@ -2164,13 +2376,13 @@ inline void BoxFilterLastRow(
     const __m128i sr_lo = LoadAligned16(src + x + 0);
     ma[0] = LoadAligned16(ma565 + x);
     LoadAligned32U32(b565 + x, b[0]);
-    p[0] = CalculateFilteredOutputPass1(sr_lo, ma, b);
+    CalculateFilteredOutputPass1(sr_lo, ma, b, p[0]);
     ma[0] = LoadAligned16(ma343 + x);
     ma[1] = LoadAligned16(ma444 + x);
     LoadAligned32U32(b343 + x, b[0]);
     LoadAligned32U32(b444 + x, b[1]);
-    p[1] = CalculateFilteredOutputPass2(sr_lo, ma, b);
-    const __m128i d0 = SelfGuidedDoubleMultiplier(sr_lo, p, w0, w2);
+    CalculateFilteredOutputPass2(sr_lo, ma, b, p[1]);
+    const __m128i d0 = SelfGuidedDoubleMultiplier<bitdepth>(sr_lo, p, w0, w2);
 
     ma[1] = Sum565Hi(ma5x);
     Sum565(b5 + 2, b[1]);
@@ -2179,15 +2391,15 @@ inline void BoxFilterLastRow(
     const __m128i sr_hi = LoadAligned16(src + x + 8);
     ma[0] = LoadAligned16(ma565 + x + 8);
     LoadAligned32U32(b565 + x + 8, b[0]);
-    p[0] = CalculateFilteredOutputPass1(sr_hi, ma, b);
+    CalculateFilteredOutputPass1(sr_hi, ma, b, p[0]);
     ma[0] = LoadAligned16(ma343 + x + 8);
     ma[1] = LoadAligned16(ma444 + x + 8);
     LoadAligned32U32(b343 + x + 8, b[0]);
     LoadAligned32U32(b444 + x + 8, b[1]);
-    p[1] = CalculateFilteredOutputPass2(sr_hi, ma, b);
-    const __m128i d1 = SelfGuidedDoubleMultiplier(sr_hi, p, w0, w2);
-    ClipAndStore(dst + x + 0, d0);
-    ClipAndStore(dst + x + 8, d1);
+    CalculateFilteredOutputPass2(sr_hi, ma, b, p[1]);
+    const __m128i d1 = SelfGuidedDoubleMultiplier<bitdepth>(sr_hi, p, w0, w2);
+    ClipAndStore<bitdepth>(dst + x + 0, d0);
+    ClipAndStore<bitdepth>(dst + x + 8, d1);
     s[1] = s[3];
     sq[2] = sq[6];
     sq[3] = sq[7];
@@ -2201,6 +2413,7 @@ inline void BoxFilterLastRow(
   } while (x < width);
 }
 
+template <int bitdepth>
 LIBGAV1_ALWAYS_INLINE void BoxFilterProcess(
     const RestorationUnitInfo& restoration_info, const uint16_t* src,
     const ptrdiff_t stride, const uint16_t* const top_border,
@@ -2250,9 +2463,9 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterProcess(
   sum5[0] = sum5[1];
   square_sum5[0] = square_sum5[1];
   const uint16_t* const s = (height > 1) ? src + stride : bottom_border;
-  BoxSumFilterPreProcess(src, s, width, scales, sum3, sum5, square_sum3,
-                         square_sum5, sum_width, ma343, ma444[0], ma565[0],
-                         b343, b444[0], b565[0]);
+  BoxSumFilterPreProcess<bitdepth>(src, s, width, scales, sum3, sum5,
+                                   square_sum3, square_sum5, sum_width, ma343,
+                                   ma444[0], ma565[0], b343, b444[0], b565[0]);
   sum5[0] = sgr_buffer->sum5;
   square_sum5[0] = sgr_buffer->square_sum5;
 
@@ -2261,9 +2474,10 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterProcess(
     Circulate4PointersBy2<uint32_t>(square_sum3);
     Circulate5PointersBy2<uint16_t>(sum5);
     Circulate5PointersBy2<uint32_t>(square_sum5);
-    BoxFilter(src + 3, src + 2 * stride, src + 3 * stride, stride, width,
-              scales, w0, w2, sum3, sum5, square_sum3, square_sum5, sum_width,
-              ma343, ma444, ma565, b343, b444, b565, dst);
+    BoxFilter<bitdepth>(src + 3, src + 2 * stride, src + 3 * stride, stride,
+                        width, scales, w0, w2, sum3, sum5, square_sum3,
+                        square_sum5, sum_width, ma343, ma444, ma565, b343, b444,
+                        b565, dst);
     src += 2 * stride;
     dst += 2 * stride;
     Circulate4PointersBy2<uint16_t>(ma343);
@@ -2287,9 +2501,9 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterProcess(
       sr[0] = src + 2 * stride;
       sr[1] = bottom_border;
     }
-    BoxFilter(src + 3, sr[0], sr[1], stride, width, scales, w0, w2, sum3, sum5,
-              square_sum3, square_sum5, sum_width, ma343, ma444, ma565, b343,
-              b444, b565, dst);
+    BoxFilter<bitdepth>(src + 3, sr[0], sr[1], stride, width, scales, w0, w2,
+                        sum3, sum5, square_sum3, square_sum5, sum_width, ma343,
+                        ma444, ma565, b343, b444, b565, dst);
   }
   if ((height & 1) != 0) {
     if (height > 1) {
@@ -2306,13 +2520,14 @@ LIBGAV1_ALWAYS_INLINE void BoxFilterProcess(
       std::swap(ma565[0], ma565[1]);
       std::swap(b565[0], b565[1]);
     }
-    BoxFilterLastRow(src + 3, bottom_border + bottom_border_stride, width,
-                     sum_width, scales, w0, w2, sum3, sum5, square_sum3,
-                     square_sum5, ma343[0], ma444[0], ma565[0], b343[0],
-                     b444[0], b565[0], dst);
+    BoxFilterLastRow<bitdepth>(src + 3, bottom_border + bottom_border_stride,
+                               width, sum_width, scales, w0, w2, sum3, sum5,
+                               square_sum3, square_sum5, ma343[0], ma444[0],
+                               ma565[0], b343[0], b444[0], b565[0], dst);
   }
 }
 
+template <int bitdepth>
 inline void BoxFilterProcessPass1(const RestorationUnitInfo& restoration_info,
                                   const uint16_t* src, const ptrdiff_t stride,
                                   const uint16_t* const top_border,
@@ -2345,16 +2560,17 @@ inline void BoxFilterProcessPass1(const RestorationUnitInfo& restoration_info,
   sum5[0] = sum5[1];
   square_sum5[0] = square_sum5[1];
   const uint16_t* const s = (height > 1) ? src + stride : bottom_border;
-  BoxSumFilterPreProcess5(src, s, width, scale, sum5, square_sum5, sum_width,
-                          ma565[0], b565[0]);
+  BoxSumFilterPreProcess5<bitdepth>(src, s, width, scale, sum5, square_sum5,
+                                    sum_width, ma565[0], b565[0]);
   sum5[0] = sgr_buffer->sum5;
   square_sum5[0] = sgr_buffer->square_sum5;
 
   for (int y = (height >> 1) - 1; y > 0; --y) {
     Circulate5PointersBy2<uint16_t>(sum5);
     Circulate5PointersBy2<uint32_t>(square_sum5);
-    BoxFilterPass1(src + 3, src + 2 * stride, src + 3 * stride, stride, sum5,
-                   square_sum5, width, sum_width, scale, w0, ma565, b565, dst);
+    BoxFilterPass1<bitdepth>(src + 3, src + 2 * stride, src + 3 * stride,
+                             stride, sum5, square_sum5, width, sum_width, scale,
+                             w0, ma565, b565, dst);
     src += 2 * stride;
     dst += 2 * stride;
     std::swap(ma565[0], ma565[1]);
@@ -2372,8 +2588,8 @@ inline void BoxFilterProcessPass1(const RestorationUnitInfo& restoration_info,
       sr[0] = src + 2 * stride;
       sr[1] = bottom_border;
     }
-    BoxFilterPass1(src + 3, sr[0], sr[1], stride, sum5, square_sum5, width,
-                   sum_width, scale, w0, ma565, b565, dst);
+    BoxFilterPass1<bitdepth>(src + 3, sr[0], sr[1], stride, sum5, square_sum5,
+                             width, sum_width, scale, w0, ma565, b565, dst);
   }
   if ((height & 1) != 0) {
     src += 3;
@@ -2385,12 +2601,13 @@ inline void BoxFilterProcessPass1(const RestorationUnitInfo& restoration_info,
       Circulate5PointersBy2<uint16_t>(sum5);
       Circulate5PointersBy2<uint32_t>(square_sum5);
     }
-    BoxFilterPass1LastRow(src, bottom_border + bottom_border_stride, width,
-                          sum_width, scale, w0, sum5, square_sum5, ma565[0],
-                          b565[0], dst);
+    BoxFilterPass1LastRow<bitdepth>(src, bottom_border + bottom_border_stride,
+                                    width, sum_width, scale, w0, sum5,
+                                    square_sum5, ma565[0], b565[0], dst);
   }
 }
 
+template <int bitdepth>
 inline void BoxFilterProcessPass2(const RestorationUnitInfo& restoration_info,
                                   const uint16_t* src, const ptrdiff_t stride,
                                   const uint16_t* const top_border,
@@ -2426,9 +2643,9 @@ inline void BoxFilterProcessPass2(const RestorationUnitInfo& restoration_info,
   assert(scale != 0);
   BoxSum<3>(top_border, top_border_stride, width, sum_stride, sum_width,
             sum3[0], square_sum3[0]);
-  BoxSumFilterPreProcess3<false>(src, width, scale, sum3, square_sum3,
-                                 sum_width, ma343[0], nullptr, b343[0],
-                                 nullptr);
+  BoxSumFilterPreProcess3<bitdepth, false>(src, width, scale, sum3, square_sum3,
+                                           sum_width, ma343[0], nullptr,
+                                           b343[0], nullptr);
   Circulate3PointersBy1<uint16_t>(sum3);
   Circulate3PointersBy1<uint32_t>(square_sum3);
   const uint16_t* s;
@@ -2438,14 +2655,16 @@ inline void BoxFilterProcessPass2(const RestorationUnitInfo& restoration_info,
     s = bottom_border;
     bottom_border += bottom_border_stride;
   }
-  BoxSumFilterPreProcess3<true>(s, width, scale, sum3, square_sum3, sum_width,
-                                ma343[1], ma444[0], b343[1], b444[0]);
+  BoxSumFilterPreProcess3<bitdepth, true>(s, width, scale, sum3, square_sum3,
+                                          sum_width, ma343[1], ma444[0],
+                                          b343[1], b444[0]);
 
   for (int y = height - 2; y > 0; --y) {
     Circulate3PointersBy1<uint16_t>(sum3);
     Circulate3PointersBy1<uint32_t>(square_sum3);
-    BoxFilterPass2(src + 2, src + 2 * stride, width, sum_width, scale, w0, sum3,
-                   square_sum3, ma343, ma444, b343, b444, dst);
+    BoxFilterPass2<bitdepth>(src + 2, src + 2 * stride, width, sum_width, scale,
+                             w0, sum3, square_sum3, ma343, ma444, b343, b444,
+                             dst);
     src += stride;
     dst += stride;
     Circulate3PointersBy1<uint16_t>(ma343);
@@ -2459,8 +2678,8 @@ inline void BoxFilterProcessPass2(const RestorationUnitInfo& restoration_info,
   do {
     Circulate3PointersBy1<uint16_t>(sum3);
     Circulate3PointersBy1<uint32_t>(square_sum3);
-    BoxFilterPass2(src, bottom_border, width, sum_width, scale, w0, sum3,
-                   square_sum3, ma343, ma444, b343, b444, dst);
+    BoxFilterPass2<bitdepth>(src, bottom_border, width, sum_width, scale, w0,
+                             sum3, square_sum3, ma343, ma444, b343, b444, dst);
     src += stride;
     dst += stride;
     bottom_border += bottom_border_stride;
@@ -2474,6 +2693,7 @@ inline void BoxFilterProcessPass2(const RestorationUnitInfo& restoration_info,
 // If |width| is non-multiple of 16, up to 15 more pixels are written to |dest|
 // in the end of each row. It is safe to overwrite the output as it will not be
 // part of the visible frame.
+template <int bitdepth>
 void SelfGuidedFilter_SSE4_1(
     const RestorationUnitInfo& LIBGAV1_RESTRICT restoration_info,
     const void* LIBGAV1_RESTRICT const source, const ptrdiff_t stride,
@@ -2495,17 +2715,17 @@ void SelfGuidedFilter_SSE4_1(
     // |radius_pass_0| and |radius_pass_1| cannot both be 0, so we have the
     // following assertion.
     assert(radius_pass_0 != 0);
-    BoxFilterProcessPass1(restoration_info, src - 3, stride, top - 3,
-                          top_border_stride, bottom - 3, bottom_border_stride,
-                          width, height, sgr_buffer, dst);
+    BoxFilterProcessPass1<bitdepth>(
+        restoration_info, src - 3, stride, top - 3, top_border_stride,
+        bottom - 3, bottom_border_stride, width, height, sgr_buffer, dst);
   } else if (radius_pass_0 == 0) {
-    BoxFilterProcessPass2(restoration_info, src - 2, stride, top - 2,
-                          top_border_stride, bottom - 2, bottom_border_stride,
-                          width, height, sgr_buffer, dst);
+    BoxFilterProcessPass2<bitdepth>(
+        restoration_info, src - 2, stride, top - 2, top_border_stride,
+        bottom - 2, bottom_border_stride, width, height, sgr_buffer, dst);
   } else {
-    BoxFilterProcess(restoration_info, src - 3, stride, top - 3,
-                     top_border_stride, bottom - 3, bottom_border_stride, width,
-                     height, sgr_buffer, dst);
+    BoxFilterProcess<bitdepth>(
+        restoration_info, src - 3, stride, top - 3, top_border_stride,
+        bottom - 3, bottom_border_stride, width, height, sgr_buffer, dst);
   }
 }
 
@@ -2514,20 +2734,43 @@ void Init10bpp() {
   assert(dsp != nullptr);
   static_cast<void>(dsp);
 #if DSP_ENABLED_10BPP_SSE4_1(WienerFilter)
-  dsp->loop_restorations[0] = WienerFilter_SSE4_1;
+  dsp->loop_restorations[0] = WienerFilter_SSE4_1<kBitdepth10>;
 #else
-  static_cast<void>(WienerFilter_SSE4_1);
+  static_cast<void>(WienerFilter_SSE4_1<kBitdepth10>);
 #endif
 #if DSP_ENABLED_10BPP_SSE4_1(SelfGuidedFilter)
-  dsp->loop_restorations[1] = SelfGuidedFilter_SSE4_1;
+  dsp->loop_restorations[1] = SelfGuidedFilter_SSE4_1<kBitdepth10>;
 #else
-  static_cast<void>(SelfGuidedFilter_SSE4_1);
+  static_cast<void>(SelfGuidedFilter_SSE4_1<kBitdepth10>);
 #endif
 }
 
+#if LIBGAV1_MAX_BITDEPTH == 12
+void Init12bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth12);
+  assert(dsp != nullptr);
+  static_cast<void>(dsp);
+#if DSP_ENABLED_12BPP_SSE4_1(WienerFilter)
+  dsp->loop_restorations[0] = WienerFilter_SSE4_1<kBitdepth12>;
+#else
+  static_cast<void>(WienerFilter_SSE4_1<kBitdepth12>);
+#endif
+#if DSP_ENABLED_12BPP_SSE4_1(SelfGuidedFilter)
+  dsp->loop_restorations[1] = SelfGuidedFilter_SSE4_1<kBitdepth12>;
+#else
+  static_cast<void>(SelfGuidedFilter_SSE4_1<kBitdepth12>);
+#endif
+}
+#endif  // LIBGAV1_MAX_BITDEPTH == 12
+
 }  // namespace
 
-void LoopRestorationInit10bpp_SSE4_1() { Init10bpp(); }
+void LoopRestorationInit10bpp_SSE4_1() {
+  Init10bpp();
+#if LIBGAV1_MAX_BITDEPTH == 12
+  Init12bpp();
+#endif
+}
 
 }  // namespace dsp
 }  // namespace libgav1
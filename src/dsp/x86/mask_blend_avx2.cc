@@ -0,0 +1,453 @@
+// Copyright 2023 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "src/dsp/mask_blend.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+// Every step below covers 16 output pixels. When the block is narrower than
+// 16 the step spans 16 / |width| rows, so a 4xH block takes 4 rows at once
+// and an 8xH block takes 2.
+inline int RowsPerStep(const int width) {
+  return (width >= 16) ? 1 : 16 / width;
+}
+
+// Loads 16 bytes made up of rows of |row_bytes| (4, 8 or 16) bytes.
+inline __m128i LoadBytes16(const uint8_t* const src, const ptrdiff_t stride,
+                           const int row_bytes) {
+  if (row_bytes >= 16) return LoadUnaligned16(src);
+  if (row_bytes == 8) return LoadHi8(LoadLo8(src), src + stride);
+  assert(row_bytes == 4);
+  return _mm_unpacklo_epi64(Load4x2(src, src + stride),
+                            Load4x2(src + 2 * stride, src + 3 * stride));
+}
+
+// Loads 32 bytes made up of rows of |row_bytes| (8, 16 or 32) bytes.
+inline __m256i LoadBytes32(const uint8_t* const src, const ptrdiff_t stride,
+                           const int row_bytes) {
+  if (row_bytes >= 32) return LoadUnaligned32(src);
+  const int rows = 16 / row_bytes;
+  return SetrM128i(LoadBytes16(src, stride, row_bytes),
+                   LoadBytes16(src + rows * stride, stride, row_bytes));
+}
+
+// Loads 16 16-bit predictions made up of rows of |width| (4, 8 or 16)
+// values.
+template <typename PredType>
+inline __m256i LoadPred16(const PredType* const pred, const ptrdiff_t stride,
+                          const int width) {
+  static_assert(sizeof(PredType) == 2, "");
+  if (width >= 16) return LoadUnaligned32(pred);
+  if (width == 8) {
+    return SetrM128i(LoadUnaligned16(pred), LoadUnaligned16(pred + stride));
+  }
+  assert(width == 4);
+  return SetrM128i(LoadHi8(LoadLo8(pred), pred + stride),
+                   LoadHi8(LoadLo8(pred + 2 * stride), pred + 3 * stride));
+}
+
+// Returns the 16 mask values for the current step as 16-bit values, averaging
+// the subsampled positions as GetMaskValue() in mask_blend.cc does.
+template <int subsampling_x, int subsampling_y>
+inline __m256i GetMask16(const uint8_t* LIBGAV1_RESTRICT mask,
+                         const ptrdiff_t mask_stride, const int width) {
+  const ptrdiff_t row_stride = mask_stride << subsampling_y;
+  if (subsampling_x == 0) {
+    return _mm256_cvtepu8_epi16(LoadBytes16(mask, row_stride, width));
+  }
+  const __m256i ones = _mm256_set1_epi8(1);
+  __m256i sum = _mm256_maddubs_epi16(LoadBytes32(mask, row_stride, width << 1),
+                                     ones);
+  if (subsampling_y == 1) {
+    sum = _mm256_add_epi16(
+        sum, _mm256_maddubs_epi16(
+                 LoadBytes32(mask + mask_stride, row_stride, width << 1),
+                 ones));
+  }
+  return RightShiftWithRounding_S16(sum, subsampling_x + subsampling_y);
+}
+
+// Stores 16 8-bit pixels held as 16-bit values in rows of |width| (4, 8 or
+// 16).
+inline void StorePixels16(uint8_t* LIBGAV1_RESTRICT dst,
+                          const ptrdiff_t dst_stride, const int width,
+                          const __m256i& res) {
+  const __m128i result_pixels = _mm_packus_epi16(
+      _mm256_castsi256_si128(res), _mm256_extracti128_si256(res, 1));
+  if (width >= 16) {
+    StoreUnaligned16(dst, result_pixels);
+    return;
+  }
+  if (width == 8) {
+    StoreLo8(dst, result_pixels);
+    StoreHi8(dst + dst_stride, result_pixels);
+    return;
+  }
+  assert(width == 4);
+  Store4(dst, result_pixels);
+  const int result_1 = _mm_extract_epi32(result_pixels, 1);
+  memcpy(dst + dst_stride, &result_1, sizeof(result_1));
+  const int result_2 = _mm_extract_epi32(result_pixels, 2);
+  memcpy(dst + 2 * dst_stride, &result_2, sizeof(result_2));
+  const int result_3 = _mm_extract_epi32(result_pixels, 3);
+  memcpy(dst + 3 * dst_stride, &result_3, sizeof(result_3));
+}
+
+// Packs two steps of 16-bit values into 32 8-bit pixels in order.
+inline __m256i PackPixels32(const __m256i& res_0, const __m256i& res_1) {
+  // packus works within 128-bit lanes; restore the order.
+  return _mm256_permute4x64_epi64(_mm256_packus_epi16(res_0, res_1), 0xd8);
+}
+
+}  // namespace
+
+namespace low_bitdepth {
+namespace {
+
+constexpr int kRoundBitsMaskBlend = 4;
+
+// (mask * pred_0 + (64 - mask) * pred_1) >> 6, rounded down by
+// kRoundBitsMaskBlend bits.
+inline __m256i MaskBlend16(const int16_t* LIBGAV1_RESTRICT pred_0,
+                           const int16_t* LIBGAV1_RESTRICT pred_1,
+                           const int width, const __m256i& pred_mask_0) {
+  const __m256i pred_mask_1 =
+      _mm256_sub_epi16(_mm256_set1_epi16(64), pred_mask_0);
+  const __m256i pred_val_0 = LoadPred16(pred_0, width, width);
+  const __m256i pred_val_1 = LoadPred16(pred_1, width, width);
+  const __m256i compound_pred_lo = _mm256_madd_epi16(
+      _mm256_unpacklo_epi16(pred_val_0, pred_val_1),
+      _mm256_unpacklo_epi16(pred_mask_0, pred_mask_1));
+  const __m256i compound_pred_hi = _mm256_madd_epi16(
+      _mm256_unpackhi_epi16(pred_val_0, pred_val_1),
+      _mm256_unpackhi_epi16(pred_mask_0, pred_mask_1));
+  // Negative values saturate to 0, which remains 0 after rounding.
+  const __m256i compound_pred =
+      _mm256_packus_epi32(_mm256_srai_epi32(compound_pred_lo, 6),
+                          _mm256_srai_epi32(compound_pred_hi, 6));
+  return RightShiftWithRounding_S16(compound_pred, kRoundBitsMaskBlend);
+}
+
+template <int subsampling_x, int subsampling_y>
+void MaskBlend_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                    const void* LIBGAV1_RESTRICT prediction_1,
+                    const ptrdiff_t /*prediction_stride_1*/,
+                    const uint8_t* LIBGAV1_RESTRICT const mask_ptr,
+                    const ptrdiff_t mask_stride, const int width,
+                    const int height, void* LIBGAV1_RESTRICT dest,
+                    const ptrdiff_t dst_stride) {
+  auto* dst = static_cast<uint8_t*>(dest);
+  const auto* pred_0 = static_cast<const int16_t*>(prediction_0);
+  const auto* pred_1 = static_cast<const int16_t*>(prediction_1);
+  const uint8_t* mask = mask_ptr;
+  const int rows = RowsPerStep(width);
+  int y = 0;
+  do {
+    if (width >= 32) {
+      int x = 0;
+      do {
+        const __m256i res_0 = MaskBlend16(
+            pred_0 + x, pred_1 + x, width,
+            GetMask16<subsampling_x, subsampling_y>(
+                mask + (x << subsampling_x), mask_stride, width));
+        const __m256i res_1 = MaskBlend16(
+            pred_0 + x + 16, pred_1 + x + 16, width,
+            GetMask16<subsampling_x, subsampling_y>(
+                mask + ((x + 16) << subsampling_x), mask_stride, width));
+        StoreUnaligned32(dst + x, PackPixels32(res_0, res_1));
+        x += 32;
+      } while (x < width);
+    } else {
+      StorePixels16(dst, dst_stride, width,
+                    MaskBlend16(pred_0, pred_1, width,
+                                GetMask16<subsampling_x, subsampling_y>(
+                                    mask, mask_stride, width)));
+    }
+    dst += dst_stride * rows;
+    mask += (mask_stride << subsampling_y) * rows;
+    pred_0 += width * rows;
+    pred_1 += width * rows;
+    y += rows;
+  } while (y < height);
+}
+
+// RightShiftWithRounding(mask * pred_1 + (64 - mask) * pred_0, 6). The sum
+// is at most 64 * 255, so it fits in 16 bits.
+inline __m256i InterIntraMaskBlend16(
+    const uint8_t* LIBGAV1_RESTRICT pred_0,
+    const uint8_t* LIBGAV1_RESTRICT pred_1, const ptrdiff_t pred_stride_1,
+    const int width, const __m256i& pred_mask_1) {
+  const __m256i pred_mask_0 =
+      _mm256_sub_epi16(_mm256_set1_epi16(64), pred_mask_1);
+  const __m256i pred_val_0 =
+      _mm256_cvtepu8_epi16(LoadBytes16(pred_0, width, width));
+  const __m256i pred_val_1 =
+      _mm256_cvtepu8_epi16(LoadBytes16(pred_1, pred_stride_1, width));
+  const __m256i sum =
+      _mm256_add_epi16(_mm256_mullo_epi16(pred_val_0, pred_mask_0),
+                       _mm256_mullo_epi16(pred_val_1, pred_mask_1));
+  return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(32)), 6);
+}
+
+template <int subsampling_x, int subsampling_y>
+void InterIntraMaskBlend8bpp_AVX2(
+    const uint8_t* LIBGAV1_RESTRICT prediction_0,
+    uint8_t* LIBGAV1_RESTRICT prediction_1, const ptrdiff_t prediction_stride_1,
+    const uint8_t* LIBGAV1_RESTRICT const mask_ptr, const ptrdiff_t mask_stride,
+    const int width, const int height) {
+  const uint8_t* mask = mask_ptr;
+  const int rows = RowsPerStep(width);
+  int y = 0;
+  do {
+    if (width >= 32) {
+      int x = 0;
+      do {
+        const __m256i res_0 = InterIntraMaskBlend16(
+            prediction_0 + x, prediction_1 + x, prediction_stride_1, width,
+            GetMask16<subsampling_x, subsampling_y>(
+                mask + (x << subsampling_x), mask_stride, width));
+        const __m256i res_1 = InterIntraMaskBlend16(
+            prediction_0 + x + 16, prediction_1 + x + 16, prediction_stride_1,
+            width,
+            GetMask16<subsampling_x, subsampling_y>(
+                mask + ((x + 16) << subsampling_x), mask_stride, width));
+        StoreUnaligned32(prediction_1 + x, PackPixels32(res_0, res_1));
+        x += 32;
+      } while (x < width);
+    } else {
+      StorePixels16(
+          prediction_1, prediction_stride_1, width,
+          InterIntraMaskBlend16(prediction_0, prediction_1,
+                                prediction_stride_1, width,
+                                GetMask16<subsampling_x, subsampling_y>(
+                                    mask, mask_stride, width)));
+    }
+    mask += (mask_stride << subsampling_y) * rows;
+    prediction_0 += width * rows;
+    prediction_1 += prediction_stride_1 * rows;
+    y += rows;
+  } while (y < height);
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX2(MaskBlend444)
+  dsp->mask_blend[0][0] = MaskBlend_AVX2<0, 0>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(MaskBlend422)
+  dsp->mask_blend[1][0] = MaskBlend_AVX2<1, 0>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(MaskBlend420)
+  dsp->mask_blend[2][0] = MaskBlend_AVX2<1, 1>;
+#endif
+  // The is_inter_intra index of mask_blend is not used in 8bpp. Instead
+  // inter_intra_mask_blend_8bpp is used.
+#if DSP_ENABLED_8BPP_AVX2(InterIntraMaskBlend8bpp444)
+  dsp->inter_intra_mask_blend_8bpp[0] = InterIntraMaskBlend8bpp_AVX2<0, 0>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(InterIntraMaskBlend8bpp422)
+  dsp->inter_intra_mask_blend_8bpp[1] = InterIntraMaskBlend8bpp_AVX2<1, 0>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(InterIntraMaskBlend8bpp420)
+  dsp->inter_intra_mask_blend_8bpp[2] = InterIntraMaskBlend8bpp_AVX2<1, 1>;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+constexpr int kRoundBitsMaskBlend = 4;
+constexpr int kMax10bppSample = (1 << kBitdepth10) - 1;
+
+// Stores 16 10-bit pixels in rows of |width| (4, 8 or 16).
+inline void StorePixels16(uint16_t* LIBGAV1_RESTRICT dst,
+                          const ptrdiff_t dst_stride, const int width,
+                          const __m256i& res) {
+  if (width >= 16) {
+    StoreUnaligned32(dst, res);
+    return;
+  }
+  const __m128i res_lo = _mm256_castsi256_si128(res);
+  const __m128i res_hi = _mm256_extracti128_si256(res, 1);
+  if (width == 8) {
+    StoreUnaligned16(dst, res_lo);
+    StoreUnaligned16(dst + dst_stride, res_hi);
+    return;
+  }
+  assert(width == 4);
+  StoreLo8(dst, res_lo);
+  StoreHi8(dst + dst_stride, res_lo);
+  StoreLo8(dst + 2 * dst_stride, res_hi);
+  StoreHi8(dst + 3 * dst_stride, res_hi);
+}
+
+// Compound predictions use the full 16-bit range, so they are biased into
+// the signed range before madd. The weights sum to 64, so the bias removes
+// 64 * 32768, which is exactly 32768 after the shift by 6.
+inline __m256i MaskBlend16(const uint16_t* LIBGAV1_RESTRICT pred_0,
+                           const uint16_t* LIBGAV1_RESTRICT pred_1,
+                           const ptrdiff_t pred_stride_1, const int width,
+                           const __m256i& pred_mask_0) {
+  const __m256i pred_mask_1 =
+      _mm256_sub_epi16(_mm256_set1_epi16(64), pred_mask_0);
+  const __m256i sign_bias = _mm256_set1_epi16(static_cast<int16_t>(0x8000));
+  const __m256i pred_val_0 =
+      _mm256_xor_si256(LoadPred16(pred_0, width, width), sign_bias);
+  const __m256i pred_val_1 =
+      _mm256_xor_si256(LoadPred16(pred_1, pred_stride_1, width), sign_bias);
+  const __m256i compound_pred_lo = _mm256_madd_epi16(
+      _mm256_unpacklo_epi16(pred_val_0, pred_val_1),
+      _mm256_unpacklo_epi16(pred_mask_0, pred_mask_1));
+  const __m256i compound_pred_hi = _mm256_madd_epi16(
+      _mm256_unpackhi_epi16(pred_val_0, pred_val_1),
+      _mm256_unpackhi_epi16(pred_mask_0, pred_mask_1));
+  const __m256i offset =
+      _mm256_set1_epi32(32768 - kCompoundOffset +
+                        ((1 << kRoundBitsMaskBlend) >> 1));
+  const __m256i res_lo = _mm256_srai_epi32(
+      _mm256_add_epi32(_mm256_srai_epi32(compound_pred_lo, 6), offset),
+      kRoundBitsMaskBlend);
+  const __m256i res_hi = _mm256_srai_epi32(
+      _mm256_add_epi32(_mm256_srai_epi32(compound_pred_hi, 6), offset),
+      kRoundBitsMaskBlend);
+  return _mm256_min_epu16(_mm256_packus_epi32(res_lo, res_hi),
+                          _mm256_set1_epi16(kMax10bppSample));
+}
+
+// RightShiftWithRounding(mask * pred_1 + (64 - mask) * pred_0, 6). The
+// inputs are 10-bit pixels, so the sum is at most 64 * 1023 + 32 and fits in
+// 16 unsigned bits.
+inline __m256i InterIntraMaskBlend16(const uint16_t* LIBGAV1_RESTRICT pred_0,
+                                     const uint16_t* LIBGAV1_RESTRICT pred_1,
+                                     const ptrdiff_t pred_stride_1,
+                                     const int width,
+                                     const __m256i& pred_mask_1) {
+  const __m256i pred_mask_0 =
+      _mm256_sub_epi16(_mm256_set1_epi16(64), pred_mask_1);
+  const __m256i pred_val_0 = LoadPred16(pred_0, width, width);
+  const __m256i pred_val_1 = LoadPred16(pred_1, pred_stride_1, width);
+  const __m256i sum =
+      _mm256_add_epi16(_mm256_mullo_epi16(pred_val_0, pred_mask_0),
+                       _mm256_mullo_epi16(pred_val_1, pred_mask_1));
+  return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(32)), 6);
+}
+
+template <int subsampling_x, int subsampling_y, bool is_inter_intra>
+void MaskBlend10bpp_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                         const void* LIBGAV1_RESTRICT prediction_1,
+                         const ptrdiff_t prediction_stride_1,
+                         const uint8_t* LIBGAV1_RESTRICT const mask_ptr,
+                         const ptrdiff_t mask_stride, const int width,
+                         const int height, void* LIBGAV1_RESTRICT dest,
+                         const ptrdiff_t dest_stride) {
+  auto* dst = static_cast<uint16_t*>(dest);
+  const ptrdiff_t dst_stride = dest_stride / sizeof(dst[0]);
+  const auto* pred_0 = static_cast<const uint16_t*>(prediction_0);
+  const auto* pred_1 = static_cast<const uint16_t*>(prediction_1);
+  const ptrdiff_t pred_stride_1 = prediction_stride_1;
+  const uint8_t* mask = mask_ptr;
+  const int rows = RowsPerStep(width);
+  int y = 0;
+  do {
+    int x = 0;
+    do {
+      const __m256i pred_mask = GetMask16<subsampling_x, subsampling_y>(
+          mask + (x << subsampling_x), mask_stride, width);
+      const __m256i res =
+          is_inter_intra
+              ? InterIntraMaskBlend16(pred_0 + x, pred_1 + x, pred_stride_1,
+                                      width, pred_mask)
+              : MaskBlend16(pred_0 + x, pred_1 + x, pred_stride_1, width,
+                            pred_mask);
+      StorePixels16(dst + x, dst_stride, width, res);
+      x += 16;
+    } while (x < width);
+    dst += dst_stride * rows;
+    mask += (mask_stride << subsampling_y) * rows;
+    pred_0 += width * rows;
+    pred_1 += pred_stride_1 * rows;
+    y += rows;
+  } while (y < height);
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_AVX2(MaskBlend444)
+  dsp->mask_blend[0][0] = MaskBlend10bpp_AVX2<0, 0, false>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(MaskBlend422)
+  dsp->mask_blend[1][0] = MaskBlend10bpp_AVX2<1, 0, false>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(MaskBlend420)
+  dsp->mask_blend[2][0] = MaskBlend10bpp_AVX2<1, 1, false>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(MaskBlendInterIntra444)
+  dsp->mask_blend[0][1] = MaskBlend10bpp_AVX2<0, 0, true>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(MaskBlendInterIntra422)
+  dsp->mask_blend[1][1] = MaskBlend10bpp_AVX2<1, 0, true>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(MaskBlendInterIntra420)
+  dsp->mask_blend[2][1] = MaskBlend10bpp_AVX2<1, 1, true>;
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void MaskBlendInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX2
+
+namespace libgav1 {
+namespace dsp {
+
+void MaskBlendInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
@@ -34,12 +34,16 @@
 
 namespace libgav1 {
 namespace dsp {
-namespace low_bitdepth {
 namespace {
 
 // Number of extra bits of precision in warped filtering.
 constexpr int kWarpedDiffPrecisionBits = 10;
 
+}  // namespace
+
+namespace low_bitdepth {
+namespace {
+
 // This assumes the two filters contain filter[x] and filter[x+2].
 inline __m128i AccumulateFilter(const __m128i sum, const __m128i filter_0,
                                 const __m128i filter_1,
@@ -519,7 +523,338 @@ void Init8bpp() {
 }  // namespace
 }  // namespace low_bitdepth
 
-void WarpInit_SSE4_1() { low_bitdepth::Init8bpp(); }
+//------------------------------------------------------------------------------
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+// Adds the products of taps k and k + 1 for the 8 output pixels to |sum_low|
+// (pixels 0-3) and |sum_high| (pixels 4-7). |src_lo| and |src_hi| hold 16
+// consecutive source pixels.
+template <int k>
+inline void AccumulateFilter(const __m128i filter[8], const __m128i src_lo,
+                             const __m128i src_hi, __m128i* const sum_low,
+                             __m128i* const sum_high) {
+  const __m128i src_0 = _mm_alignr_epi8(src_hi, src_lo, 2 * k);
+  const __m128i src_1 = _mm_alignr_epi8(src_hi, src_lo, 2 * (k + 1));
+  const __m128i taps_low = _mm_unpacklo_epi16(filter[k], filter[k + 1]);
+  const __m128i taps_high = _mm_unpackhi_epi16(filter[k], filter[k + 1]);
+  *sum_low = _mm_add_epi32(
+      *sum_low, _mm_madd_epi16(taps_low, _mm_unpacklo_epi16(src_0, src_1)));
+  *sum_high = _mm_add_epi32(
+      *sum_high, _mm_madd_epi16(taps_high, _mm_unpackhi_epi16(src_0, src_1)));
+}
+
+// Applies the horizontal filter to one source row and stores the result in
+// |intermediate_result_row|. |src_row_lo| and |src_row_hi| contain the 16
+// pixels starting at src_row[ix4 - 7]. The 10bpp sums do not fit in int16_t so
+// they are accumulated in 32 bits.
+inline void HorizontalFilter(const int sx4, const int16_t alpha,
+                             const __m128i src_row_lo, const __m128i src_row_hi,
+                             int16_t intermediate_result_row[8]) {
+  int sx = sx4 - MultiplyBy4(alpha);
+  __m128i filter[8];
+  for (__m128i& f : filter) {
+    const int offset = RightShiftWithRounding(sx, kWarpedDiffPrecisionBits) +
+                       kWarpedPixelPrecisionShifts;
+    f = LoadUnaligned16(kWarpedFilters[offset]);
+    sx += alpha;
+  }
+  Transpose8x8_U16(filter, filter);
+  // |filter[k]| now contains tap k of each of the 8 filters.
+  __m128i sum_low = _mm_setzero_si128();
+  __m128i sum_high = _mm_setzero_si128();
+  AccumulateFilter<0>(filter, src_row_lo, src_row_hi, &sum_low, &sum_high);
+  AccumulateFilter<2>(filter, src_row_lo, src_row_hi, &sum_low, &sum_high);
+  AccumulateFilter<4>(filter, src_row_lo, src_row_hi, &sum_low, &sum_high);
+  AccumulateFilter<6>(filter, src_row_lo, src_row_hi, &sum_low, &sum_high);
+  sum_low = RightShiftWithRounding_S32(sum_low, kInterRoundBitsHorizontal);
+  sum_high = RightShiftWithRounding_S32(sum_high, kInterRoundBitsHorizontal);
+  StoreUnaligned16(intermediate_result_row,
+                   _mm_packs_epi32(sum_low, sum_high));
+}
+
+template <bool is_compound>
+inline void StoreVerticalFilterOutput(__m128i sum_low, __m128i sum_high,
+                                      uint16_t* LIBGAV1_RESTRICT dst_row) {
+  constexpr int kRoundBitsVertical =
+      is_compound ? kInterRoundBitsCompoundVertical : kInterRoundBitsVertical;
+  sum_low = RightShiftWithRounding_S32(sum_low, kRoundBitsVertical);
+  sum_high = RightShiftWithRounding_S32(sum_high, kRoundBitsVertical);
+  if (is_compound) {
+    // The offset compound values are in [0, 65535] so the saturating pack
+    // does not alter them.
+    const __m128i compound_offset = _mm_set1_epi32(kCompoundOffset);
+    sum_low = _mm_add_epi32(sum_low, compound_offset);
+    sum_high = _mm_add_epi32(sum_high, compound_offset);
+    StoreUnaligned16(dst_row, _mm_packus_epi32(sum_low, sum_high));
+  } else {
+    const __m128i sum = _mm_packus_epi32(sum_low, sum_high);
+    StoreUnaligned16(
+        dst_row, _mm_min_epu16(sum, _mm_set1_epi16((1 << kBitdepth10) - 1)));
+  }
+}
+
+template <bool is_compound>
+inline void WriteVerticalFilter(const __m128i filter[8],
+                                const int16_t intermediate_result[15][8], int y,
+                                uint16_t* LIBGAV1_RESTRICT dst_row) {
+  __m128i sum_low = _mm_setzero_si128();
+  __m128i sum_high = _mm_setzero_si128();
+  for (int k = 0; k < 8; k += 2) {
+    const __m128i filters_low = _mm_unpacklo_epi16(filter[k], filter[k + 1]);
+    const __m128i filters_high = _mm_unpackhi_epi16(filter[k], filter[k + 1]);
+    const __m128i intermediate_0 = LoadUnaligned16(intermediate_result[y + k]);
+    const __m128i intermediate_1 =
+        LoadUnaligned16(intermediate_result[y + k + 1]);
+    const __m128i intermediate_low =
+        _mm_unpacklo_epi16(intermediate_0, intermediate_1);
+    const __m128i intermediate_high =
+        _mm_unpackhi_epi16(intermediate_0, intermediate_1);
+
+    const __m128i product_low = _mm_madd_epi16(filters_low, intermediate_low);
+    const __m128i product_high =
+        _mm_madd_epi16(filters_high, intermediate_high);
+    sum_low = _mm_add_epi32(sum_low, product_low);
+    sum_high = _mm_add_epi32(sum_high, product_high);
+  }
+  StoreVerticalFilterOutput<is_compound>(sum_low, sum_high, dst_row);
+}
+
+template <bool is_compound>
+inline void WriteVerticalFilter(const __m128i filter[8],
+                                const int16_t* LIBGAV1_RESTRICT
+                                    intermediate_result_column,
+                                uint16_t* LIBGAV1_RESTRICT dst_row) {
+  __m128i sum_low = _mm_setzero_si128();
+  __m128i sum_high = _mm_setzero_si128();
+  for (int k = 0; k < 8; k += 2) {
+    const __m128i filters_low = _mm_unpacklo_epi16(filter[k], filter[k + 1]);
+    const __m128i filters_high = _mm_unpackhi_epi16(filter[k], filter[k + 1]);
+    // Equivalent to unpacking two vectors made by duplicating int16_t values.
+    const __m128i intermediate =
+        _mm_set1_epi32((intermediate_result_column[k + 1] << 16) |
+                       intermediate_result_column[k]);
+    const __m128i product_low = _mm_madd_epi16(filters_low, intermediate);
+    const __m128i product_high = _mm_madd_epi16(filters_high, intermediate);
+    sum_low = _mm_add_epi32(sum_low, product_low);
+    sum_high = _mm_add_epi32(sum_high, product_high);
+  }
+  StoreVerticalFilterOutput<is_compound>(sum_low, sum_high, dst_row);
+}
+
+template <bool is_compound>
+inline void VerticalFilter(const int16_t source[15][8], int64_t y4, int gamma,
+                           int delta, uint16_t* LIBGAV1_RESTRICT dst_row,
+                           ptrdiff_t dst_stride) {
+  int sy4 = (y4 & ((1 << kWarpedModelPrecisionBits) - 1)) - MultiplyBy4(delta);
+  for (int y = 0; y < 8; ++y) {
+    int sy = sy4 - MultiplyBy4(gamma);
+    __m128i filter[8];
+    for (__m128i& f : filter) {
+      const int offset = RightShiftWithRounding(sy, kWarpedDiffPrecisionBits) +
+                         kWarpedPixelPrecisionShifts;
+      f = LoadUnaligned16(kWarpedFilters[offset]);
+      sy += gamma;
+    }
+    Transpose8x8_U16(filter, filter);
+    WriteVerticalFilter<is_compound>(filter, source, y, dst_row);
+    dst_row += dst_stride;
+    sy4 += delta;
+  }
+}
+
+template <bool is_compound>
+inline void VerticalFilter(const int16_t* LIBGAV1_RESTRICT source_cols,
+                           int64_t y4, int gamma, int delta,
+                           uint16_t* LIBGAV1_RESTRICT dst_row,
+                           ptrdiff_t dst_stride) {
+  int sy4 = (y4 & ((1 << kWarpedModelPrecisionBits) - 1)) - MultiplyBy4(delta);
+  for (int y = 0; y < 8; ++y) {
+    int sy = sy4 - MultiplyBy4(gamma);
+    __m128i filter[8];
+    for (__m128i& f : filter) {
+      const int offset = RightShiftWithRounding(sy, kWarpedDiffPrecisionBits) +
+                         kWarpedPixelPrecisionShifts;
+      f = LoadUnaligned16(kWarpedFilters[offset]);
+      sy += gamma;
+    }
+    Transpose8x8_U16(filter, filter);
+    WriteVerticalFilter<is_compound>(filter, &source_cols[y], dst_row);
+    dst_row += dst_stride;
+    sy4 += delta;
+  }
+}
+
+template <bool is_compound>
+inline void HandleWarpBlock(const uint16_t* LIBGAV1_RESTRICT src,
+                            ptrdiff_t src_stride, int source_width,
+                            int source_height,
+                            const int* LIBGAV1_RESTRICT warp_params,
+                            int subsampling_x, int subsampling_y, int src_x,
+                            int src_y, int16_t alpha, int16_t beta,
+                            int16_t gamma, int16_t delta,
+                            uint16_t* LIBGAV1_RESTRICT dst_row,
+                            ptrdiff_t dst_stride) {
+  union {
+    // |intermediate_result| is the output of the horizontal filtering and
+    // rounding. The range is within int16_t.
+    int16_t intermediate_result[15][8];  // 15 rows, 8 columns.
+    // In the simple special cases where the samples in each row are all the
+    // same, store one sample per row in a column vector.
+    int16_t intermediate_result_column[15];
+  };
+
+  const WarpFilterParams filter_params = GetWarpFilterParams(
+      src_x, src_y, subsampling_x, subsampling_y, warp_params);
+  // The plane is divided into the same regions as in the 8bpp version above.
+  // See warp.cc for the details.
+  if (filter_params.ix4 - 7 >= source_width - 1 || filter_params.ix4 + 7 <= 0) {
+    // Points to the left or right border of the first row of |src|.
+    const uint16_t* const first_row_border =
+        (filter_params.ix4 + 7 <= 0) ? src : src + source_width - 1;
+    if (filter_params.iy4 - 7 >= source_height - 1 ||
+        filter_params.iy4 + 7 <= 0) {
+      // Region 1.
+      // Every sample used to calculate the prediction block has the same
+      // value. So the whole prediction block has the same value.
+      const int row = (filter_params.iy4 + 7 <= 0) ? 0 : source_height - 1;
+      const uint16_t row_border_pixel = first_row_border[row * src_stride];
+      __m128i value = _mm_set1_epi16(row_border_pixel);
+      if (is_compound) {
+        value = _mm_slli_epi16(
+            value, kInterRoundBitsVertical - kInterRoundBitsCompoundVertical);
+        value = _mm_add_epi16(value, _mm_set1_epi16(kCompoundOffset));
+      }
+      for (int y = 0; y < 8; ++y) {
+        StoreUnaligned16(dst_row, value);
+        dst_row += dst_stride;
+      }
+      return;
+    }
+
+    // Region 2.
+    // The input values in this region are identical in the horizontal
+    // direction so the horizontal filter reduces to a shift.
+    for (int y = -7; y < 8; ++y) {
+      // We may over-read up to 13 pixels above the top source row, or up
+      // to 13 pixels below the bottom source row. This is proved in
+      // warp.cc.
+      const int row = filter_params.iy4 + y;
+      int sum = first_row_border[row * src_stride];
+      sum <<= (kFilterBits - kInterRoundBitsHorizontal);
+      intermediate_result_column[y + 7] = sum;
+    }
+    VerticalFilter<is_compound>(intermediate_result_column, filter_params.y4,
+                                gamma, delta, dst_row, dst_stride);
+    return;
+  }
+
+  int sx4 = (filter_params.x4 & ((1 << kWarpedModelPrecisionBits) - 1)) -
+            beta * 7;
+  if (filter_params.iy4 - 7 >= source_height - 1 ||
+      filter_params.iy4 + 7 <= 0) {
+    // Region 3.
+    // All of the source rows are the same.
+    const int row = (filter_params.iy4 + 7 <= 0) ? 0 : source_height - 1;
+    const uint16_t* const src_row = src + row * src_stride;
+    // Read 15 samples from &src_row[ix4 - 7]. The 16th sample is also
+    // read but is ignored.
+    //
+    // NOTE: This may read up to 13 pixels before src_row[0] or up to 14
+    // pixels after src_row[source_width - 1]. We assume the source frame
+    // has left and right borders of at least 13 pixels that extend the
+    // frame boundary pixels. We also assume there is at least one extra
+    // padding pixel after the right border of the last source row.
+    const __m128i src_row_lo = LoadUnaligned16(&src_row[filter_params.ix4 - 7]);
+    const __m128i src_row_hi = LoadUnaligned16(&src_row[filter_params.ix4 + 1]);
+    for (int y = -7; y < 8; ++y) {
+      HorizontalFilter(sx4, alpha, src_row_lo, src_row_hi,
+                       intermediate_result[y + 7]);
+      sx4 += beta;
+    }
+  } else {
+    // Region 4.
+    for (int y = -7; y < 8; ++y) {
+      // We may over-read up to 13 pixels above the top source row, or up
+      // to 13 pixels below the bottom source row. This is proved in
+      // warp.cc.
+      const int row = filter_params.iy4 + y;
+      const uint16_t* const src_row = src + row * src_stride;
+      // See the over-read note for region 3.
+      const __m128i src_row_lo =
+          LoadUnaligned16(&src_row[filter_params.ix4 - 7]);
+      const __m128i src_row_hi =
+          LoadUnaligned16(&src_row[filter_params.ix4 + 1]);
+      HorizontalFilter(sx4, alpha, src_row_lo, src_row_hi,
+                       intermediate_result[y + 7]);
+      sx4 += beta;
+    }
+  }
+  // Region 3 and 4 vertical filter.
+  VerticalFilter<is_compound>(intermediate_result, filter_params.y4, gamma,
+                              delta, dst_row, dst_stride);
+}
+
+template <bool is_compound>
+void Warp_SSE4_1(const void* LIBGAV1_RESTRICT source, ptrdiff_t source_stride,
+                 int source_width, int source_height,
+                 const int* LIBGAV1_RESTRICT warp_params, int subsampling_x,
+                 int subsampling_y, int block_start_x, int block_start_y,
+                 int block_width, int block_height, int16_t alpha, int16_t beta,
+                 int16_t gamma, int16_t delta, void* LIBGAV1_RESTRICT dest,
+                 ptrdiff_t dest_stride) {
+  const auto* const src = static_cast<const uint16_t*>(source);
+  const ptrdiff_t src_stride = source_stride >> 1;
+  auto* dst = static_cast<uint16_t*>(dest);
+  // The compound stride is in units of uint16_t.
+  const ptrdiff_t dst_stride = is_compound ? dest_stride : dest_stride >> 1;
+
+  // Warp process applies for each 8x8 block.
+  assert(block_width >= 8);
+  assert(block_height >= 8);
+  const int block_end_x = block_start_x + block_width;
+  const int block_end_y = block_start_y + block_height;
+
+  const int start_x = block_start_x;
+  const int start_y = block_start_y;
+  int src_x = (start_x + 4) << subsampling_x;
+  int src_y = (start_y + 4) << subsampling_y;
+  const int end_x = (block_end_x + 4) << subsampling_x;
+  const int end_y = (block_end_y + 4) << subsampling_y;
+  do {
+    uint16_t* dst_row = dst;
+    src_x = (start_x + 4) << subsampling_x;
+    do {
+      HandleWarpBlock<is_compound>(src, src_stride, source_width, source_height,
+                                   warp_params, subsampling_x, subsampling_y,
+                                   src_x, src_y, alpha, beta, gamma, delta,
+                                   dst_row, dst_stride);
+      src_x += (8 << subsampling_x);
+      dst_row += 8;
+    } while (src_x < end_x);
+    dst += 8 * dst_stride;
+    src_y += (8 << subsampling_y);
+  } while (src_y < end_y);
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+  dsp->warp = Warp_SSE4_1</*is_compound=*/false>;
+  dsp->warp_compound = Warp_SSE4_1</*is_compound=*/true>;
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void WarpInit_SSE4_1() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
 
 }  // namespace dsp
 }  // namespace libgav1
@@ -0,0 +1,286 @@
+// Copyright 2023 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "src/dsp/weight_mask.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+// The predictions are contiguous with a stride of |width|, so every
+// iteration handles 32 of them regardless of the block width.
+// RightShiftWithRounding(difference, rounding_bits) >> 4 is folded into a
+// single shift: (x >> a) >> b == x >> (a + b).
+template <int width, int height, bool mask_is_inverse, int rounding_bits,
+          typename PredType>
+void ComputeWeightMask_AVX2(const PredType* LIBGAV1_RESTRICT pred_0,
+                            const PredType* LIBGAV1_RESTRICT pred_1,
+                            uint8_t* LIBGAV1_RESTRICT mask,
+                            ptrdiff_t mask_stride) {
+  static_assert(width >= 8, "");
+  constexpr int kShift = rounding_bits + 4;
+  const __m256i rounding = _mm256_set1_epi16(1 << (rounding_bits - 1));
+  const __m256i difference_offset = _mm256_set1_epi8(38);
+  const __m256i mask_ceiling = _mm256_set1_epi8(64);
+  int y = 0;
+  do {
+    int x = 0;
+    do {
+      __m256i scaled_difference[2];
+      for (int i = 0; i < 2; ++i) {
+        const __m256i p0 = LoadUnaligned32(pred_0 + x + i * 16);
+        const __m256i p1 = LoadUnaligned32(pred_1 + x + i * 16);
+        // 8bpp predictions are signed and their difference fits in 15 bits.
+        // 10bpp predictions use the full unsigned range, so the absolute
+        // difference is formed with unsigned max/min.
+        const __m256i difference =
+            std::is_signed<PredType>::value
+                ? _mm256_abs_epi16(_mm256_sub_epi16(p0, p1))
+                : _mm256_sub_epi16(_mm256_max_epu16(p0, p1),
+                                   _mm256_min_epu16(p0, p1));
+        scaled_difference[i] =
+            _mm256_srli_epi16(_mm256_add_epi16(difference, rounding), kShift);
+      }
+      // packus works within 128-bit lanes; restore the order.
+      const __m256i packed = _mm256_permute4x64_epi64(
+          _mm256_packus_epi16(scaled_difference[0], scaled_difference[1]),
+          0xd8);
+      __m256i mask_value = _mm256_min_epu8(
+          _mm256_adds_epu8(packed, difference_offset), mask_ceiling);
+      if (mask_is_inverse) {
+        mask_value = _mm256_sub_epi8(mask_ceiling, mask_value);
+      }
+      if (width >= 32) {
+        StoreUnaligned32(mask + x, mask_value);
+        x += 32;
+      } else if (width == 16) {
+        StoreUnaligned16(mask, _mm256_castsi256_si128(mask_value));
+        StoreUnaligned16(mask + mask_stride,
+                         _mm256_extracti128_si256(mask_value, 1));
+        x += 32;
+      } else {
+        const __m128i mask_lo = _mm256_castsi256_si128(mask_value);
+        const __m128i mask_hi = _mm256_extracti128_si256(mask_value, 1);
+        StoreLo8(mask, mask_lo);
+        StoreHi8(mask + mask_stride, mask_lo);
+        StoreLo8(mask + 2 * mask_stride, mask_hi);
+        StoreHi8(mask + 3 * mask_stride, mask_hi);
+        x += 32;
+      }
+    } while (x < width);
+    constexpr int kRows = (width >= 32) ? 1 : 32 / width;
+    pred_0 += width * kRows;
+    pred_1 += width * kRows;
+    mask += mask_stride * kRows;
+    y += kRows;
+  } while (y < height);
+}
+
+}  // namespace
+
+namespace low_bitdepth {
+namespace {
+
+constexpr int kRoundingBits8bpp = 4;
+
+template <int width, int height, bool mask_is_inverse>
+void WeightMask_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                     const void* LIBGAV1_RESTRICT prediction_1,
+                     uint8_t* LIBGAV1_RESTRICT mask, ptrdiff_t mask_stride) {
+  ComputeWeightMask_AVX2<width, height, mask_is_inverse, kRoundingBits8bpp>(
+      static_cast<const int16_t*>(prediction_0),
+      static_cast<const int16_t*>(prediction_1), mask, mask_stride);
+}
+
+#define INIT_WEIGHT_MASK_8BPP(width, height, w_index, h_index) \
+  dsp->weight_mask[w_index][h_index][0] =                      \
+      WeightMask_AVX2<width, height, 0>;                       \
+  dsp->weight_mask[w_index][h_index][1] =                      \
+      WeightMask_AVX2<width, height, 1>
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_8x8)
+  INIT_WEIGHT_MASK_8BPP(8, 8, 0, 0);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_8x16)
+  INIT_WEIGHT_MASK_8BPP(8, 16, 0, 1);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_8x32)
+  INIT_WEIGHT_MASK_8BPP(8, 32, 0, 2);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_16x8)
+  INIT_WEIGHT_MASK_8BPP(16, 8, 1, 0);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_16x16)
+  INIT_WEIGHT_MASK_8BPP(16, 16, 1, 1);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_16x32)
+  INIT_WEIGHT_MASK_8BPP(16, 32, 1, 2);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_16x64)
+  INIT_WEIGHT_MASK_8BPP(16, 64, 1, 3);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_32x8)
+  INIT_WEIGHT_MASK_8BPP(32, 8, 2, 0);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_32x16)
+  INIT_WEIGHT_MASK_8BPP(32, 16, 2, 1);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_32x32)
+  INIT_WEIGHT_MASK_8BPP(32, 32, 2, 2);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_32x64)
+  INIT_WEIGHT_MASK_8BPP(32, 64, 2, 3);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_64x16)
+  INIT_WEIGHT_MASK_8BPP(64, 16, 3, 1);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_64x32)
+  INIT_WEIGHT_MASK_8BPP(64, 32, 3, 2);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_64x64)
+  INIT_WEIGHT_MASK_8BPP(64, 64, 3, 3);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_64x128)
+  INIT_WEIGHT_MASK_8BPP(64, 128, 3, 4);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_128x64)
+  INIT_WEIGHT_MASK_8BPP(128, 64, 4, 3);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_128x128)
+  INIT_WEIGHT_MASK_8BPP(128, 128, 4, 4);
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+constexpr int kRoundingBits10bpp = 6;
+
+template <int width, int height, bool mask_is_inverse>
+void WeightMask10bpp_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                          const void* LIBGAV1_RESTRICT prediction_1,
+                          uint8_t* LIBGAV1_RESTRICT mask,
+                          ptrdiff_t mask_stride) {
+  ComputeWeightMask_AVX2<width, height, mask_is_inverse, kRoundingBits10bpp>(
+      static_cast<const uint16_t*>(prediction_0),
+      static_cast<const uint16_t*>(prediction_1), mask, mask_stride);
+}
+
+#define INIT_WEIGHT_MASK_10BPP(width, height, w_index, h_index) \
+  dsp->weight_mask[w_index][h_index][0] =                       \
+      WeightMask10bpp_AVX2<width, height, 0>;                   \
+  dsp->weight_mask[w_index][h_index][1] =                       \
+      WeightMask10bpp_AVX2<width, height, 1>
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_8x8)
+  INIT_WEIGHT_MASK_10BPP(8, 8, 0, 0);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_8x16)
+  INIT_WEIGHT_MASK_10BPP(8, 16, 0, 1);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_8x32)
+  INIT_WEIGHT_MASK_10BPP(8, 32, 0, 2);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_16x8)
+  INIT_WEIGHT_MASK_10BPP(16, 8, 1, 0);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_16x16)
+  INIT_WEIGHT_MASK_10BPP(16, 16, 1, 1);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_16x32)
+  INIT_WEIGHT_MASK_10BPP(16, 32, 1, 2);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_16x64)
+  INIT_WEIGHT_MASK_10BPP(16, 64, 1, 3);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_32x8)
+  INIT_WEIGHT_MASK_10BPP(32, 8, 2, 0);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_32x16)
+  INIT_WEIGHT_MASK_10BPP(32, 16, 2, 1);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_32x32)
+  INIT_WEIGHT_MASK_10BPP(32, 32, 2, 2);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_32x64)
+  INIT_WEIGHT_MASK_10BPP(32, 64, 2, 3);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_64x16)
+  INIT_WEIGHT_MASK_10BPP(64, 16, 3, 1);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_64x32)
+  INIT_WEIGHT_MASK_10BPP(64, 32, 3, 2);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_64x64)
+  INIT_WEIGHT_MASK_10BPP(64, 64, 3, 3);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_64x128)
+  INIT_WEIGHT_MASK_10BPP(64, 128, 3, 4);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_128x64)
+  INIT_WEIGHT_MASK_10BPP(128, 64, 4, 3);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_128x128)
+  INIT_WEIGHT_MASK_10BPP(128, 128, 4, 4);
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void WeightMaskInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX2
+
+namespace libgav1 {
+namespace dsp {
+
+void WeightMaskInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
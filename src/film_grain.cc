@@ -25,6 +25,7 @@
 #include "src/dsp/constants.h"
 #include "src/dsp/dsp.h"
 #include "src/dsp/film_grain_common.h"
+#include "src/memory_tracker.h"
 #include "src/utils/array_2d.h"
 #include "src/utils/blocking_counter.h"
 #include "src/utils/common.h"
@@ -284,6 +285,9 @@ FilmGrain<bitdepth>::~FilmGrain() {
   // is reused.
   ASAN_UNPOISON_MEMORY_REGION(luma_grain_, sizeof(luma_grain_));
   ASAN_UNPOISON_MEMORY_REGION(scaling_lut_y_, sizeof(scaling_lut_y_));
+  if (memory_tracker_ != nullptr) {
+    memory_tracker_->Subtract(kMemoryCategoryFilmGrain, allocated_bytes_);
+  }
 }
 
 template <int bitdepth>
@@ -348,6 +352,7 @@ bool FilmGrain<bitdepth>::Init() {
                                static_cast<int>(params_.num_v_points > 0));
       scaling_lut_chroma_buffer_.reset(new (std::nothrow) int16_t[buffer_size]);
       if (scaling_lut_chroma_buffer_ == nullptr) return false;
+      CountAllocation(buffer_size * sizeof(int16_t));
 
       int16_t* buffer = scaling_lut_chroma_buffer_.get();
 #if LIBGAV1_MSAN
@@ -453,6 +458,7 @@ bool FilmGrain<bitdepth>::AllocateNoiseStripes() {
   }
   noise_buffer_.reset(new (std::nothrow) GrainType[noise_buffer_size]);
   if (noise_buffer_ == nullptr) return false;
+  CountAllocation(noise_buffer_size * sizeof(GrainType));
   GrainType* noise_buffer = noise_buffer_.get();
   if (params_.num_y_points > 0) {
     noise_stripes_[kPlaneY].Reset(max_luma_num, kNoiseStripeHeight * width_,
@@ -498,9 +504,19 @@ bool FilmGrain<bitdepth>::AllocateNoiseImage() {
       return false;
     }
   }
+  for (const auto& noise_image : noise_image_) {
+    CountAllocation(noise_image.size() * sizeof(GrainType));
+  }
   return true;
 }
 
+template <int bitdepth>
+void FilmGrain<bitdepth>::CountAllocation(size_t bytes) {
+  if (memory_tracker_ == nullptr) return;
+  memory_tracker_->Add(kMemoryCategoryFilmGrain, bytes);
+  allocated_bytes_ += bytes;
+}
+
 // Uses |overlap_flag| to skip rows that are covered by the overlap computation.
 template <int bitdepth>
 void FilmGrain<bitdepth>::ConstructNoiseImage(
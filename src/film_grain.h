@@ -35,6 +35,8 @@
 
 namespace libgav1 {
 
+class MemoryTracker;
+
 // Film grain synthesis function signature. Section 7.18.3.
 // This function generates film grain noise and blends the noise with the
 // decoded frame.
@@ -101,6 +103,12 @@ class FilmGrain {
                 ptrdiff_t dest_stride_y, uint8_t* dest_plane_u,
                 uint8_t* dest_plane_v, ptrdiff_t dest_stride_uv);
 
+  // Counts the buffers allocated by AddNoise() in the film grain category of
+  // |memory_tracker| until the object is destroyed.
+  void set_memory_tracker(MemoryTracker* memory_tracker) {
+    memory_tracker_ = memory_tracker;
+  }
+
  private:
   using Pixel =
       typename std::conditional<bitdepth == 8, uint8_t, uint16_t>::type;
@@ -116,6 +124,9 @@ class FilmGrain {
 
   bool AllocateNoiseImage();
 
+  // Records an allocation of |bytes| bytes in |memory_tracker_|.
+  void CountAllocation(size_t bytes);
+
   void BlendNoiseChromaWorker(const dsp::Dsp& dsp, const Plane* planes,
                               int num_planes, std::atomic<int>* job_counter,
                               int min_value, int max_chroma,
@@ -191,6 +202,9 @@ class FilmGrain {
 
   Array2D<GrainType> noise_image_[kMaxPlanes];
   ThreadPool* const thread_pool_;
+  MemoryTracker* memory_tracker_ = nullptr;
+  // The number of bytes recorded in |memory_tracker_|.
+  size_t allocated_bytes_ = 0;
 };
 
 }  // namespace libgav1
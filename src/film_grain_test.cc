@@ -1808,6 +1808,8 @@ class ConstructImageTest : public testing::TestWithParam<std::tuple<int, int>> {
 #if LIBGAV1_ENABLE_NEON
       FilmGrainInit_NEON();
 #endif
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) != 0) FilmGrainInit_AVX2();
     }
     construct_noise_image_overlap_func_ =
         dsp->film_grain.construct_noise_image_overlap;
@@ -2021,10 +2023,22 @@ INSTANTIATE_TEST_SUITE_P(NEON, ConstructImageTest8bpp,
                                           testing::Range(0, 3)));
 #endif  // LIBGAV1_ENABLE_NEON
 
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, ConstructImageTest8bpp,
+                         testing::Combine(testing::Range(0, 2),
+                                          testing::Range(0, 3)));
+#endif  // LIBGAV1_ENABLE_AVX2
+
 #if LIBGAV1_MAX_BITDEPTH >= 10
 INSTANTIATE_TEST_SUITE_P(C, ConstructImageTest10bpp,
                          testing::Combine(testing::Range(0, 2),
                                           testing::Range(0, 3)));
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, ConstructImageTest10bpp,
+                         testing::Combine(testing::Range(0, 2),
+                                          testing::Range(0, 3)));
+#endif  // LIBGAV1_ENABLE_AVX2
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
 
 #if LIBGAV1_MAX_BITDEPTH == 12
@@ -2208,6 +2222,9 @@ class BlendNoiseTest : public testing::TestWithParam<std::tuple<int, int>> {
     } else if (absl::StartsWith(test_case, "SSE41/")) {
       if ((GetCpuInfo() & kSSE4_1) == 0) GTEST_SKIP() << "No SSE4.1 support!";
       FilmGrainInit_SSE4_1();
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) == 0) GTEST_SKIP() << "No AVX2 support!";
+      FilmGrainInit_AVX2();
     }
     const BlendNoiseTestParam test_param(GetParam());
     chroma_scaling_from_luma_ = test_param.chroma_scaling_from_luma;
@@ -2489,6 +2506,12 @@ INSTANTIATE_TEST_SUITE_P(SSE41, BlendNoiseTest8bpp,
                                           testing::Range(0, 3)));
 #endif
 
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, BlendNoiseTest8bpp,
+                         testing::Combine(testing::Range(0, 2),
+                                          testing::Range(0, 3)));
+#endif
+
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, BlendNoiseTest8bpp,
                          testing::Combine(testing::Range(0, 2),
@@ -2511,6 +2534,12 @@ INSTANTIATE_TEST_SUITE_P(SSE41, BlendNoiseTest10bpp,
                                           testing::Range(0, 3)));
 #endif
 
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, BlendNoiseTest10bpp,
+                         testing::Combine(testing::Range(0, 2),
+                                          testing::Range(0, 3)));
+#endif
+
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, BlendNoiseTest10bpp,
                          testing::Combine(testing::Range(0, 2),
@@ -2551,6 +2580,9 @@ class FilmGrainSpeedTest : public testing::TestWithParam<int> {
     } else if (absl::StartsWith(test_case, "SSE41/")) {
       if ((GetCpuInfo() & kSSE4_1) == 0) GTEST_SKIP() << "No SSE4.1 support!";
       FilmGrainInit_SSE4_1();
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) == 0) GTEST_SKIP() << "No AVX2 support!";
+      FilmGrainInit_AVX2();
     }
     uv_width_ = (width_ + subsampling_x_) >> subsampling_x_;
     uv_height_ = (height_ + subsampling_y_) >> subsampling_y_;
@@ -2648,6 +2680,11 @@ INSTANTIATE_TEST_SUITE_P(SSE41, FilmGrainSpeedTest8bpp,
                          testing::Values(0, 3, 8));
 #endif
 
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, FilmGrainSpeedTest8bpp,
+                         testing::Values(0, 3, 8));
+#endif
+
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, FilmGrainSpeedTest8bpp,
                          testing::Values(0, 3, 8));
@@ -2667,6 +2704,11 @@ INSTANTIATE_TEST_SUITE_P(SSE41, FilmGrainSpeedTest10bpp,
                          testing::Values(0, 3, 8));
 #endif
 
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, FilmGrainSpeedTest10bpp,
+                         testing::Values(0, 3, 8));
+#endif
+
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, FilmGrainSpeedTest10bpp,
                          testing::Values(0, 3, 8));
@@ -26,10 +26,12 @@
 #include <utility>
 
 #include "src/loop_restoration_info.h"
+#include "src/memory_tracker.h"
 #include "src/residual_buffer_pool.h"
 #include "src/symbol_decoder_context.h"
 #include "src/threading_strategy.h"
 #include "src/tile_scratch_buffer.h"
+#include "src/utils/arena.h"
 #include "src/utils/array_2d.h"
 #include "src/utils/block_parameters_holder.h"
 #include "src/utils/compiler_attributes.h"
@@ -87,6 +89,9 @@ struct FrameScratchBuffer : public MaxAlignedAllocable {
   // The size of this dynamic buffer is |tile_rows|.
   DynamicBuffer<IntraPredictionBuffer> intra_prediction_buffers;
   TileScratchBufferPool tile_scratch_buffer_pool;
+  // Backs the Tile objects of the frame and their per-frame buffers. It is
+  // reset rather than freed between frames.
+  Arena tile_arena;
   ThreadingStrategy threading_strategy;
   std::mutex superblock_row_mutex;
   // The size of this buffer is the number of superblock rows.
@@ -112,6 +117,15 @@ class FrameScratchBufferPool {
     lock.unlock();
     std::unique_ptr<FrameScratchBuffer> scratch_buffer(new (std::nothrow)
                                                            FrameScratchBuffer);
+    if (scratch_buffer != nullptr && memory_tracker_ != nullptr) {
+      memory_tracker_->Add(
+          kMemoryCategoryScratch,
+          sizeof(FrameScratchBuffer) - sizeof(SymbolDecoderContext));
+      memory_tracker_->Add(kMemoryCategorySymbolContexts,
+                           sizeof(SymbolDecoderContext));
+      scratch_buffer->tile_scratch_buffer_pool.set_memory_tracker(
+          memory_tracker_);
+    }
     return scratch_buffer;
   }
 
@@ -120,10 +134,46 @@ class FrameScratchBufferPool {
     buffers_.Push(std::move(scratch_buffer));
   }
 
+  // Frees the memory that the buffers in the pool allocate again, at the size
+  // of the stream, when they are used for the next frame: the pooled tile
+  // scratch and residual buffers, the tile arena and the BlockParameters
+  // objects that the last frame did not use. The buffers themselves are kept,
+  // together with their thread pools.
+  void Trim() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stack<std::unique_ptr<FrameScratchBuffer>, kMaxThreads> trimmed_buffers;
+    while (!buffers_.Empty()) {
+      std::unique_ptr<FrameScratchBuffer> scratch_buffer = buffers_.Pop();
+      scratch_buffer->tile_scratch_buffer_pool.Trim();
+      if (scratch_buffer->residual_buffer_pool != nullptr) {
+        scratch_buffer->residual_buffer_pool->Trim();
+      }
+      if (memory_tracker_ != nullptr) {
+        memory_tracker_->Subtract(kMemoryCategoryScratch,
+                                  scratch_buffer->tile_arena.capacity());
+      }
+      scratch_buffer->tile_arena.Trim();
+      scratch_buffer->block_parameters_holder.Trim();
+      trimmed_buffers.Push(std::move(scratch_buffer));
+    }
+    // Restore the original order of the buffers.
+    while (!trimmed_buffers.Empty()) {
+      buffers_.Push(trimmed_buffers.Pop());
+    }
+  }
+
+  // Counts the buffers allocated from now on in |memory_tracker|, which must
+  // outlive the pool. Must be called before the pool is used by more than one
+  // thread.
+  void set_memory_tracker(MemoryTracker* memory_tracker) {
+    memory_tracker_ = memory_tracker;
+  }
+
  private:
   std::mutex mutex_;
   Stack<std::unique_ptr<FrameScratchBuffer>, kMaxThreads> buffers_
       LIBGAV1_GUARDED_BY(mutex_);
+  MemoryTracker* memory_tracker_ = nullptr;
 };
 
 }  // namespace libgav1
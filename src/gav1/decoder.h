@@ -43,6 +43,32 @@ extern "C" {
 struct Libgav1Decoder;
 typedef struct Libgav1Decoder Libgav1Decoder;
 
+// The parts of the decoder whose memory use is reported by
+// Libgav1DecoderGetMemoryUsage().
+typedef enum Libgav1MemoryCategory {
+  // The frame buffers allocated by the decoder. The frame buffers provided by
+  // the get_frame_buffer callback are not included.
+  kLibgav1MemoryCategoryFrameBuffers,
+  // The per-frame and per-thread scratch buffers.
+  kLibgav1MemoryCategoryScratch,
+  // The residual buffers used to parse and decode superblocks on different
+  // threads.
+  kLibgav1MemoryCategoryResidual,
+  // The symbol decoder contexts saved with the frames and scratch buffers.
+  kLibgav1MemoryCategorySymbolContexts,
+  // The noise buffers used by film grain synthesis.
+  kLibgav1MemoryCategoryFilmGrain,
+  kLibgav1NumMemoryCategories
+} Libgav1MemoryCategory;
+
+// The number of bytes held by each part of the decoder, indexed by
+// Libgav1MemoryCategory. The peaks are kept from the creation of the decoder,
+// across Libgav1DecoderSignalEOS() calls.
+typedef struct Libgav1MemoryUsage {
+  size_t current_bytes[kLibgav1NumMemoryCategories];
+  size_t peak_bytes[kLibgav1NumMemoryCategories];
+} Libgav1MemoryUsage;
+
 LIBGAV1_PUBLIC Libgav1StatusCode Libgav1DecoderCreate(
     const Libgav1DecoderSettings* settings, Libgav1Decoder** decoder_out);
 
@@ -58,6 +84,18 @@ LIBGAV1_PUBLIC Libgav1StatusCode Libgav1DecoderDequeueFrame(
 LIBGAV1_PUBLIC Libgav1StatusCode
 Libgav1DecoderSignalEOS(Libgav1Decoder* decoder);
 
+LIBGAV1_PUBLIC Libgav1StatusCode Libgav1DecoderReset(Libgav1Decoder* decoder);
+
+LIBGAV1_PUBLIC Libgav1StatusCode Libgav1DecoderPrewarm(
+    Libgav1Decoder* decoder, int max_width, int max_height, int bitdepth,
+    Libgav1ImageFormat image_format, int frame_parallel_depth);
+
+LIBGAV1_PUBLIC Libgav1StatusCode Libgav1DecoderGetMemoryUsage(
+    const Libgav1Decoder* decoder, Libgav1MemoryUsage* usage);
+
+LIBGAV1_PUBLIC Libgav1StatusCode
+Libgav1DecoderTrimMemory(Libgav1Decoder* decoder);
+
 LIBGAV1_PUBLIC int Libgav1DecoderGetMaxBitdepth(void);
 
 #if defined(__cplusplus)
@@ -65,6 +103,20 @@ LIBGAV1_PUBLIC int Libgav1DecoderGetMaxBitdepth(void);
 
 namespace libgav1 {
 
+using MemoryCategory = Libgav1MemoryCategory;
+constexpr MemoryCategory kMemoryCategoryFrameBuffers =
+    kLibgav1MemoryCategoryFrameBuffers;
+constexpr MemoryCategory kMemoryCategoryScratch = kLibgav1MemoryCategoryScratch;
+constexpr MemoryCategory kMemoryCategoryResidual =
+    kLibgav1MemoryCategoryResidual;
+constexpr MemoryCategory kMemoryCategorySymbolContexts =
+    kLibgav1MemoryCategorySymbolContexts;
+constexpr MemoryCategory kMemoryCategoryFilmGrain =
+    kLibgav1MemoryCategoryFilmGrain;
+constexpr int kNumMemoryCategories = kLibgav1NumMemoryCategories;
+
+using MemoryUsage = Libgav1MemoryUsage;
+
 // Forward declaration.
 class DecoderImpl;
 
@@ -102,6 +154,14 @@ class LIBGAV1_PUBLIC Decoder {
   // If the call to |EnqueueFrame()| is not successful, then libgav1 will not
   // hold any references to the |data| buffer. |settings_.release_input_buffer|
   // callback will not be called in that case.
+  //
+  // If |settings_.on_frame_ready| is not nullptr, the decoded frames are passed
+  // to that callback instead of being returned by DequeueFrame(). In that case,
+  // when the decoder is not operating in frame parallel mode, this call decodes
+  // the frame and invokes the callback before returning, and it returns the
+  // decoding errors. In frame parallel mode, kStatusTryAgain means that the
+  // application has to wait for the callback to output some frames, and a
+  // decoding error makes the subsequent calls fail.
   StatusCode EnqueueFrame(const uint8_t* data, size_t size,
                           int64_t user_private_data, void* buffer_private_data);
 
@@ -120,6 +180,9 @@ class LIBGAV1_PUBLIC Decoder {
   // then this call will return kStatusTryAgain if an enqueued frame is not yet
   // decoded (it is a non blocking call in this case). In all other cases, this
   // call will block until an enqueued frame has been decoded.
+  //
+  // Returns kStatusInvalidArgument if |settings_.on_frame_ready| is not
+  // nullptr.
   StatusCode DequeueFrame(const DecoderBuffer** out_ptr);
 
   // Signals the end of stream.
@@ -130,13 +193,73 @@ class LIBGAV1_PUBLIC Decoder {
   // the frame buffers were allocated by the application, then any references
   // that libgav1 is holding on to will be released.
   //
+  // If |settings_.on_frame_ready| is not nullptr, this function first waits
+  // until all the enqueued frames have been passed to the callback, unless
+  // there was a decoding error.
+  //
   // Once this function returns successfully, the decoder state will be reset
   // and the decoder is ready to start decoding a new coded video sequence.
   StatusCode SignalEOS();
 
+  // Discards all the enqueued frames and the stream state (the reference
+  // frames and the sequence header) so that the decoder can start decoding an
+  // unrelated stream, e.g. after a channel change. Unlike SignalEOS(), the
+  // threads, the pooled frame buffers and the other allocations are kept, so
+  // the first frames of the new stream are decoded without the start up cost
+  // of a new decoder.
+  //
+  // The input buffers of the discarded frames are passed to
+  // |settings_.release_input_buffer| and the frames are not output. In frame
+  // parallel mode, this function first waits until the frames that are being
+  // decoded are done. The pointer obtained by the prior DequeueFrame call will
+  // no longer be valid.
+  //
+  // In frame parallel mode, the frame threading is still set up according to
+  // the first frame that was enqueued after Init(), as it is across coded
+  // video sequences.
+  //
+  // If there was a decoding error, the decoder is initialized again as in
+  // SignalEOS().
+  StatusCode Reset();
+
+  // Does the allocations that the first frames of a stream would otherwise do,
+  // so that these frames are decoded as fast as the ones that follow: the
+  // worker threads, the frame buffers (through the frame buffer callbacks if
+  // they are set) and the scratch buffers for frames of up to
+  // |max_width|x|max_height| pixels with the given |bitdepth| and
+  // |image_format|.
+  //
+  // Should be called after Init() (or Reset()) and before the first frame is
+  // enqueued. Returns kStatusTryAgain if there are enqueued frames that have
+  // not been dequeued yet.
+  //
+  // In frame parallel mode, the decoder decides whether to use frame parallel
+  // mode, and with how many frame threads, when the first frame is enqueued.
+  // If Prewarm() is called before that, it makes this decision as if the
+  // stream had a single tile, with at most |frame_parallel_depth| frames
+  // decoded in parallel (0 means no limit). |frame_parallel_depth| is ignored
+  // otherwise.
+  StatusCode Prewarm(int max_width, int max_height, int bitdepth,
+                     ImageFormat image_format, int frame_parallel_depth);
+
   // Returns the maximum bitdepth that is supported by this decoder.
   static int GetMaxBitdepth();
 
+  // Fills |usage| with the number of bytes currently held by each part of the
+  // decoder and the largest number of bytes held since Init(). Returns
+  // kStatusNotInitialized if Init() has not been called successfully.
+  StatusCode GetMemoryUsage(MemoryUsage* usage) const;
+
+  // Frees the memory that the decoder keeps for reuse but does not currently
+  // need: the frame buffers and buffer pool entries that no frame refers to,
+  // and the pooled scratch buffers, which are allocated again at the size of
+  // the current stream when they are next needed. The reference frames and the
+  // frames that have been output are not affected, and neither are the worker
+  // threads. This is useful after decoding high resolution frames followed by
+  // lower resolution ones. Returns kStatusNotInitialized if Init() has not been
+  // called successfully.
+  StatusCode TrimMemory();
+
   // Returns a vector with the QP values for all the frames in the last temporal
   // unit in encoding/decoding order (Note: not display order). If no frames are
   // present in the last temporal unit the method returns an empty vector.
@@ -148,7 +271,12 @@ class LIBGAV1_PUBLIC Decoder {
   std::vector<int> GetFramesMeanQpInTemporalUnit();
 
  private:
+  // Replaces |impl_| with a new instance and keeps its memory usage peaks.
+  StatusCode RecreateImpl();
+
   DecoderSettings settings_;
+  // A copy of the CPUs in |settings_.affinity_cpus|, which points to it.
+  std::vector<int> affinity_cpus_;
   // The object is initialized if and only if impl_ != nullptr.
   std::unique_ptr<DecoderImpl> impl_;
   std::vector<int> frame_mean_qps_;
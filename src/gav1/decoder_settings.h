@@ -18,11 +18,14 @@
 #define LIBGAV1_SRC_GAV1_DECODER_SETTINGS_H_
 
 #if defined(__cplusplus)
+#include <cstddef>
 #include <cstdint>
 #else
+#include <stddef.h>
 #include <stdint.h>
 #endif  // defined(__cplusplus)
 
+#include "gav1/decoder_buffer.h"
 #include "gav1/frame_buffer.h"
 #include "gav1/symbol_visibility.h"
 
@@ -40,6 +43,43 @@ extern "C" {
 typedef void (*Libgav1ReleaseInputBufferCallback)(void* callback_private_data,
                                                   void* buffer_private_data);
 
+// This callback is invoked by the decoder when a frame is ready to be output.
+// It replaces the DequeueFrame() calls when it is set. The frames are output in
+// the same order as they would be returned by DequeueFrame().
+//
+// |buffer| and the frame it describes are only valid until the callback
+// returns. |buffer->user_private_data| is the value passed in the
+// EnqueueFrame() call of the temporal unit that contains the frame.
+typedef void (*Libgav1FrameReadyCallback)(void* callback_private_data,
+                                          const Libgav1DecoderBuffer* buffer);
+
+// A unit of work handed to the application's executor. It must be called
+// exactly once with the |task_data| it was scheduled with.
+typedef void (*Libgav1ExecutorTask)(void* task_data);
+
+// This callback is invoked by the decoder to run |task| on one of the
+// application's worker threads. It must not block waiting for |task| to run
+// and should not run |task| in the calling thread. All the tasks scheduled by
+// a decoder instance have been run by the time it is destroyed.
+//
+// |executor_private_data| is the value of the executor_private_data setting.
+typedef void (*Libgav1ExecutorScheduleCallback)(void* executor_private_data,
+                                                Libgav1ExecutorTask task,
+                                                void* task_data);
+
+// Where the worker threads created by the decoder run. The thread that calls
+// the decoder functions is never affected.
+typedef enum Libgav1ThreadAffinity {
+  // The operating system decides.
+  kLibgav1ThreadAffinityNone,
+  // The worker threads run on the CPUs given in the affinity_cpus setting.
+  kLibgav1ThreadAffinityCpuSet,
+  // The worker threads that work on the same frame are kept on the CPUs of one
+  // NUMA node, and the nodes are filled one after the other. The frame
+  // buffers allocated by the decoder are placed on the nodes that are used.
+  kLibgav1ThreadAffinityCompactPerNode
+} Libgav1ThreadAffinity;
+
 typedef struct Libgav1DecoderSettings {
   // Number of threads to use when decoding. Must be greater than 0. The library
   // will create at most |threads| new threads. Defaults to 1 (no new threads
@@ -86,6 +126,46 @@ typedef struct Libgav1DecoderSettings {
   // A boolean. If set to 1, the decoder will only parse the bitstream, i.e., no
   // decoding will take place.
   int parse_only;
+  // Optional. If not NULL, the decoder does not create any threads and runs
+  // its multi-threaded work on the application-owned executor instead. Up to
+  // |threads| - 1 tasks of this decoder are handed to the executor at a time,
+  // so several decoder instances can share one executor without starving
+  // each other. Frame parallel decoding is not used with an executor.
+  Libgav1ExecutorScheduleCallback executor_schedule;
+  // Passed as the executor_private_data argument to |executor_schedule|.
+  void* executor_private_data;
+  // A boolean. If set to 1, the decoder measures how much time each frame
+  // spends in parsing, reconstruction, post filtering and film grain
+  // synthesis, and uses these measurements to rebalance the threads between
+  // tiles and superblock rows for the next frames. Ignored if |threads| is 1
+  // or in frame parallel mode.
+  int adaptive_threading;
+  // Where the worker threads run. Only supported on Linux, ignored elsewhere.
+  // Ignored if executor_schedule is not NULL.
+  Libgav1ThreadAffinity thread_affinity;
+  // The CPUs to run the worker threads on when thread_affinity is
+  // kLibgav1ThreadAffinityCpuSet. CPUs are numbered as by the operating
+  // system. The array is only read by Libgav1DecoderCreate().
+  const int* affinity_cpus;
+  // Number of elements in affinity_cpus.
+  int num_affinity_cpus;
+  // The number of bytes of memory the decoder should stay under, 0 for no
+  // limit. When the first frame is enqueued, the decoder estimates its memory
+  // use from the frame size and lowers the frame parallel depth and the number
+  // of threads until the estimate fits. A stream whose frames need more memory
+  // than the limit with one thread is still decoded. The estimate includes the
+  // frame buffers, even if the application provides them.
+  size_t max_memory_bytes;
+  // Optional. If not NULL, the frames are output through this callback and
+  // Libgav1DecoderDequeueFrame must not be called. In frame parallel mode, the
+  // callback is invoked from one of the decoder's threads as soon as a frame
+  // and all the frames before it are decoded, and it may also be invoked from
+  // Libgav1DecoderEnqueueFrame. Otherwise, it is invoked from
+  // Libgav1DecoderEnqueueFrame, which decodes the frame before returning.
+  // Libgav1DecoderSignalEOS waits for all the enqueued frames to be output.
+  // The callback is never invoked concurrently with itself and must not call
+  // the decoder functions.
+  Libgav1FrameReadyCallback on_frame_ready;
 } Libgav1DecoderSettings;
 
 LIBGAV1_PUBLIC void Libgav1DecoderSettingsInitDefault(
@@ -97,6 +177,15 @@ LIBGAV1_PUBLIC void Libgav1DecoderSettingsInitDefault(
 namespace libgav1 {
 
 using ReleaseInputBufferCallback = Libgav1ReleaseInputBufferCallback;
+using FrameReadyCallback = Libgav1FrameReadyCallback;
+using ExecutorTask = Libgav1ExecutorTask;
+using ExecutorScheduleCallback = Libgav1ExecutorScheduleCallback;
+
+using ThreadAffinity = Libgav1ThreadAffinity;
+constexpr ThreadAffinity kThreadAffinityNone = kLibgav1ThreadAffinityNone;
+constexpr ThreadAffinity kThreadAffinityCpuSet = kLibgav1ThreadAffinityCpuSet;
+constexpr ThreadAffinity kThreadAffinityCompactPerNode =
+    kLibgav1ThreadAffinityCompactPerNode;
 
 // Applications must populate this structure before creating a decoder instance.
 struct DecoderSettings {
@@ -145,6 +234,45 @@ struct DecoderSettings {
   // If set to true, the decoder will only parse the bitstream, i.e., no
   // decoding will take place.
   bool parse_only = false;
+  // Optional. If not nullptr, the decoder does not create any threads and runs
+  // its multi-threaded work on the application-owned executor instead. Up to
+  // |threads| - 1 tasks of this decoder are handed to the executor at a time,
+  // so several decoder instances can share one executor without starving
+  // each other. Frame parallel decoding is not used with an executor.
+  ExecutorScheduleCallback executor_schedule = nullptr;
+  // Passed as the executor_private_data argument to |executor_schedule|.
+  void* executor_private_data = nullptr;
+  // If set to true, the decoder measures how much time each frame spends in
+  // parsing, reconstruction, post filtering and film grain synthesis, and uses
+  // these measurements to rebalance the threads between tiles and superblock
+  // rows for the next frames. Ignored if |threads| is 1 or in frame parallel
+  // mode.
+  bool adaptive_threading = false;
+  // Where the worker threads run. Only supported on Linux, ignored elsewhere.
+  // Ignored if |executor_schedule| is not nullptr.
+  ThreadAffinity thread_affinity = kThreadAffinityNone;
+  // The CPUs to run the worker threads on when |thread_affinity| is
+  // kThreadAffinityCpuSet. CPUs are numbered as by the operating system. The
+  // array is only read by Decoder::Init().
+  const int* affinity_cpus = nullptr;
+  // Number of elements in |affinity_cpus|.
+  int num_affinity_cpus = 0;
+  // The number of bytes of memory the decoder should stay under, 0 for no
+  // limit. When the first frame is enqueued, the decoder estimates its memory
+  // use from the frame size and lowers the frame parallel depth and the number
+  // of threads until the estimate fits. A stream whose frames need more memory
+  // than the limit with one thread is still decoded. The estimate includes the
+  // frame buffers, even if the application provides them.
+  size_t max_memory_bytes = 0;
+  // Optional. If not nullptr, the frames are output through this callback and
+  // DequeueFrame() must not be called. In frame parallel mode, the callback is
+  // invoked from one of the decoder's threads as soon as a frame and all the
+  // frames before it are decoded, and it may also be invoked from
+  // EnqueueFrame(). Otherwise, it is invoked from EnqueueFrame(), which
+  // decodes the frame before returning. SignalEOS() waits for all the enqueued
+  // frames to be output. The callback is never invoked concurrently with
+  // itself and must not call the decoder functions.
+  FrameReadyCallback on_frame_ready = nullptr;
 };
 
 }  // namespace libgav1
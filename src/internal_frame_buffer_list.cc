@@ -20,7 +20,9 @@
 #include <new>
 #include <utility>
 
+#include "src/memory_tracker.h"
 #include "src/utils/common.h"
+#include "src/utils/cpu_affinity.h"
 
 namespace libgav1 {
 extern "C" {
@@ -98,6 +100,15 @@ StatusCode InternalFrameBufferList::GetFrameBuffer(
     std::unique_ptr<uint8_t[], MallocDeleter> new_data(
         static_cast<uint8_t*>(malloc(min_size)));
     if (new_data == nullptr) return kStatusOutOfMemory;
+    // This only moves the pages that have not been written to yet, which is
+    // usually all of them for an allocation of that size.
+    if (memory_nodes_ != 0) {
+      BindMemoryToNumaNodes(new_data.get(), min_size, memory_nodes_);
+    }
+    if (memory_tracker_ != nullptr) {
+      memory_tracker_->Update(kMemoryCategoryFrameBuffers, buffer->size,
+                              min_size);
+    }
     buffer->data = std::move(new_data);
     buffer->size = min_size;
   }
@@ -119,4 +130,22 @@ void InternalFrameBufferList::ReleaseFrameBuffer(void* buffer_private_data) {
   buffer->in_use = false;
 }
 
+void InternalFrameBufferList::Trim() {
+  size_t num_buffers = 0;
+  for (size_t i = 0; i < buffers_.size(); ++i) {
+    if (!buffers_[i]->in_use) {
+      if (memory_tracker_ != nullptr) {
+        memory_tracker_->Subtract(kMemoryCategoryFrameBuffers,
+                                  buffers_[i]->size);
+      }
+      buffers_[i] = nullptr;
+      continue;
+    }
+    // The frame buffers in use point to the Buffer objects, which do not move.
+    if (i != num_buffers) buffers_[num_buffers] = std::move(buffers_[i]);
+    ++num_buffers;
+  }
+  buffers_.erase(buffers_.begin() + num_buffers, buffers_.end());
+}
+
 }  // namespace libgav1
@@ -27,6 +27,8 @@
 
 namespace libgav1 {
 
+class MemoryTracker;
+
 extern "C" Libgav1StatusCode OnInternalFrameBufferSizeChanged(
     void* callback_private_data, int bitdepth, Libgav1ImageFormat image_format,
     int width, int height, int left_border, int right_border, int top_border,
@@ -66,6 +68,19 @@ class InternalFrameBufferList : public Allocable {
 
   void ReleaseFrameBuffer(void* buffer_private_data);
 
+  // Frees the buffers that are not in use.
+  void Trim();
+
+  // Sets the NUMA nodes (bit i is node i) that the buffers allocated from now
+  // on are placed on. 0 means no preference.
+  void set_memory_nodes(uint64_t node_mask) { memory_nodes_ = node_mask; }
+
+  // Counts the buffers allocated from now on in |memory_tracker|, which must
+  // outlive this object.
+  void set_memory_tracker(MemoryTracker* memory_tracker) {
+    memory_tracker_ = memory_tracker;
+  }
+
  private:
   struct Buffer : public Allocable {
     std::unique_ptr<uint8_t[], MallocDeleter> data;
@@ -74,6 +89,8 @@ class InternalFrameBufferList : public Allocable {
   };
 
   Vector<std::unique_ptr<Buffer>> buffers_;
+  uint64_t memory_nodes_ = 0;
+  MemoryTracker* memory_tracker_ = nullptr;
 };
 
 }  // namespace libgav1
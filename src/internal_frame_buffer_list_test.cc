@@ -19,6 +19,7 @@
 #include "gtest/gtest.h"
 #include "src/gav1/decoder_buffer.h"
 #include "src/gav1/frame_buffer.h"
+#include "src/memory_tracker.h"
 
 namespace libgav1 {
 namespace {
@@ -41,7 +42,6 @@ class InternalFrameBufferListTest : public testing::Test {
   // Private data associated with the frame buffer callbacks.
   void* callback_private_data_;
 
- private:
   InternalFrameBufferList buffer_list_;
 };
 
@@ -154,5 +154,50 @@ TEST_F(InternalFrameBufferListTest, VaryingBufferSizes) {
   }
 }
 
+TEST_F(InternalFrameBufferListTest, Trim) {
+  const int bitdepth = 8;
+  const Libgav1ImageFormat image_format = kLibgav1ImageFormatYuv420;
+  const int width = 100;
+  const int height = 50;
+  const int border = 0;
+  const int stride_alignment = 16;
+  MemoryTracker memory_tracker;
+  buffer_list_.set_memory_tracker(&memory_tracker);
+
+  FrameBuffer frame_buffers[3];
+  for (auto& frame_buffer : frame_buffers) {
+    ASSERT_EQ(get_frame_buffer_(callback_private_data_, bitdepth, image_format,
+                                width, height, border, border, border, border,
+                                stride_alignment, &frame_buffer),
+              0);
+  }
+  MemoryUsage usage;
+  memory_tracker.Get(&usage);
+  const size_t buffer_size =
+      usage.current_bytes[kMemoryCategoryFrameBuffers] / 3;
+  EXPECT_GT(buffer_size, size_t{0});
+
+  release_frame_buffer_(callback_private_data_, frame_buffers[0].private_data);
+  release_frame_buffer_(callback_private_data_, frame_buffers[2].private_data);
+  buffer_list_.Trim();
+  memory_tracker.Get(&usage);
+  EXPECT_EQ(usage.current_bytes[kMemoryCategoryFrameBuffers], buffer_size);
+  EXPECT_EQ(usage.peak_bytes[kMemoryCategoryFrameBuffers], 3 * buffer_size);
+
+  // The buffer in use is not affected.
+  frame_buffers[1].plane[0][0] = 1;
+  frame_buffers[1].plane[2][frame_buffers[1].stride[2] - 1] = 1;
+  release_frame_buffer_(callback_private_data_, frame_buffers[1].private_data);
+  ASSERT_EQ(get_frame_buffer_(callback_private_data_, bitdepth, image_format,
+                              width, height, border, border, border, border,
+                              stride_alignment, &frame_buffers[0]),
+            0);
+  EXPECT_EQ(frame_buffers[0].plane[0], frame_buffers[1].plane[0]);
+  release_frame_buffer_(callback_private_data_, frame_buffers[0].private_data);
+  buffer_list_.Trim();
+  memory_tracker.Get(&usage);
+  EXPECT_EQ(usage.current_bytes[kMemoryCategoryFrameBuffers], size_t{0});
+}
+
 }  // namespace
 }  // namespace libgav1
@@ -35,6 +35,7 @@ list(APPEND libgav1_decoder_sources
             "${libgav1_source}/internal_frame_buffer_list.h"
             "${libgav1_source}/loop_restoration_info.cc"
             "${libgav1_source}/loop_restoration_info.h"
+            "${libgav1_source}/memory_tracker.h"
             "${libgav1_source}/motion_vector.cc"
             "${libgav1_source}/motion_vector.h"
             "${libgav1_source}/obu_parser.cc"
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2023 The libgav1 Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIBGAV1_SRC_MEMORY_TRACKER_H_
+#define LIBGAV1_SRC_MEMORY_TRACKER_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+
+#include "src/gav1/decoder.h"
+
+namespace libgav1 {
+
+// Counts the bytes held by each part of the decoder, as reported by
+// Decoder::GetMemoryUsage(). All the functions are thread safe.
+class MemoryTracker {
+ public:
+  MemoryTracker() {
+    for (int i = 0; i < kNumMemoryCategories; ++i) {
+      current_[i] = 0;
+      peak_[i] = 0;
+    }
+  }
+
+  // Not copyable or movable.
+  MemoryTracker(const MemoryTracker&) = delete;
+  MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+  void Add(MemoryCategory category, size_t bytes) {
+    const size_t current =
+        current_[category].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    RaisePeak(category, current);
+  }
+
+  void Subtract(MemoryCategory category, size_t bytes) {
+    assert(current_[category].load(std::memory_order_relaxed) >= bytes);
+    current_[category].fetch_sub(bytes, std::memory_order_relaxed);
+  }
+
+  // Records that an allocation of |category| changed from |old_bytes| to
+  // |new_bytes|.
+  void Update(MemoryCategory category, size_t old_bytes, size_t new_bytes) {
+    if (new_bytes > old_bytes) {
+      Add(category, new_bytes - old_bytes);
+    } else {
+      Subtract(category, old_bytes - new_bytes);
+    }
+  }
+
+  void Get(MemoryUsage* const usage) const {
+    for (int i = 0; i < kNumMemoryCategories; ++i) {
+      usage->current_bytes[i] = current_[i].load(std::memory_order_relaxed);
+      usage->peak_bytes[i] = peak_[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  // Raises the peaks to at least the ones in |usage|. Used to keep the peaks
+  // of a previous instance of the decoder.
+  void RecordPeaks(const MemoryUsage& usage) {
+    for (int i = 0; i < kNumMemoryCategories; ++i) {
+      RaisePeak(static_cast<MemoryCategory>(i), usage.peak_bytes[i]);
+    }
+  }
+
+ private:
+  void RaisePeak(MemoryCategory category, size_t bytes) {
+    size_t peak = peak_[category].load(std::memory_order_relaxed);
+    while (bytes > peak && !peak_[category].compare_exchange_weak(
+                               peak, bytes, std::memory_order_relaxed)) {
+    }
+  }
+
+  std::atomic<size_t> current_[kNumMemoryCategories];
+  std::atomic<size_t> peak_[kNumMemoryCategories];
+};
+
+}  // namespace libgav1
+
+#endif  // LIBGAV1_SRC_MEMORY_TRACKER_H_
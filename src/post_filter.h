@@ -20,9 +20,13 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <condition_variable>  // NOLINT (unapproved c++11 header)
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT (unapproved c++11 header)
 #include <type_traits>
 
 #include "src/dsp/common.h"
@@ -33,6 +37,7 @@
 #include "src/utils/array_2d.h"
 #include "src/utils/block_parameters_holder.h"
 #include "src/utils/common.h"
+#include "src/utils/compiler_attributes.h"
 #include "src/utils/constants.h"
 #include "src/utils/memory.h"
 #include "src/utils/threadpool.h"
@@ -84,6 +89,10 @@ class PostFilter {
   PostFilter(PostFilter&&) = delete;
   PostFilter& operator=(PostFilter&&) = delete;
 
+  // Waits for the jobs scheduled by RunRowTasks() and SuperBlockRowDecoded()
+  // to finish.
+  ~PostFilter();
+
   // The overall function that applies all post processing filtering with
   // multiple threads.
   // * The filtering order is:
@@ -118,6 +127,29 @@ class PostFilter {
   //                with a shift to the left).
   void ApplyFilteringThreaded();
 
+  // Prepares the multi-threaded post filter to run while the tiles are still
+  // being decoded. The frame is filtered in units of 64 rows on |thread_pool_|
+  // with the same buffer layout as ApplyFilteringThreaded(). Each filter
+  // starts on a unit as soon as the superblock rows it depends on have been
+  // reported through SuperBlockRowDecoded() and the previous filters are done
+  // on the neighboring units. Returns false if this is not supported for the
+  // current frame (there is no |thread_pool_|, SuperRes is on or none of the
+  // filters are on) or if memory allocation fails. ApplyFilteringThreaded() has
+  // to be called once all the tiles are decoded in that case.
+  bool StartFilteringWithDecoding();
+
+  // Records that a tile has decoded its part of the superblock row starting at
+  // |row4x4| with a height of 4*|sb4x4|. Does nothing unless
+  // StartFilteringWithDecoding() returned true. May be called concurrently
+  // from multiple threads.
+  void SuperBlockRowDecoded(int row4x4, int sb4x4);
+
+  // Filters the units that are left once all the tiles have been decoded, waits
+  // for the jobs scheduled since StartFilteringWithDecoding() and extends the
+  // frame borders. Must be called only if StartFilteringWithDecoding() returned
+  // true and all the tiles were decoded successfully.
+  void FinishFilteringWithDecoding();
+
   // Does the overall post processing filter for one superblock row starting at
   // |row4x4| with height 4*|sb4x4|. If |do_deblock| is false, deblocking filter
   // will not be applied.
@@ -150,6 +182,15 @@ class PostFilter {
   // called only if |DoDeblock()| returns true.
   void ApplyDeblockFilter(LoopFilterType loop_filter_type, int row4x4_start,
                           int column4x4_start, int column4x4_end, int sb4x4);
+  // Same as above for the |num_ranges| disjoint column ranges starting at
+  // |column4x4_start[i]| and ending at |column4x4_end[i]|. The starts must be
+  // multiples of 16. If |row_thread_pool_| is not nullptr, the ranges are
+  // split into 64 wide column ranges that are filtered concurrently. This is
+  // possible since an edge only reads and modifies the pixels within half of
+  // the transform blocks on either side of it.
+  void ApplyDeblockFilter(LoopFilterType loop_filter_type, int row4x4_start,
+                          const int* column4x4_start, const int* column4x4_end,
+                          int num_ranges, int sb4x4);
 
   static bool DoCdef(const ObuFrameHeader& frame_header,
                      int do_post_filter_mask) {
@@ -241,8 +282,23 @@ class PostFilter {
   using DeblockFilter = void (PostFilter::*)(int row4x4_start, int row4x4_end,
                                              int column4x4_start,
                                              int column4x4_end);
+  // A task of RunRowTasks(). It is passed the index of the task.
+  using RowTask = std::function<void(int index)>;
   // Functions common to all post filters.
 
+  // Runs |task| for the indices in [0, |num_tasks|) and returns once all of
+  // them are done. If |row_thread_pool_| is not nullptr, the tasks are claimed
+  // in increasing order by the calling thread and by up to |num_tasks| - 1
+  // jobs scheduled on it. So a task may wait for a task with a lower index,
+  // but not the other way around. The calling thread does not wait for the
+  // jobs to start, so the tasks are not held up when the pool is busy.
+  void RunRowTasks(int num_tasks, const RowTask& task);
+  // Claims and runs the tasks of the RunRowTasks() call identified by
+  // |generation| until none are left.
+  void ClaimRowTasks(int generation);
+  // Job scheduled on |row_thread_pool_| by RunRowTasks().
+  void RowTaskJob(int generation);
+
   // Extends the frame by setting the border pixel values to the one from its
   // closest frame boundary.
   void ExtendFrameBoundary(uint8_t* frame_start, int width, int height,
@@ -313,6 +369,14 @@ class PostFilter {
                                           BlockParameters* const* bp_ptr,
                                           uint8_t* level_u, uint8_t* level_v,
                                           int* step, int* filter_length) const;
+  // Filters the luma edge segment at |src| and the one |offset| bytes further
+  // along the edge. A |level| of 0 skips that segment. When both segments
+  // share the level and filter size and Dsp::dual_loop_filters provides an
+  // implementation they are filtered with a single call.
+  void DeblockFilterSegmentPair(LoopFilterType type, uint8_t* src,
+                                ptrdiff_t stride, ptrdiff_t offset,
+                                const uint8_t level[2],
+                                const dsp::LoopFilterSize size[2]);
   void HorizontalDeblockFilter(int row4x4_start, int row4x4_end,
                                int column4x4_start, int column4x4_end);
   void VerticalDeblockFilter(int row4x4_start, int row4x4_end,
@@ -355,21 +419,37 @@ class PostFilter {
                         ptrdiff_t cdef_stride, bool y_plane,
                         const uint8_t border_columns[kMaxPlanes][256],
                         bool use_border_columns);
-  // Applies cdef for one 64x64 block.
+  // Applies cdef to the planes in [|plane_start|, |plane_end|) of one 64x64
+  // block. |direction_y| holds the 8x8 luma directions of the block. They are
+  // written by the luma pass and read by the chroma pass, so the luma plane
+  // has to be filtered before (or together with) the chroma planes.
   template <typename Pixel>
   void ApplyCdefForOneUnit(uint16_t* cdef_block, int index, int block_width4x4,
                            int block_height4x4, int row4x4_start,
                            int column4x4_start,
                            uint8_t border_columns[2][kMaxPlanes][256],
-                           bool use_border_columns[2][2]);
+                           bool use_border_columns[2][2], int plane_start,
+                           int plane_end, uint8_t direction_y[8 * 8]);
   // Helper function used by ApplyCdefForOneSuperBlockRow to avoid some code
-  // duplication.
+  // duplication. If [|plane_start|, |plane_end|) does not cover all the
+  // planes, the luma directions are exchanged through |cdef_directions_|
+  // with the 64x64 blocks numbered from |unit_start| onwards.
   void ApplyCdefForOneSuperBlockRowHelper(
       uint16_t* cdef_block, uint8_t border_columns[2][kMaxPlanes][256],
-      int row4x4, int block_height4x4);
+      int row4x4, int block_height4x4, int plane_start, int plane_end,
+      int unit_start);
   // Applies CDEF filtering for the superblock row starting at |row4x4| with a
-  // height of 4*|sb4x4|.
+  // height of 4*|sb4x4|. If |row_thread_pool_| is not nullptr, the chroma
+  // planes are filtered concurrently with the luma plane, each 64x64 block
+  // once its luma directions are known.
   void ApplyCdefForOneSuperBlockRow(int row4x4, int sb4x4, bool is_last_row);
+  // Filters the planes in [|plane_start|, |plane_end|) of the 64x64 block rows
+  // that ApplyCdefForOneSuperBlockRow() covers.
+  void ApplyCdefForPlanes(uint16_t* cdef_block, int row4x4_start, int sb4x4,
+                          bool is_last_row, int plane_start, int plane_end);
+  // Applies CDEF filtering for the 64 rows starting at |row4x4| in the
+  // multi-threaded case.
+  void ApplyCdefForOneRowOfUnits(int row4x4);
   // Worker function used for multi-threaded CDEF.
   void ApplyCdefWorker(std::atomic<int>* row4x4_atomic);
   static_assert(std::is_same<decltype(&PostFilter::ApplyCdefWorker),
@@ -435,11 +515,17 @@ class PostFilter {
                                      int current_process_unit_height,
                                      int plane_unit_size, Pixel* dst_buffer);
   // Applies loop restoration for the superblock row starting at |row4x4_start|
-  // with a height of 4*|sb4x4|.
+  // with a height of 4*|sb4x4| to the planes in [|plane_start|, |plane_end|).
   template <typename Pixel>
-  void ApplyLoopRestorationForOneSuperBlockRow(int row4x4_start, int sb4x4);
+  void ApplyLoopRestorationForOneSuperBlockRow(int row4x4_start, int sb4x4,
+                                               int plane_start, int plane_end);
   // Helper function that calls the right variant of
   // ApplyLoopRestorationForOneSuperBlockRow based on the bitdepth.
+  void ApplyLoopRestorationForPlanes(int row4x4_start, int sb4x4,
+                                     int plane_start, int plane_end);
+  // Applies loop restoration for all the planes of the superblock row starting
+  // at |row4x4_start| with a height of 4*|sb4x4|. The planes are filtered
+  // concurrently if |row_thread_pool_| is not nullptr.
   void ApplyLoopRestoration(int row4x4_start, int sb4x4);
   // Worker function used for multithreaded Loop Restoration.
   void ApplyLoopRestorationWorker(std::atomic<int>* row4x4_atomic);
@@ -447,6 +533,52 @@ class PostFilter {
                              WorkerFunction>::value,
                 "");
 
+  // Functions used when the post filter runs while the tiles are being
+  // decoded (see StartFilteringWithDecoding()).
+
+  // The filters that are applied to each unit of 64 rows, in order.
+  enum FilterStage {
+    kFilterStageVerticalDeblock,
+    kFilterStageHorizontalDeblock,
+    // Saves the rows that are needed by CDEF and loop restoration of the
+    // neighboring units before they are overwritten.
+    kFilterStageBorders,
+    kFilterStageCdef,
+    kFilterStageLoopRestoration,
+    kNumFilterStages
+  };
+  // Progress of one unit of 64 rows.
+  struct FilterUnitState {
+    // Number of tiles that have decoded the rows of this unit.
+    uint8_t decoded_tile_columns;
+    // Bit |stage| is set once |stage| is done for this unit.
+    uint8_t done_stages;
+  };
+  // Returns the number of units that |stage| is applied to. Loop restoration
+  // works with a lag of 8 rows and hence needs an extra unit at the bottom.
+  int NumFilterTasks(int stage) const {
+    return num_filter_units_ +
+           static_cast<int>(stage == kFilterStageLoopRestoration);
+  }
+  // The following functions must be called with |filter_mutex_| held.
+  // Returns true if |stage| can be applied to |unit|.
+  bool FilterTaskIsReady(int stage, int unit) const;
+  // Claims the next unit that is ready for one of the stages. Returns false if
+  // there is none.
+  bool GetNextFilterTask(int* stage, int* unit);
+  // Marks |stage| as done for |unit|.
+  void CompleteFilterTask(int stage, int unit);
+  // Returns the number of additional jobs that are needed to work on the units
+  // that are ready and accounts for them in |filter_jobs_pending_|.
+  int ReserveFilterJobs();
+
+  // Schedules |num_jobs| jobs that run FilterJob() on |thread_pool_|.
+  void ScheduleFilterJobs(int num_jobs);
+  // Applies |stage| to |unit|.
+  void RunFilterTask(int stage, int unit);
+  // Applies the filters to the units that are ready until there are none left.
+  void FilterJob();
+
   // The lookup table for picking the deblock filter, according to deblock
   // filter type.
   const DeblockFilter deblock_filter_func_[2] = {
@@ -516,14 +648,55 @@ class PostFilter {
   //   (2). Cdef is on, or multi-threading is enabled for post filter.
   YuvBuffer& loop_restoration_border_;
   ThreadPool* const thread_pool_;
+  // Used to spread the post filtering of a superblock row over multiple
+  // threads in frame parallel mode. nullptr otherwise.
+  ThreadPool* const row_thread_pool_;
+  // The following members are used only if |row_thread_pool_| is not nullptr.
+  std::mutex row_task_mutex_;
+  std::condition_variable row_task_condvar_;
+  // The tasks of the last RunRowTasks() call. |row_task_| is only valid while
+  // that call is running.
+  const RowTask* row_task_ LIBGAV1_GUARDED_BY(row_task_mutex_) = nullptr;
+  int row_task_generation_ LIBGAV1_GUARDED_BY(row_task_mutex_) = 0;
+  int num_row_tasks_ LIBGAV1_GUARDED_BY(row_task_mutex_) = 0;
+  // The next task to be claimed.
+  int next_row_task_ LIBGAV1_GUARDED_BY(row_task_mutex_) = 0;
+  // Number of claimed tasks that have not finished.
+  int row_tasks_running_ LIBGAV1_GUARDED_BY(row_task_mutex_) = 0;
+  // Number of jobs scheduled on |row_thread_pool_| that have not finished.
+  int row_jobs_pending_ LIBGAV1_GUARDED_BY(row_task_mutex_) = 0;
+  // Luma directions of the 64x64 blocks filtered by one
+  // ApplyCdefForOneSuperBlockRow() call, 64 bytes per block. nullptr if the
+  // planes are not filtered concurrently.
+  std::unique_ptr<uint8_t[]> cdef_directions_;
+  // Number of 64x64 blocks of the current ApplyCdefForOneSuperBlockRow() call
+  // whose luma directions are in |cdef_directions_|.
+  int cdef_luma_units_done_ LIBGAV1_GUARDED_BY(row_task_mutex_) = 0;
+  // The following members are used only if StartFilteringWithDecoding()
+  // returned true. |num_filter_units_| is 0 otherwise.
+  int num_filter_units_ = 0;
+  std::unique_ptr<FilterUnitState[]> filter_unit_state_;
+  std::mutex filter_mutex_;
+  std::condition_variable filter_condvar_;
+  // Number of units at the top of the frame that are decoded by all the tiles.
+  int decoded_filter_units_ LIBGAV1_GUARDED_BY(filter_mutex_) = 0;
+  // The next unit to be claimed for each stage.
+  int next_filter_unit_[kNumFilterStages] LIBGAV1_GUARDED_BY(filter_mutex_) =
+      {};
+  // Number of units at the top of the frame for which each stage is done.
+  int done_filter_units_[kNumFilterStages] LIBGAV1_GUARDED_BY(filter_mutex_) =
+      {};
+  // Number of jobs scheduled by ScheduleFilterJobs() that have not finished.
+  int filter_jobs_pending_ LIBGAV1_GUARDED_BY(filter_mutex_) = 0;
 
   // Tracks the progress of the post filters.
   int progress_row_ = -1;
 
   // A block buffer to hold the input that is converted to uint16_t before
-  // cdef filtering. Only used in single threaded case. Y plane is processed
-  // separately. U and V planes are processed together. So it is sufficient to
-  // have this buffer to accommodate 2 planes at a time.
+  // cdef filtering. Only used in single threaded case (by the luma pass if the
+  // planes are filtered concurrently in frame parallel mode). Y plane is
+  // processed separately. U and V planes are processed together. So it is
+  // sufficient to have this buffer to accommodate 2 planes at a time.
   uint16_t cdef_block_[kCdefUnitSizeWithBorders * kCdefUnitSizeWithBorders * 2];
 
   template <int bitdepth, typename Pixel>
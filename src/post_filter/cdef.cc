@@ -278,7 +278,9 @@ void PostFilter::ApplyCdefForOneUnit(uint16_t* cdef_block, const int index,
                                      const int row4x4_start,
                                      const int column4x4_start,
                                      uint8_t border_columns[2][kMaxPlanes][256],
-                                     bool use_border_columns[2][2]) {
+                                     bool use_border_columns[2][2],
+                                     const int plane_start, const int plane_end,
+                                     uint8_t direction_y[8 * 8]) {
   // Cdef operates in 8x8 blocks (4x4 for chroma with subsampling).
   static constexpr int kStep = 8;
   static constexpr int kStep4x4 = 2;
@@ -322,14 +324,14 @@ void PostFilter::ApplyCdefForOneUnit(uint16_t* cdef_block, const int index,
 
   if (index == -1) {
     if (thread_pool_ == nullptr) {
-      int plane = kPlaneY;
+      int plane = plane_start;
       do {
         CopyPixels(src_buffer_row_base[plane], frame_buffer_.stride(plane),
                    cdef_buffer_row_base[plane], frame_buffer_.stride(plane),
                    MultiplyBy4(block_width4x4) >> subsampling_x_[plane],
                    MultiplyBy4(block_height4x4) >> subsampling_y_[plane],
                    sizeof(Pixel));
-      } while (++plane < planes_);
+      } while (++plane < plane_end);
     }
     use_border_columns[border_columns_dst_index][0] = false;
     use_border_columns[border_columns_dst_index][1] = false;
@@ -338,152 +340,152 @@ void PostFilter::ApplyCdefForOneUnit(uint16_t* cdef_block, const int index,
 
   const bool is_frame_right =
       MultiplyBy4(column4x4_start + block_width4x4) >= frame_header_.width;
-  if (!is_frame_right && thread_pool_ != nullptr) {
-    // Backup the last 2 columns for use in the next iteration.
-    use_border_columns[border_columns_dst_index][0] = true;
-    const uint8_t* src_line =
-        GetSourceBuffer(kPlaneY, row4x4_start,
-                        column4x4_start + block_width4x4) -
-        kCdefBorder * sizeof(Pixel);
-    assert(border_columns != nullptr);
-    CopyPixels(src_line, frame_buffer_.stride(kPlaneY),
-               border_columns[border_columns_dst_index][kPlaneY],
-               kCdefBorder * sizeof(Pixel), kCdefBorder,
-               MultiplyBy4(block_height4x4), sizeof(Pixel));
-  }
-
-  PrepareCdefBlock<Pixel>(
-      block_width4x4, block_height4x4, row4x4_start, column4x4_start,
-      cdef_block, kCdefUnitSizeWithBorders, true,
-      (border_columns != nullptr) ? border_columns[border_columns_src_index]
-                                  : nullptr,
-      use_border_columns[border_columns_src_index][0]);
-
-  // Stored direction used during the u/v pass.  If bit 3 is set, then block is
-  // a skip.
-  uint8_t direction_y[8 * 8];
+  // If bit 3 of an entry of |direction_y| is set, then the block is a skip.
   int y_index = 0;
+  if (plane_start == kPlaneY) {
+    if (!is_frame_right && thread_pool_ != nullptr) {
+      // Backup the last 2 columns for use in the next iteration.
+      use_border_columns[border_columns_dst_index][0] = true;
+      const uint8_t* src_line =
+          GetSourceBuffer(kPlaneY, row4x4_start,
+                          column4x4_start + block_width4x4) -
+          kCdefBorder * sizeof(Pixel);
+      assert(border_columns != nullptr);
+      CopyPixels(src_line, frame_buffer_.stride(kPlaneY),
+                 border_columns[border_columns_dst_index][kPlaneY],
+                 kCdefBorder * sizeof(Pixel), kCdefBorder,
+                 MultiplyBy4(block_height4x4), sizeof(Pixel));
+    }
 
-  const uint8_t y_primary_strength =
-      frame_header_.cdef.y_primary_strength[index];
-  const uint8_t y_secondary_strength =
-      frame_header_.cdef.y_secondary_strength[index];
-  // y_strength_index is 0 for both primary and secondary strengths being
-  // non-zero, 1 for primary only, 2 for secondary only. This will be updated
-  // with y_primary_strength after variance is applied.
-  int y_strength_index = static_cast<int>(y_secondary_strength == 0);
-
-  const bool compute_direction_and_variance =
-      (y_primary_strength | frame_header_.cdef.uv_primary_strength[index]) != 0;
-  const uint8_t* skip_row =
-      &cdef_skip_[row4x4_start >> 1][column4x4_start >> 4];
-  const int skip_stride = cdef_skip_.columns();
-  int row4x4 = row4x4_start;
-  do {
-    uint8_t* cdef_buffer_base = cdef_buffer_row_base[kPlaneY];
-    const uint8_t* src_buffer_base = src_buffer_row_base[kPlaneY];
-    const uint16_t* cdef_src_base = cdef_src_row_base[kPlaneY];
-    int column4x4 = column4x4_start;
-
-    if (*skip_row == 0) {
-      for (int i = 0; i < DivideBy2(block_width4x4); ++i, ++y_index) {
-        direction_y[y_index] = kCdefSkip;
-      }
-      if (thread_pool_ == nullptr) {
-        CopyPixels(src_buffer_base, frame_buffer_.stride(kPlaneY),
-                   cdef_buffer_base, frame_buffer_.stride(kPlaneY), 64, kStep,
-                   sizeof(Pixel));
-      }
-    } else {
-      do {
-        const int block_width = kStep;
-        const int block_height = kStep;
-        const int cdef_stride = frame_buffer_.stride(kPlaneY);
-        uint8_t* const cdef_buffer = cdef_buffer_base;
-        const uint16_t* const cdef_src = cdef_src_base;
-        const int src_stride = frame_buffer_.stride(kPlaneY);
-        const uint8_t* const src_buffer = src_buffer_base;
+    PrepareCdefBlock<Pixel>(
+        block_width4x4, block_height4x4, row4x4_start, column4x4_start,
+        cdef_block, kCdefUnitSizeWithBorders, true,
+        (border_columns != nullptr) ? border_columns[border_columns_src_index]
+                                    : nullptr,
+        use_border_columns[border_columns_src_index][0]);
+
+    const uint8_t y_primary_strength =
+        frame_header_.cdef.y_primary_strength[index];
+    const uint8_t y_secondary_strength =
+        frame_header_.cdef.y_secondary_strength[index];
+    // y_strength_index is 0 for both primary and secondary strengths being
+    // non-zero, 1 for primary only, 2 for secondary only. This will be updated
+    // with y_primary_strength after variance is applied.
+    int y_strength_index = static_cast<int>(y_secondary_strength == 0);
+
+    const bool compute_direction_and_variance =
+        (y_primary_strength | frame_header_.cdef.uv_primary_strength[index]) !=
+        0;
+    const uint8_t* skip_row =
+        &cdef_skip_[row4x4_start >> 1][column4x4_start >> 4];
+    const int skip_stride = cdef_skip_.columns();
+    int row4x4 = row4x4_start;
+    do {
+      uint8_t* cdef_buffer_base = cdef_buffer_row_base[kPlaneY];
+      const uint8_t* src_buffer_base = src_buffer_row_base[kPlaneY];
+      const uint16_t* cdef_src_base = cdef_src_row_base[kPlaneY];
+      int column4x4 = column4x4_start;
 
-        const uint8_t skip_shift = (column4x4 >> 1) & 0x7;
-        const bool skip = ((*skip_row >> skip_shift) & 1) == 0;
-        if (skip) {  // No cdef filtering.
+      if (*skip_row == 0) {
+        for (int i = 0; i < DivideBy2(block_width4x4); ++i, ++y_index) {
           direction_y[y_index] = kCdefSkip;
-          if (thread_pool_ == nullptr) {
-            CopyPixels(src_buffer, src_stride, cdef_buffer, cdef_stride,
-                       block_width, block_height, sizeof(Pixel));
-          }
-        } else {
-          // Zero out residual skip flag.
-          direction_y[y_index] = 0;
-
-          int variance = 0;
-          if (compute_direction_and_variance) {
-            if (thread_pool_ == nullptr ||
-                row4x4 + kStep4x4 < row4x4_start + block_height4x4) {
-              dsp_.cdef_direction(src_buffer, src_stride, &direction_y[y_index],
-                                  &variance);
-            } else if (sizeof(Pixel) == 2) {
-              dsp_.cdef_direction(cdef_src, kCdefUnitSizeWithBorders * 2,
-                                  &direction_y[y_index], &variance);
-            } else {
-              // If we are in the last row4x4 for this unit, then the last two
-              // input rows have to come from |cdef_border_|. Since we already
-              // have |cdef_src| populated correctly, use that as the input
-              // for the direction process.
-              uint8_t direction_src[8][8];
-              const uint16_t* cdef_src_line = cdef_src;
-              for (auto& direction_src_line : direction_src) {
-                for (int i = 0; i < 8; ++i) {
-                  direction_src_line[i] = cdef_src_line[i];
-                }
-                cdef_src_line += kCdefUnitSizeWithBorders;
-              }
-              dsp_.cdef_direction(direction_src, 8, &direction_y[y_index],
-                                  &variance);
-            }
-          }
-          const int direction =
-              (y_primary_strength == 0) ? 0 : direction_y[y_index];
-          const int variance_strength =
-              ((variance >> 6) != 0) ? std::min(FloorLog2(variance >> 6), 12)
-                                     : 0;
-          const uint8_t primary_strength =
-              (variance != 0)
-                  ? (y_primary_strength * (4 + variance_strength) + 8) >> 4
-                  : 0;
-          if ((primary_strength | y_secondary_strength) == 0) {
+        }
+        if (thread_pool_ == nullptr) {
+          CopyPixels(src_buffer_base, frame_buffer_.stride(kPlaneY),
+                     cdef_buffer_base, frame_buffer_.stride(kPlaneY), 64, kStep,
+                     sizeof(Pixel));
+        }
+      } else {
+        do {
+          const int block_width = kStep;
+          const int block_height = kStep;
+          const int cdef_stride = frame_buffer_.stride(kPlaneY);
+          uint8_t* const cdef_buffer = cdef_buffer_base;
+          const uint16_t* const cdef_src = cdef_src_base;
+          const int src_stride = frame_buffer_.stride(kPlaneY);
+          const uint8_t* const src_buffer = src_buffer_base;
+
+          const uint8_t skip_shift = (column4x4 >> 1) & 0x7;
+          const bool skip = ((*skip_row >> skip_shift) & 1) == 0;
+          if (skip) {  // No cdef filtering.
+            direction_y[y_index] = kCdefSkip;
             if (thread_pool_ == nullptr) {
               CopyPixels(src_buffer, src_stride, cdef_buffer, cdef_stride,
                          block_width, block_height, sizeof(Pixel));
             }
           } else {
-            const int strength_index =
-                y_strength_index |
-                (static_cast<int>(primary_strength == 0) << 1);
-            dsp_.cdef_filters[1][strength_index](
-                cdef_src, kCdefUnitSizeWithBorders, block_height,
-                primary_strength, y_secondary_strength,
-                frame_header_.cdef.damping, direction, cdef_buffer,
-                cdef_stride);
+            // Zero out residual skip flag.
+            direction_y[y_index] = 0;
+
+            int variance = 0;
+            if (compute_direction_and_variance) {
+              if (thread_pool_ == nullptr ||
+                  row4x4 + kStep4x4 < row4x4_start + block_height4x4) {
+                dsp_.cdef_direction(src_buffer, src_stride,
+                                    &direction_y[y_index], &variance);
+              } else if (sizeof(Pixel) == 2) {
+                dsp_.cdef_direction(cdef_src, kCdefUnitSizeWithBorders * 2,
+                                    &direction_y[y_index], &variance);
+              } else {
+                // If we are in the last row4x4 for this unit, then the last two
+                // input rows have to come from |cdef_border_|. Since we already
+                // have |cdef_src| populated correctly, use that as the input
+                // for the direction process.
+                uint8_t direction_src[8][8];
+                const uint16_t* cdef_src_line = cdef_src;
+                for (auto& direction_src_line : direction_src) {
+                  for (int i = 0; i < 8; ++i) {
+                    direction_src_line[i] = cdef_src_line[i];
+                  }
+                  cdef_src_line += kCdefUnitSizeWithBorders;
+                }
+                dsp_.cdef_direction(direction_src, 8, &direction_y[y_index],
+                                    &variance);
+              }
+            }
+            const int direction =
+                (y_primary_strength == 0) ? 0 : direction_y[y_index];
+            const int variance_strength =
+                ((variance >> 6) != 0) ? std::min(FloorLog2(variance >> 6), 12)
+                                       : 0;
+            const uint8_t primary_strength =
+                (variance != 0)
+                    ? (y_primary_strength * (4 + variance_strength) + 8) >> 4
+                    : 0;
+            if ((primary_strength | y_secondary_strength) == 0) {
+              if (thread_pool_ == nullptr) {
+                CopyPixels(src_buffer, src_stride, cdef_buffer, cdef_stride,
+                           block_width, block_height, sizeof(Pixel));
+              }
+            } else {
+              const int strength_index =
+                  y_strength_index |
+                  (static_cast<int>(primary_strength == 0) << 1);
+              dsp_.cdef_filters[1][strength_index](
+                  cdef_src, kCdefUnitSizeWithBorders, block_height,
+                  primary_strength, y_secondary_strength,
+                  frame_header_.cdef.damping, direction, cdef_buffer,
+                  cdef_stride);
+            }
           }
-        }
-        cdef_buffer_base += column_step[kPlaneY];
-        src_buffer_base += column_step[kPlaneY];
-        cdef_src_base += column_step[kPlaneY] / sizeof(Pixel);
+          cdef_buffer_base += column_step[kPlaneY];
+          src_buffer_base += column_step[kPlaneY];
+          cdef_src_base += column_step[kPlaneY] / sizeof(Pixel);
 
-        column4x4 += kStep4x4;
-        y_index++;
-      } while (column4x4 < column4x4_start + block_width4x4);
-    }
+          column4x4 += kStep4x4;
+          y_index++;
+        } while (column4x4 < column4x4_start + block_width4x4);
+      }
 
-    cdef_buffer_row_base[kPlaneY] += cdef_buffer_row_base_stride[kPlaneY];
-    src_buffer_row_base[kPlaneY] += src_buffer_row_base_stride[kPlaneY];
-    cdef_src_row_base[kPlaneY] += cdef_src_row_base_stride[kPlaneY];
-    skip_row += skip_stride;
-    row4x4 += kStep4x4;
-  } while (row4x4 < row4x4_start + block_height4x4);
+      cdef_buffer_row_base[kPlaneY] += cdef_buffer_row_base_stride[kPlaneY];
+      src_buffer_row_base[kPlaneY] += src_buffer_row_base_stride[kPlaneY];
+      cdef_src_row_base[kPlaneY] += cdef_src_row_base_stride[kPlaneY];
+      skip_row += skip_stride;
+      row4x4 += kStep4x4;
+    } while (row4x4 < row4x4_start + block_height4x4);
+  }
 
-  if (planes_ == kMaxPlanesMonochrome) {
+  if (plane_end <= kPlaneU) {
     return;
   }
 
@@ -615,37 +617,61 @@ void PostFilter::ApplyCdefForOneUnit(uint16_t* cdef_block, const int index,
 
 void PostFilter::ApplyCdefForOneSuperBlockRowHelper(
     uint16_t* cdef_block, uint8_t border_columns[2][kMaxPlanes][256],
-    int row4x4, int block_height4x4) {
+    int row4x4, int block_height4x4, int plane_start, int plane_end,
+    int unit_start) {
   bool use_border_columns[2][2] = {};
   const bool non_zero_index = frame_header_.cdef.bits > 0;
   const int8_t* cdef_index =
       non_zero_index ? cdef_index_[DivideBy16(row4x4)] : nullptr;
+  // The luma directions are only exchanged through |cdef_directions_| if the
+  // luma and the chroma planes are filtered separately.
+  const bool luma_only = plane_start == kPlaneY && plane_end < planes_;
+  const bool chroma_only = plane_start != kPlaneY;
+  uint8_t direction_y_buffer[8 * 8];
+  int unit = unit_start;
   int column4x4 = 0;
   do {
     const int index = non_zero_index ? *cdef_index++ : 0;
     const int block_width4x4 =
         std::min(kStep64x64, frame_header_.columns4x4 - column4x4);
+    uint8_t* const direction_y = (luma_only || chroma_only)
+                                     ? &cdef_directions_[unit * 8 * 8]
+                                     : direction_y_buffer;
+    if (chroma_only) {
+      std::unique_lock<std::mutex> lock(row_task_mutex_);
+      row_task_condvar_.wait(
+          lock, [this, unit]() { return cdef_luma_units_done_ > unit; });
+    }
 
 #if LIBGAV1_MAX_BITDEPTH >= 10
     if (bitdepth_ >= 10) {
       ApplyCdefForOneUnit<uint16_t>(cdef_block, index, block_width4x4,
                                     block_height4x4, row4x4, column4x4,
-                                    border_columns, use_border_columns);
+                                    border_columns, use_border_columns,
+                                    plane_start, plane_end, direction_y);
     } else  // NOLINT
 #endif      // LIBGAV1_MAX_BITDEPTH >= 10
     {
       ApplyCdefForOneUnit<uint8_t>(cdef_block, index, block_width4x4,
                                    block_height4x4, row4x4, column4x4,
-                                   border_columns, use_border_columns);
+                                   border_columns, use_border_columns,
+                                   plane_start, plane_end, direction_y);
+    }
+    if (luma_only) {
+      std::lock_guard<std::mutex> lock(row_task_mutex_);
+      cdef_luma_units_done_ = unit + 1;
+      row_task_condvar_.notify_all();
     }
+    ++unit;
     column4x4 += kStep64x64;
   } while (column4x4 < frame_header_.columns4x4);
 }
 
-void PostFilter::ApplyCdefForOneSuperBlockRow(int row4x4_start, int sb4x4,
-                                              bool is_last_row) {
-  assert(row4x4_start >= 0);
-  assert(DoCdef());
+void PostFilter::ApplyCdefForPlanes(uint16_t* cdef_block, int row4x4_start,
+                                    int sb4x4, bool is_last_row,
+                                    int plane_start, int plane_end) {
+  const int units_per_row = RightShiftWithCeiling(frame_header_.columns4x4, 4);
+  int unit_start = 0;
   int row4x4 = row4x4_start;
   const int row4x4_limit = row4x4_start + sb4x4;
   do {
@@ -658,7 +684,9 @@ void PostFilter::ApplyCdefForOneSuperBlockRow(int row4x4_start, int sb4x4,
     // first iteration (row4x4 == row4x4_start).
     if (row4x4 > 0 && (!is_last_row || row4x4 == row4x4_start)) {
       assert(row4x4 >= 16);
-      ApplyCdefForOneSuperBlockRowHelper(cdef_block_, nullptr, row4x4 - 2, 2);
+      ApplyCdefForOneSuperBlockRowHelper(cdef_block, nullptr, row4x4 - 2, 2,
+                                         plane_start, plane_end, unit_start);
+      unit_start += units_per_row;
     }
 
     // Apply cdef for the current superblock row. If this is the last superblock
@@ -668,13 +696,56 @@ void PostFilter::ApplyCdefForOneSuperBlockRow(int row4x4_start, int sb4x4,
         std::min(kStep64x64, frame_header_.rows4x4 - row4x4);
     const int height4x4 = block_height4x4 - (is_last_row ? 0 : 2);
     if (height4x4 > 0) {
-      ApplyCdefForOneSuperBlockRowHelper(cdef_block_, nullptr, row4x4,
-                                         height4x4);
+      ApplyCdefForOneSuperBlockRowHelper(cdef_block, nullptr, row4x4,
+                                         height4x4, plane_start, plane_end,
+                                         unit_start);
+      unit_start += units_per_row;
     }
     row4x4 += kStep64x64;
   } while (row4x4 < row4x4_limit);
 }
 
+void PostFilter::ApplyCdefForOneSuperBlockRow(int row4x4_start, int sb4x4,
+                                              bool is_last_row) {
+  assert(row4x4_start >= 0);
+  assert(DoCdef());
+  if (cdef_directions_ == nullptr) {
+    ApplyCdefForPlanes(cdef_block_, row4x4_start, sb4x4, is_last_row, kPlaneY,
+                       planes_);
+    return;
+  }
+  // The planes are filtered in place independently of each other, except that
+  // the chroma planes use the directions computed by the luma pass. So the
+  // chroma planes are filtered one 64x64 block behind the luma plane.
+  {
+    std::lock_guard<std::mutex> lock(row_task_mutex_);
+    cdef_luma_units_done_ = 0;
+  }
+  RunRowTasks(2, [this, row4x4_start, sb4x4, is_last_row](int index) {
+    if (index == 0) {
+      ApplyCdefForPlanes(cdef_block_, row4x4_start, sb4x4, is_last_row,
+                         kPlaneY, kPlaneU);
+      return;
+    }
+    uint16_t cdef_block[kCdefUnitSizeWithBorders * kCdefUnitSizeWithBorders *
+                        2];
+    ApplyCdefForPlanes(cdef_block, row4x4_start, sb4x4, is_last_row, kPlaneU,
+                       kMaxPlanes);
+  });
+}
+
+void PostFilter::ApplyCdefForOneRowOfUnits(int row4x4) {
+  assert(row4x4 >= 0 && row4x4 < frame_header_.rows4x4);
+  uint16_t cdef_block[kCdefUnitSizeWithBorders * kCdefUnitSizeWithBorders * 2];
+  // Each border_column buffer has to store 64 rows and 2 columns for each
+  // plane. For 10bit, that is 64*2*2 = 256 bytes.
+  alignas(kMaxAlignment) uint8_t border_columns[2][kMaxPlanes][256];
+  ApplyCdefForOneSuperBlockRowHelper(
+      cdef_block, border_columns, row4x4,
+      std::min(kStep64x64, frame_header_.rows4x4 - row4x4), kPlaneY, planes_,
+      /*unit_start=*/0);
+}
+
 void PostFilter::ApplyCdefWorker(std::atomic<int>* row4x4_atomic) {
   int row4x4;
   uint16_t cdef_block[kCdefUnitSizeWithBorders * kCdefUnitSizeWithBorders * 2];
@@ -686,7 +757,8 @@ void PostFilter::ApplyCdefWorker(std::atomic<int>* row4x4_atomic) {
     const int block_height4x4 =
         std::min(kStep64x64, frame_header_.rows4x4 - row4x4);
     ApplyCdefForOneSuperBlockRowHelper(cdef_block, border_columns, row4x4,
-                                       block_height4x4);
+                                       block_height4x4, kPlaneY, planes_,
+                                       /*unit_start=*/0);
   }
 }
 
@@ -302,7 +302,6 @@ void PostFilter::HorizontalDeblockFilter(int row4x4_start, int row4x4_end,
   const int width4x4 = column4x4_end - column4x4_start;
   if (height4x4 <= 0 || width4x4 <= 0) return;
 
-  const int column_step = 1;
   const int src_step = 4 << pixel_size_log2_;
   const ptrdiff_t src_stride = frame_buffer_.stride(kPlaneY);
   uint8_t* src = GetSourceBuffer(kPlaneY, row4x4_start, column4x4_start);
@@ -312,9 +311,47 @@ void PostFilter::HorizontalDeblockFilter(int row4x4_start, int row4x4_end,
 
   const int width = frame_header_.width;
   const int height = frame_header_.height;
+  // With dual loop filters the edges of two adjacent columns are walked
+  // together so that segments on the same row can be filtered in one call.
+  const bool use_dual_filters =
+      dsp_.dual_loop_filters[dsp::kLoopFilterSize4]
+                            [kLoopFilterTypeHorizontal] != nullptr;
+  int column_step;
   for (int column4x4 = 0;
        column4x4 < width4x4 && MultiplyBy4(column4x4_start + column4x4) < width;
-       column4x4 += column_step, src += src_step) {
+       column4x4 += column_step, src += column_step * src_step) {
+    column_step = (use_dual_filters && column4x4 + 1 < width4x4 &&
+                   MultiplyBy4(column4x4_start + column4x4 + 1) < width)
+                      ? 2
+                      : 1;
+    if (column_step == 2) {
+      // The next row4x4 with an edge in each of the two columns.
+      int next_row4x4[2] = {0, 0};
+      while (true) {
+        const int row4x4 = std::min(next_row4x4[0], next_row4x4[1]);
+        if (row4x4 >= height4x4 ||
+            MultiplyBy4(row4x4_start + row4x4) >= height) {
+          break;
+        }
+        uint8_t levels[2] = {0, 0};
+        dsp::LoopFilterSize sizes[2] = {};
+        for (int i = 0; i < 2; ++i) {
+          if (next_row4x4[i] != row4x4) continue;
+          if (GetHorizontalDeblockFilterEdgeInfo(
+                  row4x4_start + row4x4, column4x4_start + column4x4 + i,
+                  &levels[i], &row_step, &filter_length)) {
+            sizes[i] = GetLoopFilterSizeY(filter_length);
+          } else {
+            levels[i] = 0;
+          }
+          next_row4x4[i] += DivideBy4(row_step);
+        }
+        DeblockFilterSegmentPair(kLoopFilterTypeHorizontal,
+                                 src + MultiplyBy4(row4x4) * src_stride,
+                                 src_stride, src_step, levels, sizes);
+      }
+      continue;
+    }
     uint8_t* src_row = src;
     for (int row4x4 = 0;
          row4x4 < height4x4 && MultiplyBy4(row4x4_start + row4x4) < height;
@@ -397,9 +434,50 @@ void PostFilter::VerticalDeblockFilter(int row4x4_start, int row4x4_end,
   const int column_step_shift = pixel_size_log2_;
   const int width = frame_header_.width;
   const int height = frame_header_.height;
+  // With dual loop filters the edges of two adjacent rows are walked together
+  // so that segments in the same column can be filtered in one call.
+  const bool use_dual_filters =
+      dsp_.dual_loop_filters[dsp::kLoopFilterSize4][kLoopFilterTypeVertical] !=
+      nullptr;
+  int row_step;
   for (int row4x4 = 0;
        row4x4 < height4x4 && MultiplyBy4(row4x4_start + row4x4) < height;
-       ++row4x4, src += row_stride, bp_row_base += bp_stride) {
+       row4x4 += row_step, src += row_step * row_stride,
+           bp_row_base += row_step * bp_stride) {
+    row_step = (use_dual_filters && row4x4 + 1 < height4x4 &&
+                MultiplyBy4(row4x4_start + row4x4 + 1) < height)
+                   ? 2
+                   : 1;
+    if (row_step == 2) {
+      // The next column4x4 with an edge in each of the two rows.
+      int next_column4x4[2] = {0, 0};
+      while (true) {
+        const int column4x4 = std::min(next_column4x4[0], next_column4x4[1]);
+        if (column4x4 >= width4x4 ||
+            MultiplyBy4(column4x4_start + column4x4) >= width) {
+          break;
+        }
+        uint8_t levels[2] = {0, 0};
+        dsp::LoopFilterSize sizes[2] = {};
+        for (int i = 0; i < 2; ++i) {
+          if (next_column4x4[i] != column4x4) continue;
+          if (GetVerticalDeblockFilterEdgeInfo(
+                  row4x4_start + row4x4 + i, column4x4_start + column4x4,
+                  bp_row_base + i * bp_stride + column4x4, &levels[i],
+                  &column_step, &filter_length)) {
+            sizes[i] = GetLoopFilterSizeY(filter_length);
+          } else {
+            levels[i] = 0;
+          }
+          next_column4x4[i] += DivideBy4(column_step);
+        }
+        DeblockFilterSegmentPair(
+            kLoopFilterTypeVertical,
+            src + (MultiplyBy4(column4x4) << column_step_shift), src_stride,
+            MultiplyBy4(src_stride), levels, sizes);
+      }
+      continue;
+    }
     uint8_t* src_row = src;
     BlockParameters* const* bp = bp_row_base;
     for (int column4x4 = 0; column4x4 < width4x4 &&
@@ -473,6 +551,28 @@ void PostFilter::VerticalDeblockFilter(int row4x4_start, int row4x4_end,
   }
 }
 
+void PostFilter::DeblockFilterSegmentPair(LoopFilterType type, uint8_t* src,
+                                          ptrdiff_t stride, ptrdiff_t offset,
+                                          const uint8_t level[2],
+                                          const dsp::LoopFilterSize size[2]) {
+  if (level[0] != 0 && level[0] == level[1] && size[0] == size[1] &&
+      dsp_.dual_loop_filters[size[0]][type] != nullptr) {
+    assert(level[0] <= kMaxLoopFilterValue);
+    dsp_.dual_loop_filters[size[0]][type](src, stride, outer_thresh_[level[0]],
+                                          inner_thresh_[level[0]],
+                                          HevThresh(level[0]));
+    return;
+  }
+  for (int i = 0; i < 2; ++i) {
+    if (level[i] == 0) continue;
+    assert(level[i] <= kMaxLoopFilterValue);
+    dsp_.loop_filters[size[i]][type](src + i * offset, stride,
+                                     outer_thresh_[level[i]],
+                                     inner_thresh_[level[i]],
+                                     HevThresh(level[i]));
+  }
+}
+
 template <LoopFilterType loop_filter_type>
 void PostFilter::DeblockFilterWorker(std::atomic<int>* row4x4_atomic) {
   const int rows4x4 = frame_header_.rows4x4;
@@ -503,4 +603,39 @@ void PostFilter::ApplyDeblockFilter(LoopFilterType loop_filter_type,
       row4x4_start, row4x4_start + sb4x4, column4x4_start, column4x4_end);
 }
 
+void PostFilter::ApplyDeblockFilter(LoopFilterType loop_filter_type,
+                                    int row4x4_start,
+                                    const int* const column4x4_start,
+                                    const int* const column4x4_end,
+                                    int num_ranges, int sb4x4) {
+  if (row_thread_pool_ == nullptr) {
+    for (int i = 0; i < num_ranges; ++i) {
+      ApplyDeblockFilter(loop_filter_type, row4x4_start, column4x4_start[i],
+                         column4x4_end[i], sb4x4);
+    }
+    return;
+  }
+  // Each task filters 64 columns of one of the ranges.
+  const auto num_units = [column4x4_start, column4x4_end](int i) {
+    return std::max(DivideBy16(column4x4_end[i] - column4x4_start[i] +
+                               kNum4x4InLoopFilterUnit - 1),
+                    0);
+  };
+  int num_tasks = 0;
+  for (int i = 0; i < num_ranges; ++i) {
+    assert((column4x4_start[i] & (kNum4x4InLoopFilterUnit - 1)) == 0);
+    num_tasks += num_units(i);
+  }
+  RunRowTasks(num_tasks, [this, loop_filter_type, row4x4_start,
+                          column4x4_start, column4x4_end, sb4x4,
+                          &num_units](int index) {
+    int i = 0;
+    while (index >= num_units(i)) index -= num_units(i++);
+    const int start = column4x4_start[i] + index * kNum4x4InLoopFilterUnit;
+    ApplyDeblockFilter(
+        loop_filter_type, row4x4_start, start,
+        std::min(start + kNum4x4InLoopFilterUnit, column4x4_end[i]), sb4x4);
+  });
+}
+
 }  // namespace libgav1
@@ -103,10 +103,13 @@ void PostFilter::ApplyLoopRestorationForOneRow(
 
 template <typename Pixel>
 void PostFilter::ApplyLoopRestorationForOneSuperBlockRow(const int row4x4_start,
-                                                         const int sb4x4) {
+                                                         const int sb4x4,
+                                                         const int plane_start,
+                                                         const int plane_end) {
   assert(row4x4_start >= 0);
   assert(DoRestoration());
-  int plane = kPlaneY;
+  assert(plane_start < plane_end && plane_end <= planes_);
+  int plane = plane_start;
   const int upscaled_width = frame_header_.upscaled_width;
   const int height = frame_header_.height;
   do {
@@ -144,17 +147,37 @@ void PostFilter::ApplyLoopRestorationForOneSuperBlockRow(const int row4x4_start,
           reinterpret_cast<Pixel*>(loop_restoration_buffer_[plane]) +
               y * stride);
     }
-  } while (++plane < planes_);
+  } while (++plane < plane_end);
 }
 
-void PostFilter::ApplyLoopRestoration(const int row4x4_start, const int sb4x4) {
+void PostFilter::ApplyLoopRestorationForPlanes(const int row4x4_start,
+                                               const int sb4x4,
+                                               const int plane_start,
+                                               const int plane_end) {
 #if LIBGAV1_MAX_BITDEPTH >= 10
   if (bitdepth_ >= 10) {
-    ApplyLoopRestorationForOneSuperBlockRow<uint16_t>(row4x4_start, sb4x4);
+    ApplyLoopRestorationForOneSuperBlockRow<uint16_t>(row4x4_start, sb4x4,
+                                                      plane_start, plane_end);
     return;
   }
 #endif
-  ApplyLoopRestorationForOneSuperBlockRow<uint8_t>(row4x4_start, sb4x4);
+  ApplyLoopRestorationForOneSuperBlockRow<uint8_t>(row4x4_start, sb4x4,
+                                                   plane_start, plane_end);
+}
+
+void PostFilter::ApplyLoopRestoration(const int row4x4_start, const int sb4x4) {
+  // The planes are filtered independently of each other.
+  int planes[kMaxPlanes];
+  int num_planes = 0;
+  for (int plane = kPlaneY; plane < planes_; ++plane) {
+    if (loop_restoration_.type[plane] != kLoopRestorationTypeNone) {
+      planes[num_planes++] = plane;
+    }
+  }
+  RunRowTasks(num_planes, [this, &planes, row4x4_start, sb4x4](int index) {
+    ApplyLoopRestorationForPlanes(row4x4_start, sb4x4, planes[index],
+                                  planes[index] + 1);
+  });
 }
 
 void PostFilter::ApplyLoopRestorationWorker(std::atomic<int>* row4x4_atomic) {
@@ -169,15 +192,8 @@ void PostFilter::ApplyLoopRestorationWorker(std::atomic<int>* row4x4_atomic) {
          row4x4_end) {
     CopyBordersForOneSuperBlockRow(row4x4, kNum4x4InLoopRestorationUnit,
                                    /*for_loop_restoration=*/true);
-#if LIBGAV1_MAX_BITDEPTH >= 10
-    if (bitdepth_ >= 10) {
-      ApplyLoopRestorationForOneSuperBlockRow<uint16_t>(
-          row4x4, kNum4x4InLoopRestorationUnit);
-      continue;
-    }
-#endif
-    ApplyLoopRestorationForOneSuperBlockRow<uint8_t>(
-        row4x4, kNum4x4InLoopRestorationUnit);
+    ApplyLoopRestorationForPlanes(row4x4, kNum4x4InLoopRestorationUnit,
+                                  kPlaneY, planes_);
   }
 }
 
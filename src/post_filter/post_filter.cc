@@ -20,6 +20,8 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <mutex>  // NOLINT (unapproved c++11 header)
+#include <new>
 
 #include "src/dsp/constants.h"
 #include "src/dsp/dsp.h"
@@ -90,7 +92,9 @@ PostFilter::PostFilter(const ObuFrameHeader& frame_header,
       cdef_border_(frame_scratch_buffer->cdef_border),
       loop_restoration_border_(frame_scratch_buffer->loop_restoration_border),
       thread_pool_(
-          frame_scratch_buffer->threading_strategy.post_filter_thread_pool()) {
+          frame_scratch_buffer->threading_strategy.post_filter_thread_pool()),
+      row_thread_pool_(frame_scratch_buffer->threading_strategy
+                           .post_filter_row_thread_pool()) {
   const int8_t zero_delta_lf[kFrameLfCount] = {};
   ComputeDeblockFilterLevels(zero_delta_lf, deblock_filter_levels_);
   if (DoSuperRes()) {
@@ -167,6 +171,24 @@ PostFilter::PostFilter(const ObuFrameHeader& frame_header,
                                (horizontal_shift << pixel_size_log2);
     } while (++plane < planes_);
   }
+  if (row_thread_pool_ != nullptr && DoCdef() && planes_ == kMaxPlanes) {
+    // ApplyCdefForOneSuperBlockRow() filters at most two 64x64 block rows of
+    // a 128x128 superblock row and the lagging rows of each of them. If the
+    // allocation fails, the planes are filtered together.
+    const int num_units =
+        4 * RightShiftWithCeiling(frame_header_.columns4x4, 4);
+    cdef_directions_.reset(new (std::nothrow) uint8_t[num_units * 8 * 8]);
+  }
+}
+
+PostFilter::~PostFilter() {
+  if (num_filter_units_ != 0) {
+    std::unique_lock<std::mutex> lock(filter_mutex_);
+    filter_condvar_.wait(lock, [this]() { return filter_jobs_pending_ == 0; });
+  }
+  if (row_thread_pool_ == nullptr) return;
+  std::unique_lock<std::mutex> lock(row_task_mutex_);
+  row_task_condvar_.wait(lock, [this]() { return row_jobs_pending_ == 0; });
 }
 
 // The following example illustrates how ExtendFrame() extends a frame.
@@ -572,6 +594,57 @@ void PostFilter::RunJobs(WorkerFunction worker) {
   pending_workers.Wait();
 }
 
+void PostFilter::RunRowTasks(const int num_tasks, const RowTask& task) {
+  if (row_thread_pool_ == nullptr || num_tasks <= 1) {
+    for (int i = 0; i < num_tasks; ++i) task(i);
+    return;
+  }
+  const int num_jobs =
+      std::min(num_tasks - 1, row_thread_pool_->num_threads());
+  int generation;
+  {
+    std::lock_guard<std::mutex> lock(row_task_mutex_);
+    generation = ++row_task_generation_;
+    row_task_ = &task;
+    num_row_tasks_ = num_tasks;
+    next_row_task_ = 0;
+    row_jobs_pending_ += num_jobs;
+  }
+  for (int i = 0; i < num_jobs; ++i) {
+    row_thread_pool_->Schedule(
+        [this, generation]() { RowTaskJob(generation); });
+  }
+  ClaimRowTasks(generation);
+  // Wait for the tasks claimed by the jobs. The jobs that have not started
+  // yet will find no task left to claim.
+  std::unique_lock<std::mutex> lock(row_task_mutex_);
+  row_task_condvar_.wait(lock, [this]() { return row_tasks_running_ == 0; });
+  row_task_ = nullptr;
+}
+
+void PostFilter::ClaimRowTasks(const int generation) {
+  std::unique_lock<std::mutex> lock(row_task_mutex_);
+  while (row_task_generation_ == generation &&
+         next_row_task_ < num_row_tasks_) {
+    const int index = next_row_task_++;
+    const RowTask& task = *row_task_;
+    ++row_tasks_running_;
+    lock.unlock();
+    task(index);
+    lock.lock();
+    if (--row_tasks_running_ == 0) row_task_condvar_.notify_all();
+  }
+}
+
+void PostFilter::RowTaskJob(const int generation) {
+  ClaimRowTasks(generation);
+  // Notify while holding the mutex since the destructor may run as soon as
+  // |row_jobs_pending_| becomes 0.
+  std::lock_guard<std::mutex> lock(row_task_mutex_);
+  --row_jobs_pending_;
+  row_task_condvar_.notify_all();
+}
+
 void PostFilter::ApplyFilteringThreaded() {
   if (DoDeblock()) {
     RunJobs(&PostFilter::DeblockFilterWorker<kLoopFilterTypeVertical>);
@@ -604,14 +677,220 @@ void PostFilter::ApplyFilteringThreaded() {
   ExtendBordersForReferenceFrame();
 }
 
+bool PostFilter::StartFilteringWithDecoding() {
+  assert(num_filter_units_ == 0);
+  if (thread_pool_ == nullptr || DoSuperRes() ||
+      (!DoDeblock() && !DoCdef() && !DoRestoration())) {
+    return false;
+  }
+  const int num_units = RightShiftWithCeiling(frame_header_.rows4x4, 4);
+  // Loop restoration needs an extra unit. See NumFilterTasks().
+  filter_unit_state_.reset(new (std::nothrow) FilterUnitState[num_units + 1]());
+  if (filter_unit_state_ == nullptr) return false;
+  num_filter_units_ = num_units;
+  return true;
+}
+
+void PostFilter::SuperBlockRowDecoded(int row4x4, int sb4x4) {
+  if (num_filter_units_ == 0) return;
+  const int unit_start = DivideBy16(row4x4);
+  const int unit_end = std::min(RightShiftWithCeiling(row4x4 + sb4x4, 4),
+                                num_filter_units_);
+  const int tile_columns = frame_header_.tile_info.tile_columns;
+  int num_jobs;
+  {
+    std::lock_guard<std::mutex> lock(filter_mutex_);
+    for (int unit = unit_start; unit < unit_end; ++unit) {
+      ++filter_unit_state_[unit].decoded_tile_columns;
+    }
+    while (decoded_filter_units_ < num_filter_units_ &&
+           filter_unit_state_[decoded_filter_units_].decoded_tile_columns ==
+               tile_columns) {
+      ++decoded_filter_units_;
+    }
+    num_jobs = ReserveFilterJobs();
+  }
+  ScheduleFilterJobs(num_jobs);
+}
+
+void PostFilter::FinishFilteringWithDecoding() {
+  assert(num_filter_units_ != 0);
+  std::unique_lock<std::mutex> lock(filter_mutex_);
+  assert(decoded_filter_units_ == num_filter_units_);
+  // Have the current thread partake in filtering until all the units are done.
+  while (done_filter_units_[kFilterStageLoopRestoration] <
+         NumFilterTasks(kFilterStageLoopRestoration)) {
+    int stage;
+    int unit;
+    if (!GetNextFilterTask(&stage, &unit)) {
+      filter_condvar_.wait(lock);
+      continue;
+    }
+    lock.unlock();
+    RunFilterTask(stage, unit);
+    lock.lock();
+    CompleteFilterTask(stage, unit);
+    const int num_jobs = ReserveFilterJobs();
+    if (num_jobs > 0) {
+      lock.unlock();
+      ScheduleFilterJobs(num_jobs);
+      lock.lock();
+    }
+  }
+  filter_condvar_.wait(lock, [this]() { return filter_jobs_pending_ == 0; });
+  lock.unlock();
+  ExtendBordersForReferenceFrame();
+}
+
+bool PostFilter::FilterTaskIsReady(int stage, int unit) const {
+  // The bottom row of each unit is used for the intra prediction of the next
+  // unit. Deblocking modifies it, so it has to wait until the next unit is
+  // decoded. Horizontal deblocking modifies the bottom rows of the unit above
+  // and the border rows have to be saved once deblocking is done. CDEF and
+  // loop restoration (with its lag of 8 rows) read the rows saved for the
+  // units above and below.
+  switch (stage) {
+    case kFilterStageVerticalDeblock:
+      return std::min(unit + 2, num_filter_units_) <= decoded_filter_units_;
+    case kFilterStageHorizontalDeblock:
+      return unit + 1 <= done_filter_units_[kFilterStageVerticalDeblock];
+    case kFilterStageBorders:
+      return std::min(unit + 2, num_filter_units_) <=
+             done_filter_units_[kFilterStageHorizontalDeblock];
+    case kFilterStageCdef:
+      return std::min(unit + 2, num_filter_units_) <=
+             done_filter_units_[kFilterStageBorders];
+    case kFilterStageLoopRestoration:
+      return std::min(unit + 1, num_filter_units_) <=
+             done_filter_units_[DoCdef() ? kFilterStageCdef
+                                         : kFilterStageBorders];
+    default:
+      assert(false);
+      return false;
+  }
+}
+
+bool PostFilter::GetNextFilterTask(int* const stage, int* const unit) {
+  // Prefer the later stages so that the units are completed as early as
+  // possible.
+  for (int s = kNumFilterStages - 1; s >= 0; --s) {
+    const int u = next_filter_unit_[s];
+    if (u < NumFilterTasks(s) && FilterTaskIsReady(s, u)) {
+      ++next_filter_unit_[s];
+      *stage = s;
+      *unit = u;
+      return true;
+    }
+  }
+  return false;
+}
+
+void PostFilter::CompleteFilterTask(int stage, int unit) {
+  filter_unit_state_[unit].done_stages |= 1 << stage;
+  int& done_units = done_filter_units_[stage];
+  while (done_units < NumFilterTasks(stage) &&
+         (filter_unit_state_[done_units].done_stages & (1 << stage)) != 0) {
+    ++done_units;
+  }
+  filter_condvar_.notify_all();
+}
+
+int PostFilter::ReserveFilterJobs() {
+  const int max_jobs = thread_pool_->num_threads();
+  int ready_tasks = 0;
+  for (int s = 0; s < kNumFilterStages && ready_tasks < max_jobs; ++s) {
+    for (int u = next_filter_unit_[s];
+         u < NumFilterTasks(s) && FilterTaskIsReady(s, u) &&
+         ready_tasks < max_jobs;
+         ++u) {
+      ++ready_tasks;
+    }
+  }
+  const int num_jobs = ready_tasks - filter_jobs_pending_;
+  if (num_jobs <= 0) return 0;
+  filter_jobs_pending_ += num_jobs;
+  return num_jobs;
+}
+
+void PostFilter::ScheduleFilterJobs(int num_jobs) {
+  for (int i = 0; i < num_jobs; ++i) {
+    thread_pool_->Schedule([this]() { FilterJob(); });
+  }
+}
+
+void PostFilter::RunFilterTask(int stage, int unit) {
+  const int row4x4 = unit * kNum4x4InLoopFilterUnit;
+  switch (stage) {
+    case kFilterStageVerticalDeblock:
+    case kFilterStageHorizontalDeblock:
+      if (DoDeblock()) {
+        const LoopFilterType type = (stage == kFilterStageVerticalDeblock)
+                                        ? kLoopFilterTypeVertical
+                                        : kLoopFilterTypeHorizontal;
+        (this->*deblock_filter_func_[type])(
+            row4x4, row4x4 + kNum4x4InLoopFilterUnit, 0,
+            frame_header_.columns4x4);
+      }
+      break;
+    case kFilterStageBorders:
+      if (DoCdef()) {
+        if (DoRestoration()) {
+          SetupLoopRestorationBorder(row4x4, kNum4x4InLoopFilterUnit);
+        }
+        SetupCdefBorder(row4x4);
+      } else if (DoRestoration()) {
+        SetupLoopRestorationBorder(row4x4);
+      }
+      break;
+    case kFilterStageCdef:
+      if (DoCdef()) ApplyCdefForOneRowOfUnits(row4x4);
+      break;
+    case kFilterStageLoopRestoration:
+      if (DoRestoration()) {
+        CopyBordersForOneSuperBlockRow(row4x4, kNum4x4InLoopRestorationUnit,
+                                       /*for_loop_restoration=*/true);
+        ApplyLoopRestorationForPlanes(row4x4, kNum4x4InLoopRestorationUnit,
+                                      kPlaneY, planes_);
+      }
+      break;
+    default:
+      assert(false);
+  }
+}
+
+void PostFilter::FilterJob() {
+  std::unique_lock<std::mutex> lock(filter_mutex_);
+  int stage;
+  int unit;
+  while (GetNextFilterTask(&stage, &unit)) {
+    lock.unlock();
+    RunFilterTask(stage, unit);
+    lock.lock();
+    CompleteFilterTask(stage, unit);
+    const int num_jobs = ReserveFilterJobs();
+    if (num_jobs > 0) {
+      lock.unlock();
+      ScheduleFilterJobs(num_jobs);
+      lock.lock();
+    }
+  }
+  // Notify while holding the lock so that the destructor cannot run before
+  // this job stops using the PostFilter.
+  --filter_jobs_pending_;
+  filter_condvar_.notify_all();
+}
+
 int PostFilter::ApplyFilteringForOneSuperBlockRow(int row4x4, int sb4x4,
                                                   bool is_last_row,
                                                   bool do_deblock) {
   if (row4x4 < 0) return -1;
   if (DoDeblock() && do_deblock) {
-    VerticalDeblockFilter(row4x4, row4x4 + sb4x4, 0, frame_header_.columns4x4);
-    HorizontalDeblockFilter(row4x4, row4x4 + sb4x4, 0,
-                            frame_header_.columns4x4);
+    const int column4x4_start = 0;
+    const int column4x4_end = frame_header_.columns4x4;
+    ApplyDeblockFilter(kLoopFilterTypeVertical, row4x4, &column4x4_start,
+                       &column4x4_end, 1, sb4x4);
+    ApplyDeblockFilter(kLoopFilterTypeHorizontal, row4x4, &column4x4_start,
+                       &column4x4_end, 1, sb4x4);
   }
   if (DoRestoration() && DoCdef()) {
     SetupLoopRestorationBorder(row4x4, sb4x4);
@@ -29,13 +29,18 @@
 #include "gtest/gtest.h"
 #include "src/dsp/cdef.h"
 #include "src/dsp/dsp.h"
+#include "src/dsp/loop_filter.h"
+#include "src/dsp/loop_restoration.h"
 #include "src/dsp/super_res.h"
 #include "src/frame_scratch_buffer.h"
 #include "src/obu_parser.h"
+#include "src/symbol_decoder_context.h"
 #include "src/threading_strategy.h"
 #include "src/utils/array_2d.h"
+#include "src/utils/block_parameters_holder.h"
 #include "src/utils/common.h"
 #include "src/utils/constants.h"
+#include "src/utils/entropy_decoder.h"
 #include "src/utils/memory.h"
 #include "src/utils/types.h"
 #include "src/yuv_buffer.h"
@@ -516,8 +521,8 @@ void PostFilterSuperResTest<bitdepth, Pixel>::TestApplySuperRes(
   constexpr int kNumThreads = 4;
   FrameScratchBuffer frame_scratch_buffer;
   if (multi_threaded) {
-    ASSERT_TRUE(frame_scratch_buffer.threading_strategy.Reset(frame_header,
-                                                              kNumThreads));
+    ASSERT_TRUE(frame_scratch_buffer.threading_strategy.Reset(
+        frame_header, kNumThreads, /*executor=*/nullptr));
   }
   const int pixel_size = sequence_header.color_config.bitdepth == 8
                              ? sizeof(uint8_t)
@@ -842,7 +847,9 @@ class PostFilterApplyCdefTest : public testing::TestWithParam<FrameSizeParam>,
   // Sets yuv_buffer_.
   void SetInputBuffer(libvpx_test::ACMRandom* rnd, PostFilter* post_filter);
   void CopyFilterOutputToDestBuffer();
-  void TestMultiThread(int num_threads);
+  // If |filter_with_decoding| is true, the superblock rows are reported to the
+  // PostFilter one by one as if they were being decoded.
+  void TestMultiThread(int num_threads, bool filter_with_decoding = false);
 
   ObuSequenceHeader sequence_header_;
   ObuFrameHeader frame_header_ = {};
@@ -877,6 +884,7 @@ void PostFilterApplyCdefTest<bitdepth, Pixel>::SetInput(
   frame_header_.columns4x4 = DivideBy4(Align(frame_header_.width, 8));
   frame_header_.rows4x4 = DivideBy4(Align(frame_header_.height, 8));
   frame_header_.tile_info.tile_count = 1;
+  frame_header_.tile_info.tile_columns = 1;
   frame_header_.refresh_frame_flags = 0;
   Cdef* const cdef = &frame_header_.cdef;
   const int coeff_shift = bitdepth - 8;
@@ -972,12 +980,12 @@ void PostFilterApplyCdefTest<bitdepth, Pixel>::CopyFilterOutputToDestBuffer() {
 
 template <int bitdepth, typename Pixel>
 void PostFilterApplyCdefTest<bitdepth, Pixel>::TestMultiThread(
-    int num_threads) {
+    int num_threads, bool filter_with_decoding) {
   libvpx_test::ACMRandom rnd(libvpx_test::ACMRandom::DeterministicSeed());
   SetInput(&rnd);
 
-  ASSERT_TRUE(frame_scratch_buffer_.threading_strategy.Reset(frame_header_,
-                                                             num_threads));
+  ASSERT_TRUE(frame_scratch_buffer_.threading_strategy.Reset(
+      frame_header_, num_threads, /*executor=*/nullptr));
   if (num_threads > 1) {
     const int num_units =
         MultiplyBy4(RightShiftWithCeiling(frame_header_.rows4x4, 4));
@@ -1001,7 +1009,16 @@ void PostFilterApplyCdefTest<bitdepth, Pixel>::TestMultiThread(
 
   // Only ApplyCdef() and frame copy inside ApplyFilteringThreaded() are
   // triggered, since we set the filter mask to 0x02.
-  post_filter.ApplyFilteringThreaded();
+  if (filter_with_decoding) {
+    ASSERT_TRUE(post_filter.StartFilteringWithDecoding());
+    const int sb4x4 = sequence_header_.use_128x128_superblock ? 32 : 16;
+    for (int row4x4 = 0; row4x4 < frame_header_.rows4x4; row4x4 += sb4x4) {
+      post_filter.SuperBlockRowDecoded(row4x4, sb4x4);
+    }
+    post_filter.FinishFilteringWithDecoding();
+  } else {
+    post_filter.ApplyFilteringThreaded();
+  }
   elapsed_time += absl::Now() - start;
 
   CopyFilterOutputToDestBuffer();
@@ -1045,6 +1062,12 @@ TEST_P(PostFilterApplyCdefTest8bpp, ApplyCdef) {
   TestMultiThread(8);
 }
 
+TEST_P(PostFilterApplyCdefTest8bpp, ApplyCdefWithDecoding) {
+  TestMultiThread(2, /*filter_with_decoding=*/true);
+  TestMultiThread(4, /*filter_with_decoding=*/true);
+  TestMultiThread(8, /*filter_with_decoding=*/true);
+}
+
 INSTANTIATE_TEST_SUITE_P(PostFilterApplyCdefTestInstance,
                          PostFilterApplyCdefTest8bpp,
                          testing::ValuesIn(kTestParamApplyCdef));
@@ -1058,6 +1081,12 @@ TEST_P(PostFilterApplyCdefTest10bpp, ApplyCdef) {
   TestMultiThread(8);
 }
 
+TEST_P(PostFilterApplyCdefTest10bpp, ApplyCdefWithDecoding) {
+  TestMultiThread(2, /*filter_with_decoding=*/true);
+  TestMultiThread(4, /*filter_with_decoding=*/true);
+  TestMultiThread(8, /*filter_with_decoding=*/true);
+}
+
 INSTANTIATE_TEST_SUITE_P(PostFilterApplyCdefTestInstance,
                          PostFilterApplyCdefTest10bpp,
                          testing::ValuesIn(kTestParamApplyCdef));
@@ -1072,9 +1101,344 @@ TEST_P(PostFilterApplyCdefTest12bpp, ApplyCdef) {
   TestMultiThread(8);
 }
 
+TEST_P(PostFilterApplyCdefTest12bpp, ApplyCdefWithDecoding) {
+  TestMultiThread(2, /*filter_with_decoding=*/true);
+  TestMultiThread(4, /*filter_with_decoding=*/true);
+  TestMultiThread(8, /*filter_with_decoding=*/true);
+}
+
 INSTANTIATE_TEST_SUITE_P(PostFilterApplyCdefTestInstance,
                          PostFilterApplyCdefTest12bpp,
                          testing::ValuesIn(kTestParamApplyCdef));
 #endif  // LIBGAV1_MAX_BITDEPTH == 12
 
+// Runs all the in-loop filters (deblocking, CDEF and loop restoration) one
+// superblock row at a time as in frame parallel mode, once without threads
+// and once with the rows spread over a thread pool, and checks that the
+// outputs match.
+template <int bitdepth, typename Pixel>
+class PostFilterFrameParallelTest
+    : public testing::TestWithParam<FrameSizeParam> {
+ public:
+  static_assert(bitdepth >= kBitdepth8 && bitdepth <= LIBGAV1_MAX_BITDEPTH, "");
+  PostFilterFrameParallelTest() = default;
+  PostFilterFrameParallelTest(const PostFilterFrameParallelTest&) = delete;
+  PostFilterFrameParallelTest& operator=(const PostFilterFrameParallelTest&) =
+      delete;
+  ~PostFilterFrameParallelTest() override = default;
+
+ protected:
+  void SetUp() override {
+    test_utils::ResetDspTable(bitdepth);
+    dsp::LoopFilterInit_C();
+    dsp::LoopFilterInit_SSE4_1();
+    dsp::LoopFilterInit_NEON();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+    dsp::LoopFilterInit10bpp_NEON();
+#endif
+    dsp::CdefInit_C();
+    dsp::CdefInit_SSE4_1();
+    dsp::CdefInit_NEON();
+    dsp::LoopRestorationInit_C();
+    dsp::LoopRestorationInit_SSE4_1();
+    dsp::LoopRestorationInit_NEON();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+    dsp::LoopRestorationInit10bpp_NEON();
+#endif
+
+    dsp_ = dsp::GetDspTable(bitdepth);
+    ASSERT_NE(dsp_, nullptr);
+  }
+
+  // Sets the headers and the filter parameters in |frame_scratch_buffer|, and
+  // allocates |yuv_buffer|. The same values are generated on every call.
+  void SetInput(FrameScratchBuffer* frame_scratch_buffer,
+                YuvBuffer* yuv_buffer);
+  // Fills |yuv_buffer| including its borders. The same values are generated
+  // on every call.
+  void SetInputBuffer(YuvBuffer* yuv_buffer);
+  // Filters the frame one superblock row at a time. If |num_threads| is 0,
+  // no thread pool is used.
+  void Filter(int num_threads, FrameScratchBuffer* frame_scratch_buffer,
+              YuvBuffer* yuv_buffer);
+  void TestFrameParallel(int num_threads);
+
+  ObuSequenceHeader sequence_header_;
+  ObuFrameHeader frame_header_ = {};
+  const dsp::Dsp* dsp_;
+  FrameSizeParam param_ = GetParam();
+};
+
+template <int bitdepth, typename Pixel>
+void PostFilterFrameParallelTest<bitdepth, Pixel>::SetInput(
+    FrameScratchBuffer* const frame_scratch_buffer,
+    YuvBuffer* const yuv_buffer) {
+  libvpx_test::ACMRandom rnd(libvpx_test::ACMRandom::DeterministicSeed());
+  sequence_header_.color_config.bitdepth = bitdepth;
+  sequence_header_.color_config.subsampling_x = param_.subsampling_x;
+  sequence_header_.color_config.subsampling_y = param_.subsampling_y;
+  sequence_header_.color_config.is_monochrome = false;
+  sequence_header_.use_128x128_superblock =
+      static_cast<bool>(rnd.Rand16() & 1);
+
+  frame_header_.width = param_.width;
+  frame_header_.upscaled_width = param_.upscaled_width;
+  frame_header_.height = param_.height;
+  frame_header_.columns4x4 = DivideBy4(Align(frame_header_.width, 8));
+  frame_header_.rows4x4 = DivideBy4(Align(frame_header_.height, 8));
+  frame_header_.tile_info.tile_count = 1;
+  frame_header_.tile_info.tile_columns = 1;
+  frame_header_.refresh_frame_flags = 0;
+
+  // Deblocking. The levels of the individual blocks are set below.
+  for (auto& level : frame_header_.loop_filter.level) {
+    level = 1;
+  }
+  const int rows4x4 = frame_header_.rows4x4 + kMaxBlockHeight4x4;
+  const int columns4x4 = frame_header_.columns4x4 + kMaxBlockWidth4x4;
+  ASSERT_TRUE(
+      frame_scratch_buffer->block_parameters_holder.Reset(rows4x4, columns4x4));
+  ASSERT_TRUE(frame_scratch_buffer->inter_transform_sizes.Reset(
+      rows4x4, columns4x4, /*zero_initialize=*/false));
+  static constexpr TransformSize kTransformSizes[3] = {
+      kTransformSize4x4, kTransformSize8x8, kTransformSize16x16};
+  for (int row4x4 = 0; row4x4 < rows4x4; row4x4 += 4) {
+    for (int column4x4 = 0; column4x4 < columns4x4; column4x4 += 4) {
+      BlockParameters* const bp =
+          frame_scratch_buffer->block_parameters_holder.Get(
+              row4x4, column4x4, kBlock16x16);
+      ASSERT_NE(bp, nullptr);
+      bp->size = kBlock16x16;
+      bp->skip = false;
+      bp->is_inter = false;
+      bp->uv_transform_size = kTransformSizes[rnd.Rand8() & 1];
+      for (auto& level : bp->deblock_filter_level) {
+        level = rnd.Rand8() & kMaxLoopFilterValue;
+      }
+      const TransformSize transform_size = kTransformSizes[rnd.Rand8() % 3];
+      for (int y = row4x4; y < std::min(row4x4 + 4, rows4x4); ++y) {
+        for (int x = column4x4; x < std::min(column4x4 + 4, columns4x4); ++x) {
+          frame_scratch_buffer->inter_transform_sizes[y][x] = transform_size;
+        }
+      }
+    }
+  }
+
+  // CDEF.
+  Cdef* const cdef = &frame_header_.cdef;
+  const int coeff_shift = bitdepth - 8;
+  cdef->damping = (rnd.Rand16() & 3) + 3 + coeff_shift;
+  cdef->bits = (rnd.Rand16() & 1) + 1;
+  for (int i = 0; i < (1 << cdef->bits); ++i) {
+    cdef->y_primary_strength[i] = (rnd.Rand16() & 15) << coeff_shift;
+    cdef->y_secondary_strength[i] = rnd.Rand16() & 3;
+    if (cdef->y_secondary_strength[i] == 3) {
+      ++cdef->y_secondary_strength[i];
+    }
+    cdef->y_secondary_strength[i] <<= coeff_shift;
+    cdef->uv_primary_strength[i] = (rnd.Rand16() & 15) << coeff_shift;
+    cdef->uv_secondary_strength[i] = rnd.Rand16() & 3;
+    if (cdef->uv_secondary_strength[i] == 3) {
+      ++cdef->uv_secondary_strength[i];
+    }
+    cdef->uv_secondary_strength[i] <<= coeff_shift;
+  }
+  const int rows64x64 = DivideBy16(rows4x4);
+  const int columns64x64 = DivideBy16(columns4x4);
+  ASSERT_TRUE(frame_scratch_buffer->cdef_index.Reset(rows64x64, columns64x64));
+  for (int row = 0; row < rows64x64; ++row) {
+    for (int column = 0; column < columns64x64; ++column) {
+      // Leave some of the blocks unfiltered (index -1).
+      const int index = rnd.Rand16() & ((2 << cdef->bits) - 1);
+      frame_scratch_buffer->cdef_index[row][column] =
+          (index < (1 << cdef->bits)) ? index : -1;
+    }
+  }
+  const int skip_rows = DivideBy2(rows4x4);
+  ASSERT_TRUE(frame_scratch_buffer->cdef_skip.Reset(skip_rows, columns64x64));
+  for (int row = 0; row < skip_rows; ++row) {
+    for (int column = 0; column < columns64x64; ++column) {
+      frame_scratch_buffer->cdef_skip[row][column] = rnd.Rand8() | 0x81;
+    }
+  }
+
+  // Loop restoration. Each unit is set to none, Wiener or self guided by
+  // decoding random data.
+  LoopRestoration* const loop_restoration = &frame_header_.loop_restoration;
+  const int luma_unit_size_log2 = 6 + rnd.Rand8() % 3;
+  const int uv_shift = (param_.subsampling_x != 0 && param_.subsampling_y != 0)
+                           ? rnd.Rand8() & 1
+                           : 0;
+  for (int plane = kPlaneY; plane < kMaxPlanes; ++plane) {
+    loop_restoration->type[plane] = kLoopRestorationTypeSwitchable;
+    loop_restoration->unit_size_log2[plane] =
+        luma_unit_size_log2 - ((plane == kPlaneY) ? 0 : uv_shift);
+  }
+  LoopRestorationInfo& restoration_info =
+      frame_scratch_buffer->loop_restoration_info;
+  ASSERT_TRUE(restoration_info.Reset(
+      loop_restoration, frame_header_.upscaled_width, frame_header_.height,
+      param_.subsampling_x, param_.subsampling_y, /*is_monochrome=*/false));
+  uint8_t data[1024];
+  for (auto& byte : data) {
+    byte = rnd.Rand8();
+  }
+  EntropyDecoder reader(data, sizeof(data), /*allow_update_cdf=*/true);
+  SymbolDecoderContext symbol_decoder_context;
+  symbol_decoder_context.Initialize(/*base_quantizer_index=*/0);
+  // Same as the defaults used by Tile::ResetLoopRestorationParams().
+  static constexpr int8_t kSgrProjDefaultMultiplier[2] = {-32, 31};
+  static constexpr int8_t kWienerDefaultFilter[kNumWienerCoefficients] = {
+      3, -7, 15};
+  std::array<RestorationUnitInfo, kMaxPlanes> reference_unit_info;
+  for (auto& unit_info : reference_unit_info) {
+    for (int i = WienerInfo::kVertical; i <= WienerInfo::kHorizontal; ++i) {
+      unit_info.sgr_proj_info.multiplier[i] = kSgrProjDefaultMultiplier[i];
+      for (int j = 0; j < kNumWienerCoefficients; ++j) {
+        unit_info.wiener_info.filter[i][j] = kWienerDefaultFilter[j];
+      }
+    }
+  }
+  for (int plane = kPlaneY; plane < kMaxPlanes; ++plane) {
+    for (int unit_id = 0;
+         unit_id < restoration_info.num_units(static_cast<Plane>(plane));
+         ++unit_id) {
+      restoration_info.ReadUnitCoefficients(
+          &reader, &symbol_decoder_context, static_cast<Plane>(plane),
+          unit_id, &reference_unit_info);
+    }
+  }
+  ASSERT_TRUE(frame_scratch_buffer->loop_restoration_border.Realloc(
+      bitdepth, /*is_monochrome=*/false, frame_header_.upscaled_width,
+      MultiplyBy4(RightShiftWithCeiling(frame_header_.rows4x4, 4)),
+      param_.subsampling_x, /*subsampling_y=*/0, kBorderPixels, kBorderPixels,
+      kBorderPixels, kBorderPixels, nullptr, nullptr, nullptr));
+
+  ASSERT_TRUE(yuv_buffer->Realloc(
+      bitdepth, /*is_monochrome=*/false, frame_header_.upscaled_width,
+      frame_header_.height, param_.subsampling_x, param_.subsampling_y,
+      kBorderPixels, kBorderPixels, kBorderPixels, kBorderPixels, nullptr,
+      nullptr, nullptr));
+}
+
+template <int bitdepth, typename Pixel>
+void PostFilterFrameParallelTest<bitdepth, Pixel>::SetInputBuffer(
+    YuvBuffer* const yuv_buffer) {
+  libvpx_test::ACMRandom rnd(libvpx_test::ACMRandom::DeterministicSeed());
+  for (int plane = kPlaneY; plane < kMaxPlanes; ++plane) {
+    // The buffers are shifted for in-place filtering, so the filters also read
+    // the padding at the end of each row. Fill it as well so that the two
+    // runs see the same values.
+    const int stride = yuv_buffer->stride(plane) / sizeof(Pixel);
+    const int height = yuv_buffer->top_border(plane) +
+                       yuv_buffer->height(plane) +
+                       yuv_buffer->bottom_border(plane);
+    Pixel* src = reinterpret_cast<Pixel*>(yuv_buffer->data(plane)) -
+                 yuv_buffer->top_border(plane) * stride -
+                 yuv_buffer->left_border(plane);
+    for (int y = 0; y < height; ++y) {
+      const int width = (y == height - 1) ? yuv_buffer->left_border(plane) +
+                                                yuv_buffer->width(plane) +
+                                                yuv_buffer->right_border(plane)
+                                          : stride;
+      for (int x = 0; x < width; ++x) {
+        src[x] = rnd.Rand16() & ((1 << bitdepth) - 1);
+      }
+      src += stride;
+    }
+  }
+}
+
+template <int bitdepth, typename Pixel>
+void PostFilterFrameParallelTest<bitdepth, Pixel>::Filter(
+    int num_threads, FrameScratchBuffer* const frame_scratch_buffer,
+    YuvBuffer* const yuv_buffer) {
+  SetInput(frame_scratch_buffer, yuv_buffer);
+  if (num_threads > 0) {
+    ASSERT_TRUE(frame_scratch_buffer->threading_strategy.Reset(num_threads));
+  }
+  SetInputBuffer(yuv_buffer);
+  PostFilter post_filter(frame_header_, sequence_header_, frame_scratch_buffer,
+                         yuv_buffer, dsp_, /*do_post_filter_mask=*/0x0b);
+  ASSERT_TRUE(post_filter.DoDeblock());
+  ASSERT_TRUE(post_filter.DoCdef());
+  ASSERT_TRUE(post_filter.DoRestoration());
+  const int sb4x4 = sequence_header_.use_128x128_superblock ? 32 : 16;
+  for (int row4x4 = 0; row4x4 < frame_header_.rows4x4; row4x4 += sb4x4) {
+    post_filter.ApplyFilteringForOneSuperBlockRow(
+        row4x4, sb4x4, row4x4 + sb4x4 >= frame_header_.rows4x4,
+        /*do_deblock=*/true);
+  }
+}
+
+template <int bitdepth, typename Pixel>
+void PostFilterFrameParallelTest<bitdepth, Pixel>::TestFrameParallel(
+    int num_threads) {
+  FrameScratchBuffer frame_scratch_buffer;
+  YuvBuffer yuv_buffer;
+  Filter(/*num_threads=*/0, &frame_scratch_buffer, &yuv_buffer);
+  FrameScratchBuffer frame_parallel_scratch_buffer;
+  YuvBuffer frame_parallel_yuv_buffer;
+  Filter(num_threads, &frame_parallel_scratch_buffer,
+         &frame_parallel_yuv_buffer);
+
+  for (int plane = kPlaneY; plane < kMaxPlanes; ++plane) {
+    const int subsampling_x = (plane == kPlaneY) ? 0 : param_.subsampling_x;
+    const int subsampling_y = (plane == kPlaneY) ? 0 : param_.subsampling_y;
+    const int plane_width = SubsampledValue(param_.width, subsampling_x);
+    const int plane_height = SubsampledValue(param_.height, subsampling_y);
+    ASSERT_EQ(frame_parallel_yuv_buffer.stride(plane),
+              yuv_buffer.stride(plane));
+    const int stride = yuv_buffer.stride(plane) / sizeof(Pixel);
+    const auto* expected =
+        reinterpret_cast<const Pixel*>(yuv_buffer.data(plane));
+    const auto* actual =
+        reinterpret_cast<const Pixel*>(frame_parallel_yuv_buffer.data(plane));
+    for (int y = 0; y < plane_height; ++y) {
+      for (int x = 0; x < plane_width; ++x) {
+        ASSERT_EQ(actual[x], expected[x])
+            << "plane: " << plane << " x: " << x << " y: " << y
+            << " threads: " << num_threads;
+      }
+      expected += stride;
+      actual += stride;
+    }
+  }
+}
+
+const FrameSizeParam kTestParamFrameParallel[] = {
+    FrameSizeParam(352, 352, 288, 0, 0), FrameSizeParam(251, 251, 187, 0, 0),
+    FrameSizeParam(352, 352, 288, 1, 0), FrameSizeParam(251, 251, 187, 1, 0),
+    FrameSizeParam(352, 352, 288, 1, 1), FrameSizeParam(251, 251, 187, 1, 1),
+    FrameSizeParam(720, 720, 480, 1, 1),
+};
+
+using PostFilterFrameParallelTest8bpp =
+    PostFilterFrameParallelTest<8, uint8_t>;
+
+TEST_P(PostFilterFrameParallelTest8bpp, ApplyFilteringForOneSuperBlockRow) {
+  TestFrameParallel(1);
+  TestFrameParallel(2);
+  TestFrameParallel(4);
+}
+
+INSTANTIATE_TEST_SUITE_P(PostFilterFrameParallelTestInstance,
+                         PostFilterFrameParallelTest8bpp,
+                         testing::ValuesIn(kTestParamFrameParallel));
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+using PostFilterFrameParallelTest10bpp =
+    PostFilterFrameParallelTest<10, uint16_t>;
+
+TEST_P(PostFilterFrameParallelTest10bpp, ApplyFilteringForOneSuperBlockRow) {
+  TestFrameParallel(1);
+  TestFrameParallel(2);
+  TestFrameParallel(4);
+}
+
+INSTANTIATE_TEST_SUITE_P(PostFilterFrameParallelTestInstance,
+                         PostFilterFrameParallelTest10bpp,
+                         testing::ValuesIn(kTestParamFrameParallel));
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
 }  // namespace libgav1
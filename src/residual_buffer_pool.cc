@@ -17,6 +17,8 @@
 #include <mutex>  // NOLINT (unapproved c++11 header)
 #include <utility>
 
+#include "src/memory_tracker.h"
+
 namespace libgav1 {
 namespace {
 
@@ -100,6 +102,7 @@ void ResidualBufferPool::Reset(bool use_128x128_superblock, int subsampling_x,
     // The existing buffers (if any) are still valid, so don't do anything.
     return;
   }
+  const size_t allocated_buffer_size = AllocatedBufferSize();
   buffer_size_ = buffer_size;
   queue_size_ = queue_size;
   // The existing buffers (if any) are no longer valid since the buffer size or
@@ -112,6 +115,10 @@ void ResidualBufferPool::Reset(bool use_128x128_superblock, int subsampling_x,
     buffers.Swap(&buffers_);
     // Release mutex_ before freeing the buffers.
   }
+  if (memory_tracker_ != nullptr) {
+    memory_tracker_->Subtract(kMemoryCategoryResidual,
+                              buffers.Size() * allocated_buffer_size);
+  }
   // As the local variable |buffers| goes out of scope, its destructor frees
   // the buffers that were in the stack.
 }
@@ -124,6 +131,9 @@ std::unique_ptr<ResidualBuffer> ResidualBufferPool::Get() {
   }
   if (buffer == nullptr) {
     buffer = ResidualBuffer::Create(buffer_size_, queue_size_);
+    if (buffer != nullptr && memory_tracker_ != nullptr) {
+      memory_tracker_->Add(kMemoryCategoryResidual, AllocatedBufferSize());
+    }
   }
   return buffer;
 }
@@ -135,6 +145,24 @@ void ResidualBufferPool::Release(std::unique_ptr<ResidualBuffer> buffer) {
   buffers_.Push(std::move(buffer));
 }
 
+void ResidualBufferPool::Trim() {
+  ResidualBufferStack buffers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers.Swap(&buffers_);
+  }
+  if (memory_tracker_ != nullptr) {
+    memory_tracker_->Subtract(kMemoryCategoryResidual,
+                              buffers.Size() * AllocatedBufferSize());
+  }
+}
+
+size_t ResidualBufferPool::AllocatedBufferSize() const {
+  return sizeof(ResidualBuffer) + buffer_size_ +
+         queue_size_ *
+             (sizeof(TransformParameters) + sizeof(PartitionTreeNode));
+}
+
 size_t ResidualBufferPool::Size() const {
   std::lock_guard<std::mutex> lock(mutex_);
   return buffers_.Size();
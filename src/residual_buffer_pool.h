@@ -32,6 +32,8 @@
 
 namespace libgav1 {
 
+class MemoryTracker;
+
 // This class is used for parsing and decoding a superblock. Members of this
 // class are populated in the "parse" step and consumed in the "decode" step.
 class ResidualBuffer : public Allocable {
@@ -133,14 +135,27 @@ class ResidualBufferPool : public Allocable {
   // Subsequent calls to Get() may re-use this buffer.
   void Release(std::unique_ptr<ResidualBuffer> buffer);
 
+  // Frees the buffers in the stack.
+  void Trim();
+
   // Used only in the tests. Returns the number of buffers in the stack.
   size_t Size() const;
 
+  // Counts the buffers allocated from now on in |memory_tracker|, which must
+  // outlive the pool.
+  void set_memory_tracker(MemoryTracker* memory_tracker) {
+    memory_tracker_ = memory_tracker;
+  }
+
  private:
+  // Returns the number of bytes allocated for each buffer.
+  size_t AllocatedBufferSize() const;
+
   mutable std::mutex mutex_;
   ResidualBufferStack buffers_ LIBGAV1_GUARDED_BY(mutex_);
   size_t buffer_size_;
   int queue_size_;
+  MemoryTracker* memory_tracker_ = nullptr;
 };
 
 }  // namespace libgav1
@@ -19,6 +19,7 @@
 #include <utility>
 
 #include "gtest/gtest.h"
+#include "src/memory_tracker.h"
 #include "src/utils/constants.h"
 #include "src/utils/queue.h"
 #include "src/utils/types.h"
@@ -80,6 +81,32 @@ TEST(ResidualBufferTest, TestUsage) {
   EXPECT_EQ(pool.Size(), 0);
 }
 
+TEST(ResidualBufferTest, TestTrim) {
+  ResidualBufferPool pool(true, 1, 1, sizeof(int16_t));
+  MemoryTracker memory_tracker;
+  pool.set_memory_tracker(&memory_tracker);
+  std::unique_ptr<ResidualBuffer> buffer1 = pool.Get();
+  ASSERT_NE(buffer1, nullptr);
+  std::unique_ptr<ResidualBuffer> buffer2 = pool.Get();
+  ASSERT_NE(buffer2, nullptr);
+  MemoryUsage usage;
+  memory_tracker.Get(&usage);
+  const size_t buffer_size = usage.current_bytes[kMemoryCategoryResidual] / 2;
+  EXPECT_GT(buffer_size, 0);
+  pool.Release(std::move(buffer2));
+  EXPECT_EQ(pool.Size(), 1);
+  // Only the buffer in the stack is freed.
+  pool.Trim();
+  EXPECT_EQ(pool.Size(), 0);
+  memory_tracker.Get(&usage);
+  EXPECT_EQ(usage.current_bytes[kMemoryCategoryResidual], buffer_size);
+  pool.Release(std::move(buffer1));
+  EXPECT_EQ(pool.Size(), 1);
+  pool.Trim();
+  memory_tracker.Get(&usage);
+  EXPECT_EQ(usage.current_bytes[kMemoryCategoryResidual], 0);
+}
+
 TEST(ResidualBufferTest, TestQueue) {
   ResidualBufferPool pool(true, 1, 1, sizeof(int16_t));
   EXPECT_EQ(pool.Size(), 0);
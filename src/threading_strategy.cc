@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <memory>
 
 #include "src/frame_scratch_buffer.h"
@@ -64,15 +65,72 @@ int ComputeFrameThreadCount(int thread_count, int tile_count,
              : std::max(2, thread_count / (1 + tile_columns));
 }
 
+// Each frame contributes 1 / (1 << kStageTimeAverageWeightLog2) to the running
+// average of the stage times. This follows changes in the stream within a few
+// frames while smoothing out the noise of the individual measurements.
+constexpr int kStageTimeAverageWeightLog2 = 2;
+
 }  // namespace
 
+void ThreadPlacement::Init(ThreadAffinity affinity, const CpuSet& cpus,
+                           const NumaTopology& topology) {
+  affinity_ = affinity;
+  cpus_ = cpus;
+  topology_ = topology;
+  node_ = 0;
+  used_cpus_ = 0;
+  memory_nodes_ = 0;
+}
+
+CpuSet ThreadPlacement::Place(int num_threads) {
+  CpuSet cpus;
+  if (affinity_ == kThreadAffinityCpuSet) {
+    cpus = cpus_;
+  } else if (affinity_ == kThreadAffinityCompactPerNode) {
+    int total_cpus = 0;
+    for (int i = 0; i < topology_.num_nodes; ++i) {
+      total_cpus += topology_.node_cpus[i].Count();
+    }
+    if (total_cpus == 0) return cpus;
+    while (true) {
+      const CpuSet& node_cpus = topology_.node_cpus[node_];
+      const int available_cpus = node_cpus.Count() - used_cpus_;
+      // Only start a pool in a partially used node if the pool fits in it.
+      if (available_cpus > 0 &&
+          (available_cpus >= num_threads || used_cpus_ == 0)) {
+        const int count = std::min(available_cpus, num_threads);
+        cpus.Add(node_cpus);
+        used_cpus_ += count;
+        num_threads -= count;
+        if (num_threads <= 0) break;
+      }
+      node_ = (node_ + 1 == topology_.num_nodes) ? 0 : node_ + 1;
+      used_cpus_ = 0;
+    }
+  }
+  AddMemoryNodes(cpus);
+  return cpus;
+}
+
+void ThreadPlacement::AddMemoryNodes(const CpuSet& cpus) {
+  for (int i = 0; i < topology_.num_nodes; ++i) {
+    if (topology_.node_cpus[i].Intersects(cpus)) {
+      memory_nodes_ |= uint64_t{1} << i;
+    }
+  }
+}
+
 bool ThreadingStrategy::Reset(const ObuFrameHeader& frame_header,
-                              int thread_count) {
+                              int thread_count, Executor* const executor) {
   assert(thread_count > 0);
+  // Check adaptive() before |frame_parallel_| and |thread_pool_| are updated
+  // since the stage times were measured with their previous values.
+  if (adaptive()) UpdateAverageStageTimes();
   frame_parallel_ = false;
 
   if (thread_count == 1) {
     thread_pool_.reset(nullptr);
+    affinity_ = CpuSet();
     tile_thread_count_ = 0;
     max_tile_index_for_row_threads_ = 0;
     return true;
@@ -82,8 +140,18 @@ bool ThreadingStrategy::Reset(const ObuFrameHeader& frame_header,
   // |thread_count|-1 threads in the threadpool.
   thread_count = std::min(thread_count, static_cast<int>(kMaxThreads)) - 1;
 
-  if (thread_pool_ == nullptr || thread_pool_->num_threads() != thread_count) {
-    thread_pool_ = ThreadPool::Create("libgav1", thread_count);
+  const bool use_executor = executor != nullptr;
+  if (thread_pool_ == nullptr || thread_pool_->num_threads() != thread_count ||
+      use_executor !=
+          (thread_pool_->mode() == ThreadPool::Mode::kExternalExecutor)) {
+    affinity_ = (placement_ != nullptr && !use_executor)
+                    ? placement_->Place(thread_count)
+                    : CpuSet();
+    thread_pool_ =
+        use_executor
+            ? ThreadPool::Create(executor, thread_count)
+            : ThreadPool::Create("libgav1", thread_count,
+                                 ThreadPool::kDefaultMode, affinity_);
     if (thread_pool_ == nullptr) {
       LIBGAV1_DLOG(ERROR, "Failed to create a thread pool with %d threads.",
                    thread_count);
@@ -101,7 +169,7 @@ bool ThreadingStrategy::Reset(const ObuFrameHeader& frame_header,
     // tile_thread_count_ <= tile_count - 1.
     tile_thread_count_ = std::min(thread_count, tile_count - 1);
     thread_count -= tile_thread_count_;
-    if (thread_count == 0) {
+    if (thread_count == 0 || use_executor) {
       max_tile_index_for_row_threads_ = 0;
       return true;
     }
@@ -109,6 +177,18 @@ bool ThreadingStrategy::Reset(const ObuFrameHeader& frame_header,
     tile_thread_count_ = 0;
   }
 
+  const int64_t parse_time = average_stage_time_[kStageParse];
+  const int64_t reconstruct_time = average_stage_time_[kStageReconstruct];
+  if (adaptive_ && parse_time > 0 && reconstruct_time > 0) {
+    // The number of workers needed to reconstruct the superblocks as fast as
+    // a single thread parses them.
+    const int threads_per_tile = static_cast<int>(std::min<int64_t>(
+        (reconstruct_time + parse_time - 1) / parse_time, thread_count));
+    max_tile_index_for_row_threads_ = std::min(
+        tile_count, (thread_count + threads_per_tile - 1) / threads_per_tile);
+    return true;
+  }
+
 #if defined(__ANDROID__)
   // Assign the remaining threads for each Tile. The heuristic used here is that
   // we will assign two threads for each Tile. So for example, if |thread_count|
@@ -149,6 +229,20 @@ bool ThreadingStrategy::Reset(const ObuFrameHeader& frame_header,
   return true;
 }
 
+void ThreadingStrategy::UpdateAverageStageTimes() {
+  for (int stage = 0; stage < kNumStages; ++stage) {
+    const int64_t time =
+        stage_time_[stage].exchange(0, std::memory_order_relaxed);
+    // Stages that did not run for this frame (for example, film grain
+    // synthesis is not applied to every frame) keep their previous average.
+    if (time == 0) continue;
+    int64_t& average = average_stage_time_[stage];
+    average = (average == 0)
+                  ? time
+                  : average + ((time - average) >> kStageTimeAverageWeightLog2);
+  }
+}
+
 bool ThreadingStrategy::Reset(int thread_count) {
   assert(thread_count > 0);
   frame_parallel_ = true;
@@ -161,7 +255,10 @@ bool ThreadingStrategy::Reset(int thread_count) {
   max_tile_index_for_row_threads_ = 0;
 
   if (thread_pool_ == nullptr || thread_pool_->num_threads() != thread_count) {
-    thread_pool_ = ThreadPool::Create("libgav1-fp", thread_count);
+    affinity_ =
+        (placement_ != nullptr) ? placement_->Place(thread_count) : CpuSet();
+    thread_pool_ = ThreadPool::Create("libgav1-fp", thread_count,
+                                      ThreadPool::kDefaultMode, affinity_);
     if (thread_pool_ == nullptr) {
       LIBGAV1_DLOG(ERROR, "Failed to create a thread pool with %d threads.",
                    thread_count);
@@ -172,15 +269,20 @@ bool ThreadingStrategy::Reset(int thread_count) {
 }
 
 bool InitializeThreadPoolsForFrameParallel(
-    int thread_count, int tile_count, int tile_columns,
+    int thread_count, int tile_count, int tile_columns, int max_frame_threads,
     std::unique_ptr<ThreadPool>* const frame_thread_pool,
-    FrameScratchBufferPool* const frame_scratch_buffer_pool) {
+    FrameScratchBufferPool* const frame_scratch_buffer_pool,
+    ThreadPlacement* const placement) {
   assert(*frame_thread_pool == nullptr);
   thread_count = std::min(thread_count, static_cast<int>(kMaxThreads));
-  const int frame_threads =
-      ComputeFrameThreadCount(thread_count, tile_count, tile_columns);
-  if (frame_threads == 0) return true;
-  *frame_thread_pool = ThreadPool::Create(frame_threads);
+  assert(max_frame_threads > 0);
+  const int frame_threads = std::min(
+      ComputeFrameThreadCount(thread_count, tile_count, tile_columns),
+      max_frame_threads);
+  if (frame_threads < 2) return true;
+  *frame_thread_pool = ThreadPool::Create(
+      /*name_prefix=*/"", frame_threads, ThreadPool::kDefaultMode,
+      (placement != nullptr) ? placement->shared_cpus() : CpuSet());
   if (*frame_thread_pool == nullptr) {
     LIBGAV1_DLOG(ERROR, "Failed to create frame thread pool with %d threads.",
                  frame_threads);
@@ -204,6 +306,7 @@ bool InitializeThreadPoolsForFrameParallel(
     // threads.
     const int current_frame_thread_count =
         threads_per_frame + static_cast<int>(i < extra_threads);
+    frame_scratch_buffer->threading_strategy.set_placement(placement);
     if (!frame_scratch_buffer->threading_strategy.Reset(
             current_frame_thread_count)) {
       return false;
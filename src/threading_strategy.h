@@ -17,20 +17,86 @@
 #ifndef LIBGAV1_SRC_THREADING_STRATEGY_H_
 #define LIBGAV1_SRC_THREADING_STRATEGY_H_
 
+#include <atomic>
+#include <chrono>  // NOLINT (unapproved c++11 header)
+#include <cstdint>
 #include <memory>
 
+#include "src/gav1/decoder_settings.h"
 #include "src/obu_parser.h"
 #include "src/utils/compiler_attributes.h"
+#include "src/utils/cpu_affinity.h"
 #include "src/utils/threadpool.h"
 
 namespace libgav1 {
 
 class FrameScratchBufferPool;
 
+// This class decides which CPUs the worker threads of a decoder run on, and
+// which NUMA nodes its frame buffers are allocated on, according to the
+// thread_affinity setting.
+class ThreadPlacement {
+ public:
+  ThreadPlacement() = default;
+
+  // Not copyable or movable.
+  ThreadPlacement(const ThreadPlacement&) = delete;
+  ThreadPlacement& operator=(const ThreadPlacement&) = delete;
+
+  // |cpus| is only used with kThreadAffinityCpuSet. |topology| is used to find
+  // the NUMA nodes of the CPUs.
+  void Init(ThreadAffinity affinity, const CpuSet& cpus,
+            const NumaTopology& topology);
+
+  // Returns the CPUs that the |num_threads| worker threads of a new thread pool
+  // are to run on, or an empty set if they are not restricted.
+  // With kThreadAffinityCompactPerNode, each pool is given the CPUs of one NUMA
+  // node. The nodes are used in order, moving on to the next node when the
+  // current one has fewer unused CPUs than the pool has threads. A pool that
+  // has more threads than a node has CPUs spans consecutive nodes. When all the
+  // nodes are used, the next pool starts over with the first node.
+  CpuSet Place(int num_threads);
+
+  // Returns the CPUs that the threads that do not belong to a single pool (the
+  // frame threads) are to run on, or an empty set if they are not restricted.
+  // With kThreadAffinityCompactPerNode, these threads instead move to the CPUs
+  // of the pool that helps them with the frame they are decoding.
+  CpuSet shared_cpus() const {
+    return (affinity_ == kThreadAffinityCpuSet) ? cpus_ : CpuSet();
+  }
+
+  // Returns the NUMA nodes (bit i is node i) of the CPUs handed out by
+  // Place(), or 0 if the memory is to be allocated as usual.
+  uint64_t memory_nodes() const { return memory_nodes_; }
+
+ private:
+  // Adds the nodes that |cpus| intersects to |memory_nodes_|.
+  void AddMemoryNodes(const CpuSet& cpus);
+
+  ThreadAffinity affinity_ = kThreadAffinityNone;
+  CpuSet cpus_;
+  NumaTopology topology_;
+  // The node that the next pool is placed on and the number of its CPUs that
+  // have already been handed out.
+  int node_ = 0;
+  int used_cpus_ = 0;
+  uint64_t memory_nodes_ = 0;
+};
+
 // This class allocates and manages the worker threads among thread pools used
 // for multi-threaded decoding.
 class ThreadingStrategy {
  public:
+  // The stages of decoding a frame whose busy time is measured in adaptive
+  // mode.
+  enum Stage {
+    kStageParse,
+    kStageReconstruct,
+    kStagePostFilter,
+    kStageFilmGrain,
+    kNumStages
+  };
+
   ThreadingStrategy() = default;
 
   // Not copyable or movable.
@@ -47,10 +113,24 @@ class ThreadingStrategy {
   //   * One thread is allocated for decoding each Tile.
   //   * Any remaining threads are allocated for superblock row multi-threading
   //     within each of the tile in a round robin fashion.
+  // In adaptive mode (see set_adaptive()), the remaining threads are instead
+  // allocated based on the stage times measured for the previous frames. A
+  // tile that uses superblock row multi-threading is parsed by one thread and
+  // its superblocks are reconstructed by the workers. So each such tile is
+  // given as many workers as it takes to reconstruct what one thread can
+  // parse, and the number of tiles that use superblock row multi-threading is
+  // reduced accordingly. The first tile always uses it so that the ratio can
+  // still be measured.
+  // If |executor| is not nullptr, no threads are created. The thread pool
+  // instead runs at most |thread_count|-1 jobs at a time on |executor|. Since
+  // |executor| may be shared with other decoders, it cannot be relied upon to
+  // run all of those jobs concurrently. Tile threads wait for the superblock
+  // row jobs they schedule, so the two are not combined in that case: if there
+  // is more than one tile, the threads are used only for tile decoding.
   // Note: During the lifetime of a ThreadingStrategy object, only one of the
   // Reset() variants will be used.
   LIBGAV1_MUST_USE_RESULT bool Reset(const ObuFrameHeader& frame_header,
-                                     int thread_count);
+                                     int thread_count, Executor* executor);
 
   // Creates or re-allocates a thread pool with |thread_count| threads. This
   // function is used only in frame parallel mode. This function is idempotent
@@ -60,6 +140,38 @@ class ThreadingStrategy {
   // Reset() variants will be used.
   LIBGAV1_MUST_USE_RESULT bool Reset(int thread_count);
 
+  // Enables or disables the adaptive mode. Only used in non frame-parallel
+  // mode. Takes effect on the next call to Reset().
+  void set_adaptive(bool adaptive) { adaptive_ = adaptive; }
+
+  // Sets the object that decides which CPUs the threads created by the next
+  // calls to Reset() run on. May be nullptr, in which case the threads are not
+  // restricted.
+  void set_placement(ThreadPlacement* placement) { placement_ = placement; }
+
+  // Returns the CPUs that the threads of the underlying ThreadPool run on, or
+  // an empty set if they are not restricted.
+  const CpuSet& affinity() const { return affinity_; }
+
+  // Returns true if the stage times have to be measured, i.e. if the adaptive
+  // mode is enabled and more than one thread is used.
+  bool adaptive() const {
+    return adaptive_ && !frame_parallel_ && thread_pool_ != nullptr;
+  }
+
+  // Adds |nanoseconds| to the busy time of |stage| in the current frame. May be
+  // called concurrently from multiple threads.
+  void AddStageTime(Stage stage, int64_t nanoseconds) {
+    stage_time_[stage].fetch_add(nanoseconds, std::memory_order_relaxed);
+  }
+
+  // Returns the running average (in nanoseconds per frame) of the busy time of
+  // |stage|, as of the last call to Reset(). Returns 0 if |stage| has not been
+  // measured yet.
+  int64_t average_stage_time(Stage stage) const {
+    return average_stage_time_[stage];
+  }
+
   // Returns a pointer to the ThreadPool that is to be used for Tile
   // multi-threading.
   ThreadPool* tile_thread_pool() const {
@@ -88,22 +200,71 @@ class ThreadingStrategy {
     return frame_parallel_ ? nullptr : thread_pool_.get();
   }
 
+  // Returns a pointer to the ThreadPool that is to be used for spreading the
+  // post filtering of a superblock row over multiple threads.
+  // Note: Valid only when |frame_parallel_| is true.
+  ThreadPool* post_filter_row_thread_pool() const {
+    return frame_parallel_ ? thread_pool_.get() : nullptr;
+  }
+
   // Returns a pointer to the ThreadPool that is to be used for film grain
   // synthesis and blending.
   // Note: Valid only when |frame_parallel_| is false.
   ThreadPool* film_grain_thread_pool() const { return thread_pool_.get(); }
 
  private:
+  // Folds the stage times measured since the last call into
+  // |average_stage_time_| and clears them.
+  void UpdateAverageStageTimes();
+
   std::unique_ptr<ThreadPool> thread_pool_;
   int tile_thread_count_ = 0;
   int max_tile_index_for_row_threads_ = 0;
   bool frame_parallel_ = false;
+  bool adaptive_ = false;
+  ThreadPlacement* placement_ = nullptr;
+  CpuSet affinity_;
+  std::atomic<int64_t> stage_time_[kNumStages] = {};
+  int64_t average_stage_time_[kNumStages] = {};
+};
+
+// Adds the time between its construction and destruction to the busy time of
+// |stage| in |threading_strategy|, if the stage times have to be measured.
+class ScopedStageTimer {
+ public:
+  ScopedStageTimer(ThreadingStrategy* const threading_strategy,
+                   ThreadingStrategy::Stage stage)
+      : threading_strategy_(threading_strategy->adaptive() ? threading_strategy
+                                                           : nullptr),
+        stage_(stage) {
+    if (threading_strategy_ != nullptr) start_ = Clock::now();
+  }
+
+  // Not copyable or movable.
+  ScopedStageTimer(const ScopedStageTimer&) = delete;
+  ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+  ~ScopedStageTimer() {
+    if (threading_strategy_ == nullptr) return;
+    threading_strategy_->AddStageTime(
+        stage_, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    Clock::now() - start_)
+                    .count());
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  ThreadingStrategy* const threading_strategy_;
+  const ThreadingStrategy::Stage stage_;
+  Clock::time_point start_;
 };
 
 // Initializes the |frame_thread_pool| and the necessary worker threadpools (the
 // threading_strategy objects in each of the frame scratch buffer in
 // |frame_scratch_buffer_pool|) as follows:
-//  * frame_threads = ComputeFrameThreadCount();
+//  * frame_threads = min(ComputeFrameThreadCount(), max_frame_threads). Frame
+//    threading is not used if frame_threads is less than 2.
 //  * For more details on how frame_threads is computed, see the function
 //    comment in ComputeFrameThreadCount().
 //  * |frame_thread_pool| is created with |frame_threads| threads.
@@ -121,10 +282,12 @@ class ThreadingStrategy {
 //    * |frame_thread_pool| is nullptr. |frame_scratch_buffer_pool| is not
 //      modified. This means that frame threading will not be used and the
 //      decoder will continue to operate normally in non frame parallel mode.
+//  If |placement| is not nullptr, it decides which CPUs the threads run on.
 LIBGAV1_MUST_USE_RESULT bool InitializeThreadPoolsForFrameParallel(
-    int thread_count, int tile_count, int tile_columns,
+    int thread_count, int tile_count, int tile_columns, int max_frame_threads,
     std::unique_ptr<ThreadPool>* frame_thread_pool,
-    FrameScratchBufferPool* frame_scratch_buffer_pool);
+    FrameScratchBufferPool* frame_scratch_buffer_pool,
+    ThreadPlacement* placement);
 
 }  // namespace libgav1
 
@@ -21,8 +21,10 @@
 #include "absl/strings/str_cat.h"
 #include "gtest/gtest.h"
 #include "src/frame_scratch_buffer.h"
+#include "src/gav1/decoder_settings.h"
 #include "src/obu_parser.h"
 #include "src/utils/constants.h"
+#include "src/utils/cpu_affinity.h"
 #include "src/utils/threadpool.h"
 #include "src/utils/types.h"
 
@@ -37,7 +39,7 @@ class ThreadingStrategyTest : public testing::Test {
 
 TEST_F(ThreadingStrategyTest, MaxThreadEnforced) {
   frame_header_.tile_info.tile_count = 32;
-  ASSERT_TRUE(strategy_.Reset(frame_header_, 32));
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 32, /*executor=*/nullptr));
   EXPECT_NE(strategy_.tile_thread_pool(), nullptr);
   for (int i = 0; i < 32; ++i) {
     EXPECT_EQ(strategy_.row_thread_pool(i), nullptr);
@@ -47,7 +49,7 @@ TEST_F(ThreadingStrategyTest, MaxThreadEnforced) {
 
 TEST_F(ThreadingStrategyTest, UseAllThreadsForTiles) {
   frame_header_.tile_info.tile_count = 8;
-  ASSERT_TRUE(strategy_.Reset(frame_header_, 8));
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 8, /*executor=*/nullptr));
   EXPECT_NE(strategy_.tile_thread_pool(), nullptr);
   for (int i = 0; i < 8; ++i) {
     EXPECT_EQ(strategy_.row_thread_pool(i), nullptr);
@@ -57,7 +59,7 @@ TEST_F(ThreadingStrategyTest, UseAllThreadsForTiles) {
 
 TEST_F(ThreadingStrategyTest, RowThreads) {
   frame_header_.tile_info.tile_count = 2;
-  ASSERT_TRUE(strategy_.Reset(frame_header_, 8));
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 8, /*executor=*/nullptr));
   EXPECT_NE(strategy_.tile_thread_pool(), nullptr);
   // Each tile should get 3 threads each.
   for (int i = 0; i < 2; ++i) {
@@ -69,17 +71,18 @@ TEST_F(ThreadingStrategyTest, RowThreads) {
 TEST_F(ThreadingStrategyTest, RowThreadsUnequal) {
   frame_header_.tile_info.tile_count = 2;
 
-  ASSERT_TRUE(strategy_.Reset(frame_header_, 9));
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 9, /*executor=*/nullptr));
   EXPECT_NE(strategy_.tile_thread_pool(), nullptr);
   EXPECT_NE(strategy_.row_thread_pool(0), nullptr);
   EXPECT_NE(strategy_.row_thread_pool(1), nullptr);
   EXPECT_NE(strategy_.post_filter_thread_pool(), nullptr);
+  EXPECT_EQ(strategy_.post_filter_row_thread_pool(), nullptr);
 }
 
 // Test a random combination of tile_count and thread_count.
 TEST_F(ThreadingStrategyTest, MultipleCalls) {
   frame_header_.tile_info.tile_count = 2;
-  ASSERT_TRUE(strategy_.Reset(frame_header_, 8));
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 8, /*executor=*/nullptr));
   EXPECT_NE(strategy_.tile_thread_pool(), nullptr);
   for (int i = 0; i < 2; ++i) {
     EXPECT_NE(strategy_.row_thread_pool(i), nullptr);
@@ -87,7 +90,7 @@ TEST_F(ThreadingStrategyTest, MultipleCalls) {
   EXPECT_NE(strategy_.post_filter_thread_pool(), nullptr);
 
   frame_header_.tile_info.tile_count = 8;
-  ASSERT_TRUE(strategy_.Reset(frame_header_, 8));
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 8, /*executor=*/nullptr));
   EXPECT_NE(strategy_.tile_thread_pool(), nullptr);
   // Row threads must have been reset.
   for (int i = 0; i < 8; ++i) {
@@ -96,7 +99,7 @@ TEST_F(ThreadingStrategyTest, MultipleCalls) {
   EXPECT_NE(strategy_.post_filter_thread_pool(), nullptr);
 
   frame_header_.tile_info.tile_count = 8;
-  ASSERT_TRUE(strategy_.Reset(frame_header_, 16));
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 16, /*executor=*/nullptr));
   EXPECT_NE(strategy_.tile_thread_pool(), nullptr);
   for (int i = 0; i < 8; ++i) {
     // See ThreadingStrategy::Reset().
@@ -111,7 +114,7 @@ TEST_F(ThreadingStrategyTest, MultipleCalls) {
   EXPECT_NE(strategy_.post_filter_thread_pool(), nullptr);
 
   frame_header_.tile_info.tile_count = 4;
-  ASSERT_TRUE(strategy_.Reset(frame_header_, 16));
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 16, /*executor=*/nullptr));
   EXPECT_NE(strategy_.tile_thread_pool(), nullptr);
   for (int i = 0; i < 4; ++i) {
     EXPECT_NE(strategy_.row_thread_pool(i), nullptr);
@@ -123,7 +126,7 @@ TEST_F(ThreadingStrategyTest, MultipleCalls) {
   EXPECT_NE(strategy_.post_filter_thread_pool(), nullptr);
 
   frame_header_.tile_info.tile_count = 4;
-  ASSERT_TRUE(strategy_.Reset(frame_header_, 6));
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 6, /*executor=*/nullptr));
   EXPECT_NE(strategy_.tile_thread_pool(), nullptr);
   // First two tiles will get 1 thread each.
   for (int i = 0; i < 2; ++i) {
@@ -142,7 +145,7 @@ TEST_F(ThreadingStrategyTest, MultipleCalls) {
   }
   EXPECT_NE(strategy_.post_filter_thread_pool(), nullptr);
 
-  ASSERT_TRUE(strategy_.Reset(frame_header_, 1));
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 1, /*executor=*/nullptr));
   EXPECT_EQ(strategy_.tile_thread_pool(), nullptr);
   for (int i = 0; i < 8; ++i) {
     EXPECT_EQ(strategy_.row_thread_pool(i), nullptr);
@@ -154,7 +157,7 @@ TEST_F(ThreadingStrategyTest, MultipleCalls) {
 //  * 1 Tile - 2 Tiles - 1 Tile.
 TEST_F(ThreadingStrategyTest, MultipleCalls2) {
   frame_header_.tile_info.tile_count = 1;
-  ASSERT_TRUE(strategy_.Reset(frame_header_, 4));
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 4, /*executor=*/nullptr));
   // When there is only one tile, tile thread pool must be nullptr.
   EXPECT_EQ(strategy_.tile_thread_pool(), nullptr);
   EXPECT_NE(strategy_.row_thread_pool(0), nullptr);
@@ -164,7 +167,7 @@ TEST_F(ThreadingStrategyTest, MultipleCalls2) {
   EXPECT_NE(strategy_.post_filter_thread_pool(), nullptr);
 
   frame_header_.tile_info.tile_count = 2;
-  ASSERT_TRUE(strategy_.Reset(frame_header_, 4));
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 4, /*executor=*/nullptr));
   EXPECT_NE(strategy_.tile_thread_pool(), nullptr);
   for (int i = 0; i < 2; ++i) {
     // See ThreadingStrategy::Reset().
@@ -182,7 +185,7 @@ TEST_F(ThreadingStrategyTest, MultipleCalls2) {
   EXPECT_NE(strategy_.post_filter_thread_pool(), nullptr);
 
   frame_header_.tile_info.tile_count = 1;
-  ASSERT_TRUE(strategy_.Reset(frame_header_, 4));
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 4, /*executor=*/nullptr));
   EXPECT_EQ(strategy_.tile_thread_pool(), nullptr);
   EXPECT_NE(strategy_.row_thread_pool(0), nullptr);
   for (int i = 1; i < 8; ++i) {
@@ -191,16 +194,105 @@ TEST_F(ThreadingStrategyTest, MultipleCalls2) {
   EXPECT_NE(strategy_.post_filter_thread_pool(), nullptr);
 }
 
+// With an executor, tile threads and superblock row threads are not combined.
+TEST_F(ThreadingStrategyTest, Executor) {
+  std::unique_ptr<ThreadPool> executor = ThreadPool::Create(4);
+  ASSERT_NE(executor, nullptr);
+  frame_header_.tile_info.tile_count = 2;
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 8, executor.get()));
+  ASSERT_NE(strategy_.tile_thread_pool(), nullptr);
+  EXPECT_EQ(strategy_.tile_thread_pool()->mode(),
+            ThreadPool::Mode::kExternalExecutor);
+  EXPECT_EQ(strategy_.tile_thread_pool()->num_threads(), 7);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(strategy_.row_thread_pool(i), nullptr);
+  }
+  EXPECT_NE(strategy_.post_filter_thread_pool(), nullptr);
+
+  frame_header_.tile_info.tile_count = 1;
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 8, executor.get()));
+  EXPECT_EQ(strategy_.tile_thread_pool(), nullptr);
+  EXPECT_NE(strategy_.row_thread_pool(0), nullptr);
+  EXPECT_NE(strategy_.post_filter_thread_pool(), nullptr);
+
+  // Switching back to owned threads must replace the thread pool.
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 8, /*executor=*/nullptr));
+  ASSERT_NE(strategy_.thread_pool(), nullptr);
+  EXPECT_NE(strategy_.thread_pool()->mode(),
+            ThreadPool::Mode::kExternalExecutor);
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 1, /*executor=*/nullptr));
+}
+
+TEST_F(ThreadingStrategyTest, Adaptive) {
+  frame_header_.tile_info.tile_count = 4;
+  strategy_.set_adaptive(true);
+  // 3 tile threads and 4 row threads.
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 8, /*executor=*/nullptr));
+  EXPECT_TRUE(strategy_.adaptive());
+  EXPECT_EQ(strategy_.average_stage_time(ThreadingStrategy::kStageParse), 0);
+
+  // Reconstruction is 4 times slower than parsing, so all the row threads are
+  // needed to keep up with the parsing of one tile.
+  strategy_.AddStageTime(ThreadingStrategy::kStageParse, 1000);
+  strategy_.AddStageTime(ThreadingStrategy::kStageReconstruct, 4000);
+  strategy_.AddStageTime(ThreadingStrategy::kStagePostFilter, 500);
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 8, /*executor=*/nullptr));
+  EXPECT_EQ(strategy_.average_stage_time(ThreadingStrategy::kStageParse),
+            1000);
+  EXPECT_EQ(
+      strategy_.average_stage_time(ThreadingStrategy::kStageReconstruct),
+      4000);
+  EXPECT_EQ(strategy_.average_stage_time(ThreadingStrategy::kStagePostFilter),
+            500);
+  EXPECT_EQ(strategy_.average_stage_time(ThreadingStrategy::kStageFilmGrain),
+            0);
+  EXPECT_NE(strategy_.tile_thread_pool(), nullptr);
+  EXPECT_NE(strategy_.row_thread_pool(0), nullptr);
+  for (int i = 1; i < 4; ++i) {
+    EXPECT_EQ(strategy_.row_thread_pool(i), nullptr) << "i = " << i;
+  }
+
+  // The averages move a quarter of the way towards the new measurements:
+  // parse = 1750 and reconstruct = 3250. Each tile now needs 2 row threads.
+  strategy_.AddStageTime(ThreadingStrategy::kStageParse, 4000);
+  strategy_.AddStageTime(ThreadingStrategy::kStageReconstruct, 1000);
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 8, /*executor=*/nullptr));
+  EXPECT_EQ(strategy_.average_stage_time(ThreadingStrategy::kStageParse),
+            1750);
+  EXPECT_EQ(
+      strategy_.average_stage_time(ThreadingStrategy::kStageReconstruct),
+      3250);
+  // Stages that were not measured keep their previous average.
+  EXPECT_EQ(strategy_.average_stage_time(ThreadingStrategy::kStagePostFilter),
+            500);
+  for (int i = 0; i < 4; ++i) {
+    if (i >= 2) {
+      EXPECT_EQ(strategy_.row_thread_pool(i), nullptr) << "i = " << i;
+      continue;
+    }
+    EXPECT_NE(strategy_.row_thread_pool(i), nullptr) << "i = " << i;
+  }
+
+  // The stage times are not measured with a single thread.
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 1, /*executor=*/nullptr));
+  EXPECT_FALSE(strategy_.adaptive());
+
+  strategy_.set_adaptive(false);
+  ASSERT_TRUE(strategy_.Reset(frame_header_, 8, /*executor=*/nullptr));
+  EXPECT_FALSE(strategy_.adaptive());
+}
+
 void VerifyFrameParallel(int thread_count, int tile_count, int tile_columns,
                          int expected_frame_threads,
-                         const std::vector<int>& expected_tile_threads) {
+                         const std::vector<int>& expected_tile_threads,
+                         int max_frame_threads = kMaxThreads) {
   ASSERT_EQ(expected_frame_threads, expected_tile_threads.size());
   ASSERT_GT(thread_count, 1);
   std::unique_ptr<ThreadPool> frame_thread_pool;
   FrameScratchBufferPool frame_scratch_buffer_pool;
   ASSERT_TRUE(InitializeThreadPoolsForFrameParallel(
-      thread_count, tile_count, tile_columns, &frame_thread_pool,
-      &frame_scratch_buffer_pool));
+      thread_count, tile_count, tile_columns, max_frame_threads,
+      &frame_thread_pool, &frame_scratch_buffer_pool, /*placement=*/nullptr));
   if (expected_frame_threads == 0) {
     EXPECT_EQ(frame_thread_pool, nullptr);
     return;
@@ -212,8 +304,12 @@ void VerifyFrameParallel(int thread_count, int tile_count, int tile_columns,
   for (int i = 0; i < expected_frame_threads; ++i) {
     SCOPED_TRACE(absl::StrCat("i: ", i));
     frame_scratch_buffers.push_back(frame_scratch_buffer_pool.Get());
-    ThreadPool* const thread_pool =
-        frame_scratch_buffers.back()->threading_strategy.thread_pool();
+    const ThreadingStrategy& threading_strategy =
+        frame_scratch_buffers.back()->threading_strategy;
+    ThreadPool* const thread_pool = threading_strategy.thread_pool();
+    // Post filtering of superblock rows is spread over the same pool.
+    EXPECT_EQ(threading_strategy.post_filter_row_thread_pool(), thread_pool);
+    EXPECT_EQ(threading_strategy.post_filter_thread_pool(), nullptr);
     if (expected_tile_threads[i] > 0) {
       EXPECT_NE(thread_pool, nullptr);
       EXPECT_EQ(thread_pool->num_threads(), expected_tile_threads[i]);
@@ -271,12 +367,30 @@ TEST(FrameParallelStrategyTest, FrameParallel) {
       /*expected_frame_threads=*/4, /*expected_tile_threads=*/{4, 3, 3, 3});
 }
 
+TEST(FrameParallelStrategyTest, MaxFrameThreads) {
+  // The threads that are not frame threads go to the tile thread pools.
+  VerifyFrameParallel(
+      /*thread_count=*/8, /*tile_count=*/1, /*tile_columns=*/1,
+      /*expected_frame_threads=*/2, /*expected_tile_threads=*/{3, 3},
+      /*max_frame_threads=*/2);
+  VerifyFrameParallel(
+      /*thread_count=*/12, /*tile_count=*/2, /*tile_columns=*/2,
+      /*expected_frame_threads=*/3, /*expected_tile_threads=*/{3, 3, 3},
+      /*max_frame_threads=*/3);
+  // A single frame thread means that frame threading is not used.
+  VerifyFrameParallel(
+      /*thread_count=*/8, /*tile_count=*/1, /*tile_columns=*/1,
+      /*expected_frame_threads=*/0, /*expected_tile_threads=*/{},
+      /*max_frame_threads=*/1);
+}
+
 TEST(FrameParallelStrategyTest, ThreadCountDoesNotExceedkMaxThreads) {
   std::unique_ptr<ThreadPool> frame_thread_pool;
   FrameScratchBufferPool frame_scratch_buffer_pool;
   ASSERT_TRUE(InitializeThreadPoolsForFrameParallel(
       /*thread_count=*/kMaxThreads + 10, /*tile_count=*/2, /*tile_columns=*/2,
-      &frame_thread_pool, &frame_scratch_buffer_pool));
+      /*max_frame_threads=*/kMaxThreads, &frame_thread_pool,
+      &frame_scratch_buffer_pool, /*placement=*/nullptr));
   EXPECT_NE(frame_thread_pool.get(), nullptr);
   std::vector<std::unique_ptr<FrameScratchBuffer>> frame_scratch_buffers;
   int actual_thread_count = frame_thread_pool->num_threads();
@@ -298,5 +412,101 @@ TEST(FrameParallelStrategyTest, ThreadCountDoesNotExceedkMaxThreads) {
   }
 }
 
+// Returns a topology with |num_nodes| nodes of |cpus_per_node| CPUs each.
+NumaTopology MakeTopology(int num_nodes, int cpus_per_node) {
+  NumaTopology topology;
+  topology.num_nodes = num_nodes;
+  for (int i = 0; i < num_nodes * cpus_per_node; ++i) {
+    topology.node_cpus[i / cpus_per_node].Add(i);
+  }
+  return topology;
+}
+
+TEST(ThreadPlacementTest, None) {
+  ThreadPlacement placement;
+  placement.Init(kThreadAffinityNone, CpuSet(), MakeTopology(2, 4));
+  EXPECT_TRUE(placement.Place(4).Empty());
+  EXPECT_TRUE(placement.shared_cpus().Empty());
+  EXPECT_EQ(placement.memory_nodes(), 0);
+}
+
+TEST(ThreadPlacementTest, CpuSet) {
+  CpuSet cpus;
+  cpus.Add(1);
+  cpus.Add(2);
+  ThreadPlacement placement;
+  placement.Init(kThreadAffinityCpuSet, cpus, MakeTopology(2, 4));
+  for (int i = 0; i < 3; ++i) {
+    const CpuSet placed = placement.Place(8);
+    EXPECT_EQ(placed.Count(), 2);
+    EXPECT_TRUE(placed.Contains(1));
+    EXPECT_TRUE(placed.Contains(2));
+  }
+  EXPECT_EQ(placement.shared_cpus().Count(), 2);
+  EXPECT_EQ(placement.memory_nodes(), 1);
+}
+
+TEST(ThreadPlacementTest, CompactPerNode) {
+  const NumaTopology topology = MakeTopology(2, 4);
+  ThreadPlacement placement;
+  placement.Init(kThreadAffinityCompactPerNode, CpuSet(), topology);
+  EXPECT_TRUE(placement.shared_cpus().Empty());
+  // The first two pools fill node 0.
+  for (int i = 0; i < 2; ++i) {
+    const CpuSet placed = placement.Place(2);
+    EXPECT_EQ(placed.Count(), 4);
+    EXPECT_TRUE(placed.Intersects(topology.node_cpus[0]));
+    EXPECT_EQ(placement.memory_nodes(), 1);
+  }
+  // Node 1 has room for this pool, but not for the next one, which starts over
+  // with node 0.
+  CpuSet placed = placement.Place(3);
+  EXPECT_EQ(placed.Count(), 4);
+  EXPECT_TRUE(placed.Intersects(topology.node_cpus[1]));
+  EXPECT_EQ(placement.memory_nodes(), 3);
+  placed = placement.Place(2);
+  EXPECT_EQ(placed.Count(), 4);
+  EXPECT_TRUE(placed.Intersects(topology.node_cpus[0]));
+  // A pool that does not fit in one node spans two of them.
+  placed = placement.Place(6);
+  EXPECT_EQ(placed.Count(), 8);
+}
+
+TEST(ThreadPlacementTest, CompactPerNodeSkipsNodesWithoutCpus) {
+  NumaTopology topology = MakeTopology(3, 2);
+  topology.node_cpus[1] = CpuSet();
+  ThreadPlacement placement;
+  placement.Init(kThreadAffinityCompactPerNode, CpuSet(), topology);
+  EXPECT_TRUE(placement.Place(2).Intersects(topology.node_cpus[0]));
+  EXPECT_TRUE(placement.Place(2).Intersects(topology.node_cpus[2]));
+  EXPECT_EQ(placement.memory_nodes(), 5);
+}
+
+TEST(FrameParallelStrategyTest, Placement) {
+  // Use the CPUs this test may run on so that the threads can start.
+  NumaTopology topology;
+  ASSERT_TRUE(GetNumaTopology(&topology));
+  ThreadPlacement placement;
+  placement.Init(kThreadAffinityCompactPerNode, CpuSet(), topology);
+  std::unique_ptr<ThreadPool> frame_thread_pool;
+  FrameScratchBufferPool frame_scratch_buffer_pool;
+  ASSERT_TRUE(InitializeThreadPoolsForFrameParallel(
+      /*thread_count=*/8, /*tile_count=*/1, /*tile_columns=*/1,
+      /*max_frame_threads=*/kMaxThreads, &frame_thread_pool,
+      &frame_scratch_buffer_pool, &placement));
+  ASSERT_NE(frame_thread_pool.get(), nullptr);
+  EXPECT_NE(placement.memory_nodes(), 0);
+  std::vector<std::unique_ptr<FrameScratchBuffer>> frame_scratch_buffers;
+  for (int i = 0; i < frame_thread_pool->num_threads(); ++i) {
+    SCOPED_TRACE(absl::StrCat("i: ", i));
+    frame_scratch_buffers.push_back(frame_scratch_buffer_pool.Get());
+    EXPECT_FALSE(
+        frame_scratch_buffers.back()->threading_strategy.affinity().Empty());
+  }
+  for (auto& frame_scratch_buffer : frame_scratch_buffers) {
+    frame_scratch_buffer_pool.Release(std::move(frame_scratch_buffer));
+  }
+}
+
 }  // namespace
 }  // namespace libgav1
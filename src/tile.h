@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <condition_variable>  // NOLINT (unapproved c++11 header)
@@ -39,7 +40,9 @@
 #include "src/quantizer.h"
 #include "src/residual_buffer_pool.h"
 #include "src/symbol_decoder_context.h"
+#include "src/threading_strategy.h"
 #include "src/tile_scratch_buffer.h"
+#include "src/utils/arena.h"
 #include "src/utils/array_2d.h"
 #include "src/utils/block_parameters_holder.h"
 #include "src/utils/blocking_counter.h"
@@ -69,7 +72,10 @@ enum ProcessingMode {
 // symbol_decoder_context_.
 class Tile : public MaxAlignedAllocable {
  public:
-  static std::unique_ptr<Tile> Create(
+  // The Tile and its per-frame state are allocated in
+  // |frame_scratch_buffer->tile_arena|, so the returned Tile must be destroyed
+  // before the next Reset() of that arena.
+  static ArenaUniquePtr<Tile> Create(
       int tile_number, const uint8_t* const data, size_t size,
       const ObuSequenceHeader& sequence_header,
       const ObuFrameHeader& frame_header, RefCountedBuffer* const current_frame,
@@ -81,15 +87,24 @@ class Tile : public MaxAlignedAllocable {
       const dsp::Dsp* const dsp, ThreadPool* const thread_pool,
       BlockingCounterWithStatus* const pending_tiles, bool frame_parallel,
       bool use_intra_prediction_buffer, bool parse_only) {
-    std::unique_ptr<Tile> tile(new (std::nothrow) Tile(
+    static_assert(alignof(Tile) <= kMaxAlignment, "");
+    Arena& arena = frame_scratch_buffer->tile_arena;
+    void* const memory = arena.Allocate(sizeof(Tile));
+    if (memory == nullptr) return nullptr;
+    ArenaUniquePtr<Tile> tile(::new (memory) Tile(
         tile_number, data, size, sequence_header, frame_header, current_frame,
         state, frame_scratch_buffer, wedge_masks, quantizer_matrix,
         saved_symbol_decoder_context, prev_segment_ids, post_filter, dsp,
         thread_pool, pending_tiles, frame_parallel, use_intra_prediction_buffer,
         parse_only));
-    return (tile != nullptr && tile->Init()) ? std::move(tile) : nullptr;
+    return tile->Init(&arena) ? std::move(tile) : nullptr;
   }
 
+  // Returns an upper bound of the number of bytes that Create() takes from
+  // |frame_scratch_buffer->tile_arena| for one tile of the frame.
+  static size_t ArenaSize(const ObuSequenceHeader& sequence_header,
+                          const ObuFrameHeader& frame_header);
+
   // Move only.
   Tile(Tile&& tile) noexcept;
   Tile& operator=(Tile&& tile) noexcept;
@@ -212,24 +227,18 @@ class Tile : public MaxAlignedAllocable {
     int depth;
   };
 
-  // Enum to track the processing state of a superblock.
-  enum SuperBlockState : uint8_t {
-    kSuperBlockStateNone,       // Not yet parsed or decoded.
-    kSuperBlockStateParsed,     // Parsed but not yet decoded.
-    kSuperBlockStateScheduled,  // Scheduled for decoding.
-    kSuperBlockStateDecoded     // Parsed and decoded.
-  };
-
   // Parameters used to facilitate multi-threading within the Tile.
   struct ThreadingParameters {
-    std::mutex mutex;
     // 2d array of size |superblock_rows_| by |superblock_columns_| containing
-    // the processing state of each superblock.
-    Array2D<SuperBlockState> sb_state LIBGAV1_GUARDED_BY(mutex);
+    // the number of unmet prerequisites of each superblock. A superblock has to
+    // be parsed and the superblocks to its left and to its top-right (with a
+    // lag of |intra_block_copy_lag_|) have to be decoded (if they exist) before
+    // it can be decoded.
+    Array2D<std::atomic<uint8_t>> pending_dependencies;
     // Variable used to indicate either parse or decode failure.
-    bool abort LIBGAV1_GUARDED_BY(mutex) = false;
-    int pending_jobs LIBGAV1_GUARDED_BY(mutex) = 0;
-    std::condition_variable pending_jobs_zero_condvar;
+    std::atomic<bool> abort{false};
+    // Number of unfinished jobs, including the parsing job.
+    std::atomic<int> pending_jobs{0};
   };
 
   // The residual pointer is used to traverse the |residual_buffer_|. It is
@@ -258,9 +267,9 @@ class Tile : public MaxAlignedAllocable {
        BlockingCounterWithStatus* pending_tiles, bool frame_parallel,
        bool use_intra_prediction_buffer, bool parse_only);
 
-  // Performs member initializations that may fail. Helper function used by
-  // Create().
-  LIBGAV1_MUST_USE_RESULT bool Init();
+  // Performs member initializations that may fail. The per-frame buffers are
+  // allocated from |arena|. Helper function used by Create().
+  LIBGAV1_MUST_USE_RESULT bool Init(Arena* arena);
 
   // Saves the symbol decoder context of this tile into
   // |saved_symbol_decoder_context_| if necessary.
@@ -271,20 +280,25 @@ class Tile : public MaxAlignedAllocable {
   // while the worker threads do the "decode" step.
   bool ThreadedParseAndDecode();
 
-  // Returns whether or not the prerequisites for decoding the superblock at
-  // |row_index| and |column_index| are satisfied. |threading_.mutex| must be
-  // held when calling this function.
-  bool CanDecode(int row_index, int column_index) const;
+  // Marks one of the prerequisites for decoding the superblock at |row_index|
+  // and |column_index| as satisfied. Returns true if that was the last one, in
+  // which case the caller is responsible for decoding the superblock.
+  bool ResolveDependency(int row_index, int column_index);
+
+  // Schedules a DecodeSuperBlocks() job starting at |row_index| and
+  // |column_index|.
+  void ScheduleDecodeSuperBlocks(int row_index, int column_index);
 
   // This function is run by the worker threads when multi-threaded decoding is
-  // enabled. Once a superblock is decoded, this function will set the
-  // corresponding |threading_.sb_state| entry to kSuperBlockStateDecoded. On
+  // enabled. It decodes the superblock at |row_index| and |column_index| and
+  // resolves the dependencies of the superblocks to the bottom-left and to the
+  // right of it. It then continues with one of the superblocks that became
+  // ready (preferring the one to the right) and schedules new jobs for the
+  // others, so that a run of ready superblocks is decoded by a single job. On
   // failure, |threading_.abort| will be set to true. If at any point
   // |threading_.abort| becomes true, this function will return as early as it
-  // can. If the decoding succeeds, this function will also schedule the
-  // decoding jobs for the superblock to the bottom-left and the superblock to
-  // the right of this superblock (if it is allowed).
-  void DecodeSuperBlock(int row_index, int column_index, int block_width4x4);
+  // can.
+  void DecodeSuperBlocks(int row_index, int column_index);
 
   // If |use_intra_prediction_buffer_| is true, then this function copies the
   // last row of the superblockrow starting at |row4x4| into the
@@ -661,7 +675,7 @@ class Tile : public MaxAlignedAllocable {
   // GetTransformAllZeroContext. In that function, we only care about the
   // following values: 0, 1, 2, 3 and >= 4. So instead of clamping to 63, we
   // clamp to 4 (i.e.) all the values greater than 4 are stored as 4.
-  std::array<Array2D<uint8_t>, 2> coefficient_levels_;
+  std::array<Array2DView<uint8_t>, 2> coefficient_levels_;
   // This is equivalent to the LeftDcContext and AboveDcContext arrays in the
   // spec. In the spec, it can store 3 possible values: 0, 1 and 2 (where 1
   // means the value is < 0, 2 means the value is > 0 and 0 means the value is
@@ -679,7 +693,7 @@ class Tile : public MaxAlignedAllocable {
   //
   // The usage on GetTransformAllZeroContext is unaffected since there we
   // only care about whether it is 0 or not.
-  std::array<Array2D<int8_t>, 2> dc_categories_;
+  std::array<Array2DView<int8_t>, 2> dc_categories_;
   const ObuSequenceHeader& sequence_header_;
   const ObuFrameHeader& frame_header_;
   const std::array<bool, kNumReferenceFrameTypes>& reference_frame_sign_bias_;
@@ -717,10 +731,10 @@ class Tile : public MaxAlignedAllocable {
   //        |residual_size_|. Where 4096 = 64x64 which is the maximum transform
   //        size, and 32 * |kResidualPaddingVertical| is the padding to avoid
   //        bottom boundary checks when parsing quantized coefficients. This
-  //        memory is allocated and owned by the Tile class.
+  //        memory is allocated from the tile arena by the Tile class.
   //    For |residual_buffer_threaded_|: See the comment below. This memory is
   //        not allocated or owned by the Tile class.
-  AlignedUniquePtr<uint8_t> residual_buffer_;
+  uint8_t* residual_buffer_ = nullptr;
   // This is a 2d array of pointers of size |superblock_rows_| by
   // |superblock_columns_| where each pointer points to a ResidualBuffer for a
   // single super block. The array is populated when the parsing process begins
@@ -764,6 +778,9 @@ class Tile : public MaxAlignedAllocable {
   ThreadingParameters threading_;
   ResidualBufferPool* const residual_buffer_pool_;
   TileScratchBufferPool* const tile_scratch_buffer_pool_;
+  // Used to measure the parse and reconstruct stage times when
+  // |split_parse_and_decode_| is true.
+  ThreadingStrategy* const threading_strategy_;
   BlockingCounterWithStatus* const pending_tiles_;
   bool split_parse_and_decode_;
   // This is used only when |split_parse_and_decode_| is false.
@@ -792,8 +809,8 @@ class Tile : public MaxAlignedAllocable {
   // Stores the CDF contexts necessary for the "top" block. The size of this
   // buffer is the number of superblock columns in this tile. For each block,
   // the access index will be the corresponding SuperBlockColumnIndex()'th
-  // entry.
-  DynamicBuffer<BlockCdfContext> top_context_;
+  // entry. Allocated from the tile arena.
+  BlockCdfContext* top_context_ = nullptr;
   // Whether the tile should only be parsed and not decoded.
   const bool parse_only_;
 };
@@ -811,7 +828,7 @@ struct Tile::Block {
         height4x4(height >> 2),
         scratch_buffer(scratch_buffer),
         residual(residual),
-        top_context(tile.top_context_.get() +
+        top_context(tile.top_context_ +
                     tile.SuperBlockColumnIndex(column4x4)),
         top_context_index(tile.CdfContextIndex(column4x4)),
         left_context_index(tile.CdfContextIndex(row4x4)) {
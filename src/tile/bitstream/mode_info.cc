@@ -778,7 +778,7 @@ bool Tile::ReadIntraBlockModeInfo(const Block& block, bool intra_y_mode) {
       bp.prediction_parameters->chroma_top_uses_smooth_prediction =
           (bp_top.reference_frame[0] <= kReferenceFrameIntra) &&
           kPredictionModeSmoothMask.Contains(
-              top_context_.get()[SuperBlockColumnIndex(smooth_column)]
+              top_context_[SuperBlockColumnIndex(smooth_column)]
                   .uv_mode[CdfContextIndex(smooth_column)]);
     }
     SetCdfContextUVMode(block);
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <cstdlib>
@@ -87,6 +88,10 @@ constexpr uint8_t kAllZeroContextsByTopLeft[5][5] = {{1, 2, 2, 2, 3},
 //                                 stack.
 constexpr int kDfsStackSize = 16;
 
+// Number of parsed superblocks in a row that are released for decoding at once
+// in ThreadedParseAndDecode().
+constexpr int kParsedSuperBlockBatchSize = 4;
+
 // Mask indicating whether the transform sets contain a particular transform
 // type. If |tx_type| is present in |tx_set|, then the |tx_type|th LSB is set.
 constexpr BitMaskSet kTransformTypeInSetMask[kNumTransformSets] = {
@@ -469,6 +474,7 @@ Tile::Tile(int tile_number, const uint8_t* const data, size_t size,
       residual_buffer_pool_(frame_scratch_buffer->residual_buffer_pool.get()),
       tile_scratch_buffer_pool_(
           &frame_scratch_buffer->tile_scratch_buffer_pool),
+      threading_strategy_(&frame_scratch_buffer->threading_strategy),
       pending_tiles_(pending_tiles),
       frame_parallel_(frame_parallel),
       use_intra_prediction_buffer_(use_intra_prediction_buffer),
@@ -547,20 +553,53 @@ Tile::Tile(int tile_number, const uint8_t* const data, size_t size,
   }
 }
 
-bool Tile::Init() {
+// static
+size_t Tile::ArenaSize(const ObuSequenceHeader& sequence_header,
+                       const ObuFrameHeader& frame_header) {
+  const size_t plane_count = sequence_header.color_config.is_monochrome
+                                 ? kMaxPlanesMonochrome
+                                 : kMaxPlanes;
+  const int block_width4x4_log2 =
+      k4x4WidthLog2[sequence_header.use_128x128_superblock ? kBlock128x128
+                                                           : kBlock64x64];
+  const size_t superblock_columns =
+      (frame_header.columns4x4 + (1 << block_width4x4_log2) - 1) >>
+      block_width4x4_log2;
+  const size_t residual_size =
+      (sequence_header.color_config.bitdepth == 8) ? sizeof(int16_t)
+                                                   : sizeof(int32_t);
+  // Each allocation may be preceded by up to kMaxAlignment - 1 bytes of
+  // padding.
+  size_t size = sizeof(Tile) + kMaxAlignment;
+  // |coefficient_levels_| and |dc_categories_|.
+  size += 2 * (plane_count * frame_header.rows4x4 + kMaxAlignment);
+  size += 2 * (plane_count * frame_header.columns4x4 + kMaxAlignment);
+  // |residual_buffer_|.
+  size += (4096 + 32 * kResidualPaddingVertical) * residual_size +
+          kMaxAlignment;
+  // |top_context_|.
+  size += superblock_columns * sizeof(BlockCdfContext) + kMaxAlignment;
+  return size;
+}
+
+bool Tile::Init(Arena* const arena) {
   assert(coefficient_levels_.size() == dc_categories_.size());
   for (size_t i = 0; i < coefficient_levels_.size(); ++i) {
     const int contexts_per_plane = (i == kEntropyContextLeft)
                                        ? frame_header_.rows4x4
                                        : frame_header_.columns4x4;
-    if (!coefficient_levels_[i].Reset(PlaneCount(), contexts_per_plane)) {
-      LIBGAV1_DLOG(ERROR, "coefficient_levels_[%zu].Reset() failed.", i);
-      return false;
-    }
-    if (!dc_categories_[i].Reset(PlaneCount(), contexts_per_plane)) {
-      LIBGAV1_DLOG(ERROR, "dc_categories_[%zu].Reset() failed.", i);
+    const size_t size = PlaneCount() * contexts_per_plane;
+    auto* const coefficient_levels = arena->AllocateArray<uint8_t>(size);
+    auto* const dc_categories = arena->AllocateArray<int8_t>(size);
+    if (coefficient_levels == nullptr || dc_categories == nullptr) {
+      LIBGAV1_DLOG(ERROR, "Allocation of the entropy contexts %zu failed.", i);
       return false;
     }
+    memset(coefficient_levels, 0, size);
+    memset(dc_categories, 0, size);
+    coefficient_levels_[i].Reset(PlaneCount(), contexts_per_plane,
+                                 coefficient_levels);
+    dc_categories_[i].Reset(PlaneCount(), contexts_per_plane, dc_categories);
   }
   if (split_parse_and_decode_) {
     assert(residual_buffer_pool_ != nullptr);
@@ -572,8 +611,8 @@ bool Tile::Init() {
   } else {
     // Add 32 * |kResidualPaddingVertical| padding to avoid bottom boundary
     // checks when parsing quantized coefficients.
-    residual_buffer_ = MakeAlignedUniquePtr<uint8_t>(
-        32, (4096 + 32 * kResidualPaddingVertical) * residual_size_);
+    residual_buffer_ = static_cast<uint8_t*>(arena->Allocate(
+        (4096 + 32 * kResidualPaddingVertical) * residual_size_));
     if (residual_buffer_ == nullptr) {
       LIBGAV1_DLOG(ERROR, "Allocation of residual_buffer_ failed.");
       return false;
@@ -591,7 +630,8 @@ bool Tile::Init() {
                      column4x4_end_, &motion_field_);
   }
   ResetLoopRestorationParams();
-  if (!top_context_.Resize(superblock_columns_)) {
+  top_context_ = arena->AllocateArray<BlockCdfContext>(superblock_columns_);
+  if (top_context_ == nullptr) {
     LIBGAV1_DLOG(ERROR, "Allocation of top_context_ failed.");
     return false;
   }
@@ -659,6 +699,7 @@ bool Tile::ParseAndDecode() {
       pending_tiles_->Decrement(false);
       return false;
     }
+    post_filter_.SuperBlockRowDecoded(row4x4, block_width4x4);
   }
   tile_scratch_buffer_pool_->Release(std::move(scratch_buffer));
   pending_tiles_->Decrement(true);
@@ -744,16 +785,23 @@ bool Tile::Decode(
 }
 
 bool Tile::ThreadedParseAndDecode() {
-  {
-    std::lock_guard<std::mutex> lock(threading_.mutex);
-    if (!threading_.sb_state.Reset(superblock_rows_, superblock_columns_)) {
-      pending_tiles_->Decrement(false);
-      LIBGAV1_DLOG(ERROR, "threading.sb_state.Reset() failed.");
-      return false;
+  if (!threading_.pending_dependencies.Reset(superblock_rows_,
+                                             superblock_columns_)) {
+    pending_tiles_->Decrement(false);
+    LIBGAV1_DLOG(ERROR, "threading_.pending_dependencies.Reset() failed.");
+    return false;
+  }
+  for (int row_index = 0; row_index < superblock_rows_; ++row_index) {
+    for (int column_index = 0; column_index < superblock_columns_;
+         ++column_index) {
+      threading_.pending_dependencies[row_index][column_index].store(
+          1 + static_cast<int>(row_index > 0) +
+              static_cast<int>(column_index > 0),
+          std::memory_order_relaxed);
     }
-    // Account for the parsing job.
-    ++threading_.pending_jobs;
   }
+  // Account for the parsing job.
+  threading_.pending_jobs.store(1, std::memory_order_relaxed);
 
   const int block_width4x4 = kNum4x4BlocksWide[SuperBlockSize()];
 
@@ -767,32 +815,32 @@ bool Tile::ThreadedParseAndDecode() {
   }
   for (int row4x4 = row4x4_start_, row_index = 0; row4x4 < row4x4_end_;
        row4x4 += block_width4x4, ++row_index) {
+    // The parsed superblocks are released for decoding in batches. Within a
+    // batch, only the first superblock can be ready after it is parsed. The
+    // others become ready when the superblock to their left is decoded, so the
+    // whole batch is usually decoded by a single job.
+    int batch_start = 0;
     for (int column4x4 = column4x4_start_, column_index = 0;
          column4x4 < column4x4_end_;
          column4x4 += block_width4x4, ++column_index) {
       if (!ProcessSuperBlock(row4x4, column4x4, scratch_buffer.get(),
                              kProcessingModeParseOnly)) {
-        std::lock_guard<std::mutex> lock(threading_.mutex);
-        threading_.abort = true;
+        threading_.abort.store(true, std::memory_order_relaxed);
         break;
       }
-      std::unique_lock<std::mutex> lock(threading_.mutex);
-      if (threading_.abort) break;
-      threading_.sb_state[row_index][column_index] = kSuperBlockStateParsed;
-      // Schedule the decoding of this superblock if it is allowed.
-      if (CanDecode(row_index, column_index)) {
-        ++threading_.pending_jobs;
-        threading_.sb_state[row_index][column_index] =
-            kSuperBlockStateScheduled;
-        lock.unlock();
-        thread_pool_->Schedule(
-            [this, row_index, column_index, block_width4x4]() {
-              DecodeSuperBlock(row_index, column_index, block_width4x4);
-            });
+      if (threading_.abort.load(std::memory_order_relaxed)) break;
+      if (column_index + 1 - batch_start < kParsedSuperBlockBatchSize &&
+          column_index + 1 < superblock_columns_) {
+        continue;
       }
+      for (int i = batch_start; i <= column_index; ++i) {
+        if (ResolveDependency(row_index, i)) {
+          ScheduleDecodeSuperBlocks(row_index, i);
+        }
+      }
+      batch_start = column_index + 1;
     }
-    std::lock_guard<std::mutex> lock(threading_.mutex);
-    if (threading_.abort) break;
+    if (threading_.abort.load(std::memory_order_relaxed)) break;
   }
   tile_scratch_buffer_pool_->Release(std::move(scratch_buffer));
 
@@ -802,107 +850,98 @@ bool Tile::ThreadedParseAndDecode() {
   // Finish using |threading_| before |pending_tiles_->Decrement()| because the
   // Tile object could go out of scope as soon as |pending_tiles_->Decrement()|
   // is called.
-  threading_.mutex.lock();
-  const bool no_pending_jobs = (--threading_.pending_jobs == 0);
-  const bool job_succeeded = !threading_.abort;
-  threading_.mutex.unlock();
-  if (no_pending_jobs) {
+  const bool job_succeeded = !threading_.abort.load(std::memory_order_relaxed);
+  if (threading_.pending_jobs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
     // We are done parsing and decoding this tile.
-    pending_tiles_->Decrement(job_succeeded);
+    pending_tiles_->Decrement(
+        !threading_.abort.load(std::memory_order_relaxed));
   }
   return job_succeeded;
 }
 
-bool Tile::CanDecode(int row_index, int column_index) const {
-  assert(row_index >= 0);
-  assert(column_index >= 0);
-  // If |threading_.sb_state[row_index][column_index]| is not equal to
-  // kSuperBlockStateParsed, then return false. This is ok because if
-  // |threading_.sb_state[row_index][column_index]| is equal to:
-  //   kSuperBlockStateNone - then the superblock is not yet parsed.
-  //   kSuperBlockStateScheduled - then the superblock is already scheduled for
-  //                               decode.
-  //   kSuperBlockStateDecoded - then the superblock has already been decoded.
-  if (row_index >= superblock_rows_ || column_index >= superblock_columns_ ||
-      threading_.sb_state[row_index][column_index] != kSuperBlockStateParsed) {
-    return false;
-  }
-  // First superblock has no dependencies.
-  if (row_index == 0 && column_index == 0) {
-    return true;
-  }
-  // Superblocks in the first row only depend on the superblock to the left of
-  // it.
-  if (row_index == 0) {
-    return threading_.sb_state[0][column_index - 1] == kSuperBlockStateDecoded;
-  }
-  // All other superblocks depend on superblock to the left of it (if one
-  // exists) and superblock to the top right with a lag of
-  // |intra_block_copy_lag_| (if one exists).
-  const int top_right_column_index =
-      std::min(column_index + intra_block_copy_lag_, superblock_columns_ - 1);
-  return threading_.sb_state[row_index - 1][top_right_column_index] ==
-             kSuperBlockStateDecoded &&
-         (column_index == 0 ||
-          threading_.sb_state[row_index][column_index - 1] ==
-              kSuperBlockStateDecoded);
+bool Tile::ResolveDependency(int row_index, int column_index) {
+  assert(row_index >= 0 && row_index < superblock_rows_);
+  assert(column_index >= 0 && column_index < superblock_columns_);
+  // The acquire-release ordering makes the pixels written by the decoding of
+  // the prerequisites visible to the thread that decodes this superblock.
+  return threading_.pending_dependencies[row_index][column_index].fetch_sub(
+             1, std::memory_order_acq_rel) == 1;
+}
+
+void Tile::ScheduleDecodeSuperBlocks(int row_index, int column_index) {
+  // The caller is a job that has not finished yet, so |pending_jobs| cannot
+  // drop to zero concurrently.
+  threading_.pending_jobs.fetch_add(1, std::memory_order_relaxed);
+  thread_pool_->Schedule([this, row_index, column_index]() {
+    DecodeSuperBlocks(row_index, column_index);
+  });
 }
 
-void Tile::DecodeSuperBlock(int row_index, int column_index,
-                            int block_width4x4) {
-  const int row4x4 = row4x4_start_ + (row_index * block_width4x4);
-  const int column4x4 = column4x4_start_ + (column_index * block_width4x4);
+void Tile::DecodeSuperBlocks(int row_index, int column_index) {
+  const int block_width4x4 = kNum4x4BlocksWide[SuperBlockSize()];
   std::unique_ptr<TileScratchBuffer> scratch_buffer =
       tile_scratch_buffer_pool_->Get();
-  bool ok = scratch_buffer != nullptr;
-  if (ok) {
-    ok = ProcessSuperBlock(row4x4, column4x4, scratch_buffer.get(),
-                           kProcessingModeDecodeOnly);
-    tile_scratch_buffer_pool_->Release(std::move(scratch_buffer));
-  }
-  std::unique_lock<std::mutex> lock(threading_.mutex);
-  if (ok) {
-    threading_.sb_state[row_index][column_index] = kSuperBlockStateDecoded;
-    // Candidate rows and columns that we could potentially begin the decoding
-    // (if it is allowed to do so). The candidates are:
+  if (scratch_buffer == nullptr) {
+    threading_.abort.store(true, std::memory_order_relaxed);
+  }
+  while (!threading_.abort.load(std::memory_order_relaxed)) {
+    const int row4x4 = row4x4_start_ + (row_index * block_width4x4);
+    const int column4x4 = column4x4_start_ + (column_index * block_width4x4);
+    if (!ProcessSuperBlock(row4x4, column4x4, scratch_buffer.get(),
+                           kProcessingModeDecodeOnly)) {
+      threading_.abort.store(true, std::memory_order_relaxed);
+      break;
+    }
+    const bool is_last_column = column_index == superblock_columns_ - 1;
+    // The superblocks are decoded from left to right within a row, so the row
+    // is done once its last superblock is decoded.
+    if (is_last_column) {
+      post_filter_.SuperBlockRowDecoded(row4x4, block_width4x4);
+    }
+    // Superblocks that could potentially begin the decoding now are:
     //   1) The superblock to the bottom-left of the current superblock with a
-    //   lag of |intra_block_copy_lag_| (or the beginning of the next superblock
-    //   row in case there are less than |intra_block_copy_lag_| superblock
-    //   columns in the Tile).
+    //   lag of |intra_block_copy_lag_|. If this is the last superblock of the
+    //   row, then it is also the top-right superblock (with the lag) of the
+    //   superblocks after that one in the next row.
     //   2) The superblock to the right of the current superblock.
-    const int candidate_row_indices[] = {row_index + 1, row_index};
-    const int candidate_column_indices[] = {
-        std::max(0, column_index - intra_block_copy_lag_), column_index + 1};
-    for (size_t i = 0; i < std::extent<decltype(candidate_row_indices)>::value;
-         ++i) {
-      const int candidate_row_index = candidate_row_indices[i];
-      const int candidate_column_index = candidate_column_indices[i];
-      if (!CanDecode(candidate_row_index, candidate_column_index)) {
-        continue;
+    int next_row_index = -1;
+    int next_column_index = -1;
+    if (row_index + 1 < superblock_rows_) {
+      const int first_column_index = column_index - intra_block_copy_lag_;
+      const int last_column_index =
+          is_last_column ? column_index : first_column_index;
+      for (int i = std::max(first_column_index, 0); i <= last_column_index;
+           ++i) {
+        if (!ResolveDependency(row_index + 1, i)) continue;
+        if (next_row_index < 0) {
+          next_row_index = row_index + 1;
+          next_column_index = i;
+        } else {
+          ScheduleDecodeSuperBlocks(row_index + 1, i);
+        }
       }
-      ++threading_.pending_jobs;
-      threading_.sb_state[candidate_row_index][candidate_column_index] =
-          kSuperBlockStateScheduled;
-      lock.unlock();
-      thread_pool_->Schedule([this, candidate_row_index, candidate_column_index,
-                              block_width4x4]() {
-        DecodeSuperBlock(candidate_row_index, candidate_column_index,
-                         block_width4x4);
-      });
-      lock.lock();
     }
-  } else {
-    threading_.abort = true;
+    if (!is_last_column && ResolveDependency(row_index, column_index + 1)) {
+      if (next_row_index >= 0) {
+        ScheduleDecodeSuperBlocks(next_row_index, next_column_index);
+      }
+      next_row_index = row_index;
+      next_column_index = column_index + 1;
+    }
+    if (next_row_index < 0) break;
+    row_index = next_row_index;
+    column_index = next_column_index;
+  }
+  if (scratch_buffer != nullptr) {
+    tile_scratch_buffer_pool_->Release(std::move(scratch_buffer));
   }
   // Finish using |threading_| before |pending_tiles_->Decrement()| because the
   // Tile object could go out of scope as soon as |pending_tiles_->Decrement()|
   // is called.
-  const bool no_pending_jobs = (--threading_.pending_jobs == 0);
-  const bool job_succeeded = !threading_.abort;
-  lock.unlock();
-  if (no_pending_jobs) {
+  if (threading_.pending_jobs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
     // We are done parsing and decoding this tile.
-    pending_tiles_->Decrement(job_succeeded);
+    pending_tiles_->Decrement(
+        !threading_.abort.load(std::memory_order_relaxed));
   }
 }
 
@@ -2505,7 +2544,7 @@ bool Tile::ProcessSuperBlock(int row4x4, int column4x4,
     ReadLoopRestorationCoefficients(row4x4, column4x4, block_size);
   }
   if (parsing && decoding) {
-    uint8_t* residual_buffer = residual_buffer_.get();
+    uint8_t* residual_buffer = residual_buffer_;
     if (!ProcessPartition(row4x4, column4x4, scratch_buffer,
                           &residual_buffer)) {
       LIBGAV1_DLOG(ERROR, "Error decoding partition row: %d column: %d", row4x4,
@@ -2516,6 +2555,9 @@ bool Tile::ProcessSuperBlock(int row4x4, int column4x4,
   }
   const int sb_row_index = SuperBlockRowIndex(row4x4);
   const int sb_column_index = SuperBlockColumnIndex(column4x4);
+  const ScopedStageTimer stage_timer(
+      threading_strategy_, parsing ? ThreadingStrategy::kStageParse
+                                   : ThreadingStrategy::kStageReconstruct);
   if (parsing) {
     residual_buffer_threaded_[sb_row_index][sb_column_index] =
         residual_buffer_pool_->Get();
@@ -26,6 +26,7 @@
 #include <utility>
 
 #include "src/dsp/constants.h"
+#include "src/memory_tracker.h"
 #include "src/utils/common.h"
 #include "src/utils/compiler_attributes.h"
 #include "src/utils/constants.h"
@@ -38,7 +39,26 @@ namespace libgav1 {
 struct TileScratchBuffer : public MaxAlignedAllocable {
   static constexpr int kBlockDecodedStride = 34;
 
+  static constexpr int kConvolveBufferHeight =
+      kMaxScaledSuperBlockSizeInPixels + kConvolveBorderLeftTop +
+      kConvolveBorderBottom;
+
   LIBGAV1_MUST_USE_RESULT bool Init(int bitdepth) {
+    convolve_block_buffer_stride = ConvolveBlockBufferStride(bitdepth);
+    convolve_block_buffer = MakeAlignedUniquePtr<uint8_t>(
+        kMaxAlignment, kConvolveBufferHeight * convolve_block_buffer_stride);
+#if LIBGAV1_MSAN
+    // Quiet msan warnings in ConvolveScale2D_NEON(). Set with random non-zero
+    // value to aid in future debugging.
+    memset(convolve_block_buffer.get(), 0x66,
+           kConvolveBufferHeight * convolve_block_buffer_stride);
+#endif
+
+    return convolve_block_buffer != nullptr;
+  }
+
+  // Returns the stride of |convolve_block_buffer| for |bitdepth|.
+  static ptrdiff_t ConvolveBlockBufferStride(int bitdepth) {
 #if LIBGAV1_MAX_BITDEPTH >= 10
     const int pixel_size = (bitdepth == 8) ? 1 : 2;
 #else
@@ -51,22 +71,15 @@ struct TileScratchBuffer : public MaxAlignedAllocable {
     constexpr int unaligned_convolve_buffer_stride =
         kMaxScaledSuperBlockSizeInPixels + kConvolveBorderLeftTop +
         kConvolveScaleBorderRight;
-    convolve_block_buffer_stride = Align<ptrdiff_t>(
-        unaligned_convolve_buffer_stride * pixel_size, kMaxAlignment);
-    constexpr int convolve_buffer_height = kMaxScaledSuperBlockSizeInPixels +
-                                           kConvolveBorderLeftTop +
-                                           kConvolveBorderBottom;
-
-    convolve_block_buffer = MakeAlignedUniquePtr<uint8_t>(
-        kMaxAlignment, convolve_buffer_height * convolve_block_buffer_stride);
-#if LIBGAV1_MSAN
-    // Quiet msan warnings in ConvolveScale2D_NEON(). Set with random non-zero
-    // value to aid in future debugging.
-    memset(convolve_block_buffer.get(), 0x66,
-           convolve_buffer_height * convolve_block_buffer_stride);
-#endif
+    return Align<ptrdiff_t>(unaligned_convolve_buffer_stride * pixel_size,
+                            kMaxAlignment);
+  }
 
-    return convolve_block_buffer != nullptr;
+  // Returns the number of bytes used by a TileScratchBuffer initialized with
+  // |bitdepth|.
+  static size_t AllocatedSize(int bitdepth) {
+    return sizeof(TileScratchBuffer) +
+           kConvolveBufferHeight * ConvolveBlockBufferStride(bitdepth);
   }
 
   // kCompoundPredictionTypeDiffWeighted prediction mode needs a mask of the
@@ -133,14 +146,18 @@ class TileScratchBufferPool {
       // We are going from a pixel size of 1 to a pixel size of 2. So invalidate
       // the stack.
       std::lock_guard<std::mutex> lock(mutex_);
-      while (!buffers_.Empty()) {
-        buffers_.Pop();
-      }
+      FreeBuffers();
     }
 #endif
     bitdepth_ = bitdepth;
   }
 
+  // Frees the buffers in the pool.
+  void Trim() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FreeBuffers();
+  }
+
   std::unique_ptr<TileScratchBuffer> Get() {
     std::lock_guard<std::mutex> lock(mutex_);
     if (buffers_.Empty()) {
@@ -149,6 +166,10 @@ class TileScratchBufferPool {
       if (scratch_buffer == nullptr || !scratch_buffer->Init(bitdepth_)) {
         return nullptr;
       }
+      if (memory_tracker_ != nullptr) {
+        memory_tracker_->Add(kMemoryCategoryScratch,
+                             TileScratchBuffer::AllocatedSize(bitdepth_));
+      }
       return scratch_buffer;
     }
     return buffers_.Pop();
@@ -159,13 +180,34 @@ class TileScratchBufferPool {
     buffers_.Push(std::move(scratch_buffer));
   }
 
+  // Counts the buffers allocated from now on in |memory_tracker|, which must
+  // outlive the pool.
+  void set_memory_tracker(MemoryTracker* memory_tracker) {
+    memory_tracker_ = memory_tracker;
+  }
+
  private:
+  // Frees the buffers in the pool. |mutex_| must be held.
+  void FreeBuffers() {
+    while (!buffers_.Empty()) {
+      // The buffers may have been allocated for a larger pixel size than the
+      // current one.
+      const size_t size = sizeof(TileScratchBuffer) +
+                          TileScratchBuffer::kConvolveBufferHeight *
+                              buffers_.Pop()->convolve_block_buffer_stride;
+      if (memory_tracker_ != nullptr) {
+        memory_tracker_->Subtract(kMemoryCategoryScratch, size);
+      }
+    }
+  }
+
   std::mutex mutex_;
   // We will never need more than kMaxThreads scratch buffers since that is the
   // maximum amount of work that will be done at any given time.
   Stack<std::unique_ptr<TileScratchBuffer>, kMaxThreads> buffers_
       LIBGAV1_GUARDED_BY(mutex_);
   int bitdepth_ = 0;
+  MemoryTracker* memory_tracker_ = nullptr;
 };
 
 }  // namespace libgav1
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2023 The libgav1 Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIBGAV1_SRC_UTILS_ARENA_H_
+#define LIBGAV1_SRC_UTILS_ARENA_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "src/utils/common.h"
+#include "src/utils/compiler_attributes.h"
+#include "src/utils/memory.h"
+#include "src/utils/vector.h"
+
+namespace libgav1 {
+
+// A bump pointer allocator for state that lives for the duration of one frame.
+// Reset() releases all the allocations at once but keeps the memory, so the
+// allocations of the next frame do not go to the system allocator. When the
+// allocations outgrow the arena, the extra memory comes from overflow blocks,
+// and the next Reset() replaces all the blocks with a single one that is large
+// enough for the previous round of allocations.
+//
+// The arena does not run destructors. The objects that are not trivially
+// destructible must be destroyed by their owners, e.g. using ArenaUniquePtr.
+//
+// WARNING: Not thread safe.
+class Arena {
+ public:
+  Arena() = default;
+
+  // Not copyable or movable.
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Releases all the allocations and ensures that at least |size| bytes can be
+  // allocated before an overflow block is needed. Returns false on memory
+  // allocation failure. The arena remains usable in that case.
+  LIBGAV1_MUST_USE_RESULT bool Reset(size_t size) {
+    // An allocation that started an overflow block may need up to
+    // kMaxAlignment bytes of padding when it is carved out of a single block.
+    size = std::max(size, used_ + overflow_blocks_.size() * kMaxAlignment);
+    overflow_blocks_.clear();
+    used_ = 0;
+    offset_ = 0;
+    if (size > capacity_) {
+      block_ = MakeAlignedUniquePtr<uint8_t>(kMaxAlignment, size);
+      capacity_ = (block_ == nullptr) ? 0 : size;
+    }
+    current_block_ = block_.get();
+    current_block_size_ = capacity_;
+    return block_ != nullptr || size == 0;
+  }
+
+  // Frees all the memory of the arena. There must be no live allocations.
+  // The next Reset() allocates the arena again.
+  void Trim() {
+    block_ = nullptr;
+    capacity_ = 0;
+    overflow_blocks_.clear();
+    current_block_ = nullptr;
+    current_block_size_ = 0;
+    offset_ = 0;
+    used_ = 0;
+  }
+
+  // Returns |size| bytes aligned to |alignment|, which must be a power of 2 no
+  // larger than kMaxAlignment. Returns nullptr on memory allocation failure.
+  void* Allocate(size_t size, size_t alignment = kMaxAlignment) {
+    assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+    assert(alignment <= kMaxAlignment);
+    size_t offset = Align(offset_, alignment);
+    if (current_block_ == nullptr || offset + size > current_block_size_) {
+      const size_t block_size =
+          std::max(size, static_cast<size_t>(kMinOverflowBlockSize));
+      AlignedUniquePtr<uint8_t> block =
+          MakeAlignedUniquePtr<uint8_t>(kMaxAlignment, block_size);
+      if (block == nullptr) return nullptr;
+      current_block_ = block.get();
+      if (!overflow_blocks_.push_back(std::move(block))) {
+        current_block_ = nullptr;
+        return nullptr;
+      }
+      current_block_size_ = block_size;
+      offset_ = 0;
+      offset = 0;
+    }
+    used_ += offset - offset_ + size;
+    offset_ = offset + size;
+    return current_block_ + offset;
+  }
+
+  // Allocates |count| default-initialized objects of type T. Returns nullptr
+  // on memory allocation failure.
+  template <typename T>
+  T* AllocateArray(size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value, "");
+    void* const memory = Allocate(sizeof(T) * count, alignof(T));
+    if (memory == nullptr) return nullptr;
+    T* const array = static_cast<T*>(memory);
+    for (size_t i = 0; i < count; ++i) new (&array[i]) T;
+    return array;
+  }
+
+  // The number of bytes that can be allocated after a Reset() without using
+  // an overflow block.
+  size_t capacity() const { return capacity_; }
+  // The number of bytes handed out since the last Reset(), including the
+  // alignment padding.
+  size_t used() const { return used_; }
+
+ private:
+  static constexpr size_t kMinOverflowBlockSize = 64 * 1024;
+
+  AlignedUniquePtr<uint8_t> block_;
+  size_t capacity_ = 0;
+  Vector<AlignedUniquePtr<uint8_t>> overflow_blocks_;
+  // The block that the next allocation is carved out of, and the offset of the
+  // first free byte in that block.
+  uint8_t* current_block_ = nullptr;
+  size_t current_block_size_ = 0;
+  size_t offset_ = 0;
+  size_t used_ = 0;
+};
+
+// Destroys an object that was constructed in an Arena. The memory itself is
+// released by Arena::Reset().
+template <typename T>
+struct ArenaDeleter {
+  void operator()(T* const object) const { object->~T(); }
+};
+
+template <typename T>
+using ArenaUniquePtr = std::unique_ptr<T, ArenaDeleter<T>>;
+
+}  // namespace libgav1
+
+#endif  // LIBGAV1_SRC_UTILS_ARENA_H_
@@ -0,0 +1,137 @@
+// Copyright 2023 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/utils/arena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "gtest/gtest.h"
+#include "src/utils/memory.h"
+
+namespace libgav1 {
+namespace {
+
+bool IsAligned(const void* pointer, size_t alignment) {
+  return (reinterpret_cast<uintptr_t>(pointer) & (alignment - 1)) == 0;
+}
+
+TEST(ArenaTest, Alignment) {
+  Arena arena;
+  ASSERT_TRUE(arena.Reset(1024));
+  EXPECT_EQ(arena.capacity(), size_t{1024});
+  for (const size_t alignment : {size_t{1}, size_t{2}, size_t{4}, size_t{8},
+                                 static_cast<size_t>(kMaxAlignment)}) {
+    ASSERT_NE(arena.Allocate(1, 1), nullptr);
+    void* const memory = arena.Allocate(3, alignment);
+    ASSERT_NE(memory, nullptr);
+    EXPECT_TRUE(IsAligned(memory, alignment));
+  }
+  EXPECT_LE(arena.used(), arena.capacity());
+}
+
+TEST(ArenaTest, ResetReusesMemory) {
+  Arena arena;
+  ASSERT_TRUE(arena.Reset(256));
+  auto* const first = static_cast<uint8_t*>(arena.Allocate(100));
+  ASSERT_NE(first, nullptr);
+  auto* const second = static_cast<uint8_t*>(arena.Allocate(100));
+  ASSERT_NE(second, nullptr);
+  EXPECT_GE(second, first + 100);
+  ASSERT_TRUE(arena.Reset(256));
+  EXPECT_EQ(arena.used(), size_t{0});
+  EXPECT_EQ(arena.Allocate(100), first);
+}
+
+TEST(ArenaTest, GrowsToHighWaterMark) {
+  Arena arena;
+  ASSERT_TRUE(arena.Reset(64));
+  // The allocations that do not fit come from overflow blocks.
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_NE(arena.Allocate(48), nullptr);
+  }
+  const size_t used = arena.used();
+  EXPECT_GT(used, arena.capacity());
+  // The next round of allocations fits in a single block.
+  ASSERT_TRUE(arena.Reset(0));
+  EXPECT_GE(arena.capacity(), used);
+  auto* const first = static_cast<uint8_t*>(arena.Allocate(48));
+  ASSERT_NE(first, nullptr);
+  for (int i = 1; i < 10; ++i) {
+    auto* const memory = static_cast<uint8_t*>(arena.Allocate(48));
+    ASSERT_NE(memory, nullptr);
+    EXPECT_LT(memory, first + arena.capacity());
+  }
+}
+
+TEST(ArenaTest, Trim) {
+  Arena arena;
+  ASSERT_TRUE(arena.Reset(64));
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_NE(arena.Allocate(48), nullptr);
+  }
+  arena.Trim();
+  EXPECT_EQ(arena.capacity(), size_t{0});
+  EXPECT_EQ(arena.used(), size_t{0});
+  // The arena does not grow to the size used before Trim().
+  ASSERT_TRUE(arena.Reset(64));
+  EXPECT_EQ(arena.capacity(), size_t{64});
+  EXPECT_NE(arena.Allocate(48), nullptr);
+}
+
+TEST(ArenaTest, LargeAllocation) {
+  Arena arena;
+  ASSERT_TRUE(arena.Reset(0));
+  constexpr size_t kSize = 1024 * 1024;
+  auto* const memory = static_cast<uint8_t*>(arena.Allocate(kSize));
+  ASSERT_NE(memory, nullptr);
+  memory[0] = 1;
+  memory[kSize - 1] = 1;
+}
+
+TEST(ArenaTest, AllocateArray) {
+  struct Element {
+    int value = 5;
+  };
+  Arena arena;
+  ASSERT_TRUE(arena.Reset(1024));
+  Element* const elements = arena.AllocateArray<Element>(10);
+  ASSERT_NE(elements, nullptr);
+  EXPECT_TRUE(IsAligned(elements, alignof(Element)));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(elements[i].value, 5);
+  }
+}
+
+TEST(ArenaTest, ArenaUniquePtr) {
+  struct Counted {
+    explicit Counted(int* destroyed) : destroyed(destroyed) {}
+    ~Counted() { ++*destroyed; }
+    int* const destroyed;
+  };
+  int destroyed = 0;
+  Arena arena;
+  ASSERT_TRUE(arena.Reset(1024));
+  {
+    void* const memory = arena.Allocate(sizeof(Counted), alignof(Counted));
+    ASSERT_NE(memory, nullptr);
+    ArenaUniquePtr<Counted> counted(new (memory) Counted(&destroyed));
+    EXPECT_EQ(destroyed, 0);
+  }
+  EXPECT_EQ(destroyed, 1);
+}
+
+}  // namespace
+}  // namespace libgav1
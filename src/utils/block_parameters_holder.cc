@@ -44,6 +44,15 @@ BlockParameters* BlockParametersHolder::Get(int row4x4, int column4x4,
   return bp.get();
 }
 
+void BlockParametersHolder::Trim() {
+  const size_t used =
+      std::min(static_cast<size_t>(index_.load(std::memory_order_relaxed)),
+               block_parameters_.size());
+  for (size_t i = used; i < block_parameters_.size(); ++i) {
+    block_parameters_.get()[i] = nullptr;
+  }
+}
+
 void BlockParametersHolder::FillCache(int row4x4, int column4x4,
                                       BlockSize block_size,
                                       BlockParameters* const bp) {
@@ -45,6 +45,10 @@ class BlockParametersHolder {
   // of size |block_size| with the returned pointer.
   BlockParameters* Get(int row4x4, int column4x4, BlockSize block_size);
 
+  // Frees the BlockParameters objects that were not handed out by Get() since
+  // the last call to Reset().
+  void Trim();
+
   // Finds the BlockParameters corresponding to |row4x4| and |column4x4|. This
   // is done as a simple look up of the |block_parameters_cache_| matrix.
   // Returns nullptr if the BlockParameters cannot be found.
@@ -72,5 +72,23 @@ TEST(BlockParametersHolder, TestBasic) {
   EXPECT_NE(bp4, nullptr);
 }
 
+TEST(BlockParametersHolder, TestTrim) {
+  BlockParametersHolder holder;
+  ASSERT_TRUE(holder.Reset(20, 20));
+  BlockParameters* const bp1 = holder.Get(0, 0, kBlock32x32);
+  ASSERT_NE(bp1, nullptr);
+  BlockParameters* const bp2 = holder.Get(0, 8, kBlock32x32);
+  ASSERT_NE(bp2, nullptr);
+
+  ASSERT_TRUE(holder.Reset(20, 20));
+  EXPECT_EQ(holder.Get(0, 0, kBlock32x32), bp1);
+  // The object that was not used since the last Reset() is freed. The one that
+  // was used is kept.
+  holder.Trim();
+  ASSERT_TRUE(holder.Reset(20, 20));
+  EXPECT_EQ(holder.Get(0, 0, kBlock32x32), bp1);
+  EXPECT_NE(holder.Get(0, 8, kBlock32x32), nullptr);
+}
+
 }  // namespace
 }  // namespace libgav1
@@ -71,6 +71,14 @@ uint32_t GetCpuInfo() {
       if (max_cpuid_value >= 7) {
         CpuId(7, info);
         if ((info[1] & (1 << 5)) != 0) features |= kAVX2;
+        // Bits 16 (AVX512F), 17 (AVX512DQ), 30 (AVX512BW) & 31 (AVX512VL).
+        constexpr uint32_t kAvx512Bits =
+            (1u << 16) | (1u << 17) | (1u << 30) | (1u << 31);
+        // Opmask, upper ZMM0-15 and ZMM16-31 state enabled by the OS.
+        if ((info[1] & kAvx512Bits) == kAvx512Bits &&
+            (Xgetbv() & 0xe0) == 0xe0) {
+          features |= kAVX512;
+        }
       }
     }
   }
@@ -0,0 +1,163 @@
+// Copyright 2023 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/utils/cpu_affinity.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+// The mbind() system call is not allowed for Android applications.
+#if !defined(__ANDROID__)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#define LIBGAV1_HAVE_MBIND 1
+#endif  // !defined(__ANDROID__)
+#endif  // defined(__linux__)
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+namespace libgav1 {
+namespace {
+
+#if defined(__linux__)
+
+// Reads a list such as "0-3,8,10-11\n", the format of the sysfs files that
+// describe the NUMA nodes, from the file at |path| and adds its elements to
+// |set|. Returns false if the file cannot be read or is malformed.
+bool ReadList(const char* path, CpuSet* const set) {
+  FILE* const file = fopen(path, "r");
+  if (file == nullptr) return false;
+  char line[4096];
+  const bool read = fgets(line, sizeof(line), file) != nullptr;
+  fclose(file);
+  if (!read) return false;
+  const char* p = line;
+  while (*p != '\0' && *p != '\n') {
+    char* end;
+    const int64_t first = strtol(p, &end, 10);
+    if (end == p || first < 0) return false;
+    int64_t last = first;
+    p = end;
+    if (*p == '-') {
+      ++p;
+      last = strtol(p, &end, 10);
+      if (end == p || last < first) return false;
+      p = end;
+    }
+    for (int64_t i = first; i <= last && i < CpuSet::kMaxCpus; ++i) {
+      set->Add(static_cast<int>(i));
+    }
+    if (*p == ',') ++p;
+  }
+  return true;
+}
+
+bool GetCurrentThreadCpus(CpuSet* const cpus) {
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0) return false;
+  for (int cpu = 0; cpu < CpuSet::kMaxCpus && cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &cpu_set)) cpus->Add(cpu);
+  }
+  return !cpus->Empty();
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
+
+bool GetNumaTopology(NumaTopology* const topology) {
+  topology->num_nodes = 0;
+  for (auto& node_cpus : topology->node_cpus) node_cpus = CpuSet();
+#if defined(__linux__)
+  CpuSet allowed_cpus;
+  if (!GetCurrentThreadCpus(&allowed_cpus)) return false;
+  CpuSet nodes;
+  if (ReadList("/sys/devices/system/node/online", &nodes)) {
+    bool has_cpus = false;
+    for (int node = 0; node < kMaxNumaNodes; ++node) {
+      if (!nodes.Contains(node)) continue;
+      char path[64];
+      snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+               node);
+      CpuSet& node_cpus = topology->node_cpus[node];
+      if (!ReadList(path, &node_cpus)) {
+        node_cpus = CpuSet();
+        continue;
+      }
+      node_cpus.Intersect(allowed_cpus);
+      has_cpus |= !node_cpus.Empty();
+      topology->num_nodes = node + 1;
+    }
+    if (has_cpus) return true;
+    for (auto& node_cpus : topology->node_cpus) node_cpus = CpuSet();
+  }
+  topology->num_nodes = 1;
+  topology->node_cpus[0] = allowed_cpus;
+  return true;
+#else   // !defined(__linux__)
+  return false;
+#endif  // defined(__linux__)
+}
+
+bool SetCurrentThreadAffinity(const CpuSet& cpus) {
+  if (cpus.Empty()) return false;
+#if defined(__linux__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int cpu = 0; cpu < CpuSet::kMaxCpus && cpu < CPU_SETSIZE; ++cpu) {
+    if (cpus.Contains(cpu)) CPU_SET(cpu, &cpu_set);
+  }
+  // A pid of 0 refers to the calling thread.
+  return sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+#else   // !defined(__linux__)
+  return false;
+#endif  // defined(__linux__)
+}
+
+bool BindMemoryToNumaNodes(void* const address, const size_t size,
+                           const uint64_t node_mask) {
+#if defined(LIBGAV1_HAVE_MBIND)
+  if (node_mask == 0) return false;
+  const int64_t page_size = sysconf(_SC_PAGESIZE);
+  if (page_size <= 0) return false;
+  const uintptr_t page_mask = ~static_cast<uintptr_t>(page_size - 1);
+  const uintptr_t begin =
+      (reinterpret_cast<uintptr_t>(address) + page_size - 1) & page_mask;
+  const uintptr_t end = (reinterpret_cast<uintptr_t>(address) + size) &
+                        page_mask;
+  if (begin >= end) return false;
+  // The kernel expects the node mask as an array of unsigned long.
+  constexpr int kBitsPerWord = 8 * sizeof(unsigned long);  // NOLINT
+  unsigned long words[kMaxNumaNodes / kBitsPerWord] = {};  // NOLINT
+  for (int node = 0; node < kMaxNumaNodes; ++node) {
+    if (((node_mask >> node) & 1) != 0) {
+      words[node / kBitsPerWord] |= 1UL << (node % kBitsPerWord);
+    }
+  }
+  const int mode = ((node_mask & (node_mask - 1)) == 0) ? MPOL_PREFERRED
+                                                        : MPOL_INTERLEAVE;
+  return syscall(SYS_mbind, begin, end - begin, mode, words,
+                 kMaxNumaNodes + 1, 0) == 0;
+#else   // !defined(LIBGAV1_HAVE_MBIND)
+  static_cast<void>(address);
+  static_cast<void>(size);
+  static_cast<void>(node_mask);
+  return false;
+#endif  // defined(LIBGAV1_HAVE_MBIND)
+}
+
+}  // namespace libgav1
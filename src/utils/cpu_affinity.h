@@ -0,0 +1,84 @@
+/*
+ * Copyright 2023 The libgav1 Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIBGAV1_SRC_UTILS_CPU_AFFINITY_H_
+#define LIBGAV1_SRC_UTILS_CPU_AFFINITY_H_
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+namespace libgav1 {
+
+// A set of logical CPUs, numbered as by the operating system.
+class CpuSet {
+ public:
+  static constexpr int kMaxCpus = 1024;
+
+  // Adds |cpu| to the set. CPUs outside of [0, kMaxCpus) are ignored.
+  void Add(int cpu) {
+    if (cpu >= 0 && cpu < kMaxCpus) cpus_.set(cpu);
+  }
+  // Adds all the CPUs of |other| to the set.
+  void Add(const CpuSet& other) { cpus_ |= other.cpus_; }
+  // Removes the CPUs that are not in |other| from the set.
+  void Intersect(const CpuSet& other) { cpus_ &= other.cpus_; }
+
+  bool Contains(int cpu) const {
+    return cpu >= 0 && cpu < kMaxCpus && cpus_.test(cpu);
+  }
+  bool Intersects(const CpuSet& other) const {
+    return (cpus_ & other.cpus_).any();
+  }
+  bool Empty() const { return cpus_.none(); }
+  int Count() const { return static_cast<int>(cpus_.count()); }
+
+ private:
+  std::bitset<kMaxCpus> cpus_;
+};
+
+constexpr int kMaxNumaNodes = 64;
+
+// The CPUs of each NUMA node of the system.
+struct NumaTopology {
+  int num_nodes = 0;
+  // Indexed by node number. Only the CPUs that the calling thread was allowed
+  // to run on when the topology was read are included, so some of the nodes
+  // may be empty.
+  CpuSet node_cpus[kMaxNumaNodes];
+};
+
+// Reads the NUMA topology of the system into |topology|. If the operating
+// system does not report one, |topology| has a single node with all the CPUs
+// the calling thread may run on. Returns false if these CPUs cannot be
+// determined, in which case |topology->num_nodes| is 0.
+bool GetNumaTopology(NumaTopology* topology);
+
+// Restricts the calling thread to the CPUs in |cpus|. Returns false if |cpus|
+// is empty, if the operating system rejects it or if thread affinity is not
+// supported on this platform.
+bool SetCurrentThreadAffinity(const CpuSet& cpus);
+
+// Asks the operating system to back the pages that lie entirely within
+// [address, address + size) with memory from the NUMA nodes in |node_mask|
+// (bit i is node i), interleaving them if there are several nodes. This only
+// affects the pages that have not been written to yet and it is only a hint.
+// Returns false if the hint could not be given.
+bool BindMemoryToNumaNodes(void* address, size_t size, uint64_t node_mask);
+
+}  // namespace libgav1
+
+#endif  // LIBGAV1_SRC_UTILS_CPU_AFFINITY_H_
@@ -0,0 +1,102 @@
+// Copyright 2023 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/utils/cpu_affinity.h"
+
+#include <cstdint>
+#include <thread>  // NOLINT (unapproved c++11 header)
+
+#include "gtest/gtest.h"
+
+namespace libgav1 {
+namespace {
+
+TEST(CpuSetTest, Basic) {
+  CpuSet cpus;
+  EXPECT_TRUE(cpus.Empty());
+  EXPECT_EQ(cpus.Count(), 0);
+  cpus.Add(3);
+  cpus.Add(-1);
+  cpus.Add(CpuSet::kMaxCpus);
+  EXPECT_FALSE(cpus.Empty());
+  EXPECT_EQ(cpus.Count(), 1);
+  EXPECT_TRUE(cpus.Contains(3));
+  EXPECT_FALSE(cpus.Contains(2));
+  EXPECT_FALSE(cpus.Contains(-1));
+
+  CpuSet other;
+  other.Add(2);
+  EXPECT_FALSE(cpus.Intersects(other));
+  other.Add(CpuSet::kMaxCpus - 1);
+  cpus.Add(other);
+  EXPECT_EQ(cpus.Count(), 3);
+  EXPECT_TRUE(cpus.Intersects(other));
+  cpus.Intersect(other);
+  EXPECT_EQ(cpus.Count(), 2);
+  EXPECT_FALSE(cpus.Contains(3));
+  EXPECT_TRUE(cpus.Contains(CpuSet::kMaxCpus - 1));
+}
+
+TEST(CpuAffinityTest, SetCurrentThreadAffinityRejectsEmptySet) {
+  EXPECT_FALSE(SetCurrentThreadAffinity(CpuSet()));
+}
+
+#if defined(__linux__)
+
+TEST(CpuAffinityTest, NumaTopology) {
+  NumaTopology topology;
+  ASSERT_TRUE(GetNumaTopology(&topology));
+  ASSERT_GT(topology.num_nodes, 0);
+  ASSERT_LE(topology.num_nodes, kMaxNumaNodes);
+  CpuSet all_cpus;
+  for (int i = 0; i < topology.num_nodes; ++i) {
+    // The nodes do not share CPUs.
+    EXPECT_FALSE(all_cpus.Intersects(topology.node_cpus[i]));
+    all_cpus.Add(topology.node_cpus[i]);
+  }
+  EXPECT_FALSE(all_cpus.Empty());
+}
+
+TEST(CpuAffinityTest, SetCurrentThreadAffinity) {
+  NumaTopology topology;
+  ASSERT_TRUE(GetNumaTopology(&topology));
+  int node = 0;
+  while (topology.node_cpus[node].Empty()) ++node;
+  const CpuSet& node_cpus = topology.node_cpus[node];
+  // Use another thread so that the affinity of the test thread is unchanged.
+  std::thread thread([&node_cpus]() {
+    ASSERT_TRUE(SetCurrentThreadAffinity(node_cpus));
+    NumaTopology thread_topology;
+    ASSERT_TRUE(GetNumaTopology(&thread_topology));
+    // The topology only includes the CPUs the thread may run on.
+    CpuSet thread_cpus;
+    for (int i = 0; i < thread_topology.num_nodes; ++i) {
+      thread_cpus.Add(thread_topology.node_cpus[i]);
+    }
+    EXPECT_EQ(thread_cpus.Count(), node_cpus.Count());
+    EXPECT_TRUE(thread_cpus.Intersects(node_cpus));
+  });
+  thread.join();
+}
+
+#endif  // defined(__linux__)
+
+TEST(CpuAffinityTest, BindMemoryToNumaNodesRejectsSmallRanges) {
+  uint8_t buffer[16];
+  EXPECT_FALSE(BindMemoryToNumaNodes(buffer, sizeof(buffer), 1));
+  EXPECT_FALSE(BindMemoryToNumaNodes(buffer, sizeof(buffer), 0));
+}
+
+}  // namespace
+}  // namespace libgav1
@@ -18,6 +18,7 @@ endif() # LIBGAV1_UTILS_LIBGAV1_UTILS_CMAKE_
 set(LIBGAV1_UTILS_LIBGAV1_UTILS_CMAKE_ 1)
 
 list(APPEND libgav1_utils_sources
+            "${libgav1_source}/utils/arena.h"
             "${libgav1_source}/utils/array_2d.h"
             "${libgav1_source}/utils/bit_mask_set.h"
             "${libgav1_source}/utils/bit_reader.cc"
@@ -31,6 +32,8 @@ list(APPEND libgav1_utils_sources
             "${libgav1_source}/utils/constants.h"
             "${libgav1_source}/utils/cpu.cc"
             "${libgav1_source}/utils/cpu.h"
+            "${libgav1_source}/utils/cpu_affinity.cc"
+            "${libgav1_source}/utils/cpu_affinity.h"
             "${libgav1_source}/utils/dynamic_buffer.h"
             "${libgav1_source}/utils/entropy_decoder.cc"
             "${libgav1_source}/utils/entropy_decoder.h"
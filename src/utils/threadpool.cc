@@ -25,6 +25,7 @@
 #include <unistd.h>
 #endif
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cinttypes>
 #include <cstddef>
@@ -32,8 +33,11 @@
 #include <cstdio>
 #include <cstring>
 #include <new>
+#include <thread>  // NOLINT (unapproved c++11 header)
 #include <utility>
 
+#include "src/utils/constants.h"
+
 #if defined(__ANDROID__)
 #include <chrono>  // NOLINT (unapproved c++11 header)
 #endif
@@ -55,17 +59,24 @@ static pid_t GetTid() { return static_cast<pid_t>(syscall(SYS_gettid)); }
 #endif  // defined(__GLIBC__)
 
 namespace libgav1 {
-
-#if defined(__ANDROID__)
 namespace {
 
+#if defined(__ANDROID__)
 using Clock = std::chrono::steady_clock;
 using Duration = Clock::duration;
 constexpr Duration kBusyWaitDuration =
     std::chrono::duration_cast<Duration>(std::chrono::duration<double>(2e-3));
+#endif  // defined(__ANDROID__)
+
+// Number of failed attempts to take a WorkQueue lock before yielding.
+constexpr int kSpinsBeforeYield = 64;
+
+// The kWorkStealing pool, if any, that the current thread is a worker of and
+// the index of that worker.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local int current_worker_index = 0;
 
 }  // namespace
-#endif  // defined(__ANDROID__)
 
 // static
 std::unique_ptr<ThreadPool> ThreadPool::Create(int num_threads) {
@@ -75,22 +86,60 @@ std::unique_ptr<ThreadPool> ThreadPool::Create(int num_threads) {
 // static
 std::unique_ptr<ThreadPool> ThreadPool::Create(const char name_prefix[],
                                                int num_threads) {
-  if (name_prefix == nullptr || num_threads <= 0) return nullptr;
+  return Create(name_prefix, num_threads, kDefaultMode);
+}
+
+// static
+std::unique_ptr<ThreadPool> ThreadPool::Create(const char name_prefix[],
+                                               int num_threads, Mode mode) {
+  return Create(name_prefix, num_threads, mode, CpuSet());
+}
+
+// static
+std::unique_ptr<ThreadPool> ThreadPool::Create(const char name_prefix[],
+                                               int num_threads, Mode mode,
+                                               const CpuSet& affinity) {
+  if (name_prefix == nullptr || num_threads <= 0 ||
+      mode == Mode::kExternalExecutor) {
+    return nullptr;
+  }
   std::unique_ptr<WorkerThread*[]> threads(new (std::nothrow)
                                                WorkerThread*[num_threads]);
   if (threads == nullptr) return nullptr;
   std::unique_ptr<ThreadPool> pool(new (std::nothrow) ThreadPool(
-      name_prefix, std::move(threads), num_threads));
+      name_prefix, std::move(threads), num_threads, mode, affinity));
   if (pool != nullptr && !pool->StartWorkers()) {
     pool = nullptr;
   }
   return pool;
 }
 
+// static
+std::unique_ptr<ThreadPool> ThreadPool::Create(Executor* executor,
+                                               int num_threads) {
+  if (executor == nullptr || num_threads <= 0) return nullptr;
+  // No worker threads are created, but the constructor expects room for the
+  // null terminator of |threads_|.
+  std::unique_ptr<WorkerThread*[]> threads(new (std::nothrow) WorkerThread*[1]);
+  if (threads == nullptr) return nullptr;
+  std::unique_ptr<ThreadPool> pool(
+      new (std::nothrow) ThreadPool(/*name_prefix=*/"", std::move(threads),
+                                    num_threads, Mode::kExternalExecutor,
+                                    CpuSet()));
+  if (pool == nullptr) return nullptr;
+  pool->executor_ = executor;
+  if (!pool->StartWorkers()) return nullptr;
+  return pool;
+}
+
 ThreadPool::ThreadPool(const char name_prefix[],
                        std::unique_ptr<WorkerThread*[]> threads,
-                       int num_threads)
-    : threads_(std::move(threads)), num_threads_(num_threads) {
+                       int num_threads, Mode mode,
+                       const CpuSet& affinity)
+    : threads_(std::move(threads)),
+      num_threads_(num_threads),
+      mode_(mode),
+      affinity_(affinity) {
   threads_[0] = nullptr;
   assert(name_prefix != nullptr);
   const size_t name_prefix_len =
@@ -102,27 +151,124 @@ ThreadPool::ThreadPool(const char name_prefix[],
 ThreadPool::~ThreadPool() { Shutdown(); }
 
 void ThreadPool::Schedule(std::function<void()> closure) {
+  Schedule(std::move(closure), Priority::kNormal);
+}
+
+void ThreadPool::Schedule(std::function<void()> closure, Priority priority) {
+  if (mode_ == Mode::kWorkStealing) {
+    ScheduleWorkStealing(std::move(closure), priority);
+    return;
+  }
+  if (mode_ == Mode::kExternalExecutor) {
+    ScheduleExternal(std::move(closure), priority);
+    return;
+  }
+  UnboundedQueue<std::function<void()>>& queue =
+      (priority == Priority::kHigh) ? high_priority_queue_ : queue_;
   LockMutex();
-  if (!queue_.GrowIfNeeded()) {
-    // queue_ is full and we can't grow it. Run |closure| directly.
+  if (!queue.GrowIfNeeded()) {
+    // |queue| is full and we can't grow it. Run |closure| directly.
     UnlockMutex();
     closure();
     return;
   }
-  queue_.Push(std::move(closure));
+  queue.Push(std::move(closure));
   UnlockMutex();
   SignalOne();
 }
 
 int ThreadPool::num_threads() const { return num_threads_; }
 
+// A job queue owned by one worker in kWorkStealing mode. The queue is
+// guarded by a spin lock because it is only held for a push or a pop, and
+// jobs are stored in the recycled blocks of an UnboundedQueue so that
+// scheduling does not allocate once the queue has warmed up. The queues are
+// aligned to cache lines so that the locks of neighboring queues do not share
+// one.
+class alignas(kCacheLineSize) ThreadPool::WorkQueue {
+ public:
+  WorkQueue() = default;
+
+  // Not copyable or movable.
+  WorkQueue(const WorkQueue&) = delete;
+  WorkQueue& operator=(const WorkQueue&) = delete;
+
+  // Allocable does not honor the alignment of the class, so arrays of
+  // WorkQueues are allocated with AlignedAlloc().
+  static void* operator new[](size_t size) = delete;
+  static void* operator new[](size_t size,
+                              const std::nothrow_t& /*tag*/) noexcept {
+    if (size > 0x40000000) return nullptr;
+    return AlignedAlloc(alignof(WorkQueue), size);
+  }
+  static void operator delete[](void* ptr) noexcept { AlignedFree(ptr); }
+  static void operator delete[](void* ptr,
+                                const std::nothrow_t& /*tag*/) noexcept {
+    AlignedFree(ptr);
+  }
+
+  LIBGAV1_MUST_USE_RESULT bool Init() { return queue_.Init(); }
+
+  // Moves |*closure| to the back of the queue. Returns false, leaving
+  // |*closure| untouched, if the queue is full and cannot be grown.
+  LIBGAV1_MUST_USE_RESULT bool Push(std::function<void()>* closure) {
+    Lock();
+    if (!queue_.GrowIfNeeded()) {
+      Unlock();
+      return false;
+    }
+    queue_.Push(std::move(*closure));
+    size_.fetch_add(1, std::memory_order_relaxed);
+    Unlock();
+    return true;
+  }
+
+  // Moves the job at the front of the queue to |*job|. Returns false if the
+  // queue is empty.
+  bool Pop(std::function<void()>* job) {
+    // Skip the lock for queues that look empty. A job added concurrently is
+    // accounted for in |pending_jobs_|, so the caller will come back for it.
+    if (size_.load(std::memory_order_relaxed) == 0) return false;
+    Lock();
+    if (queue_.Empty()) {
+      Unlock();
+      return false;
+    }
+    *job = std::move(queue_.Front());
+    queue_.Pop();
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    Unlock();
+    return true;
+  }
+
+ private:
+  void Lock() {
+    int spins = 0;
+    while (locked_.exchange(true, std::memory_order_acquire)) {
+      while (locked_.load(std::memory_order_relaxed)) {
+        if (++spins == kSpinsBeforeYield) {
+          spins = 0;
+          std::this_thread::yield();
+        }
+      }
+    }
+  }
+
+  void Unlock() { locked_.store(false, std::memory_order_release); }
+
+  std::atomic<bool> locked_{false};
+  std::atomic<int> size_{0};
+  UnboundedQueue<std::function<void()>> queue_;
+};
+
 // A simple implementation that mirrors the non-portable Thread.  We may
 // choose to expand this in the future as a portable implementation of
 // Thread, or replace it at such a time as one is implemented.
 class ThreadPool::WorkerThread : public Allocable {
  public:
-  // Creates and starts a thread that runs pool->WorkerFunction().
-  explicit WorkerThread(ThreadPool* pool);
+  // Creates and starts a thread that runs pool->WorkerFunction(), or
+  // pool->WorkStealingWorkerFunction(index) in kWorkStealing mode.
+  WorkerThread(ThreadPool* pool, int index);
 
   // Not copyable or movable.
   WorkerThread(const WorkerThread&) = delete;
@@ -148,6 +294,7 @@ class ThreadPool::WorkerThread : public Allocable {
   void Run();
 
   ThreadPool* pool_;
+  const int index_;
 #if defined(_MSC_VER)
   HANDLE handle_;
 #else
@@ -155,7 +302,8 @@ class ThreadPool::WorkerThread : public Allocable {
 #endif
 };
 
-ThreadPool::WorkerThread::WorkerThread(ThreadPool* pool) : pool_(pool) {}
+ThreadPool::WorkerThread::WorkerThread(ThreadPool* pool, int index)
+    : pool_(pool), index_(index) {}
 
 #if defined(_MSC_VER)
 
@@ -236,13 +384,27 @@ void ThreadPool::WorkerThread::SetupName() {
 
 void ThreadPool::WorkerThread::Run() {
   SetupName();
-  pool_->WorkerFunction();
+  // The pool works without the affinity, so a failure is not reported.
+  if (!pool_->affinity_.Empty()) SetCurrentThreadAffinity(pool_->affinity_);
+  if (pool_->mode_ == Mode::kWorkStealing) {
+    pool_->WorkStealingWorkerFunction(index_);
+  } else {
+    pool_->WorkerFunction();
+  }
 }
 
 bool ThreadPool::StartWorkers() {
-  if (!queue_.Init()) return false;
+  if (!queue_.Init() || !high_priority_queue_.Init()) return false;
+  if (mode_ == Mode::kExternalExecutor) return true;
+  if (mode_ == Mode::kWorkStealing) {
+    work_queues_.reset(new (std::nothrow) WorkQueue[num_threads_ + 1]);
+    if (work_queues_ == nullptr) return false;
+    for (int i = 0; i <= num_threads_; ++i) {
+      if (!work_queues_[i].Init()) return false;
+    }
+  }
   for (int i = 0; i < num_threads_; ++i) {
-    threads_[i] = new (std::nothrow) WorkerThread(this);
+    threads_[i] = new (std::nothrow) WorkerThread(this, i);
     if (threads_[i] == nullptr) return false;
     if (!threads_[i]->Start()) {
       delete threads_[i];
@@ -253,10 +415,18 @@ bool ThreadPool::StartWorkers() {
   return true;
 }
 
+void ThreadPool::PopJob(std::function<void()>* const job) {
+  UnboundedQueue<std::function<void()>>& queue =
+      high_priority_queue_.Empty() ? queue_ : high_priority_queue_;
+  assert(!queue.Empty());
+  *job = std::move(queue.Front());
+  queue.Pop();
+}
+
 void ThreadPool::WorkerFunction() {
   LockMutex();
   while (true) {
-    if (queue_.Empty()) {
+    if (QueuesEmpty()) {
       if (exit_threads_) {
         break;  // Queue is empty and exit was requested.
       }
@@ -272,20 +442,20 @@ void ThreadPool::WorkerFunction() {
       const auto wait_start = Clock::now();
       while (Clock::now() - wait_start < kBusyWaitDuration) {
         LockMutex();
-        if (!queue_.Empty()) {
+        if (!QueuesEmpty()) {
           found_job = true;
           break;
         }
         UnlockMutex();
       }
       // If |found_job| is true, we simply continue since we already hold the
-      // mutex and we know for sure that the |queue_| is not empty.
+      // mutex and we know for sure that the queues are not empty.
       if (found_job) continue;
       // Since |found_job_| was false, the mutex is not being held at this
       // point.
       LockMutex();
-      // Ensure that the queue is still empty.
-      if (!queue_.Empty()) continue;
+      // Ensure that the queues are still empty.
+      if (!QueuesEmpty()) continue;
       if (exit_threads_) {
         break;  // Queue is empty and exit was requested.
       }
@@ -293,9 +463,9 @@ void ThreadPool::WorkerFunction() {
       // Queue is still empty, wait for signal or broadcast.
       Wait();
     } else {
-      // Take a job from the queue.
-      std::function<void()> job = std::move(queue_.Front());
-      queue_.Pop();
+      // Take a job from the queues.
+      std::function<void()> job;
+      PopJob(&job);
 
       UnlockMutex();
       // Note that it is good practice to surround this with a try/catch so
@@ -310,10 +480,148 @@ void ThreadPool::WorkerFunction() {
   UnlockMutex();
 }
 
+void ThreadPool::ScheduleWorkStealing(std::function<void()> closure,
+                                      Priority priority) {
+  int index;
+  if (priority == Priority::kHigh) {
+    // The WorkQueue after the ones owned by the workers holds the kHigh
+    // priority jobs.
+    index = num_threads_;
+  } else if (current_pool == this) {
+    index = current_worker_index;
+  } else {
+    index = static_cast<int>(next_queue_.fetch_add(
+                                 1, std::memory_order_relaxed) %
+                             static_cast<unsigned int>(num_threads_));
+  }
+  // Count the job before it becomes visible. Together with the order of
+  // operations in WorkStealingWorkerFunction() this guarantees that either a
+  // worker about to sleep sees the job or we see that worker and wake it up.
+  pending_jobs_.fetch_add(1);
+  if (!work_queues_[index].Push(&closure)) {
+    // The queue is full and we can't grow it. Run |closure| directly.
+    pending_jobs_.fetch_sub(1);
+    closure();
+    return;
+  }
+  if (idle_workers_.load() > 0) {
+    // Taking the mutex ensures the idle worker is either waiting or will
+    // see the job when it checks |pending_jobs_|.
+    LockMutex();
+    UnlockMutex();
+    SignalOne();
+  }
+}
+
+bool ThreadPool::TakeJob(int index, std::function<void()>* job) {
+  if (work_queues_[num_threads_].Pop(job)) {
+    pending_jobs_.fetch_sub(1);
+    return true;
+  }
+  for (int i = 0; i < num_threads_; ++i) {
+    int victim = index + i;
+    if (victim >= num_threads_) victim -= num_threads_;
+    if (work_queues_[victim].Pop(job)) {
+      pending_jobs_.fetch_sub(1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::WorkStealingWorkerFunction(int index) {
+  current_pool = this;
+  current_worker_index = index;
+  std::function<void()> job;
+  while (true) {
+    if (TakeJob(index, &job)) {
+      std::move(job)();
+      job = nullptr;
+      continue;
+    }
+#if defined(__ANDROID__)
+    // See the comment in WorkerFunction().
+    bool found_job = false;
+    const auto wait_start = Clock::now();
+    while (Clock::now() - wait_start < kBusyWaitDuration) {
+      if (pending_jobs_.load(std::memory_order_relaxed) != 0) {
+        found_job = true;
+        break;
+      }
+    }
+    if (found_job) continue;
+#endif  // defined(__ANDROID__)
+    LockMutex();
+    idle_workers_.fetch_add(1);
+    bool exit = false;
+    if (pending_jobs_.load() == 0) {
+      if (exit_threads_) {
+        exit = true;  // No work left and exit was requested.
+      } else {
+        // No work anywhere, wait for signal or broadcast.
+        Wait();
+      }
+    }
+    idle_workers_.fetch_sub(1);
+    UnlockMutex();
+    if (exit) break;
+  }
+  current_pool = nullptr;
+}
+
+void ThreadPool::ScheduleExternal(std::function<void()> closure,
+                                  Priority priority) {
+  UnboundedQueue<std::function<void()>>& queue =
+      (priority == Priority::kHigh) ? high_priority_queue_ : queue_;
+  LockMutex();
+  if (!queue.GrowIfNeeded()) {
+    // |queue| is full and we can't grow it. Run |closure| directly.
+    UnlockMutex();
+    closure();
+    return;
+  }
+  queue.Push(std::move(closure));
+  if (external_jobs_ == num_threads_) {
+    // One of the running jobs will pick up |closure|.
+    UnlockMutex();
+    return;
+  }
+  ++external_jobs_;
+  UnlockMutex();
+  executor_->Schedule([this]() { RunExternalJob(); });
+}
+
+void ThreadPool::RunExternalJob() {
+  LockMutex();
+  if (!QueuesEmpty()) {
+    std::function<void()> job;
+    PopJob(&job);
+    UnlockMutex();
+    std::move(job)();
+    job = nullptr;
+    LockMutex();
+    if (!QueuesEmpty()) {
+      UnlockMutex();
+      // Give the executor thread back between jobs so that the other users of
+      // |executor_| get their turn.
+      executor_->Schedule([this]() { RunExternalJob(); });
+      return;
+    }
+  }
+  // Signal while holding the mutex, Shutdown() may destroy the pool as soon
+  // as it is released.
+  if (--external_jobs_ == 0) SignalAll();
+  UnlockMutex();
+}
+
 void ThreadPool::Shutdown() {
   // Tell worker threads how to exit.
   LockMutex();
   exit_threads_ = true;
+  if (mode_ == Mode::kExternalExecutor) {
+    // Wait until |executor_| has run all of our jobs.
+    while (external_jobs_ != 0) Wait();
+  }
   UnlockMutex();
   SignalAll();
 
@@ -17,6 +17,7 @@
 #ifndef LIBGAV1_SRC_UTILS_THREADPOOL_H_
 #define LIBGAV1_SRC_UTILS_THREADPOOL_H_
 
+#include <atomic>
 #include <functional>
 #include <memory>
 
@@ -32,6 +33,12 @@
 #endif
 #endif
 
+// Selects the scheduler used by ThreadPool::Create() when no mode is given.
+// See ThreadPool::Mode.
+#if !defined(LIBGAV1_THREADPOOL_USE_WORK_STEALING)
+#define LIBGAV1_THREADPOOL_USE_WORK_STEALING 0
+#endif
+
 #if LIBGAV1_THREADPOOL_USE_STD_MUTEX
 #include <condition_variable>  // NOLINT (unapproved c++11 header)
 #include <mutex>               // NOLINT (unapproved c++11 header)
@@ -44,6 +51,7 @@
 #endif
 
 #include "src/utils/compiler_attributes.h"
+#include "src/utils/cpu_affinity.h"
 #include "src/utils/executor.h"
 #include "src/utils/memory.h"
 #include "src/utils/unbounded_queue.h"
@@ -68,6 +76,33 @@ namespace libgav1 {
 //   } // ThreadPool gets destroyed only when all jobs are done.
 class ThreadPool : public Executor, public Allocable {
  public:
+  enum class Mode {
+    // All jobs go through a single queue guarded by one mutex.
+    kSharedQueue,
+    // Each worker owns a job queue. Jobs scheduled from a worker thread are
+    // added to that worker's queue, other jobs are distributed round-robin.
+    // Idle workers steal from the other queues before going to sleep, so the
+    // shared mutex is only taken to put workers to sleep and wake them up.
+    kWorkStealing,
+    // The pool does not create any threads. Jobs are run on an Executor owned
+    // by the caller, with at most num_threads() of them handed to it at any
+    // given time. The remaining jobs wait in the pool's queue. This lets
+    // several pools share one Executor without any of them flooding it.
+    kExternalExecutor,
+  };
+
+  // Jobs with kHigh priority are run before all the kNormal priority jobs
+  // that are waiting in the pool's queues. They are meant for work on the
+  // critical path, such as the decoding of a reference frame that other
+  // threads are waiting on. Jobs with the same priority are run in the order
+  // described for the scheduler in use.
+  enum class Priority { kNormal, kHigh };
+
+  // The scheduler used by the factory methods that do not take a Mode.
+  static constexpr Mode kDefaultMode = LIBGAV1_THREADPOOL_USE_WORK_STEALING
+                                           ? Mode::kWorkStealing
+                                           : Mode::kSharedQueue;
+
   // Creates the thread pool with the specified number of worker threads.
   // If num_threads is 1, the closures are run in FIFO order.
   static std::unique_ptr<ThreadPool> Create(int num_threads);
@@ -76,6 +111,23 @@ class ThreadPool : public Executor, public Allocable {
   static std::unique_ptr<ThreadPool> Create(const char name_prefix[],
                                             int num_threads);
 
+  // Like the above factory method, but also selects the scheduler.
+  static std::unique_ptr<ThreadPool> Create(const char name_prefix[],
+                                            int num_threads, Mode mode);
+
+  // Like the above factory method, but also restricts the worker threads to
+  // the CPUs in |affinity|, if it is not empty. This is a best effort: the
+  // pool is still created if the affinity cannot be set.
+  static std::unique_ptr<ThreadPool> Create(const char name_prefix[],
+                                            int num_threads, Mode mode,
+                                            const CpuSet& affinity);
+
+  // Creates a kExternalExecutor pool that runs its jobs on |executor|.
+  // |executor| must outlive the pool and must eventually run every closure
+  // scheduled on it. It should not run them in the calling thread.
+  static std::unique_ptr<ThreadPool> Create(Executor* executor,
+                                            int num_threads);
+
   // The destructor will shut down the thread pool and all jobs are executed.
   // Note that after shutdown, the thread pool does not accept further jobs.
   ~ThreadPool() override;
@@ -92,21 +144,44 @@ class ThreadPool : public Executor, public Allocable {
   //   2. Have the current thread wait until the queue is not full.
   void Schedule(std::function<void()> closure) override;
 
+  // Like the above, but with the given |priority|. The above is the same as
+  // passing Priority::kNormal.
+  void Schedule(std::function<void()> closure, Priority priority);
+
   int num_threads() const;
 
+  Mode mode() const { return mode_; }
+
  private:
   class WorkerThread;
+  class WorkQueue;
 
   // Creates the thread pool with the specified number of worker threads.
   // If num_threads is 1, the closures are run in FIFO order.
   ThreadPool(const char name_prefix[], std::unique_ptr<WorkerThread*[]> threads,
-             int num_threads);
+             int num_threads, Mode mode, const CpuSet& affinity);
 
   // Starts the worker pool.
   LIBGAV1_MUST_USE_RESULT bool StartWorkers();
 
   void WorkerFunction();
 
+  // kWorkStealing versions of Schedule() and WorkerFunction(). |index| is the
+  // index of the calling worker and of the WorkQueue it owns.
+  void ScheduleWorkStealing(std::function<void()> closure, Priority priority);
+  void WorkStealingWorkerFunction(int index);
+
+  // Takes a job from the high priority WorkQueue, or failing that from the
+  // WorkQueue at |index| and then from the other WorkQueues. Returns false if
+  // all of them are empty.
+  bool TakeJob(int index, std::function<void()>* job);
+
+  // kExternalExecutor versions of Schedule() and WorkerFunction(). Each call
+  // to RunExternalJob() runs one job and then schedules itself on
+  // |executor_| again if there are more jobs in |queue_|.
+  void ScheduleExternal(std::function<void()> closure, Priority priority);
+  void RunExternalJob();
+
   // Shuts down the thread pool, i.e. worker threads finish their work and
   // pick up new jobs until the queue is empty. This call will block until
   // the shutdown is complete.
@@ -117,6 +192,17 @@ class ThreadPool : public Executor, public Allocable {
   // It is up to the caller to prevent adding new jobs.
   void Shutdown();
 
+  // Returns true if both |queue_| and |high_priority_queue_| are empty.
+  // |queue_mutex_| must be held.
+  bool QueuesEmpty() const {
+    return high_priority_queue_.Empty() && queue_.Empty();
+  }
+
+  // Moves the next job to |*job|, taking it from |high_priority_queue_| if it
+  // is not empty. |queue_mutex_| must be held and the queues must not be both
+  // empty.
+  void PopJob(std::function<void()>* job);
+
 #if LIBGAV1_THREADPOOL_USE_STD_MUTEX
 
   void LockMutex() { queue_mutex_.lock(); }
@@ -148,12 +234,37 @@ class ThreadPool : public Executor, public Allocable {
 #endif  // LIBGAV1_THREADPOOL_USE_STD_MUTEX
 
   UnboundedQueue<std::function<void()>> queue_ LIBGAV1_GUARDED_BY(queue_mutex_);
+  // The kHigh priority jobs in the kSharedQueue and kExternalExecutor modes.
+  UnboundedQueue<std::function<void()>> high_priority_queue_
+      LIBGAV1_GUARDED_BY(queue_mutex_);
   // If not all the worker threads are created, the first entry after the
   // created worker threads is a null pointer.
   const std::unique_ptr<WorkerThread*[]> threads_;
 
   bool exit_threads_ LIBGAV1_GUARDED_BY(queue_mutex_) = false;
   const int num_threads_ = 0;
+  const Mode mode_;
+  // The CPUs the worker threads run on. Empty if they are not restricted.
+  const CpuSet affinity_;
+
+  // The following members are only used in kWorkStealing mode. There is one
+  // WorkQueue per worker thread, followed by a WorkQueue shared by all the
+  // workers for the kHigh priority jobs.
+  std::unique_ptr<WorkQueue[]> work_queues_;
+  // Number of jobs that have been scheduled but not yet taken by a worker.
+  // Incremented before a job is added to a WorkQueue so that a worker about
+  // to sleep never misses it.
+  std::atomic<int> pending_jobs_{0};
+  // Number of workers that are about to wait or are waiting on |condition_|.
+  std::atomic<int> idle_workers_{0};
+  // Round-robin cursor used for jobs scheduled from outside the pool.
+  std::atomic<unsigned int> next_queue_{0};
+
+  // The following members are only used in kExternalExecutor mode.
+  Executor* executor_ = nullptr;
+  // Number of RunExternalJob() calls that have been handed to |executor_| and
+  // have not finished yet. Never exceeds |num_threads_|.
+  int external_jobs_ LIBGAV1_GUARDED_BY(queue_mutex_) = 0;
   // name_prefix_ is a C string, whose length is restricted to 16 characters,
   // including the terminating null byte ('\0'). This restriction comes from
   // the Linux pthread_setname_np() function.
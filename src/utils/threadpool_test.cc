@@ -14,9 +14,12 @@
 
 #include "src/utils/threadpool.h"
 
+#include <atomic>
 #include <cassert>
 #include <cstdint>
+#include <cstdio>
 #include <memory>
+#include <vector>
 
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
@@ -129,5 +132,195 @@ TEST(ThreadPoolTest, OneThreadRunsClosuresFIFO) {
   }
 }
 
+TEST(ThreadPoolTest, WorkStealingThreadedIntegerIncrement) {
+  std::unique_ptr<ThreadPool> thread_pool =
+      ThreadPool::Create("", 100, ThreadPool::Mode::kWorkStealing);
+  ASSERT_NE(thread_pool, nullptr);
+  EXPECT_EQ(thread_pool->num_threads(), 100);
+  EXPECT_EQ(thread_pool->mode(), ThreadPool::Mode::kWorkStealing);
+  SimpleGuardedInteger count(0);
+  for (int i = 0; i < 1000; ++i) {
+    thread_pool->Schedule([&count]() { IncrementIntegerJob(&count); });
+  }
+  thread_pool.reset(nullptr);
+  EXPECT_EQ(count.Value(), 1000);
+}
+
+TEST(ThreadPoolTest, WorkStealingOneThreadRunsClosuresFIFO) {
+  int count = 0;  // Declare first so that it outlives the thread pool.
+  std::unique_ptr<ThreadPool> pool =
+      ThreadPool::Create("", 1, ThreadPool::Mode::kWorkStealing);
+  ASSERT_NE(pool, nullptr);
+  for (int i = 0; i < 1000; ++i) {
+    pool->Schedule([&count, i]() {
+      EXPECT_EQ(count, i);
+      count++;
+    });
+  }
+}
+
+// Jobs scheduled from a worker go to that worker's queue and must be picked
+// up by the other workers while it is busy.
+TEST(ThreadPoolTest, WorkStealingNestedSchedule) {
+  SimpleGuardedInteger count(0);
+  std::unique_ptr<ThreadPool> pool =
+      ThreadPool::Create("", 8, ThreadPool::Mode::kWorkStealing);
+  ASSERT_NE(pool, nullptr);
+  ThreadPool* const pool_ptr = pool.get();
+  for (int i = 0; i < 8; ++i) {
+    count.Increment();
+    pool->Schedule([pool_ptr, &count]() {
+      for (int j = 0; j < 16; ++j) {
+        count.Increment();
+        pool_ptr->Schedule([&count]() {
+          LoopForMs(1);
+          count.Decrement();
+        });
+      }
+      // Keep this worker busy so that its queue has to be stolen from.
+      LoopForMs(50);
+      count.Decrement();
+    });
+  }
+  count.WaitForZero();
+  pool.reset(nullptr);
+  EXPECT_EQ(count.Value(), 0);
+}
+
+TEST(ThreadPoolTest, ExternalExecutorNullOrModeOnly) {
+  Executor* const executor = nullptr;
+  EXPECT_EQ(ThreadPool::Create(executor, 4), nullptr);
+  EXPECT_EQ(ThreadPool::Create("", 4, ThreadPool::Mode::kExternalExecutor),
+            nullptr);
+}
+
+// Two pools sharing one executor never have more than num_threads() jobs
+// running at once, and all their jobs are done when they are destroyed.
+TEST(ThreadPoolTest, ExternalExecutorLimitsJobsInFlight) {
+  std::unique_ptr<ThreadPool> executor = ThreadPool::Create(16);
+  ASSERT_NE(executor, nullptr);
+  std::atomic<int> running[2] = {{0}, {0}};
+  std::atomic<int> max_running[2] = {{0}, {0}};
+  SimpleGuardedInteger count(0);
+  {
+    std::unique_ptr<ThreadPool> pools[2] = {
+        ThreadPool::Create(executor.get(), 2),
+        ThreadPool::Create(executor.get(), 3)};
+    for (int p = 0; p < 2; ++p) {
+      ASSERT_NE(pools[p], nullptr);
+      EXPECT_EQ(pools[p]->num_threads(), 2 + p);
+      EXPECT_EQ(pools[p]->mode(), ThreadPool::Mode::kExternalExecutor);
+    }
+    for (int i = 0; i < 100; ++i) {
+      for (int p = 0; p < 2; ++p) {
+        pools[p]->Schedule([&running, &max_running, &count, p]() {
+          const int now = running[p].fetch_add(1) + 1;
+          int max = max_running[p].load();
+          while (now > max && !max_running[p].compare_exchange_weak(max, now)) {
+          }
+          LoopForMs(1);
+          running[p].fetch_sub(1);
+          count.Increment();
+        });
+      }
+    }
+  }
+  EXPECT_EQ(count.Value(), 200);
+  EXPECT_LE(max_running[0].load(), 2);
+  EXPECT_LE(max_running[1].load(), 3);
+}
+
+TEST(ThreadPoolTest, ExternalExecutorOneThreadRunsClosuresFIFO) {
+  int count = 0;  // Declare first so that it outlives the thread pools.
+  std::unique_ptr<ThreadPool> executor = ThreadPool::Create(4);
+  ASSERT_NE(executor, nullptr);
+  std::unique_ptr<ThreadPool> pool = ThreadPool::Create(executor.get(), 1);
+  ASSERT_NE(pool, nullptr);
+  for (int i = 0; i < 1000; ++i) {
+    pool->Schedule([&count, i]() {
+      EXPECT_EQ(count, i);
+      count++;
+    });
+  }
+}
+
+// Keeps the only worker of |pool| busy while kNormal and kHigh priority jobs
+// are queued, and checks that the kHigh priority jobs run first.
+void HighPriorityJobsRunFirst(std::unique_ptr<ThreadPool> pool) {
+  ASSERT_NE(pool, nullptr);
+  ASSERT_EQ(pool->num_threads(), 1);
+  std::atomic<bool> started(false);
+  std::atomic<bool> release(false);
+  std::vector<int> order;
+  pool->Schedule([&started, &release]() {
+    started = true;
+    while (!release) LoopForMs(1);
+  });
+  while (!started) LoopForMs(1);
+  for (int i = 0; i < 8; ++i) {
+    pool->Schedule([&order, i]() { order.push_back(i); });
+    pool->Schedule([&order, i]() { order.push_back(100 + i); },
+                   ThreadPool::Priority::kHigh);
+  }
+  release = true;
+  pool.reset(nullptr);
+  ASSERT_EQ(order.size(), 16);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(order[i], 100 + i);
+    EXPECT_EQ(order[8 + i], i);
+  }
+}
+
+TEST(ThreadPoolTest, HighPriorityJobsRunFirst) {
+  HighPriorityJobsRunFirst(
+      ThreadPool::Create("", 1, ThreadPool::Mode::kSharedQueue));
+}
+
+TEST(ThreadPoolTest, WorkStealingHighPriorityJobsRunFirst) {
+  HighPriorityJobsRunFirst(
+      ThreadPool::Create("", 1, ThreadPool::Mode::kWorkStealing));
+}
+
+TEST(ThreadPoolTest, ExternalExecutorHighPriorityJobsRunFirst) {
+  std::unique_ptr<ThreadPool> executor = ThreadPool::Create(4);
+  ASSERT_NE(executor, nullptr);
+  HighPriorityJobsRunFirst(ThreadPool::Create(executor.get(), 1));
+}
+
+// Schedules many small jobs, half from the calling thread and half from
+// within the pool, and reports the time taken by each scheduler.
+void ContentionTest(ThreadPool::Mode mode, const char* mode_name) {
+  constexpr int kNumThreads = 32;
+  constexpr int kNumRootJobs = 256;
+  constexpr int kNumChildJobs = 256;
+  constexpr int kTotalJobs = kNumRootJobs * (1 + kNumChildJobs);
+  std::atomic<int> count(0);
+  std::unique_ptr<ThreadPool> pool =
+      ThreadPool::Create("", kNumThreads, mode);
+  ASSERT_NE(pool, nullptr);
+  ThreadPool* const pool_ptr = pool.get();
+  const absl::Time start = absl::Now();
+  for (int i = 0; i < kNumRootJobs; ++i) {
+    pool->Schedule([pool_ptr, &count]() {
+      for (int j = 0; j < kNumChildJobs; ++j) {
+        pool_ptr->Schedule(
+            [&count]() { count.fetch_add(1, std::memory_order_relaxed); });
+      }
+      count.fetch_add(1, std::memory_order_relaxed);
+    });
+  }
+  pool.reset(nullptr);
+  const absl::Duration elapsed_time = absl::Now() - start;
+  EXPECT_EQ(count.load(), kTotalJobs);
+  printf("Mode %s: %d jobs on %d threads: %d us\n", mode_name, kTotalJobs,
+         kNumThreads,
+         static_cast<int>(absl::ToInt64Microseconds(elapsed_time)));
+}
+
+TEST(ThreadPoolTest, DISABLED_ContentionSpeed) {
+  ContentionTest(ThreadPool::Mode::kSharedQueue, "SharedQueue");
+  ContentionTest(ThreadPool::Mode::kWorkStealing, "WorkStealing");
+}
+
 }  // namespace
 }  // namespace libgav1
@@ -72,6 +72,8 @@ list(APPEND libgav1_tests_utils_sources
 list(APPEND libgav1_tests_utils_test_sources
             "${libgav1_root}/tests/utils_test.cc")
 
+list(APPEND libgav1_arena_test_sources
+            "${libgav1_source}/utils/arena_test.cc")
 list(APPEND libgav1_array_2d_test_sources
             "${libgav1_source}/utils/array_2d_test.cc")
 list(APPEND libgav1_average_blend_test_sources
@@ -103,6 +105,8 @@ list(APPEND libgav1_common_sse4_test_sources
 list(APPEND libgav1_convolve_test_sources
             "${libgav1_source}/dsp/convolve_test.cc")
 list(APPEND libgav1_cpu_test_sources "${libgav1_source}/utils/cpu_test.cc")
+list(APPEND libgav1_cpu_affinity_test_sources
+            "${libgav1_source}/utils/cpu_affinity_test.cc")
 list(APPEND libgav1_c_decoder_test_sources
             "${libgav1_source}/c_decoder_test.c"
             "${libgav1_source}/decoder_test_data.h")
@@ -232,6 +236,22 @@ macro(libgav1_add_tests_targets)
     list(APPEND libgav1_common_test_absl_deps absl::synchronization)
   endif()
 
+  libgav1_add_executable(TEST
+                         NAME
+                         arena_test
+                         SOURCES
+                         ${libgav1_arena_test_sources}
+                         DEFINES
+                         ${libgav1_defines}
+                         INCLUDES
+                         ${libgav1_test_include_paths}
+                         OBJLIB_DEPS
+                         libgav1_utils
+                         LIB_DEPS
+                         ${libgav1_common_test_absl_deps}
+                         libgav1_gtest
+                         libgav1_gtest_main)
+
   libgav1_add_executable(TEST
                          NAME
                          array_2d_test
@@ -358,6 +378,22 @@ macro(libgav1_add_tests_targets)
                          libgav1_gtest
                          libgav1_gtest_main)
 
+  libgav1_add_executable(TEST
+                         NAME
+                         cpu_affinity_test
+                         SOURCES
+                         ${libgav1_cpu_affinity_test_sources}
+                         DEFINES
+                         ${libgav1_defines}
+                         INCLUDES
+                         ${libgav1_test_include_paths}
+                         OBJLIB_DEPS
+                         libgav1_utils
+                         LIB_DEPS
+                         ${libgav1_common_test_absl_deps}
+                         libgav1_gtest
+                         libgav1_gtest_main)
+
   libgav1_add_executable(TEST
                          NAME
                          entropy_decoder_test